@@ -43,6 +43,7 @@
 # ifdef MATRIX_USE_FILE_SYSTEM
 
 #  include <signal.h>                /* Defines SIGTERM, etc. */
+#  include <sys/stat.h>
 
 #  ifndef MATRIX_TESTING_ENVIRONMENT /* Omit the message when testing. */
 #   ifdef WIN32
@@ -98,6 +99,10 @@ static char g_identityCert[MAX_KEYFILE_PATH];
 static char g_dhParamFile[MAX_KEYFILE_PATH];
 static char g_caFile[MAX_KEYFILE_PATH];
 static char g_password[MAX_PASSWORD_LEN];
+#  ifdef USE_OCSP
+static char g_ocspFile[MAX_KEYFILE_PATH];
+static time_t g_ocspFileTime;
+#  endif
 
 static unsigned char g_httpResponseHdr[] = "HTTP/1.0 200 OK\r\n"
                                            "Server: MatrixSSL/" MATRIXSSL_VERSION "\r\n"
@@ -121,6 +126,9 @@ static int32 httpWriteResponse(httpConn_t *conn);
 static int setSocketOptions(SOCKET fd);
 static SOCKET lsocketListen(short port, int32 *err);
 static void closeConn(httpConn_t *cp, int32 reason);
+#  ifdef USE_OCSP
+static void ocspFileWatch(sslKeys_t *keys);
+#  endif
 
 #  ifdef POSIX
 static void sigsegv_handler(int i);
@@ -738,6 +746,10 @@ static void usage(void)
         "                       and Diffie-Hellman parameter files\n"
         "-P <port>           - Port number\n"
         "-h                  - Help, print usage and exit\n"
+#  ifdef USE_OCSP
+        "-o <file>           - DER OCSP response to staple, reloaded when\n"
+        "                      the file changes\n"
+#  endif
         "-x <ciphers>        - Cipher suites to disable\n"
         "                      Example cipher numbers:\n"
         "                        - '53' TLS_RSA_WITH_AES_256_CBC_SHA\n"
@@ -808,13 +820,16 @@ static int32 process_cmd_options(int32 argc, char **argv)
     memset(g_dhParamFile, 0, MAX_KEYFILE_PATH);
     memset(g_caFile, 0, MAX_KEYFILE_PATH);
     memset(g_password, 0, MAX_PASSWORD_LEN);
+#  ifdef USE_OCSP
+    memset(g_ocspFile, 0, MAX_KEYFILE_PATH);
+#  endif
 
     g_port              = HTTPS_PORT;
     g_version           = 3;
     g_disabledCiphers   = 0;
 
     opterr = 0;
-    while ((optionChar = getopt(argc, argv, "c:d:a:D:hk:p:P:v:x:")) != -1)
+    while ((optionChar = getopt(argc, argv, "c:d:a:D:hk:o:p:P:v:x:")) != -1)
     {
         switch (optionChar)
         {
@@ -885,6 +900,18 @@ static int32 process_cmd_options(int32 argc, char **argv)
             strncpy(g_privkeyFile, optarg, str_len);
             break;
 
+#  ifdef USE_OCSP
+        case 'o':
+            /* OCSP response file */
+            str_len = strlen(optarg);
+            if (str_len > MAX_KEYFILE_PATH - 1)
+            {
+                return -1;
+            }
+            strncpy(g_ocspFile, optarg, str_len);
+            break;
+#  endif
+
         case 'p':
             /* password */
             str_len = strlen(optarg);
@@ -1121,6 +1148,9 @@ int32 main(int32 argc, char **argv)
     /* Main select loop to handle sockets events */
     while (!g_exitFlag)
     {
+#  ifdef USE_OCSP
+        ocspFileWatch(keys);
+#  endif
         selectLoop(keys, lfd);
         displayStats();
     }
@@ -1145,6 +1175,36 @@ L_EXIT:
     return 0;
 }
 
+#  ifdef USE_OCSP
+/******************************************************************************/
+/*
+    Stand-in for a file watcher, polled once per pass of the select loop:
+    hand the OCSP response file to the refresh hook whenever its
+    modification time changes.  Handshakes keep running on the old
+    response until the new one has been read and checked.
+ */
+static void ocspFileWatch(sslKeys_t *keys)
+{
+    struct stat st;
+    int32 rc;
+
+    if (g_ocspFile[0] == 0 || stat(g_ocspFile, &st) != 0 ||
+        st.st_mtime == g_ocspFileTime)
+    {
+        return;
+    }
+    g_ocspFileTime = st.st_mtime;
+    if ((rc = matrixSslRefreshOCSPResponseFile(keys, g_ocspFile)) < 0)
+    {
+        _psTraceInt("Unable to load OCSP response: %d\n", rc);
+    }
+    else
+    {
+        _psTrace("Loaded OCSP response\n");
+    }
+}
+#  endif /* USE_OCSP */
+
 /******************************************************************************/
 /*
     Close a socket and free associated SSL context and buffers
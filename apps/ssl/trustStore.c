@@ -0,0 +1,175 @@
+/**
+ *      @file    trustStore.c
+ *      @version $Format:%h%d$
+ *
+ *      Compile a CA bundle into a binary trust store image.
+ */
+/*
+ *      Copyright (c) 2013-2017 INSIDE Secure Corporation
+ *      Copyright (c) PeerSec Networks, 2002-2011
+ *      All Rights Reserved
+ *
+ *      The latest version of this code is available at http://www.matrixssl.org
+ *
+ *      This software is open source; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This General Public License does NOT permit incorporating this software
+ *      into proprietary programs.  If you are unable to comply with the GPL, a
+ *      commercial license for this software may be purchased from INSIDE at
+ *      http://www.insidesecure.com/
+ *
+ *      This program is distributed in WITHOUT ANY WARRANTY; without even the
+ *      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *      See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program; if not, write to the Free Software
+ *      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *      http://www.gnu.org/copyleft/gpl.html
+ */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crypto/cryptoApi.h"
+
+/*
+    trustStore <CA bundle> <image>
+        Parse a PEM or DER CA bundle, as matrixSslLoadKeys would, and write
+        the image that matrixSslLoadTrustStore loads in its place.
+    trustStore -l <image>
+        List the certificates of an image.
+ */
+
+#if defined(USE_X509) && defined(USE_CERT_PARSE) && \
+    defined(MATRIX_USE_FILE_SYSTEM)
+
+static int32 compileTrustStore(const char *bundle, const char *imageFile)
+{
+    psX509Cert_t *certs, *cert, *check;
+    unsigned char *image;
+    psSizeL_t imageLen;
+    FILE *fp;
+    int32 rc, i;
+
+    if ((rc = psX509ParseCertFile(NULL, (char *) bundle, &certs,
+             CERT_STORE_UNPARSED_BUFFER | CERT_ALLOW_BUNDLE_PARTIAL_PARSE))
+        <= 0)
+    {
+        printf("Unable to parse %s: %d\n", bundle, (int) rc);
+        psX509FreeCert(certs);
+        return rc < 0 ? rc : PS_PARSE_FAIL;
+    }
+    /* The image leaves these out, as ALLOW_CA_BUNDLE_PARTIAL_PARSE would */
+    for (i = 1, cert = certs; cert != NULL; i++, cert = cert->next)
+    {
+        if (cert->parseStatus != PS_X509_PARSE_SUCCESS)
+        {
+            printf("Skipping certificate %d of %s: parse status %d\n",
+                (int) i, bundle, (int) cert->parseStatus);
+        }
+    }
+    rc = psX509NewTrustStore(NULL, certs, &image, &imageLen);
+    psX509FreeCert(certs);
+    if (rc < 0)
+    {
+        printf("Unable to compile %s: %d\n", bundle, (int) rc);
+        return rc;
+    }
+    /* Load it back before anyone else does */
+    if ((rc = psX509ParseTrustStore(NULL, image, imageLen, &check, 0)) < 0)
+    {
+        printf("Compiled image does not load: %d\n", (int) rc);
+        psFree(image, NULL);
+        return rc;
+    }
+    psX509FreeCert(check);
+
+    if ((fp = fopen(imageFile, "wb")) == NULL ||
+        fwrite(image, 1, imageLen, fp) != imageLen)
+    {
+        printf("Unable to write %s\n", imageFile);
+        rc = PS_PLATFORM_FAIL;
+    }
+    else
+    {
+        printf("%s: %d CA certs, %u bytes\n", imageFile, (int) rc,
+            (unsigned) imageLen);
+        rc = PS_SUCCESS;
+    }
+    if (fp != NULL && fclose(fp) != 0)
+    {
+        rc = PS_PLATFORM_FAIL;
+    }
+    psFree(image, NULL);
+    return rc;
+}
+
+static int32 listTrustStore(const char *imageFile)
+{
+    psX509Cert_t *certs, *cert;
+    const unsigned char *image;
+    psSizeL_t imageLen;
+    int32 rc, i;
+
+    if ((rc = psMapFile(NULL, imageFile, &image, &imageLen)) < 0)
+    {
+        printf("Unable to open %s\n", imageFile);
+        return rc;
+    }
+    if ((rc = psX509ParseTrustStore(NULL, image, imageLen, &certs, 0)) < 0)
+    {
+        printf("Unable to load %s: %d\n", imageFile, (int) rc);
+        psUnmapFile(NULL, image, imageLen);
+        return rc;
+    }
+    for (i = 0, cert = certs; cert != NULL; i++, cert = cert->next)
+    {
+        printf("%3d %5u %s\n", (int) i, (unsigned) cert->binLen,
+            cert->subject.commonName ? cert->subject.commonName : "");
+    }
+    psX509FreeCert(certs);
+    psUnmapFile(NULL, image, imageLen);
+    return PS_SUCCESS;
+}
+
+int32 main(int32 argc, char **argv)
+{
+    int32 rc;
+
+    if (argc != 3)
+    {
+        printf("usage: %s <CA bundle> <image>\n"
+            "       %s -l <image>\n", argv[0], argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (psCryptoOpen(PSCRYPTO_CONFIG) < PS_SUCCESS)
+    {
+        printf("psCryptoOpen failed\n");
+        return EXIT_FAILURE;
+    }
+    if (strcmp(argv[1], "-l") == 0)
+    {
+        rc = listTrustStore(argv[2]);
+    }
+    else
+    {
+        rc = compileTrustStore(argv[1], argv[2]);
+    }
+    psCryptoClose();
+    return rc < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#else
+
+int32 main(int32 argc, char **argv)
+{
+    printf("USE_X509, USE_CERT_PARSE and MATRIX_USE_FILE_SYSTEM must be " \
+        "enabled at build time to run this application\n");
+    return EXIT_FAILURE;
+}
+#endif /* USE_X509 && USE_CERT_PARSE && MATRIX_USE_FILE_SYSTEM */
@@ -177,6 +177,28 @@ extern "C" {
 */
 //#define NO_ECC_EPHEMERAL_CACHE /**< @security NIST_SHALL */
 
+/**
+	Keep a small pool of fresh ephemeral ECC keys for each curve in use,
+	refilled by a background thread, instead of the single cached key above.
+	Handshakes take a ready key and do not wait for key generation unless
+	a burst of connections empties the pool. Each pooled key is used at most
+	ECC_EPHEMERAL_POOL_USAGE times, the default of 1 gives every handshake
+	its own key. @pre USE_MULTITHREADING
+ */
+//#define USE_ECC_EPHEMERAL_POOL
+
+/******************************************************************************/
+/**
+	Run the private and public key operations that are deferred to flight
+	encoding (the ServerKeyExchange signature and the ClientKeyExchange
+	encryption or key agreement) on a library worker pool of
+	ASYNC_PKA_THREADS threads. Only sessions opened with
+	sslSessOpts_t.asyncPka use it. matrixSslReceivedData then returns
+	MATRIXSSL_PKA_PENDING instead of blocking, and the handshake continues
+	once matrixSslGetPkaEventFd() is readable. @pre USE_MULTITHREADING
+*/
+//#define USE_ASYNC_PKA
+
 /******************************************************************************/
 /**
 	Configure Support for TLS protocol versions.
@@ -78,6 +78,23 @@
 /**< @note Enable verification of DSA signatures in certificate validation.
    Works only when using the CL/SL library. @pre USE_CERT_PARSE. */
 /* #define USE_DSA_VERIFY */
+/**
+    Compute the two CRT halves of RSA private key operations concurrently,
+    using a small internal pool of worker threads. This roughly halves the
+    latency of each signature or decryption with large keys, at the cost of
+    keeping an additional core busy. Without USE_MULTITHREADING the halves
+    are computed one after the other. @pre USE_RSA
+ */
+/* #define USE_RSA_PARALLEL_CRT */
+/**
+    Precompute ECDSA signing nonces for the TLS private key in a background
+    thread, so that ServerKeyExchange and CertificateVerify signatures need
+    only one modular multiplication. Each nonce is used once, and a forked
+    child discards the queue of its parent. Without USE_MULTITHREADING the
+    nonces are computed by the signing thread, which gives no speedup.
+    @pre USE_ECC
+ */
+/* #define USE_ECDSA_PRESIGN */
 
 /******************************************************************************/
 /**
@@ -111,6 +128,23 @@
 /* #define USE_BRAIN512R1 */
 #  endif
 
+/**
+    Define to enable X25519 (RFC 7748) for ECDHE key exchange.
+    @see https://tools.ietf.org/html/rfc7748
+ */
+#  ifdef USE_ECC
+#   define USE_X25519
+#  endif
+
+/**
+    Define to enable Ed25519 signatures (RFC 8032) and certificates.
+    @pre USE_SHA512
+    @see https://tools.ietf.org/html/rfc8032
+ */
+#  ifdef USE_ECC
+#   define USE_ED25519
+#  endif
+
 /******************************************************************************/
 /**
     Symmetric and AEAD ciphers.
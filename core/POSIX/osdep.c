@@ -48,6 +48,11 @@
 # include <unistd.h>   /* close() */
 # include <errno.h>    /* errno */
 # include <sys/time.h> /* gettimeofday */
+# include <sys/mman.h> /* mmap() */
+# include <sys/stat.h> /* fstat() */
+# if defined(USE_MULTITHREADING) && defined(__linux__)
+#  include <sys/eventfd.h>
+# endif
 
 /******************************************************************************/
 /*
@@ -239,6 +244,15 @@ int32 psCompareTime(psTime_t a, psTime_t b, void *userPtr)
 
 # endif  /* USE_HIGHRES_TIME */
 
+/******************************************************************************/
+/*
+    PROCESS ID
+ */
+uint32_t psGetProcessId(void)
+{
+    return (uint32_t) getpid();
+}
+
 /******************************************************************************/
 
 # ifdef USE_MULTITHREADING
@@ -315,6 +329,227 @@ void psDestroyMutex(psMutex_t *mutex)
 {
     pthread_mutex_destroy(mutex);
 }
+
+/******************************************************************************/
+/*
+    CONDITION VARIABLE AND THREAD FUNCTIONS
+ */
+/******************************************************************************/
+
+int32_t psCreateCond(psCond_t *cond)
+{
+    int rc;
+
+    if ((rc = pthread_cond_init(cond, NULL)) != 0)
+    {
+        psErrorInt("pthread_cond_init failed %d\n", rc);
+        return PS_PLATFORM_FAIL;
+    }
+    return PS_SUCCESS;
+}
+
+void psWaitCond(psCond_t *cond, psMutex_t *mutex)
+{
+    if (pthread_cond_wait(cond, mutex) != 0)
+    {
+        psTraceCore("pthread_cond_wait failed\n");
+        abort(); /* Catastrophic error: condition does not work correctly. */
+    }
+}
+
+void psSignalCond(psCond_t *cond)
+{
+    pthread_cond_signal(cond);
+}
+
+void psBroadcastCond(psCond_t *cond)
+{
+    pthread_cond_broadcast(cond);
+}
+
+void psDestroyCond(psCond_t *cond)
+{
+    pthread_cond_destroy(cond);
+}
+
+int32_t psCreateRwLock(psRwLock_t *lock)
+{
+    int rc;
+
+    if ((rc = pthread_rwlock_init(lock, NULL)) != 0)
+    {
+        psErrorInt("pthread_rwlock_init failed %d\n", rc);
+        return PS_PLATFORM_FAIL;
+    }
+    return PS_SUCCESS;
+}
+
+void psReadLock(psRwLock_t *lock)
+{
+    if (pthread_rwlock_rdlock(lock) != 0)
+    {
+        psTraceCore("pthread_rwlock_rdlock failed\n");
+        abort(); /* Catastrophic error: lock does not work correctly. */
+    }
+}
+
+void psReadUnlock(psRwLock_t *lock)
+{
+    if (pthread_rwlock_unlock(lock) != 0)
+    {
+        psTraceCore("pthread_rwlock_unlock failed\n");
+        abort(); /* Catastrophic error: lock does not work correctly. */
+    }
+}
+
+void psWriteLock(psRwLock_t *lock)
+{
+    if (pthread_rwlock_wrlock(lock) != 0)
+    {
+        psTraceCore("pthread_rwlock_wrlock failed\n");
+        abort(); /* Catastrophic error: lock does not work correctly. */
+    }
+}
+
+void psWriteUnlock(psRwLock_t *lock)
+{
+    if (pthread_rwlock_unlock(lock) != 0)
+    {
+        psTraceCore("pthread_rwlock_unlock (write) failed\n");
+        abort(); /* Catastrophic error: lock does not work correctly. */
+    }
+}
+
+void psDestroyRwLock(psRwLock_t *lock)
+{
+    pthread_rwlock_destroy(lock);
+}
+
+typedef struct
+{
+    psThreadFunc_t func;
+    void *arg;
+} psThreadStart_t;
+
+static void *psThreadTrampoline(void *arg)
+{
+    psThreadStart_t start = *(psThreadStart_t *) arg;
+
+    psFreeNoPool(arg);
+    start.func(start.arg);
+    return NULL;
+}
+
+int32_t psCreateThread(psThread_t *thread, psThreadFunc_t func, void *arg)
+{
+    psThreadStart_t *start;
+    int rc;
+
+    if ((start = psMallocNoPool(sizeof(psThreadStart_t))) == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    start->func = func;
+    start->arg = arg;
+    if ((rc = pthread_create(thread, NULL, psThreadTrampoline, start)) != 0)
+    {
+        psFreeNoPool(start);
+        psErrorInt("pthread_create failed %d\n", rc);
+        return PS_PLATFORM_FAIL;
+    }
+    return PS_SUCCESS;
+}
+
+void psJoinThread(psThread_t *thread)
+{
+    pthread_join(*thread, NULL);
+}
+
+/******************************************************************************/
+/*
+    NOTIFY FUNCTIONS
+    An eventfd where available, otherwise a self-pipe. Both ends are
+    non-blocking so neither posting nor clearing can stall the caller.
+ */
+int32_t psCreateNotify(psNotify_t *n)
+{
+#  ifdef __linux__
+    if ((n->fd[0] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0)
+    {
+        psErrorInt("eventfd failed %d\n", errno);
+        return PS_PLATFORM_FAIL;
+    }
+    n->fd[1] = n->fd[0];
+#  else
+    int i;
+
+    if (pipe(n->fd) < 0)
+    {
+        psErrorInt("pipe failed %d\n", errno);
+        return PS_PLATFORM_FAIL;
+    }
+    for (i = 0; i < 2; i++)
+    {
+        fcntl(n->fd[i], F_SETFL, fcntl(n->fd[i], F_GETFL) | O_NONBLOCK);
+        fcntl(n->fd[i], F_SETFD, FD_CLOEXEC);
+    }
+#  endif
+    return PS_SUCCESS;
+}
+
+int psNotifyFd(const psNotify_t *n)
+{
+    return n->fd[0];
+}
+
+void psSignalNotify(psNotify_t *n)
+{
+#  ifdef __linux__
+    uint64_t one = 1;
+#  else
+    unsigned char one = 1;
+#  endif
+
+    /* Only fails when the eventfd counter would overflow or the pipe is
+       full. The notify is readable in both cases, so nothing is lost. */
+    if (write(n->fd[1], &one, sizeof(one)) < 0)
+    {
+        psTraceCore("Notify already posted\n");
+    }
+}
+
+/*
+    Returns PS_TRUE and rearms if the notify had been posted, PS_FALSE
+    otherwise.
+ */
+int32_t psClearNotify(psNotify_t *n)
+{
+#  ifdef __linux__
+    uint64_t count;
+
+    return read(n->fd[0], &count, sizeof(count)) == sizeof(count) ?
+           PS_TRUE : PS_FALSE;
+#  else
+    unsigned char buf[16];
+    int32_t posted = PS_FALSE;
+
+    while (read(n->fd[0], buf, sizeof(buf)) > 0)
+    {
+        posted = PS_TRUE;
+    }
+    return posted;
+#  endif
+}
+
+void psDestroyNotify(psNotify_t *n)
+{
+    close(n->fd[0]);
+    if (n->fd[1] != n->fd[0])
+    {
+        close(n->fd[1]);
+    }
+    n->fd[0] = n->fd[1] = -1;
+}
 # endif /* USE_MULTITHREADING */
 /******************************************************************************/
 
@@ -667,6 +902,56 @@ int32 psGetFileBuf(psPool_t *pool, const char *fileName, unsigned char **buf,
     }
     return psGetFileBufFp(pool, fp, buf, bufLen);
 }
+
+/**
+    Map a file read-only.  Pages are read in by the kernel on access, so
+    large files such as CRLs cost neither heap nor an up front read.
+    @note Caller must release 'buf' with psUnmapFile on success.
+ */
+int32_t psMapFile(psPool_t *pool, const char *fileName,
+    const unsigned char **buf, psSizeL_t *bufLen)
+{
+    struct stat f_stat;
+    void *map;
+    int fd;
+
+    *buf = NULL;
+    *bufLen = 0;
+
+    if (fileName == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    if ((fd = open(fileName, O_RDONLY)) < 0)
+    {
+        psTraceStrCore("Unable to open %s\n", (char *) fileName);
+        return PS_PLATFORM_FAIL;
+    }
+    if (fstat(fd, &f_stat) != 0 || f_stat.st_size <= 0)
+    {
+        close(fd);
+        psTraceStrCore("Unable to stat %s\n", (char *) fileName);
+        return PS_PLATFORM_FAIL;
+    }
+    map = mmap(NULL, (size_t) f_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        psTraceStrCore("Unable to map %s\n", (char *) fileName);
+        return PS_PLATFORM_FAIL;
+    }
+    *buf = map;
+    *bufLen = (psSizeL_t) f_stat.st_size;
+    return PS_SUCCESS;
+}
+
+void psUnmapFile(psPool_t *pool, const unsigned char *buf, psSizeL_t bufLen)
+{
+    if (buf != NULL)
+    {
+        munmap((void *) buf, (size_t) bufLen);
+    }
+}
 # endif /* MATRIX_USE_FILE_SYSTEM */
 #endif  /* POSIX */
 /******************************************************************************/
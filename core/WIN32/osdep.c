@@ -99,6 +99,14 @@ int32 psCompareTime(psTime_t a, psTime_t b, void *userPtr)
     return 0;
 }
 
+/******************************************************************************/
+/* PROCESS ID */
+
+uint32_t psGetProcessId(void)
+{
+    return (uint32_t) GetCurrentProcessId();
+}
+
 /******************************************************************************/
 /* MUTEX */
 
@@ -138,6 +146,107 @@ void psDestroyMutex(psMutex_t *mutex)
 {
     DeleteCriticalSection(mutex);
 }
+
+/******************************************************************************/
+/* CONDITION VARIABLE AND THREAD */
+
+int32_t psCreateCond(psCond_t *cond)
+{
+    InitializeConditionVariable(cond);   /* Does not return a value */
+    return PS_SUCCESS;
+}
+
+void psWaitCond(psCond_t *cond, psMutex_t *mutex)
+{
+    SleepConditionVariableCS(cond, mutex, INFINITE);
+}
+
+void psSignalCond(psCond_t *cond)
+{
+    WakeConditionVariable(cond);
+}
+
+void psBroadcastCond(psCond_t *cond)
+{
+    WakeAllConditionVariable(cond);
+}
+
+void psDestroyCond(psCond_t *cond)
+{
+    /* Windows condition variables need no cleanup */
+}
+
+int32_t psCreateRwLock(psRwLock_t *lock)
+{
+    InitializeSRWLock(lock);   /* Does not return a value */
+    return PS_SUCCESS;
+}
+
+void psReadLock(psRwLock_t *lock)
+{
+    AcquireSRWLockShared(lock);
+}
+
+void psReadUnlock(psRwLock_t *lock)
+{
+    ReleaseSRWLockShared(lock);
+}
+
+void psWriteLock(psRwLock_t *lock)
+{
+    AcquireSRWLockExclusive(lock);
+}
+
+void psWriteUnlock(psRwLock_t *lock)
+{
+    ReleaseSRWLockExclusive(lock);
+}
+
+void psDestroyRwLock(psRwLock_t *lock)
+{
+    /* Slim reader/writer locks need no cleanup */
+}
+
+typedef struct
+{
+    psThreadFunc_t func;
+    void *arg;
+} psThreadStart_t;
+
+static DWORD WINAPI psThreadTrampoline(LPVOID arg)
+{
+    psThreadStart_t start = *(psThreadStart_t *) arg;
+
+    psFreeNoPool(arg);
+    start.func(start.arg);
+    return 0;
+}
+
+int32_t psCreateThread(psThread_t *thread, psThreadFunc_t func, void *arg)
+{
+    psThreadStart_t *start;
+
+    if ((start = psMallocNoPool(sizeof(psThreadStart_t))) == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    start->func = func;
+    start->arg = arg;
+    *thread = CreateThread(NULL, 0, psThreadTrampoline, start, 0, NULL);
+    if (*thread == NULL)
+    {
+        psFreeNoPool(start);
+        psErrorInt("CreateThread failed %u\n", (uint32) GetLastError());
+        return PS_PLATFORM_FAIL;
+    }
+    return PS_SUCCESS;
+}
+
+void psJoinThread(psThread_t *thread)
+{
+    WaitForSingleObject(*thread, INFINITE);
+    CloseHandle(*thread);
+}
 # endif /* USE_MULTITHREADING */
 
 /******************************************************************************/
@@ -285,6 +394,32 @@ int32 psGetFileBuf(psPool_t *pool, const char *fileName, unsigned char **buf,
     CloseHandle(hFile);
     return PS_SUCCESS;
 }
+
+/*
+    No mapping here: psMapFile reads the file into the heap and psUnmapFile
+    frees it again.
+ */
+int32_t psMapFile(psPool_t *pool, const char *fileName,
+    const unsigned char **buf, psSizeL_t *bufLen)
+{
+    unsigned char *fileBuf;
+    int32 fileBufLen, rc;
+
+    *buf = NULL;
+    *bufLen = 0;
+    if ((rc = psGetFileBuf(pool, fileName, &fileBuf, &fileBufLen)) < 0)
+    {
+        return rc;
+    }
+    *buf = fileBuf;
+    *bufLen = (psSizeL_t) fileBufLen;
+    return PS_SUCCESS;
+}
+
+void psUnmapFile(psPool_t *pool, const unsigned char *buf, psSizeL_t bufLen)
+{
+    psFree((unsigned char *) buf, pool);
+}
 # endif /* MATRIX_USE_FILE_SYSTEM */
 
 #endif  /* WIN32 */
@@ -239,6 +239,9 @@ PSPUBLIC int32      psGetEntropy(unsigned char *bytes, uint32 size,
 PSPUBLIC int32      psGetTime(psTime_t *t, void *userPtr);
 PSPUBLIC int32      psDiffMsecs(psTime_t then, psTime_t now, void *userPtr);
 
+/* Identifies the running process, changes in the child after fork() */
+PSPUBLIC uint32_t   psGetProcessId(void);
+
 /* psCompareTime is no longer used */
 PSPUBLIC int32      psCompareTime(psTime_t a, psTime_t b, void *userPtr);
 
@@ -249,6 +252,12 @@ PSPUBLIC int32      psGetFileBufFp(psPool_t *pool, FILE *fp,
 #  endif /* USE_POSIX */
 PSPUBLIC int32      psGetFileBuf(psPool_t *pool, const char *fileName,
                                  unsigned char **buf, int32 *bufLen);
+/* Read-only view of a whole file, mmap'd where the platform allows.
+   Release with psUnmapFile, giving the same buf and bufLen. */
+PSPUBLIC int32_t    psMapFile(psPool_t *pool, const char *fileName,
+                              const unsigned char **buf, psSizeL_t *bufLen);
+PSPUBLIC void       psUnmapFile(psPool_t *pool, const unsigned char *buf,
+                                psSizeL_t bufLen);
 # endif /* MATRIX_USE_FILE_SYSTEM */
 
 # ifdef USE_MULTITHREADING
@@ -266,6 +275,80 @@ PSPUBLIC void       psDestroyMutex(psMutex_t *mutex);
 #  define psDestroyMutex(A)
 # endif /* USE_MULTITHREADING */
 
+# ifdef PS_HAVE_THREADS
+/** Entry point of a thread started with psCreateThread(). */
+typedef void (*psThreadFunc_t)(void *arg);
+
+PSPUBLIC int32_t    psCreateCond(psCond_t *cond);
+PSPUBLIC void       psWaitCond(psCond_t *cond, psMutex_t *mutex);
+PSPUBLIC void       psSignalCond(psCond_t *cond);
+PSPUBLIC void       psBroadcastCond(psCond_t *cond);
+PSPUBLIC void       psDestroyCond(psCond_t *cond);
+PSPUBLIC int32_t    psCreateThread(psThread_t *thread, psThreadFunc_t func,
+                                   void *arg);
+PSPUBLIC void       psJoinThread(psThread_t *thread);
+# endif /* PS_HAVE_THREADS */
+
+# ifdef PS_HAVE_RWLOCK
+/** Lock for read-mostly data: any number of readers or a single writer. */
+PSPUBLIC int32_t    psCreateRwLock(psRwLock_t *lock);
+PSPUBLIC void       psReadLock(psRwLock_t *lock);
+PSPUBLIC void       psReadUnlock(psRwLock_t *lock);
+PSPUBLIC void       psWriteLock(psRwLock_t *lock);
+PSPUBLIC void       psWriteUnlock(psRwLock_t *lock);
+PSPUBLIC void       psDestroyRwLock(psRwLock_t *lock);
+# endif /* PS_HAVE_RWLOCK */
+
+# ifdef PS_HAVE_NOTIFY
+/*
+    A wakeup that another thread can post and an event loop can wait for
+    with poll() or select() on psNotifyFd(). Posting is idempotent until
+    psClearNotify() consumes it.
+ */
+PSPUBLIC int32_t    psCreateNotify(psNotify_t *n);
+PSPUBLIC int        psNotifyFd(const psNotify_t *n);
+PSPUBLIC void       psSignalNotify(psNotify_t *n);
+PSPUBLIC int32_t    psClearNotify(psNotify_t *n);
+PSPUBLIC void       psDestroyNotify(psNotify_t *n);
+# endif /* PS_HAVE_NOTIFY */
+
+/******************************************************************************/
+/*
+    Worker pool.
+
+    A small set of threads that run jobs on behalf of the library.
+    The job structure is owned by the caller and must stay valid until
+    the job has completed. When the library is built without thread
+    support, psWorkerPoolSubmit() runs the job in the calling thread
+    before returning, so callers do not need a separate code path.
+
+    fork() does not copy the threads of a pool. In the child every pool
+    opened by the parent runs submitted jobs in the calling thread, and
+    jobs that were queued or running in the parent at the time of the fork
+    never complete there: do not psWorkerJobWait() on them in the child.
+    psWorkerPoolThreads() tells whether jobs run in the background.
+ */
+typedef void (*psWorkerFunc_t)(void *arg);
+
+typedef struct psWorkerJob
+{
+    psWorkerFunc_t func;
+    void *arg;
+    struct psWorkerJob *next;
+    uint8_t done;
+} psWorkerJob_t;
+
+typedef struct psWorkerPool psWorkerPool_t;
+
+PSPUBLIC int32_t    psWorkerPoolOpen(psPool_t *pool, psWorkerPool_t **wp,
+                                     uint16_t threads);
+PSPUBLIC void       psWorkerPoolClose(psWorkerPool_t *wp);
+PSPUBLIC void       psWorkerJobInit(psWorkerJob_t *job, psWorkerFunc_t func,
+                                    void *arg);
+PSPUBLIC int32_t    psWorkerPoolSubmit(psWorkerPool_t *wp, psWorkerJob_t *job);
+PSPUBLIC void       psWorkerJobWait(psWorkerPool_t *wp, psWorkerJob_t *job);
+PSPUBLIC uint16_t   psWorkerPoolThreads(const psWorkerPool_t *wp);
+
 /******************************************************************************/
 /*
     Internal list helpers
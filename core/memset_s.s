@@ -0,0 +1,368 @@
+	.file	"memset_s.c"
+# GNU C17 (Debian 12.2.0-14+deb12u1) version 12.2.0 (x86_64-linux-gnu)
+#	compiled by GNU C version 12.2.0, GMP version 6.2.1, MPFR version 4.2.0, MPC version 1.3.1, isl version isl-0.25-GMP
+
+# GGC heuristics: --param ggc-min-expand=100 --param ggc-min-heapsize=131072
+# options passed: -mtune=generic -march=x86-64 -g -O0 -fasynchronous-unwind-tables
+	.text
+.Ltext0:
+	.file 0 "/root/repo/core" "memset_s.c"
+	.globl	memset_s
+	.type	memset_s, @function
+memset_s:
+.LFB0:
+	.file 1 "memset_s.c"
+	.loc 1 74 1
+	.cfi_startproc
+	pushq	%rbp	#
+	.cfi_def_cfa_offset 16
+	.cfi_offset 6, -16
+	movq	%rsp, %rbp	#,
+	.cfi_def_cfa_register 6
+	subq	$32, %rsp	#,
+	movq	%rdi, -8(%rbp)	# s, s
+	movq	%rsi, -16(%rbp)	# smax, smax
+	movl	%edx, -20(%rbp)	# c, c
+	movq	%rcx, -32(%rbp)	# n, n
+# memset_s.c:75:     if (n > smax)
+	.loc 1 75 8
+	movq	-32(%rbp), %rax	# n, tmp85
+	cmpq	%rax, -16(%rbp)	# tmp85, smax
+	jnb	.L2	#,
+# memset_s.c:77:         n = smax;
+	.loc 1 77 11
+	movq	-16(%rbp), %rax	# smax, tmp86
+	movq	%rax, -32(%rbp)	# tmp86, n
+.L2:
+# memset_s.c:79:     memset(s, c, n);
+	.loc 1 79 5
+	movq	-32(%rbp), %rdx	# n, tmp87
+	movl	-20(%rbp), %ecx	# c, tmp88
+	movq	-8(%rbp), %rax	# s, tmp89
+	movl	%ecx, %esi	# tmp88,
+	movq	%rax, %rdi	# tmp89,
+	call	memset@PLT	#
+# memset_s.c:80:     return ((unsigned char volatile *) s)[0];
+	.loc 1 80 42
+	movq	-8(%rbp), %rax	# s, tmp90
+	movzbl	(%rax), %eax	# MEM[(volatile unsigned char *)s_7(D)], _1
+	movzbl	%al, %eax	# _1, _10
+# memset_s.c:81: }
+	.loc 1 81 1
+	leave	
+	.cfi_def_cfa 7, 8
+	ret	
+	.cfi_endproc
+.LFE0:
+	.size	memset_s, .-memset_s
+.Letext0:
+	.file 2 "/usr/lib/gcc/x86_64-linux-gnu/12/include/stddef.h"
+	.file 3 "/usr/include/string.h"
+	.section	.debug_info,"",@progbits
+.Ldebug_info0:
+	.long	0xdc
+	.value	0x5
+	.byte	0x1
+	.byte	0x8
+	.long	.Ldebug_abbrev0
+	.uleb128 0x5
+	.long	.LASF9
+	.byte	0x1d
+	.long	.LASF0
+	.long	.LASF1
+	.quad	.Ltext0
+	.quad	.Letext0-.Ltext0
+	.long	.Ldebug_line0
+	.uleb128 0x1
+	.long	.LASF5
+	.byte	0x2
+	.byte	0xd6
+	.byte	0x17
+	.long	0x3a
+	.uleb128 0x2
+	.byte	0x8
+	.byte	0x7
+	.long	.LASF2
+	.uleb128 0x2
+	.byte	0x2
+	.byte	0x7
+	.long	.LASF3
+	.uleb128 0x6
+	.byte	0x4
+	.byte	0x5
+	.string	"int"
+	.uleb128 0x2
+	.byte	0x1
+	.byte	0x6
+	.long	.LASF4
+	.uleb128 0x1
+	.long	.LASF6
+	.byte	0x1
+	.byte	0x46
+	.byte	0x10
+	.long	0x2e
+	.uleb128 0x1
+	.long	.LASF7
+	.byte	0x1
+	.byte	0x47
+	.byte	0xd
+	.long	0x48
+	.uleb128 0x7
+	.long	.LASF10
+	.byte	0x3
+	.byte	0x3d
+	.byte	0xe
+	.long	0x8e
+	.long	0x8e
+	.uleb128 0x3
+	.long	0x8e
+	.uleb128 0x3
+	.long	0x48
+	.uleb128 0x3
+	.long	0x2e
+	.byte	0
+	.uleb128 0x8
+	.byte	0x8
+	.uleb128 0x9
+	.long	.LASF11
+	.byte	0x1
+	.byte	0x49
+	.byte	0x12
+	.long	0x62
+	.quad	.LFB0
+	.quad	.LFE0-.LFB0
+	.uleb128 0x1
+	.byte	0x9c
+	.uleb128 0x4
+	.string	"s"
+	.byte	0x21
+	.long	0x8e
+	.uleb128 0x2
+	.byte	0x91
+	.sleb128 -24
+	.uleb128 0xa
+	.long	.LASF8
+	.byte	0x1
+	.byte	0x49
+	.byte	0x2c
+	.long	0x56
+	.uleb128 0x2
+	.byte	0x91
+	.sleb128 -32
+	.uleb128 0x4
+	.string	"c"
+	.byte	0x36
+	.long	0x48
+	.uleb128 0x2
+	.byte	0x91
+	.sleb128 -36
+	.uleb128 0x4
+	.string	"n"
+	.byte	0x41
+	.long	0x56
+	.uleb128 0x2
+	.byte	0x91
+	.sleb128 -48
+	.byte	0
+	.byte	0
+	.section	.debug_abbrev,"",@progbits
+.Ldebug_abbrev0:
+	.uleb128 0x1
+	.uleb128 0x16
+	.byte	0
+	.uleb128 0x3
+	.uleb128 0xe
+	.uleb128 0x3a
+	.uleb128 0xb
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x49
+	.uleb128 0x13
+	.byte	0
+	.byte	0
+	.uleb128 0x2
+	.uleb128 0x24
+	.byte	0
+	.uleb128 0xb
+	.uleb128 0xb
+	.uleb128 0x3e
+	.uleb128 0xb
+	.uleb128 0x3
+	.uleb128 0xe
+	.byte	0
+	.byte	0
+	.uleb128 0x3
+	.uleb128 0x5
+	.byte	0
+	.uleb128 0x49
+	.uleb128 0x13
+	.byte	0
+	.byte	0
+	.uleb128 0x4
+	.uleb128 0x5
+	.byte	0
+	.uleb128 0x3
+	.uleb128 0x8
+	.uleb128 0x3a
+	.uleb128 0x21
+	.sleb128 1
+	.uleb128 0x3b
+	.uleb128 0x21
+	.sleb128 73
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x49
+	.uleb128 0x13
+	.uleb128 0x2
+	.uleb128 0x18
+	.byte	0
+	.byte	0
+	.uleb128 0x5
+	.uleb128 0x11
+	.byte	0x1
+	.uleb128 0x25
+	.uleb128 0xe
+	.uleb128 0x13
+	.uleb128 0xb
+	.uleb128 0x3
+	.uleb128 0x1f
+	.uleb128 0x1b
+	.uleb128 0x1f
+	.uleb128 0x11
+	.uleb128 0x1
+	.uleb128 0x12
+	.uleb128 0x7
+	.uleb128 0x10
+	.uleb128 0x17
+	.byte	0
+	.byte	0
+	.uleb128 0x6
+	.uleb128 0x24
+	.byte	0
+	.uleb128 0xb
+	.uleb128 0xb
+	.uleb128 0x3e
+	.uleb128 0xb
+	.uleb128 0x3
+	.uleb128 0x8
+	.byte	0
+	.byte	0
+	.uleb128 0x7
+	.uleb128 0x2e
+	.byte	0x1
+	.uleb128 0x3f
+	.uleb128 0x19
+	.uleb128 0x3
+	.uleb128 0xe
+	.uleb128 0x3a
+	.uleb128 0xb
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x27
+	.uleb128 0x19
+	.uleb128 0x49
+	.uleb128 0x13
+	.uleb128 0x3c
+	.uleb128 0x19
+	.uleb128 0x1
+	.uleb128 0x13
+	.byte	0
+	.byte	0
+	.uleb128 0x8
+	.uleb128 0xf
+	.byte	0
+	.uleb128 0xb
+	.uleb128 0xb
+	.byte	0
+	.byte	0
+	.uleb128 0x9
+	.uleb128 0x2e
+	.byte	0x1
+	.uleb128 0x3f
+	.uleb128 0x19
+	.uleb128 0x3
+	.uleb128 0xe
+	.uleb128 0x3a
+	.uleb128 0xb
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x27
+	.uleb128 0x19
+	.uleb128 0x49
+	.uleb128 0x13
+	.uleb128 0x11
+	.uleb128 0x1
+	.uleb128 0x12
+	.uleb128 0x7
+	.uleb128 0x40
+	.uleb128 0x18
+	.uleb128 0x7c
+	.uleb128 0x19
+	.byte	0
+	.byte	0
+	.uleb128 0xa
+	.uleb128 0x5
+	.byte	0
+	.uleb128 0x3
+	.uleb128 0xe
+	.uleb128 0x3a
+	.uleb128 0xb
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x49
+	.uleb128 0x13
+	.uleb128 0x2
+	.uleb128 0x18
+	.byte	0
+	.byte	0
+	.byte	0
+	.section	.debug_aranges,"",@progbits
+	.long	0x2c
+	.value	0x2
+	.long	.Ldebug_info0
+	.byte	0x8
+	.byte	0
+	.value	0
+	.value	0
+	.quad	.Ltext0
+	.quad	.Letext0-.Ltext0
+	.quad	0
+	.quad	0
+	.section	.debug_line,"",@progbits
+.Ldebug_line0:
+	.section	.debug_str,"MS",@progbits,1
+.LASF2:
+	.string	"long unsigned int"
+.LASF5:
+	.string	"size_t"
+.LASF3:
+	.string	"short unsigned int"
+.LASF11:
+	.string	"memset_s"
+.LASF6:
+	.string	"rsize_t"
+.LASF8:
+	.string	"smax"
+.LASF10:
+	.string	"memset"
+.LASF7:
+	.string	"errno_t"
+.LASF9:
+	.string	"GNU C17 12.2.0 -mtune=generic -march=x86-64 -g -O0 -fasynchronous-unwind-tables"
+.LASF4:
+	.string	"char"
+	.section	.debug_line_str,"MS",@progbits,1
+.LASF1:
+	.string	"/root/repo/core"
+.LASF0:
+	.string	"memset_s.c"
+	.ident	"GCC: (Debian 12.2.0-14+deb12u1) 12.2.0"
+	.section	.note.GNU-stack,"",@progbits
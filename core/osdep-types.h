@@ -359,10 +359,26 @@ extern void osdepMutexClose(void);
 
 #   if defined(WIN32)
 typedef CRITICAL_SECTION psMutex_t;
+typedef CONDITION_VARIABLE psCond_t;
+typedef HANDLE psThread_t;
+typedef SRWLOCK psRwLock_t;
+#    define PS_HAVE_THREADS
+#    define PS_HAVE_RWLOCK
 #   elif defined(POSIX)
 #    include <string.h>
 #    include <pthread.h>
 typedef pthread_mutex_t psMutex_t;
+typedef pthread_cond_t psCond_t;
+typedef pthread_t psThread_t;
+typedef pthread_rwlock_t psRwLock_t;
+#    define PS_HAVE_THREADS
+#    define PS_HAVE_RWLOCK
+/* Read and write ends, the same eventfd on Linux */
+typedef struct
+{
+    int fd[2];
+} psNotify_t;
+#    define PS_HAVE_NOTIFY
 #   elif defined(VXWORKS)
 #    include "semLib.h"
 typedef SEM_ID psMutex_t;
@@ -0,0 +1,297 @@
+/**
+ *      @file    psWorker.c
+ *      @version $Format:%h%d$
+ *
+ *      Small worker thread pool for running library jobs in the background.
+ */
+/*
+ *      Copyright (c) 2017 INSIDE Secure Corporation
+ *      All Rights Reserved
+ *
+ *      The latest version of this code is available at http://www.matrixssl.org
+ *
+ *      This software is open source; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This General Public License does NOT permit incorporating this software
+ *      into proprietary programs.  If you are unable to comply with the GPL, a
+ *      commercial license for this software may be purchased from INSIDE at
+ *      http://www.insidesecure.com/
+ *
+ *      This program is distributed in WITHOUT ANY WARRANTY; without even the
+ *      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *      See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program; if not, write to the Free Software
+ *      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *      http://www.gnu.org/copyleft/gpl.html
+ */
+/******************************************************************************/
+
+#include "coreApi.h"
+#include "osdep.h"
+#include "psUtil.h"
+
+/* Upper bound for the number of threads in a single pool. */
+#define PS_WORKER_MAX_THREADS 16
+
+struct psWorkerPool
+{
+    psPool_t *pool;
+#ifdef PS_HAVE_THREADS
+    psMutex_t lock;
+    psCond_t work;          /* Signalled when a job is queued or on close */
+    psCond_t done;          /* Broadcast when any job completes */
+    psWorkerJob_t *head;    /* Queue of pending jobs, oldest first */
+    psWorkerJob_t *tail;
+    psThread_t thread[PS_WORKER_MAX_THREADS];
+    uint32_t pid;           /* Process that started the threads */
+    uint8_t shutdown;
+#endif /* PS_HAVE_THREADS */
+    uint16_t threads;       /* Number of running threads, may be 0 */
+};
+
+/******************************************************************************/
+/**
+    Prepare a job for submission.
+ */
+void psWorkerJobInit(psWorkerJob_t *job, psWorkerFunc_t func, void *arg)
+{
+    job->func = func;
+    job->arg = arg;
+    job->next = NULL;
+    job->done = 0;
+}
+
+#ifdef PS_HAVE_THREADS
+/*
+    fork() only copies the calling thread, so in a child the pool has no
+    threads, and its lock and queue are in whatever state the other threads
+    of the parent left them. The child does not touch them: it treats the
+    pool as one without threads.
+ */
+static int psWorkerForked(const psWorkerPool_t *wp)
+{
+    return wp->pid != psGetProcessId();
+}
+
+static void psWorkerMain(void *arg)
+{
+    psWorkerPool_t *wp = arg;
+    psWorkerJob_t *job;
+
+    psLockMutex(&wp->lock);
+    for (;; )
+    {
+        while (wp->head == NULL && !wp->shutdown)
+        {
+            psWaitCond(&wp->work, &wp->lock);
+        }
+        if (wp->head == NULL)
+        {
+            /* Shutting down and the queue has been drained */
+            break;
+        }
+        job = wp->head;
+        wp->head = job->next;
+        if (wp->head == NULL)
+        {
+            wp->tail = NULL;
+        }
+        psUnlockMutex(&wp->lock);
+
+        job->func(job->arg);
+
+        psLockMutex(&wp->lock);
+        job->done = 1;
+        psBroadcastCond(&wp->done);
+    }
+    psUnlockMutex(&wp->lock);
+}
+#endif /* PS_HAVE_THREADS */
+
+/******************************************************************************/
+/**
+    Create a worker pool.
+
+    @param[in] pool Memory pool for the worker pool structure.
+    @param[out] wp The new worker pool.
+    @param[in] threads Number of threads to start. Zero, or a library
+    built without thread support, gives a pool that runs every job
+    synchronously in psWorkerPoolSubmit().
+    @return < 0 on failure.
+ */
+int32_t psWorkerPoolOpen(psPool_t *pool, psWorkerPool_t **wp, uint16_t threads)
+{
+    psWorkerPool_t *w;
+
+    if (wp == NULL || threads > PS_WORKER_MAX_THREADS)
+    {
+        return PS_ARG_FAIL;
+    }
+    if ((w = psMalloc(pool, sizeof(psWorkerPool_t))) == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    memset(w, 0x0, sizeof(psWorkerPool_t));
+    w->pool = pool;
+#ifdef PS_HAVE_THREADS
+    w->pid = psGetProcessId();
+    if (psCreateMutex(&w->lock, 0) < 0)
+    {
+        psFree(w, pool);
+        return PS_PLATFORM_FAIL;
+    }
+    if (psCreateCond(&w->work) < 0)
+    {
+        psDestroyMutex(&w->lock);
+        psFree(w, pool);
+        return PS_PLATFORM_FAIL;
+    }
+    if (psCreateCond(&w->done) < 0)
+    {
+        psDestroyCond(&w->work);
+        psDestroyMutex(&w->lock);
+        psFree(w, pool);
+        return PS_PLATFORM_FAIL;
+    }
+    for (w->threads = 0; w->threads < threads; w->threads++)
+    {
+        if (psCreateThread(&w->thread[w->threads], psWorkerMain, w) < 0)
+        {
+            psWorkerPoolClose(w);
+            return PS_PLATFORM_FAIL;
+        }
+    }
+#else
+    PS_VARIABLE_SET_BUT_UNUSED(threads);
+#endif /* PS_HAVE_THREADS */
+    *wp = w;
+    return PS_SUCCESS;
+}
+
+/******************************************************************************/
+/**
+    Stop the worker threads and free the pool.
+    Jobs that are already queued are run to completion first.
+    In a child of the process that opened the pool, only the memory is
+    freed: there are no threads to stop, and jobs queued or running in the
+    parent at the time of the fork never complete.
+ */
+void psWorkerPoolClose(psWorkerPool_t *wp)
+{
+#ifdef PS_HAVE_THREADS
+    uint16_t i;
+#endif
+
+    if (wp == NULL)
+    {
+        return;
+    }
+#ifdef PS_HAVE_THREADS
+    if (psWorkerForked(wp))
+    {
+        psFree(wp, wp->pool);
+        return;
+    }
+    psLockMutex(&wp->lock);
+    wp->shutdown = 1;
+    psBroadcastCond(&wp->work);
+    psUnlockMutex(&wp->lock);
+    for (i = 0; i < wp->threads; i++)
+    {
+        psJoinThread(&wp->thread[i]);
+    }
+    psDestroyCond(&wp->done);
+    psDestroyCond(&wp->work);
+    psDestroyMutex(&wp->lock);
+#endif /* PS_HAVE_THREADS */
+    psFree(wp, wp->pool);
+}
+
+/******************************************************************************/
+/**
+    Queue a job for execution by the pool.
+    If the pool has no threads, is closing, or 'wp' is NULL, the job is
+    run before this function returns. So is every job submitted in a child
+    of the process that opened the pool.
+ */
+int32_t psWorkerPoolSubmit(psWorkerPool_t *wp, psWorkerJob_t *job)
+{
+    if (job == NULL || job->func == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    job->done = 0;
+    job->next = NULL;
+#ifdef PS_HAVE_THREADS
+    if (wp != NULL && wp->threads > 0 && !psWorkerForked(wp))
+    {
+        psLockMutex(&wp->lock);
+        if (!wp->shutdown)
+        {
+            if (wp->tail)
+            {
+                wp->tail->next = job;
+            }
+            else
+            {
+                wp->head = job;
+            }
+            wp->tail = job;
+            psSignalCond(&wp->work);
+            psUnlockMutex(&wp->lock);
+            return PS_SUCCESS;
+        }
+        /* Pool is closing: fall back to running the job here */
+        psUnlockMutex(&wp->lock);
+    }
+#endif /* PS_HAVE_THREADS */
+    job->func(job->arg);
+    job->done = 1;
+    return PS_SUCCESS;
+}
+
+/******************************************************************************/
+/**
+    Block until a submitted job has completed.
+ */
+void psWorkerJobWait(psWorkerPool_t *wp, psWorkerJob_t *job)
+{
+#ifdef PS_HAVE_THREADS
+    if (wp != NULL && wp->threads > 0 && !psWorkerForked(wp))
+    {
+        psLockMutex(&wp->lock);
+        while (!job->done)
+        {
+            psWaitCond(&wp->done, &wp->lock);
+        }
+        psUnlockMutex(&wp->lock);
+        return;
+    }
+#endif /* PS_HAVE_THREADS */
+    psAssert(job->done);
+}
+
+/******************************************************************************/
+/**
+    Number of threads that run the jobs of 'wp'. Zero means every job runs
+    in psWorkerPoolSubmit(), in the thread that submits it.
+ */
+uint16_t psWorkerPoolThreads(const psWorkerPool_t *wp)
+{
+#ifdef PS_HAVE_THREADS
+    if (wp != NULL && !psWorkerForked(wp))
+    {
+        return wp->threads;
+    }
+#else
+    PS_VARIABLE_SET_BUT_UNUSED(wp);
+#endif /* PS_HAVE_THREADS */
+    return 0;
+}
+
+/******************************************************************************/
@@ -573,6 +573,11 @@ PSPUBLIC int32_t psPkcs5Pbkdf1(unsigned char *pass, uint32 passlen,
 PSPUBLIC void psPkcs5Pbkdf2(unsigned char *password, uint32 pLen,
                             unsigned char *salt, uint32 sLen, int32 rounds,
                             unsigned char *key, uint32 kLen);
+PSPUBLIC int32_t psPkcs5Pbkdf2Hmac(psCipherType_e hash,
+                                   const unsigned char *password, uint32 pLen,
+                                   const unsigned char *salt, uint32 sLen,
+                                   int32 rounds, unsigned char *key,
+                                   uint32 kLen);
 # endif /* USE_PKCS5 */
 
 /******************************************************************************/
@@ -592,6 +597,11 @@ PSPUBLIC int32_t psParseUnknownPrivKeyMem(psPool_t *pool,
         const char *password, psPubKey_t *privkey);
 PSPUBLIC int32_t psParseUnknownPubKey(psPool_t *pool, int pemOrDer,
         char *keyfile, const char *password, psPubKey_t *pubkey);
+#  ifdef USE_PUBKEY_PRECOMP
+PSPUBLIC int32_t psPubKeyPrecompute(psPool_t *pool, const psPubKey_t *key,
+        psPubKeyPrecomp_t **precomp);
+PSPUBLIC void psPubKeyPrecompFree(psPubKeyPrecomp_t *precomp);
+#  endif
 # endif
 
 # ifdef USE_RSA
@@ -631,6 +641,18 @@ PSPUBLIC int32_t psRsaCrypt(psPool_t *pool, psRsaKey_t *key,
                             const unsigned char *in, psSize_t inlen,
                             unsigned char *out, psSize_t *outlen,
                             uint8_t type, void *data);
+#  ifdef USE_PUBKEY_PRECOMP
+PSPUBLIC int32_t psRsaDecryptPubExt(psPool_t *pool, psRsaKey_t *key,
+                                    const psPubKeyPrecomp_t *precomp,
+                                    unsigned char *in, psSize_t inlen,
+                                    unsigned char *out, psSize_t outlen,
+                                    void *data);
+PSPUBLIC int32_t psRsaCryptExt(psPool_t *pool, psRsaKey_t *key,
+                               const psPubKeyPrecomp_t *precomp,
+                               const unsigned char *in, psSize_t inlen,
+                               unsigned char *out, psSize_t *outlen,
+                               uint8_t type, void *data);
+#  endif
 
 PSPUBLIC int32_t pubRsaDecryptSignedElement(psPool_t *pool, psRsaKey_t *key,
                                             unsigned char *in, psSize_t inlen,
@@ -693,19 +715,62 @@ PSPUBLIC int32_t psEccX963ImportKey(psPool_t *pool,
                                     psEccKey_t *key, const psEccCurve_t *curve);
 PSPUBLIC int32_t psEccX963ExportKey(psPool_t *pool, const psEccKey_t *key,
                                     unsigned char *out, psSize_t *outlen);
+PSPUBLIC psSize_t psEccX963Size(const psEccCurve_t *curve);
 
 PSPUBLIC int32_t psEccGenSharedSecret(psPool_t *pool,
                                       const psEccKey_t *privKey, const psEccKey_t *pubKey,
                                       unsigned char *outbuf, psSize_t *outlen, void *usrData);
+#  ifdef USE_X25519
+PSPUBLIC int32_t psX25519(unsigned char out[32], const unsigned char scalar[32],
+                          const unsigned char u[32]);
+#  endif
 
 PSPUBLIC int32_t psEccDsaSign(psPool_t *pool, const psEccKey_t *privKey,
                               const unsigned char *buf, psSize_t buflen,
                               unsigned char *sig, psSize_t *siglen,
                               uint8_t includeSize, void *usrData);
+#  ifdef USE_ECDSA_PRESIGN
+PSPUBLIC int32_t psEccNewPresign(psPool_t *pool, const psEccKey_t *privKey,
+                                 uint16_t depth, psEccPresign_t **presign);
+PSPUBLIC void psEccDeletePresign(psEccPresign_t *presign);
+PSPUBLIC int32_t psEccDsaSignExt(psPool_t *pool, const psEccKey_t *privKey,
+                                 psEccPresign_t *presign,
+                                 const unsigned char *buf, psSize_t buflen,
+                                 unsigned char *sig, psSize_t *siglen,
+                                 uint8_t includeSize, void *usrData);
+#  endif
 PSPUBLIC int32_t psEccDsaVerify(psPool_t *pool, const psEccKey_t *key,
                                 const unsigned char *buf, psSize_t bufLen,
                                 const unsigned char *sig, psSize_t siglen,
                                 int32_t *status, void *usrData);
+#  ifdef USE_PUBKEY_PRECOMP
+PSPUBLIC int32_t psEccDsaVerifyExt(psPool_t *pool, const psEccKey_t *key,
+                                   const psPubKeyPrecomp_t *precomp,
+                                   const unsigned char *buf, psSize_t bufLen,
+                                   const unsigned char *sig, psSize_t siglen,
+                                   int32_t *status, void *usrData);
+#  endif
+
+#  ifdef USE_ED25519
+/******************************************************************************/
+/*
+    Ed25519 signatures (RFC 8032). Messages are signed whole, not as digests.
+ */
+PSPUBLIC int32_t psEd25519GenKey(psPool_t *pool, psEd25519Key_t *key,
+                                 void *usrData);
+PSPUBLIC int32_t psEd25519ImportPrivKey(psEd25519Key_t *key,
+                                        const unsigned char seed[ED25519_KEY_SIZE]);
+PSPUBLIC int32_t psEd25519ImportPubKey(psEd25519Key_t *key,
+                                       const unsigned char pub[ED25519_KEY_SIZE]);
+PSPUBLIC void psEd25519ClearKey(psEd25519Key_t *key);
+PSPUBLIC int32_t psEd25519Sign(const psEd25519Key_t *key,
+                               const unsigned char *msg, psSizeL_t msgLen,
+                               unsigned char sig[ED25519_SIG_SIZE]);
+PSPUBLIC int32_t psEd25519Verify(const psEd25519Key_t *key,
+                                 const unsigned char *msg, psSizeL_t msgLen,
+                                 const unsigned char *sig, psSize_t sigLen,
+                                 int32_t *status);
+#  endif
 # endif /* USE_ECC */
 
 # ifdef USE_DH
@@ -726,6 +791,16 @@ PSPUBLIC int32_t psDhExportParameters(psPool_t *pool,
                                       unsigned char **pg, psSize_t *gLen);
 PSPUBLIC void psPkcs3ClearDhParams(psDhParams_t *params);
 
+/* RFC 7919 groups, identified by their TLS NamedGroup value */
+#  define PS_DH_FFDHE2048     0x0100
+#  define PS_DH_FFDHE3072     0x0101
+#  define PS_DH_FFDHE4096     0x0102
+PSPUBLIC int32_t psDhLoadNamedGroup(psPool_t *pool, uint16_t group,
+                                    psDhParams_t *params);
+#  ifdef USE_DH_PRECOMP
+PSPUBLIC int32_t psDhPrecomputeParams(psPool_t *pool, psDhParams_t *params);
+#  endif
+
 PSPUBLIC int32_t psDhImportPubKey(psPool_t *pool,
                                   const unsigned char *inbuf, psSize_t inlen,
                                   psDhKey_t *key);
@@ -733,6 +808,8 @@ PSPUBLIC int32_t psDhExportPubKey(psPool_t *pool, const psDhKey_t *key,
                                   unsigned char *out, psSize_t *outlen);
 PSPUBLIC void psDhClearKey(psDhKey_t *key);
 PSPUBLIC psSize_t psDhSize(const psDhKey_t *key);
+PSPUBLIC int32_t psDhCopyKey(psPool_t *pool, psDhKey_t *to,
+                             const psDhKey_t *from);
 
 PSPUBLIC int32_t psDhGenKey(psPool_t *pool, psSize_t keysize,
                             const unsigned char *pBin, psSize_t pLen,
@@ -741,6 +818,8 @@ PSPUBLIC int32_t psDhGenKey(psPool_t *pool, psSize_t keysize,
 PSPUBLIC int32_t psDhGenKeyInts(psPool_t *pool, psSize_t keysize,
                                 const pstm_int *p, const pstm_int *g,
                                 psDhKey_t *key, void *usrData);
+PSPUBLIC int32_t psDhGenKeyParams(psPool_t *pool, const psDhParams_t *params,
+                                  psDhKey_t *key, void *usrData);
 
 PSPUBLIC int32_t psDhGenSharedSecret(psPool_t *pool,
                                      const psDhKey_t *privKey, const psDhKey_t *pubKey,
@@ -760,12 +839,31 @@ PSPUBLIC int32 psX509ParseCert(psPool_t *pool, const unsigned char *pp, uint32 s
                                psX509Cert_t **outcert, int32 flags);
 PSPUBLIC void psX509FreeCert(psX509Cert_t *cert);
 #  ifdef USE_CERT_PARSE
+PSPUBLIC int32_t psX509DecodeCert(psX509Cert_t *cert);
+PSPUBLIC int32_t psX509DecodeDN(psPool_t *pool, x509DNattributes_t *dn);
 PSPUBLIC int32 psX509GetCertPublicKeyDer(psX509Cert_t *cert,
                                          unsigned char *der_out,
                                          psSize_t *der_out_len);
 PSPUBLIC int32 psX509AuthenticateCert(psPool_t *pool, psX509Cert_t *subjectCert,
                                       psX509Cert_t *issuerCert, psX509Cert_t **foundIssuer,
                                       void *hwCtx, void *poolUserPtr);
+PSPUBLIC int32_t psX509NewCertIndex(psPool_t *pool, psX509Cert_t *certs,
+                                    psX509CertIndex_t **index);
+PSPUBLIC void psX509FreeCertIndex(psX509CertIndex_t *index);
+PSPUBLIC psX509Cert_t *psX509FindIssuerCandidate(
+        const psX509CertIndex_t *index, const psX509Cert_t *subjectCert,
+        psX509CertIndexCursor_t *cursor);
+PSPUBLIC int32_t psX509NewTrustStore(psPool_t *pool, const psX509Cert_t *certs,
+                                     unsigned char **image,
+                                     psSizeL_t *imageLen);
+PSPUBLIC int32_t psX509ParseTrustStore(psPool_t *pool,
+                                       const unsigned char *image,
+                                       psSizeL_t imageLen,
+                                       psX509Cert_t **certs, int32 flags);
+PSPUBLIC psX509Cert_t *psX509ParseDeferred(psX509Cert_t *cert);
+#   ifdef USE_PUBKEY_PRECOMP
+PSPUBLIC void psX509PrecomputeKeys(psX509Cert_t *certs);
+#   endif
 #  endif
 #  ifdef USE_CRL
 #   define CRL_CHECK_EXPECTED  5                    /* cert had a dist point but not fetched yet */
@@ -782,6 +880,18 @@ PSPUBLIC int32 psX509GetCRLVersion(const unsigned char *crlBin,
 PSPUBLIC int32_t psX509ParseCRL(psPool_t *pool, psX509Crl_t **crl,
                                 unsigned char *crlBin, int32 crlBinLen);
 PSPUBLIC void    psX509FreeCRL(psX509Crl_t *crl);
+/* Streaming parse, revoked serials kept in one packed sorted array */
+PSPUBLIC int32_t psX509CrlStreamOpen(psPool_t *pool,
+                                     psX509CrlStream_t **stream);
+PSPUBLIC int32_t psX509CrlStreamUpdate(psX509CrlStream_t *stream,
+                                       const unsigned char *data,
+                                       psSizeL_t len);
+PSPUBLIC int32_t psX509CrlStreamFinal(psX509CrlStream_t *stream,
+                                      psX509Crl_t **crl);
+#   ifdef MATRIX_USE_FILE_SYSTEM
+PSPUBLIC int32_t psX509ParseCRLFile(psPool_t *pool, const char *fileName,
+                                    psX509Crl_t **crl);
+#   endif
 PSPUBLIC int32_t psX509GetCRLdistURL(psX509Cert_t *cert, char **url,
                                      uint32_t *urlLen);
 PSPUBLIC int32_t psX509AuthenticateCRL(psX509Cert_t *CA, psX509Crl_t *CRL,
@@ -795,10 +905,17 @@ PSPUBLIC int psCRL_Delete(psX509Crl_t *crl);
 PSPUBLIC void psCRL_RemoveAll();
 PSPUBLIC void psCRL_DeleteAll();
 PSPUBLIC psX509Crl_t *psCRL_GetCRLForCert(psX509Cert_t *cert);
+PSPUBLIC psX509Crl_t *psCRL_AcquireCRLForCert(psX509Cert_t *cert);
+PSPUBLIC void psCRL_Release(psX509Crl_t *crl);
 PSPUBLIC int32_t psCRL_isRevoked(psX509Cert_t *cert, psX509Crl_t *CRL);
 PSPUBLIC int32_t psCRL_determineRevokedStatus(psX509Cert_t *cert);
 PSPUBLIC int32_t psCRL_determineRevokedStatusBDT(psX509Cert_t *cert,
                                                  psBrokenDownTime_t *bdt);
+#   ifdef MATRIX_USE_FILE_SYSTEM
+PSPUBLIC int32_t psCRL_ReloadFile(psCrlReload_t *reload, psPool_t *pool,
+                                  const char *fileName, psX509Cert_t *CA);
+PSPUBLIC int32_t psCRL_ReloadWait(psCrlReload_t *reload);
+#   endif
 
 #  endif /* USE_CRL */
 # endif  /* USE_X509 */
@@ -67,6 +67,12 @@
 #  endif
 # endif
 
+# ifdef USE_ED25519
+#  if !defined(USE_ECC) || !defined(USE_SHA512)
+#   error "Enable USE_ECC and USE_SHA512 in cryptoConfig.h for USE_ED25519"
+#  endif
+# endif
+
 # ifdef USE_PKCS8
 #  ifndef USE_HMAC_SHA1
 #   error "Enable USE_HMAC_SHA1 in cryptoConfig.h for PKCS8 support"
@@ -105,6 +111,12 @@
 #  endif
 # endif
 
+# ifdef USE_ECDSA_PRESIGN
+#  ifndef USE_ECC
+#   error "Enable USE_ECC in cryptoConfig.h for USE_ECDSA_PRESIGN"
+#  endif
+# endif
+
 # ifdef USE_OCSP
 #  ifndef USE_SHA1
 #   error "Enable USE_SHA1 in cryptoConfig.h for OCSP support"
@@ -103,6 +103,17 @@
  */
 extern int32_t psBase64decode(const unsigned char *in, psSize_t len,
                               unsigned char *out, psSize_t *outlen);
+extern int32_t psPemFindBody(const unsigned char *pem, psSizeL_t pemLen,
+                             const char *label, const unsigned char **body,
+                             psSizeL_t *bodyLen, psSizeL_t *consumed);
+# ifdef USE_SHA1_LANES
+extern void psSha1CompressLanes(uint32_t state[5][4],
+                                const uint32_t block[16][4]);
+# endif
+# ifdef USE_SHA256_LANES
+extern void psSha256CompressLanes(uint32_t state[8][4],
+                                  const uint32_t block[16][4]);
+# endif
 extern void psOpenPrng(void);
 extern void psClosePrng(void);
 extern int32_t psGetPrngLocked(unsigned char *bytes, psSize_t size,
@@ -203,6 +214,8 @@ extern int32_t psGetPrngLocked(unsigned char *bytes, psSize_t size,
 # define OID_SHA512_ECDSA_SIG_STR         "1.2.840.10045.4.3.4"
 # define OID_SHA512_ECDSA_SIG             526
 # define OID_SHA512_ECDSA_SIG_HEX         "\x06\x08\x2A\x86\x48\xCE\x3D\x04\x03\x04"
+/* RFC 8410: the key algorithm identifier also names the signature */
+# define OID_ED25519_SIG                  OID_ED25519_KEY_ALG
 
 /* Public key algorithms */
 # define OID_RSA_KEY_ALG_STR              "1.2.840.113549.1.1.1"
@@ -214,6 +227,9 @@ extern int32_t psGetPrngLocked(unsigned char *bytes, psSize_t size,
 # define OID_ECDSA_KEY_ALG_STR            "1.2.840.10045.2.1"
 # define OID_ECDSA_KEY_ALG                518
 # define OID_ECDSA_KEY_ALG_HEX            "\x06\x07\x2A\x86\x48\xCE\x3D\x02\x01"
+# define OID_ED25519_KEY_ALG_STR          "1.3.101.112"
+# define OID_ED25519_KEY_ALG              256
+# define OID_ED25519_KEY_ALG_HEX          "\x06\x03\x2B\x65\x70"
 
 /* Encryption algorithms */
 # define OID_DES_EDE3_CBC_STR             "1.2.840.113549.3.7"
@@ -272,6 +288,18 @@ extern int32_t psGetPrngLocked(unsigned char *bytes, psSize_t size,
 # define OID_PKCS_PBES2_STR               "1.2.840.113549.1.5.13"
 # define OID_PKCS_PBES2                   (661 + OID_COLLISION)
 # define OID_PKCS_PBES2_HEX               "\x06\x09\x2A\x86\x48\x86\xF7\x0D\x01\x05\x0D"
+# define OID_HMAC_WITH_SHA1_STR           "1.2.840.113549.2.7"
+# define OID_HMAC_WITH_SHA1               (651 + OID_COLLISION)
+# define OID_HMAC_WITH_SHA1_HEX           "\x06\x08\x2A\x86\x48\x86\xF7\x0D\x02\x07"
+# define OID_HMAC_WITH_SHA256_STR         "1.2.840.113549.2.9"
+# define OID_HMAC_WITH_SHA256             (653 + OID_COLLISION)
+# define OID_HMAC_WITH_SHA256_HEX         "\x06\x08\x2A\x86\x48\x86\xF7\x0D\x02\x09"
+# define OID_HMAC_WITH_SHA384_STR         "1.2.840.113549.2.10"
+# define OID_HMAC_WITH_SHA384             (654 + 2 * OID_COLLISION)
+# define OID_HMAC_WITH_SHA384_HEX         "\x06\x08\x2A\x86\x48\x86\xF7\x0D\x02\x0A"
+# define OID_HMAC_WITH_SHA512_STR         "1.2.840.113549.2.11"
+# define OID_HMAC_WITH_SHA512             (655 + 2 * OID_COLLISION)
+# define OID_HMAC_WITH_SHA512_HEX         "\x06\x08\x2A\x86\x48\x86\xF7\x0D\x02\x0B"
 
 # define OID_PKCS_PBESHA128RC4_STR        "1.2.840.113549.1.12.1.1"
 # define OID_PKCS_PBESHA128RC4            657
@@ -733,6 +761,21 @@ extern int32_t psCrlOpen();
 extern void psCrlClose();
 # endif
 
+# if defined(USE_X509) && defined(USE_CERT_PARSE)
+extern int32_t psX509Open(void);
+extern void psX509Close(void);
+# endif
+
+# if defined(USE_MATRIX_ECC) && defined(USE_PUBKEY_PRECOMP)
+extern int32_t psEccCombOpen(void);
+extern void psEccCombClose(void);
+# endif
+
+# if defined(USE_MATRIX_RSA) && defined(USE_RSA_PARALLEL_CRT)
+extern int32_t psRsaParallelCrtOpen(void);
+extern void psRsaParallelCrtClose(void);
+# endif
+
 #endif /* _h_PS_CRYPTOLIB */
 
 /******************************************************************************/
@@ -162,6 +162,79 @@ static void sha1_compress(psSha1_t *sha1)
 }
 # endif /* USE_BURN_STACK */
 
+# ifdef USE_SHA1_LANES
+#  include <emmintrin.h>
+
+#  define L4ROL(x, n)   _mm_or_si128(_mm_slli_epi32(x, n), _mm_srli_epi32(x, 32 - (n)))
+
+/*
+    Compress one block in each of four independent states.  Lane j of the
+    computation uses state[i][j] and message words block[i][j], the words
+    already converted from big endian.
+ */
+void psSha1CompressLanes(uint32_t state[5][4], const uint32_t block[16][4])
+{
+    __m128i W[80], S[5], f, k, t;
+    int32 i;
+
+    for (i = 0; i < 16; i++)
+    {
+        W[i] = _mm_loadu_si128((const __m128i *) block[i]);
+    }
+    for (i = 16; i < 80; i++)
+    {
+        W[i] = L4ROL(_mm_xor_si128(_mm_xor_si128(W[i - 3], W[i - 8]),
+                _mm_xor_si128(W[i - 14], W[i - 16])), 1);
+    }
+    for (i = 0; i < 5; i++)
+    {
+        S[i] = _mm_loadu_si128((const __m128i *) state[i]);
+    }
+    for (i = 0; i < 80; i++)
+    {
+        if (i < 20)
+        {
+            /* F0 */
+            f = _mm_xor_si128(S[3], _mm_and_si128(S[1],
+                    _mm_xor_si128(S[2], S[3])));
+            k = _mm_set1_epi32(0x5a827999UL);
+        }
+        else if (i < 40)
+        {
+            f = _mm_xor_si128(_mm_xor_si128(S[1], S[2]), S[3]);
+            k = _mm_set1_epi32(0x6ed9eba1UL);
+        }
+        else if (i < 60)
+        {
+            /* F2 */
+            f = _mm_or_si128(_mm_and_si128(S[1], S[2]),
+                _mm_and_si128(S[3], _mm_or_si128(S[1], S[2])));
+            k = _mm_set1_epi32((int) 0x8f1bbcdcUL);
+        }
+        else
+        {
+            f = _mm_xor_si128(_mm_xor_si128(S[1], S[2]), S[3]);
+            k = _mm_set1_epi32((int) 0xca62c1d6UL);
+        }
+        t = _mm_add_epi32(_mm_add_epi32(L4ROL(S[0], 5), f),
+            _mm_add_epi32(_mm_add_epi32(S[4], k), W[i]));
+        S[4] = S[3];
+        S[3] = S[2];
+        S[2] = L4ROL(S[1], 30);
+        S[1] = S[0];
+        S[0] = t;
+    }
+    for (i = 0; i < 5; i++)
+    {
+        _mm_storeu_si128((__m128i *) state[i], _mm_add_epi32(S[i],
+                _mm_loadu_si128((const __m128i *) state[i])));
+    }
+#  ifdef USE_BURN_STACK
+    memset_s(W, sizeof(W), 0x0, sizeof(W));
+#  endif
+}
+# endif /* USE_SHA1_LANES */
+
 /******************************************************************************/
 
 int32_t psSha1Init(psSha1_t *sha1)
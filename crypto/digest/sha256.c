@@ -208,6 +208,73 @@ static void sha256_compress(psSha256_t *sha256, const unsigned char *buf)
 }
 # endif /* USE_BURN_STACK */
 
+# ifdef USE_SHA256_LANES
+#  include <emmintrin.h>
+
+#  define L4ROR(x, n)   _mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32 - (n)))
+#  define L4XOR3(x, y, z) _mm_xor_si128(_mm_xor_si128(x, y), z)
+
+/*
+    Compress one block in each of four independent states.  Lane j of the
+    computation uses state[i][j] and message words block[i][j], the words
+    already converted from big endian.
+ */
+void psSha256CompressLanes(uint32_t state[8][4], const uint32_t block[16][4])
+{
+    __m128i W[64], S[8], t0, t1;
+    int32 i;
+
+    for (i = 0; i < 16; i++)
+    {
+        W[i] = _mm_loadu_si128((const __m128i *) block[i]);
+    }
+    for (i = 16; i < 64; i++)
+    {
+        t0 = L4XOR3(L4ROR(W[i - 2], 17), L4ROR(W[i - 2], 19),
+            _mm_srli_epi32(W[i - 2], 10));
+        t1 = L4XOR3(L4ROR(W[i - 15], 7), L4ROR(W[i - 15], 18),
+            _mm_srli_epi32(W[i - 15], 3));
+        W[i] = _mm_add_epi32(_mm_add_epi32(t0, W[i - 7]),
+            _mm_add_epi32(t1, W[i - 16]));
+    }
+    for (i = 0; i < 8; i++)
+    {
+        S[i] = _mm_loadu_si128((const __m128i *) state[i]);
+    }
+    for (i = 0; i < 64; i++)
+    {
+        /* t0 = h + Sigma1(e) + Ch(e, f, g) + K[i] + W[i] */
+        t0 = _mm_add_epi32(S[7], L4XOR3(L4ROR(S[4], 6), L4ROR(S[4], 11),
+                L4ROR(S[4], 25)));
+        t0 = _mm_add_epi32(t0, _mm_xor_si128(S[6],
+                _mm_and_si128(S[4], _mm_xor_si128(S[5], S[6]))));
+        t0 = _mm_add_epi32(t0, _mm_add_epi32(W[i],
+                _mm_set1_epi32((int) K[i])));
+        /* t1 = Sigma0(a) + Maj(a, b, c) */
+        t1 = _mm_add_epi32(L4XOR3(L4ROR(S[0], 2), L4ROR(S[0], 13),
+                L4ROR(S[0], 22)),
+            _mm_or_si128(_mm_and_si128(_mm_or_si128(S[0], S[1]), S[2]),
+                _mm_and_si128(S[0], S[1])));
+        S[7] = S[6];
+        S[6] = S[5];
+        S[5] = S[4];
+        S[4] = _mm_add_epi32(S[3], t0);
+        S[3] = S[2];
+        S[2] = S[1];
+        S[1] = S[0];
+        S[0] = _mm_add_epi32(t0, t1);
+    }
+    for (i = 0; i < 8; i++)
+    {
+        _mm_storeu_si128((__m128i *) state[i], _mm_add_epi32(S[i],
+                _mm_loadu_si128((const __m128i *) state[i])));
+    }
+#  ifdef USE_BURN_STACK
+    memset_s(W, sizeof(W), 0x0, sizeof(W));
+#  endif
+}
+# endif /* USE_SHA256_LANES */
+
 /******************************************************************************/
 
 int32_t psSha256Init(psSha256_t *sha256)
@@ -533,6 +533,7 @@ static void checkAsnOidDatabase(int32_t *oi,
         case OID_RSA_KEY_ALG: oid_hex = OID_RSA_KEY_ALG_HEX; break;
         case OID_DSA_KEY_ALG: oid_hex = OID_DSA_KEY_ALG_HEX; break;
         case OID_ECDSA_KEY_ALG: oid_hex = OID_ECDSA_KEY_ALG_HEX; break;
+        case OID_ED25519_KEY_ALG: oid_hex = OID_ED25519_KEY_ALG_HEX; break;
         case OID_DES_EDE3_CBC: oid_hex = OID_DES_EDE3_CBC_HEX; break;
         case OID_AES_128_CBC: oid_hex = OID_AES_128_CBC_HEX; break;
         case OID_AES_128_WRAP: oid_hex = OID_AES_128_WRAP_HEX; break;
@@ -550,6 +551,10 @@ static void checkAsnOidDatabase(int32_t *oi,
         case OID_AUTH_ENC_256_SUM: oid_hex = OID_AUTH_ENC_256_SUM_HEX; break;
         case OID_PKCS_PBKDF2: oid_hex = OID_PKCS_PBKDF2_HEX; break;
         case OID_PKCS_PBES2: oid_hex = OID_PKCS_PBES2_HEX; break;
+        case OID_HMAC_WITH_SHA1: oid_hex = OID_HMAC_WITH_SHA1_HEX; break;
+        case OID_HMAC_WITH_SHA256: oid_hex = OID_HMAC_WITH_SHA256_HEX; break;
+        case OID_HMAC_WITH_SHA384: oid_hex = OID_HMAC_WITH_SHA384_HEX; break;
+        case OID_HMAC_WITH_SHA512: oid_hex = OID_HMAC_WITH_SHA512_HEX; break;
         case OID_PKCS_PBESHA128RC4: oid_hex = OID_PKCS_PBESHA128RC4_HEX; break;
         case OID_PKCS_PBESHA40RC4: oid_hex = OID_PKCS_PBESHA40RC4_HEX; break;
         case OID_PKCS_PBESHA3DES3: oid_hex = OID_PKCS_PBESHA3DES3_HEX; break;
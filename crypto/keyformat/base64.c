@@ -36,6 +36,27 @@
 
 #ifdef USE_BASE64_DECODE
 
+/*
+    Vector decoding of runs of the base64 alphabet.  On x86 the SSSE3 and
+    AVX2 paths are compiled for their own targets whatever the build flags,
+    and picked from the CPUID features at runtime, so a default build uses
+    them where the CPU has them and the scalar loop elsewhere.  NEON, when
+    the compiler targets it, takes a whole 64 character PEM line per step.
+    Any block holding another character is left to the scalar loop, so the
+    result is always identical to it.  Define DISABLE_BASE64_SIMD for the
+    scalar loop only.
+ */
+# ifndef DISABLE_BASE64_SIMD
+#  if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && \
+    (__GNUC__ >= 5 || defined(__clang__))
+#   include <immintrin.h>
+#   define BASE64_X86
+#  elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   include <arm_neon.h>
+#   define BASE64_NEON
+#  endif
+# endif
+
 static const unsigned char map[] = {
     255, 255, 255, 255,  255,  255,  255, 255,  255,   255,   255,   255,
     255, 255, 255, 255,  255,  255,  255, 255,  255,   255,   255,   255,
@@ -63,6 +84,199 @@ static const unsigned char map[] = {
  */
 };
 
+# ifdef BASE64_X86
+/* Map 16 characters to their sextets.  Returns 0 if any is not base64 */
+__attribute__((target("ssse3")))
+static int32_t base64Sextets128(__m128i in, __m128i *sextets)
+{
+    __m128i upper, lower, digit, plus, slash, delta;
+
+    /* Signed compares, so bytes 0x80 and above fail every range */
+    upper = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('A' - 1)),
+        _mm_cmplt_epi8(in, _mm_set1_epi8('Z' + 1)));
+    lower = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('a' - 1)),
+        _mm_cmplt_epi8(in, _mm_set1_epi8('z' + 1)));
+    digit = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('0' - 1)),
+        _mm_cmplt_epi8(in, _mm_set1_epi8('9' + 1)));
+    plus = _mm_cmpeq_epi8(in, _mm_set1_epi8('+'));
+    slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+    if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(upper, lower),
+                _mm_or_si128(digit, _mm_or_si128(plus, slash)))) != 0xFFFF)
+    {
+        return 0;
+    }
+    delta = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-65)),
+            _mm_and_si128(lower, _mm_set1_epi8(-71))),
+        _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(4)),
+            _mm_or_si128(_mm_and_si128(plus, _mm_set1_epi8(19)),
+                _mm_and_si128(slash, _mm_set1_epi8(16)))));
+    *sextets = _mm_add_epi8(in, delta);
+    return 1;
+}
+
+/* Pack 16 sextets into 12 bytes at out */
+__attribute__((target("ssse3")))
+static void base64Pack128(__m128i sextets, unsigned char *out)
+{
+    __m128i t;
+    int32_t tail;
+
+    /* a << 6 | b and c << 6 | d in each 16 bit lane, then the 24 bit
+       quantum in each 32 bit lane, then its bytes in big endian order */
+    t = _mm_maddubs_epi16(sextets, _mm_set1_epi32(0x01400140));
+    t = _mm_madd_epi16(t, _mm_set1_epi32(0x00011000));
+    t = _mm_shuffle_epi8(t, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+            14, 13, 12, -1, -1, -1, -1));
+    _mm_storel_epi64((__m128i *) out, t);
+    tail = _mm_cvtsi128_si32(_mm_srli_si128(t, 8));
+    memcpy(out + 8, &tail, 4);
+}
+
+/* 16 characters to 12 bytes per step, from n on */
+__attribute__((target("ssse3")))
+static psSizeL_t base64DecodeSsse3(const unsigned char *in, psSizeL_t inLen,
+    unsigned char *out, psSizeL_t outLen, psSizeL_t n)
+{
+    __m128i v;
+
+    for (; inLen - n >= 16 && outLen - n / 4 * 3 >= 12; n += 16)
+    {
+        if (!base64Sextets128(_mm_loadu_si128((const __m128i *) (in + n)), &v))
+        {
+            break;
+        }
+        base64Pack128(v, out + n / 4 * 3);
+    }
+    return n;
+}
+
+/* As the SSSE3 path, 32 characters to 24 bytes per step */
+__attribute__((target("avx2")))
+static psSizeL_t base64DecodeAvx2(const unsigned char *in, psSizeL_t inLen,
+    unsigned char *out, psSizeL_t outLen)
+{
+    __m256i v, upper, lower, digit, plus, slash, delta;
+    psSizeL_t n;
+
+    for (n = 0; inLen - n >= 32 && outLen - n / 4 * 3 >= 24; n += 32)
+    {
+        v = _mm256_loadu_si256((const __m256i *) (in + n));
+        upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+            _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+        lower = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('a' - 1)),
+            _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), v));
+        digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+            _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+        plus = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('+'));
+        slash = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/'));
+        if (_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(upper, lower),
+                    _mm256_or_si256(digit, _mm256_or_si256(plus, slash)))) != -1)
+        {
+            break;
+        }
+        delta = _mm256_or_si256(
+            _mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-65)),
+                _mm256_and_si256(lower, _mm256_set1_epi8(-71))),
+            _mm256_or_si256(_mm256_and_si256(digit, _mm256_set1_epi8(4)),
+                _mm256_or_si256(_mm256_and_si256(plus, _mm256_set1_epi8(19)),
+                    _mm256_and_si256(slash, _mm256_set1_epi8(16)))));
+        v = _mm256_add_epi8(v, delta);
+        v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+        v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(2, 1, 0, 6, 5, 4,
+                10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        /* Close the gap between the 12 bytes of each 128 bit lane */
+        v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6,
+                7, 7));
+        _mm_storeu_si128((__m128i *) (out + n / 4 * 3),
+            _mm256_castsi256_si128(v));
+        _mm_storel_epi64((__m128i *) (out + n / 4 * 3 + 16),
+            _mm256_extracti128_si256(v, 1));
+    }
+    return n;
+}
+# endif /* BASE64_X86 */
+
+# ifdef BASE64_NEON
+/* Map 16 characters to their sextets.  Returns 0 if any is not base64 */
+static int32_t base64SextetsNeon(uint8x16_t in, uint8x16_t *sextets)
+{
+    uint8x16_t upper, lower, digit, plus, slash, valid, delta;
+    uint8x8_t fold;
+
+    upper = vcltq_u8(vsubq_u8(in, vdupq_n_u8('A')), vdupq_n_u8(26));
+    lower = vcltq_u8(vsubq_u8(in, vdupq_n_u8('a')), vdupq_n_u8(26));
+    digit = vcltq_u8(vsubq_u8(in, vdupq_n_u8('0')), vdupq_n_u8(10));
+    plus = vceqq_u8(in, vdupq_n_u8('+'));
+    slash = vceqq_u8(in, vdupq_n_u8('/'));
+    valid = vorrq_u8(vorrq_u8(upper, lower),
+        vorrq_u8(digit, vorrq_u8(plus, slash)));
+    fold = vand_u8(vget_low_u8(valid), vget_high_u8(valid));
+    if (vget_lane_u64(vreinterpret_u64_u8(fold), 0) != ~(uint64_t) 0)
+    {
+        return 0;
+    }
+    delta = vorrq_u8(
+        vorrq_u8(vandq_u8(upper, vdupq_n_u8((uint8_t) -65)),
+            vandq_u8(lower, vdupq_n_u8((uint8_t) -71))),
+        vorrq_u8(vandq_u8(digit, vdupq_n_u8(4)),
+            vorrq_u8(vandq_u8(plus, vdupq_n_u8(19)),
+                vandq_u8(slash, vdupq_n_u8(16)))));
+    *sextets = vaddq_u8(in, delta);
+    return 1;
+}
+# endif /* BASE64_NEON */
+
+# if defined(BASE64_X86) || defined(BASE64_NEON)
+/*
+    Decode the leading blocks of in that are made only of the base64
+    alphabet, stopping before any that would overrun outLen.  Returns the
+    number of characters consumed, a multiple of 4 that has produced 3/4 as
+    many bytes at out.
+ */
+static psSizeL_t base64DecodeBlocks(const unsigned char *in, psSizeL_t inLen,
+    unsigned char *out, psSizeL_t outLen)
+{
+    psSizeL_t n = 0;
+
+#  ifdef BASE64_X86
+    /* CPUID features as probed once by the compiler runtime at startup */
+    if (__builtin_cpu_supports("avx2"))
+    {
+        n = base64DecodeAvx2(in, inLen, out, outLen);
+    }
+    if (__builtin_cpu_supports("ssse3"))
+    {
+        n = base64DecodeSsse3(in, inLen, out, outLen, n);
+    }
+#  else
+    uint8x16x4_t c;
+    uint8x16x3_t o;
+
+    for (; inLen - n >= 64 && outLen - n / 4 * 3 >= 48; n += 64)
+    {
+        /* Lane i of c.val[0..3] is the i'th 4 character quantum */
+        c = vld4q_u8(in + n);
+        if (!base64SextetsNeon(c.val[0], &c.val[0]) ||
+            !base64SextetsNeon(c.val[1], &c.val[1]) ||
+            !base64SextetsNeon(c.val[2], &c.val[2]) ||
+            !base64SextetsNeon(c.val[3], &c.val[3]))
+        {
+            break;
+        }
+        o.val[0] = vorrq_u8(vshlq_n_u8(c.val[0], 2), vshrq_n_u8(c.val[1], 4));
+        o.val[1] = vorrq_u8(vshlq_n_u8(c.val[1], 4), vshrq_n_u8(c.val[2], 2));
+        o.val[2] = vorrq_u8(vshlq_n_u8(c.val[2], 6), c.val[3]);
+        vst3q_u8(out + n / 4 * 3, o);
+    }
+#  endif
+    return n;
+}
+#  define BASE64_SIMD
+# endif /* BASE64_X86 || BASE64_NEON */
+
 int32_t psBase64decode(const unsigned char *in, psSize_t len,
     unsigned char *out, psSize_t *outlen)
 {
@@ -70,6 +284,9 @@ int32_t psBase64decode(const unsigned char *in, psSize_t len,
     unsigned char c;
     uint16_t x, y, z;
     int16_t g;
+# ifdef BASE64_SIMD
+    psSizeL_t n;
+# endif
 
     if (in == NULL || out == NULL || outlen == NULL)
     {
@@ -79,6 +296,19 @@ int32_t psBase64decode(const unsigned char *in, psSize_t len,
     g = 3;
     for (x = y = z = t = 0; x < len; x++)
     {
+# ifdef BASE64_SIMD
+        /* Between quanta, and so at the start of each PEM line */
+        if (y == 0 && g == 3)
+        {
+            n = base64DecodeBlocks(in + x, len - x, out + z, *outlen - z);
+            x += (uint16_t) n;
+            z += (uint16_t) (n / 4 * 3);
+            if (x == len)
+            {
+                break;
+            }
+        }
+# endif
         /* Save a little space by skipping values that would be 255 in the full map */
         if (in[x] > 122)
         {
@@ -137,6 +367,115 @@ int32_t psBase64decode(const unsigned char *in, psSize_t len,
     return PS_SUCCESS;
 }
 
+/******************************************************************************/
+/*
+    PEM block location.  Boundary lines are only recognised at the start of
+    a line, so everything else is skipped a line at a time with memchr.
+ */
+static const unsigned char *pemNextLine(const unsigned char *p,
+    const unsigned char *end)
+{
+    const unsigned char *nl;
+
+    nl = memchr(p, '\n', end - p);
+    return nl ? nl + 1 : end;
+}
+
+/* Is the line at p "-----<kind> <label>-----", with optional blanks around */
+static int32_t pemBoundary(const unsigned char *p, const unsigned char *end,
+    const char *kind, const unsigned char **label, psSizeL_t *labelLen)
+{
+    const unsigned char *eol;
+    psSizeL_t kindLen;
+
+    eol = pemNextLine(p, end);
+    while (eol > p && (eol[-1] == '\n' || eol[-1] == '\r' ||
+                       eol[-1] == ' ' || eol[-1] == '\t'))
+    {
+        eol--;
+    }
+    while (p < eol && (*p == ' ' || *p == '\t'))
+    {
+        p++;
+    }
+    kindLen = strlen(kind);
+    if ((psSizeL_t) (eol - p) < 10 + kindLen + 1 ||
+        memcmp(p, "-----", 5) != 0 || memcmp(p + 5, kind, kindLen) != 0 ||
+        p[5 + kindLen] != ' ' || memcmp(eol - 5, "-----", 5) != 0)
+    {
+        return 0;
+    }
+    *label = p + 5 + kindLen + 1;
+    *labelLen = (eol - 5) - *label;
+    return 1;
+}
+
+/*
+    Find the first PEM block in pem whose label ends with the word(s) in
+    label, so "CERTIFICATE" also matches "TRUSTED CERTIFICATE" and
+    "PRIVATE KEY" matches "RSA PRIVATE KEY".  A NULL label matches any.
+
+    On success body and bodyLen give the encoded text between the boundary
+    lines, ready for psBase64decode, and consumed is the length of pem up to
+    and including the END line.  Returns PS_FAILURE if there is no further
+    block, or PS_PARSE_FAIL if the block is not terminated by a matching
+    END line.
+ */
+int32_t psPemFindBody(const unsigned char *pem, psSizeL_t pemLen,
+    const char *label, const unsigned char **body, psSizeL_t *bodyLen,
+    psSizeL_t *consumed)
+{
+    const unsigned char *end, *p, *q, *lbl, *endLbl;
+    psSizeL_t wantLen, lblLen, endLblLen;
+
+    if (pem == NULL || body == NULL || bodyLen == NULL || consumed == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    wantLen = label ? strlen(label) : 0;
+    end = pem + pemLen;
+    for (p = pem; p < end; p = pemNextLine(p, end))
+    {
+        if (*p != '-' && *p != ' ' && *p != '\t')
+        {
+            continue;
+        }
+        if (!pemBoundary(p, end, "BEGIN", &lbl, &lblLen) ||
+            lblLen < wantLen ||
+            memcmp(lbl + lblLen - wantLen, label, wantLen) != 0 ||
+            (lblLen > wantLen && wantLen > 0 &&
+             lbl[lblLen - wantLen - 1] != ' '))
+        {
+            continue;
+        }
+        *body = pemNextLine(p, end);
+        for (q = *body; q < end; q = pemNextLine(q, end))
+        {
+            if (*q != '-' && *q != ' ' && *q != '\t')
+            {
+                continue;
+            }
+            if (!memchr(q, '-', pemNextLine(q, end) - q))
+            {
+                continue;
+            }
+            /* Base64 has no '-', so this must be our END line */
+            if (!pemBoundary(q, end, "END", &endLbl, &endLblLen) ||
+                endLblLen != lblLen || memcmp(endLbl, lbl, lblLen) != 0)
+            {
+                psTraceCrypto("PEM block has no matching END line\n");
+                return PS_PARSE_FAIL;
+            }
+            *bodyLen = q - *body;
+            *consumed = pemNextLine(q, end) - pem;
+            return PS_SUCCESS;
+        }
+        psTraceCrypto("PEM block has no END line\n");
+        return PS_PARSE_FAIL;
+    }
+    return PS_FAILURE;
+}
+
 #endif /* USE_BASE64_DECODE */
 
 /******************************************************************************/
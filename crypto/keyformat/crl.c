@@ -36,9 +36,45 @@
 #ifdef USE_CRL
 # ifdef USE_CERT_PARSE
 
-#  ifdef USE_MULTITHREADING
+/* Revocation checks only read the CRL table, so where the platform has
+    reader/writer locks they run concurrently.  Changes to the table, and
+    the rare lookups that update the expired or authenticated state of a
+    CRL, take the lock exclusively. */
+#  if defined(USE_MULTITHREADING) && defined(PS_HAVE_RWLOCK)
+static psRwLock_t g_crlTableLock;
+#   define CRL_CREATE_LOCK()   psCreateRwLock(&g_crlTableLock)
+#   define CRL_DESTROY_LOCK()  psDestroyRwLock(&g_crlTableLock)
+#   define CRL_READ_LOCK()     psReadLock(&g_crlTableLock)
+#   define CRL_READ_UNLOCK()   psReadUnlock(&g_crlTableLock)
+#   define CRL_WRITE_LOCK()    psWriteLock(&g_crlTableLock)
+#   define CRL_WRITE_UNLOCK()  psWriteUnlock(&g_crlTableLock)
+#  elif defined(USE_MULTITHREADING)
 static psMutex_t g_crlTableLock;
-#  endif
+#   define CRL_CREATE_LOCK()   psCreateMutex(&g_crlTableLock, 0)
+#   define CRL_DESTROY_LOCK()  psDestroyMutex(&g_crlTableLock)
+#   define CRL_READ_LOCK()     psLockMutex(&g_crlTableLock)
+#   define CRL_READ_UNLOCK()   psUnlockMutex(&g_crlTableLock)
+#   define CRL_WRITE_LOCK()    psLockMutex(&g_crlTableLock)
+#   define CRL_WRITE_UNLOCK()  psUnlockMutex(&g_crlTableLock)
+#  else
+#   define CRL_CREATE_LOCK()
+#   define CRL_DESTROY_LOCK()
+#   define CRL_READ_LOCK()
+#   define CRL_READ_UNLOCK()
+#   define CRL_WRITE_LOCK()
+#   define CRL_WRITE_UNLOCK()
+#  endif /* USE_MULTITHREADING */
+
+/* The refs counts of psCRL_AcquireCRLForCert change with the table only
+    read-locked, so they have a lock of their own */
+#  ifdef USE_MULTITHREADING
+static psMutex_t g_crlRefLock;
+#   define CRL_REF_LOCK()      psLockMutex(&g_crlRefLock)
+#   define CRL_REF_UNLOCK()    psUnlockMutex(&g_crlRefLock)
+#  else
+#   define CRL_REF_LOCK()
+#   define CRL_REF_UNLOCK()
+#  endif /* USE_MULTITHREADING */
 
 /* Seems like many CRLs are not adhering to the specification that this
     extension be present.  That just leaves us with the DN to match against
@@ -52,12 +88,146 @@ static void internalFreeCRL(psX509Crl_t *crl);
     psX509Crl_t structure represents a single CRL file */
 static psX509Crl_t *g_CRL = NULL;
 
+/* The same CRLs hashed on the issuer DN, each bucket in g_CRL order and
+    linked through bucketNext.  Indexed by the first octet of the DN hash */
+#  define CRL_TABLE_BUCKETS 256
+static psX509Crl_t *g_crlBuckets[CRL_TABLE_BUCKETS];
+
+static psX509Crl_t **crlBucket(const char *issuerHash)
+{
+    return &g_crlBuckets[(unsigned char) issuerHash[0]];
+}
+
+/* Order of revokedIndex: by length, then by octets */
+static int crlSerialCmp(const unsigned char *a, psSize_t aLen,
+    const unsigned char *b, psSize_t bLen)
+{
+    if (aLen != bLen)
+    {
+        return aLen < bLen ? -1 : 1;
+    }
+    return aLen > 0 ? memcmp(a, b, aLen) : 0;
+}
+
+static int crlRevokedCmp(const void *a, const void *b)
+{
+    const x509revoked_t *ra = *(x509revoked_t *const *) a;
+    const x509revoked_t *rb = *(x509revoked_t *const *) b;
+
+    return crlSerialCmp(ra->serial, ra->serialLen, rb->serial, rb->serialLen);
+}
+
+/* Sort the revoked entries of a parsed CRL for binary search */
+static int32_t crlIndexRevoked(psX509Crl_t *crl)
+{
+    x509revoked_t *entry;
+    uint32_t i;
+
+    crl->revokedCount = 0;
+    for (entry = crl->revoked; entry != NULL; entry = entry->next)
+    {
+        crl->revokedCount++;
+    }
+    if (crl->revokedCount == 0)
+    {
+        return PS_SUCCESS;
+    }
+    crl->revokedIndex = psMalloc(crl->pool,
+        crl->revokedCount * sizeof(x509revoked_t *));
+    if (crl->revokedIndex == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    for (i = 0, entry = crl->revoked; entry != NULL; entry = entry->next)
+    {
+        crl->revokedIndex[i++] = entry;
+    }
+    qsort(crl->revokedIndex, crl->revokedCount, sizeof(x509revoked_t *),
+        crlRevokedCmp);
+    return PS_SUCCESS;
+}
+
+/* Records of packedRevoked, as built by psX509CrlStreamUpdate: serial
+    length, serial, revocationDate tag, length and text.  RFC 5280 allows
+    at most 20 serial octets and no fractional seconds.  Entries with longer
+    serials are not kept but counted in longRevoked, and certificates with
+    such serials are then taken as revoked.  Other entries that do not fit
+    are refused rather than truncated */
+#  define CRL_REC_SERIAL_MAX  21    /* 20 octets and a sign octet */
+#  define CRL_REC_TIME_MAX    15    /* YYYYMMDDHHMMSSZ */
+#  define CRL_REC_SERIAL      1
+#  define CRL_REC_TIMETAG     (CRL_REC_SERIAL + CRL_REC_SERIAL_MAX)
+#  define CRL_REC_TIMELEN     (CRL_REC_TIMETAG + 1)
+#  define CRL_REC_TIME        (CRL_REC_TIMELEN + 1)
+#  define CRL_REC_SIZE        (CRL_REC_TIME + CRL_REC_TIME_MAX)
+
+static int crlPackedCmp(const void *a, const void *b)
+{
+    const unsigned char *ra = a;
+    const unsigned char *rb = b;
+
+    return crlSerialCmp(ra + CRL_REC_SERIAL, ra[0], rb + CRL_REC_SERIAL, rb[0]);
+}
+
+static int32_t crlPackedIsRevoked(psX509Crl_t *crl, psX509Cert_t *cert,
+    psBrokenDownTime_t *bdt)
+{
+    const unsigned char *rec;
+    uint32_t lo, hi, mid;
+    int cmp;
+
+    if (cert->serialNumberLen > CRL_REC_SERIAL_MAX && crl->longRevoked > 0)
+    {
+        /* Might be one of the entries that were not kept */
+        if (bdt)
+        {
+            memcpy(bdt, &crl->thisUpdateBDT, sizeof(psBrokenDownTime_t));
+        }
+        return 1;
+    }
+    lo = 0;
+    hi = crl->revokedCount;
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        rec = crl->packedRevoked + (size_t) mid * CRL_REC_SIZE;
+        cmp = crlSerialCmp(cert->serialNumber, cert->serialNumberLen,
+            rec + CRL_REC_SERIAL, rec[0]);
+        if (cmp == 0)
+        {
+            if (bdt)
+            {
+                /* Validated when the record was added */
+                psBrokenDownTimeImport(bdt,
+                    (const char *) rec + CRL_REC_TIME, rec[CRL_REC_TIMELEN],
+                    rec[CRL_REC_TIMETAG] == ASN_UTCTIME ?
+                    PS_BROKENDOWN_TIME_IMPORT_2DIGIT_YEAR : 0);
+            }
+            return 1; /* REVOKED! */
+        }
+        if (cmp < 0)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+    return 0;
+}
+
+#  ifdef MATRIX_USE_FILE_SYSTEM
+/* Runs psCRL_ReloadFile jobs, opened on first use */
+static psWorkerPool_t *g_crlWorker = NULL;
+#  endif
 
 /* Invoked from psCryptoOpen */
 int32_t psCrlOpen()
 {
+    CRL_CREATE_LOCK();
 #  ifdef USE_MULTITHREADING
-    psCreateMutex(&g_crlTableLock, 0);
+    psCreateMutex(&g_crlRefLock, 0);
 #  endif
     return PS_SUCCESS;
 }
@@ -65,16 +235,22 @@ int32_t psCrlOpen()
 /* Invoked from psCryptoClose */
 void psCrlClose()
 {
+#  ifdef MATRIX_USE_FILE_SYSTEM
+    /* Lets queued reloads finish, they take the table lock */
+    psWorkerPoolClose(g_crlWorker);
+    g_crlWorker = NULL;
+#  endif
     psCRL_DeleteAll();
+    CRL_DESTROY_LOCK();
 #  ifdef USE_MULTITHREADING
-    psDestroyMutex(&g_crlTableLock);
+    psDestroyMutex(&g_crlRefLock);
 #  endif
 }
 
 /* Helper for CRL insert */
 static int internalCRLInsert(psX509Crl_t *crl)
 {
-    psX509Crl_t *next;
+    psX509Crl_t *next, **link;
 
     if (crl == NULL)
     {
@@ -85,23 +261,30 @@ static int internalCRLInsert(psX509Crl_t *crl)
     {
         /* first one */
         g_CRL = crl;
-        return 1;
-    }
-    /* append */
-    next = g_CRL;
-    if (g_CRL == crl)
-    {
-        return 0; /* no pointer dups */
     }
-    while (next->next)
+    else
     {
-        next = next->next;
-        if (next == crl)   /* no pointer dups */
+        /* append */
+        next = g_CRL;
+        if (g_CRL == crl)
+        {
+            return 0; /* no pointer dups */
+        }
+        while (next->next)
         {
-            return 0;
+            next = next->next;
+            if (next == crl)   /* no pointer dups */
+            {
+                return 0;
+            }
         }
+        next->next = crl;
+    }
+    for (link = crlBucket(crl->issuer.hash); *link; link = &(*link)->bucketNext)
+    {
     }
-    next->next = crl;
+    *link = crl;
+    crl->bucketNext = NULL;
     return 1;
 }
 
@@ -111,22 +294,19 @@ int psCRL_Insert(psX509Crl_t *crl)
 {
     int rc;
 
-#  ifdef USE_MULTITHREADING
-    psLockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
+    CRL_WRITE_LOCK();
 
     rc = internalCRLInsert(crl);
 
-#  ifdef USE_MULTITHREADING
-    psUnlockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
+    CRL_WRITE_UNLOCK();
     return rc;
 }
 
 /* Helper for Remove and Delete to take a CRL out of g_CRL */
 static int internalShrinkCRLtable(psX509Crl_t *crl, int delete)
 {
-    psX509Crl_t *prev, *curr, *next;
+    psX509Crl_t *prev, *curr, *next, **link;
+    uint32_t refs;
 
     /* Return whether or not it was found in the list to help with the
         standalone psX509FreeCRL call logic */
@@ -142,7 +322,23 @@ static int internalShrinkCRLtable(psX509Crl_t *crl, int delete)
     {
         if (curr == crl)
         {
+            for (link = crlBucket(crl->issuer.hash); *link != crl;
+                 link = &(*link)->bucketNext)
+            {
+            }
+            *link = crl->bucketNext;
+            crl->bucketNext = NULL;
+            refs = 0;
             if (delete)
+            {
+                /* If still held from psCRL_AcquireCRLForCert, the last
+                    psCRL_Release frees it */
+                CRL_REF_LOCK();
+                refs = crl->refs;
+                crl->deleted = 1;
+                CRL_REF_UNLOCK();
+            }
+            if (delete && refs == 0)
             {
                 internalFreeCRL(crl);
             }
@@ -183,15 +379,11 @@ int psCRL_Remove(psX509Crl_t *crl)
 {
     int rc;
 
-#  ifdef USE_MULTITHREADING
-    psLockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
+    CRL_WRITE_LOCK();
 
     rc = internalShrinkCRLtable(crl, 0);
 
-#  ifdef USE_MULTITHREADING
-    psUnlockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
+    CRL_WRITE_UNLOCK();
 
     return rc;
 }
@@ -201,15 +393,11 @@ int psCRL_Delete(psX509Crl_t *crl)
 {
     int rc;
 
-#  ifdef USE_MULTITHREADING
-    psLockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
+    CRL_WRITE_LOCK();
 
     rc = internalShrinkCRLtable(crl, 1);
 
-#  ifdef USE_MULTITHREADING
-    psUnlockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
+    CRL_WRITE_UNLOCK();
     return rc;
 }
 
@@ -219,21 +407,18 @@ void psCRL_RemoveAll()
 {
     psX509Crl_t *curr, *next;
 
-#  ifdef USE_MULTITHREADING
-    psLockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
+    CRL_WRITE_LOCK();
     curr = g_CRL;
-    next = curr->next;
-    while (next)
+    while (curr)
     {
         next = curr->next;
         curr->next = NULL;
+        curr->bucketNext = NULL;
         curr = next;
     }
     g_CRL = NULL;
-#  ifdef USE_MULTITHREADING
-    psUnlockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
+    memset(g_crlBuckets, 0, sizeof(g_crlBuckets));
+    CRL_WRITE_UNLOCK();
 }
 
 /* Remove all CRLs from g_CRL and free the associated memory */
@@ -241,9 +426,7 @@ void psCRL_DeleteAll()
 {
     psX509Crl_t *curr, *next;
 
-#  ifdef USE_MULTITHREADING
-    psLockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
+    CRL_WRITE_LOCK();
 
     curr = g_CRL;
     while (curr)
@@ -253,9 +436,7 @@ void psCRL_DeleteAll()
         curr = next;
     }
     psAssert(g_CRL == NULL);
-#  ifdef USE_MULTITHREADING
-    psUnlockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
+    CRL_WRITE_UNLOCK();
 }
 
 /* Helpers to see if the two CRLs are from the same issuer */
@@ -299,24 +480,20 @@ int psCRL_Update(psX509Crl_t *crl, int deleteExisting)
     {
         return 0;
     }
-#  ifdef USE_MULTITHREADING
-    psLockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
+    CRL_WRITE_LOCK();
          /* Currently no Delta CRL support so replace the CRL if we find the
              same issuer.  Add otherwise. */
-    curr = g_CRL;
+    curr = *crlBucket(crl->issuer.hash);
     while (curr)
     {
-        next = curr->next;
+        next = curr->bucketNext;
         if (internalCRLmatch(curr, crl) == PS_TRUE)
         {
             /* Just do a check to make sure the user isn't trying to update
                 with the exact same CRL pointer */
             if (curr == crl)
             {
-#  ifdef USE_MULTITHREADING
-                psUnlockMutex(&g_crlTableLock);
-#  endif        /* USE_MULTITHREADING */
+                CRL_WRITE_UNLOCK();
                 return 0;
             }
             internalShrinkCRLtable(curr, deleteExisting);
@@ -325,9 +502,7 @@ int psCRL_Update(psX509Crl_t *crl, int deleteExisting)
         curr = next;
     }
     rc = internalCRLInsert(crl);
-#  ifdef USE_MULTITHREADING
-    psUnlockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
+    CRL_WRITE_UNLOCK();
     return rc;
 }
 
@@ -403,7 +578,8 @@ static int32_t nextUpdateTest(const char *c, int32 timeType)
     return 0;
 }
 
-static psX509Crl_t *internalGetCrlForCert(psX509Cert_t *cert)
+/* First CRL in g_CRL from the issuer of cert.  Only reads the table */
+static psX509Crl_t *internalFindCrlForCert(psX509Cert_t *cert)
 {
     psX509Crl_t *curr;
 
@@ -411,42 +587,108 @@ static psX509Crl_t *internalGetCrlForCert(psX509Cert_t *cert)
     {
         return NULL;
     }
-    curr = g_CRL;
-    while (curr)
+    for (curr = *crlBucket(cert->issuer.hash); curr != NULL;
+         curr = curr->bucketNext)
     {
         if (internalMatchSubject(cert, curr) == PS_TRUE)
         {
-            /* This is the point where we want to make sure this CRL isn't
-                expired.  We do this by looking at the nextUpdate time and
-                seeing if we are beyond that */
-            if (nextUpdateTest(curr->nextUpdate, curr->nextUpdateType) < 0)
-            {
-                /* Got it, but it's expired */
-                curr->expired = 1;
-            }
             return curr;
         }
-        curr = curr->next;
     }
     return NULL;
 }
 
+/* Whether the expired flag of crl is due to be set */
+static int crlExpiring(psX509Crl_t *crl)
+{
+    /* This is the point where we want to make sure this CRL isn't
+        expired.  We do this by looking at the nextUpdate time and
+        seeing if we are beyond that */
+    return !crl->expired &&
+           nextUpdateTest(crl->nextUpdate, crl->nextUpdateType) < 0;
+}
+
+/* internalFindCrlForCert that also updates the expired flag, so the
+    table must be write-locked */
+static psX509Crl_t *internalGetCrlForCert(psX509Cert_t *cert)
+{
+    psX509Crl_t *crl;
+
+    if ((crl = internalFindCrlForCert(cert)) != NULL && crlExpiring(crl))
+    {
+        /* Got it, but it's expired */
+        crl->expired = 1;
+    }
+    return crl;
+}
+
+/* Common part of psCRL_GetCRLForCert and psCRL_AcquireCRLForCert */
+static psX509Crl_t *crlLookup(psX509Cert_t *cert, int acquire)
+{
+    psX509Crl_t *rc = NULL;
+    int expiring;
+
+    CRL_READ_LOCK();
+    rc = internalFindCrlForCert(cert);
+    expiring = (rc != NULL && crlExpiring(rc));
+    if (rc != NULL && !expiring && acquire)
+    {
+        CRL_REF_LOCK();
+        rc->refs++;
+        CRL_REF_UNLOCK();
+    }
+    CRL_READ_UNLOCK();
+
+    if (expiring)
+    {
+        CRL_WRITE_LOCK();
+        rc = internalGetCrlForCert(cert);
+        if (rc != NULL && acquire)
+        {
+            CRL_REF_LOCK();
+            rc->refs++;
+            CRL_REF_UNLOCK();
+        }
+        CRL_WRITE_UNLOCK();
+    }
+    return rc;
+}
+
 /* Given a cert, do we have a CRL match for the issuer?
-    Return if so or NULL if not */
+    Return if so or NULL if not.  The CRL is borrowed from g_CRL: it is
+    freed if it gets deleted or replaced, e.g. by psCRL_Update or a
+    psCRL_ReloadFile job, so use psCRL_AcquireCRLForCert to hold it */
 psX509Crl_t *psCRL_GetCRLForCert(psX509Cert_t *cert)
 {
-    psX509Crl_t *rc = NULL;
+    return crlLookup(cert, 0);
+}
 
-#  ifdef USE_MULTITHREADING
-    psLockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
+/* psCRL_GetCRLForCert that takes a reference.  The CRL stays valid, even
+    if deleted or replaced meanwhile, until psCRL_Release */
+psX509Crl_t *psCRL_AcquireCRLForCert(psX509Cert_t *cert)
+{
+    return crlLookup(cert, 1);
+}
 
-    rc = internalGetCrlForCert(cert);
+/* Drop a reference from psCRL_AcquireCRLForCert.  Frees the CRL if it was
+    deleted from g_CRL while referenced */
+void psCRL_Release(psX509Crl_t *crl)
+{
+    int last;
 
-#  ifdef USE_MULTITHREADING
-    psUnlockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
-    return rc;
+    if (crl == NULL)
+    {
+        return;
+    }
+    CRL_REF_LOCK();
+    psAssert(crl->refs > 0);
+    last = (--crl->refs == 0 && crl->deleted);
+    CRL_REF_UNLOCK();
+    if (last)
+    {
+        /* Out of the table, no other thread can reach it */
+        internalFreeCRL(crl);
+    }
 }
 
 
@@ -463,6 +705,8 @@ int32_t internalCrlIsRevoked(psX509Cert_t *cert, psX509Crl_t *CRL,
 {
     psX509Crl_t *crl;
     x509revoked_t *entry;
+    uint32_t lo, hi, mid;
+    int cmp;
 
     if (cert == NULL)
     {
@@ -475,16 +719,51 @@ int32_t internalCrlIsRevoked(psX509Cert_t *cert, psX509Crl_t *CRL,
     }
     else
     {
-        if ((crl = internalGetCrlForCert(cert)) == NULL)
+        if ((crl = internalFindCrlForCert(cert)) == NULL)
         {
             return -1;
         }
     }
+    if (crl->packedRevoked != NULL)
+    {
+        return crlPackedIsRevoked(crl, cert, bdt);
+    }
     if (crl->revoked == NULL)
     {
         /* It is totally reasonable to have a CRL with no revoked certs */
         return 0;
     }
+    if (crl->revokedIndex != NULL)
+    {
+        lo = 0;
+        hi = crl->revokedCount;
+        while (lo < hi)
+        {
+            mid = lo + (hi - lo) / 2;
+            entry = crl->revokedIndex[mid];
+            cmp = crlSerialCmp(cert->serialNumber, cert->serialNumberLen,
+                entry->serial, entry->serialLen);
+            if (cmp == 0)
+            {
+                if (bdt)
+                {
+                    memcpy(bdt, &entry->revocationDateBDT,
+                        sizeof(psBrokenDownTime_t));
+                }
+                return 1; /* REVOKED! */
+            }
+            if (cmp < 0)
+            {
+                hi = mid;
+            }
+            else
+            {
+                lo = mid + 1;
+            }
+        }
+        return 0;
+    }
+    /* CRLs not from psX509ParseCRL have no index */
     for (entry = crl->revoked; entry != NULL; entry = entry->next)
     {
         if (cert->serialNumberLen == entry->serialLen)
@@ -519,15 +798,11 @@ int32_t psCRL_isRevoked(psX509Cert_t *cert, psX509Crl_t *CRL)
 {
     int32_t rc;
 
-#  ifdef USE_MULTITHREADING
-    psLockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
+    CRL_READ_LOCK();
 
     rc = internalCrlIsRevoked(cert, CRL, NULL);
 
-#  ifdef USE_MULTITHREADING
-    psUnlockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
+    CRL_READ_UNLOCK();
 
     return rc;
 }
@@ -542,38 +817,33 @@ static int doesCertExpectCRL(psX509Cert_t *cert)
 }
 
 /*
-    Uses the psCRL_ format to highlight the use of g_CRL cache
-
-    Updates the "revokedStatus" member of a psX509Cert_t based on information
-    from within the cert itself and on the revocation status if a g_CRL entry
-    is found.
+    Body of psCRL_determineRevokedStatusBDT.  Marking the CRL expired or
+    authenticating it needs the table write-locked: with only the read lock
+    held (writable == 0) this returns PS_PENDING instead of doing either.
  */
-int32_t psCRL_determineRevokedStatusBDT(psX509Cert_t *cert,
-    psBrokenDownTime_t *bdt)
+static int32_t internalDetermineRevokedStatus(psX509Cert_t *cert,
+    psBrokenDownTime_t *bdt, int writable)
 {
     psX509Crl_t *crl;
     int expectCrl;
     int32_t revoked;
 
-    if (cert == NULL)
-    {
-        return 0;
-    }
-#  ifdef USE_MULTITHREADING
-    psLockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
-
-    crl = internalGetCrlForCert(cert);
+    crl = internalFindCrlForCert(cert);
 
     if (crl)
     {
+        if (crlExpiring(crl))
+        {
+            if (!writable)
+            {
+                return PS_PENDING;
+            }
+            crl->expired = 1;
+        }
         /* Not going to move along if the CRL has expired */
         if (crl->expired)
         {
             cert->revokedStatus = CRL_CHECK_CRL_EXPIRED;
-#  ifdef USE_MULTITHREADING
-            psUnlockMutex(&g_crlTableLock);
-#  endif    /* USE_MULTITHREADING */
             return cert->revokedStatus;
         }
 
@@ -585,6 +855,10 @@ int32_t psCRL_determineRevokedStatusBDT(psX509Cert_t *cert,
             attempt to authenticate */
         if (crl->authenticated == 0 && cert->next)
         {
+            if (!writable)
+            {
+                return PS_PENDING;
+            }
             psX509AuthenticateCRL(cert->next, crl, NULL);
         }
 
@@ -627,12 +901,38 @@ int32_t psCRL_determineRevokedStatusBDT(psX509Cert_t *cert,
             cert->revokedStatus = CRL_CHECK_NOT_EXPECTED;
         }
     }
-#  ifdef USE_MULTITHREADING
-    psUnlockMutex(&g_crlTableLock);
-#  endif /* USE_MULTITHREADING */
     return cert->revokedStatus;
 }
 
+/*
+    Uses the psCRL_ format to highlight the use of g_CRL cache
+
+    Updates the "revokedStatus" member of a psX509Cert_t based on information
+    from within the cert itself and on the revocation status if a g_CRL entry
+    is found.
+ */
+int32_t psCRL_determineRevokedStatusBDT(psX509Cert_t *cert,
+    psBrokenDownTime_t *bdt)
+{
+    int32_t rc;
+
+    if (cert == NULL)
+    {
+        return 0;
+    }
+    CRL_READ_LOCK();
+    rc = internalDetermineRevokedStatus(cert, bdt, 0);
+    CRL_READ_UNLOCK();
+
+    if (rc == PS_PENDING)
+    {
+        CRL_WRITE_LOCK();
+        rc = internalDetermineRevokedStatus(cert, bdt, 1);
+        CRL_WRITE_UNLOCK();
+    }
+    return rc;
+}
+
 int32_t psCRL_determineRevokedStatus(psX509Cert_t *cert)
 {
     return psCRL_determineRevokedStatusBDT(cert, NULL);
@@ -671,6 +971,8 @@ static void internalFreeCRL(psX509Crl_t *crl)
     psX509FreeDNStruct(&crl->issuer, pool);
     x509FreeExtensions(&crl->extensions);
     x509FreeRevoked(&crl->revoked, pool);
+    psFree(crl->revokedIndex, pool);
+    psFree(crl->packedRevoked, pool);
     psFree(crl->sig, pool);
     psFree(crl->nextUpdate, pool);
 
@@ -852,6 +1154,14 @@ int32 psX509GetCRLVersion(const unsigned char *crlBin, int32 crlBinLen)
     return 1; /* Default version (v2). */
 }
 
+/* Remaining input for the ASN.1 helpers that take a psSize_t.  Only the
+    revokedCertificates list of a CRL may be longer than that, never one of
+    its elements. */
+static psSize_t crlRemain(const unsigned char *p, const unsigned char *end)
+{
+    return (end - p) > PS_SIZE_MAX ? PS_SIZE_MAX : (psSize_t) (end - p);
+}
+
 /*
     Parse a CRL.
  */
@@ -953,7 +1263,7 @@ int32 psX509ParseCRL(psPool_t *pool, psX509Crl_t **crl, unsigned char *crlBin,
         RelativeDistinguishedName  ::=
                     SET SIZE (1 .. MAX) OF AttributeTypeAndValue
      */
-    if ((rc = psX509GetDNAttributes(pool, &p, (uint32) (end - p),
+    if ((rc = psX509GetDNAttributes(pool, &p, crlRemain(p, end),
              &lcrl->issuer, 0)) < 0)
     {
         psX509FreeCRL(lcrl);
@@ -970,7 +1280,7 @@ int32 psX509ParseCRL(psPool_t *pool, psX509Crl_t **crl, unsigned char *crlBin,
     }
     timetag = *p;
     p++;
-    if (getAsnLength(&p, (uint32) (end - p), &timelen) < 0 ||
+    if (getAsnLength(&p, crlRemain(p, end), &timelen) < 0 ||
         (uint32) (end - p) < timelen)
     {
         psTraceCrypto("Malformed thisUpdate CRL\n");
@@ -994,7 +1304,7 @@ int32 psX509ParseCRL(psPool_t *pool, psX509Crl_t **crl, unsigned char *crlBin,
     {
         lcrl->nextUpdateType = timetag = *p;
         p++;
-        if (getAsnLength(&p, (uint32) (end - p), &timelen) < 0 ||
+        if (getAsnLength(&p, crlRemain(p, end), &timelen) < 0 ||
             (uint32) (end - p) < timelen)
         {
             psTraceCrypto("Malformed nextUpdateTIME CRL\n");
@@ -1087,7 +1397,7 @@ int32 psX509ParseCRL(psPool_t *pool, psX509Crl_t **crl, unsigned char *crlBin,
                 }
                 timetag = *p;
                 p++;
-                if (getAsnLength(&p, (uint32) (end - p), &timelen) < 0 ||
+                if (getAsnLength(&p, crlRemain(p, end), &timelen) < 0 ||
                     (uint32) (end - p) < timelen)
                 {
                     psTraceCrypto("Malformed thisUpdate CRL\n");
@@ -1131,8 +1441,8 @@ int32 psX509ParseCRL(psPool_t *pool, psX509Crl_t **crl, unsigned char *crlBin,
             }
         }
         /* Always treated as OPTIONAL */
-        if (getExplicitExtensions(pool, &p, (uint32) (end - p), 0,
-                &lcrl->extensions, 0) < 0)
+        if (getExplicitExtensions(pool, &p, crlRemain(p, end), 0,
+                &lcrl->extensions, 0, 0) < 0)
         {
             psTraceCrypto("Extension parse error in psX509ParseCRL\n");
             psX509FreeCRL(lcrl);
@@ -1144,6 +1454,12 @@ int32 psX509ParseCRL(psPool_t *pool, psX509Crl_t **crl, unsigned char *crlBin,
     } /* End tbsCertList */
     sigEnd = p;
 
+    if ((rc = crlIndexRevoked(lcrl)) < 0)
+    {
+        psX509FreeCRL(lcrl);
+        return rc;
+    }
+
     if (getAsnAlgorithmIdentifier(&p, (int32) (end - p), &oi, &plen) < 0)
     {
         psX509FreeCRL(lcrl);
@@ -1158,7 +1474,7 @@ int32 psX509ParseCRL(psPool_t *pool, psX509Crl_t **crl, unsigned char *crlBin,
         return PS_PARSE_FAIL;
     }
 
-    if ((rc = psX509GetSignature(pool, &p, (uint32) (end - p), &lcrl->sig,
+    if ((rc = psX509GetSignature(pool, &p, crlRemain(p, end), &lcrl->sig,
              &lcrl->sigLen)) < 0)
     {
         psX509FreeCRL(lcrl);
@@ -1181,6 +1497,954 @@ int32 psX509ParseCRL(psPool_t *pool, psX509Crl_t **crl, unsigned char *crlBin,
     return PS_SUCCESS;
 }
 
+/******************************************************************************/
+/*
+    Streaming CRL parse.
+
+    psX509ParseCRL needs the whole CRL in memory and allocates an
+    x509revoked_t per entry, which is heavy for CRLs with millions of
+    entries.  The stream takes the same DER in pieces of any size, hashes
+    tbsCertList as it goes and stores each revoked entry as a fixed size
+    record in one packed array, sorted once at the end.  Only an element
+    split across two updates is copied, into the carry buffer.
+ */
+#  define CRL_STREAM_LIST         0
+#  define CRL_STREAM_TBS          1
+#  define CRL_STREAM_ISSUER       2
+#  define CRL_STREAM_THIS_UPDATE  3
+#  define CRL_STREAM_NEXT_UPDATE  4
+#  define CRL_STREAM_REVOKED      5
+#  define CRL_STREAM_ENTRY        6
+#  define CRL_STREAM_EXTENSIONS   7
+#  define CRL_STREAM_SIG_ALG      8
+#  define CRL_STREAM_SIG          9
+#  define CRL_STREAM_DONE         10
+
+/* Largest piece handed to the parser at once, keeps offsets in 32 bits */
+#  define CRL_STREAM_SLICE        0x40000000
+/* Input appended to the carry buffer at a time */
+#  define CRL_STREAM_CARRY_STEP   1024
+
+struct psX509CrlStream
+{
+    psPool_t *pool;
+    psX509Crl_t *crl;
+    psDigestContext_t hash;     /* Over tbsCertList, for crl->sigHash */
+    psSize_t hashLen;           /* Selects the hash.  0 before it is known */
+    unsigned char *carry;       /* Start of an element split across updates */
+    uint32_t carryLen;
+    uint32_t carrySize;
+    uint32_t listLeft;          /* CertificateList octets not yet parsed */
+    uint32_t tbsLeft;           /* tbsCertList octets not yet parsed */
+    uint32_t revokedLeft;       /* revokedCertificates octets not yet parsed */
+    uint32_t packedSize;        /* Records allocated in crl->packedRevoked */
+    int32_t state;              /* CRL_STREAM_ or the error once failed */
+};
+
+static int32_t crlHashInit(psX509CrlStream_t *s, int32_t sigAlg)
+{
+    switch (sigAlg)
+    {
+    case OID_SHA1_RSA_SIG:
+    case OID_SHA1_RSA_SIG2:
+    case OID_SHA1_ECDSA_SIG:
+        psSha1PreInit(&s->hash.sha1);
+        psSha1Init(&s->hash.sha1);
+        s->hashLen = SHA1_HASH_SIZE;
+        break;
+#  ifdef USE_SHA224
+    case OID_SHA224_RSA_SIG:
+    case OID_SHA224_ECDSA_SIG:
+        psSha224PreInit(&s->hash.sha256);
+        psSha224Init(&s->hash.sha256);
+        s->hashLen = SHA224_HASH_SIZE;
+        break;
+#  endif
+    case OID_SHA256_RSA_SIG:
+    case OID_SHA256_ECDSA_SIG:
+        psSha256PreInit(&s->hash.sha256);
+        psSha256Init(&s->hash.sha256);
+        s->hashLen = SHA256_HASH_SIZE;
+        break;
+#  ifdef USE_SHA384
+    case OID_SHA384_RSA_SIG:
+    case OID_SHA384_ECDSA_SIG:
+        psSha384PreInit(&s->hash.sha384);
+        psSha384Init(&s->hash.sha384);
+        s->hashLen = SHA384_HASH_SIZE;
+        break;
+#  endif
+#  ifdef USE_SHA512
+    case OID_SHA512_RSA_SIG:
+    case OID_SHA512_ECDSA_SIG:
+        psSha512PreInit(&s->hash.sha512);
+        psSha512Init(&s->hash.sha512);
+        s->hashLen = SHA512_HASH_SIZE;
+        break;
+#  endif
+    default:
+        psTraceIntCrypto("Unsupported CRL stream signature alg %d\n", sigAlg);
+        return PS_UNSUPPORTED_FAIL;
+    }
+    return PS_SUCCESS;
+}
+
+static void crlHashUpdate(psX509CrlStream_t *s, const unsigned char *p,
+    uint32_t len)
+{
+    switch (s->hashLen)
+    {
+    case SHA1_HASH_SIZE:
+        psSha1Update(&s->hash.sha1, p, len);
+        break;
+#  ifdef USE_SHA224
+    case SHA224_HASH_SIZE:
+        psSha224Update(&s->hash.sha256, p, len);
+        break;
+#  endif
+    case SHA256_HASH_SIZE:
+        psSha256Update(&s->hash.sha256, p, len);
+        break;
+#  ifdef USE_SHA384
+    case SHA384_HASH_SIZE:
+        psSha384Update(&s->hash.sha384, p, len);
+        break;
+#  endif
+#  ifdef USE_SHA512
+    case SHA512_HASH_SIZE:
+        psSha512Update(&s->hash.sha512, p, len);
+        break;
+#  endif
+    }
+}
+
+static void crlHashFinal(psX509CrlStream_t *s)
+{
+    psX509Crl_t *crl = s->crl;
+
+    switch (s->hashLen)
+    {
+    case SHA1_HASH_SIZE:
+        psSha1Final(&s->hash.sha1, crl->sigHash);
+        break;
+#  ifdef USE_SHA224
+    case SHA224_HASH_SIZE:
+        psSha224Final(&s->hash.sha256, crl->sigHash);
+        break;
+#  endif
+    case SHA256_HASH_SIZE:
+        psSha256Final(&s->hash.sha256, crl->sigHash);
+        break;
+#  ifdef USE_SHA384
+    case SHA384_HASH_SIZE:
+        psSha384Final(&s->hash.sha384, crl->sigHash);
+        break;
+#  endif
+#  ifdef USE_SHA512
+    case SHA512_HASH_SIZE:
+        psSha512Final(&s->hash.sha512, crl->sigHash);
+        break;
+#  endif
+    }
+    crl->sigHashLen = s->hashLen;
+    s->hashLen = 0;
+}
+
+/*
+    DER header at p.  Returns 1 with the header and content lengths, 0 when
+    more input is needed and PS_PARSE_FAIL for what DER does not allow here.
+ */
+static int32_t crlStreamHeader(const unsigned char *p, uint32_t avail,
+    uint32_t *hdrLen, uint32_t *valLen)
+{
+    uint32_t i, n, len;
+
+    if (avail < 2)
+    {
+        return 0;
+    }
+    if ((p[0] & 0x1F) == 0x1F)
+    {
+        return PS_PARSE_FAIL; /* High tag numbers are not used by CRLs */
+    }
+    if (p[1] < 0x80)
+    {
+        *hdrLen = 2;
+        *valLen = p[1];
+        return 1;
+    }
+    n = p[1] & 0x7F;
+    if (n == 0 || n > 4)
+    {
+        return PS_PARSE_FAIL; /* Indefinite, or longer than we can hold */
+    }
+    if (avail < 2 + n)
+    {
+        return 0;
+    }
+    for (len = 0, i = 0; i < n; i++)
+    {
+        len = (len << 8) | p[2 + i];
+    }
+    if (len > 0xFFFFFFFF - 6)
+    {
+        return PS_PARSE_FAIL;
+    }
+    *hdrLen = 2 + n;
+    *valLen = len;
+    return 1;
+}
+
+/*
+    As crlStreamHeader, but 1 only once the whole element is available.
+    Like crlRemain, assumes only the revokedCertificates list can be longer
+    than PS_SIZE_MAX, and that is never parsed as one element.
+ */
+static int32_t crlStreamElement(const unsigned char *p, uint32_t avail,
+    uint32_t *hdrLen, uint32_t *len)
+{
+    uint32_t valLen;
+    int32_t rc;
+
+    if ((rc = crlStreamHeader(p, avail, hdrLen, &valLen)) <= 0)
+    {
+        return rc;
+    }
+    *len = *hdrLen + valLen;
+    if (*len > PS_SIZE_MAX)
+    {
+        psTraceCrypto("CRL element too large\n");
+        return PS_PARSE_FAIL;
+    }
+    return *len <= avail ? 1 : 0;
+}
+
+/* Account for len octets of the CertificateList, outside tbsCertList */
+static int32_t crlStreamList(psX509CrlStream_t *s, uint32_t len)
+{
+    if (len > s->listLeft)
+    {
+        psTraceCrypto("CRL element overruns CertificateList\n");
+        return PS_PARSE_FAIL;
+    }
+    s->listLeft -= len;
+    return PS_SUCCESS;
+}
+
+/* Account for len octets of tbsCertList */
+static int32_t crlStreamTbs(psX509CrlStream_t *s, const unsigned char *p,
+    uint32_t len)
+{
+    if (len > s->tbsLeft)
+    {
+        psTraceCrypto("CRL element overruns tbsCertList\n");
+        return PS_PARSE_FAIL;
+    }
+    crlHashUpdate(s, p, len);
+    s->tbsLeft -= len;
+    return PS_SUCCESS;
+}
+
+/* A thisUpdate, nextUpdate or revocationDate element */
+static int32_t crlStreamTime(const unsigned char *p, uint32_t hdrLen,
+    uint32_t len, psBrokenDownTime_t *bdt)
+{
+    if ((p[0] != ASN_UTCTIME && p[0] != ASN_GENERALIZEDTIME) ||
+        psBrokenDownTimeImport(bdt, (const char *) p + hdrLen,
+            (psSize_t) (len - hdrLen), p[0] == ASN_UTCTIME ?
+            PS_BROKENDOWN_TIME_IMPORT_2DIGIT_YEAR : 0) != PS_SUCCESS)
+    {
+        return PS_PARSE_FAIL;
+    }
+    return PS_SUCCESS;
+}
+
+/* One revokedCertificates entry, appended to crl->packedRevoked */
+static int32_t crlStreamEntry(psX509CrlStream_t *s, const unsigned char *p,
+    uint32_t len)
+{
+    psX509Crl_t *crl = s->crl;
+    const unsigned char *end = p + len, *serial;
+    unsigned char *rec;
+    psBrokenDownTime_t bdt;
+    uint32_t hdrLen, serialLen, timeLen, n;
+
+    /* The caller has seen the whole element */
+    if (*p != (ASN_SEQUENCE | ASN_CONSTRUCTED) ||
+        crlStreamHeader(p, len, &hdrLen, &serialLen) <= 0)
+    {
+        psTraceCrypto("Deep revokedCert error in psX509CrlStreamUpdate\n");
+        return PS_PARSE_FAIL;
+    }
+    p += hdrLen;
+
+    /* userCertificate, tagged as getSerialNum allows */
+    if (p >= end ||
+        (*p != ASN_INTEGER && *p != (ASN_CONTEXT_SPECIFIC | ASN_PRIMITIVE | 2))
+        || crlStreamElement(p, (uint32_t) (end - p), &hdrLen, &serialLen) <= 0)
+    {
+        psTraceCrypto("ASN serial number parse error\n");
+        return PS_PARSE_FAIL;
+    }
+    serial = p + hdrLen;
+    p += serialLen;
+    serialLen -= hdrLen;
+    if (serialLen > CRL_REC_SERIAL_MAX)
+    {
+        psTraceIntCrypto("Revoked serial of %d octets not kept\n",
+            (int32) serialLen);
+        crl->longRevoked++;
+        return PS_SUCCESS;
+    }
+
+    /* revocationDate.  crlEntryExtensions are skipped */
+    if (p >= end ||
+        crlStreamElement(p, (uint32_t) (end - p), &hdrLen, &timeLen) <= 0 ||
+        timeLen - hdrLen > CRL_REC_TIME_MAX ||
+        crlStreamTime(p, hdrLen, timeLen, &bdt) < 0)
+    {
+        psTraceCrypto("Malformed revocationDate CRL\n");
+        return PS_PARSE_FAIL;
+    }
+
+    if (crl->revokedCount == s->packedSize)
+    {
+        n = s->packedSize ? s->packedSize * 2 : 256;
+        if (n < s->packedSize || (rec = psRealloc(crl->packedRevoked,
+                 (size_t) n * CRL_REC_SIZE, s->pool)) == NULL)
+        {
+            return PS_MEM_FAIL;
+        }
+        crl->packedRevoked = rec;
+        s->packedSize = n;
+    }
+    rec = crl->packedRevoked + (size_t) crl->revokedCount * CRL_REC_SIZE;
+    memset(rec, 0x0, CRL_REC_SIZE);
+    rec[0] = (unsigned char) serialLen;
+    memcpy(rec + CRL_REC_SERIAL, serial, serialLen);
+    rec[CRL_REC_TIMETAG] = p[0];
+    rec[CRL_REC_TIMELEN] = (unsigned char) (timeLen - hdrLen);
+    memcpy(rec + CRL_REC_TIME, p + hdrLen, timeLen - hdrLen);
+    crl->revokedCount++;
+    return PS_SUCCESS;
+}
+
+/*
+    Parse the complete elements at p.  used is set to the octets parsed,
+    anything after that is an element to retry once more input arrives.
+ */
+static int32_t crlStreamParse(psX509CrlStream_t *s, const unsigned char *p,
+    uint32_t avail, uint32_t *used)
+{
+    psX509Crl_t *crl = s->crl;
+    const unsigned char *start = p, *end = p + avail, *q, *v;
+    uint32_t hdrLen, tbsHdrLen, len, valLen;
+    int32 version, oi;
+    psSize_t plen;
+    int32_t rc = PS_SUCCESS;
+
+    while (s->state != CRL_STREAM_DONE)
+    {
+        avail = (uint32_t) (end - p);
+        switch (s->state)
+        {
+        case CRL_STREAM_LIST:
+            if ((rc = crlStreamHeader(p, avail, &hdrLen, &valLen)) <= 0)
+            {
+                goto out;
+            }
+            if (*p != (ASN_SEQUENCE | ASN_CONSTRUCTED))
+            {
+                psTraceCrypto("Initial parse error in psX509CrlStreamUpdate\n");
+                rc = PS_PARSE_FAIL;
+                goto out;
+            }
+            s->listLeft = valLen;
+            p += hdrLen;
+            s->state = CRL_STREAM_TBS;
+            break;
+
+        case CRL_STREAM_TBS:
+            /* Header, version and signature are taken together, the
+                signature algorithm selects the hash for all of them */
+            if ((rc = crlStreamHeader(p, avail, &tbsHdrLen, &valLen)) <= 0)
+            {
+                goto out;
+            }
+            if (*p != (ASN_SEQUENCE | ASN_CONSTRUCTED))
+            {
+                psTraceCrypto("Initial parse error in psX509CrlStreamUpdate\n");
+                rc = PS_PARSE_FAIL;
+                goto out;
+            }
+            q = p + tbsHdrLen;
+            if (q >= end)
+            {
+                rc = 0;
+                goto out;
+            }
+            if (*q == ASN_INTEGER)
+            {
+                if ((rc = crlStreamElement(q, (uint32_t) (end - q), &hdrLen,
+                         &len)) <= 0)
+                {
+                    goto out;
+                }
+                v = q;
+                version = 0;
+                if (getAsnInteger(&v, len, &version) < 0 || version < 0)
+                {
+                    psTraceCrypto("Version parse error in psX509CrlStreamUpdate\n");
+                    rc = PS_PARSE_FAIL;
+                    goto out;
+                }
+                if (version != 1)
+                {
+                    psTraceIntCrypto("Version parse: unsupported version "
+                        "requested: %d\n", version);
+                    rc = PS_VERSION_UNSUPPORTED;
+                    goto out;
+                }
+                q += len;
+            }
+            if ((rc = crlStreamElement(q, (uint32_t) (end - q), &hdrLen,
+                     &len)) <= 0)
+            {
+                goto out;
+            }
+            v = q;
+            if (getAsnAlgorithmIdentifier(&v, len, &crl->sigAlg, &plen) < 0)
+            {
+                psTraceCrypto("Couldn't parse crl sig algorithm identifier\n");
+                rc = PS_PARSE_FAIL;
+                goto out;
+            }
+            q += len;
+            if ((rc = crlHashInit(s, crl->sigAlg)) < 0)
+            {
+                goto out;
+            }
+            if ((rc = crlStreamList(s, tbsHdrLen + valLen)) < 0)
+            {
+                goto out;
+            }
+            crlHashUpdate(s, p, tbsHdrLen);
+            s->tbsLeft = valLen;
+            if ((rc = crlStreamTbs(s, p + tbsHdrLen,
+                     (uint32_t) (q - p) - tbsHdrLen)) < 0)
+            {
+                goto out;
+            }
+            p = q;
+            s->state = CRL_STREAM_ISSUER;
+            break;
+
+        case CRL_STREAM_ISSUER:
+            if ((rc = crlStreamElement(p, avail, &hdrLen, &len)) <= 0)
+            {
+                goto out;
+            }
+            v = p;
+            if ((rc = psX509GetDNAttributes(s->pool, &v, (psSize_t) len,
+                     &crl->issuer, 0)) < 0)
+            {
+                psTraceCrypto("Couldn't parse crl issuer DN attributes\n");
+                goto out;
+            }
+            if ((rc = crlStreamTbs(s, p, len)) < 0)
+            {
+                goto out;
+            }
+            p += len;
+            s->state = CRL_STREAM_THIS_UPDATE;
+            break;
+
+        case CRL_STREAM_THIS_UPDATE:
+            if ((rc = crlStreamElement(p, avail, &hdrLen, &len)) <= 0)
+            {
+                goto out;
+            }
+            if (crlStreamTime(p, hdrLen, len, &crl->thisUpdateBDT) < 0)
+            {
+                psTraceCrypto("Malformed thisUpdate CRL\n");
+                rc = PS_PARSE_FAIL;
+                goto out;
+            }
+            if ((rc = crlStreamTbs(s, p, len)) < 0)
+            {
+                goto out;
+            }
+            p += len;
+            s->state = CRL_STREAM_NEXT_UPDATE;
+            break;
+
+        case CRL_STREAM_NEXT_UPDATE:
+            if (s->tbsLeft == 0)
+            {
+                s->state = CRL_STREAM_EXTENSIONS;
+                break;
+            }
+            if (avail == 0)
+            {
+                rc = 0;
+                goto out;
+            }
+            if (*p == ASN_UTCTIME || *p == ASN_GENERALIZEDTIME)
+            {
+                if ((rc = crlStreamElement(p, avail, &hdrLen, &len)) <= 0)
+                {
+                    goto out;
+                }
+                if (crlStreamTime(p, hdrLen, len, &crl->nextUpdateBDT) < 0)
+                {
+                    psTraceCrypto("Malformed nextUpdateTIME CRL\n");
+                    rc = PS_PARSE_FAIL;
+                    goto out;
+                }
+                if ((crl->nextUpdate = psMalloc(s->pool, len - hdrLen + 1))
+                    == NULL)
+                {
+                    rc = PS_MEM_FAIL;
+                    goto out;
+                }
+                memcpy(crl->nextUpdate, p + hdrLen, len - hdrLen);
+                crl->nextUpdate[len - hdrLen] = '\0';
+                crl->nextUpdateType = *p;
+                if ((rc = crlStreamTbs(s, p, len)) < 0)
+                {
+                    goto out;
+                }
+                p += len;
+            }
+            s->state = CRL_STREAM_REVOKED;
+            break;
+
+        case CRL_STREAM_REVOKED:
+            if (s->tbsLeft == 0)
+            {
+                s->state = CRL_STREAM_EXTENSIONS;
+                break;
+            }
+            if (avail == 0)
+            {
+                rc = 0;
+                goto out;
+            }
+            /* Could be jumping right to crlExtensions */
+            if (*p == (ASN_SEQUENCE | ASN_CONSTRUCTED))
+            {
+                if ((rc = crlStreamHeader(p, avail, &hdrLen, &valLen)) <= 0)
+                {
+                    goto out;
+                }
+                if ((rc = crlStreamTbs(s, p, hdrLen)) < 0)
+                {
+                    goto out;
+                }
+                if (valLen > s->tbsLeft)
+                {
+                    psTraceCrypto("Initial revokedCert error in psX509CrlStreamUpdate\n");
+                    rc = PS_PARSE_FAIL;
+                    goto out;
+                }
+                s->revokedLeft = valLen;
+                p += hdrLen;
+                s->state = CRL_STREAM_ENTRY;
+                break;
+            }
+            s->state = CRL_STREAM_EXTENSIONS;
+            break;
+
+        case CRL_STREAM_ENTRY:
+            if (s->revokedLeft == 0)
+            {
+                s->state = CRL_STREAM_EXTENSIONS;
+                break;
+            }
+            if ((rc = crlStreamElement(p, avail, &hdrLen, &len)) <= 0)
+            {
+                goto out;
+            }
+            if (len > s->revokedLeft)
+            {
+                psTraceCrypto("Deeper revokedCert err in psX509CrlStreamUpdate\n");
+                rc = PS_PARSE_FAIL;
+                goto out;
+            }
+            if ((rc = crlStreamEntry(s, p, len)) < 0 ||
+                (rc = crlStreamTbs(s, p, len)) < 0)
+            {
+                goto out;
+            }
+            s->revokedLeft -= len;
+            p += len;
+            break;
+
+        case CRL_STREAM_EXTENSIONS:
+            if (s->tbsLeft == 0)
+            {
+                /* End tbsCertList */
+                crlHashFinal(s);
+                s->state = CRL_STREAM_SIG_ALG;
+                break;
+            }
+            if ((rc = crlStreamElement(p, avail, &hdrLen, &len)) <= 0)
+            {
+                goto out;
+            }
+            v = p;
+            if (*p != (ASN_CONTEXT_SPECIFIC | ASN_CONSTRUCTED | 0) ||
+                len != s->tbsLeft ||
+                getExplicitExtensions(s->pool, &v, (psSize_t) len, 0,
+                    &crl->extensions, 0, 0) < 0)
+            {
+                psTraceCrypto("Extension parse error in psX509CrlStreamUpdate\n");
+                rc = PS_PARSE_FAIL;
+                goto out;
+            }
+            if ((rc = crlStreamTbs(s, p, len)) < 0)
+            {
+                goto out;
+            }
+            p += len;
+            break;
+
+        case CRL_STREAM_SIG_ALG:
+            if ((rc = crlStreamElement(p, avail, &hdrLen, &len)) <= 0)
+            {
+                goto out;
+            }
+            v = p;
+            /* must match */
+            if (getAsnAlgorithmIdentifier(&v, len, &oi, &plen) < 0 ||
+                oi != crl->sigAlg)
+            {
+                psTraceCrypto("Couldn't match crl sig algorithm identifier\n");
+                rc = PS_PARSE_FAIL;
+                goto out;
+            }
+            if ((rc = crlStreamList(s, len)) < 0)
+            {
+                goto out;
+            }
+            p += len;
+            s->state = CRL_STREAM_SIG;
+            break;
+
+        case CRL_STREAM_SIG:
+            if ((rc = crlStreamElement(p, avail, &hdrLen, &len)) <= 0)
+            {
+                goto out;
+            }
+            v = p;
+            if ((rc = psX509GetSignature(s->pool, &v, (psSize_t) len,
+                     &crl->sig, &crl->sigLen)) < 0)
+            {
+                psTraceCrypto("Couldn't parse signature\n");
+                goto out;
+            }
+            if ((rc = crlStreamList(s, len)) < 0 || s->listLeft != 0)
+            {
+                psTraceCrypto("Trailing data in CertificateList\n");
+                rc = PS_PARSE_FAIL;
+                goto out;
+            }
+            p += len;
+            s->state = CRL_STREAM_DONE;
+            break;
+        }
+    }
+    /* As psX509ParseCRL, anything after the CertificateList is ignored */
+    p = end;
+    rc = PS_SUCCESS;
+out:
+    *used = (uint32_t) (p - start);
+    return rc < 0 ? rc : PS_SUCCESS;
+}
+
+/* Append to the carry buffer */
+static int32_t crlStreamCarry(psX509CrlStream_t *s, const unsigned char *p,
+    uint32_t len)
+{
+    unsigned char *carry;
+    uint32_t size;
+
+    if (s->carryLen + len > s->carrySize)
+    {
+        size = s->carrySize ? s->carrySize : 256;
+        while (size < s->carryLen + len)
+        {
+            size *= 2;
+        }
+        if ((carry = psRealloc(s->carry, size, s->pool)) == NULL)
+        {
+            return PS_MEM_FAIL;
+        }
+        s->carry = carry;
+        s->carrySize = size;
+    }
+    memcpy(s->carry + s->carryLen, p, len);
+    s->carryLen += len;
+    return PS_SUCCESS;
+}
+
+static void crlStreamFree(psX509CrlStream_t *s)
+{
+    internalFreeCRL(s->crl);
+    psFree(s->carry, s->pool);
+    psFree(s, s->pool);
+}
+
+/*
+    Start a streaming CRL parse.  Feed the DER CertificateList with
+    psX509CrlStreamUpdate, in pieces of any size, then collect the CRL with
+    psX509CrlStreamFinal.  The result behaves as one from psX509ParseCRL
+    except that crl->revoked is not built.
+ */
+int32_t psX509CrlStreamOpen(psPool_t *pool, psX509CrlStream_t **stream)
+{
+    psX509CrlStream_t *s;
+
+    if (stream == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    *stream = NULL;
+    if ((s = psMalloc(pool, sizeof(psX509CrlStream_t))) == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    memset(s, 0x0, sizeof(psX509CrlStream_t));
+    s->pool = pool;
+    if ((s->crl = psMalloc(pool, sizeof(psX509Crl_t))) == NULL)
+    {
+        psFree(s, pool);
+        return PS_MEM_FAIL;
+    }
+    memset(s->crl, 0x0, sizeof(psX509Crl_t));
+    s->crl->pool = pool;
+    s->state = CRL_STREAM_LIST;
+    *stream = s;
+    return PS_SUCCESS;
+}
+
+int32_t psX509CrlStreamUpdate(psX509CrlStream_t *stream,
+    const unsigned char *data, psSizeL_t len)
+{
+    uint32_t n, have, used;
+    int32_t rc = PS_SUCCESS;
+
+    if (stream == NULL || (data == NULL && len > 0))
+    {
+        return PS_ARG_FAIL;
+    }
+    while (len > 0 && stream->state >= 0)
+    {
+        if (stream->carryLen == 0)
+        {
+            /* Parse in place, keep only a trailing partial element */
+            n = len > CRL_STREAM_SLICE ? CRL_STREAM_SLICE : (uint32_t) len;
+            if ((rc = crlStreamParse(stream, data, n, &used)) == PS_SUCCESS &&
+                used < n)
+            {
+                rc = crlStreamCarry(stream, data + used, n - used);
+            }
+            data += n;
+            len -= n;
+        }
+        else
+        {
+            /* Complete the carried element a little at a time, then go
+                back to parsing in place from where it ended */
+            have = stream->carryLen;
+            n = len > CRL_STREAM_CARRY_STEP ? CRL_STREAM_CARRY_STEP :
+                (uint32_t) len;
+            if ((rc = crlStreamCarry(stream, data, n)) == PS_SUCCESS &&
+                (rc = crlStreamParse(stream, stream->carry, stream->carryLen,
+                      &used)) == PS_SUCCESS)
+            {
+                if (used >= have)
+                {
+                    stream->carryLen = 0;
+                    n = used - have;
+                }
+                else
+                {
+                    memmove(stream->carry, stream->carry + used,
+                        stream->carryLen - used);
+                    stream->carryLen -= used;
+                }
+            }
+            data += n;
+            len -= n;
+        }
+        if (rc < 0)
+        {
+            stream->state = rc;
+        }
+    }
+    return stream->state < 0 ? stream->state : PS_SUCCESS;
+}
+
+/*
+    Finish a streaming parse.  The stream is freed whatever the result.
+    Caller must free crl with psX509FreeCRL on success.
+ */
+int32_t psX509CrlStreamFinal(psX509CrlStream_t *stream, psX509Crl_t **crl)
+{
+    psX509Crl_t *lcrl;
+    unsigned char *packed;
+    int32_t rc;
+
+    if (stream == NULL || crl == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    *crl = NULL;
+    rc = stream->state;
+    if (rc >= 0 && rc != CRL_STREAM_DONE)
+    {
+        psTraceCrypto("Truncated CRL in psX509CrlStreamFinal\n");
+        rc = PS_PARSE_FAIL;
+    }
+    if (rc < 0)
+    {
+        crlStreamFree(stream);
+        return rc;
+    }
+    lcrl = stream->crl;
+    if (lcrl->revokedCount > 0)
+    {
+        if (lcrl->revokedCount < stream->packedSize &&
+            (packed = psRealloc(lcrl->packedRevoked,
+                 (size_t) lcrl->revokedCount * CRL_REC_SIZE,
+                 stream->pool)) != NULL)
+        {
+            lcrl->packedRevoked = packed;
+        }
+        qsort(lcrl->packedRevoked, lcrl->revokedCount, CRL_REC_SIZE,
+            crlPackedCmp);
+    }
+    stream->crl = NULL;
+    crlStreamFree(stream);
+    *crl = lcrl;
+    return PS_SUCCESS;
+}
+
+#  ifdef MATRIX_USE_FILE_SYSTEM
+/*
+    Parse a DER CRL file with psX509CrlStreamUpdate.  The file is mapped
+    rather than read, so memory use is the packed revoked list.
+ */
+int32_t psX509ParseCRLFile(psPool_t *pool, const char *fileName,
+    psX509Crl_t **crl)
+{
+    psX509CrlStream_t *stream;
+    const unsigned char *buf;
+    psSizeL_t bufLen;
+    int32_t rc;
+
+    if (crl == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    *crl = NULL;
+    if ((rc = psMapFile(pool, fileName, &buf, &bufLen)) < 0)
+    {
+        return rc;
+    }
+    if ((rc = psX509CrlStreamOpen(pool, &stream)) == PS_SUCCESS)
+    {
+        psX509CrlStreamUpdate(stream, buf, bufLen);
+        rc = psX509CrlStreamFinal(stream, crl);
+    }
+    psUnmapFile(pool, buf, bufLen);
+    return rc;
+}
+
+static void crlReloadRun(void *arg)
+{
+    psCrlReload_t *reload = arg;
+    psX509Crl_t *crl;
+    int32_t rc;
+
+    if ((rc = psX509ParseCRLFile(reload->pool, reload->fileName, &crl)) < 0)
+    {
+        reload->rc = rc;
+        return;
+    }
+    if (reload->CA != NULL)
+    {
+        rc = psX509AuthenticateCRL(reload->CA, crl, NULL);
+        if (rc == PS_SUCCESS && crl->authenticated != PS_TRUE)
+        {
+            rc = PS_CERT_AUTH_FAIL_SIG;
+        }
+        if (rc < 0)
+        {
+            internalFreeCRL(crl);
+            reload->rc = rc;
+            return;
+        }
+    }
+    /* Swaps out the CRL of the same issuer under the table write lock,
+        lookups see either the old or the new one.  A replaced CRL still
+        held from psCRL_AcquireCRLForCert is freed by its last psCRL_Release */
+    if (psCRL_Update(crl, 1) == 0)
+    {
+        internalFreeCRL(crl);
+        reload->rc = PS_FAILURE;
+        return;
+    }
+    reload->rc = PS_SUCCESS;
+}
+
+/*
+    Parse a CRL file on the CRL worker thread and replace the cached CRL of
+    the same issuer with it.  With a CA the new CRL must authenticate or it
+    is discarded and the cache left alone.  reload, fileName and CA must
+    stay valid until psCRL_ReloadWait.  Without thread support the reload
+    is done before returning.
+ */
+int32_t psCRL_ReloadFile(psCrlReload_t *reload, psPool_t *pool,
+    const char *fileName, psX509Cert_t *CA)
+{
+    int32_t rc = PS_SUCCESS;
+
+    if (reload == NULL || fileName == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    CRL_WRITE_LOCK();
+    if (g_crlWorker == NULL)
+    {
+        rc = psWorkerPoolOpen(NULL, &g_crlWorker, 1);
+    }
+    CRL_WRITE_UNLOCK();
+    if (rc < 0)
+    {
+        return rc;
+    }
+    reload->pool = pool;
+    reload->fileName = fileName;
+    reload->CA = CA;
+    reload->rc = PS_PENDING;
+    psWorkerJobInit(&reload->job, crlReloadRun, reload);
+    return psWorkerPoolSubmit(g_crlWorker, &reload->job);
+}
+
+/* Returns the result of the reload */
+int32_t psCRL_ReloadWait(psCrlReload_t *reload)
+{
+    if (reload == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    psWorkerJobWait(g_crlWorker, &reload->job);
+    return reload->rc;
+}
+#  endif /* MATRIX_USE_FILE_SYSTEM */
+
 /*
     If the provided cert has a URL based CRL Distribution point, return
     that.  The url and urlLen point directly into the cert structure so
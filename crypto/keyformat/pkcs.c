@@ -196,7 +196,8 @@ static int32 pkcs8parse_unknown(
     Unencrypted private keys are supported if 'pass' is NULL
     Encrypted private keys are supported if 'pass' is non-null for the
         des-EDE3-CBC algorithm only (3DES). Other PKCS#5 symmetric algorithms
-        are not supported.
+        are not supported.  The PBKDF2 pseudorandom function may be
+        hmacWithSHA1 (the default), hmacWithSHA256, 384 or 512.
 
     @return < 0 on error, private keysize in bytes on success.
  */
@@ -214,7 +215,9 @@ int32 psPkcs8ParsePrivBin(psPool_t *pool, unsigned char *buf, int32 size,
     unsigned char desKeyBin[24];
     psCipherContext_t ctx;
     char iv[8], salt[8];
-    int32 icount;
+    int32 icount, keyLen;
+    const unsigned char *kdfEnd;
+    psCipherType_e prf;
 #  endif /* USE_PKCS5 */
 
     /* Check for too large (invalid) inputs, unparseable with uint16_t */
@@ -243,7 +246,7 @@ int32 psPkcs8ParsePrivBin(psPool_t *pool, unsigned char *buf, int32 size,
             psTraceCrypto("Couldn't parse PKCS#8 algorithm identifier\n");
             return PS_FAILURE;
         }
-        if (oi != OID_PKCS_PBES2 || plen != 53)
+        if (oi != OID_PKCS_PBES2)
         {
             psTraceCrypto("Only supporting PKCS#8 id-PBES2 OID\n");
             return PS_FAILURE;
@@ -257,7 +260,7 @@ int32 psPkcs8ParsePrivBin(psPool_t *pool, unsigned char *buf, int32 size,
             psTraceCrypto("Couldn't parse PKCS#8 keyDerivationFunc\n");
             return PS_FAILURE;
         }
-        if (oi != OID_PKCS_PBKDF2 || plen != 16)
+        if (oi != OID_PKCS_PBKDF2)
         {
             psTraceCrypto("Only support PKCS#8 id-PBKDF2 OID\n");
             return PS_FAILURE;
@@ -266,6 +269,7 @@ int32 psPkcs8ParsePrivBin(psPool_t *pool, unsigned char *buf, int32 size,
         {
             return PS_FAILURE;
         }
+        kdfEnd = p + seqlen;
         if ((*p++ != ASN_OCTET_STRING) ||
             getAsnLength(&p, (int32) (end - p), &len) < 0 ||
             (uint32) (end - p) < len ||
@@ -283,6 +287,48 @@ int32 psPkcs8ParsePrivBin(psPool_t *pool, unsigned char *buf, int32 size,
             psTraceCrypto("Couldn't parse PKCS#8 param iterationCount\n");
             return PS_FAILURE;
         }
+        /* Optional keyLength and prf */
+        if (p < kdfEnd && *p == ASN_INTEGER)
+        {
+            if (getAsnInteger(&p, (int32) (kdfEnd - p), &keyLen) < 0 ||
+                keyLen != DES3_KEYLEN)
+            {
+                psTraceCrypto("Couldn't parse PKCS#8 param keyLength\n");
+                return PS_FAILURE;
+            }
+        }
+        prf = HASH_SHA1;
+        if (p < kdfEnd)
+        {
+            if (getAsnAlgorithmIdentifier(&p, (int32) (kdfEnd - p), &oi,
+                    &plen) < 0 || plen != 0)
+            {
+                psTraceCrypto("Couldn't parse PKCS#8 param prf\n");
+                return PS_FAILURE;
+            }
+            switch (oi)
+            {
+            case OID_HMAC_WITH_SHA1:
+                break;
+            case OID_HMAC_WITH_SHA256:
+                prf = HASH_SHA256;
+                break;
+            case OID_HMAC_WITH_SHA384:
+                prf = HASH_SHA384;
+                break;
+            case OID_HMAC_WITH_SHA512:
+                prf = HASH_SHA512;
+                break;
+            default:
+                psTraceCrypto("Unsupported PKCS#8 PBKDF2 prf\n");
+                return PS_UNSUPPORTED_FAIL;
+            }
+        }
+        if (p != kdfEnd)
+        {
+            psTraceCrypto("Couldn't parse PKCS#8 PBKDF2 params\n");
+            return PS_FAILURE;
+        }
         /* Get encryptionScheme */
         if (getAsnAlgorithmIdentifier(&p, (int32) (end - p), &oi, &plen)
             < 0)
@@ -333,9 +379,13 @@ int32 psPkcs8ParsePrivBin(psPool_t *pool, unsigned char *buf, int32 size,
             return PS_FAILURE;
         }
         /* Derive the 3DES key and decrypt the RSA key*/
-        psPkcs5Pbkdf2((unsigned char *) pass, (int32) strlen(pass),
-            (unsigned char *) salt, 8, icount, (unsigned char *) desKeyBin,
-            DES3_KEYLEN);
+        if (psPkcs5Pbkdf2Hmac(prf, (unsigned char *) pass,
+                (uint32) strlen(pass), (unsigned char *) salt, 8, icount,
+                desKeyBin, DES3_KEYLEN) < 0)
+        {
+            psTraceCrypto("PKCS#8 PBKDF2 failed\n");
+            return PS_UNSUPPORTED_FAIL;
+        }
         psDes3Init(&ctx.des3, (unsigned char *) iv, desKeyBin);
         psDes3Decrypt(&ctx.des3, p, (unsigned char *) p, len);
         /* @security SECURITY - we zero out des3 key when done with it */
@@ -419,7 +469,11 @@ int32 psPkcs8ParsePrivBin(psPool_t *pool, unsigned char *buf, int32 size,
         return PS_FAILURE;
     }
 #  ifdef USE_ECC
-    if (oi != OID_ECDSA_KEY_ALG && oi != OID_RSA_KEY_ALG)
+    if (oi != OID_ECDSA_KEY_ALG && oi != OID_RSA_KEY_ALG
+#   ifdef USE_ED25519
+        && oi != OID_ED25519_KEY_ALG
+#   endif
+        )
     {
         return pkcs8parse_unknown(pool, buf, size, key);
     }
@@ -494,6 +548,21 @@ int32 psPkcs8ParsePrivBin(psPool_t *pool, unsigned char *buf, int32 size,
         key->type = PS_ECC;
         key->keysize = psEccSize(&key->key.ecc);
     }
+#  endif
+#  ifdef USE_ED25519
+    if (oi == OID_ED25519_KEY_ALG)
+    {
+        /* The seed, wrapped in another OCTET STRING (RFC 8410 section 7) */
+        if (len != ED25519_KEY_SIZE + 2 || p[0] != ASN_OCTET_STRING ||
+            p[1] != ED25519_KEY_SIZE)
+        {
+            psTraceCrypto("Malformed Ed25519 private key\n");
+            return PS_PARSE_FAIL;
+        }
+        psEd25519ImportPrivKey(&key->key.ed25519, p + 2);
+        key->type = PS_ED25519;
+        key->keysize = ED25519_KEY_SIZE;
+    }
 #  endif
     p += len;
 
@@ -1728,6 +1797,12 @@ int32_t psPkcs1ParsePrivFile(psPool_t *pool, const char *fileName,
             psFree(DERout, pool);
             return rc;
         }
+        if (pubkey.type != PS_RSA)
+        {
+            psClearPubKey(&pubkey);
+            psFree(DERout, pool);
+            return PS_UNSUPPORTED_FAIL;
+        }
         rc = psRsaCopyKey(key, &pubkey.key.rsa);
         psClearPubKey(&pubkey);
 #   else
@@ -1752,9 +1827,11 @@ int32_t psPkcs1DecodePrivFile(psPool_t *pool, const char *fileName,
     const char *password, unsigned char **DERout, psSize_t *DERlen)
 {
     unsigned char *keyBuf, *dout;
-    char *start, *end, *endTmp;
+    const unsigned char *body;
+    char *start, *end;
     int32 keyBufLen, rc;
     uint32 PEMlen = 0;
+    psSizeL_t bodyLen, consumed;
 
 #  if defined(USE_PKCS5) && defined(USE_PBKDF1)
     psDes3_t dctx;
@@ -1779,36 +1856,18 @@ int32_t psPkcs1DecodePrivFile(psPool_t *pool, const char *fileName,
     start = end = NULL;
 
     /* Check header and encryption parameters. */
-    if (((start = strstr((char *) keyBuf, "-----BEGIN")) != NULL) &&
-        ((start = strstr((char *) keyBuf, "PRIVATE KEY-----")) != NULL) &&
-        ((end = strstr(start, "-----END")) != NULL) &&
-        ((endTmp = strstr(end, "PRIVATE KEY-----")) != NULL))
-    {
-        start += strlen("PRIVATE KEY-----");
-        while (*start == '\x0d' || *start == '\x0a')
-        {
-            start++;
-        }
-        PEMlen = (uint32) (end - start);
-    }
-    else if (((start = strstr((char *) keyBuf, "-----BEGIN")) != NULL) &&
-             ((start = strstr((char *) keyBuf, "PUBLIC KEY-----")) != NULL) &&
-             ((end = strstr(start, "-----END")) != NULL) &&
-             ((endTmp = strstr(end, "PUBLIC KEY-----")) != NULL))
-    {
-        start += strlen("PUBLIC KEY-----");
-        while (*start == '\x0d' || *start == '\x0a')
-        {
-            start++;
-        }
-        PEMlen = (uint32) (end - start);
-    }
-    else
+    if (psPemFindBody(keyBuf, keyBufLen, "PRIVATE KEY", &body, &bodyLen,
+            &consumed) != PS_SUCCESS &&
+        psPemFindBody(keyBuf, keyBufLen, "PUBLIC KEY", &body, &bodyLen,
+            &consumed) != PS_SUCCESS)
     {
         psTraceCrypto("File buffer does not look to be in PKCS#1 PEM format\n");
         psFree(keyBuf, pool);
         return PS_PARSE_FAIL;
     }
+    start = (char *) body;
+    end = start + bodyLen;
+    PEMlen = (uint32) bodyLen;
 
     if (strstr((char *) keyBuf, "Proc-Type:") &&
         strstr((char *) keyBuf, "4,ENCRYPTED"))
@@ -1982,69 +2041,366 @@ int32_t psPkcs5Pbkdf1(unsigned char *pass, uint32 passlen, unsigned char *salt,
 }
 # endif /* USE_PBKDF1 */
 
-# if defined(USE_HMAC_SHA1)
 /******************************************************************************/
 /*
-    Generate a key given a password, salt and iteration value.
-    PKCS#5 2.0 PBKDF2 key derivation format with HMAC-SHA per:
-    http://www.rsasecurity.com/rsalabs/pkcs/pkcs-5/index.html
-
-    Given a password, a salt, and an iteration count (rounds), generate a
-    key suitable for encrypting data with 3DES, AES, etc.
-    key should point to storage as large as kLen
+    PBKDF2 pseudorandom function: HMAC keyed once with the password.  The
+    digests are kept after absorbing K ^ ipad and K ^ opad and cloned for
+    each message, so an iteration costs two compressions instead of four.
  */
-void psPkcs5Pbkdf2(unsigned char *password, uint32 pLen,
-    unsigned char *salt, uint32 sLen, int32 rounds,
-    unsigned char *key, uint32 kLen)
+typedef struct
 {
-    int32 itts;
-    uint32 blkno;
-    unsigned long stored, left, i;
-    unsigned char buf[2][SHA1_HASH_SIZE];
-    psHmacSha1_t hmac;
+    psCipherType_e hash;
+    uint32 hashLen;
+    psDigestContext_t inner;
+    psDigestContext_t outer;
+} pbkdf2Prf_t;
 
-    psAssert(password && salt && key && kLen);
+static int32_t pbkdf2DigestInit(psCipherType_e hash, psDigestContext_t *md)
+{
+    switch (hash)
+    {
+#  ifdef USE_SHA1
+    case HASH_SHA1:
+        psSha1PreInit(&md->sha1);
+        return psSha1Init(&md->sha1);
+#  endif
+#  ifdef USE_SHA256
+    case HASH_SHA256:
+        psSha256PreInit(&md->sha256);
+        return psSha256Init(&md->sha256);
+#  endif
+#  ifdef USE_SHA384
+    case HASH_SHA384:
+        psSha384PreInit(&md->sha384);
+        return psSha384Init(&md->sha384);
+#  endif
+#  ifdef USE_SHA512
+    case HASH_SHA512:
+        psSha512PreInit(&md->sha512);
+        return psSha512Init(&md->sha512);
+#  endif
+    default:
+        return PS_UNSUPPORTED_FAIL;
+    }
+}
 
-    left   = kLen;
-    blkno  = 1;
-    stored = 0;
-    while (left != 0)
+static void pbkdf2DigestUpdate(psCipherType_e hash, psDigestContext_t *md,
+    const unsigned char *buf, uint32 len)
+{
+    switch (hash)
+    {
+#  ifdef USE_SHA1
+    case HASH_SHA1:
+        psSha1Update(&md->sha1, buf, len);
+        break;
+#  endif
+#  ifdef USE_SHA256
+    case HASH_SHA256:
+        psSha256Update(&md->sha256, buf, len);
+        break;
+#  endif
+#  ifdef USE_SHA384
+    case HASH_SHA384:
+        psSha384Update(&md->sha384, buf, len);
+        break;
+#  endif
+#  ifdef USE_SHA512
+    case HASH_SHA512:
+        psSha512Update(&md->sha512, buf, len);
+        break;
+#  endif
+    default:
+        break;
+    }
+}
+
+static void pbkdf2DigestFinal(psCipherType_e hash, psDigestContext_t *md,
+    unsigned char *out)
+{
+    switch (hash)
+    {
+#  ifdef USE_SHA1
+    case HASH_SHA1:
+        psSha1Final(&md->sha1, out);
+        break;
+#  endif
+#  ifdef USE_SHA256
+    case HASH_SHA256:
+        psSha256Final(&md->sha256, out);
+        break;
+#  endif
+#  ifdef USE_SHA384
+    case HASH_SHA384:
+        psSha384Final(&md->sha384, out);
+        break;
+#  endif
+#  ifdef USE_SHA512
+    case HASH_SHA512:
+        psSha512Final(&md->sha512, out);
+        break;
+#  endif
+    default:
+        break;
+    }
+}
+
+static int32_t pbkdf2PrfInit(pbkdf2Prf_t *prf, psCipherType_e hash,
+    const unsigned char *password, uint32 pLen)
+{
+    unsigned char pad[128], hashedKey[SHA512_HASHLEN];
+    uint32 blockLen, i;
+    int32_t rc;
+
+    switch (hash)
+    {
+    case HASH_SHA1:
+        prf->hashLen = SHA1_HASHLEN;
+        blockLen = 64;
+        break;
+    case HASH_SHA256:
+        prf->hashLen = SHA256_HASHLEN;
+        blockLen = 64;
+        break;
+    case HASH_SHA384:
+        prf->hashLen = SHA384_HASHLEN;
+        blockLen = 128;
+        break;
+    case HASH_SHA512:
+        prf->hashLen = SHA512_HASHLEN;
+        blockLen = 128;
+        break;
+    default:
+        psTraceCrypto("Unsupported PBKDF2 hash\n");
+        return PS_UNSUPPORTED_FAIL;
+    }
+    prf->hash = hash;
+    /* Keys longer than the hash block are hashed first, per RFC 2104 */
+    if (pLen > blockLen)
+    {
+        if ((rc = pbkdf2DigestInit(hash, &prf->inner)) < 0)
+        {
+            return rc;
+        }
+        pbkdf2DigestUpdate(hash, &prf->inner, password, pLen);
+        pbkdf2DigestFinal(hash, &prf->inner, hashedKey);
+        password = hashedKey;
+        pLen = prf->hashLen;
+    }
+    for (i = 0; i < blockLen; i++)
+    {
+        pad[i] = (i < pLen ? password[i] : 0) ^ 0x36;
+    }
+    if ((rc = pbkdf2DigestInit(hash, &prf->inner)) < 0)
     {
-        /* process block number blkno */
-        memset(buf[0], 0x0, SHA1_HASH_SIZE * 2);
+        return rc;
+    }
+    pbkdf2DigestUpdate(hash, &prf->inner, pad, blockLen);
+    for (i = 0; i < blockLen; i++)
+    {
+        pad[i] = (i < pLen ? password[i] : 0) ^ 0x5c;
+    }
+    pbkdf2DigestInit(hash, &prf->outer);
+    pbkdf2DigestUpdate(hash, &prf->outer, pad, blockLen);
+
+    memset_s(pad, sizeof(pad), 0x0, sizeof(pad));
+    memset_s(hashedKey, sizeof(hashedKey), 0x0, sizeof(hashedKey));
+    return PS_SUCCESS;
+}
 
-        /* store current block number and increment for next pass */
-        STORE32H(blkno, buf[1]);
-        ++blkno;
+/* out = HMAC(password, a || b), using md as scratch.  out may alias a */
+static void pbkdf2PrfMac(const pbkdf2Prf_t *prf, psDigestContext_t *md,
+    const unsigned char *a, uint32 aLen, const unsigned char *b, uint32 bLen,
+    unsigned char *out)
+{
+    *md = prf->inner;
+    pbkdf2DigestUpdate(prf->hash, md, a, aLen);
+    if (bLen > 0)
+    {
+        pbkdf2DigestUpdate(prf->hash, md, b, bLen);
+    }
+    pbkdf2DigestFinal(prf->hash, md, out);
+    *md = prf->outer;
+    pbkdf2DigestUpdate(prf->hash, md, out, prf->hashLen);
+    pbkdf2DigestFinal(prf->hash, md, out);
+}
 
-        /* get PRF(P, S||int(blkno)) */
-        psHmacSha1Init(&hmac, password, pLen);
-        psHmacSha1Update(&hmac, salt, sLen);
-        psHmacSha1Update(&hmac, buf[1], 4);
-        psHmacSha1Final(&hmac, buf[0]);
+#  if defined(USE_SHA1_LANES) || defined(USE_SHA256_LANES)
+/*
+    Compute up to four consecutive output blocks, starting at blkno, one
+    per SIMD lane.  After U1 every HMAC message is a single hash output,
+    which pads to exactly one block, so each iteration is one compression
+    from the inner state and one from the outer state.  Returns the number
+    of blocks written to out, or 0 if the hash has no lane implementation.
+ */
+static uint32 pbkdf2Lanes(const pbkdf2Prf_t *prf, psDigestContext_t *md,
+    const unsigned char *salt, uint32 sLen, int32 rounds, uint32 blkno,
+    uint32 blocks, unsigned char *out)
+{
+    void (*compress)(uint32_t state[][4], const uint32_t block[16][4]);
+    const uint32 *innerState, *outerState;
+    uint32_t inner[8][4], outer[8][4], state[8][4], msg[16][4], t[8][4];
+    unsigned char u[SHA512_HASHLEN], num[4];
+    uint32 words, i, j;
+    int32 itts;
 
-        /* now compute repeated and XOR it in buf[1] */
-        memcpy(buf[1], buf[0], SHA1_HASH_SIZE);
-        for (itts = 1; itts < rounds; ++itts)
+    compress = NULL;
+    innerState = outerState = NULL;
+#   ifdef USE_SHA1_LANES
+    if (prf->hash == HASH_SHA1)
+    {
+        compress = psSha1CompressLanes;
+        innerState = prf->inner.sha1.state;
+        outerState = prf->outer.sha1.state;
+    }
+#   endif
+#   ifdef USE_SHA256_LANES
+    if (prf->hash == HASH_SHA256)
+    {
+        compress = psSha256CompressLanes;
+        innerState = prf->inner.sha256.state;
+        outerState = prf->outer.sha256.state;
+    }
+#   endif
+    if (compress == NULL)
+    {
+        return 0;
+    }
+    if (blocks > 4)
+    {
+        blocks = 4;
+    }
+    words = prf->hashLen / 4;
+    memset(msg, 0x0, sizeof(msg));
+    for (j = 0; j < 4; j++)
+    {
+        for (i = 0; i < 8; i++)
         {
-            psHmacSha1Init(&hmac, password, pLen);
-            psHmacSha1Update(&hmac, buf[0], SHA1_HASH_SIZE);
-            psHmacSha1Final(&hmac, buf[0]);
-            for (i = 0; i < SHA1_HASH_SIZE; i++)
+            inner[i][j] = i < words ? innerState[i] : 0;
+            outer[i][j] = i < words ? outerState[i] : 0;
+        }
+        if (j < blocks)
+        {
+            STORE32H(blkno + j, num);
+            pbkdf2PrfMac(prf, md, salt, sLen, num, 4, u);
+            for (i = 0; i < words; i++)
             {
-                buf[1][i] ^= buf[0][i];
+                LOAD32H(msg[i][j], u + 4 * i);
             }
         }
-        /* now emit upto x bytes of buf[1] to output */
-        for (i = 0; i < SHA1_HASH_SIZE && left != 0; ++i)
+        /* Padding and bit length of the key block plus one hash output */
+        msg[words][j] = 0x80000000UL;
+        msg[15][j] = (64 + prf->hashLen) * 8;
+    }
+    memcpy(t, msg, words * sizeof(msg[0]));
+    for (itts = 1; itts < rounds; itts++)
+    {
+        memcpy(state, inner, sizeof(state));
+        compress(state, (const uint32_t (*)[4]) msg);
+        memcpy(msg, state, words * sizeof(msg[0]));
+        memcpy(state, outer, sizeof(state));
+        compress(state, (const uint32_t (*)[4]) msg);
+        memcpy(msg, state, words * sizeof(msg[0]));
+        for (i = 0; i < words; i++)
+        {
+            for (j = 0; j < 4; j++)
+            {
+                t[i][j] ^= state[i][j];
+            }
+        }
+    }
+    for (j = 0; j < blocks; j++)
+    {
+        for (i = 0; i < words; i++)
+        {
+            STORE32H(t[i][j], out + j * prf->hashLen + 4 * i);
+        }
+    }
+    memset_s(u, sizeof(u), 0x0, sizeof(u));
+    memset_s(msg, sizeof(msg), 0x0, sizeof(msg));
+    memset_s(state, sizeof(state), 0x0, sizeof(state));
+    memset_s(t, sizeof(t), 0x0, sizeof(t));
+    return blocks;
+}
+#  endif /* USE_SHA1_LANES || USE_SHA256_LANES */
+
+/******************************************************************************/
+/*
+    Generate a key given a password, salt and iteration value.
+    PKCS#5 2.0 PBKDF2 key derivation format per RFC 8018, with HMAC over
+    hash, one of HASH_SHA1, HASH_SHA256, HASH_SHA384 or HASH_SHA512, as the
+    pseudorandom function.
+
+    Given a password, a salt, and an iteration count (rounds), generate a
+    key suitable for encrypting data with 3DES, AES, etc.
+    key should point to storage as large as kLen
+ */
+int32_t psPkcs5Pbkdf2Hmac(psCipherType_e hash,
+    const unsigned char *password, uint32 pLen,
+    const unsigned char *salt, uint32 sLen, int32 rounds,
+    unsigned char *key, uint32 kLen)
+{
+    pbkdf2Prf_t prf;
+    psDigestContext_t md;
+    unsigned char u[SHA512_HASHLEN], t[4 * SHA512_HASHLEN], num[4];
+    uint32 blkno, blocks, n, i;
+    int32 itts, rc;
+
+    if (password == NULL || salt == NULL || key == NULL || kLen == 0)
+    {
+        return PS_ARG_FAIL;
+    }
+    if ((rc = pbkdf2PrfInit(&prf, hash, password, pLen)) < 0)
+    {
+        return rc;
+    }
+    for (blkno = 1; kLen > 0; blkno += blocks)
+    {
+        blocks = 0;
+#  if defined(USE_SHA1_LANES) || defined(USE_SHA256_LANES)
+        if (kLen > prf.hashLen)
+        {
+            blocks = pbkdf2Lanes(&prf, &md, salt, sLen, rounds, blkno,
+                (kLen + prf.hashLen - 1) / prf.hashLen, t);
+        }
+#  endif
+        if (blocks == 0)
         {
-            key[stored++] = buf[1][i];
-            --left;
+            /* T = U1 ^ U2 ^ ... ^ Uc, U1 = PRF(salt || INT(blkno)) */
+            STORE32H(blkno, num);
+            pbkdf2PrfMac(&prf, &md, salt, sLen, num, 4, u);
+            memcpy(t, u, prf.hashLen);
+            for (itts = 1; itts < rounds; itts++)
+            {
+                pbkdf2PrfMac(&prf, &md, u, prf.hashLen, NULL, 0, u);
+                for (i = 0; i < prf.hashLen; i++)
+                {
+                    t[i] ^= u[i];
+                }
+            }
+            blocks = 1;
         }
+        n = min(kLen, blocks * prf.hashLen);
+        memcpy(key, t, n);
+        key += n;
+        kLen -= n;
     }
 
-    memset_s(buf, SHA1_HASH_SIZE * 2, 0x0, SHA1_HASH_SIZE * 2);
-    memset_s(&hmac, sizeof(psHmacSha1_t), 0x0, sizeof(psHmacSha1_t));
+    memset_s(u, sizeof(u), 0x0, sizeof(u));
+    memset_s(t, sizeof(t), 0x0, sizeof(t));
+    memset_s(&md, sizeof(md), 0x0, sizeof(md));
+    memset_s(&prf, sizeof(prf), 0x0, sizeof(prf));
+    return PS_SUCCESS;
+}
+
+# if defined(USE_HMAC_SHA1)
+/* PBKDF2 with HMAC-SHA1, the PKCS#5 default */
+void psPkcs5Pbkdf2(unsigned char *password, uint32 pLen,
+    unsigned char *salt, uint32 sLen, int32 rounds,
+    unsigned char *key, uint32 kLen)
+{
+    psAssert(password && salt && key && kLen);
+    psPkcs5Pbkdf2Hmac(HASH_SHA1, password, pLen, salt, sLen, rounds, key,
+        kLen);
 }
 # endif /* USE_HMAC && USE_SHA1 */
 #endif  /* USE_PKCS5 */
@@ -2065,9 +2421,11 @@ void psPkcs5Pbkdf2(unsigned char *password, uint32 pLen,
 int32_t psPkcs3ParseDhParamFile(psPool_t *pool, const char *fileName, psDhParams_t *params)
 {
     unsigned char *pemOut, *p;
-    char *dhFileBuf, *start, *end;
+    const unsigned char *body;
+    char *dhFileBuf, *start;
     int32_t rc;
     psSize_t baseLen, pemOutLen;
+    psSizeL_t bodyLen, consumed;
     int32_t dhFileLen;
 
     if (!params || !fileName)
@@ -2080,29 +2438,15 @@ int32_t psPkcs3ParseDhParamFile(psPool_t *pool, const char *fileName, psDhParams
     {
         return rc;
     }
-    /* Set end to end of file buffer */
-    end = dhFileBuf + dhFileLen;
-    /* Set start to start of token */
-    if ((start = strstr(dhFileBuf, "-----BEGIN DH PARAMETERS-----")) == NULL)
-    {
-        psTraceStrCrypto("Error parsing dh file buffer header: %s\n", fileName);
-        psFree(dhFileBuf, pool);
-        return PS_PARSE_FAIL;
-    }
-    /* Move start to start of PEM data, skipping CR/LF */
-    start += 29; /* strlen("-----BEGIN DH PARAMETERS-----"); */
-    while (start < end && (*start == '\x0d' || *start == '\x0a'))
-    {
-        start++;
-    }
-    /* Set end to end token */
-    if ((end = strstr(start, "-----END DH PARAMETERS-----")) == NULL)
+    if (psPemFindBody((unsigned char *) dhFileBuf, dhFileLen, "DH PARAMETERS",
+            &body, &bodyLen, &consumed) != PS_SUCCESS)
     {
-        psTraceStrCrypto("Error parsing dh file buffer footer: %s\n", fileName);
+        psTraceStrCrypto("Error parsing dh file buffer: %s\n", fileName);
         psFree(dhFileBuf, pool);
         return PS_PARSE_FAIL;
     }
-    baseLen = (uint16_t) (end - start);
+    start = (char *) body;
+    baseLen = (uint16_t) bodyLen;
 
     p = NULL;
     p = pemOut = psMalloc(pool, baseLen);
@@ -158,7 +158,9 @@ static int32_t getTimeValidity(psPool_t *pool, const unsigned char **pp,
                                char **notBefore, char **notAfter);
 static int32_t getImplicitBitString(psPool_t *pool, const unsigned char **pp,
                                     psSize_t len, int32_t impVal, unsigned char **bitString,
-                                    psSize_t *bitLen);
+                                    psSize_t *bitLen, uint32_t flags);
+static int32_t getSerialNumView(const unsigned char **pp, psSize_t len,
+                                const unsigned char **sn, psSize_t *snLen);
 static int32_t validateDateRange(psX509Cert_t *cert);
 static int32_t issuedBefore(rfc_e rfc, const psX509Cert_t *cert);
 
@@ -169,12 +171,15 @@ static int32_t x509ConfirmSignature(const unsigned char *sigHash,
 
 # endif /* USE_CERT_PARSE */
 
+static int32_t x509GetSignatureView(const unsigned char **pp, psSize_t len,
+                                    const unsigned char **sig, psSize_t *sigLen);
+
 /******************************************************************************/
 # ifdef MATRIX_USE_FILE_SYSTEM
 /******************************************************************************/
 
 static int32_t pemCertFileBufToX509(psPool_t *pool, const unsigned char *fileBuf,
-                                    psSize_t fileBufLen, psList_t **x509certList);
+                                    psSizeL_t fileBufLen, psList_t **x509certList);
 
 /******************************************************************************/
 /*
@@ -288,67 +293,53 @@ int32 psX509ParseCertFile(psPool_t *pool, char *fileName,
 
 /******************************************************************************/
 /*
+    Decode each CERTIFICATE block of a PEM file into x509certList.  Text
+    between the blocks, such as the comments in CA bundles, is skipped.
  */
 static int32_t pemCertFileBufToX509(psPool_t *pool, const unsigned char *fileBuf,
-    psSize_t fileBufLen, psList_t **x509certList)
+    psSizeL_t fileBufLen, psList_t **x509certList)
 {
     psList_t *front, *prev, *current;
-    unsigned char *start, *end, *endTmp;
-    const unsigned char *chFileBuf;
-    unsigned char l;
+    const unsigned char *start;
+    psSizeL_t len, consumed;
+    int32_t rc;
 
     *x509certList = NULL;
-    prev = NULL;
     if (fileBuf == NULL)
     {
         psTraceCrypto("Bad parameters to pemCertFileBufToX509\n");
         return PS_ARG_FAIL;
     }
-    front = current = psMalloc(pool, sizeof(psList_t));
-    if (current == NULL)
-    {
-        psError("Memory allocation error first pemCertFileBufToX509\n");
-        return PS_MEM_FAIL;
-    }
-    l = strlen("CERTIFICATE-----");
-    memset(current, 0x0, sizeof(psList_t));
-    chFileBuf = fileBuf;
-    while (fileBufLen > 0)
+    front = prev = NULL;
+    while ((rc = psPemFindBody(fileBuf, fileBufLen, "CERTIFICATE", &start,
+                 &len, &consumed)) == PS_SUCCESS)
     {
-        if (
-            ((start = (unsigned char *) strstr((char *) chFileBuf, "-----BEGIN")) != NULL) &&
-            ((start = (unsigned char *) strstr((char *) chFileBuf, "CERTIFICATE-----")) != NULL) &&
-            ((end = (unsigned char *) strstr((char *) start, "-----END")) != NULL) &&
-            ((endTmp = (unsigned char *) strstr((char *) end, "CERTIFICATE-----")) != NULL)
-            )
+        fileBuf += consumed;
+        fileBufLen -= consumed;
+        if (len > 0xFFFF)
         {
-            start += l;
-            if (current == NULL)
-            {
-                current = psMalloc(pool, sizeof(psList_t));
-                if (current == NULL)
-                {
-                    psFreeList(front, pool);
-                    psError("Memory allocation error: pemCertFileBufToX509\n");
-                    return PS_MEM_FAIL;
-                }
-                memset(current, 0x0, sizeof(psList_t));
-                prev->next = current;
-            }
-            current->len = (uint16_t) (end - start);
-            end = endTmp + l;
-            while (*end == '\x0d' || *end == '\x0a' || *end == '\x09'
-                   || *end == ' ')
-            {
-                end++;
-            }
+            psFreeList(front, pool);
+            psTraceCrypto("PEM certificate too large\n");
+            return PS_LIMIT_FAIL;
         }
-        else
+        current = psMalloc(pool, sizeof(psList_t));
+        if (current == NULL)
         {
             psFreeList(front, pool);
-            psTraceCrypto("File buffer does not look to be X.509 PEM format\n");
-            return PS_PARSE_FAIL;
+            psError("Memory allocation error: pemCertFileBufToX509\n");
+            return PS_MEM_FAIL;
         }
+        memset(current, 0x0, sizeof(psList_t));
+        if (prev == NULL)
+        {
+            front = current;
+        }
+        else
+        {
+            prev->next = current;
+        }
+        prev = current;
+        current->len = (uint16_t) len;
         current->item = psMalloc(pool, current->len);
         if (current->item == NULL)
         {
@@ -356,20 +347,18 @@ static int32_t pemCertFileBufToX509(psPool_t *pool, const unsigned char *fileBuf
             psError("Memory allocation error: pemCertFileBufToX509\n");
             return PS_MEM_FAIL;
         }
-        memset(current->item, '\0', current->len);
-
-        fileBufLen -= (uint16_t) (end - fileBuf);
-        fileBuf = end;
-
         if (psBase64decode(start, current->len, current->item, &current->len) != 0)
         {
             psFreeList(front, pool);
             psTraceCrypto("Unable to base64 decode certificate\n");
             return PS_PARSE_FAIL;
         }
-        prev = current;
-        current = current->next;
-        chFileBuf = fileBuf;
+    }
+    if (rc != PS_FAILURE || front == NULL)
+    {
+        psFreeList(front, pool);
+        psTraceCrypto("File buffer does not look to be X.509 PEM format\n");
+        return PS_PARSE_FAIL;
     }
     *x509certList = front;
     return PS_SUCCESS;
@@ -708,7 +697,13 @@ static int parse_single_cert(psPool_t *pool, const unsigned char **pp,
       If the user has specified to keep the ASN.1 buffer in the X.509
       structure, now is the time to account for it
     */
-    if (flags & CERT_STORE_UNPARSED_BUFFER)
+    if (flags & CERT_EXTERNAL_BUFFER)
+    {
+        cert->binLen = oneCertLen + (int32) (p - certStart);
+        cert->unparsedBin = (unsigned char *) certStart;
+        cert->binExternal = 1;
+    }
+    else if (flags & CERT_STORE_UNPARSED_BUFFER)
     {
         cert->binLen = oneCertLen + (int32) (p - certStart);
         cert->unparsedBin = psMalloc(pool, cert->binLen);
@@ -720,6 +715,14 @@ static int parse_single_cert(psPool_t *pool, const unsigned char **pp,
         }
         memcpy(cert->unparsedBin, certStart, cert->binLen);
     }
+    /* Parse the retained copy, so that the field views point into it */
+    if (flags & CERT_ZERO_COPY)
+    {
+        p = cert->unparsedBin + (p - certStart);
+        end = cert->unparsedBin + cert->binLen;
+        certStart = cert->unparsedBin;
+        cert->zeroCopy = 1;
+    }
 
 # ifdef ENABLE_CA_CERT_HASH
     /* We use the cert_sha1_hash type for the Trusted CA Indication so
@@ -808,8 +811,18 @@ static int parse_single_cert(psPool_t *pool, const unsigned char **pp,
       There is a special return code for a missing serial number that
       will get written to the parse warning flag
     */
-    if ((rc = getSerialNum(pool, &p, (uint32) (end - p), &cert->serialNumber,
-                            &cert->serialNumberLen)) < 0)
+    if (flags & CERT_ZERO_COPY)
+    {
+        rc = getSerialNumView(&p, (uint32) (end - p),
+            (const unsigned char **) &cert->serialNumber,
+            &cert->serialNumberLen);
+    }
+    else
+    {
+        rc = getSerialNum(pool, &p, (uint32) (end - p), &cert->serialNumber,
+            &cert->serialNumberLen);
+    }
+    if (rc < 0)
     {
         psTraceCrypto("ASN serial number parse error\n");
         func_rc = rc;
@@ -1015,6 +1028,34 @@ static int parse_single_cert(psPool_t *pool, const unsigned char **pp,
 
         break;
 #  endif
+#  ifdef USE_ED25519
+    case OID_ED25519_KEY_ALG:
+        /* No parameters, and the key is the whole BIT STRING (RFC 8410) */
+        if (plen != 0 || (uint32) (end - p) < ED25519_KEY_SIZE + 3 ||
+            p[0] != ASN_BIT_STRING || p[1] != ED25519_KEY_SIZE + 1 ||
+            p[2] != 0)
+        {
+            psTraceCrypto("Bad Ed25519 public key\n");
+            func_rc = PS_PARSE_FAIL;
+            goto out;
+        }
+        p += 3;
+        psInitPubKey(pool, &cert->publicKey, PS_ED25519);
+        if (psEd25519ImportPubKey(&cert->publicKey.key.ed25519, p) < 0)
+        {
+            func_rc = PS_PARSE_FAIL;
+            goto out;
+        }
+        cert->publicKey.keysize = ED25519_KEY_SIZE;
+#   ifdef USE_SHA1
+        psSha1PreInit(&hashCtx.sha1);
+        psSha1Init(&hashCtx.sha1);
+        psSha1Update(&hashCtx.sha1, p, ED25519_KEY_SIZE);
+        psSha1Final(&hashCtx.sha1, sha1KeyHash);
+#   endif
+        p += ED25519_KEY_SIZE;
+        break;
+#  endif
     default:
         /* Note 645:RSA, 515:DSA, 518:ECDSA, 32969:GOST */
         psTraceIntCrypto(
@@ -1035,12 +1076,12 @@ static int parse_single_cert(psPool_t *pool, const unsigned char **pp,
     {
         if (getImplicitBitString(pool, &p, (uint32) (end - p),
                         IMPLICIT_ISSUER_ID, &cert->uniqueIssuerId,
-                        &cert->uniqueIssuerIdLen) < 0 ||
+                        &cert->uniqueIssuerIdLen, flags) < 0 ||
                 getImplicitBitString(pool, &p, (uint32) (end - p),
                         IMPLICIT_SUBJECT_ID, &cert->uniqueSubjectId,
-                        &cert->uniqueSubjectIdLen) < 0 ||
+                        &cert->uniqueSubjectIdLen, flags) < 0 ||
                 getExplicitExtensions(pool, &p, (uint32) (end - p),
-                        EXPLICIT_EXTENSION, &cert->extensions, 0) < 0)
+                        EXPLICIT_EXTENSION, &cert->extensions, 0, flags) < 0)
         {
             psTraceCrypto("There was an error parsing a certificate\n"
                     "extension.  This is likely caused by an\n"
@@ -1062,8 +1103,19 @@ static int parse_single_cert(psPool_t *pool, const unsigned char **pp,
         goto out;
     }
 
-    /* Reject any cert without a distinguishedName or subjectAltName */
-    if (cert->subject.commonName == NULL &&
+    /* Reject any cert without a distinguishedName or subjectAltName.
+       Deferred, an empty DN SEQUENCE and no subjectAltName. */
+    if (cert->subject.deferred)
+    {
+        if (cert->subject.dnencLen <= 2 && cert->extensions.sanDer == NULL)
+        {
+            psTraceCrypto("Error. Cert has no name information\n");
+            cert->parseStatus = PS_X509_MISSING_NAME;
+            func_rc = PS_PARSE_FAIL;
+            goto out;
+        }
+    }
+    else if (cert->subject.commonName == NULL &&
             cert->subject.country == NULL &&
             cert->subject.state == NULL &&
             cert->subject.organization == NULL &&
@@ -1279,6 +1331,25 @@ static int parse_single_cert(psPool_t *pool, const unsigned char **pp,
         } /* switch pssHash */
         break;
 #  endif /* USE_PKCS1_PSS */
+#  ifdef USE_ED25519
+    case OID_ED25519_SIG:
+        /* Ed25519 signs the TBSCertificate itself, keep it for the check */
+        if (flags & CERT_ZERO_COPY)
+        {
+            cert->tbsCert = (unsigned char *) tbsCertStart;
+        }
+        else if ((cert->tbsCert = psMalloc(pool, certLen)) == NULL)
+        {
+            func_rc = PS_MEM_FAIL;
+            goto out;
+        }
+        else
+        {
+            memcpy(cert->tbsCert, tbsCertStart, certLen);
+        }
+        cert->tbsCertLen = certLen;
+        break;
+#  endif
 
     default:
         /* Note 1670:MD2 */
@@ -1291,7 +1362,11 @@ static int parse_single_cert(psPool_t *pool, const unsigned char **pp,
     } /* switch certAlgorithm */
 
     /* 6 empty bytes is plenty enough to know if sigHash didn't calculate */
-    if (memcmp(cert->sigHash, "\0\0\0\0\0\0", 6) == 0)
+    if (
+#  ifdef USE_ED25519
+        cert->certAlgorithm != OID_ED25519_SIG &&
+#  endif
+        memcmp(cert->sigHash, "\0\0\0\0\0\0", 6) == 0)
     {
         psTraceIntCrypto("No library signature alg support for cert: %d\n",
                 cert->certAlgorithm);
@@ -1301,8 +1376,17 @@ static int parse_single_cert(psPool_t *pool, const unsigned char **pp,
     }
 # endif /* USE_CERT_PARSE */
 
-    if ((rc = psX509GetSignature(pool, &p, (uint32) (end - p),
-                            &cert->signature, &cert->signatureLen)) < 0)
+    if (flags & CERT_ZERO_COPY)
+    {
+        rc = x509GetSignatureView(&p, (uint32) (end - p),
+            (const unsigned char **) &cert->signature, &cert->signatureLen);
+    }
+    else
+    {
+        rc = psX509GetSignature(pool, &p, (uint32) (end - p),
+            &cert->signature, &cert->signatureLen);
+    }
+    if (rc < 0)
     {
         psTraceCrypto("Couldn't parse signature\n");
         cert->parseStatus = PS_X509_SIGNATURE;
@@ -1323,7 +1407,8 @@ out:
     }
     psAssert(p <= end); /* Must not have parsed too much. */
 
-    *pp = end;
+    /* end may point into unparsedBin, see CERT_ZERO_COPY */
+    *pp += end - certStart;
 
     return func_rc;
 }
@@ -1336,6 +1421,9 @@ out:
     flags
         CERT_STORE_UNPARSED_BUFFER
         CERT_STORE_DN_BUFFER
+        CERT_LAZY_PARSE
+        CERT_ZERO_COPY
+        CERT_EXTERNAL_BUFFER
 
     Memory info:
         Caller must always free outcert with psX509FreeCert.  Even on failure
@@ -1369,6 +1457,14 @@ int32 psX509ParseCert(psPool_t *pool, const unsigned char *pp, uint32 size,
 # ifdef ALWAYS_KEEP_CERT_DER
     flags |= CERT_STORE_UNPARSED_BUFFER;
 # endif /* ALWAYS_KEEP_CERT_DER */
+    if (flags & CERT_EXTERNAL_BUFFER)
+    {
+        flags |= CERT_ZERO_COPY;
+    }
+    if (flags & CERT_ZERO_COPY)
+    {
+        flags |= CERT_STORE_UNPARSED_BUFFER;
+    }
 
     p = pp;
     far_end = p + size;
@@ -1503,6 +1599,7 @@ void x509FreeExtensions(x509v3extensions_t *extensions)
     {
         return;
     }
+    psFree(extensions->sanDer, extensions->pool);
     if (extensions->san)
     {
         active = extensions->san;
@@ -2190,7 +2287,31 @@ void psX509FreeCert(psX509Cert_t *cert)
     while (curr)
     {
         pool = curr->pool;
-        if (curr->unparsedBin)
+# ifdef USE_CERT_PARSE
+        if (curr->deferred)
+        {
+            /* The key identifier is a view into the trust store image */
+            curr->extensions.sk.id = NULL;
+            psX509FreeCert(curr->parsed);
+        }
+# endif /* USE_CERT_PARSE */
+        if (curr->zeroCopy)
+        {
+            /* Views into unparsedBin, not separately allocated */
+            curr->signature = NULL;
+# ifdef USE_CERT_PARSE
+            curr->serialNumber = NULL;
+            curr->uniqueIssuerId = NULL;
+            curr->uniqueSubjectId = NULL;
+            curr->issuer.dnenc = NULL;
+            curr->subject.dnenc = NULL;
+            curr->extensions.sanDer = NULL;
+#  ifdef USE_ED25519
+            curr->tbsCert = NULL;
+#  endif
+# endif /* USE_CERT_PARSE */
+        }
+        if (curr->unparsedBin && !curr->binExternal)
         {
             psFree(curr->unparsedBin, pool);
         }
@@ -2221,8 +2342,17 @@ void psX509FreeCert(psX509Cert_t *cert)
         {
             psFree(curr->uniqueSubjectId, pool);
         }
+#  ifdef USE_ED25519
+        if (curr->tbsCert)
+        {
+            psFree(curr->tbsCert, pool);
+        }
+#  endif
 
 
+#  ifdef USE_PUBKEY_PRECOMP
+        psPubKeyPrecompFree(curr->keyPrecomp);
+#  endif
         if (curr->publicKey.type != PS_NOKEY)
         {
             switch (curr->pubKeyAlgorithm)
@@ -2238,6 +2368,11 @@ void psX509FreeCert(psX509Cert_t *cert)
                 psEccClearKey(&curr->publicKey.key.ecc);
                 break;
 #  endif
+#  ifdef USE_ED25519
+            case OID_ED25519_KEY_ALG:
+                psEd25519ClearKey(&curr->publicKey.key.ed25519);
+                break;
+#  endif
 
             default:
                 psAssert(0);
@@ -2259,8 +2394,8 @@ void psX509FreeCert(psX509Cert_t *cert)
     Currently just returning the raw BIT STRING and size in bytes
  */
 # define MIN_HASH_SIZE   16
-int32_t psX509GetSignature(psPool_t *pool, const unsigned char **pp, psSize_t len,
-    unsigned char **sig, psSize_t *sigLen)
+static int32_t x509GetSignatureView(const unsigned char **pp, psSize_t len,
+    const unsigned char **sig, psSize_t *sigLen)
 {
     const unsigned char *p = *pp, *end;
     psSize_t llen;
@@ -2280,14 +2415,28 @@ int32_t psX509GetSignature(psPool_t *pool, const unsigned char **pp, psSize_t le
     p++;
     /* Length was including the ignore_bits byte, subtract it */
     *sigLen = llen - 1;
+    *sig = p;
+    *pp = p + *sigLen;
+    return PS_SUCCESS;
+}
+
+int32_t psX509GetSignature(psPool_t *pool, const unsigned char **pp, psSize_t len,
+    unsigned char **sig, psSize_t *sigLen)
+{
+    const unsigned char *view;
+    int32_t rc;
+
+    if ((rc = x509GetSignatureView(pp, len, &view, sigLen)) < 0)
+    {
+        return rc;
+    }
     *sig = psMalloc(pool, *sigLen);
     if (*sig == NULL)
     {
         psError("Memory allocation error in getSignature\n");
         return PS_MEM_FAIL;
     }
-    memcpy(*sig, p, *sigLen);
-    *pp = p + *sigLen;
+    memcpy(*sig, view, *sigLen);
     return PS_SUCCESS;
 }
 
@@ -3429,7 +3578,7 @@ int32_t parseAuthorityInfoAccess(psPool_t *pool,
 
 int32_t getExplicitExtensions(psPool_t *pool, const unsigned char **pp,
     psSize_t inlen, int32_t expVal,
-    x509v3extensions_t *extensions, uint8_t known)
+    x509v3extensions_t *extensions, uint8_t known, uint32_t flags)
 {
     const unsigned char *p = *pp, *end;
     const unsigned char *extEnd, *extStart, *save;
@@ -3654,6 +3803,30 @@ KNOWN_EXT:
                 psTraceCrypto("Error parsing altSubjectName extension\n");
                 return PS_PARSE_FAIL;
             }
+            /* Kept for psX509DecodeCert */
+            if (flags & CERT_LAZY_PARSE)
+            {
+                if (extensions->sanDer != NULL)
+                {
+                    psTraceCrypto("Multiple altSubjectName extensions\n");
+                    return PS_PARSE_FAIL;
+                }
+                if (flags & CERT_ZERO_COPY)
+                {
+                    extensions->sanDer = (unsigned char *) p;
+                }
+                else if ((extensions->sanDer = psMalloc(pool, len)) == NULL)
+                {
+                    return PS_MEM_FAIL;
+                }
+                else
+                {
+                    memcpy(extensions->sanDer, p, len);
+                }
+                extensions->sanDerLen = len;
+                p += len;
+                break;
+            }
             /* NOTE: The final limit parameter was introduced for this
                 case because a well known search engine site sends back
                 about 7 KB worth of subject alt names and that has created
@@ -4228,9 +4401,10 @@ KNOWN_EXT:
     Although a certificate serial number is encoded as an integer type, that
     doesn't prevent it from being abused as containing a variable length
     binary value.  Get it here.
+    getSerialNumView leaves *sn pointing into the input buffer.
  */
-int32_t getSerialNum(psPool_t *pool, const unsigned char **pp, psSize_t len,
-    unsigned char **sn, psSize_t *snLen)
+static int32_t getSerialNumView(const unsigned char **pp, psSize_t len,
+    const unsigned char **sn, psSize_t *snLen)
 {
     const unsigned char *p = *pp;
     psSize_t vlen;
@@ -4249,19 +4423,31 @@ int32_t getSerialNum(psPool_t *pool, const unsigned char **pp, psSize_t len,
         return PS_PARSE_FAIL;
     }
     *snLen = vlen;
+    *sn = (vlen > 0) ? p : NULL;
+    *pp = p + vlen;
+    return PS_SUCCESS;
+}
 
-    if (vlen > 0)
+int32_t getSerialNum(psPool_t *pool, const unsigned char **pp, psSize_t len,
+    unsigned char **sn, psSize_t *snLen)
+{
+    const unsigned char *view;
+    int32_t rc;
+
+    if ((rc = getSerialNumView(pp, len, &view, snLen)) < 0)
+    {
+        return rc;
+    }
+    if (view != NULL)
     {
-        *sn = psMalloc(pool, vlen);
+        *sn = psMalloc(pool, *snLen);
         if (*sn == NULL)
         {
             psError("Memory allocation failure in getSerialNum\n");
             return PS_MEM_FAIL;
         }
-        memcpy(*sn, p, vlen);
-        p += vlen;
+        memcpy(*sn, view, *snLen);
     }
-    *pp = p;
     return PS_SUCCESS;
 }
 
@@ -4541,10 +4727,11 @@ static int32_t getTimeValidity(psPool_t *pool, const unsigned char **pp,
 /*
     Could be optional.  If the tag doesn't contain the value from the left
     of the IMPLICIT keyword we don't have a match and we don't incr the pointer.
+    With CERT_ZERO_COPY *bitString points into the input buffer.
  */
 static int32_t getImplicitBitString(psPool_t *pool, const unsigned char **pp,
     psSize_t len, int32_t impVal, unsigned char **bitString,
-    psSize_t *bitLen)
+    psSize_t *bitLen, uint32_t flags)
 {
     const unsigned char *p = *pp;
     int32_t ignore_bits;
@@ -4573,6 +4760,12 @@ static int32_t getImplicitBitString(psPool_t *pool, const unsigned char **pp,
     (*bitLen)--;
     psAssert(ignore_bits == 0);
 
+    if (flags & CERT_ZERO_COPY)
+    {
+        *bitString = (unsigned char *) p;
+        *pp = p + *bitLen;
+        return PS_SUCCESS;
+    }
     *bitString = psMalloc(pool, *bitLen);
     if (*bitString == NULL)
     {
@@ -4623,7 +4816,13 @@ int32_t psX509GetDNAttributes(psPool_t *pool, const unsigned char **pp,
 /*
     The possibility of a CERTIFICATE_REQUEST message.  Set aside full DN
  */
-    if (flags & CERT_STORE_DN_BUFFER)
+    if ((flags & (CERT_STORE_DN_BUFFER | CERT_LAZY_PARSE)) &&
+        (flags & CERT_ZERO_COPY))
+    {
+        attribs->dnencLen = (uint32) (dnEnd - dnStart);
+        attribs->dnenc = (char *) dnStart;
+    }
+    else if (flags & (CERT_STORE_DN_BUFFER | CERT_LAZY_PARSE))
     {
         attribs->dnencLen = (uint32) (dnEnd - dnStart);
         attribs->dnenc = psMalloc(pool, attribs->dnencLen);
@@ -4634,6 +4833,13 @@ int32_t psX509GetDNAttributes(psPool_t *pool, const unsigned char **pp,
         }
         memcpy(attribs->dnenc, dnStart, attribs->dnencLen);
     }
+    /* The attributes are decoded from dnenc by psX509DecodeDN */
+    if (flags & CERT_LAZY_PARSE)
+    {
+        attribs->deferred = 1;
+        p = dnEnd;
+        goto hash_dn;
+    }
     moreInSet = 0;
     while (p < dnEnd)
     {
@@ -5081,6 +5287,7 @@ oid_parsing_done:
             goto MORE_IN_SET;
         }
     }
+hash_dn:
     /* Hash is used to quickly compare DNs */
 #  ifdef USE_SHA1
     psSha1PreInit(&hash);
@@ -5097,6 +5304,64 @@ oid_parsing_done:
     return PS_SUCCESS;
 }
 
+/******************************************************************************/
+/*
+    Decode the attributes of a DN parsed with CERT_LAZY_PARSE from its DER.
+    Does nothing for a DN that is already decoded.
+ */
+int32_t psX509DecodeDN(psPool_t *pool, x509DNattributes_t *dn)
+{
+    const unsigned char *p;
+
+    if (!dn->deferred)
+    {
+        return PS_SUCCESS;
+    }
+    dn->deferred = 0;
+    p = (const unsigned char *) dn->dnenc;
+    return psX509GetDNAttributes(pool, &p, dn->dnencLen, dn, 0);
+}
+
+/*
+    Decode what CERT_LAZY_PARSE deferred in 'cert': the issuer and subject
+    attributes and the subjectAltName entries.  Call this before reading
+    any of those from a certificate that may have been parsed lazily.
+    Only the first certificate of a chain is decoded.
+ */
+int32_t psX509DecodeCert(psX509Cert_t *cert)
+{
+    const unsigned char *p;
+    int32_t rc;
+
+    if (cert == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    if ((rc = psX509DecodeDN(cert->pool, &cert->issuer)) < 0 ||
+        (rc = psX509DecodeDN(cert->pool, &cert->subject)) < 0)
+    {
+        return rc;
+    }
+    if (cert->extensions.sanDer != NULL)
+    {
+        p = cert->extensions.sanDer;
+        rc = parseGeneralNames(cert->pool, &p, cert->extensions.sanDerLen,
+            p + cert->extensions.sanDerLen, &cert->extensions.san, -1);
+        if (!cert->zeroCopy)
+        {
+            psFree(cert->extensions.sanDer, cert->pool);
+        }
+        cert->extensions.sanDer = NULL;
+        cert->extensions.sanDerLen = 0;
+        if (rc < 0)
+        {
+            psTraceCrypto("Error parsing altSubjectName names\n");
+            return PS_PARSE_FAIL;
+        }
+    }
+    return PS_SUCCESS;
+}
+
 /******************************************************************************/
 /*
     Free helper
@@ -5133,6 +5398,34 @@ void psX509FreeDNStruct(x509DNattributes_t *dn, psPool_t *allocPool)
 }
 
 
+#  ifdef USE_PUBKEY_PRECOMP
+/******************************************************************************/
+/**
+    Attach precomputed public key data to each certificate in the 'certs'
+    chain that does not have it yet. psX509AuthenticateCert() uses it when
+    the certificate is the issuer, so this is meant for trusted CA
+    certificates that authenticate many chains.
+    A certificate whose key cannot be precomputed is left as it is.
+ */
+void psX509PrecomputeKeys(psX509Cert_t *certs)
+{
+    psX509Cert_t *curr;
+
+    for (curr = certs; curr != NULL; curr = curr->next)
+    {
+        if (curr->keyPrecomp != NULL || curr->publicKey.type == PS_NOKEY)
+        {
+            continue;
+        }
+        if (psPubKeyPrecompute(curr->pool, &curr->publicKey,
+                &curr->keyPrecomp) < 0)
+        {
+            psTraceCrypto("Unable to precompute certificate public key\n");
+        }
+    }
+}
+#  endif /* USE_PUBKEY_PRECOMP */
+
 /******************************************************************************/
 /*
     Fundamental routine to test whether the supplied issuerCert issued
@@ -5445,6 +5738,11 @@ int32 psX509AuthenticateCert(psPool_t *pool, psX509Cert_t *subjectCert,
             }
             sigType = RSAPSS_TYPE_SIG;
             break;
+#  endif
+#  ifdef USE_ED25519
+        case OID_ED25519_SIG:
+            sigType = ED25519_TYPE_SIG;
+            break;
 #  endif
         default:
             sigType = PS_UNSUPPORTED_FAIL;
@@ -5478,8 +5776,15 @@ int32 psX509AuthenticateCert(psPool_t *pool, psX509Cert_t *subjectCert,
             }
             memcpy(tempSig, sc->signature, sc->signatureLen);
 
-            if ((rc = psRsaDecryptPub(pkiPool, &ic->publicKey.key.rsa,
-                     tempSig, sc->signatureLen, sigOut, sigLen, rsaData)) < 0)
+#   ifdef USE_PUBKEY_PRECOMP
+            rc = psRsaDecryptPubExt(pkiPool, &ic->publicKey.key.rsa,
+                ic->keyPrecomp, tempSig, sc->signatureLen, sigOut, sigLen,
+                rsaData);
+#   else
+            rc = psRsaDecryptPub(pkiPool, &ic->publicKey.key.rsa,
+                tempSig, sc->signatureLen, sigOut, sigLen, rsaData);
+#   endif
+            if (rc < 0)
             {
 
                 psTraceCrypto("Unable to RSA decrypt certificate signature\n");
@@ -5500,9 +5805,16 @@ int32 psX509AuthenticateCert(psPool_t *pool, psX509Cert_t *subjectCert,
                 return PS_MEM_FAIL;
             }
             pssLen = sc->signatureLen;
-            if ((rc = psRsaCrypt(pkiPool, &ic->publicKey.key.rsa,
-                     sc->signature, sc->signatureLen, tempSig, &pssLen,
-                     PS_PUBKEY, rsaData)) < 0)
+#    ifdef USE_PUBKEY_PRECOMP
+            rc = psRsaCryptExt(pkiPool, &ic->publicKey.key.rsa,
+                ic->keyPrecomp, sc->signature, sc->signatureLen, tempSig,
+                &pssLen, PS_PUBKEY, rsaData);
+#    else
+            rc = psRsaCrypt(pkiPool, &ic->publicKey.key.rsa,
+                sc->signature, sc->signatureLen, tempSig, &pssLen,
+                PS_PUBKEY, rsaData);
+#    endif
+            if (rc < 0)
             {
                 psFree(tempSig, pool);
                 return rc;
@@ -5529,11 +5841,16 @@ int32 psX509AuthenticateCert(psPool_t *pool, psX509Cert_t *subjectCert,
 #  ifdef USE_ECC
         if (sigType == ECDSA_TYPE_SIG)
         {
-            if ((rc = psEccDsaVerify(pkiPool,
-                     &ic->publicKey.key.ecc,
-                     sc->sigHash, sigLen,
-                     sc->signature, sc->signatureLen,
-                     &sigStat, rsaData)) != 0)
+#   ifdef USE_PUBKEY_PRECOMP
+            rc = psEccDsaVerifyExt(pkiPool, &ic->publicKey.key.ecc,
+                ic->keyPrecomp, sc->sigHash, sigLen,
+                sc->signature, sc->signatureLen, &sigStat, rsaData);
+#   else
+            rc = psEccDsaVerify(pkiPool, &ic->publicKey.key.ecc,
+                sc->sigHash, sigLen,
+                sc->signature, sc->signatureLen, &sigStat, rsaData);
+#   endif
+            if (rc != 0)
             {
                 psTraceCrypto("Error validating ECDSA certificate signature\n");
                 sc->authStatus = PS_CERT_AUTH_FAIL_SIG;
@@ -5548,6 +5865,25 @@ int32 psX509AuthenticateCert(psPool_t *pool, psX509Cert_t *subjectCert,
         }
 #  endif /* USE_ECC */
 
+#  ifdef USE_ED25519
+        if (sigType == ED25519_TYPE_SIG)
+        {
+            if (ic->publicKey.type != PS_ED25519 || sc->tbsCert == NULL)
+            {
+                sc->authStatus = PS_CERT_AUTH_FAIL_SIG;
+                return PS_CERT_AUTH_FAIL_SIG;
+            }
+            rc = psEd25519Verify(&ic->publicKey.key.ed25519,
+                sc->tbsCert, sc->tbsCertLen,
+                sc->signature, sc->signatureLen, &sigStat);
+            if (rc == 0 && sigStat == -1)
+            {
+                psTraceCrypto("Ed25519 certificate signature failed\n");
+                rc = -1;
+            }
+        }
+#  endif /* USE_ED25519 */
+
 /*
         Test what happen in the signature test?
  */
@@ -5672,6 +6008,563 @@ L_INTERMEDIATE_ROOT:
     return PS_SUCCESS;
 }
 
+/******************************************************************************/
+/*
+    Index a list of trusted certificates so that the possible issuers of a
+    certificate can be found without trying each one in turn.
+    psX509AuthenticateCert only accepts an issuer whose subject DN hash
+    equals the issuer DN hash of the subject, so that is the key here.
+
+    *index is left NULL for an empty list, and when the build allows
+    issuers that psX509AuthenticateCert matches other than by DN.  The
+    caller then tries the whole list as before.
+    The index points into certs, which must outlive it.
+ */
+static uint32_t x509CertIndexBucket(const psX509CertIndex_t *index,
+    const char *hash)
+{
+    const unsigned char *h = (const unsigned char *) hash;
+
+    return (((uint32_t) h[0] << 24) | ((uint32_t) h[1] << 16) |
+            ((uint32_t) h[2] << 8) | (uint32_t) h[3]) & index->mask;
+}
+
+int32_t psX509NewCertIndex(psPool_t *pool, psX509Cert_t *certs,
+    psX509CertIndex_t **index)
+{
+    psX509CertIndex_t *idx;
+    psX509Cert_t *curr;
+    uint32_t count, size, i, b;
+
+    *index = NULL;
+#  ifdef ALLOW_INTERMEDIATES_AS_ROOTS
+    /* An intermediate in the list also matches itself by signature */
+    return PS_SUCCESS;
+#  endif
+    count = 0;
+    for (curr = certs; curr != NULL; curr = curr->next)
+    {
+        count++;
+    }
+    if (count == 0)
+    {
+        return PS_SUCCESS;
+    }
+    for (size = 16; size < count && size < 0x10000000; size <<= 1)
+    {
+        ;
+    }
+    idx = psMalloc(pool, sizeof(psX509CertIndex_t) +
+        count * sizeof(psX509Cert_t *) + (count + size) * sizeof(uint32_t));
+    if (idx == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    idx->pool = pool;
+    idx->certs = (psX509Cert_t **) (idx + 1);
+    idx->chain = (uint32_t *) (idx->certs + count);
+    idx->buckets = idx->chain + count;
+    idx->count = count;
+    idx->mask = size - 1;
+    memset(idx->buckets, 0, size * sizeof(uint32_t));
+
+    i = 0;
+    for (curr = certs; curr != NULL; curr = curr->next)
+    {
+        idx->certs[i++] = curr;
+    }
+    /* Insert from the back so each bucket keeps the list order */
+    for (i = count; i > 0; i--)
+    {
+        b = x509CertIndexBucket(idx, idx->certs[i - 1]->subject.hash);
+        idx->chain[i - 1] = idx->buckets[b];
+        idx->buckets[b] = i;
+    }
+    *index = idx;
+    return PS_SUCCESS;
+}
+
+void psX509FreeCertIndex(psX509CertIndex_t *index)
+{
+    if (index)
+    {
+        psFree(index, index->pool);
+    }
+}
+
+/*
+    An authorityKeyIdentifier that differs from the subjectKeyIdentifier of
+    a candidate names another key.  Unknown counts as agreeing.
+ */
+static int32_t x509KeyIdAgrees(const psX509Cert_t *subjectCert,
+    const psX509Cert_t *issuerCert)
+{
+    const x509extAuthKeyId_t *ak = &subjectCert->extensions.ak;
+    const x509extSubjectKeyId_t *sk = &issuerCert->extensions.sk;
+
+    if (ak->keyId == NULL || ak->keyLen == 0 ||
+        sk->id == NULL || sk->len == 0)
+    {
+        return 1;
+    }
+    return ak->keyLen == sk->len && memcmp(ak->keyId, sk->id, sk->len) == 0;
+}
+
+/*
+    Return the next certificate of the index whose subject DN is the issuer
+    DN of subjectCert, or NULL when there are no more.  Candidates whose key
+    identifiers agree with subjectCert come first, in list order, followed
+    by the remaining ones for issuers with inconsistent identifiers.
+    Trust store shells are returned as psX509ParseDeferred parses them, and
+    skipped when it can't.
+ */
+psX509Cert_t *psX509FindIssuerCandidate(const psX509CertIndex_t *index,
+    const psX509Cert_t *subjectCert, psX509CertIndexCursor_t *cursor)
+{
+    psX509Cert_t *ic;
+    uint32_t e;
+
+    if (index == NULL || subjectCert == NULL)
+    {
+        return NULL;
+    }
+    for (; cursor->pass < 2; cursor->pass++, cursor->entry = 0)
+    {
+        if (cursor->entry == 0)
+        {
+            e = index->buckets[x509CertIndexBucket(index,
+                                   subjectCert->issuer.hash)];
+        }
+        else
+        {
+            e = index->chain[cursor->entry - 1];
+        }
+        for (; e != 0; e = index->chain[e - 1])
+        {
+            ic = index->certs[e - 1];
+            if (memcmp(ic->subject.hash, subjectCert->issuer.hash,
+                    SHA1_HASH_SIZE) != 0)
+            {
+                continue;
+            }
+            if (x509KeyIdAgrees(subjectCert, ic) != (cursor->pass == 0))
+            {
+                continue;
+            }
+            /* Trust store CAs are parsed on first use */
+            if ((ic = psX509ParseDeferred(ic)) == NULL)
+            {
+                continue;
+            }
+            cursor->entry = e;
+            return ic;
+        }
+    }
+    return NULL;
+}
+
+/******************************************************************************/
+/*
+    Binary trust store.  psX509NewTrustStore compiles a list of trusted
+    certificates into an image that psX509ParseTrustStore loads without
+    PEM decoding or copying, typically from a read-only mapping of the file
+    shared by every process.  Each entry also records what the CA index and
+    the CertificateRequest need, so that with CERT_DEFERRED_PARSE no DER is
+    parsed at load.  The image holds no pointers:
+
+        0   "PSTS"
+        4   version, 2 octets
+        6   length of each DN hash, 1 octet
+        7   zero, 1 octet
+        8   certificate count, 4 octets
+        12  image length, 4 octets
+        16  per certificate:
+            0   offset and length of its DER, 4 octets each
+            8   offset into the DER and length of the subject DN,
+                4 octets each
+            16  public key algorithm OID, 4 octets
+            20  subjectKeyIdentifier length, 1 octet, zero when absent or
+                longer than 32 octets
+            21  subjectKeyIdentifier, 32 octets, zero padded
+            53  zero, 3 octets
+            56  subject DN hash, then issuer DN hash
+            followed by the DER of each certificate, in list order
+
+    Integers are big endian, offsets from the start of the image.  The DN
+    hashes are those of psX509GetDNAttributes, SHA-1 or SHA-256 depending
+    on the build.  An image from a build with the other one still loads,
+    with a full parse.
+ */
+#  define TRUST_STORE_VERSION   2
+#  define TRUST_STORE_HDR_LEN   16
+#  define TRUST_STORE_SKI_MAX   32
+#  define TRUST_STORE_ENTRY_LEN(HASHLEN) (56 + 2 * (HASHLEN))
+#  ifdef USE_SHA1
+#   define TRUST_STORE_HASH_LEN SHA1_HASH_SIZE
+#  else
+#   define TRUST_STORE_HASH_LEN SHA256_HASH_SIZE
+#  endif
+
+#  ifdef USE_MULTITHREADING
+/* Serializes psX509ParseDeferred, opened by psCryptoOpen */
+static psMutex_t g_deferredLock;
+#   define DEFERRED_LOCK()     psLockMutex(&g_deferredLock)
+#   define DEFERRED_UNLOCK()   psUnlockMutex(&g_deferredLock)
+#  else
+#   define DEFERRED_LOCK()
+#   define DEFERRED_UNLOCK()
+#  endif
+
+/* Invoked from psCryptoOpen */
+int32_t psX509Open(void)
+{
+#  ifdef USE_MULTITHREADING
+    return psCreateMutex(&g_deferredLock, 0);
+#  else
+    return PS_SUCCESS;
+#  endif
+}
+
+/* Invoked from psCryptoClose */
+void psX509Close(void)
+{
+#  ifdef USE_MULTITHREADING
+    psDestroyMutex(&g_deferredLock);
+#  endif
+}
+
+static void trustStorePut32(unsigned char *c, uint32_t v)
+{
+    c[0] = (unsigned char) (v >> 24);
+    c[1] = (unsigned char) (v >> 16);
+    c[2] = (unsigned char) (v >> 8);
+    c[3] = (unsigned char) v;
+}
+
+static uint32_t trustStoreGet32(const unsigned char *c)
+{
+    return ((uint32_t) c[0] << 24) | ((uint32_t) c[1] << 16) |
+           ((uint32_t) c[2] << 8) | (uint32_t) c[3];
+}
+
+/*
+    Fill the entry for the DER at der in the image.  A lazy parse over the
+    image itself leaves the subject DN as a view, which gives its offset.
+ */
+static int32_t trustStoreEntry(psPool_t *pool, unsigned char *entry,
+    const unsigned char *der, psSize_t derLen)
+{
+    psX509Cert_t *cert;
+    const x509extSubjectKeyId_t *sk;
+    int32_t rc;
+
+    if ((rc = psX509ParseCert(pool, der, derLen, &cert,
+             CERT_EXTERNAL_BUFFER | CERT_LAZY_PARSE)) < 0)
+    {
+        psX509FreeCert(cert);
+        return rc;
+    }
+    memset(entry, 0, TRUST_STORE_ENTRY_LEN(TRUST_STORE_HASH_LEN));
+    trustStorePut32(entry + 8,
+        (uint32_t) ((const unsigned char *) cert->subject.dnenc - der));
+    trustStorePut32(entry + 12, cert->subject.dnencLen);
+    trustStorePut32(entry + 16, (uint32_t) cert->pubKeyAlgorithm);
+    sk = &cert->extensions.sk;
+    if (sk->id != NULL && sk->len > 0 && sk->len <= TRUST_STORE_SKI_MAX)
+    {
+        entry[20] = (unsigned char) sk->len;
+        memcpy(entry + 21, sk->id, sk->len);
+    }
+    memcpy(entry + 56, cert->subject.hash, TRUST_STORE_HASH_LEN);
+    memcpy(entry + 56 + TRUST_STORE_HASH_LEN, cert->issuer.hash,
+        TRUST_STORE_HASH_LEN);
+    psX509FreeCert(cert);
+    return PS_SUCCESS;
+}
+
+/*
+    The certificates must have been parsed with CERT_STORE_UNPARSED_BUFFER.
+    Those that failed to parse, see CERT_ALLOW_BUNDLE_PARTIAL_PARSE, are
+    left out.  Caller must free image with psFree on success.
+ */
+int32_t psX509NewTrustStore(psPool_t *pool, const psX509Cert_t *certs,
+    unsigned char **image, psSizeL_t *imageLen)
+{
+    const psX509Cert_t *curr;
+    unsigned char *c, *entry;
+    uint32_t count, off;
+    psSizeL_t len;
+    int32_t rc;
+
+    if (certs == NULL || image == NULL || imageLen == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    *image = NULL;
+    *imageLen = 0;
+    count = 0;
+    len = TRUST_STORE_HDR_LEN;
+    for (curr = certs; curr != NULL; curr = curr->next)
+    {
+        if (curr->parseStatus != PS_X509_PARSE_SUCCESS)
+        {
+            continue;
+        }
+        if (curr->unparsedBin == NULL)
+        {
+            psTraceCrypto("Trust store needs CERT_STORE_UNPARSED_BUFFER\n");
+            return PS_ARG_FAIL;
+        }
+        len += TRUST_STORE_ENTRY_LEN(TRUST_STORE_HASH_LEN) + curr->binLen;
+        count++;
+    }
+    if (len > 0xFFFFFFFF)
+    {
+        return PS_LIMIT_FAIL;
+    }
+    if ((c = psMalloc(pool, len)) == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    memcpy(c, "PSTS", 4);
+    c[4] = 0;
+    c[5] = TRUST_STORE_VERSION;
+    c[6] = TRUST_STORE_HASH_LEN;
+    c[7] = 0;
+    trustStorePut32(c + 8, count);
+    trustStorePut32(c + 12, (uint32_t) len);
+    entry = c + TRUST_STORE_HDR_LEN;
+    off = TRUST_STORE_HDR_LEN +
+          count * TRUST_STORE_ENTRY_LEN(TRUST_STORE_HASH_LEN);
+    for (curr = certs; curr != NULL; curr = curr->next)
+    {
+        if (curr->parseStatus != PS_X509_PARSE_SUCCESS)
+        {
+            continue;
+        }
+        memcpy(c + off, curr->unparsedBin, curr->binLen);
+        if ((rc = trustStoreEntry(pool, entry, c + off, curr->binLen)) < 0)
+        {
+            psFree(c, pool);
+            return rc;
+        }
+        trustStorePut32(entry, off);
+        trustStorePut32(entry + 4, curr->binLen);
+        entry += TRUST_STORE_ENTRY_LEN(TRUST_STORE_HASH_LEN);
+        off += curr->binLen;
+    }
+    *image = c;
+    *imageLen = len;
+    return PS_SUCCESS;
+}
+
+/*
+    A CERT_DEFERRED_PARSE certificate: the DER at der and the fields of its
+    image entry, as views into the image.
+ */
+static int32_t trustStoreShell(psPool_t *pool, const unsigned char *der,
+    uint32_t derLen, const unsigned char *entry, uint32_t hashLen,
+    psX509Cert_t **shell)
+{
+    psX509Cert_t *cert;
+    uint32_t dnOff, dnLen, skiLen;
+
+#  ifdef ENABLE_CA_CERT_HASH
+    psSha1_t sha1;
+#  endif
+
+    *shell = NULL;
+    dnOff = trustStoreGet32(entry + 8);
+    dnLen = trustStoreGet32(entry + 12);
+    skiLen = entry[20];
+    if (derLen > 0xFFFF || dnOff > derLen || dnLen > derLen - dnOff ||
+        skiLen > TRUST_STORE_SKI_MAX)
+    {
+        psTraceCrypto("Trust store entry out of bounds\n");
+        return PS_PARSE_FAIL;
+    }
+    if ((cert = psMalloc(pool, sizeof(psX509Cert_t))) == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    memset(cert, 0x0, sizeof(psX509Cert_t));
+    cert->pool = pool;
+    cert->parseStatus = PS_X509_PARSE_SUCCESS;
+    cert->unparsedBin = (unsigned char *) der;
+    cert->binLen = (psSize_t) derLen;
+    cert->zeroCopy = 1;
+    cert->binExternal = 1;
+    cert->deferred = 1;
+    cert->extensions.pool = pool;
+    cert->extensions.bc.cA = CA_UNDEFINED;
+    cert->pubKeyAlgorithm = (int32) trustStoreGet32(entry + 16);
+    cert->subject.dnenc = (char *) der + dnOff;
+    cert->subject.dnencLen = (psSize_t) dnLen;
+    cert->subject.deferred = 1;
+    memcpy(cert->subject.hash, entry + 56, hashLen);
+    memcpy(cert->issuer.hash, entry + 56 + hashLen, hashLen);
+    if (skiLen > 0)
+    {
+        cert->extensions.sk.id = (unsigned char *) entry + 21;
+        cert->extensions.sk.len = (psSize_t) skiLen;
+    }
+#  ifdef ENABLE_CA_CERT_HASH
+    psSha1PreInit(&sha1);
+    psSha1Init(&sha1);
+    psSha1Update(&sha1, der, derLen);
+    psSha1Final(&sha1, cert->sha1CertHash);
+#  endif
+    *shell = cert;
+    return PS_SUCCESS;
+}
+
+/*
+    Parse the certificates of a trust store image into a list, as
+    psX509ParseCert would from the original bundle.  They are parsed with
+    CERT_EXTERNAL_BUFFER added to flags, so the image must outlive them.
+    With CERT_ALLOW_BUNDLE_PARTIAL_PARSE, certificates that fail to parse
+    are left out.
+
+    With CERT_DEFERRED_PARSE the list holds shells instead, see
+    psX509ParseDeferred.  They only have the subject and issuer DN hashes,
+    the subject DN, the subjectKeyIdentifier and the public key algorithm,
+    which is enough for psX509NewCertIndex and the CertificateRequest.  The
+    validity dates of such a CA are not checked at load.  Other flags are
+    ignored then, and a certificate that would fail to parse stays in the
+    list until psX509ParseDeferred finds out.
+
+    Returns the number of certificates in the list.  Caller must free certs
+    with psX509FreeCert on success.
+ */
+int32_t psX509ParseTrustStore(psPool_t *pool, const unsigned char *image,
+    psSizeL_t imageLen, psX509Cert_t **certs, int32 flags)
+{
+    const unsigned char *entry;
+    psX509Cert_t *cert, **tail;
+    uint32_t count, i, off, len, hashLen, entryLen;
+    int32_t rc, parsed;
+
+    if (image == NULL || certs == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    *certs = NULL;
+    if (imageLen < TRUST_STORE_HDR_LEN || memcmp(image, "PSTS", 4) != 0)
+    {
+        psTraceCrypto("Not a trust store image\n");
+        return PS_PARSE_FAIL;
+    }
+    if (image[4] != 0 || image[5] != TRUST_STORE_VERSION)
+    {
+        psTraceIntCrypto("Unsupported trust store version %d\n",
+            (image[4] << 8) | image[5]);
+        return PS_VERSION_UNSUPPORTED;
+    }
+    hashLen = image[6];
+    if (hashLen != SHA1_HASH_SIZE && hashLen != SHA256_HASH_SIZE)
+    {
+        psTraceCrypto("Unsupported trust store DN hash\n");
+        return PS_PARSE_FAIL;
+    }
+    entryLen = TRUST_STORE_ENTRY_LEN(hashLen);
+    count = trustStoreGet32(image + 8);
+    if (trustStoreGet32(image + 12) != imageLen ||
+        count > (imageLen - TRUST_STORE_HDR_LEN) / entryLen)
+    {
+        psTraceCrypto("Truncated trust store image\n");
+        return PS_PARSE_FAIL;
+    }
+    if (hashLen != TRUST_STORE_HASH_LEN)
+    {
+        /* The index compares them with hashes of our own */
+        flags &= ~CERT_DEFERRED_PARSE;
+    }
+
+    flags |= CERT_EXTERNAL_BUFFER;
+    tail = certs;
+    parsed = 0;
+    entry = image + TRUST_STORE_HDR_LEN;
+    for (i = 0; i < count; i++, entry += entryLen)
+    {
+        off = trustStoreGet32(entry);
+        len = trustStoreGet32(entry + 4);
+        if (off > imageLen || len > imageLen - off)
+        {
+            psTraceCrypto("Trust store entry out of bounds\n");
+            rc = PS_PARSE_FAIL;
+            goto fail;
+        }
+        if (flags & CERT_DEFERRED_PARSE)
+        {
+            if ((rc = trustStoreShell(pool, image + off, len, entry, hashLen,
+                     &cert)) < 0)
+            {
+                goto fail;
+            }
+        }
+        else if ((rc = psX509ParseCert(pool, image + off, len, &cert,
+                      flags)) < 0)
+        {
+            psX509FreeCert(cert);
+            if (flags & CERT_ALLOW_BUNDLE_PARTIAL_PARSE)
+            {
+                continue;
+            }
+            goto fail;
+        }
+        *tail = cert;
+        while (cert->next != NULL)
+        {
+            cert = cert->next;
+        }
+        tail = &cert->next;
+        parsed++;
+    }
+    return parsed;
+
+fail:
+    psX509FreeCert(*certs);
+    *certs = NULL;
+    return rc;
+}
+
+/*
+    The certificate to use in place of cert: cert itself, unless it is a
+    CERT_DEFERRED_PARSE shell, in which case its DER is parsed on the first
+    call and kept with the shell until it is freed.  NULL when that parse
+    fails, in which case the caller should skip the certificate.
+
+    The result is not part of the list of cert; its next member is NULL.
+ */
+psX509Cert_t *psX509ParseDeferred(psX509Cert_t *cert)
+{
+    psX509Cert_t *parsed;
+
+    if (cert == NULL || !cert->deferred)
+    {
+        return cert;
+    }
+    DEFERRED_LOCK();
+    if (cert->parsed == NULL)
+    {
+        if (psX509ParseCert(cert->pool, cert->unparsedBin, cert->binLen,
+                &parsed, CERT_EXTERNAL_BUFFER) < 0)
+        {
+            /* Tried again next time, as a CA file would not load */
+            psTraceCrypto("Deferred trust store certificate failed to parse\n");
+            psX509FreeCert(parsed);
+            parsed = NULL;
+        }
+#  ifdef USE_PUBKEY_PRECOMP
+        psX509PrecomputeKeys(parsed);
+#  endif
+        cert->parsed = parsed;
+    }
+    parsed = cert->parsed;
+    DEFERRED_UNLOCK();
+    return parsed;
+}
+
 #  ifdef USE_RSA
 /******************************************************************************/
 /*
@@ -5922,6 +6815,7 @@ static int32_t parseSingleResponse(uint32_t len, const unsigned char **cp,
         return PS_PARSE_FAIL;
     }
     res->certIdKeyHash = p;
+    res->certIdKeyHashLen = (short) glen;
     p += glen;
 
     /* serialNumber       CertificateSerialNumber
@@ -6861,8 +7755,9 @@ int32_t psOcspResponseValidate(psPool_t *pool, psX509Cert_t *trustedOCSP,
                     if (memcmp(ocspResIssuer->subject.hash,
                             subject->issuer.hash, 20) == 0)
                     {
-
-                        if (psX509AuthenticateCert(pool, subject, ocspResIssuer,
+                        ocspResIssuer = psX509ParseDeferred(ocspResIssuer);
+                        if (ocspResIssuer != NULL &&
+                            psX509AuthenticateCert(pool, subject, ocspResIssuer,
                                 &ocspResIssuer, NULL, NULL) == 0)
                         {
                             /* OK, we held the CA that issued the OCSPResponse
@@ -6905,10 +7800,13 @@ int32_t psOcspResponseValidate(psPool_t *pool, psX509Cert_t *trustedOCSP,
         while (curr != NULL)
         {
             /* Currently looking for the subjectKey extension to match the
-                public key hash from the response */
-            if (ocspMatchResponderCert(response, curr) == PS_SUCCESS)
+                public key hash from the response.  The key hash of a trust
+                store CA is only known once it is parsed. */
+            ocspResIssuer = psX509ParseDeferred(curr);
+            if (ocspResIssuer != NULL &&
+                ocspMatchResponderCert(response, ocspResIssuer) == PS_SUCCESS)
             {
-                issuer = curr;
+                issuer = ocspResIssuer;
                 curr = NULL;
             }
             else
@@ -68,6 +68,24 @@ enum
     or a DER stream) to succeed even when some certs could not be
     supported by MatrixSSL. */
 #  define CERT_ALLOW_BUNDLE_PARTIAL_PARSE 0x4
+/** Defer decoding the DN attributes of the issuer and subject and the
+    subjectAltName entries until psX509DecodeCert.  Their DER is kept and
+    the DN hashes are computed, which is all certificate authentication
+    needs. */
+#  define CERT_LAZY_PARSE             0x8
+/** Keep a single copy of the certificate DER (implies
+    CERT_STORE_UNPARSED_BUFFER) and point the serial number, signature,
+    unique identifiers and any retained DN or subjectAltName DER into it
+    instead of allocating each of them separately. */
+#  define CERT_ZERO_COPY              0x10
+/** As CERT_ZERO_COPY, but over the caller's buffer instead of a copy of
+    it.  The buffer is never written or freed and must outlive the
+    certificate.  Used for the images of psX509ParseTrustStore. */
+#  define CERT_EXTERNAL_BUFFER        0x20
+/** psX509ParseTrustStore only: load each certificate from the DN hashes,
+    subject DN, key identifier and key algorithm recorded in the image, and
+    parse its DER when psX509ParseDeferred first needs it. */
+#  define CERT_DEFERRED_PARSE         0x40
 
 #  ifdef USE_CERT_PARSE
 
@@ -129,8 +147,9 @@ typedef struct
     char *email;
 #   endif /* USE_EXTRA_DN_ATTRIBUTES */
     char hash[MAX_HASH_SIZE];
-    char *dnenc;      /* CERT_STORE_DN_BUFFER */
+    char *dnenc;      /* CERT_STORE_DN_BUFFER or CERT_LAZY_PARSE */
     psSize_t dnencLen;
+    short deferred;   /* CERT_LAZY_PARSE: attributes not decoded yet */
     /* MUST support according to RFC 5280: */
     short countryType;
     psSize_t countryLen;
@@ -539,6 +558,8 @@ typedef struct
     uint32 ekuFlags;                            /* EXT_KEY_USAGE_ */
     x509extSubjectKeyId_t sk;
     x509extAuthKeyId_t ak;
+    unsigned char *sanDer;                      /* CERT_LAZY_PARSE: san */
+    psSize_t sanDerLen;
 #   if defined(USE_FULL_CERT_PARSE) || defined(USE_CERT_GEN)
     x509nameConstraints_t nameConstraints;
     x509certificatePolicies_t certificatePolicy;
@@ -582,8 +603,31 @@ typedef struct psCRL
     x509DNattributes_t issuer;
     x509v3extensions_t extensions;
     x509revoked_t *revoked;
+    x509revoked_t **revokedIndex; /* revoked, sorted by serial number */
+    unsigned char *packedRevoked; /* Instead of revoked when streamed */
+    uint32_t revokedCount;
+    uint32_t longRevoked;         /* Streamed entries with serials too long
+                                     for packedRevoked, not kept */
+    uint32_t refs;                /* psCRL_AcquireCRLForCert not released */
+    uint16_t deleted;             /* Out of g_CRL, freed on the last release */
     struct psCRL *next;
+    struct psCRL *bucketNext;     /* Same issuer bucket of the CRL table */
 } psX509Crl_t;
+
+/* Incremental parse state of psX509CrlStreamUpdate */
+typedef struct psX509CrlStream psX509CrlStream_t;
+
+#   ifdef MATRIX_USE_FILE_SYSTEM
+/* Caller owned state of psCRL_ReloadFile, valid until psCRL_ReloadWait */
+typedef struct
+{
+    psWorkerJob_t job;
+    psPool_t *pool;
+    const char *fileName;
+    struct psCert *CA;          /* Optional issuer to authenticate with */
+    int32_t rc;                 /* Result once psCRL_ReloadWait returns */
+} psCrlReload_t;
+#   endif
 #  endif
 
 typedef enum
@@ -624,6 +668,9 @@ typedef struct psCert
 #  endif /* USE_PKCS1_PSS */
 #  ifdef USE_CERT_PARSE
     psPubKey_t publicKey;
+#   ifdef USE_PUBKEY_PRECOMP
+    psPubKeyPrecomp_t *keyPrecomp;      /* see psX509PrecomputeKeys */
+#   endif
     int32 version;
     unsigned char *serialNumber;
     psSize_t serialNumberLen;
@@ -645,6 +692,12 @@ typedef struct psCert
     int32 revokedStatus;
 #   endif
     unsigned char sigHash[MAX_HASH_SIZE];
+#   ifdef USE_ED25519
+    unsigned char *tbsCert;     /* Signed data of an Ed25519 signed cert */
+    psSize_t tbsCertLen;
+#   endif
+    uint8_t deferred;           /* CERT_DEFERRED_PARSE shell */
+    struct psCert *parsed;      /* see psX509ParseDeferred */
 #  endif /* USE_CERT_PARSE */
 #  ifdef USE_OCSP
     unsigned char sha1KeyHash[SHA1_HASH_SIZE];
@@ -655,12 +708,37 @@ typedef struct psCert
 #  endif
     unsigned char *unparsedBin;         /* see psX509ParseCertFile */
     psSize_t binLen;
+    uint8_t zeroCopy;                   /* Fields point into unparsedBin */
+    uint8_t binExternal;                /* unparsedBin is not ours to free */
     uint16_t publicKeyDerOffsetIntoUnparsedBin;
     psSize_t publicKeyDerLen;
     uint16_t subjectKeyDerOffsetIntoUnparsedBin;
     struct psCert *next;
 } psX509Cert_t;
 
+#  ifdef USE_CERT_PARSE
+/*
+    Lookup of issuer candidates in a list of trusted certificates, hashed
+    on the subject DN.  See psX509NewCertIndex.
+ */
+typedef struct
+{
+    psPool_t *pool;
+    psX509Cert_t **certs;       /* Indexed certificates, in list order */
+    uint32_t *chain;            /* Next entry in the same bucket, or 0 */
+    uint32_t *buckets;          /* First entry in each bucket, or 0 */
+    uint32_t count;
+    uint32_t mask;              /* Bucket count - 1 */
+} psX509CertIndex_t;
+
+/* Iteration state of psX509FindIssuerCandidate, zero it to start */
+typedef struct
+{
+    uint32_t entry;             /* Last entry returned, 1 based */
+    uint32_t pass;              /* 0: key identifiers agree, 1: the rest */
+} psX509CertIndexCursor_t;
+#  endif /* USE_CERT_PARSE */
+
 extern int32_t psX509GetSignature(psPool_t *pool,const unsigned char **pp,
         psSize_t len, unsigned char **sig, psSize_t *sigLen);
 #  ifdef USE_CERT_PARSE
@@ -671,7 +749,7 @@ extern int32_t getSerialNum(psPool_t *pool, const unsigned char **pp,
         psSize_t len, unsigned char **sn, psSize_t *snLen);
 extern int32_t getExplicitExtensions(psPool_t *pool, const unsigned char **pp,
         psSize_t inlen, int32_t expVal, x509v3extensions_t *extensions,
-        uint8_t known);
+        uint8_t known, uint32_t flags);
 extern void x509FreeExtensions(x509v3extensions_t *extensions);
 extern int32_t psX509ValidateGeneralName(const char *n);
 
@@ -764,6 +842,7 @@ typedef struct
     uint16_t certIdHashAlg;            /* hashAlgorithm in CertID */
     const unsigned char *certIdNameHash;
     const unsigned char *certIdKeyHash;
+    short certIdKeyHashLen;
     const unsigned char *certIdSerial;
     short certIdSerialLen;
     short certStatus;
@@ -317,9 +317,52 @@
 #   if defined(USE_MATRIX_RSA) || defined(USE_MATRIX_ECC) || defined(USE_MATRIX_DH)
 #    define PS_PUBKEY_OPTIMIZE_FOR_FASTER_SPEED
 #   endif
+/*
+    Keep small big integers inside the pstm_int structure instead of on the
+    heap. ECC operations then need almost no allocations, at the cost of
+    around 150-200 bytes per pstm_int.
+ */
+#   ifdef USE_MATRIX_ECC
+#    define USE_PSTM_INLINE_DIGITS
+#   endif
 #   if defined(USE_MATRIX_RSA) || defined(USE_MATRIX_DH)
 #    define USE_1024_KEY_SPEED_OPTIMIZATIONS
 #    define USE_2048_KEY_SPEED_OPTIMIZATIONS
+/*
+    Karatsuba multiplication and squaring for operands of 2048 bits and up.
+    Speeds up 3072 and 4096 bit RSA and DH, but needs larger temporaries.
+ */
+#    define USE_PSTM_KARATSUBA
+#   endif
+/*
+    Precompute the public keys of trusted CA certificates when they are
+    loaded: the Montgomery constants of RSA moduli and comb tables for
+    ECDSA verification. Certificate chain validation gets faster at the
+    cost of a few kilobytes per ECC CA key.
+ */
+#   if defined(USE_MATRIX_RSA) || defined(USE_MATRIX_ECC)
+#    define USE_PUBKEY_PRECOMP
+#   endif
+/*
+    Precompute a fixed-base comb table for the generator of DH parameters
+    when they are loaded, see psDhPrecomputeParams(). DHE key generation
+    gets several times faster at the cost of 64 numbers of the prime size
+    per parameter set.
+ */
+#   ifdef USE_MATRIX_DH
+#    define USE_DH_PRECOMP
+#   endif
+/*
+    Compress four independent SHA-1 or SHA-256 blocks at once in SSE2
+    lanes. PBKDF2 uses this to compute several output blocks together.
+ */
+#   ifdef __SSE2__
+#    ifdef USE_MATRIX_SHA1
+#     define USE_SHA1_LANES
+#    endif
+#    ifdef USE_MATRIX_SHA256
+#     define USE_SHA256_LANES
+#    endif
 #   endif
 
 #  else /* OPTIMIZE_SIZE */
@@ -80,6 +80,22 @@ int32_t psCryptoOpen(const char *config)
 #ifdef USE_CRL
     psCrlOpen();
 #endif
+#if defined(USE_X509) && defined(USE_CERT_PARSE)
+    psX509Open();
+#endif
+#if defined(USE_MATRIX_ECC) && defined(USE_PUBKEY_PRECOMP)
+    if (psEccCombOpen() < 0)
+    {
+        psError("ECC comb open failure\n");
+        return PS_FAILURE;
+    }
+#endif
+#if defined(USE_MATRIX_RSA) && defined(USE_RSA_PARALLEL_CRT)
+    if (psRsaParallelCrtOpen() < 0)
+    {
+        psTraceCrypto("RSA CRT worker pool not available\n");
+    }
+#endif
 
     /* Everything successful, store configuration. */
     strncpy(g_config, PSCRYPTO_CONFIG, sizeof(g_config) - 1);
@@ -92,10 +108,19 @@ void psCryptoClose(void)
     if (*g_config == 'Y')
     {
         *g_config = 'N';
+#if defined(USE_MATRIX_RSA) && defined(USE_RSA_PARALLEL_CRT)
+        psRsaParallelCrtClose();
+#endif
+#if defined(USE_MATRIX_ECC) && defined(USE_PUBKEY_PRECOMP)
+        psEccCombClose();
+#endif
         psClosePrng();
         psCoreClose();
 #ifdef USE_CRL
         psCrlClose();
+#endif
+#if defined(USE_X509) && defined(USE_CERT_PARSE)
+        psX509Close();
 #endif
     }
 }
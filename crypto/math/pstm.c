@@ -45,17 +45,12 @@
 static int32_t pstm_mul_2d(const pstm_int *a, int16_t b, pstm_int *c);
 
 /******************************************************************************/
-/**
-    Initialize a pstm_int and allocate working memory for a given initial size.
-
-    @param[in] pool Memory pool to use for allocation.
-    @param[in,out] a Allocated pstm_int to initialize.
-    @param[in] size Number of digits to pre-allocate for integer. Typically
-        a digit is 32 or 64 bits.
-
-    @return < 0 on failure, >=0 on success.
+/*
+    Common part of the init functions. With inline digits enabled, small
+    integers use the storage inside the pstm_int instead of the heap.
  */
-int32_t pstm_init_size(psPool_t *pool, pstm_int *a, psSize_t size)
+static int32_t pstm_init_digits(psPool_t *pool, pstm_int *a, psSize_t size,
+    int allowInline)
 {
     uint16_t x;
 
@@ -63,10 +58,23 @@ int32_t pstm_init_size(psPool_t *pool, pstm_int *a, psSize_t size)
     {
         return PSTM_MEM;
     }
-    a->dp = psMalloc(pool, sizeof(pstm_digit) * size);
-    if (a->dp == NULL)
+# ifndef PSTM_INLINE_DIGITS
+    PS_VARIABLE_SET_BUT_UNUSED(allowInline);
+# else
+    if (allowInline && size <= PSTM_INLINE_DIGITS)
     {
-        return PSTM_MEM;
+        /* Use all of the inline storage, growing into it is free */
+        a->dp = a->inl;
+        size = PSTM_INLINE_DIGITS;
+    }
+    else
+# endif
+    {
+        a->dp = psMalloc(pool, sizeof(pstm_digit) * size);
+        if (a->dp == NULL)
+        {
+            return PSTM_MEM;
+        }
     }
     a->pool = pool;         /* Pool to use when growing or shrinking digits */
     a->used  = 0;           /* Zero of the digits are currently used */
@@ -80,6 +88,22 @@ int32_t pstm_init_size(psPool_t *pool, pstm_int *a, psSize_t size)
     return PSTM_OKAY;
 }
 
+/******************************************************************************/
+/**
+    Initialize a pstm_int and allocate working memory for a given initial size.
+
+    @param[in] pool Memory pool to use for allocation.
+    @param[in,out] a Allocated pstm_int to initialize.
+    @param[in] size Number of digits to pre-allocate for integer. Typically
+        a digit is 32 or 64 bits.
+
+    @return < 0 on failure, >=0 on success.
+ */
+int32_t pstm_init_size(psPool_t *pool, pstm_int *a, psSize_t size)
+{
+    return pstm_init_digits(pool, a, size, 1);
+}
+
 /******************************************************************************/
 /*
     Init a new pstm_int with a default size.
@@ -115,11 +139,27 @@ int32_t pstm_grow(pstm_int *a, psSize_t size)
         We store the return in a temporary variable in case the operation
         failed we don't want to overwrite the dp member of a.
  */
-        tmp = psRealloc(a->dp, sizeof(pstm_digit) * size, a->pool);
-        if (tmp == NULL)
+# ifdef PSTM_INLINE_DIGITS
+        if (a->dp == a->inl)
         {
-            /* reallocation failed but "a" is still valid [can be freed] */
-            return PSTM_MEM;
+            /* Move from the inline storage to the heap */
+            tmp = psMalloc(a->pool, sizeof(pstm_digit) * size);
+            if (tmp == NULL)
+            {
+                return PSTM_MEM;
+            }
+            memcpy(tmp, a->inl, sizeof(pstm_digit) * a->alloc);
+            memset_s(a->inl, sizeof(a->inl), 0x0, sizeof(a->inl));
+        }
+        else
+# endif
+        {
+            tmp = psRealloc(a->dp, sizeof(pstm_digit) * size, a->pool);
+            if (tmp == NULL)
+            {
+                /* reallocation failed but "a" is still valid [can be freed] */
+                return PSTM_MEM;
+            }
         }
         /* reallocation succeeded so set a->dp */
         a->dp = tmp;
@@ -235,7 +275,12 @@ void pstm_clear(pstm_int *a)
         {
             a->dp[i] = 0;
         }
-        psFree(a->dp, a->pool);
+# ifdef PSTM_INLINE_DIGITS
+        if (a->dp != a->inl)
+# endif
+        {
+            psFree(a->dp, a->pool);
+        }
         /* reset members to make debugging easier */
         a->dp       = NULL;
         a->alloc    = a->used = 0;
@@ -420,7 +465,10 @@ int32_t pstm_init_for_read_unsigned_bin(psPool_t *pool, pstm_int *a, psSize_t le
  */
     size = (((len / sizeof(pstm_digit)) * (sizeof(pstm_digit) * CHAR_BIT))
             / DIGIT_BIT) + 2;
-    return pstm_init_size(pool, a, size);
+    /* Values read from a buffer are usually key material that callers keep
+       in their own structures, and may copy by assignment. Keep them on
+       the heap so such copies stay valid. */
+    return pstm_init_digits(pool, a, size, 0);
 }
 
 
@@ -1966,6 +2014,17 @@ void pstm_exch(pstm_int *a, pstm_int *b)
     t   = *a;
     *a  = *b;
     *b  = t;
+# ifdef PSTM_INLINE_DIGITS
+    /* Inline digits were swapped along with the rest, point at them */
+    if (a->dp == b->inl)
+    {
+        a->dp = a->inl;
+    }
+    if (b->dp == a->inl)
+    {
+        b->dp = b->inl;
+    }
+# endif
 }
 
 /******************************************************************************/
@@ -2035,6 +2094,229 @@ int32_t pstm_mulmod(psPool_t *pool, const pstm_int *a, const pstm_int *b,
     return res;
 }
 
+/******************************************************************************/
+/*
+    Reduction contexts. With R^2 mod m precomputed, a value below m * R is
+    reduced by two Montgomery reductions, t * R^-1 and then
+    (t * R^-1) * R^2 * R^-1 = t (mod m), instead of a long division.
+ */
+
+/* Scratch digits kept on the stack, enough for moduli up to 2048 bits */
+#  define PSTM_MODCTX_STACK_DIGITS    (2 * (2048 / DIGIT_BIT) + 1)
+
+/* t = t mod m, for 0 <= t < m * R. 't' must have 2 * m->used + 1 digits. */
+static int32_t pstm_modctx_reduce(psPool_t *pool, const pstm_modctx *ctx,
+    pstm_int *t, pstm_digit *paD, psSize_t paDlen)
+{
+    int32_t res;
+
+    if ((res = pstm_montgomery_reduce(pool, t, ctx->m, ctx->mp, paD, paDlen))
+        != PSTM_OKAY)
+    {
+        return res;
+    }
+    if ((res = pstm_mul_comba(pool, t, &ctx->rr, t, paD, paDlen))
+        != PSTM_OKAY)
+    {
+        return res;
+    }
+    return pstm_montgomery_reduce(pool, t, ctx->m, ctx->mp, paD, paDlen);
+}
+
+/**
+    Set up a reduction context for the odd modulus 'm'.
+    R^2 mod m is computed without division: starting from R mod m, the
+    value is doubled up to 2^e * R for the odd part 'e' of the exponent
+    of R, and each Montgomery squaring then doubles the exponent.
+
+    @param[in] pool Memory pool.
+    @param[out] ctx Context to initialize. Free with pstm_modctx_clear().
+    @param[in] m Modulus. Must be odd, positive and outlive 'ctx'.
+    @return PSTM_OKAY on success, < 0 on failure.
+ */
+int32_t pstm_modctx_init(psPool_t *pool, pstm_modctx *ctx, const pstm_int *m)
+{
+    pstm_digit buf[PSTM_MODCTX_STACK_DIGITS];
+    pstm_digit *paD;
+    psSize_t paDlen, size;
+    pstm_int t;
+    uint16_t e, s, i;
+    int32_t res;
+
+    ctx->m = NULL;
+    if (m->sign == PSTM_NEG || m->used == 0)
+    {
+        return PS_ARG_FAIL;
+    }
+    if ((res = pstm_montgomery_setup(m, &ctx->mp)) != PSTM_OKAY)
+    {
+        return res;
+    }
+    size = 2 * m->used + 1;
+    paD = NULL;
+    paDlen = 0;
+    if (size <= PSTM_MODCTX_STACK_DIGITS)
+    {
+        paD = buf;
+        paDlen = sizeof(buf);
+    }
+    if ((res = pstm_init_size(pool, &ctx->rr, size)) != PSTM_OKAY)
+    {
+        return res;
+    }
+    if ((res = pstm_init_size(pool, &t, size)) != PSTM_OKAY)
+    {
+        pstm_clear(&ctx->rr);
+        return res;
+    }
+
+    /* Split the exponent of R into e * 2^s with e odd */
+    e = (uint16_t) (m->used * DIGIT_BIT);
+    for (s = 0; (e & 1) == 0; s++)
+    {
+        e >>= 1;
+    }
+    /* rr = 2^e * R mod m */
+    if ((res = pstm_montgomery_calc_normalization(&ctx->rr, m)) != PSTM_OKAY)
+    {
+        goto LBL_ERR;
+    }
+    for (i = 0; i < e; i++)
+    {
+        if ((res = pstm_mul_2(&ctx->rr, &ctx->rr)) != PSTM_OKAY)
+        {
+            goto LBL_ERR;
+        }
+        if (pstm_cmp_mag(&ctx->rr, m) != PSTM_LT)
+        {
+            if ((res = pstm_sub_s(&ctx->rr, m, &ctx->rr)) != PSTM_OKAY)
+            {
+                goto LBL_ERR;
+            }
+        }
+    }
+    /* (2^k * R)^2 * R^-1 = 2^2k * R, so s squarings give R * R */
+    for (i = 0; i < s; i++)
+    {
+        if ((res = pstm_sqr_comba(pool, &ctx->rr, &t, paD, paDlen))
+            != PSTM_OKAY)
+        {
+            goto LBL_ERR;
+        }
+        if ((res = pstm_montgomery_reduce(pool, &t, m, ctx->mp, paD, paDlen))
+            != PSTM_OKAY)
+        {
+            goto LBL_ERR;
+        }
+        pstm_exch(&t, &ctx->rr);
+    }
+    pstm_clear(&t);
+    ctx->m = m;
+    return PSTM_OKAY;
+
+LBL_ERR:
+    pstm_clear(&t);
+    pstm_clear(&ctx->rr);
+    return res;
+}
+
+/******************************************************************************/
+/*
+    Free a context set up by pstm_modctx_init().
+ */
+void pstm_modctx_clear(pstm_modctx *ctx)
+{
+    if (ctx->m != NULL)
+    {
+        pstm_clear(&ctx->rr);
+        ctx->m = NULL;
+    }
+}
+
+/******************************************************************************/
+/**
+    c = a * b (mod m) for the modulus of 'ctx'.
+    The fast path needs 0 <= a, b < R and one of them below m, which holds
+    for operands already reduced mod m. Other operands go through
+    pstm_mulmod().
+ */
+int32_t pstm_mulmod_ctx(psPool_t *pool, const pstm_modctx *ctx,
+    const pstm_int *a, const pstm_int *b, pstm_int *c)
+{
+    pstm_digit buf[PSTM_MODCTX_STACK_DIGITS];
+    pstm_digit *paD;
+    psSize_t paDlen, size;
+    const pstm_int *m = ctx->m;
+    pstm_int t;
+    int32_t res;
+
+    if (a->sign == PSTM_NEG || b->sign == PSTM_NEG ||
+        a->used > m->used || b->used > m->used ||
+        (pstm_cmp_mag(a, m) != PSTM_LT && pstm_cmp_mag(b, m) != PSTM_LT))
+    {
+        return pstm_mulmod(pool, a, b, m, c);
+    }
+    size = 2 * m->used + 1;
+    paD = NULL;
+    paDlen = 0;
+    if (size <= PSTM_MODCTX_STACK_DIGITS)
+    {
+        paD = buf;
+        paDlen = sizeof(buf);
+    }
+    if ((res = pstm_init_size(pool, &t, size)) != PSTM_OKAY)
+    {
+        return res;
+    }
+    if ((res = pstm_mul_comba(pool, a, b, &t, paD, paDlen)) == PSTM_OKAY &&
+        (res = pstm_modctx_reduce(pool, ctx, &t, paD, paDlen)) == PSTM_OKAY)
+    {
+        pstm_exch(&t, c);
+    }
+    pstm_clear(&t);
+    return res;
+}
+
+/******************************************************************************/
+/**
+    c = a (mod m) for the modulus of 'ctx'.
+    The fast path needs 0 <= a < R, other values go through pstm_mod().
+ */
+int32_t pstm_mod_ctx(psPool_t *pool, const pstm_modctx *ctx,
+    const pstm_int *a, pstm_int *c)
+{
+    pstm_digit buf[PSTM_MODCTX_STACK_DIGITS];
+    pstm_digit *paD;
+    psSize_t paDlen, size;
+    const pstm_int *m = ctx->m;
+    pstm_int t;
+    int32_t res;
+
+    if (a->sign == PSTM_NEG || a->used > m->used)
+    {
+        return pstm_mod(pool, a, m, c);
+    }
+    size = 2 * m->used + 1;
+    paD = NULL;
+    paDlen = 0;
+    if (size <= PSTM_MODCTX_STACK_DIGITS)
+    {
+        paD = buf;
+        paDlen = sizeof(buf);
+    }
+    if ((res = pstm_init_size(pool, &t, size)) != PSTM_OKAY)
+    {
+        return res;
+    }
+    if ((res = pstm_copy(a, &t)) == PSTM_OKAY &&
+        (res = pstm_modctx_reduce(pool, ctx, &t, paD, paDlen)) == PSTM_OKAY)
+    {
+        pstm_exch(&t, c);
+    }
+    pstm_clear(&t);
+    return res;
+}
+
 /******************************************************************************/
 /*
  *      y = g**x (mod p)
@@ -2188,6 +2470,12 @@ int32_t pstm_exptmod(psPool_t *pool, const pstm_int *G, const pstm_int *X,
     }
     /* Pre-allocated digit.  Used for mul, sqr, AND reduce */
     paDlen = ((M[1].used + 3) * 2) * sizeof(pstm_digit);
+# ifdef USE_PSTM_KARATSUBA
+    if (pstm_karatsuba_scratch_size(P->used) > paDlen)
+    {
+        paDlen = pstm_karatsuba_scratch_size(P->used);
+    }
+# endif /* USE_PSTM_KARATSUBA */
     if ((paD = psMalloc(pool, paDlen)) == NULL)
     {
         err = PS_MEM_FAIL;
@@ -2396,6 +2684,508 @@ LBL_RES: pstm_clear(&res);
 
     return err;
 }
+
+/******************************************************************************/
+/*
+ *      y = g**x (mod p) for a short exponent x, such as an RSA public exponent.
+ *      Plain left-to-right square-and-multiply on the Montgomery form of g.
+ *      No window table is built and the working integers live on the stack,
+ *      only the conversion of g into Montgomery form uses heap memory.
+ *      With a reduction context for p that conversion is a multiplication by
+ *      R^2 instead of a division.
+ *      Some restrictions...
+ *              x must be positive
+ *              p must be positive, odd and at most 4096 bits
+ */
+static int32_t pstm_exptmod_short_impl(psPool_t *pool, const pstm_int *G,
+    const pstm_int *X, const pstm_int *P, const pstm_modctx *ctx, pstm_int *Y)
+{
+    pstm_digit accD[PSTM_EXPTMOD_SHORT_DIGITS];
+    pstm_digit baseD[PSTM_EXPTMOD_SHORT_DIGITS];
+    pstm_digit paD[PSTM_EXPTMOD_SHORT_DIGITS];
+    pstm_int acc, base, t;
+    pstm_digit mp;
+    int32 err;
+    int16 x;
+
+    if (P->used > (4096 / DIGIT_BIT) || X->sign == PSTM_NEG)
+    {
+        psTraceIntCrypto("pstm_exptmod_short size failed: %hu\n", P->used);
+        return PS_LIMIT_FAIL;
+    }
+    if ((err = pstm_montgomery_setup(P, &mp)) != PSTM_OKAY)
+    {
+        return err;
+    }
+    x = pstm_count_bits(X);
+    if (x == 0)
+    {
+        /* g**0 == 1 */
+        if (Y->alloc < 1 && (err = pstm_grow(Y, 1)) != PSTM_OKAY)
+        {
+            return err;
+        }
+        pstm_set(Y, 1);
+        return PSTM_OKAY;
+    }
+
+    if (ctx != NULL && G->sign == PSTM_ZPOS && pstm_cmp_mag(G, P) == PSTM_LT)
+    {
+        /* t = g * R^2 * R^-1 = g * R mod p */
+        if ((err = pstm_init_size(pool, &t, 2 * P->used + 1)) != PSTM_OKAY)
+        {
+            return err;
+        }
+        if ((err = pstm_mul_comba_base(pool, G, &ctx->rr, &t, paD,
+                 sizeof(paD))) != PSTM_OKAY ||
+            (err = pstm_montgomery_reduce(pool, &t, P, mp, paD,
+                 sizeof(paD))) != PSTM_OKAY)
+        {
+            pstm_clear(&t);
+            return err;
+        }
+    }
+    else
+    {
+        /* t = g * R mod p. This is the single division in this function. */
+        if ((err = pstm_init_size(pool, &t, G->used + P->used + 1))
+            != PSTM_OKAY)
+        {
+            return err;
+        }
+        if ((err = pstm_copy(G, &t)) != PSTM_OKAY ||
+            (err = pstm_lshd(&t, P->used)) != PSTM_OKAY ||
+            (err = pstm_mod(pool, &t, P, &t)) != PSTM_OKAY)
+        {
+            pstm_clear(&t);
+            return err;
+        }
+    }
+
+    /* Stack backed integers, sized so that they are never grown */
+    acc.dp = accD;
+    base.dp = baseD;
+    acc.pool = base.pool = pool;
+    acc.alloc = base.alloc = PSTM_EXPTMOD_SHORT_DIGITS;
+    acc.used = base.used = 0;
+    acc.sign = base.sign = PSTM_ZPOS;
+    memset(accD, 0x0, sizeof(accD));
+    memset(baseD, 0x0, sizeof(baseD));
+    err = pstm_copy(&t, &base);
+    pstm_clear(&t);
+    if (err != PSTM_OKAY || (err = pstm_copy(&base, &acc)) != PSTM_OKAY)
+    {
+        goto LBL_DONE;
+    }
+
+    /* The top bit of x is consumed by acc = base. The _base comba routines
+       are used directly, as Karatsuba would need more scratch than paD. */
+    for (x -= 2; x >= 0; x--)
+    {
+        if ((err = pstm_sqr_comba_base(pool, &acc, &acc, paD, sizeof(paD)))
+            != PSTM_OKAY)
+        {
+            goto LBL_DONE;
+        }
+        if ((err = pstm_montgomery_reduce(pool, &acc, P, mp, paD, sizeof(paD)))
+            != PSTM_OKAY)
+        {
+            goto LBL_DONE;
+        }
+        if ((X->dp[x / DIGIT_BIT] >> (x % DIGIT_BIT)) & 1)
+        {
+            if ((err = pstm_mul_comba_base(pool, &acc, &base, &acc, paD,
+                     sizeof(paD))) != PSTM_OKAY)
+            {
+                goto LBL_DONE;
+            }
+            if ((err = pstm_montgomery_reduce(pool, &acc, P, mp, paD,
+                     sizeof(paD))) != PSTM_OKAY)
+            {
+                goto LBL_DONE;
+            }
+        }
+    }
+    /* Leave the Montgomery domain */
+    if ((err = pstm_montgomery_reduce(pool, &acc, P, mp, paD, sizeof(paD)))
+        != PSTM_OKAY)
+    {
+        goto LBL_DONE;
+    }
+    err = pstm_copy(&acc, Y);
+
+LBL_DONE:
+    /* The base may be secret, e.g. padded key material in RSA encryption */
+    memset_s(accD, sizeof(accD), 0x0, sizeof(accD));
+    memset_s(baseD, sizeof(baseD), 0x0, sizeof(baseD));
+    memset_s(paD, sizeof(paD), 0x0, sizeof(paD));
+    return err;
+}
+
+int32_t pstm_exptmod_short(psPool_t *pool, const pstm_int *G, const pstm_int *X,
+    const pstm_int *P, pstm_int *Y)
+{
+    return pstm_exptmod_short_impl(pool, G, X, P, NULL, Y);
+}
+
+/*
+ *      As pstm_exptmod_short(), modulo the modulus of 'ctx'.
+ */
+int32_t pstm_exptmod_short_ctx(psPool_t *pool, const pstm_int *G,
+    const pstm_int *X, const pstm_modctx *ctx, pstm_int *Y)
+{
+    return pstm_exptmod_short_impl(pool, G, X, ctx->m, ctx, Y);
+}
+
+/******************************************************************************/
+/*
+ *      Fixed-base comb exponentiation, for many exponentiations of one base
+ *      modulo one odd modulus such as a DH generator.
+ *      For spacing d, entry j of the table holds the product of
+ *      g**(2**(i * d)) over the bits i set in j, in Montgomery form. Entry 0
+ *      is 1 in Montgomery form. g**x then costs d - 1 squarings and d
+ *      multiplications for any x of up to maxBits bits.
+ */
+/* Entry 'j' of the table of 'fb', as a read-only view */
+static void pstm_fb_entry(const pstm_fbctx *fb, uint16_t j, pstm_int *e)
+{
+    psSize_t digits = fb->ctx.m->used;
+
+    e->dp = fb->table + j * digits;
+    e->pool = NULL;
+    e->used = e->alloc = digits;
+    e->sign = PSTM_ZPOS;
+    pstm_clamp(e);
+}
+
+/* Store the Montgomery product in 't' as entry 'j' of the table of 'fb' */
+static int32_t pstm_fb_store(pstm_fbctx *fb, uint16_t j, const pstm_int *t)
+{
+    psSize_t digits = fb->ctx.m->used;
+
+    if (t->used > digits)
+    {
+        return PS_LIMIT_FAIL;
+    }
+    memset(fb->table + j * digits, 0x0, digits * sizeof(pstm_digit));
+    memcpy(fb->table + j * digits, t->dp, t->used * sizeof(pstm_digit));
+    return PSTM_OKAY;
+}
+
+/* Bit 'n' of 'x', or 0 past its top */
+static pstm_digit pstm_fb_bit(const pstm_int *x, uint16_t n)
+{
+    if (n / DIGIT_BIT >= x->used)
+    {
+        return 0;
+    }
+    return (x->dp[n / DIGIT_BIT] >> (n % DIGIT_BIT)) & 1;
+}
+
+/* Scratch for Montgomery multiplication modulo a 'digits' digit modulus */
+static uint32 pstm_fb_scratch_size(psSize_t digits)
+{
+    uint32 paDlen;
+
+    paDlen = ((digits + 3) * 2) * sizeof(pstm_digit);
+#  ifdef USE_PSTM_KARATSUBA
+    if (pstm_karatsuba_scratch_size(digits) > paDlen)
+    {
+        paDlen = pstm_karatsuba_scratch_size(digits);
+    }
+#  endif /* USE_PSTM_KARATSUBA */
+    return paDlen;
+}
+
+/*
+ *      Build the comb of base 'G' modulo the odd 'P' for exponents of up to
+ *      'maxBits' bits. 'P' is referenced, not copied, and must outlive 'fb'.
+ */
+int32_t pstm_fbctx_init(psPool_t *pool, pstm_fbctx *fb, const pstm_int *G,
+    const pstm_int *P, psSize_t maxBits)
+{
+    pstm_int t, a, b;
+    pstm_digit *paD;
+    uint32 paDlen;
+    psSize_t digits;
+    uint16_t i, j;
+    int32_t err;
+
+    memset(fb, 0x0, sizeof(pstm_fbctx));
+    if (maxBits == 0 || G->sign == PSTM_NEG)
+    {
+        return PS_ARG_FAIL;
+    }
+    if (P->used > (4096 / DIGIT_BIT))
+    {
+        return PS_LIMIT_FAIL;
+    }
+    if ((err = pstm_modctx_init(pool, &fb->ctx, P)) != PSTM_OKAY)
+    {
+        return err;
+    }
+    digits = P->used;
+    fb->spacing = (maxBits + PSTM_FB_TEETH - 1) / PSTM_FB_TEETH;
+    fb->maxBits = fb->spacing * PSTM_FB_TEETH;
+    fb->pool = pool;
+    paDlen = pstm_fb_scratch_size(digits);
+    fb->table = psMalloc(pool, (1 << PSTM_FB_TEETH) * digits *
+        sizeof(pstm_digit));
+    paD = psMalloc(pool, paDlen);
+    if (fb->table == NULL || paD == NULL ||
+        pstm_init_size(pool, &t, 2 * digits + 1) != PSTM_OKAY)
+    {
+        if (paD)
+        {
+            psFree(paD, pool);
+        }
+        pstm_fbctx_clear(fb);
+        return PS_MEM_FAIL;
+    }
+
+    /* Entry 0 is R mod p */
+    if ((err = pstm_montgomery_calc_normalization(&t, P)) != PSTM_OKAY ||
+        (err = pstm_fb_store(fb, 0, &t)) != PSTM_OKAY)
+    {
+        goto LBL_ERR;
+    }
+    /* t = g * R^2 * R^-1 = g * R mod p */
+    if (pstm_cmp_mag(G, P) != PSTM_LT)
+    {
+        err = pstm_mod(pool, G, P, &t);
+    }
+    else
+    {
+        err = pstm_copy(G, &t);
+    }
+    if (err != PSTM_OKAY ||
+        (err = pstm_mul_comba(pool, &t, &fb->ctx.rr, &t, paD, paDlen))
+        != PSTM_OKAY ||
+        (err = pstm_montgomery_reduce(pool, &t, P, fb->ctx.mp, paD, paDlen))
+        != PSTM_OKAY)
+    {
+        goto LBL_ERR;
+    }
+    /* The teeth: entry 2^i is g**(2**(i * d)) */
+    for (i = 0; i < PSTM_FB_TEETH; i++)
+    {
+        if (i > 0)
+        {
+            for (j = 0; j < fb->spacing; j++)
+            {
+                if ((err = pstm_sqr_comba(pool, &t, &t, paD, paDlen))
+                    != PSTM_OKAY ||
+                    (err = pstm_montgomery_reduce(pool, &t, P, fb->ctx.mp,
+                         paD, paDlen)) != PSTM_OKAY)
+                {
+                    goto LBL_ERR;
+                }
+            }
+        }
+        if ((err = pstm_fb_store(fb, 1 << i, &t)) != PSTM_OKAY)
+        {
+            goto LBL_ERR;
+        }
+    }
+    /* The other entries from their lowest bit and the rest */
+    for (j = 3; j < (1 << PSTM_FB_TEETH); j++)
+    {
+        if ((j & (j - 1)) == 0)
+        {
+            continue;
+        }
+        pstm_fb_entry(fb, j & (j - 1), &a);
+        pstm_fb_entry(fb, j & -j, &b);
+        if ((err = pstm_mul_comba(pool, &a, &b, &t, paD, paDlen))
+            != PSTM_OKAY ||
+            (err = pstm_montgomery_reduce(pool, &t, P, fb->ctx.mp, paD,
+                 paDlen)) != PSTM_OKAY ||
+            (err = pstm_fb_store(fb, j, &t)) != PSTM_OKAY)
+        {
+            goto LBL_ERR;
+        }
+    }
+    err = PSTM_OKAY;
+
+LBL_ERR:
+    pstm_clear(&t);
+    psFree(paD, pool);
+    if (err != PSTM_OKAY)
+    {
+        pstm_fbctx_clear(fb);
+    }
+    return err;
+}
+
+void pstm_fbctx_clear(pstm_fbctx *fb)
+{
+    if (fb->table)
+    {
+        psFree(fb->table, fb->pool);
+        fb->table = NULL;
+    }
+    pstm_modctx_clear(&fb->ctx);
+    fb->spacing = fb->maxBits = 0;
+}
+
+/* Column 'c' of the comb of 'fb' over 'x': the index of its table entry */
+static uint16_t pstm_fb_column(const pstm_fbctx *fb, const pstm_int *x,
+    uint16_t c)
+{
+    uint16_t idx, i;
+
+    idx = 0;
+    for (i = 0; i < PSTM_FB_TEETH; i++)
+    {
+        idx |= (uint16_t) pstm_fb_bit(x, i * fb->spacing + c) << i;
+    }
+    return idx;
+}
+
+#  ifdef USE_CONSTANT_TIME_MODEXP
+/*
+ *      y = g**x (mod p) with the comb of 'fb', using the constant time
+ *      Montgomery steps of pstmnt. Every table entry is read for every column
+ *      so that neither the operations nor the memory accessed depend on x.
+ */
+static int32_t pstm_exptmod_fixed_nt(const pstm_fbctx *fb, const pstm_int *X,
+    pstm_int *Y)
+{
+    pstmnt_word acc[4096 / PSTMNT_WORD_BITS];
+    pstmnt_word sel[4096 / PSTMNT_WORD_BITS];
+    pstmnt_word temp[2 * 4096 / PSTMNT_WORD_BITS];
+    const pstm_int *P = fb->ctx.m;
+    const pstmnt_word *table = (const pstmnt_word *) fb->table;
+    pstmnt_words n = pstmnt_size(P);
+    pstmnt_word mp = pstmnt_neg_small_inv(pstmnt_const_ptr(P));
+    uint32_t eq;
+    uint16_t idx, j;
+    int16 c;
+
+    memcpy(acc, table, n * sizeof(pstmnt_word));
+    for (c = fb->spacing - 1; c >= 0; c--)
+    {
+        if (c < fb->spacing - 1)
+        {
+            pstmnt_montgomery_step(acc, acc, acc, temp, pstmnt_const_ptr(P),
+                mp, n);
+        }
+        idx = pstm_fb_column(fb, X, c);
+        memset(sel, 0x0, n * sizeof(pstmnt_word));
+        for (j = 0; j < (1 << PSTM_FB_TEETH); j++)
+        {
+            /* All ones when j == idx, otherwise zero */
+            eq = (uint32_t) (j ^ idx);
+            eq = ((eq | (0 - eq)) >> 31) - 1;
+            pstmnt_select_mask(table + j * n, sel, n, eq);
+        }
+        pstmnt_montgomery_step(acc, sel, acc, temp, pstmnt_const_ptr(P),
+            mp, n);
+    }
+    /* Leave the Montgomery domain */
+    pstmnt_montgomery_output(acc, acc, pstmnt_const_ptr(P), temp, n, mp);
+
+    if (Y->alloc < P->used && pstm_grow(Y, P->used) != PSTM_OKAY)
+    {
+        memset_s(acc, sizeof(acc), 0x0, sizeof(acc));
+        return PS_MEM_FAIL;
+    }
+    memcpy(pstmnt_ptr(Y), acc, n * sizeof(pstmnt_word));
+    Y->used = P->used;
+    Y->sign = PSTM_ZPOS;
+    pstm_clamp(Y);
+    memset_s(acc, sizeof(acc), 0x0, sizeof(acc));
+    memset_s(sel, sizeof(sel), 0x0, sizeof(sel));
+    memset_s(temp, sizeof(temp), 0x0, sizeof(temp));
+    return PSTM_OKAY;
+}
+#  else
+/*
+ *      y = g**x (mod p) with the comb of 'fb' on the pstm multiplication and
+ *      Montgomery reduction routines.
+ */
+static int32_t pstm_exptmod_fixed_vt(psPool_t *pool, const pstm_fbctx *fb,
+    const pstm_int *X, pstm_int *Y)
+{
+    const pstm_int *P = fb->ctx.m;
+    pstm_int acc, e;
+    pstm_digit *paD;
+    uint32 paDlen;
+    int16 c;
+    int32_t err;
+
+    paDlen = pstm_fb_scratch_size(P->used);
+    if ((paD = psMalloc(pool, paDlen)) == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    if ((err = pstm_init_size(pool, &acc, 2 * P->used + 1)) != PSTM_OKAY)
+    {
+        psFree(paD, pool);
+        return err;
+    }
+    pstm_fb_entry(fb, 0, &e);
+    if ((err = pstm_copy(&e, &acc)) != PSTM_OKAY)
+    {
+        goto LBL_DONE;
+    }
+    for (c = fb->spacing - 1; c >= 0; c--)
+    {
+        if (c < fb->spacing - 1)
+        {
+            if ((err = pstm_sqr_comba(pool, &acc, &acc, paD, paDlen))
+                != PSTM_OKAY ||
+                (err = pstm_montgomery_reduce(pool, &acc, P, fb->ctx.mp, paD,
+                     paDlen)) != PSTM_OKAY)
+            {
+                goto LBL_DONE;
+            }
+        }
+        pstm_fb_entry(fb, pstm_fb_column(fb, X, c), &e);
+        if ((err = pstm_mul_comba(pool, &acc, &e, &acc, paD, paDlen))
+            != PSTM_OKAY ||
+            (err = pstm_montgomery_reduce(pool, &acc, P, fb->ctx.mp, paD,
+                 paDlen)) != PSTM_OKAY)
+        {
+            goto LBL_DONE;
+        }
+    }
+    /* Leave the Montgomery domain */
+    if ((err = pstm_montgomery_reduce(pool, &acc, P, fb->ctx.mp, paD, paDlen))
+        != PSTM_OKAY)
+    {
+        goto LBL_DONE;
+    }
+    err = pstm_copy(&acc, Y);
+
+LBL_DONE:
+    pstm_clear(&acc);
+    memset_s(paD, paDlen, 0x0, paDlen);
+    psFree(paD, pool);
+    return err;
+}
+#  endif /* USE_CONSTANT_TIME_MODEXP */
+
+/*
+ *      y = g**x (mod p) with the comb of 'fb'. x must be positive and have
+ *      at most fb->maxBits bits. Every column costs one squaring and one
+ *      multiplication, whatever the bits of x. With USE_CONSTANT_TIME_MODEXP
+ *      the table lookups and the reductions are data independent too.
+ */
+int32_t pstm_exptmod_fixed(psPool_t *pool, const pstm_fbctx *fb,
+    const pstm_int *X, pstm_int *Y)
+{
+    if (X->sign == PSTM_NEG || pstm_count_bits(X) > fb->maxBits)
+    {
+        return PS_LIMIT_FAIL;
+    }
+#  ifdef USE_CONSTANT_TIME_MODEXP
+    PS_VARIABLE_SET_BUT_UNUSED(pool);
+    return pstm_exptmod_fixed_nt(fb, X, Y);
+#  else
+    return pstm_exptmod_fixed_vt(pool, fb, X, Y);
+#  endif /* USE_CONSTANT_TIME_MODEXP */
+}
 # endif /* USE_MATRIX_RSA || USE_MATRIX_ECC || USE_MATRIX_DH */
 
 /******************************************************************************/
@@ -136,6 +136,51 @@ typedef uint64 pstm_word;
     Effectively, it is three times the size of the largest private key. */
 #  define PSTM_MAX_SIZE   ((4096 / DIGIT_BIT) * 3)
 
+/*      Exponents up to this many bits use pstm_exptmod_short(), which needs
+    no window table. This covers all common RSA public exponents. */
+#  define PSTM_EXPTMOD_SHORT_MAX_BITS 32
+/*      Size of the stack buffers of pstm_exptmod_short(): a full product of
+    two 4096 bit integers, plus the extra digits Montgomery reduction uses. */
+#  define PSTM_EXPTMOD_SHORT_DIGITS ((4096 / DIGIT_BIT) * 2 + 3)
+
+/*      Operand sizes, in digits, from which pstm_mul_comba() and
+    pstm_sqr_comba() switch to Karatsuba when USE_PSTM_KARATSUBA is defined.
+    Below these the comba code is faster. The defaults can be overridden at
+    build time with the values reported by crypto/test/mulperf. */
+#  ifndef PSTM_KARATSUBA_MUL_CUTOFF
+#   define PSTM_KARATSUBA_MUL_CUTOFF (3072 / DIGIT_BIT)
+#  endif
+#  ifndef PSTM_KARATSUBA_SQR_CUTOFF
+#   define PSTM_KARATSUBA_SQR_CUTOFF (3584 / DIGIT_BIT)
+#  endif
+/*      Bytes of paD that are always enough for pstm_mul_comba() and
+    pstm_sqr_comba() on operands of 'digits' digits, whatever the cutoffs. */
+#  define PSTM_KARATSUBA_SCRATCH_BOUND(digits) \
+    ((10 * (digits) + 128) * sizeof(pstm_digit))
+
+/*      With USE_PSTM_INLINE_DIGITS each pstm_int carries storage for a
+    product of two coordinates of the largest enabled ECC curve, so curve
+    math runs without heap allocations. Larger (RSA and DH) integers, and
+    any integer that grows beyond the inline storage, use the heap.
+    Such a pstm_int must not be copied by structure assignment, use
+    pstm_copy() or pstm_exch(). Integers set up with
+    pstm_init_for_read_unsigned_bin() never use the inline storage. */
+#  ifdef USE_PSTM_INLINE_DIGITS
+#   if defined(USE_SECP521R1)
+#    define PSTM_INLINE_BITS 521
+#   elif defined(USE_BRAIN512R1)
+#    define PSTM_INLINE_BITS 512
+#   elif defined(USE_SECP384R1) || defined(USE_BRAIN384R1)
+#    define PSTM_INLINE_BITS 384
+#   elif defined(USE_SECP256R1) || defined(USE_BRAIN256R1)
+#    define PSTM_INLINE_BITS 256
+#   else
+#    define PSTM_INLINE_BITS 224
+#   endif
+#   define PSTM_INLINE_DIGITS \
+    (2 * ((PSTM_INLINE_BITS + DIGIT_BIT - 1) / DIGIT_BIT) + 3)
+#  endif /* USE_PSTM_INLINE_DIGITS */
+
 typedef struct
 {
     pstm_digit *dp;
@@ -150,8 +195,37 @@ typedef struct
     uint16_t alloc;
     uint8_t sign;
 #  endif
+#  ifdef PSTM_INLINE_DIGITS
+    pstm_digit inl[PSTM_INLINE_DIGITS]; /* dp points here while it fits */
+#  endif
 } pstm_int;
 
+/*
+    Precomputed Montgomery constants for repeated reduction modulo one odd
+    modulus, see pstm_modctx_init(). The modulus is referenced, not copied,
+    and must outlive the context.
+ */
+typedef struct
+{
+    const pstm_int *m;      /* Modulus */
+    pstm_int rr;            /* R^2 mod m, R = 2^(DIGIT_BIT * m->used) */
+    pstm_digit mp;          /* -1/m mod 2^DIGIT_BIT */
+} pstm_modctx;
+
+/*
+    Fixed-base comb for repeated exponentiation of one base modulo one odd
+    modulus, see pstm_fbctx_init(). Covers exponents of up to maxBits bits.
+ */
+#  define PSTM_FB_TEETH   6
+typedef struct
+{
+    pstm_modctx ctx;        /* Reduction context of the modulus */
+    pstm_digit *table;      /* 2^PSTM_FB_TEETH entries of ctx.m->used digits */
+    psPool_t *pool;
+    psSize_t spacing;       /* Bits between the teeth of the comb */
+    psSize_t maxBits;       /* Longest exponent the table covers */
+} pstm_fbctx;
+
 /******************************************************************************/
 /*
     Operations on large integers
@@ -232,9 +306,44 @@ extern int32_t pstm_mul_d(const pstm_int *a, const pstm_digit b, pstm_int *c);
 
 extern int32_t pstm_sqr_comba(psPool_t *pool, const pstm_int *A, pstm_int *B,
                               pstm_digit *paD, psSize_t paDlen);
+extern int32_t pstm_mul_comba_base(psPool_t *pool, const pstm_int *A,
+                                   const pstm_int *B, pstm_int *C,
+                                   pstm_digit *paD, psSize_t paDlen);
+extern int32_t pstm_sqr_comba_base(psPool_t *pool, const pstm_int *A,
+                                   pstm_int *B, pstm_digit *paD,
+                                   psSize_t paDlen);
+#  ifdef USE_PSTM_KARATSUBA
+extern int32_t pstm_mul_karatsuba(psPool_t *pool, const pstm_int *A,
+                                  const pstm_int *B, pstm_int *C,
+                                  pstm_digit *paD, psSize_t paDlen);
+extern int32_t pstm_sqr_karatsuba(psPool_t *pool, const pstm_int *A,
+                                  pstm_int *B, pstm_digit *paD,
+                                  psSize_t paDlen);
+/* The same with a cutoff other than the built in one, for tuning code */
+extern int32_t pstm_mul_karatsuba_cutoff(psPool_t *pool, const pstm_int *A,
+                                         const pstm_int *B, pstm_int *C,
+                                         pstm_digit *paD, psSize_t paDlen,
+                                         psSize_t cutoff);
+extern int32_t pstm_sqr_karatsuba_cutoff(psPool_t *pool, const pstm_int *A,
+                                         pstm_int *B, pstm_digit *paD,
+                                         psSize_t paDlen, psSize_t cutoff);
+extern uint32 pstm_karatsuba_scratch_size(psSize_t digits);
+#  endif /* USE_PSTM_KARATSUBA */
 
 extern int32_t pstm_exptmod(psPool_t *pool, const pstm_int *G, const pstm_int *X,
                             const pstm_int *P, pstm_int *Y);
+extern int32_t pstm_exptmod_short(psPool_t *pool, const pstm_int *G,
+                                  const pstm_int *X, const pstm_int *P,
+                                  pstm_int *Y);
+extern int32_t pstm_exptmod_short_ctx(psPool_t *pool, const pstm_int *G,
+                                      const pstm_int *X,
+                                      const pstm_modctx *ctx, pstm_int *Y);
+extern int32_t pstm_fbctx_init(psPool_t *pool, pstm_fbctx *fb,
+                               const pstm_int *G, const pstm_int *P,
+                               psSize_t maxBits);
+extern void pstm_fbctx_clear(pstm_fbctx *fb);
+extern int32_t pstm_exptmod_fixed(psPool_t *pool, const pstm_fbctx *fb,
+                                  const pstm_int *X, pstm_int *Y);
 extern int32_t pstm_2expt(pstm_int *a, int16_t b);
 
 extern int32_t pstm_montgomery_setup(const pstm_int *a, pstm_digit *rho);
@@ -242,6 +351,15 @@ extern int32_t pstm_montgomery_reduce(psPool_t *pool, pstm_int *a, const pstm_in
                                       pstm_digit mp, pstm_digit *paD, psSize_t paDlen);
 extern int32_t pstm_montgomery_calc_normalization(pstm_int *a, const pstm_int *b);
 
+extern int32_t pstm_modctx_init(psPool_t *pool, pstm_modctx *ctx,
+                                const pstm_int *m);
+extern void pstm_modctx_clear(pstm_modctx *ctx);
+extern int32_t pstm_mulmod_ctx(psPool_t *pool, const pstm_modctx *ctx,
+                               const pstm_int *a, const pstm_int *b,
+                               pstm_int *c);
+extern int32_t pstm_mod_ctx(psPool_t *pool, const pstm_modctx *ctx,
+                            const pstm_int *a, pstm_int *c);
+
 # endif /* USE_MATRIX_RSA || USE_MATRIX_ECC || USE_MATRIX_DH || USE_CL_RSA || USE_CL_DH || USE_QUICK_ASSIST_RSA || USE_QUICK_ASSIST_ECC */
 
 #endif  /* _h_PSTMATH */
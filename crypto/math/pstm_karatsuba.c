@@ -0,0 +1,525 @@
+/**
+ *      @file    pstm_karatsuba.c
+ *      @version $Format:%h%d$
+ *
+ *      Multiprecision multiplication and squaring with Karatsuba technique.
+ */
+/*
+ *      Copyright (c) 2013-2017 INSIDE Secure Corporation
+ *      All Rights Reserved
+ *
+ *      The latest version of this code is available at http://www.matrixssl.org
+ *
+ *      This software is open source; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This General Public License does NOT permit incorporating this software
+ *      into proprietary programs.  If you are unable to comply with the GPL, a
+ *      commercial license for this software may be purchased from INSIDE at
+ *      http://www.insidesecure.com/
+ *
+ *      This program is distributed in WITHOUT ANY WARRANTY; without even the
+ *      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *      See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program; if not, write to the Free Software
+ *      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *      http://www.gnu.org/copyleft/gpl.html
+ */
+/******************************************************************************/
+
+#include "../cryptoImpl.h"
+
+#if defined(USE_MATRIX_RSA) || defined(USE_MATRIX_ECC) || defined(USE_MATRIX_DH)
+# ifdef USE_PSTM_KARATSUBA
+
+/*
+    Operands are split in a low half of m digits and a high half of h digits
+    (h >= m), and the middle term is formed from |a1 - a0| * |b1 - b0| so
+    that all three sub-products are at most h digits wide. This keeps the
+    halves of 2048 and 4096 bit operands on the unrolled comba16/comba32
+    paths.
+
+    The control flow depends only on the operand sizes, never on their
+    values, as with the comba code, so this may be used for secret data.
+
+    All temporaries come from a single scratch area: either the caller's
+    paD, when it is large enough, or one allocation per top level call.
+ */
+
+/* Recursion never splits below this, regardless of the tuned cutoffs */
+#  define KARATSUBA_MIN_DIGITS    8
+
+static const psSize_t karatsuba_mul_cutoff = PSTM_KARATSUBA_MUL_CUTOFF;
+static const psSize_t karatsuba_sqr_cutoff = PSTM_KARATSUBA_SQR_CUTOFF;
+
+static psSize_t karatsuba_cutoff(psSize_t cutoff)
+{
+    return cutoff < KARATSUBA_MIN_DIGITS ? KARATSUBA_MIN_DIGITS : cutoff;
+}
+
+/******************************************************************************/
+/*
+    Digits of scratch needed by karatsuba_mul() or karatsuba_sqr() for
+    n digit operands.
+ */
+static uint32 karatsuba_scratch_digits(psSize_t n, psSize_t cutoff)
+{
+    uint32 h;
+
+    if (n < cutoff)
+    {
+        return 2 * n;
+    }
+    h = n - n / 2;
+    return 6 * h + 1 + karatsuba_scratch_digits(h, cutoff);
+}
+
+/******************************************************************************/
+/*
+    r[0..n) = a[0..n) + b[0..n), returns the carry.
+ */
+static pstm_digit karatsuba_add(pstm_digit *r, const pstm_digit *a,
+    const pstm_digit *b, psSize_t n)
+{
+    pstm_word t = 0;
+    psSize_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        t += (pstm_word) a[i] + b[i];
+        r[i] = (pstm_digit) t;
+        t >>= DIGIT_BIT;
+    }
+    return (pstm_digit) t;
+}
+
+/*
+    r[0..n) -= a[0..n), returns the borrow.
+ */
+static pstm_digit karatsuba_sub(pstm_digit *r, const pstm_digit *a,
+    psSize_t n)
+{
+    pstm_digit x, y, borrow = 0;
+    psSize_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        x = r[i] - a[i];
+        y = x - borrow;
+        borrow = (x > r[i]) | (y > x);
+        r[i] = y;
+    }
+    return borrow;
+}
+
+/*
+    Add a digit to r[0..n), returns the carry out of the top digit.
+ */
+static pstm_digit karatsuba_inc(pstm_digit *r, pstm_digit c, psSize_t n)
+{
+    psSize_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        r[i] += c;
+        c = r[i] < c;
+    }
+    return c;
+}
+
+/*
+    Subtract a digit from r[0..n), returns the borrow out of the top digit.
+ */
+static pstm_digit karatsuba_dec(pstm_digit *r, pstm_digit c, psSize_t n)
+{
+    pstm_digit x;
+    psSize_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        x = r[i];
+        r[i] = x - c;
+        c = r[i] > x;
+    }
+    return c;
+}
+
+/*
+    r[0..n) += a[0..n) if mask is zero, r[0..n) -= a[0..n) if mask is all
+    ones. Returns what is to be added to the digit above r[n - 1].
+ */
+static pstm_digit karatsuba_addsub(pstm_digit *r, const pstm_digit *a,
+    pstm_digit mask, psSize_t n)
+{
+    pstm_word t;
+    psSize_t i;
+
+    /* r + (a ^ mask) + (mask & 1) is r - a in two's complement */
+    t = mask & 1;
+    for (i = 0; i < n; i++)
+    {
+        t += (pstm_word) r[i] + (a[i] ^ mask);
+        r[i] = (pstm_digit) t;
+        t >>= DIGIT_BIT;
+    }
+    return (pstm_digit) t + mask;
+}
+
+/*
+    r[0..h) = |hi[0..h) - lo[0..m)| with m <= h.
+    Returns 1 if lo > hi, so the result is the negated difference.
+    The operand values do not affect the instructions executed, so this
+    can be used with secret data.
+ */
+static pstm_digit karatsuba_absdiff(pstm_digit *r, const pstm_digit *hi,
+    psSize_t h, const pstm_digit *lo, psSize_t m)
+{
+    pstm_digit neg, mask;
+    psSize_t i;
+
+    memcpy(r, hi, h * sizeof(pstm_digit));
+    neg = karatsuba_dec(r + m, karatsuba_sub(r, lo, m), h - m);
+    /* Negate if the subtraction borrowed */
+    mask = 0 - neg;
+    for (i = 0; i < h; i++)
+    {
+        r[i] ^= mask;
+    }
+    karatsuba_inc(r, neg, h);
+    return neg;
+}
+
+/******************************************************************************/
+/*
+    Leaves of the recursion use the comba multiplier and squarer on pstm_int
+    views of the digit arrays. The views are sized so nothing is grown.
+ */
+static void karatsuba_view(pstm_int *v, psPool_t *pool, const pstm_digit *d,
+    psSize_t n)
+{
+    v->dp = (pstm_digit *) d;
+    v->pool = pool;
+    v->used = n;
+    v->alloc = n;
+    v->sign = PSTM_ZPOS;
+}
+
+static int32_t karatsuba_leaf_mul(psPool_t *pool, const pstm_digit *a,
+    const pstm_digit *b, psSize_t n, pstm_digit *r, pstm_digit *t)
+{
+    pstm_int A, B, C;
+
+    karatsuba_view(&A, pool, a, n);
+    karatsuba_view(&B, pool, b, n);
+    karatsuba_view(&C, pool, r, 2 * n);
+    C.used = 0;
+    return pstm_mul_comba_base(pool, &A, &B, &C, t,
+        2 * n * sizeof(pstm_digit));
+}
+
+static int32_t karatsuba_leaf_sqr(psPool_t *pool, const pstm_digit *a,
+    psSize_t n, pstm_digit *r, pstm_digit *t)
+{
+    pstm_int A, B;
+
+    karatsuba_view(&A, pool, a, n);
+    karatsuba_view(&B, pool, r, 2 * n);
+    B.used = 0;
+    return pstm_sqr_comba_base(pool, &A, &B, t, 2 * n * sizeof(pstm_digit));
+}
+
+/******************************************************************************/
+/*
+    r[0..2n) = a[0..n) * b[0..n)
+    t must hold karatsuba_scratch_digits(n, cutoff) digits.
+ */
+static int32_t karatsuba_mul(psPool_t *pool, const pstm_digit *a,
+    const pstm_digit *b, psSize_t n, pstm_digit *r, pstm_digit *t,
+    psSize_t cutoff)
+{
+    pstm_digit *da, *db, *prod, *mid, *rest, c, neg;
+    psSize_t m, h;
+    int32_t err;
+
+    if (n < cutoff)
+    {
+        return karatsuba_leaf_mul(pool, a, b, n, r, t);
+    }
+    m = n / 2;
+    h = n - m;
+    da = t;
+    db = da + h;
+    prod = db + h;
+    mid = prod + 2 * h;
+    rest = mid + 2 * h + 1;
+
+    /* z0 = a0 * b0 and z2 = a1 * b1 go straight to their final place */
+    if ((err = karatsuba_mul(pool, a, b, m, r, rest, cutoff)) != PSTM_OKAY)
+    {
+        return err;
+    }
+    if ((err = karatsuba_mul(pool, a + m, b + m, h, r + 2 * m, rest, cutoff))
+        != PSTM_OKAY)
+    {
+        return err;
+    }
+    /* (a1 - a0)(b1 - b0) = z2 + z0 - (a0 * b1 + a1 * b0) */
+    neg = karatsuba_absdiff(da, a + m, h, a, m);
+    neg ^= karatsuba_absdiff(db, b + m, h, b, m);
+    if ((err = karatsuba_mul(pool, da, db, h, prod, rest, cutoff))
+        != PSTM_OKAY)
+    {
+        return err;
+    }
+    /* mid = z2 + z0 -/+ prod, which always fits in 2h + 1 digits */
+    memcpy(mid, r + 2 * m, 2 * h * sizeof(pstm_digit));
+    mid[2 * h] = 0;
+    c = karatsuba_add(mid, mid, r, 2 * m);
+    karatsuba_inc(mid + 2 * m, c, 2 * h + 1 - 2 * m);
+    mid[2 * h] += karatsuba_addsub(mid, prod, neg - 1, 2 * h);
+    c = karatsuba_add(r + m, r + m, mid, 2 * h + 1);
+    karatsuba_inc(r + m + 2 * h + 1, c, n - h - 1);
+    return PSTM_OKAY;
+}
+
+/*
+    r[0..2n) = a[0..n)^2
+    t must hold karatsuba_scratch_digits(n, cutoff) digits.
+ */
+static int32_t karatsuba_sqr(psPool_t *pool, const pstm_digit *a,
+    psSize_t n, pstm_digit *r, pstm_digit *t, psSize_t cutoff)
+{
+    pstm_digit *da, *prod, *mid, *rest, c;
+    psSize_t m, h;
+    int32_t err;
+
+    if (n < cutoff)
+    {
+        return karatsuba_leaf_sqr(pool, a, n, r, t);
+    }
+    m = n / 2;
+    h = n - m;
+    da = t;
+    prod = da + h;
+    mid = prod + 2 * h;
+    rest = mid + 2 * h + 1;
+
+    if ((err = karatsuba_sqr(pool, a, m, r, rest, cutoff)) != PSTM_OKAY)
+    {
+        return err;
+    }
+    if ((err = karatsuba_sqr(pool, a + m, h, r + 2 * m, rest, cutoff))
+        != PSTM_OKAY)
+    {
+        return err;
+    }
+    /* 2 * a0 * a1 = z2 + z0 - (a1 - a0)^2 */
+    karatsuba_absdiff(da, a + m, h, a, m);
+    if ((err = karatsuba_sqr(pool, da, h, prod, rest, cutoff)) != PSTM_OKAY)
+    {
+        return err;
+    }
+    memcpy(mid, r + 2 * m, 2 * h * sizeof(pstm_digit));
+    mid[2 * h] = 0;
+    c = karatsuba_add(mid, mid, r, 2 * m);
+    karatsuba_inc(mid + 2 * m, c, 2 * h + 1 - 2 * m);
+    mid[2 * h] += karatsuba_addsub(mid, prod, PSTM_MASK, 2 * h);
+    c = karatsuba_add(r + m, r + m, mid, 2 * h + 1);
+    karatsuba_inc(r + m + 2 * h + 1, c, n - h - 1);
+    return PSTM_OKAY;
+}
+
+/******************************************************************************/
+/*
+    Copy a 'pa' digit product into C, clearing what is left of its old value.
+ */
+static int32_t karatsuba_store(pstm_int *C, const pstm_digit *r, psSize_t pa,
+    uint8_t sign)
+{
+    psSize_t oldused;
+
+    if (C->alloc < pa)
+    {
+        if (pstm_grow(C, pa) != PSTM_OKAY)
+        {
+            return PS_MEM_FAIL;
+        }
+    }
+    oldused = C->used;
+    memcpy(C->dp, r, pa * sizeof(pstm_digit));
+    if (oldused > pa)
+    {
+        memset(C->dp + pa, 0x0, (oldused - pa) * sizeof(pstm_digit));
+    }
+    C->used = pa;
+    C->sign = sign;
+    pstm_clamp(C);
+    return PSTM_OKAY;
+}
+
+/******************************************************************************/
+/**
+    Return the size in bytes of the paD buffer that lets pstm_mul_comba() and
+    pstm_sqr_comba() run on operands of 'digits' digits without allocating.
+ */
+uint32 pstm_karatsuba_scratch_size(psSize_t digits)
+{
+    psSize_t cutoff;
+    uint32 n;
+
+    cutoff = karatsuba_cutoff(min(karatsuba_mul_cutoff,
+            karatsuba_sqr_cutoff));
+    if (digits < cutoff)
+    {
+        return 0;
+    }
+    /* Zero extended operand copies, product, recursion temporaries */
+    n = 2 * digits + 2 * digits + karatsuba_scratch_digits(digits, cutoff);
+    return n * sizeof(pstm_digit);
+}
+
+/**
+    C = A * B using Karatsuba multiplication.
+    Operands of unequal length are zero extended to the longer one, so the
+    caller should only use this for roughly balanced operands.
+
+    @param[in] pool Memory pool
+    @param[in] A Multiplicand
+    @param[in] B Multiplier
+    @param[out] C Result, may be the same as A or B
+    @param[in,out] paD Temporary storage, may be NULL
+    @param[in] paDlen Size of paD in bytes
+ */
+int32_t pstm_mul_karatsuba(psPool_t *pool, const pstm_int *A,
+    const pstm_int *B, pstm_int *C, pstm_digit *paD, psSize_t paDlen)
+{
+    return pstm_mul_karatsuba_cutoff(pool, A, B, C, paD, paDlen,
+        karatsuba_mul_cutoff);
+}
+
+/**
+    pstm_mul_karatsuba() with operands below 'cutoff' digits going to comba.
+    Only tuning code needs another cutoff than the built in one.
+ */
+int32_t pstm_mul_karatsuba_cutoff(psPool_t *pool, const pstm_int *A,
+    const pstm_int *B, pstm_int *C, pstm_digit *paD, psSize_t paDlen,
+    psSize_t cutoff)
+{
+    const pstm_digit *a, *b;
+    pstm_digit *buf, *x, *r;
+    psSize_t n;
+    uint32 need;
+    int32_t err;
+
+    n = A->used > B->used ? A->used : B->used;
+    cutoff = karatsuba_cutoff(cutoff);
+    need = (4 * n + karatsuba_scratch_digits(n, cutoff)) * sizeof(pstm_digit);
+    if (paD != NULL && paDlen >= need)
+    {
+        buf = paD;
+    }
+    else if ((buf = psMalloc(pool, need)) == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    x = buf;
+    a = A->dp;
+    if (A->used < n)
+    {
+        memcpy(x, A->dp, A->used * sizeof(pstm_digit));
+        memset(x + A->used, 0x0, (n - A->used) * sizeof(pstm_digit));
+        a = x;
+    }
+    x += n;
+    b = B->dp;
+    if (B->used < n)
+    {
+        memcpy(x, B->dp, B->used * sizeof(pstm_digit));
+        memset(x + B->used, 0x0, (n - B->used) * sizeof(pstm_digit));
+        b = x;
+    }
+    x += n;
+    r = x;
+    x += 2 * n;
+
+    if (a == b)
+    {
+        err = karatsuba_sqr(pool, a, n, r, x, cutoff);
+    }
+    else
+    {
+        err = karatsuba_mul(pool, a, b, n, r, x, cutoff);
+    }
+    if (err == PSTM_OKAY)
+    {
+        err = karatsuba_store(C, r, A->used + B->used, A->sign ^ B->sign);
+    }
+    if (buf != paD)
+    {
+        /* The scratch holds partial products of the operands */
+        memzero_s(buf, need);
+        psFree(buf, pool);
+    }
+    return err;
+}
+
+/**
+    B = A**2 using Karatsuba squaring.
+
+    @param[in] pool Memory pool
+    @param[in] A Base
+    @param[out] B Result, may be the same as A
+    @param[in,out] paD Temporary storage, may be NULL
+    @param[in] paDlen Size of paD in bytes
+ */
+int32_t pstm_sqr_karatsuba(psPool_t *pool, const pstm_int *A, pstm_int *B,
+    pstm_digit *paD, psSize_t paDlen)
+{
+    return pstm_sqr_karatsuba_cutoff(pool, A, B, paD, paDlen,
+        karatsuba_sqr_cutoff);
+}
+
+/**
+    pstm_sqr_karatsuba() with operands below 'cutoff' digits going to comba.
+    Only tuning code needs another cutoff than the built in one.
+ */
+int32_t pstm_sqr_karatsuba_cutoff(psPool_t *pool, const pstm_int *A,
+    pstm_int *B, pstm_digit *paD, psSize_t paDlen, psSize_t cutoff)
+{
+    pstm_digit *buf;
+    psSize_t n;
+    uint32 need;
+    int32_t err;
+
+    n = A->used;
+    cutoff = karatsuba_cutoff(cutoff);
+    need = (2 * n + karatsuba_scratch_digits(n, cutoff)) * sizeof(pstm_digit);
+    if (paD != NULL && paDlen >= need)
+    {
+        buf = paD;
+    }
+    else if ((buf = psMalloc(pool, need)) == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    err = karatsuba_sqr(pool, A->dp, n, buf, buf + 2 * n, cutoff);
+    if (err == PSTM_OKAY)
+    {
+        err = karatsuba_store(B, buf, 2 * n, PSTM_ZPOS);
+    }
+    if (buf != paD)
+    {
+        memzero_s(buf, need);
+        psFree(buf, pool);
+    }
+    return err;
+}
+
+# endif /* USE_PSTM_KARATSUBA */
+#endif  /* USE_MATRIX_RSA || USE_MATRIX_ECC || USE_MATRIX_DH */
+
+/******************************************************************************/
@@ -348,7 +348,7 @@ int32_t pstm_montgomery_reduce(psPool_t *pool, pstm_int *a, const pstm_int *m,
     if (paD && paDlen >= cSize)
     {
         c = paD;
-        memset(c, 0x0, paDlen);
+        memset(c, 0x0, cSize);
     }
     else
     {
@@ -250,7 +250,7 @@ static int32_t pstm_mul_comba_gen(psPool_t *pool, const pstm_int *A,
         else
         {
             dst = paD;
-            memset(dst, 0x0, paDlen);
+            memset(dst, 0x0, sizeof(pstm_digit) * pa);
         }
     }
     else
@@ -774,8 +774,17 @@ static int32_t pstm_mul_comba32(const pstm_int *A, const pstm_int *B, pstm_int *
 
 /******************************************************************************/
 
-int32 pstm_mul_comba(psPool_t *pool, const pstm_int *A, const pstm_int *B, pstm_int *C,
-    pstm_digit *paD, psSize_t paDlen)
+/**
+    C = A * B with the comba multipliers only.
+    @param[in] pool Memory pool
+    @param[in] A Multiplicand
+    @param[in] B Multiplier
+    @param[out] C Result
+    @param[in,out] paD Temporary storage
+    @param[in] paDlen Size of paD in bytes
+ */
+int32_t pstm_mul_comba_base(psPool_t *pool, const pstm_int *A,
+    const pstm_int *B, pstm_int *C, pstm_digit *paD, psSize_t paDlen)
 {
 # ifdef USE_1024_KEY_SPEED_OPTIMIZATIONS
     if (A->used == 16 && B->used == 16)
@@ -803,6 +812,25 @@ int32 pstm_mul_comba(psPool_t *pool, const pstm_int *A, const pstm_int *B, pstm_
 # endif
 }
 
+/******************************************************************************/
+/**
+    C = A * B.
+    Large, balanced operands use Karatsuba multiplication when enabled.
+ */
+int32_t pstm_mul_comba(psPool_t *pool, const pstm_int *A, const pstm_int *B,
+    pstm_int *C, pstm_digit *paD, psSize_t paDlen)
+{
+# ifdef USE_PSTM_KARATSUBA
+    if (A->used >= PSTM_KARATSUBA_MUL_CUTOFF &&
+        B->used >= PSTM_KARATSUBA_MUL_CUTOFF &&
+        4 * A->used >= 3 * B->used && 4 * B->used >= 3 * A->used)
+    {
+        return pstm_mul_karatsuba(pool, A, B, C, paD, paDlen);
+    }
+# endif /* USE_PSTM_KARATSUBA */
+    return pstm_mul_comba_base(pool, A, B, C, paD, paDlen);
+}
+
 #endif /* defined(USE_MATRIX_RSA) || defined(USE_MATRIX_ECC) */
 
 /******************************************************************************/
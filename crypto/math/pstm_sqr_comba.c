@@ -470,7 +470,7 @@ static int32_t pstm_sqr_comba_gen(psPool_t *pool, const pstm_int *A,
         else
         {
             dst = paD;
-            memset(dst, 0x0, paDlen);
+            memset(dst, 0x0, sizeof(pstm_digit) * pa);
         }
     }
     else
@@ -1095,14 +1095,14 @@ static int32_t pstm_sqr_comba32(const pstm_int *A, pstm_int *B)
 
 /******************************************************************************/
 /**
-    B = A**2.
+    B = A**2 with the comba squarers only.
     @param[in] pool Memory pool
     @param[in] A Base
     @param[out] B Result
     @param[in,out] paD Temporary storage
     @param[in] paDlen Number of items pointed to by paD
  */
-int32_t pstm_sqr_comba(psPool_t *pool, const pstm_int *A, pstm_int *B,
+int32_t pstm_sqr_comba_base(psPool_t *pool, const pstm_int *A, pstm_int *B,
     pstm_digit *paD, psSize_t paDlen)
 {
 # ifdef USE_1024_KEY_SPEED_OPTIMIZATIONS
@@ -1131,6 +1131,23 @@ int32_t pstm_sqr_comba(psPool_t *pool, const pstm_int *A, pstm_int *B,
 # endif
 }
 
+/******************************************************************************/
+/**
+    B = A**2.
+    Large operands use Karatsuba squaring when enabled.
+ */
+int32_t pstm_sqr_comba(psPool_t *pool, const pstm_int *A, pstm_int *B,
+    pstm_digit *paD, psSize_t paDlen)
+{
+# ifdef USE_PSTM_KARATSUBA
+    if (A->used >= PSTM_KARATSUBA_SQR_CUTOFF)
+    {
+        return pstm_sqr_karatsuba(pool, A, B, paD, paDlen);
+    }
+# endif /* USE_PSTM_KARATSUBA */
+    return pstm_sqr_comba_base(pool, A, B, paD, paDlen);
+}
+
 #endif /* defined(USE_MATRIX_RSA) || defined(USE_MATRIX_ECC) */
 
 /******************************************************************************/
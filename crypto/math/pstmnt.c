@@ -721,6 +721,14 @@ __extension__ typedef unsigned __int128 pstmntDD_word;
         PSTM_ZPOS                                           \
     }
 
+# if DIGIT_BIT >= 32 && defined(USE_PSTM_KARATSUBA)
+/* Karatsuba scratch for the largest pstmnt operands, 4096 bits. On the stack
+   so that the Montgomery steps of a modular exponentiation do not allocate,
+   and cleared after use since it holds partial products of secret values. */
+#  define PSTMNT_KARATSUBA_SCRATCH_DIGITS \
+    (PSTM_KARATSUBA_SCRATCH_BOUND(4096 / DIGIT_BIT) / sizeof(pstm_digit))
+# endif
+
 /* Use pstm_sqr_comba if compiled in and suitable size variant is available. */
 __inline static int
 pstmnt_square_comba(
@@ -766,6 +774,20 @@ pstmnt_square_comba(
         return res == PSTM_OKAY;
     }
 #   endif
+#   if DIGIT_BIT >= 32 && defined(USE_PSTM_KARATSUBA)
+    /* Large operands go to the Karatsuba squarer behind pstm_sqr_comba */
+    if (sz % (DIGIT_BIT / 32) == 0 &&
+        sz / (DIGIT_BIT / 32) >= PSTM_KARATSUBA_SQR_CUTOFF)
+    {
+        pstm_digit paD[PSTMNT_KARATSUBA_SCRATCH_DIGITS];
+        pstm_int a_wrap = PSTM_INT_UNSIGNED_MEM(a, sz / (DIGIT_BIT / 32));
+        pstm_int r_wrap = PSTM_INT_UNSIGNED_MEM(r, 2 * sz / (DIGIT_BIT / 32));
+        int32_t res = pstm_sqr_comba(NULL, &a_wrap, &r_wrap, paD,
+            sizeof(paD));
+        memzero_s(paD, sizeof(paD));
+        return res == PSTM_OKAY;
+    }
+#   endif
 #  endif /* PSTMNT_WORD_BITS == 32 */
 # endif  /* !PSTMNT_NO_COMBA */
     return 0;
@@ -820,6 +842,20 @@ pstmnt_mult_comba(
         return res == PSTM_OKAY;
     }
 #   endif
+#   if DIGIT_BIT >= 32 && defined(USE_PSTM_KARATSUBA)
+    if (sz % (DIGIT_BIT / 32) == 0 &&
+        sz / (DIGIT_BIT / 32) >= PSTM_KARATSUBA_MUL_CUTOFF)
+    {
+        pstm_digit paD[PSTMNT_KARATSUBA_SCRATCH_DIGITS];
+        pstm_int a_wrap = PSTM_INT_UNSIGNED_MEM(a, sz / (DIGIT_BIT / 32));
+        pstm_int b_wrap = PSTM_INT_UNSIGNED_MEM(b, sz / (DIGIT_BIT / 32));
+        pstm_int r_wrap = PSTM_INT_UNSIGNED_MEM(r, 2 * sz / (DIGIT_BIT / 32));
+        int32_t res = pstm_mul_comba(NULL, &a_wrap, &b_wrap, &r_wrap, paD,
+            sizeof(paD));
+        memzero_s(paD, sizeof(paD));
+        return res == PSTM_OKAY;
+    }
+#   endif
 #  endif /* PSTMNT_WORD_BITS == 32 */
 # endif  /* !PSTMNT_NO_COMBA */
     return 0;
@@ -1412,7 +1448,7 @@ pstmnt_square(
         return;
     }
 
-    if ((sz & 1) == 0 && sz < 4096 / 32)
+    if ((sz & 1) == 0 && sz <= 4096 / 32)
     {
         pstmnt_dword a_storage[4096 / 64];
         if ((((unsigned long) a) & 0x7) != 0)
@@ -1734,7 +1770,7 @@ pstmnt_mult(
     }
 
 #  ifdef PSTMNT_USE_INT128_MULT
-    if ((sz & 1) == 0 && sz >= 4 && sz < 4096 / 32)
+    if ((sz & 1) == 0 && sz >= 4 && sz <= 4096 / 32)
     {
         pstmnt_dword a_storage[4096 / 64];
         pstmnt_dword b_storage[4096 / 64];
@@ -1817,7 +1853,7 @@ pstmnt_mult_unroll2(
     PSTMNT_PRECONDITION(b != r);
 
 #   ifdef PSTMNT_USE_INT128_MULT
-    if ((sz & 1) == 0 && sz >= 4 && sz < 4096 / 32)
+    if ((sz & 1) == 0 && sz >= 4 && sz <= 4096 / 32)
     {
         pstmnt_dword a_storage[4096 / 64];
         pstmnt_dword b_storage[4096 / 64];
@@ -1935,7 +1971,7 @@ pstmnt_mult(
     }
 
 #  ifdef PSTMNT_USE_INT128_MULT
-    if ((sz & 1) == 0 && sz >= 4 && sz < 4096 / 32)
+    if ((sz & 1) == 0 && sz >= 4 && sz <= 4096 / 32)
     {
         pstmnt_dword a_storage[4096 / 64];
         pstmnt_dword b_storage[4096 / 64];
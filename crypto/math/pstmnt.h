@@ -128,6 +128,26 @@ pstmnt_mod_exp_montgomery_skip(
     pstmnt_word mp,
     pstmnt_words len);
 
+/* Montgomery multiplication, or squaring when 'a' and 'b' are the same,
+   r == a * b * R^-1 (mod p). 'r' may overlap 'a' or 'b'. */
+void
+pstmnt_montgomery_step(
+    const pstmnt_word a[] /* n */,
+    const pstmnt_word b[] /* n */,
+    pstmnt_word r[] /* n */,
+    pstmnt_word temp_r[] /* n * 2 */,
+    const pstmnt_word p[] /* n */,
+    pstmnt_word mp,
+    pstmnt_words n);
+
+/* Data independent r = (r & ~bmask) | (b & bmask). */
+void
+pstmnt_select_mask(
+    const uint32_t *b,
+    uint32_t *r,
+    int szl,
+    uint32_t bmask);
+
 # endif /* INCLUDE_GUARD_PSTMNT_H */
 
 #endif  /* USE_CONSTANT_TIME_MODEXP */
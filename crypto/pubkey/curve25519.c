@@ -0,0 +1,1350 @@
+/**
+ *      @file    curve25519.c
+ *      @version $Format:%h%d$
+ *
+ *      X25519 Diffie-Hellman function (RFC 7748) for ECDHE key exchange
+ *      and Ed25519 signatures (RFC 8032).
+ */
+/*
+ *      Copyright (c) 2017 INSIDE Secure Corporation
+ *      All Rights Reserved
+ *
+ *      The latest version of this code is available at http://www.matrixssl.org
+ *
+ *      This software is open source; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This General Public License does NOT permit incorporating this software
+ *      into proprietary programs.  If you are unable to comply with the GPL, a
+ *      commercial license for this software may be purchased from INSIDE at
+ *      http://www.insidesecure.com/
+ *
+ *      This program is distributed in WITHOUT ANY WARRANTY; without even the
+ *      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *      See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program; if not, write to the Free Software
+ *      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *      http://www.gnu.org/copyleft/gpl.html
+ */
+/******************************************************************************/
+
+#include "../cryptoImpl.h"
+
+#if defined(USE_MATRIX_ECC) && (defined(USE_X25519) || defined(USE_ED25519))
+
+/******************************************************************************/
+/*
+    Arithmetic modulo p = 2^255 - 19.
+
+    The field code does not use pstm, every operation runs in time
+    independent of the values, and the X25519 ladder and the Ed25519
+    signing multiplication select their operands with masks instead of
+    branching on key bits.
+
+    With 64 bit digits an element is five 51 bit limbs and products use
+    the 128 bit word of the compiler. Otherwise an element is sixteen 16 bit
+    limbs held in 64 bit integers, which needs only 32x32 bit products.
+ */
+# ifdef PSTM_64BIT
+
+typedef uint64_t fe[5];
+typedef unsigned long x25519_u128 __attribute__ ((mode(TI)));
+
+#  define MASK51  0x7FFFFFFFFFFFFULL
+
+static uint64_t load64(const unsigned char *p)
+{
+    return (uint64_t) p[0] | ((uint64_t) p[1] << 8) |
+           ((uint64_t) p[2] << 16) | ((uint64_t) p[3] << 24) |
+           ((uint64_t) p[4] << 32) | ((uint64_t) p[5] << 40) |
+           ((uint64_t) p[6] << 48) | ((uint64_t) p[7] << 56);
+}
+
+static void store64(unsigned char *p, uint64_t v)
+{
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        p[i] = (unsigned char) (v >> (8 * i));
+    }
+}
+
+/* Little endian bytes to element, the top bit is ignored */
+static void feFromBytes(fe h, const unsigned char s[32])
+{
+    h[0] = load64(s) & MASK51;
+    h[1] = (load64(s + 6) >> 3) & MASK51;
+    h[2] = (load64(s + 12) >> 6) & MASK51;
+    h[3] = (load64(s + 19) >> 1) & MASK51;
+    h[4] = (load64(s + 24) >> 12) & MASK51;
+}
+
+static void feCarry(fe h)
+{
+    h[1] += h[0] >> 51; h[0] &= MASK51;
+    h[2] += h[1] >> 51; h[1] &= MASK51;
+    h[3] += h[2] >> 51; h[2] &= MASK51;
+    h[4] += h[3] >> 51; h[3] &= MASK51;
+    h[0] += 19 * (h[4] >> 51); h[4] &= MASK51;
+}
+
+/* Fully reduced little endian bytes */
+static void feToBytes(unsigned char s[32], const fe f)
+{
+    fe h;
+
+    memcpy(h, f, sizeof(fe));
+    feCarry(h);
+    feCarry(h);
+    /* h is now below 2p. Compute h + 19 mod 2^255, then add 2^255 - 19
+       and drop the top bit: this subtracts p exactly when h >= p. */
+    h[0] += 19;
+    feCarry(h);
+    h[0] += 0x8000000000000ULL - 19;
+    h[1] += 0x8000000000000ULL - 1;
+    h[2] += 0x8000000000000ULL - 1;
+    h[3] += 0x8000000000000ULL - 1;
+    h[4] += 0x8000000000000ULL - 1;
+    h[1] += h[0] >> 51; h[0] &= MASK51;
+    h[2] += h[1] >> 51; h[1] &= MASK51;
+    h[3] += h[2] >> 51; h[2] &= MASK51;
+    h[4] += h[3] >> 51; h[3] &= MASK51;
+    h[4] &= MASK51;
+    store64(s, h[0] | (h[1] << 51));
+    store64(s + 8, (h[1] >> 13) | (h[2] << 38));
+    store64(s + 16, (h[2] >> 26) | (h[3] << 25));
+    store64(s + 24, (h[3] >> 39) | (h[4] << 12));
+}
+
+static void feSet(fe h, uint32_t v)
+{
+    h[0] = v;
+    h[1] = h[2] = h[3] = h[4] = 0;
+}
+
+static void feAdd(fe h, const fe f, const fe g)
+{
+    int i;
+
+    for (i = 0; i < 5; i++)
+    {
+        h[i] = f[i] + g[i];
+    }
+}
+
+/* Adds 2p first, so limbs of g must be below 2^52 */
+static void feSub(fe h, const fe f, const fe g)
+{
+    h[0] = (f[0] + 0xFFFFFFFFFFFDAULL) - g[0];
+    h[1] = (f[1] + 0xFFFFFFFFFFFFEULL) - g[1];
+    h[2] = (f[2] + 0xFFFFFFFFFFFFEULL) - g[2];
+    h[3] = (f[3] + 0xFFFFFFFFFFFFEULL) - g[3];
+    h[4] = (f[4] + 0xFFFFFFFFFFFFEULL) - g[4];
+}
+
+static void feReduce(fe h, x25519_u128 t0, x25519_u128 t1, x25519_u128 t2,
+    x25519_u128 t3, x25519_u128 t4)
+{
+    uint64_t c;
+
+    h[0] = (uint64_t) t0 & MASK51; t1 += (uint64_t) (t0 >> 51);
+    h[1] = (uint64_t) t1 & MASK51; t2 += (uint64_t) (t1 >> 51);
+    h[2] = (uint64_t) t2 & MASK51; t3 += (uint64_t) (t2 >> 51);
+    h[3] = (uint64_t) t3 & MASK51; t4 += (uint64_t) (t3 >> 51);
+    h[4] = (uint64_t) t4 & MASK51; c = (uint64_t) (t4 >> 51);
+    h[0] += c * 19;
+    h[1] += h[0] >> 51; h[0] &= MASK51;
+}
+
+static void feMul(fe h, const fe f, const fe g)
+{
+    uint64_t g1_19, g2_19, g3_19, g4_19;
+
+    g1_19 = 19 * g[1];
+    g2_19 = 19 * g[2];
+    g3_19 = 19 * g[3];
+    g4_19 = 19 * g[4];
+    feReduce(h,
+        (x25519_u128) f[0] * g[0] + (x25519_u128) f[1] * g4_19 +
+        (x25519_u128) f[2] * g3_19 + (x25519_u128) f[3] * g2_19 +
+        (x25519_u128) f[4] * g1_19,
+        (x25519_u128) f[0] * g[1] + (x25519_u128) f[1] * g[0] +
+        (x25519_u128) f[2] * g4_19 + (x25519_u128) f[3] * g3_19 +
+        (x25519_u128) f[4] * g2_19,
+        (x25519_u128) f[0] * g[2] + (x25519_u128) f[1] * g[1] +
+        (x25519_u128) f[2] * g[0] + (x25519_u128) f[3] * g4_19 +
+        (x25519_u128) f[4] * g3_19,
+        (x25519_u128) f[0] * g[3] + (x25519_u128) f[1] * g[2] +
+        (x25519_u128) f[2] * g[1] + (x25519_u128) f[3] * g[0] +
+        (x25519_u128) f[4] * g4_19,
+        (x25519_u128) f[0] * g[4] + (x25519_u128) f[1] * g[3] +
+        (x25519_u128) f[2] * g[2] + (x25519_u128) f[3] * g[1] +
+        (x25519_u128) f[4] * g[0]);
+}
+
+static void feSqr(fe h, const fe f)
+{
+    uint64_t f0_2, f1_2, f3_2, f2_2, f3_19, f4_19;
+
+    f0_2 = 2 * f[0];
+    f1_2 = 2 * f[1];
+    f2_2 = 2 * f[2];
+    f3_2 = 2 * f[3];
+    f3_19 = 19 * f[3];
+    f4_19 = 19 * f[4];
+    feReduce(h,
+        (x25519_u128) f[0] * f[0] + (x25519_u128) f1_2 * f4_19 +
+        (x25519_u128) f2_2 * f3_19,
+        (x25519_u128) f0_2 * f[1] + (x25519_u128) f2_2 * f4_19 +
+        (x25519_u128) f[3] * f3_19,
+        (x25519_u128) f0_2 * f[2] + (x25519_u128) f[1] * f[1] +
+        (x25519_u128) f3_2 * f4_19,
+        (x25519_u128) f0_2 * f[3] + (x25519_u128) f1_2 * f[2] +
+        (x25519_u128) f[4] * f4_19,
+        (x25519_u128) f0_2 * f[4] + (x25519_u128) f1_2 * f[3] +
+        (x25519_u128) f[2] * f[2]);
+}
+
+#  ifdef USE_X25519
+/* h = f * 121665, the a24 constant of the ladder */
+static void feMulA24(fe h, const fe f)
+{
+    feReduce(h, (x25519_u128) f[0] * 121665, (x25519_u128) f[1] * 121665,
+        (x25519_u128) f[2] * 121665, (x25519_u128) f[3] * 121665,
+        (x25519_u128) f[4] * 121665);
+}
+#  endif
+
+/* Swap f and g if b is 1, without branching */
+static void feSwap(fe f, fe g, uint64_t b)
+{
+    uint64_t m, t;
+    int i;
+
+    m = 0 - b;
+    for (i = 0; i < 5; i++)
+    {
+        t = m & (f[i] ^ g[i]);
+        f[i] ^= t;
+        g[i] ^= t;
+    }
+}
+
+# else /* !PSTM_64BIT */
+
+typedef int64_t fe[16];
+
+static void feFromBytes(fe h, const unsigned char s[32])
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+    {
+        h[i] = s[2 * i] + ((int64_t) s[2 * i + 1] << 8);
+    }
+    h[15] &= 0x7FFF;
+}
+
+static void feCarry(fe h)
+{
+    int64_t c;
+    int i;
+
+    for (i = 0; i < 16; i++)
+    {
+        h[i] += (int64_t) 1 << 16;
+        c = h[i] >> 16;
+        if (i < 15)
+        {
+            h[i + 1] += c - 1;
+        }
+        else
+        {
+            h[0] += 38 * (c - 1);
+        }
+        h[i] -= c << 16;
+    }
+}
+
+/* Swap f and g if b is 1, without branching */
+static void feSwap(fe f, fe g, int64_t b)
+{
+    int64_t m, t;
+    int i;
+
+    m = ~(b - 1);
+    for (i = 0; i < 16; i++)
+    {
+        t = m & (f[i] ^ g[i]);
+        f[i] ^= t;
+        g[i] ^= t;
+    }
+}
+
+static void feToBytes(unsigned char s[32], const fe f)
+{
+    fe t, m;
+    int64_t b;
+    int i, j;
+
+    memcpy(t, f, sizeof(fe));
+    feCarry(t);
+    feCarry(t);
+    feCarry(t);
+    for (j = 0; j < 2; j++)
+    {
+        /* m = t - p, keep it if there was no borrow */
+        m[0] = t[0] - 0xFFED;
+        for (i = 1; i < 15; i++)
+        {
+            m[i] = t[i] - 0xFFFF - ((m[i - 1] >> 16) & 1);
+            m[i - 1] &= 0xFFFF;
+        }
+        m[15] = t[15] - 0x7FFF - ((m[14] >> 16) & 1);
+        b = (m[15] >> 16) & 1;
+        m[14] &= 0xFFFF;
+        feSwap(t, m, 1 - b);
+    }
+    for (i = 0; i < 16; i++)
+    {
+        s[2 * i] = (unsigned char) (t[i] & 0xFF);
+        s[2 * i + 1] = (unsigned char) ((t[i] >> 8) & 0xFF);
+    }
+}
+
+static void feSet(fe h, uint32_t v)
+{
+    memset(h, 0x0, sizeof(fe));
+    h[0] = v;
+}
+
+static void feAdd(fe h, const fe f, const fe g)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+    {
+        h[i] = f[i] + g[i];
+    }
+}
+
+static void feSub(fe h, const fe f, const fe g)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+    {
+        h[i] = f[i] - g[i];
+    }
+}
+
+static void feMul(fe h, const fe f, const fe g)
+{
+    int64_t t[31];
+    int i, j;
+
+    memset(t, 0x0, sizeof(t));
+    for (i = 0; i < 16; i++)
+    {
+        for (j = 0; j < 16; j++)
+        {
+            t[i + j] += f[i] * g[j];
+        }
+    }
+    /* 2^256 = 38 mod p */
+    for (i = 0; i < 15; i++)
+    {
+        t[i] += 38 * t[i + 16];
+    }
+    memcpy(h, t, sizeof(fe));
+    feCarry(h);
+    feCarry(h);
+}
+
+static void feSqr(fe h, const fe f)
+{
+    feMul(h, f, f);
+}
+
+#  ifdef USE_X25519
+static void feMulA24(fe h, const fe f)
+{
+    static const fe a24 = { 0xDB41, 1 };
+
+    feMul(h, f, a24);
+}
+#  endif
+
+# endif /* PSTM_64BIT */
+
+/* h = f^(p - 2) = 1/f */
+static void feInvert(fe h, const fe f)
+{
+    fe z2, z9, z11, z2_5_0, z2_10_0, z2_20_0, z2_50_0, z2_100_0, t;
+    int i;
+
+    feSqr(z2, f);                               /* 2 */
+    feSqr(t, z2);                               /* 4 */
+    feSqr(t, t);                                /* 8 */
+    feMul(z9, t, f);                            /* 9 */
+    feMul(z11, z9, z2);                         /* 11 */
+    feSqr(t, z11);                              /* 22 */
+    feMul(z2_5_0, t, z9);                       /* 2^5 - 2^0 */
+    feSqr(t, z2_5_0);
+    for (i = 1; i < 5; i++)
+    {
+        feSqr(t, t);
+    }
+    feMul(z2_10_0, t, z2_5_0);                  /* 2^10 - 2^0 */
+    feSqr(t, z2_10_0);
+    for (i = 1; i < 10; i++)
+    {
+        feSqr(t, t);
+    }
+    feMul(z2_20_0, t, z2_10_0);                 /* 2^20 - 2^0 */
+    feSqr(t, z2_20_0);
+    for (i = 1; i < 20; i++)
+    {
+        feSqr(t, t);
+    }
+    feMul(t, t, z2_20_0);                       /* 2^40 - 2^0 */
+    for (i = 0; i < 10; i++)
+    {
+        feSqr(t, t);
+    }
+    feMul(z2_50_0, t, z2_10_0);                 /* 2^50 - 2^0 */
+    feSqr(t, z2_50_0);
+    for (i = 1; i < 50; i++)
+    {
+        feSqr(t, t);
+    }
+    feMul(z2_100_0, t, z2_50_0);                /* 2^100 - 2^0 */
+    feSqr(t, z2_100_0);
+    for (i = 1; i < 100; i++)
+    {
+        feSqr(t, t);
+    }
+    feMul(t, t, z2_100_0);                      /* 2^200 - 2^0 */
+    for (i = 0; i < 50; i++)
+    {
+        feSqr(t, t);
+    }
+    feMul(t, t, z2_50_0);                       /* 2^250 - 2^0 */
+    for (i = 0; i < 5; i++)
+    {
+        feSqr(t, t);
+    }
+    feMul(h, t, z11);                           /* 2^255 - 21 */
+}
+
+# ifdef USE_X25519
+/******************************************************************************/
+/**
+    The X25519 function of RFC 7748: out = scalar * u.
+
+    @param[out] out The resulting u-coordinate, 32 bytes.
+    @param[in] scalar Private scalar, 32 bytes. Clamped here.
+    @param[in] u Peer u-coordinate, 32 bytes, or the base point 9.
+    @return PS_SUCCESS, or PS_FAILURE if the result is all zeros, which
+        happens when 'u' is a point of small order.
+ */
+int32_t psX25519(unsigned char out[32], const unsigned char scalar[32],
+    const unsigned char u[32])
+{
+    unsigned char k[32];
+    fe x1, x2, z2, x3, z3, a, aa, b, bb, e, c, d, da, cb;
+    unsigned int swap, bit;
+    unsigned char nz;
+    int t;
+
+    memcpy(k, scalar, 32);
+    k[0] &= 248;
+    k[31] &= 127;
+    k[31] |= 64;
+
+    feFromBytes(x1, u);
+    feSet(x2, 1);
+    feSet(z2, 0);
+    memcpy(x3, x1, sizeof(fe));
+    feSet(z3, 1);
+
+    swap = 0;
+    for (t = 254; t >= 0; t--)
+    {
+        bit = (k[t >> 3] >> (t & 7)) & 1;
+        swap ^= bit;
+        feSwap(x2, x3, swap);
+        feSwap(z2, z3, swap);
+        swap = bit;
+
+        feAdd(a, x2, z2);
+        feSqr(aa, a);
+        feSub(b, x2, z2);
+        feSqr(bb, b);
+        feSub(e, aa, bb);
+        feAdd(c, x3, z3);
+        feSub(d, x3, z3);
+        feMul(da, d, a);
+        feMul(cb, c, b);
+        feAdd(x3, da, cb);
+        feSqr(x3, x3);
+        feSub(z3, da, cb);
+        feSqr(z3, z3);
+        feMul(z3, z3, x1);
+        feMul(x2, aa, bb);
+        feMulA24(z2, e);
+        feAdd(z2, z2, aa);
+        feMul(z2, z2, e);
+    }
+    feSwap(x2, x3, swap);
+    feSwap(z2, z3, swap);
+
+    feInvert(z2, z2);
+    feMul(x2, x2, z2);
+    feToBytes(out, x2);
+    memset_s(k, sizeof(k), 0x0, sizeof(k));
+
+    /* Reject the all zero output, in constant time */
+    nz = 0;
+    for (t = 0; t < 32; t++)
+    {
+        nz |= out[t];
+    }
+    return nz ? PS_SUCCESS : PS_FAILURE;
+}
+
+/******************************************************************************/
+/*
+    X25519 keys are kept in psEccKey_t: the private scalar in 'k' and the
+    public u-coordinate in 'pubkey.x', each as its 32 byte string read as
+    an unsigned number. 'pubkey.y' and 'pubkey.z' are unused.
+ */
+static int32_t x25519GetBytes(psPool_t *pool, const pstm_int *a,
+    unsigned char out[32])
+{
+    psSize_t len;
+
+    len = pstm_unsigned_bin_size(a);
+    if (len > 32)
+    {
+        return PS_ARG_FAIL;
+    }
+    memset(out, 0x0, 32);
+    return pstm_to_unsigned_bin(pool, a, out + (32 - len));
+}
+
+static int32_t x25519SetBytes(psPool_t *pool, pstm_int *a,
+    const unsigned char in[32])
+{
+    int32_t err;
+
+    if ((err = pstm_init_for_read_unsigned_bin(pool, a, 32)) < 0)
+    {
+        return err;
+    }
+    return pstm_read_unsigned_bin(a, in, 32);
+}
+
+/**
+    Generate an X25519 key pair into a key initialized for the curve.
+    The key is cleared on failure.
+ */
+int32_t psX25519GenKey(psPool_t *pool, psEccKey_t *key, void *usrData)
+{
+    static const unsigned char base[32] = { 9 };
+    unsigned char k[32], u[32];
+    int32_t err;
+
+    if (psGetPrngLocked(k, sizeof(k), usrData) != sizeof(k))
+    {
+        return PS_PLATFORM_FAIL;
+    }
+    if ((err = psX25519(u, k, base)) != PS_SUCCESS)
+    {
+        goto L_OUT;
+    }
+    if ((err = x25519SetBytes(pool, &key->k, k)) != PS_SUCCESS)
+    {
+        goto L_OUT;
+    }
+    if ((err = x25519SetBytes(pool, &key->pubkey.x, u)) != PS_SUCCESS)
+    {
+        goto L_OUT;
+    }
+    key->type = PS_PRIVKEY;
+L_OUT:
+    memset_s(k, sizeof(k), 0x0, sizeof(k));
+    if (err != PS_SUCCESS)
+    {
+        psEccClearKey(key);
+    }
+    return err;
+}
+
+/**
+    Import a 32 byte public u-coordinate. The key is cleared on failure.
+ */
+int32_t psX25519ImportKey(psPool_t *pool, const unsigned char *in,
+    psSize_t inlen, psEccKey_t *key)
+{
+    int32_t err;
+
+    if (inlen != 32)
+    {
+        return PS_ARG_FAIL;
+    }
+    if ((err = x25519SetBytes(pool, &key->pubkey.x, in)) != PSTM_OKAY)
+    {
+        psEccClearKey(key);
+        return err;
+    }
+    if (key->type != PS_PRIVKEY)
+    {
+        key->type = PS_PUBKEY;
+    }
+    return PS_SUCCESS;
+}
+
+/**
+    Export the 32 byte public u-coordinate.
+ */
+int32_t psX25519ExportKey(psPool_t *pool, const psEccKey_t *key,
+    unsigned char *out, psSize_t *outlen)
+{
+    int32_t err;
+
+    if (*outlen < 32)
+    {
+        *outlen = 32;
+        return PS_LIMIT_FAIL;
+    }
+    if ((err = x25519GetBytes(pool, &key->pubkey.x, out)) != PSTM_OKAY)
+    {
+        return err;
+    }
+    *outlen = 32;
+    return PS_SUCCESS;
+}
+
+/**
+    Compute the 32 byte shared secret. Fails on an all zero result, as
+    required for TLS by RFC 8422.
+ */
+int32_t psX25519SharedSecret(psPool_t *pool, const psEccKey_t *privKey,
+    const psEccKey_t *pubKey, unsigned char *out, psSize_t *outlen)
+{
+    unsigned char k[32], u[32];
+    int32_t err;
+
+    if (*outlen < 32)
+    {
+        *outlen = 32;
+        return PS_LIMIT_FAIL;
+    }
+    if ((err = x25519GetBytes(pool, &privKey->k, k)) != PSTM_OKAY)
+    {
+        return err;
+    }
+    if ((err = x25519GetBytes(pool, &pubKey->pubkey.x, u)) == PSTM_OKAY)
+    {
+        err = psX25519(out, k, u);
+    }
+    memset_s(k, sizeof(k), 0x0, sizeof(k));
+    if (err != PS_SUCCESS)
+    {
+        psTraceCrypto("X25519 shared secret rejected\n");
+        memset_s(out, 32, 0x0, 32);
+        return err;
+    }
+    *outlen = 32;
+    return PS_SUCCESS;
+}
+
+# endif /* USE_X25519 */
+
+# ifdef USE_ED25519
+/******************************************************************************/
+/*
+    Ed25519 (RFC 8032) on the twisted Edwards curve -x^2 + y^2 = 1 + d x^2 y^2
+    birationally equivalent to Curve25519.
+
+    Points are kept in extended coordinates (X : Y : Z : T) with x = X/Z,
+    y = Y/Z and xy = T/Z. The addition formula used is complete on this
+    curve, so doublings, additions of equal points and of the neutral
+    element need no special cases.
+
+    With 64 bit digits feSub() needs the limbs of its second operand below
+    2^52: all subtrahends below are products, or sums carried first.
+ */
+typedef struct
+{
+    fe X, Y, Z, T;
+} edPoint_t;
+
+/* -121665/121666, 2 * d and sqrt(-1), as little endian bytes */
+static const unsigned char edD[32] = {
+    0xA3, 0x78, 0x59, 0x13, 0xCA, 0x4D, 0xEB, 0x75, 0xAB, 0xD8, 0x41, 0x41,
+    0x4D, 0x0A, 0x70, 0x00, 0x98, 0xE8, 0x79, 0x77, 0x79, 0x40, 0xC7, 0x8C,
+    0x73, 0xFE, 0x6F, 0x2B, 0xEE, 0x6C, 0x03, 0x52
+};
+static const unsigned char edD2[32] = {
+    0x59, 0xF1, 0xB2, 0x26, 0x94, 0x9B, 0xD6, 0xEB, 0x56, 0xB1, 0x83, 0x82,
+    0x9A, 0x14, 0xE0, 0x00, 0x30, 0xD1, 0xF3, 0xEE, 0xF2, 0x80, 0x8E, 0x19,
+    0xE7, 0xFC, 0xDF, 0x56, 0xDC, 0xD9, 0x06, 0x24
+};
+static const unsigned char edSqrtM1[32] = {
+    0xB0, 0xA0, 0x0E, 0x4A, 0x27, 0x1B, 0xEE, 0xC4, 0x78, 0xE4, 0x2F, 0xAD,
+    0x06, 0x18, 0x43, 0x2F, 0xA7, 0xD7, 0xFB, 0x3D, 0x99, 0x00, 0x4D, 0x2B,
+    0x0B, 0xDF, 0xC1, 0x4F, 0x80, 0x24, 0x83, 0x2B
+};
+
+/* The base point B, x then y (y = 4/5) */
+static const unsigned char edBaseX[32] = {
+    0x1A, 0xD5, 0x25, 0x8F, 0x60, 0x2D, 0x56, 0xC9, 0xB2, 0xA7, 0x25, 0x95,
+    0x60, 0xC7, 0x2C, 0x69, 0x5C, 0xDC, 0xD6, 0xFD, 0x31, 0xE2, 0xA4, 0xC0,
+    0xFE, 0x53, 0x6E, 0xCD, 0xD3, 0x36, 0x69, 0x21
+};
+static const unsigned char edBaseY[32] = {
+    0x58, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66
+};
+
+/* The group order L = 2^252 + 27742317777372353535851937790883648493 */
+static const unsigned char edL[32] = {
+    0xED, 0xD3, 0xF5, 0x5C, 0x1A, 0x63, 0x12, 0x58, 0xD6, 0x9C, 0xF7, 0xA2,
+    0xDE, 0xF9, 0xDE, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10
+};
+
+static void feCopy(fe h, const fe f)
+{
+    memcpy(h, f, sizeof(fe));
+}
+
+/* f = g if b is 1, without branching */
+static void feCmov(fe f, const fe g, unsigned int b)
+{
+    fe t;
+
+    feCopy(t, g);
+    feSwap(f, t, b);
+}
+
+static void feNeg(fe h, const fe f)
+{
+    fe z;
+
+    feSet(z, 0);
+    feSub(h, z, f);
+}
+
+static int feIsNegative(const fe f)
+{
+    unsigned char s[32];
+
+    feToBytes(s, f);
+    return s[0] & 1;
+}
+
+static int feEqual(const fe f, const fe g)
+{
+    unsigned char s[32], t[32];
+
+    feToBytes(s, f);
+    feToBytes(t, g);
+    return memcmp(s, t, 32) == 0;
+}
+
+/* h = f^(2^n) */
+static void feSqrN(fe h, const fe f, int n)
+{
+    feSqr(h, f);
+    while (--n > 0)
+    {
+        feSqr(h, h);
+    }
+}
+
+/* h = f^((p - 5) / 8) = f^(2^252 - 3), for the square root */
+static void fePow22523(fe h, const fe f)
+{
+    fe t0, t1, t2;
+
+    feSqr(t0, f);                               /* 2 */
+    feSqrN(t1, t0, 2);                          /* 8 */
+    feMul(t1, f, t1);                           /* 9 */
+    feMul(t0, t0, t1);                          /* 11 */
+    feSqr(t0, t0);                              /* 22 */
+    feMul(t0, t1, t0);                          /* 2^5 - 2^0 */
+    feSqrN(t1, t0, 5);
+    feMul(t0, t1, t0);                          /* 2^10 - 2^0 */
+    feSqrN(t1, t0, 10);
+    feMul(t1, t1, t0);                          /* 2^20 - 2^0 */
+    feSqrN(t2, t1, 20);
+    feMul(t1, t2, t1);                          /* 2^40 - 2^0 */
+    feSqrN(t1, t1, 10);
+    feMul(t0, t1, t0);                          /* 2^50 - 2^0 */
+    feSqrN(t1, t0, 50);
+    feMul(t1, t1, t0);                          /* 2^100 - 2^0 */
+    feSqrN(t2, t1, 100);
+    feMul(t1, t2, t1);                          /* 2^200 - 2^0 */
+    feSqrN(t1, t1, 50);
+    feMul(t0, t1, t0);                          /* 2^250 - 2^0 */
+    feSqrN(t0, t0, 2);                          /* 2^252 - 2^2 */
+    feMul(h, t0, f);                            /* 2^252 - 3 */
+}
+
+static void edIdentity(edPoint_t *r)
+{
+    feSet(r->X, 0);
+    feSet(r->Y, 1);
+    feSet(r->Z, 1);
+    feSet(r->T, 0);
+}
+
+/* r = p + q, add-2008-hwcd-3 with a = -1. r may be p or q. */
+static void edAdd(edPoint_t *r, const edPoint_t *p, const edPoint_t *q)
+{
+    fe a, b, c, d, e, f, g, h, t;
+
+    feSub(a, p->Y, p->X);
+    feSub(t, q->Y, q->X);
+    feMul(a, a, t);
+    feAdd(b, p->Y, p->X);
+    feAdd(t, q->Y, q->X);
+    feMul(b, b, t);
+    feFromBytes(t, edD2);
+    feMul(c, p->T, q->T);
+    feMul(c, c, t);
+    feMul(d, p->Z, q->Z);
+    feAdd(d, d, d);
+    feSub(e, b, a);
+    feSub(f, d, c);
+    feAdd(g, d, c);
+    feAdd(h, b, a);
+    feMul(r->X, e, f);
+    feMul(r->Y, g, h);
+    feMul(r->T, e, h);
+    feMul(r->Z, f, g);
+}
+
+/* r = 2p, dbl-2008-hwcd with a = -1. r may be p. */
+static void edDouble(edPoint_t *r, const edPoint_t *p)
+{
+    fe a, b, c, e, f, g, h, t;
+
+    feSqr(a, p->X);
+    feSqr(b, p->Y);
+    feSqr(c, p->Z);
+    feAdd(c, c, c);
+    feCarry(c);
+    feAdd(t, a, b);
+    feCarry(t);
+    feNeg(h, t);                                /* -(A + B) */
+    feAdd(e, p->X, p->Y);
+    feSqr(e, e);
+    feSub(e, e, t);                             /* (X + Y)^2 - A - B */
+    feSub(g, b, a);
+    feSub(f, g, c);
+    feMul(r->X, e, f);
+    feMul(r->Y, g, h);
+    feMul(r->T, e, h);
+    feMul(r->Z, f, g);
+}
+
+static void edNeg(edPoint_t *r, const edPoint_t *p)
+{
+    feNeg(r->X, p->X);
+    feCarry(r->X);
+    feCopy(r->Y, p->Y);
+    feCopy(r->Z, p->Z);
+    feNeg(r->T, p->T);
+    feCarry(r->T);
+}
+
+static void edBase(edPoint_t *r)
+{
+    feFromBytes(r->X, edBaseX);
+    feFromBytes(r->Y, edBaseY);
+    feSet(r->Z, 1);
+    feMul(r->T, r->X, r->Y);
+}
+
+/* table[i] = i * p for i = 0 to 15 */
+static void edTable(edPoint_t table[16], const edPoint_t *p)
+{
+    int i;
+
+    edIdentity(&table[0]);
+    memcpy(&table[1], p, sizeof(edPoint_t));
+    for (i = 2; i < 16; i += 2)
+    {
+        edDouble(&table[i], &table[i / 2]);
+        edAdd(&table[i + 1], &table[i], p);
+    }
+}
+
+/* Nibble i of a 32 byte little endian scalar */
+static unsigned int scNibble(const unsigned char s[32], int i)
+{
+    return (s[i >> 1] >> ((i & 1) * 4)) & 0xF;
+}
+
+/*
+    r = s * p in constant time, with 4 bit fixed windows. Every table entry
+    is read for every window, the wanted one is kept with a mask.
+ */
+static void edScalarMult(edPoint_t *r, const unsigned char s[32],
+    const edPoint_t *p)
+{
+    edPoint_t table[16], q;
+    unsigned int n, j, eq;
+    int i;
+
+    edTable(table, p);
+    edIdentity(r);
+    for (i = 63; i >= 0; i--)
+    {
+        edDouble(r, r);
+        edDouble(r, r);
+        edDouble(r, r);
+        edDouble(r, r);
+        n = scNibble(s, i);
+        edIdentity(&q);
+        for (j = 0; j < 16; j++)
+        {
+            /* eq is 1 if j == n */
+            eq = ((j ^ n) - 1) >> 31;
+            feCmov(q.X, table[j].X, eq);
+            feCmov(q.Y, table[j].Y, eq);
+            feCmov(q.Z, table[j].Z, eq);
+            feCmov(q.T, table[j].T, eq);
+        }
+        edAdd(r, r, &q);
+    }
+    memset_s(table, sizeof(table), 0x0, sizeof(table));
+    memset_s(&q, sizeof(q), 0x0, sizeof(q));
+}
+
+/*
+    r = a * p + b * q for public scalars, as needed by verification.
+    Both multiplications share the doublings.
+ */
+static void edDoubleScalarMultVartime(edPoint_t *r, const unsigned char a[32],
+    const edPoint_t *p, const unsigned char b[32], const edPoint_t *q)
+{
+    edPoint_t tp[16], tq[16];
+    unsigned int n;
+    int i;
+
+    edTable(tp, p);
+    edTable(tq, q);
+    edIdentity(r);
+    for (i = 63; i >= 0; i--)
+    {
+        edDouble(r, r);
+        edDouble(r, r);
+        edDouble(r, r);
+        edDouble(r, r);
+        if ((n = scNibble(a, i)) != 0)
+        {
+            edAdd(r, r, &tp[n]);
+        }
+        if ((n = scNibble(b, i)) != 0)
+        {
+            edAdd(r, r, &tq[n]);
+        }
+    }
+}
+
+static void edToBytes(unsigned char s[32], const edPoint_t *p)
+{
+    fe zi, x, y;
+
+    feInvert(zi, p->Z);
+    feMul(x, p->X, zi);
+    feMul(y, p->Y, zi);
+    feToBytes(s, y);
+    s[31] ^= feIsNegative(x) << 7;
+}
+
+/*
+    Decode a point as in RFC 8032 section 5.1.3. Non canonical encodings
+    of y and points not on the curve are rejected.
+ */
+static int32_t edFromBytes(edPoint_t *r, const unsigned char s[32])
+{
+    unsigned char t[32];
+    fe one, u, v, v3, vx2, x;
+    unsigned char nz;
+    int sign, i;
+
+    sign = s[31] >> 7;
+    feFromBytes(r->Y, s);
+    feToBytes(t, r->Y);
+    t[31] |= sign << 7;
+    if (memcmp(t, s, 32) != 0)
+    {
+        return PS_FAILURE;
+    }
+
+    /* x^2 = (y^2 - 1) / (d y^2 + 1) = u / v */
+    feSet(one, 1);
+    feSqr(u, r->Y);
+    feFromBytes(v, edD);
+    feMul(v, v, u);
+    feAdd(v, v, one);
+    feSub(u, u, one);
+    feCarry(u);
+
+    /* x = u v^3 (u v^7)^((p - 5) / 8) */
+    feSqr(v3, v);
+    feMul(v3, v3, v);
+    feSqr(x, v3);
+    feMul(x, x, v);
+    feMul(x, x, u);
+    fePow22523(x, x);
+    feMul(x, x, v3);
+    feMul(x, x, u);
+
+    feSqr(vx2, x);
+    feMul(vx2, vx2, v);
+    if (!feEqual(vx2, u))
+    {
+        feNeg(v3, u);
+        if (!feEqual(vx2, v3))
+        {
+            return PS_FAILURE;
+        }
+        feFromBytes(v3, edSqrtM1);
+        feMul(x, x, v3);
+    }
+    feToBytes(t, x);
+    nz = 0;
+    for (i = 0; i < 32; i++)
+    {
+        nz |= t[i];
+    }
+    if (sign && nz == 0)
+    {
+        /* x = 0 has no negative form */
+        return PS_FAILURE;
+    }
+    if ((t[0] & 1) != sign)
+    {
+        feNeg(x, x);
+        feCarry(x);
+    }
+    feCopy(r->X, x);
+    feSet(r->Z, 1);
+    feMul(r->T, r->X, r->Y);
+    return PS_SUCCESS;
+}
+
+/******************************************************************************/
+/*
+    Arithmetic modulo the group order L. Scalars are 32 little endian
+    bytes, intermediate values are 64 signed digits of about 8 bits.
+ */
+static void scModL(unsigned char r[32], int64_t x[64])
+{
+    int64_t carry;
+    int i, j;
+
+    for (i = 63; i >= 32; i--)
+    {
+        carry = 0;
+        for (j = i - 32; j < i - 12; j++)
+        {
+            x[j] += carry - 16 * x[i] * edL[j - (i - 32)];
+            carry = (x[j] + 128) >> 8;
+            x[j] -= carry * 256;
+        }
+        x[j] += carry;
+        x[i] = 0;
+    }
+    carry = 0;
+    for (j = 0; j < 32; j++)
+    {
+        x[j] += carry - (x[31] >> 4) * edL[j];
+        carry = x[j] >> 8;
+        x[j] &= 255;
+    }
+    for (j = 0; j < 32; j++)
+    {
+        x[j] -= carry * edL[j];
+    }
+    for (i = 0; i < 32; i++)
+    {
+        x[i + 1] += x[i] >> 8;
+        r[i] = (unsigned char) (x[i] & 255);
+    }
+}
+
+/* r = h mod L for a 64 byte hash */
+static void scReduce(unsigned char r[32], const unsigned char h[64])
+{
+    int64_t x[64];
+    int i;
+
+    for (i = 0; i < 64; i++)
+    {
+        x[i] = h[i];
+    }
+    scModL(r, x);
+    memset_s(x, sizeof(x), 0x0, sizeof(x));
+}
+
+/* r = a * b + c mod L */
+static void scMulAdd(unsigned char r[32], const unsigned char a[32],
+    const unsigned char b[32], const unsigned char c[32])
+{
+    int64_t x[64];
+    int i, j;
+
+    memset(x, 0x0, sizeof(x));
+    for (i = 0; i < 32; i++)
+    {
+        x[i] = c[i];
+    }
+    for (i = 0; i < 32; i++)
+    {
+        for (j = 0; j < 32; j++)
+        {
+            x[i + j] += (int64_t) a[i] * b[j];
+        }
+    }
+    scModL(r, x);
+    memset_s(x, sizeof(x), 0x0, sizeof(x));
+}
+
+/* True if s < L, the check against malleable signatures */
+static int scIsCanonical(const unsigned char s[32])
+{
+    int i;
+
+    for (i = 31; i >= 0; i--)
+    {
+        if (s[i] < edL[i])
+        {
+            return 1;
+        }
+        if (s[i] > edL[i])
+        {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/******************************************************************************/
+
+/* psSha512Update() takes 32 bit lengths */
+static void edHashUpdate(psSha512_t *md, const unsigned char *buf,
+    psSizeL_t len)
+{
+    uint32_t n;
+
+    while (len > 0)
+    {
+        n = len > 0x40000000 ? 0x40000000 : (uint32_t) len;
+        psSha512Update(md, buf, n);
+        buf += n;
+        len -= n;
+    }
+}
+
+/* The clamped secret scalar and the nonce prefix of a private key */
+static void edExpandKey(const unsigned char seed[ED25519_KEY_SIZE],
+    unsigned char a[32], unsigned char prefix[32])
+{
+    psSha512_t md;
+    unsigned char h[SHA512_HASH_SIZE];
+
+    psSha512PreInit(&md);
+    psSha512Init(&md);
+    psSha512Update(&md, seed, ED25519_KEY_SIZE);
+    psSha512Final(&md, h);
+    memcpy(a, h, 32);
+    a[0] &= 248;
+    a[31] &= 127;
+    a[31] |= 64;
+    memcpy(prefix, h + 32, 32);
+    memset_s(h, sizeof(h), 0x0, sizeof(h));
+}
+
+/**
+    Generate a new Ed25519 key pair.
+ */
+int32_t psEd25519GenKey(psPool_t *pool, psEd25519Key_t *key, void *usrData)
+{
+    unsigned char seed[ED25519_KEY_SIZE];
+    int32_t err;
+
+    if (psGetPrngLocked(seed, sizeof(seed), usrData) != sizeof(seed))
+    {
+        return PS_PLATFORM_FAIL;
+    }
+    err = psEd25519ImportPrivKey(key, seed);
+    memset_s(seed, sizeof(seed), 0x0, sizeof(seed));
+    return err;
+}
+
+/**
+    Load a private key from its 32 byte seed, the form stored in PKCS#8
+    (RFC 8410), and derive the public key.
+ */
+int32_t psEd25519ImportPrivKey(psEd25519Key_t *key,
+    const unsigned char seed[ED25519_KEY_SIZE])
+{
+    unsigned char a[32], prefix[32];
+    edPoint_t B, A;
+
+    edExpandKey(seed, a, prefix);
+    edBase(&B);
+    edScalarMult(&A, a, &B);
+    edToBytes(key->pub, &A);
+    memcpy(key->priv, seed, ED25519_KEY_SIZE);
+    key->type = PS_PRIVKEY;
+    memset_s(a, sizeof(a), 0x0, sizeof(a));
+    memset_s(prefix, sizeof(prefix), 0x0, sizeof(prefix));
+    memset_s(&A, sizeof(A), 0x0, sizeof(A));
+    return PS_SUCCESS;
+}
+
+/**
+    Load a 32 byte encoded public key. Fails if it is not a point on the
+    curve.
+ */
+int32_t psEd25519ImportPubKey(psEd25519Key_t *key,
+    const unsigned char pub[ED25519_KEY_SIZE])
+{
+    edPoint_t A;
+
+    if (edFromBytes(&A, pub) < 0)
+    {
+        psTraceCrypto("Invalid Ed25519 public key\n");
+        return PS_FAILURE;
+    }
+    memset(key, 0x0, sizeof(psEd25519Key_t));
+    memcpy(key->pub, pub, ED25519_KEY_SIZE);
+    key->type = PS_PUBKEY;
+    return PS_SUCCESS;
+}
+
+void psEd25519ClearKey(psEd25519Key_t *key)
+{
+    memset_s(key, sizeof(psEd25519Key_t), 0x0, sizeof(psEd25519Key_t));
+}
+
+/**
+    Sign a message with PureEdDSA. The message is hashed twice, so it
+    is passed whole, not as a digest.
+
+    @param[in] key Private key.
+    @param[in] msg The message.
+    @param[in] msgLen Length of 'msg'.
+    @param[out] sig The 64 byte signature R || S.
+    @return PS_SUCCESS, or PS_ARG_FAIL if 'key' is not a private key.
+ */
+int32_t psEd25519Sign(const psEd25519Key_t *key,
+    const unsigned char *msg, psSizeL_t msgLen,
+    unsigned char sig[ED25519_SIG_SIZE])
+{
+    psSha512_t md;
+    unsigned char a[32], prefix[32], h[SHA512_HASH_SIZE], r[32], k[32];
+    edPoint_t B, R;
+
+    if (key->type != PS_PRIVKEY)
+    {
+        return PS_ARG_FAIL;
+    }
+    edExpandKey(key->priv, a, prefix);
+
+    /* r = SHA-512(prefix || M), R = rB */
+    psSha512PreInit(&md);
+    psSha512Init(&md);
+    psSha512Update(&md, prefix, sizeof(prefix));
+    edHashUpdate(&md, msg, msgLen);
+    psSha512Final(&md, h);
+    scReduce(r, h);
+    edBase(&B);
+    edScalarMult(&R, r, &B);
+    edToBytes(sig, &R);
+
+    /* S = r + SHA-512(R || A || M) * a */
+    psSha512Init(&md);
+    psSha512Update(&md, sig, 32);
+    psSha512Update(&md, key->pub, ED25519_KEY_SIZE);
+    edHashUpdate(&md, msg, msgLen);
+    psSha512Final(&md, h);
+    scReduce(k, h);
+    scMulAdd(sig + 32, k, a, r);
+
+    memset_s(a, sizeof(a), 0x0, sizeof(a));
+    memset_s(prefix, sizeof(prefix), 0x0, sizeof(prefix));
+    memset_s(r, sizeof(r), 0x0, sizeof(r));
+    memset_s(&R, sizeof(R), 0x0, sizeof(R));
+    return PS_SUCCESS;
+}
+
+/**
+    Verify a PureEdDSA signature.
+
+    @param[in] key Public key, a private key works too.
+    @param[in] msg The signed message.
+    @param[in] msgLen Length of 'msg'.
+    @param[in] sig The signature.
+    @param[in] sigLen Length of 'sig', must be 64.
+    @param[out] status 1 if the signature is valid, -1 if not.
+    @return < 0 only if 'sig' has the wrong length. A bad signature
+        returns PS_SUCCESS with 'status' -1.
+ */
+int32_t psEd25519Verify(const psEd25519Key_t *key,
+    const unsigned char *msg, psSizeL_t msgLen,
+    const unsigned char *sig, psSize_t sigLen, int32_t *status)
+{
+    psSha512_t md;
+    unsigned char h[SHA512_HASH_SIZE], k[32], check[32];
+    edPoint_t A, B, R;
+
+    *status = -1;
+    if (sigLen != ED25519_SIG_SIZE)
+    {
+        return PS_ARG_FAIL;
+    }
+    if (!scIsCanonical(sig + 32) || edFromBytes(&A, key->pub) < 0)
+    {
+        return PS_SUCCESS;
+    }
+
+    /* k = SHA-512(R || A || M) */
+    psSha512PreInit(&md);
+    psSha512Init(&md);
+    psSha512Update(&md, sig, 32);
+    psSha512Update(&md, key->pub, ED25519_KEY_SIZE);
+    edHashUpdate(&md, msg, msgLen);
+    psSha512Final(&md, h);
+    scReduce(k, h);
+
+    /* Check that SB - kA encodes to R */
+    edNeg(&A, &A);
+    edBase(&B);
+    edDoubleScalarMultVartime(&R, sig + 32, &B, k, &A);
+    edToBytes(check, &R);
+    if (memcmpct(check, sig, 32) == 0)
+    {
+        *status = 1;
+    }
+    return PS_SUCCESS;
+}
+# endif /* USE_ED25519 */
+#endif /* USE_MATRIX_ECC && (USE_X25519 || USE_ED25519) */
+
+/******************************************************************************/
@@ -51,6 +51,31 @@ psSize_t psDhSize(const psDhKey_t *key)
     return key->size;
 }
 
+/**
+    Copy a DH key pair.
+    @param pool Memory pool for the copy
+    @param[out] to Uninitialized key to receive the copy. Free with
+        psDhClearKey().
+    @param[in] from Key to copy.
+ */
+int32_t psDhCopyKey(psPool_t *pool, psDhKey_t *to, const psDhKey_t *from)
+{
+    int32_t rc;
+
+    if ((rc = pstm_init_copy(pool, &to->priv, &from->priv, 0)) != PSTM_OKAY)
+    {
+        return rc;
+    }
+    if ((rc = pstm_init_copy(pool, &to->pub, &from->pub, 0)) != PSTM_OKAY)
+    {
+        pstm_clear(&to->priv);
+        return rc;
+    }
+    to->size = from->size;
+    to->type = from->type;
+    return PS_SUCCESS;
+}
+
 /******************************************************************************/
 /**
     Parse ASN.1 encoded DH parameters.
@@ -82,6 +107,9 @@ int32_t psPkcs3ParseDhParamBin(psPool_t *pool, const unsigned char *dhBin,
     }
     end = dhBin + dhBinLen;
     c = dhBin;
+# ifdef USE_DH_PRECOMP
+    params->gComb = NULL;
+# endif
 
     if (getAsnSequence(&c, (uint16_t) (end - c), &baseLen) < 0)
     {
@@ -132,6 +160,14 @@ void psPkcs3ClearDhParams(psDhParams_t *params)
     {
         return;
     }
+# ifdef USE_DH_PRECOMP
+    if (params->gComb)
+    {
+        pstm_fbctx_clear(params->gComb);
+        psFree(params->gComb, params->pool);
+        params->gComb = NULL;
+    }
+# endif
     pstm_clear(&params->g);
     pstm_clear(&params->p);
     params->size = 0;
@@ -322,31 +358,11 @@ error:
 }
 
 /******************************************************************************/
-/**
-    Does the actual key generation given p and g.
-
+/*
+    Size in bytes of the private exponent for a prime of 'keysize' bytes.
  */
-# define DH_KEYGEN_SANITY    256
-int32_t psDhGenKeyInts(psPool_t *pool, psSize_t keysize,
-    const pstm_int *p, const pstm_int *g,
-    psDhKey_t *key, void *usrData)
+static psSize_t dhPrivSize(psSize_t keysize)
 {
-    unsigned char *buf = NULL;
-    int32_t err, i;
-    psSize_t privsize;
-
-    if (key == NULL)
-    {
-        return PS_ARG_FAIL;
-    }
-
-    /* Detect parameters with too small g. */
-    if (pstm_count_bits(g) < 2)
-    {
-        return PS_ARG_FAIL;
-    }
-
-    privsize = keysize;
 # ifndef USE_LARGE_DH_PRIVATE_KEYS
 /*
     The mapping between DH prime field size and key size follows
@@ -356,25 +372,54 @@ int32_t psDhGenKeyInts(psPool_t *pool, psSize_t keysize,
  */
     if (keysize >= 160 / 8 && keysize <= 1024 / 8)
     {
-        privsize = 160 / 8;
+        return 160 / 8;
     }
     else if (keysize > 1024 / 8 && keysize <= 2048 / 8)
     {
-        privsize = 224 / 8;
+        return 224 / 8;
     }
     else if (keysize > 2048 / 8 && keysize <= 3072 / 8)
     {
-        privsize = 256 / 8;
+        return 256 / 8;
     }
     else if (keysize > 3072 / 8 && keysize <= 7680 / 8)
     {
-        privsize = 384 / 8;
+        return 384 / 8;
     }
     else if (keysize > 7680 / 8 && keysize <= 15360 / 8)
     {
-        privsize = 256 / 8;
+        return 256 / 8;
     }
 # endif /* USE_LARGE_DH_PRIVATE_KEYS */
+    return keysize;
+}
+
+/******************************************************************************/
+/**
+    Does the actual key generation given p and g.
+
+ */
+# define DH_KEYGEN_SANITY    256
+static int32_t dhGenKey(psPool_t *pool, psSize_t keysize,
+    const pstm_int *p, const pstm_int *g, const pstm_fbctx *gComb,
+    psDhKey_t *key, void *usrData)
+{
+    unsigned char *buf = NULL;
+    int32_t err, i;
+    psSize_t privsize;
+
+    if (key == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+
+    /* Detect parameters with too small g. */
+    if (pstm_count_bits(g) < 2)
+    {
+        return PS_ARG_FAIL;
+    }
+
+    privsize = dhPrivSize(keysize);
 
     key->size = keysize;
 
@@ -422,8 +467,15 @@ int32_t psDhGenKeyInts(psPool_t *pool, psSize_t keysize,
         pstm_clear(&key->priv);
         goto error;
     }
-    if ((err = pstm_exptmod(pool, g, &key->priv, p, &key->pub)) !=
-        PS_SUCCESS)
+    if (gComb != NULL && privsize * 8 <= gComb->maxBits)
+    {
+        err = pstm_exptmod_fixed(pool, gComb, &key->priv, &key->pub);
+    }
+    else
+    {
+        err = pstm_exptmod(pool, g, &key->priv, p, &key->pub);
+    }
+    if (err != PS_SUCCESS)
     {
         goto error;
     }
@@ -442,6 +494,234 @@ done:
     return err;
 }
 
+int32_t psDhGenKeyInts(psPool_t *pool, psSize_t keysize,
+    const pstm_int *p, const pstm_int *g,
+    psDhKey_t *key, void *usrData)
+{
+    return dhGenKey(pool, keysize, p, g, NULL, key, usrData);
+}
+
+/**
+    Generate a DH key with loaded parameters, using the comb of the
+    generator when the parameters have one.
+ */
+int32_t psDhGenKeyParams(psPool_t *pool, const psDhParams_t *params,
+    psDhKey_t *key, void *usrData)
+{
+# ifdef USE_DH_PRECOMP
+    return dhGenKey(pool, params->size, &params->p, &params->g,
+        params->gComb, key, usrData);
+# else
+    return dhGenKey(pool, params->size, &params->p, &params->g, NULL,
+        key, usrData);
+# endif
+}
+
+# ifdef USE_DH_PRECOMP
+/******************************************************************************/
+/**
+    Compute the fixed-base comb of the generator of 'params', so that
+    psDhGenKeyParams() avoids a full exponentiation. The comb covers the
+    private key size psDhGenKeyParams() uses for the prime.
+
+    @param pool Memory pool
+    @param[in,out] params Loaded DH parameters. The comb is freed with them.
+    @return < 0 on error. The parameters remain usable without a comb.
+ */
+int32_t psDhPrecomputeParams(psPool_t *pool, psDhParams_t *params)
+{
+    pstm_fbctx *fb;
+    int32_t rc;
+
+    if (params->gComb != NULL)
+    {
+        return PS_SUCCESS;
+    }
+    if ((fb = psMalloc(pool, sizeof(pstm_fbctx))) == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    if ((rc = pstm_fbctx_init(pool, fb, &params->g, &params->p,
+             dhPrivSize(params->size) * 8)) != PSTM_OKAY)
+    {
+        psFree(fb, pool);
+        return rc;
+    }
+    params->gComb = fb;
+    return PS_SUCCESS;
+}
+# endif /* USE_DH_PRECOMP */
+
+/******************************************************************************/
+/*
+    The safe primes of the RFC 7919 groups. The generator is 2 for all.
+ */
+static const unsigned char ffdhe2048_p[] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xAD, 0xF8, 0x54, 0x58,
+    0xA2, 0xBB, 0x4A, 0x9A, 0xAF, 0xDC, 0x56, 0x20, 0x27, 0x3D, 0x3C, 0xF1,
+    0xD8, 0xB9, 0xC5, 0x83, 0xCE, 0x2D, 0x36, 0x95, 0xA9, 0xE1, 0x36, 0x41,
+    0x14, 0x64, 0x33, 0xFB, 0xCC, 0x93, 0x9D, 0xCE, 0x24, 0x9B, 0x3E, 0xF9,
+    0x7D, 0x2F, 0xE3, 0x63, 0x63, 0x0C, 0x75, 0xD8, 0xF6, 0x81, 0xB2, 0x02,
+    0xAE, 0xC4, 0x61, 0x7A, 0xD3, 0xDF, 0x1E, 0xD5, 0xD5, 0xFD, 0x65, 0x61,
+    0x24, 0x33, 0xF5, 0x1F, 0x5F, 0x06, 0x6E, 0xD0, 0x85, 0x63, 0x65, 0x55,
+    0x3D, 0xED, 0x1A, 0xF3, 0xB5, 0x57, 0x13, 0x5E, 0x7F, 0x57, 0xC9, 0x35,
+    0x98, 0x4F, 0x0C, 0x70, 0xE0, 0xE6, 0x8B, 0x77, 0xE2, 0xA6, 0x89, 0xDA,
+    0xF3, 0xEF, 0xE8, 0x72, 0x1D, 0xF1, 0x58, 0xA1, 0x36, 0xAD, 0xE7, 0x35,
+    0x30, 0xAC, 0xCA, 0x4F, 0x48, 0x3A, 0x79, 0x7A, 0xBC, 0x0A, 0xB1, 0x82,
+    0xB3, 0x24, 0xFB, 0x61, 0xD1, 0x08, 0xA9, 0x4B, 0xB2, 0xC8, 0xE3, 0xFB,
+    0xB9, 0x6A, 0xDA, 0xB7, 0x60, 0xD7, 0xF4, 0x68, 0x1D, 0x4F, 0x42, 0xA3,
+    0xDE, 0x39, 0x4D, 0xF4, 0xAE, 0x56, 0xED, 0xE7, 0x63, 0x72, 0xBB, 0x19,
+    0x0B, 0x07, 0xA7, 0xC8, 0xEE, 0x0A, 0x6D, 0x70, 0x9E, 0x02, 0xFC, 0xE1,
+    0xCD, 0xF7, 0xE2, 0xEC, 0xC0, 0x34, 0x04, 0xCD, 0x28, 0x34, 0x2F, 0x61,
+    0x91, 0x72, 0xFE, 0x9C, 0xE9, 0x85, 0x83, 0xFF, 0x8E, 0x4F, 0x12, 0x32,
+    0xEE, 0xF2, 0x81, 0x83, 0xC3, 0xFE, 0x3B, 0x1B, 0x4C, 0x6F, 0xAD, 0x73,
+    0x3B, 0xB5, 0xFC, 0xBC, 0x2E, 0xC2, 0x20, 0x05, 0xC5, 0x8E, 0xF1, 0x83,
+    0x7D, 0x16, 0x83, 0xB2, 0xC6, 0xF3, 0x4A, 0x26, 0xC1, 0xB2, 0xEF, 0xFA,
+    0x88, 0x6B, 0x42, 0x38, 0x61, 0x28, 0x5C, 0x97, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF
+};
+
+static const unsigned char ffdhe3072_p[] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xAD, 0xF8, 0x54, 0x58,
+    0xA2, 0xBB, 0x4A, 0x9A, 0xAF, 0xDC, 0x56, 0x20, 0x27, 0x3D, 0x3C, 0xF1,
+    0xD8, 0xB9, 0xC5, 0x83, 0xCE, 0x2D, 0x36, 0x95, 0xA9, 0xE1, 0x36, 0x41,
+    0x14, 0x64, 0x33, 0xFB, 0xCC, 0x93, 0x9D, 0xCE, 0x24, 0x9B, 0x3E, 0xF9,
+    0x7D, 0x2F, 0xE3, 0x63, 0x63, 0x0C, 0x75, 0xD8, 0xF6, 0x81, 0xB2, 0x02,
+    0xAE, 0xC4, 0x61, 0x7A, 0xD3, 0xDF, 0x1E, 0xD5, 0xD5, 0xFD, 0x65, 0x61,
+    0x24, 0x33, 0xF5, 0x1F, 0x5F, 0x06, 0x6E, 0xD0, 0x85, 0x63, 0x65, 0x55,
+    0x3D, 0xED, 0x1A, 0xF3, 0xB5, 0x57, 0x13, 0x5E, 0x7F, 0x57, 0xC9, 0x35,
+    0x98, 0x4F, 0x0C, 0x70, 0xE0, 0xE6, 0x8B, 0x77, 0xE2, 0xA6, 0x89, 0xDA,
+    0xF3, 0xEF, 0xE8, 0x72, 0x1D, 0xF1, 0x58, 0xA1, 0x36, 0xAD, 0xE7, 0x35,
+    0x30, 0xAC, 0xCA, 0x4F, 0x48, 0x3A, 0x79, 0x7A, 0xBC, 0x0A, 0xB1, 0x82,
+    0xB3, 0x24, 0xFB, 0x61, 0xD1, 0x08, 0xA9, 0x4B, 0xB2, 0xC8, 0xE3, 0xFB,
+    0xB9, 0x6A, 0xDA, 0xB7, 0x60, 0xD7, 0xF4, 0x68, 0x1D, 0x4F, 0x42, 0xA3,
+    0xDE, 0x39, 0x4D, 0xF4, 0xAE, 0x56, 0xED, 0xE7, 0x63, 0x72, 0xBB, 0x19,
+    0x0B, 0x07, 0xA7, 0xC8, 0xEE, 0x0A, 0x6D, 0x70, 0x9E, 0x02, 0xFC, 0xE1,
+    0xCD, 0xF7, 0xE2, 0xEC, 0xC0, 0x34, 0x04, 0xCD, 0x28, 0x34, 0x2F, 0x61,
+    0x91, 0x72, 0xFE, 0x9C, 0xE9, 0x85, 0x83, 0xFF, 0x8E, 0x4F, 0x12, 0x32,
+    0xEE, 0xF2, 0x81, 0x83, 0xC3, 0xFE, 0x3B, 0x1B, 0x4C, 0x6F, 0xAD, 0x73,
+    0x3B, 0xB5, 0xFC, 0xBC, 0x2E, 0xC2, 0x20, 0x05, 0xC5, 0x8E, 0xF1, 0x83,
+    0x7D, 0x16, 0x83, 0xB2, 0xC6, 0xF3, 0x4A, 0x26, 0xC1, 0xB2, 0xEF, 0xFA,
+    0x88, 0x6B, 0x42, 0x38, 0x61, 0x1F, 0xCF, 0xDC, 0xDE, 0x35, 0x5B, 0x3B,
+    0x65, 0x19, 0x03, 0x5B, 0xBC, 0x34, 0xF4, 0xDE, 0xF9, 0x9C, 0x02, 0x38,
+    0x61, 0xB4, 0x6F, 0xC9, 0xD6, 0xE6, 0xC9, 0x07, 0x7A, 0xD9, 0x1D, 0x26,
+    0x91, 0xF7, 0xF7, 0xEE, 0x59, 0x8C, 0xB0, 0xFA, 0xC1, 0x86, 0xD9, 0x1C,
+    0xAE, 0xFE, 0x13, 0x09, 0x85, 0x13, 0x92, 0x70, 0xB4, 0x13, 0x0C, 0x93,
+    0xBC, 0x43, 0x79, 0x44, 0xF4, 0xFD, 0x44, 0x52, 0xE2, 0xD7, 0x4D, 0xD3,
+    0x64, 0xF2, 0xE2, 0x1E, 0x71, 0xF5, 0x4B, 0xFF, 0x5C, 0xAE, 0x82, 0xAB,
+    0x9C, 0x9D, 0xF6, 0x9E, 0xE8, 0x6D, 0x2B, 0xC5, 0x22, 0x36, 0x3A, 0x0D,
+    0xAB, 0xC5, 0x21, 0x97, 0x9B, 0x0D, 0xEA, 0xDA, 0x1D, 0xBF, 0x9A, 0x42,
+    0xD5, 0xC4, 0x48, 0x4E, 0x0A, 0xBC, 0xD0, 0x6B, 0xFA, 0x53, 0xDD, 0xEF,
+    0x3C, 0x1B, 0x20, 0xEE, 0x3F, 0xD5, 0x9D, 0x7C, 0x25, 0xE4, 0x1D, 0x2B,
+    0x66, 0xC6, 0x2E, 0x37, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+static const unsigned char ffdhe4096_p[] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xAD, 0xF8, 0x54, 0x58,
+    0xA2, 0xBB, 0x4A, 0x9A, 0xAF, 0xDC, 0x56, 0x20, 0x27, 0x3D, 0x3C, 0xF1,
+    0xD8, 0xB9, 0xC5, 0x83, 0xCE, 0x2D, 0x36, 0x95, 0xA9, 0xE1, 0x36, 0x41,
+    0x14, 0x64, 0x33, 0xFB, 0xCC, 0x93, 0x9D, 0xCE, 0x24, 0x9B, 0x3E, 0xF9,
+    0x7D, 0x2F, 0xE3, 0x63, 0x63, 0x0C, 0x75, 0xD8, 0xF6, 0x81, 0xB2, 0x02,
+    0xAE, 0xC4, 0x61, 0x7A, 0xD3, 0xDF, 0x1E, 0xD5, 0xD5, 0xFD, 0x65, 0x61,
+    0x24, 0x33, 0xF5, 0x1F, 0x5F, 0x06, 0x6E, 0xD0, 0x85, 0x63, 0x65, 0x55,
+    0x3D, 0xED, 0x1A, 0xF3, 0xB5, 0x57, 0x13, 0x5E, 0x7F, 0x57, 0xC9, 0x35,
+    0x98, 0x4F, 0x0C, 0x70, 0xE0, 0xE6, 0x8B, 0x77, 0xE2, 0xA6, 0x89, 0xDA,
+    0xF3, 0xEF, 0xE8, 0x72, 0x1D, 0xF1, 0x58, 0xA1, 0x36, 0xAD, 0xE7, 0x35,
+    0x30, 0xAC, 0xCA, 0x4F, 0x48, 0x3A, 0x79, 0x7A, 0xBC, 0x0A, 0xB1, 0x82,
+    0xB3, 0x24, 0xFB, 0x61, 0xD1, 0x08, 0xA9, 0x4B, 0xB2, 0xC8, 0xE3, 0xFB,
+    0xB9, 0x6A, 0xDA, 0xB7, 0x60, 0xD7, 0xF4, 0x68, 0x1D, 0x4F, 0x42, 0xA3,
+    0xDE, 0x39, 0x4D, 0xF4, 0xAE, 0x56, 0xED, 0xE7, 0x63, 0x72, 0xBB, 0x19,
+    0x0B, 0x07, 0xA7, 0xC8, 0xEE, 0x0A, 0x6D, 0x70, 0x9E, 0x02, 0xFC, 0xE1,
+    0xCD, 0xF7, 0xE2, 0xEC, 0xC0, 0x34, 0x04, 0xCD, 0x28, 0x34, 0x2F, 0x61,
+    0x91, 0x72, 0xFE, 0x9C, 0xE9, 0x85, 0x83, 0xFF, 0x8E, 0x4F, 0x12, 0x32,
+    0xEE, 0xF2, 0x81, 0x83, 0xC3, 0xFE, 0x3B, 0x1B, 0x4C, 0x6F, 0xAD, 0x73,
+    0x3B, 0xB5, 0xFC, 0xBC, 0x2E, 0xC2, 0x20, 0x05, 0xC5, 0x8E, 0xF1, 0x83,
+    0x7D, 0x16, 0x83, 0xB2, 0xC6, 0xF3, 0x4A, 0x26, 0xC1, 0xB2, 0xEF, 0xFA,
+    0x88, 0x6B, 0x42, 0x38, 0x61, 0x1F, 0xCF, 0xDC, 0xDE, 0x35, 0x5B, 0x3B,
+    0x65, 0x19, 0x03, 0x5B, 0xBC, 0x34, 0xF4, 0xDE, 0xF9, 0x9C, 0x02, 0x38,
+    0x61, 0xB4, 0x6F, 0xC9, 0xD6, 0xE6, 0xC9, 0x07, 0x7A, 0xD9, 0x1D, 0x26,
+    0x91, 0xF7, 0xF7, 0xEE, 0x59, 0x8C, 0xB0, 0xFA, 0xC1, 0x86, 0xD9, 0x1C,
+    0xAE, 0xFE, 0x13, 0x09, 0x85, 0x13, 0x92, 0x70, 0xB4, 0x13, 0x0C, 0x93,
+    0xBC, 0x43, 0x79, 0x44, 0xF4, 0xFD, 0x44, 0x52, 0xE2, 0xD7, 0x4D, 0xD3,
+    0x64, 0xF2, 0xE2, 0x1E, 0x71, 0xF5, 0x4B, 0xFF, 0x5C, 0xAE, 0x82, 0xAB,
+    0x9C, 0x9D, 0xF6, 0x9E, 0xE8, 0x6D, 0x2B, 0xC5, 0x22, 0x36, 0x3A, 0x0D,
+    0xAB, 0xC5, 0x21, 0x97, 0x9B, 0x0D, 0xEA, 0xDA, 0x1D, 0xBF, 0x9A, 0x42,
+    0xD5, 0xC4, 0x48, 0x4E, 0x0A, 0xBC, 0xD0, 0x6B, 0xFA, 0x53, 0xDD, 0xEF,
+    0x3C, 0x1B, 0x20, 0xEE, 0x3F, 0xD5, 0x9D, 0x7C, 0x25, 0xE4, 0x1D, 0x2B,
+    0x66, 0x9E, 0x1E, 0xF1, 0x6E, 0x6F, 0x52, 0xC3, 0x16, 0x4D, 0xF4, 0xFB,
+    0x79, 0x30, 0xE9, 0xE4, 0xE5, 0x88, 0x57, 0xB6, 0xAC, 0x7D, 0x5F, 0x42,
+    0xD6, 0x9F, 0x6D, 0x18, 0x77, 0x63, 0xCF, 0x1D, 0x55, 0x03, 0x40, 0x04,
+    0x87, 0xF5, 0x5B, 0xA5, 0x7E, 0x31, 0xCC, 0x7A, 0x71, 0x35, 0xC8, 0x86,
+    0xEF, 0xB4, 0x31, 0x8A, 0xED, 0x6A, 0x1E, 0x01, 0x2D, 0x9E, 0x68, 0x32,
+    0xA9, 0x07, 0x60, 0x0A, 0x91, 0x81, 0x30, 0xC4, 0x6D, 0xC7, 0x78, 0xF9,
+    0x71, 0xAD, 0x00, 0x38, 0x09, 0x29, 0x99, 0xA3, 0x33, 0xCB, 0x8B, 0x7A,
+    0x1A, 0x1D, 0xB9, 0x3D, 0x71, 0x40, 0x00, 0x3C, 0x2A, 0x4E, 0xCE, 0xA9,
+    0xF9, 0x8D, 0x0A, 0xCC, 0x0A, 0x82, 0x91, 0xCD, 0xCE, 0xC9, 0x7D, 0xCF,
+    0x8E, 0xC9, 0xB5, 0x5A, 0x7F, 0x88, 0xA4, 0x6B, 0x4D, 0xB5, 0xA8, 0x51,
+    0xF4, 0x41, 0x82, 0xE1, 0xC6, 0x8A, 0x00, 0x7E, 0x5E, 0x65, 0x5F, 0x6A,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/**
+    Load one of the RFC 7919 groups. With USE_DH_PRECOMP the comb of the
+    generator is computed too.
+
+    @param pool Memory pool
+    @param[in] group PS_DH_FFDHE2048, PS_DH_FFDHE3072 or PS_DH_FFDHE4096
+    @param[out] params Parameter structure to receive the group. Free with
+        psPkcs3ClearDhParams().
+    @return < 0 on error.
+ */
+int32_t psDhLoadNamedGroup(psPool_t *pool, uint16_t group,
+    psDhParams_t *params)
+{
+    const unsigned char *p;
+    psSize_t pLen;
+    int32_t rc;
+
+    switch (group)
+    {
+    case PS_DH_FFDHE2048:
+        p = ffdhe2048_p;
+        pLen = sizeof(ffdhe2048_p);
+        break;
+    case PS_DH_FFDHE3072:
+        p = ffdhe3072_p;
+        pLen = sizeof(ffdhe3072_p);
+        break;
+    case PS_DH_FFDHE4096:
+        p = ffdhe4096_p;
+        pLen = sizeof(ffdhe4096_p);
+        break;
+    default:
+        psTraceIntCrypto("Unsupported DH group %hu\n", group);
+        return PS_UNSUPPORTED_FAIL;
+    }
+    memset(params, 0x0, sizeof(psDhParams_t));
+    if ((rc = pstm_init_for_read_unsigned_bin(pool, &params->p, pLen))
+        != PS_SUCCESS)
+    {
+        return rc;
+    }
+    if ((rc = pstm_read_unsigned_bin(&params->p, p, pLen)) != PS_SUCCESS ||
+        (rc = pstm_init_size(pool, &params->g, 1)) != PS_SUCCESS)
+    {
+        pstm_clear(&params->p);
+        return rc;
+    }
+    pstm_set(&params->g, 2);
+    params->size = pLen;
+    params->pool = pool;
+# ifdef USE_DH_PRECOMP
+    if ((rc = psDhPrecomputeParams(pool, params)) < 0)
+    {
+        psPkcs3ClearDhParams(params);
+        return rc;
+    }
+# endif
+    return PS_SUCCESS;
+}
+
 /******************************************************************************/
 /**
     Create the DH premaster secret.
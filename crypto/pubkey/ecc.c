@@ -40,6 +40,13 @@
 
 # define ECC_BUF_SIZE    256
 
+/* Stack scratch for the point routines, enough for the largest curve */
+# ifdef PSTM_INLINE_DIGITS
+#  define ECC_PAD_STACK_DIGITS    PSTM_INLINE_DIGITS
+# else
+#  define ECC_PAD_STACK_DIGITS    1
+# endif
+
 static psEccPoint_t *eccNewPoint(psPool_t *pool, short size);
 static void eccFreePoint(psEccPoint_t *p);
 
@@ -78,9 +85,30 @@ static int32_t eccMap(psPool_t *pool, psEccPoint_t *P, const pstm_int *modulus,
         const char *order; // The order of the curve (hex)
         const char *Gx; // The x co-ordinate of the base point on the curve (hex)
         const char *Gy; // The y co-ordinate of the base point on the curve (hex)
+        uint8_t     type; // PS_ECC_CURVE_*, zero (Weierstrass) unless set
     } psEccCurve_t;
  */
 const static psEccCurve_t eccCurves[] = {
+# ifdef USE_X25519
+    /* Curve25519 in Montgomery form, for key agreement only. It is listed
+       first so that it is preferred in the TLS supported groups. A and B
+       are the Montgomery coefficients, the type keeps the Weierstrass code
+       away from them: only the X25519 functions in curve25519.c use it. */
+    {
+        32,
+        IANA_X25519,
+        0,   /* isOptimized */
+        0,   /* No OID, X25519 keys are not used in certificates */
+        "x25519",
+        "7FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFED",
+        "0000000000000000000000000000000000000000000000000000000000076D06",
+        "0000000000000000000000000000000000000000000000000000000000000001",
+        "1000000000000000000000000000000014DEF9DEA2F79CD65812631A5CF5D3ED",
+        "0000000000000000000000000000000000000000000000000000000000000009",
+        "20AE19A1B8A086B4E01EDD2C7748D14C923D4D7E6D7C61B229E9C5A27ECED3D9",
+        PS_ECC_CURVE_MONTGOMERY
+    },
+# endif
 # ifdef USE_SECP521R1
     {
         66,
@@ -483,6 +511,7 @@ int32_t psEccGenKey(psPool_t *pool, psEccKey_t *key, const psEccCurve_t *curve,
 {
     int32_t err;
     psSize_t keysize, slen;
+    uint16_t orderBits;
     psEccPoint_t *base;
     pstm_int *A = NULL;
     pstm_int prime, order, rand;
@@ -495,6 +524,16 @@ int32_t psEccGenKey(psPool_t *pool, psEccKey_t *key, const psEccCurve_t *curve,
     }
 
     psEccInitKey(pool, key, curve);
+# ifdef USE_X25519
+    if (PS_ECC_IS_X25519(curve))
+    {
+        return psX25519GenKey(pool, key, usrData);
+    }
+# endif
+    if (!PS_ECC_IS_WEIERSTRASS(curve))
+    {
+        return PS_UNSUPPORTED_FAIL;
+    }
     keysize  = curve->size; /* Note, curve is non-null */
     slen = keysize * 2;
 
@@ -521,6 +560,7 @@ int32_t psEccGenKey(psPool_t *pool, psEccKey_t *key, const psEccCurve_t *curve,
         pstm_clear(&order);
         goto ERR_BUF;
     }
+    orderBits = pstm_count_bits(&order);
 
     /* make up random string */
 RETRY_RAND:
@@ -530,6 +570,12 @@ RETRY_RAND:
         pstm_clear(&order);
         goto ERR_BUF;
     }
+    /* Drop the bits above the order (e.g. 7 bits for secp521r1), otherwise
+       most candidates are rejected below. */
+    if (orderBits < keysize * 8)
+    {
+        buf[0] &= 0xFF >> (keysize * 8 - orderBits);
+    }
 
     if (pstm_init_for_read_unsigned_bin(pool, &rand, keysize) < 0)
     {
@@ -707,6 +753,12 @@ int32_t psEccParsePrivFile(psPool_t *pool, const char *fileName,
             psFree(DERout, pool);
             return rc;
         }
+        if (pubkey.type != PS_ECC)
+        {
+            psClearPubKey(&pubkey);
+            psFree(DERout, pool);
+            return PS_UNSUPPORTED_FAIL;
+        }
         rc = psEccCopyKey(key, &pubkey.key.ecc);
         psClearPubKey(&pubkey);
 #  else
@@ -904,6 +956,11 @@ int32_t getEccParamById(psCurve16_t curveId, const psEccCurve_t **curve)
     if (curveId == 0)
     {
         *curve = &eccCurves[0];
+        /* The default must be usable for ECDSA as well */
+        if (!PS_ECC_IS_WEIERSTRASS(*curve))
+        {
+            *curve = &eccCurves[1];
+        }
         return 0;
     }
 
@@ -927,7 +984,7 @@ int32_t getEccParamByOid(uint32_t oid, const psEccCurve_t **curve)
     *curve = NULL;
     while (eccCurves[i].size > 0)
     {
-        if (oid == eccCurves[i].OIDsum)
+        if (oid == eccCurves[i].OIDsum && oid != 0)
         {
             *curve = &eccCurves[i];
             return 0;
@@ -986,6 +1043,17 @@ void userSuppliedEccList(unsigned char *curveList, uint8_t *len, uint32_t curves
     const psEccCurve_t *curve;
     uint8_t listLen = 0;
 
+    if (curves & IS_X25519)
+    {
+        if (getEccParamById(IANA_X25519, &curve) == 0)
+        {
+            if (listLen < (*len - 2))
+            {
+                curveList[listLen++] = (curve->curveId & 0xFF00) >> 8;
+                curveList[listLen++] = curve->curveId & 0xFF;
+            }
+        }
+    }
     if (curves & IS_SECP521R1)
     {
         if (getEccParamById(IANA_SECP521R1, &curve) == 0)
@@ -1093,6 +1161,9 @@ uint32_t compiledInEcFlags(void)
 {
     uint32_t ecFlags = 0;
 
+# ifdef USE_X25519
+    ecFlags |= IS_X25519;
+# endif
 # ifdef USE_SECP192R1
     ecFlags |= IS_SECP192R1;
 # endif
@@ -1157,6 +1228,7 @@ static int32_t eccMulmod(psPool_t *pool, const pstm_int *k, const psEccPoint_t *
     psEccPoint_t *tG, *M[8];      /* @note large on stack */
     int32 i, j, err;
     pstm_int mu;
+    pstm_modctx pctx;
     pstm_digit mp;
     unsigned long buf;
     int32 first, bitbuf, bitcpy, bitcnt, mode, digidx;
@@ -1217,15 +1289,19 @@ static int32_t eccMulmod(psPool_t *pool, const pstm_int *k, const psEccPoint_t *
     }
     else
     {
-        if ((err = pstm_mulmod(pool, &G->x, &mu, modulus, &tG->x)) != PS_SUCCESS)
+        if ((err = pstm_modctx_init(pool, &pctx, modulus)) != PS_SUCCESS)
         {
             goto done;
         }
-        if ((err = pstm_mulmod(pool, &G->y, &mu, modulus, &tG->y)) != PS_SUCCESS)
+        if ((err = pstm_mulmod_ctx(pool, &pctx, &G->x, &mu, &tG->x))
+            == PS_SUCCESS &&
+            (err = pstm_mulmod_ctx(pool, &pctx, &G->y, &mu, &tG->y))
+            == PS_SUCCESS)
         {
-            goto done;
+            err = pstm_mulmod_ctx(pool, &pctx, &G->z, &mu, &tG->z);
         }
-        if ((err = pstm_mulmod(pool, &G->z, &mu, modulus, &tG->z)) != PS_SUCCESS)
+        pstm_modctx_clear(&pctx);
+        if (err != PS_SUCCESS)
         {
             goto done;
         }
@@ -1423,14 +1499,39 @@ done:
     return err;
 }
 
+/*
+    The point routines need (2 * modulus->used + 1) digits of scratch for
+    every call. Take it from the caller's stack buffer when it fits, and
+    only fall back to the heap for curves larger than the inline size.
+ */
+static pstm_digit *eccAllocPaD(psPool_t *pool, pstm_digit *stackBuf,
+    uint32 paDlen)
+{
+# ifdef PSTM_INLINE_DIGITS
+    if (paDlen <= ECC_PAD_STACK_DIGITS * sizeof(pstm_digit))
+    {
+        return stackBuf;
+    }
+# endif
+    return psMalloc(pool, paDlen);
+}
+
+static void eccFreePaD(psPool_t *pool, pstm_digit *paD, pstm_digit *stackBuf)
+{
+    if (paD != NULL && paD != stackBuf)
+    {
+        psFree(paD, pool);
+    }
+}
+
 static int32 eccTestPoint(psPool_t *pool, psEccPoint_t *P, pstm_int *prime,
     pstm_int *b)
 {
     pstm_int t1, t2;
-    uint32 paDlen;
-    pstm_digit *paD;
+    pstm_modctx pctx;
     int32 err;
 
+    pctx.m = NULL;
     if ((err = pstm_init(pool, &t1)) < 0)
     {
         return err;
@@ -1440,32 +1541,23 @@ static int32 eccTestPoint(psPool_t *pool, psEccPoint_t *P, pstm_int *prime,
         pstm_clear(&t1);
         return err;
     }
-    /*  Pre-allocated digit. TODO: haven't fully explored max paDlen */
-    paDlen = (prime->used * 2 + 1) * sizeof(pstm_digit);
-    if ((paD = psMalloc(pool, paDlen)) == NULL)
-    {
-        pstm_clear(&t1);
-        pstm_clear(&t2);
-        return PS_MEM_FAIL;
-    }
 
     /* compute y^2 */
-    if ((err = pstm_sqr_comba(pool, &P->y, &t1, paD, paDlen)) < 0)
+    if ((err = pstm_modctx_init(pool, &pctx, prime)) < 0)
     {
         goto error;
     }
-
-    /* compute x^3 */
-    if ((err = pstm_sqr_comba(pool, &P->x, &t2, paD, paDlen)) < 0)
+    if ((err = pstm_mulmod_ctx(pool, &pctx, &P->y, &P->y, &t1)) < 0)
     {
         goto error;
     }
-    if ((err = pstm_mod(pool, &t2, prime, &t2)) < 0)
+
+    /* compute x^3 */
+    if ((err = pstm_mulmod_ctx(pool, &pctx, &P->x, &P->x, &t2)) < 0)
     {
         goto error;
     }
-
-    if ((err = pstm_mul_comba(pool, &P->x, &t2, &t2, paD, paDlen)) < 0)
+    if ((err = pstm_mulmod_ctx(pool, &pctx, &P->x, &t2, &t2)) < 0)
     {
         goto error;
     }
@@ -1489,10 +1581,7 @@ static int32 eccTestPoint(psPool_t *pool, psEccPoint_t *P, pstm_int *prime,
     {
         goto error;
     }
-    if ((err = pstm_mod(pool, &t1, prime, &t1)) < 0)
-    {
-        goto error;
-    }
+    /* Both terms were reduced, bring the sum back into [0, prime) */
     while (pstm_cmp_d(&t1, 0) == PSTM_LT)
     {
         if ((err = pstm_add(&t1, prime, &t1)) < 0)
@@ -1520,7 +1609,7 @@ static int32 eccTestPoint(psPool_t *pool, psEccPoint_t *P, pstm_int *prime,
     }
 
 error:
-    psFree(paD, pool);
+    pstm_modctx_clear(&pctx);
     pstm_clear(&t1);
     pstm_clear(&t2);
     return err;
@@ -1551,6 +1640,21 @@ int32_t psEccX963ImportKey(psPool_t *pool,
     int32_t err;
     pstm_int prime, b;
 
+# ifdef USE_X25519
+    /* RFC 8422: X25519 public keys are the plain 32 byte u-coordinate */
+    if (PS_ECC_IS_X25519(curve))
+    {
+        if (key->type != PS_PRIVKEY)
+        {
+            psEccInitKey(pool, key, curve);
+        }
+        return psX25519ImportKey(pool, in, inlen, key);
+    }
+# endif
+    if (!PS_ECC_IS_WEIERSTRASS(curve))
+    {
+        return PS_UNSUPPORTED_FAIL;
+    }
     /* Must be odd and minimal size */
     if (inlen < ((2 * (MIN_ECC_BITS / 8)) + 1) || (inlen & 1) == 0)
     {
@@ -1660,6 +1764,23 @@ error:
     return err;
 }
 
+/******************************************************************************/
+/**
+    Size of a public key as encoded by psEccX963ExportKey().
+    @param[in] curve The curve of the key.
+    @return The encoded size in bytes.
+ */
+psSize_t psEccX963Size(const psEccCurve_t *curve)
+{
+# ifdef USE_X25519
+    if (PS_ECC_IS_X25519(curve))
+    {
+        return 32;
+    }
+# endif
+    return (curve->size * 2) + 1;
+}
+
 /******************************************************************************/
 /**
    ANSI X9.62 or X9.63 (Sec. 4.3.6) uncompressed export.
@@ -1676,6 +1797,16 @@ int32_t psEccX963ExportKey(psPool_t *pool, const psEccKey_t *key,
     unsigned long numlen;
     int32_t res;
 
+# ifdef USE_X25519
+    if (PS_ECC_IS_X25519(key->curve))
+    {
+        return psX25519ExportKey(pool, key, out, outlen);
+    }
+# endif
+    if (!PS_ECC_IS_WEIERSTRASS(key->curve))
+    {
+        return PS_UNSUPPORTED_FAIL;
+    }
     numlen = key->curve->size;
     if (*outlen < (1 + 2 * numlen))
     {
@@ -1741,6 +1872,16 @@ int32_t psEccGenSharedSecret(psPool_t *pool,
             return PS_ARG_FAIL;
         }
     }
+# ifdef USE_X25519
+    if (PS_ECC_IS_X25519(private_key->curve))
+    {
+        return psX25519SharedSecret(pool, private_key, public_key, out, outlen);
+    }
+# endif
+    if (!PS_ECC_IS_WEIERSTRASS(private_key->curve))
+    {
+        return PS_UNSUPPORTED_FAIL;
+    }
 
     /* make new point */
     result = eccNewPoint(pool, (private_key->k.used * 2) + 1);
@@ -1841,6 +1982,7 @@ static int32_t eccProjectiveAddPoint(psPool_t *pool, const psEccPoint_t *P,
 {
     pstm_int t1, t2, x, y, z;
     pstm_digit *paD;
+    pstm_digit paDbuf[ECC_PAD_STACK_DIGITS];
     int32 err;
     uint32 paDlen;
 
@@ -1899,7 +2041,7 @@ static int32_t eccProjectiveAddPoint(psPool_t *pool, const psEccPoint_t *P,
 /*
     Pre-allocated digit.  Used for mul, sqr, AND reduce*/
     paDlen = (modulus->used * 2 + 1) * sizeof(pstm_digit);
-    if ((paD = psMalloc(pool, paDlen)) == NULL)
+    if ((paD = eccAllocPaD(pool, paDbuf, paDlen)) == NULL)
     {
         err = PS_MEM_FAIL;
         goto done;
@@ -2245,10 +2387,7 @@ ERR_T2:
     pstm_clear(&t2);
 ERR_T1:
     pstm_clear(&t1);
-    if (paD)
-    {
-        psFree(paD, pool);
-    }
+    eccFreePaD(pool, paD, paDbuf);
     return err;
 }
 
@@ -2269,6 +2408,7 @@ static int32_t eccProjectiveDblPoint(psPool_t *pool, const psEccPoint_t *P,
 {
     pstm_int t1, t2;
     pstm_digit *paD;
+    pstm_digit paDbuf[ECC_PAD_STACK_DIGITS];
     uint32 paDlen;
     int32 err, initSize;
 
@@ -2312,7 +2452,7 @@ static int32_t eccProjectiveDblPoint(psPool_t *pool, const psEccPoint_t *P,
 /*
     Pre-allocated digit.  Used for mul, sqr, AND reduce*/
     paDlen = (modulus->used * 2 + 1) * sizeof(pstm_digit);
-    if ((paD = psMalloc(pool, paDlen)) == NULL)
+    if ((paD = eccAllocPaD(pool, paDbuf, paDlen)) == NULL)
     {
         err = PS_MEM_FAIL;
         goto done;
@@ -2634,10 +2774,7 @@ static int32_t eccProjectiveDblPoint(psPool_t *pool, const psEccPoint_t *P,
     err = PS_SUCCESS;
 done:
     pstm_clear_multi(&t1, &t2, NULL, NULL, NULL, NULL, NULL, NULL);
-    if (paD)
-    {
-        psFree(paD, pool);
-    }
+    eccFreePaD(pool, paD, paDbuf);
     return err;
 }
 
@@ -2722,7 +2859,9 @@ static int32_t eccMap(psPool_t *pool, psEccPoint_t *P, const pstm_int *modulus,
     const pstm_digit *mp)
 {
     pstm_int t1, t2;
+    pstm_modctx pctx;
     pstm_digit *paD;
+    pstm_digit paDbuf[ECC_PAD_STACK_DIGITS];
     int32 err;
     uint32 paDlen;
 
@@ -2738,7 +2877,7 @@ static int32_t eccMap(psPool_t *pool, psEccPoint_t *P, const pstm_int *modulus,
 
     /* Pre-allocated digit.  Used for mul, sqr, AND reduce */
     paDlen = (modulus->used * 2 + 1) * sizeof(pstm_digit);
-    if ((paD = psMalloc(pool, paDlen)) == NULL)
+    if ((paD = eccAllocPaD(pool, paDbuf, paDlen)) == NULL)
     {
         err = PS_MEM_FAIL;
         goto done;
@@ -2758,19 +2897,16 @@ static int32_t eccMap(psPool_t *pool, psEccPoint_t *P, const pstm_int *modulus,
     }
 
     /* get 1/z^2 and 1/z^3 */
-    if ((err = pstm_sqr_comba(pool, &t1, &t2, paD, paDlen)) != PS_SUCCESS)
-    {
-        goto done;
-    }
-    if ((err = pstm_mod(pool, &t2, modulus, &t2)) != PS_SUCCESS)
+    if ((err = pstm_modctx_init(pool, &pctx, modulus)) != PS_SUCCESS)
     {
         goto done;
     }
-    if ((err = pstm_mul_comba(pool, &t1, &t2, &t1, paD, paDlen)) != PS_SUCCESS)
+    if ((err = pstm_mulmod_ctx(pool, &pctx, &t1, &t1, &t2)) == PS_SUCCESS)
     {
-        goto done;
+        err = pstm_mulmod_ctx(pool, &pctx, &t1, &t2, &t1);
     }
-    if ((err = pstm_mod(pool, &t1, modulus, &t1)) != PS_SUCCESS)
+    pstm_modctx_clear(&pctx);
+    if (err != PS_SUCCESS)
     {
         goto done;
     }
@@ -2800,136 +2936,617 @@ static int32_t eccMap(psPool_t *pool, psEccPoint_t *P, const pstm_int *modulus,
     err = PS_SUCCESS;
 done:
     pstm_clear_multi(&t1, &t2, NULL, NULL, NULL, NULL, NULL, NULL);
-    if (paD)
-    {
-        psFree(paD, pool);
-    }
+    eccFreePaD(pool, paD, paDbuf);
     return err;
 }
 
+# ifdef USE_PUBKEY_PRECOMP
 /******************************************************************************/
-/**
-    Verify an ECDSA signature.
-
-    @param pool Memory pool
-    @param[in] key Public key to use for signature validation
-    @param[in] buf Data that is signed by private 'key'
-    @param[in] buflen Length in bytes of 'buf'
-    @param[in] sig Signature of 'buf' by the private key pair of 'key'
-    @param[in] siglen Length in bytes of 'sig'
-    @param[out] status Result of the signature check. 1 on success, -1 on
-        non-matching signature.
-    @param usrData Data used by some hardware crypto. Can be NULL.
-    @return < 0 on failure. Also 'status'.
+/*
+    Fixed-base comb for keys that verify many signatures, such as CA keys.
+    For a point P, spacing d and ECC_COMB_TEETH teeth, entry j of the table
+    holds the sum of 2^(b * d) * P over the bits b set in j, as affine x and
+    y in Montgomery form. k * P then costs d - 1 doublings and at most d
+    mixed additions. Each precomputation holds a table for the public key Q,
+    verification walks it together with the shared table of the base point
+    G, so that u1 * G + u2 * Q shares the doublings.
  */
-int32_t psEccDsaVerify(psPool_t *pool, const psEccKey_t *key,
-    const unsigned char *buf, psSize_t buflen,
-    const unsigned char *sig, psSize_t siglen,
-    int32_t *status, void *usrData)
-{
-    psEccPoint_t *mG, *mQ;
-    pstm_digit mp;
-    pstm_int *A = NULL;
-    pstm_int v, w, u1, u2, e, p, m, r, s;
-    const unsigned char *c, *end;
-    int32_t err, radlen;
-    psSize_t len;
+#  define ECC_COMB_TEETH      5
+#  define ECC_COMB_POINTS     ((1 << ECC_COMB_TEETH) - 1)
 
-    /* default to invalid signature */
-    *status = -1;
+/* Point 'j' of a comb table, as a read-only view with the z of 'P' */
+static void eccCombEntry(const pstm_digit *table, psSize_t digits,
+    uint16_t j, psEccPoint_t *P)
+{
+    const pstm_digit *e = table + (j - 1) * 2 * digits;
+
+    P->x.dp = (pstm_digit *) e;
+    P->y.dp = (pstm_digit *) e + digits;
+    P->x.used = P->x.alloc = P->y.used = P->y.alloc = digits;
+    P->x.sign = P->y.sign = PSTM_ZPOS;
+    pstm_clamp(&P->x);
+    pstm_clamp(&P->y);
+}
 
-    c = sig;
-    end = c + siglen;
+/* Store the affine point P (z == 1) as Montgomery x and y */
+static int32_t eccCombStore(psPool_t *pool, const pstm_modctx *pctx,
+    const pstm_int *mu, psEccPoint_t *P, pstm_digit *e, psSize_t digits)
+{
+    int32_t err;
 
-    if ((err = getAsnSequence(&c, (uint16_t) (end - c), &len)) < 0)
+    if ((err = pstm_mulmod_ctx(pool, pctx, &P->x, mu, &P->x)) != PS_SUCCESS ||
+        (err = pstm_mulmod_ctx(pool, pctx, &P->y, mu, &P->y)) != PS_SUCCESS)
     {
-        psTraceCrypto("ECDSA subject signature parse failure 1\n");
-        return err;
-    }
-    if ((err = pstm_read_asn(pool, &c, (uint16_t) (end - c), &r)) < 0)
-    {
-        psTraceCrypto("ECDSA subject signature parse failure 2\n");
         return err;
     }
-    if ((err = pstm_read_asn(pool, &c, (uint16_t) (end - c), &s)) < 0)
+    if (P->x.used > digits || P->y.used > digits)
     {
-        psTraceCrypto("ECDSA subject signature parse failure 3\n");
-        pstm_clear(&r);
-        return err;
+        return PS_LIMIT_FAIL;
     }
+    memset(e, 0x0, 2 * digits * sizeof(pstm_digit));
+    memcpy(e, P->x.dp, P->x.used * sizeof(pstm_digit));
+    memcpy(e + digits, P->y.dp, P->y.used * sizeof(pstm_digit));
+    return PS_SUCCESS;
+}
 
-    /* allocate ints */
-    radlen = key->curve->size * 2;
-    if (pstm_init_for_read_unsigned_bin(pool, &p, key->curve->size) < 0)
+/*
+    Fill 'table' with the comb of the affine point 'G'.
+ */
+static int32_t eccCombTable(psPool_t *pool, const psEccPoint_t *G,
+    pstm_digit *table, psSize_t digits, psSize_t spacing,
+    const pstm_int *modulus, const pstm_modctx *pctx, const pstm_int *mu,
+    const pstm_int *A)
+{
+    psEccPoint_t *B[ECC_COMB_TEETH], *E, view;
+    pstm_digit one;
+    pstm_digit mp;
+    uint16_t i, j, b;
+    int32_t err;
+
+    if ((err = pstm_montgomery_setup(modulus, &mp)) != PS_SUCCESS)
     {
-        pstm_clear(&s);
-        pstm_clear(&r);
-        return PS_MEM_FAIL;
+        return err;
     }
+    memset(B, 0x0, sizeof(B));
+    memset(&view, 0x0, sizeof(view));
+    one = 1;
+    view.z.dp = &one;
+    view.z.used = view.z.alloc = 1;
+    view.z.sign = PSTM_ZPOS;
     err = PS_MEM_FAIL;
-    if (pstm_init_for_read_unsigned_bin(pool, &m, key->curve->size) < 0)
-    {
-        goto LBL_P;
-    }
-    if (pstm_init_size(pool, &v, key->pubkey.x.alloc) < 0)
+    if ((E = eccNewPoint(pool, digits * 2 + 1)) == NULL)
     {
-        goto LBL_M;
+        return err;
     }
-    if (pstm_init_size(pool, &w, s.alloc) < 0)
+    for (b = 0; b < ECC_COMB_TEETH; b++)
     {
-        goto LBL_V;
+        if ((B[b] = eccNewPoint(pool, digits * 2 + 1)) == NULL)
+        {
+            goto done;
+        }
     }
-    /* Shouldn't have signed more data than the key length.  Truncate if so */
-    if (buflen > key->curve->size)
+
+    /* B[b] = 2^(b * spacing) * G, Jacobian in Montgomery form */
+    if ((err = pstm_mulmod_ctx(pool, pctx, &G->x, mu, &B[0]->x))
+        != PS_SUCCESS ||
+        (err = pstm_mulmod_ctx(pool, pctx, &G->y, mu, &B[0]->y))
+        != PS_SUCCESS ||
+        (err = pstm_copy(mu, &B[0]->z)) != PS_SUCCESS)
     {
-        buflen = key->curve->size;
+        goto done;
     }
-    if (pstm_init_for_read_unsigned_bin(pool, &e, buflen) < 0)
+    for (b = 1; b < ECC_COMB_TEETH; b++)
     {
-        goto LBL_W;
+        if ((err = eccProjectiveDblPoint(pool, B[b - 1], B[b], modulus, &mp, A))
+            != PS_SUCCESS)
+        {
+            goto done;
+        }
+        for (i = 1; i < spacing; i++)
+        {
+            if ((err = eccProjectiveDblPoint(pool, B[b], B[b], modulus, &mp, A))
+                != PS_SUCCESS)
+            {
+                goto done;
+            }
+        }
     }
-    if (pstm_init_size(pool, &u1, e.alloc + w.alloc) < 0)
+
+    /* Entry j is B[top bit of j] plus the already stored entry of the
+       remaining bits */
+    for (j = 1; j <= ECC_COMB_POINTS; j++)
     {
-        goto LBL_E;
+        for (b = ECC_COMB_TEETH - 1; (j >> b) == 0; b--)
+        {
+        }
+        if (j == (1 << b))
+        {
+            if ((err = pstm_copy(&B[b]->x, &E->x)) != PS_SUCCESS ||
+                (err = pstm_copy(&B[b]->y, &E->y)) != PS_SUCCESS ||
+                (err = pstm_copy(&B[b]->z, &E->z)) != PS_SUCCESS)
+            {
+                goto done;
+            }
+        }
+        else
+        {
+            eccCombEntry(table, digits, j ^ (1 << b), &view);
+            if ((err = eccProjectiveAddPoint(pool, B[b], &view, E, modulus,
+                     &mp, (pstm_int *) A)) != PS_SUCCESS)
+            {
+                goto done;
+            }
+        }
+        if ((err = eccMap(pool, E, modulus, &mp)) != PS_SUCCESS ||
+            (err = eccCombStore(pool, pctx, mu, E,
+                 table + (j - 1) * 2 * digits, digits)) != PS_SUCCESS)
+        {
+            goto done;
+        }
     }
-    if (pstm_init_size(pool, &u2, r.alloc + w.alloc) < 0)
+    err = PS_SUCCESS;
+done:
+    for (b = 0; b < ECC_COMB_TEETH; b++)
     {
-        goto LBL_U1;
+        eccFreePoint(B[b]);
     }
+    eccFreePoint(E);
+    return err;
+}
 
-    /* allocate points */
-    if ((mG = eccNewPoint(pool, key->pubkey.x.alloc * 2)) == NULL)
+/*
+    Allocate and fill the comb table of the affine point 'P' on 'curve',
+    or of its base point if 'P' is NULL.
+ */
+static int32_t eccCurveComb(psPool_t *pool, const psEccCurve_t *curve,
+    const psEccPoint_t *P, pstm_digit **table, psSize_t *spacing)
+{
+    psEccPoint_t *G;
+    pstm_int m, n, mu, *A = NULL;
+    pstm_modctx pctx;
+    pstm_digit *comb = NULL;
+    psSize_t digits;
+    int32_t err, radlen;
+
+    radlen = curve->size * 2;
+    if (pstm_init_for_read_unsigned_bin(pool, &m, curve->size) < 0)
     {
-        goto LBL_U2;
+        return PS_MEM_FAIL;
     }
-    if ((mQ = eccNewPoint(pool, key->pubkey.x.alloc * 2)) == NULL)
+    if (pstm_init_for_read_unsigned_bin(pool, &n, curve->size) < 0)
     {
-        goto LBL_MG;
+        pstm_clear(&m);
+        return PS_MEM_FAIL;
     }
-
-    /* get the order */
-    if ((err = pstm_read_radix(pool, &p, key->curve->order, radlen, 16))
-        != PS_SUCCESS)
+    pctx.m = NULL;
+    G = NULL;
+    err = PS_MEM_FAIL;
+    if (pstm_init_size(pool, &mu,
+            (curve->size + sizeof(pstm_digit) - 1) / sizeof(pstm_digit) + 2)
+        < 0)
     {
-        goto error;
+        goto LBL_N;
     }
-
-    /* get the modulus */
-    if ((err = pstm_read_radix(pool, &m, key->curve->prime, radlen, 16))
+    if ((err = pstm_read_radix(pool, &m, curve->prime, radlen, 16))
+        != PS_SUCCESS ||
+        (err = pstm_read_radix(pool, &n, curve->order, radlen, 16))
         != PS_SUCCESS)
     {
-        goto error;
+        goto done;
     }
-
-    /* check for zero */
-    if (pstm_iszero(&r) || pstm_iszero(&s) || pstm_cmp(&r, &p) != PSTM_LT ||
-        pstm_cmp(&s, &p) != PSTM_LT)
+    if (P == NULL)
     {
-        err = PS_PARSE_FAIL;
-        goto error;
+        if ((G = eccNewPoint(pool, m.alloc * 2)) == NULL)
+        {
+            err = PS_MEM_FAIL;
+            goto done;
+        }
+        if ((err = pstm_read_radix(pool, &G->x, curve->Gx, radlen, 16))
+            != PS_SUCCESS ||
+            (err = pstm_read_radix(pool, &G->y, curve->Gy, radlen, 16))
+            != PS_SUCCESS)
+        {
+            goto done;
+        }
+        pstm_set(&G->z, 1);
+        P = G;
     }
-
-    /* read data */
+    if (curve->isOptimized == 0)
+    {
+        if ((A = psMalloc(pool, sizeof(pstm_int))) == NULL)
+        {
+            err = PS_MEM_FAIL;
+            goto done;
+        }
+        if (pstm_init_for_read_unsigned_bin(pool, A, curve->size) < 0)
+        {
+            psFree(A, pool);
+            A = NULL;
+            err = PS_MEM_FAIL;
+            goto done;
+        }
+        if ((err = pstm_read_radix(pool, A, curve->A, radlen, 16))
+            != PS_SUCCESS)
+        {
+            goto done;
+        }
+    }
+    if ((err = pstm_montgomery_calc_normalization(&mu, &m)) != PS_SUCCESS ||
+        (err = pstm_modctx_init(pool, &pctx, &m)) != PS_SUCCESS)
+    {
+        goto done;
+    }
+
+    digits = m.used;
+    *spacing = (pstm_count_bits(&n) + ECC_COMB_TEETH - 1) / ECC_COMB_TEETH;
+    comb = psMalloc(pool, ECC_COMB_POINTS * 2 * digits * sizeof(pstm_digit));
+    if (comb == NULL)
+    {
+        err = PS_MEM_FAIL;
+        goto done;
+    }
+    if ((err = eccCombTable(pool, P, comb, digits, *spacing, &m, &pctx, &mu,
+             A)) != PS_SUCCESS)
+    {
+        goto done;
+    }
+    *table = comb;
+    comb = NULL;
+    err = PS_SUCCESS;
+done:
+    if (comb)
+    {
+        psFree(comb, pool);
+    }
+    pstm_modctx_clear(&pctx);
+    if (A)
+    {
+        pstm_clear(A);
+        psFree(A, pool);
+    }
+    eccFreePoint(G);
+    pstm_clear(&mu);
+LBL_N:
+    pstm_clear(&n);
+    pstm_clear(&m);
+    return err;
+}
+
+/*
+    The comb tables of the base points are the same for every key, so
+    there is one per entry of eccCurves[], shared by all precomputed keys
+    and built by the first verification that needs it.
+ */
+#  define ECC_NUM_CURVES  (sizeof(eccCurves) / sizeof(eccCurves[0]))
+
+static pstm_digit *g_eccBaseComb[ECC_NUM_CURVES];
+
+#  ifdef USE_MULTITHREADING
+/* Guards g_eccBaseComb, opened by psCryptoOpen */
+static psMutex_t g_eccBaseCombLock;
+#   define BASE_COMB_LOCK()    psLockMutex(&g_eccBaseCombLock)
+#   define BASE_COMB_UNLOCK()  psUnlockMutex(&g_eccBaseCombLock)
+#  else
+#   define BASE_COMB_LOCK()
+#   define BASE_COMB_UNLOCK()
+#  endif
+
+/* Invoked from psCryptoOpen */
+int32_t psEccCombOpen(void)
+{
+    memset(g_eccBaseComb, 0x0, sizeof(g_eccBaseComb));
+#  ifdef USE_MULTITHREADING
+    return psCreateMutex(&g_eccBaseCombLock, 0);
+#  else
+    return PS_SUCCESS;
+#  endif
+}
+
+/* Invoked from psCryptoClose */
+void psEccCombClose(void)
+{
+    uint16_t i;
+
+    for (i = 0; i < ECC_NUM_CURVES; i++)
+    {
+        if (g_eccBaseComb[i])
+        {
+            psFree(g_eccBaseComb[i], NULL);
+            g_eccBaseComb[i] = NULL;
+        }
+    }
+#  ifdef USE_MULTITHREADING
+    psDestroyMutex(&g_eccBaseCombLock);
+#  endif
+}
+
+/*
+    The comb table of the base point of 'curve', or NULL if it can't be
+    built. The table is computed without holding the lock; if two threads
+    race, the loser frees its copy. Installed tables stay until
+    psCryptoClose().
+ */
+static const pstm_digit *eccBaseComb(const psEccCurve_t *curve)
+{
+    pstm_digit *table, *mine;
+    psSize_t spacing;
+    uint16_t i;
+
+    if (curve < eccCurves || curve >= eccCurves + ECC_NUM_CURVES)
+    {
+        return NULL;
+    }
+    i = (uint16_t) (curve - eccCurves);
+    BASE_COMB_LOCK();
+    table = g_eccBaseComb[i];
+    BASE_COMB_UNLOCK();
+    if (table != NULL)
+    {
+        return table;
+    }
+    if (eccCurveComb(NULL, curve, NULL, &mine, &spacing) < 0)
+    {
+        return NULL;
+    }
+    BASE_COMB_LOCK();
+    if (g_eccBaseComb[i] == NULL)
+    {
+        g_eccBaseComb[i] = mine;
+        mine = NULL;
+    }
+    table = g_eccBaseComb[i];
+    BASE_COMB_UNLOCK();
+    if (mine)
+    {
+        psFree(mine, NULL);
+    }
+    return table;
+}
+
+/**
+    Build the comb table of 'key'. The table of the base point is shared
+    by all keys on the curve and built on first use, see eccBaseComb().
+    @param[in] pool Memory pool
+    @param[in] key Public key
+    @param[out] precomp Receives the table in 'comb' and 'combSpacing'
+    @return PS_SUCCESS on success, < 0 on error
+ */
+int32_t psEccPrecompute(psPool_t *pool, const psEccKey_t *key,
+    psPubKeyPrecomp_t *precomp)
+{
+    if (!PS_ECC_IS_WEIERSTRASS(key->curve))
+    {
+        return PS_UNSUPPORTED_FAIL;
+    }
+    /* The public key must be affine, as after import */
+    if (pstm_cmp_d(&key->pubkey.z, 1) != PSTM_EQ)
+    {
+        return PS_ARG_FAIL;
+    }
+    return eccCurveComb(pool, key->curve, &key->pubkey, &precomp->comb,
+        &precomp->combSpacing);
+}
+
+/* Bit 'n' of 'k' */
+static pstm_digit eccCombBit(const pstm_int *k, uint16_t n)
+{
+    return (get_digit(k, (uint8_t) (n / DIGIT_BIT)) >> (n % DIGIT_BIT)) & 1;
+}
+
+/*
+    R = k1 * G + k2 * Q with the comb tables 'gComb' and 'qComb', left in
+    Jacobian Montgomery form like eccMulmod() with map == 0. Both scalars
+    must be below the curve order.
+ */
+static int32_t eccCombMulmod2(psPool_t *pool, const pstm_digit *gComb,
+    const pstm_digit *qComb, psSize_t spacing,
+    const pstm_int *k1, const pstm_int *k2,
+    psEccPoint_t *R, const pstm_int *modulus, const pstm_int *A)
+{
+    const pstm_int *k[2];
+    const pstm_digit *comb[2];
+    psEccPoint_t view;
+    pstm_digit one, mp;
+    psSize_t digits;
+    int32 i, err;
+    uint16_t t, b, idx;
+    int first;
+
+    if ((err = pstm_montgomery_setup(modulus, &mp)) != PS_SUCCESS)
+    {
+        return err;
+    }
+    digits = modulus->used;
+    memset(&view, 0x0, sizeof(view));
+    one = 1;
+    view.z.dp = &one;
+    view.z.used = view.z.alloc = 1;
+    view.z.sign = PSTM_ZPOS;
+    k[0] = k2;
+    comb[0] = qComb;
+    k[1] = k1;
+    comb[1] = gComb;
+    first = 1;
+    for (i = spacing - 1; i >= 0; i--)
+    {
+        if (!first)
+        {
+            if ((err = eccProjectiveDblPoint(pool, R, R, modulus, &mp, A))
+                != PS_SUCCESS)
+            {
+                return err;
+            }
+        }
+        for (t = 0; t < 2; t++)
+        {
+            idx = 0;
+            for (b = ECC_COMB_TEETH; b > 0; b--)
+            {
+                idx = (idx << 1) |
+                      (uint16_t) eccCombBit(k[t], (b - 1) * spacing + i);
+            }
+            if (idx == 0)
+            {
+                continue;
+            }
+            eccCombEntry(comb[t], digits, idx, &view);
+            if (first)
+            {
+                /* z = 1 in Montgomery form */
+                if ((err = pstm_copy(&view.x, &R->x)) != PS_SUCCESS ||
+                    (err = pstm_copy(&view.y, &R->y)) != PS_SUCCESS ||
+                    (err = pstm_montgomery_calc_normalization(&R->z, modulus))
+                    != PS_SUCCESS)
+                {
+                    return err;
+                }
+                first = 0;
+            }
+            else if ((err = eccProjectiveAddPoint(pool, R, &view, R, modulus,
+                          &mp, (pstm_int *) A)) != PS_SUCCESS)
+            {
+                return err;
+            }
+        }
+    }
+    if (first)
+    {
+        /* Both scalars zero: the point at infinity */
+        return PS_FAILURE;
+    }
+    return PS_SUCCESS;
+}
+# endif /* USE_PUBKEY_PRECOMP */
+
+/******************************************************************************/
+/*
+    psEccDsaVerify() with the optional comb table of 'key' from
+    psEccPrecompute().
+ */
+static int32_t eccDsaVerify(psPool_t *pool, const psEccKey_t *key,
+    const pstm_digit *qComb, psSize_t combSpacing,
+    const unsigned char *buf, psSize_t buflen,
+    const unsigned char *sig, psSize_t siglen,
+    int32_t *status, void *usrData)
+{
+    psEccPoint_t *mG, *mQ;
+    pstm_digit mp;
+#  ifdef USE_PUBKEY_PRECOMP
+    const pstm_digit *gComb;
+#  endif
+    pstm_int *A = NULL;
+    pstm_int v, w, u1, u2, e, p, m, r, s;
+    pstm_modctx nctx;
+    const unsigned char *c, *end;
+    int32_t err, radlen;
+    psSize_t len;
+
+    /* default to invalid signature */
+    *status = -1;
+
+    if (!PS_ECC_IS_WEIERSTRASS(key->curve))
+    {
+        psTraceCrypto("ECDSA is only defined for Weierstrass curves\n");
+        return PS_UNSUPPORTED_FAIL;
+    }
+
+    c = sig;
+    end = c + siglen;
+
+    if ((err = getAsnSequence(&c, (uint16_t) (end - c), &len)) < 0)
+    {
+        psTraceCrypto("ECDSA subject signature parse failure 1\n");
+        return err;
+    }
+    if ((err = pstm_read_asn(pool, &c, (uint16_t) (end - c), &r)) < 0)
+    {
+        psTraceCrypto("ECDSA subject signature parse failure 2\n");
+        return err;
+    }
+    if ((err = pstm_read_asn(pool, &c, (uint16_t) (end - c), &s)) < 0)
+    {
+        psTraceCrypto("ECDSA subject signature parse failure 3\n");
+        pstm_clear(&r);
+        return err;
+    }
+
+    /* allocate ints */
+    radlen = key->curve->size * 2;
+    if (pstm_init_for_read_unsigned_bin(pool, &p, key->curve->size) < 0)
+    {
+        pstm_clear(&s);
+        pstm_clear(&r);
+        return PS_MEM_FAIL;
+    }
+    err = PS_MEM_FAIL;
+    if (pstm_init_for_read_unsigned_bin(pool, &m, key->curve->size) < 0)
+    {
+        goto LBL_P;
+    }
+    if (pstm_init_size(pool, &v, key->pubkey.x.alloc) < 0)
+    {
+        goto LBL_M;
+    }
+    if (pstm_init_size(pool, &w, s.alloc) < 0)
+    {
+        goto LBL_V;
+    }
+    /* Shouldn't have signed more data than the key length.  Truncate if so */
+    if (buflen > key->curve->size)
+    {
+        buflen = key->curve->size;
+    }
+    if (pstm_init_for_read_unsigned_bin(pool, &e, buflen) < 0)
+    {
+        goto LBL_W;
+    }
+    if (pstm_init_size(pool, &u1, e.alloc + w.alloc) < 0)
+    {
+        goto LBL_E;
+    }
+    if (pstm_init_size(pool, &u2, r.alloc + w.alloc) < 0)
+    {
+        goto LBL_U1;
+    }
+
+    /* allocate points */
+    if ((mG = eccNewPoint(pool, key->pubkey.x.alloc * 2)) == NULL)
+    {
+        goto LBL_U2;
+    }
+    if ((mQ = eccNewPoint(pool, key->pubkey.x.alloc * 2)) == NULL)
+    {
+        goto LBL_MG;
+    }
+
+    /* get the order, and set up reduction modulo the order */
+    nctx.m = NULL;
+    if ((err = pstm_read_radix(pool, &p, key->curve->order, radlen, 16))
+        != PS_SUCCESS)
+    {
+        goto error;
+    }
+    if ((err = pstm_modctx_init(pool, &nctx, &p)) != PS_SUCCESS)
+    {
+        goto error;
+    }
+
+    /* get the modulus */
+    if ((err = pstm_read_radix(pool, &m, key->curve->prime, radlen, 16))
+        != PS_SUCCESS)
+    {
+        goto error;
+    }
+
+    /* check for zero */
+    if (pstm_iszero(&r) || pstm_iszero(&s) || pstm_cmp(&r, &p) != PSTM_LT ||
+        pstm_cmp(&s, &p) != PSTM_LT)
+    {
+        err = PS_PARSE_FAIL;
+        goto error;
+    }
+
+    /* read data */
     if ((err = pstm_read_unsigned_bin(&e, buf, buflen)) != PS_SUCCESS)
     {
         goto error;
@@ -2942,13 +3559,13 @@ int32_t psEccDsaVerify(psPool_t *pool, const psEccKey_t *key,
     }
 
     /* u1 = ew */
-    if ((err = pstm_mulmod(pool, &e, &w, &p, &u1)) != PS_SUCCESS)
+    if ((err = pstm_mulmod_ctx(pool, &nctx, &e, &w, &u1)) != PS_SUCCESS)
     {
         goto error;
     }
 
     /* u2 = rw */
-    if ((err = pstm_mulmod(pool, &r, &w, &p, &u2)) != PS_SUCCESS)
+    if ((err = pstm_mulmod_ctx(pool, &nctx, &r, &w, &u2)) != PS_SUCCESS)
     {
         goto error;
     }
@@ -2999,26 +3616,42 @@ int32_t psEccDsaVerify(psPool_t *pool, const psEccKey_t *key,
         }
     }
 
-    /* compute u1*mG + u2*mQ = mG */
-    if ((err = eccMulmod(pool, &u1, mG, mG, &m, 0, A)) != PS_SUCCESS)
-    {
-        goto error;
-    }
-    if ((err = eccMulmod(pool, &u2, mQ, mQ, &m, 0, A)) != PS_SUCCESS)
-    {
-        goto error;
-    }
-
     /* find the montgomery mp */
     if ((err = pstm_montgomery_setup(&m, &mp)) != PS_SUCCESS)
     {
         goto error;
     }
 
-    /* add them */
-    if ((err = eccProjectiveAddPoint(pool, mQ, mG, mG, &m, &mp, A)) != PS_SUCCESS)
+#  ifdef USE_PUBKEY_PRECOMP
+    gComb = qComb != NULL ? eccBaseComb(key->curve) : NULL;
+    if (gComb != NULL)
     {
-        goto error;
+        /* compute u1*mG + u2*mQ = mG in one pass over both combs */
+        if ((err = eccCombMulmod2(pool, gComb, qComb, combSpacing, &u1, &u2,
+                 mG, &m, A)) != PS_SUCCESS)
+        {
+            goto error;
+        }
+    }
+    else
+#  endif /* USE_PUBKEY_PRECOMP */
+    {
+        /* compute u1*mG + u2*mQ = mG */
+        if ((err = eccMulmod(pool, &u1, mG, mG, &m, 0, A)) != PS_SUCCESS)
+        {
+            goto error;
+        }
+        if ((err = eccMulmod(pool, &u2, mQ, mQ, &m, 0, A)) != PS_SUCCESS)
+        {
+            goto error;
+        }
+
+        /* add them */
+        if ((err = eccProjectiveAddPoint(pool, mQ, mG, mG, &m, &mp, A))
+            != PS_SUCCESS)
+        {
+            goto error;
+        }
     }
 
     /* reduce */
@@ -3028,7 +3661,7 @@ int32_t psEccDsaVerify(psPool_t *pool, const psEccKey_t *key,
     }
 
     /* v = X_x1 mod n */
-    if ((err = pstm_mod(pool, &mG->x, &p, &v)) != PS_SUCCESS)
+    if ((err = pstm_mod_ctx(pool, &nctx, &mG->x, &v)) != PS_SUCCESS)
     {
         goto error;
     }
@@ -3043,6 +3676,7 @@ int32_t psEccDsaVerify(psPool_t *pool, const psEccKey_t *key,
     err = PS_SUCCESS;
 
 error:
+    pstm_modctx_clear(&nctx);
     if (A)
     {
         pstm_clear(A);
@@ -3071,29 +3705,391 @@ LBL_P:
     return err;
 }
 
+/******************************************************************************/
 /**
-    Sign a message digest.
+    Verify an ECDSA signature.
+
     @param pool Memory pool
-    @param[in] key Private ECC key
-    @param[in] in The data to sign
-    @param[in] inlen The length in bytes of 'in'
-    @param[out] out The destination for the signature
-    @param[in,out] outlen The max size and resulting size of the signature
-    @param[in] includeSize Pass 1 to include size prefix in output.
-    @param usrData Implementation specific data. Can pass NULL.
-    @return PS_SUCCESS if successful
+    @param[in] key Public key to use for signature validation
+    @param[in] buf Data that is signed by private 'key'
+    @param[in] buflen Length in bytes of 'buf'
+    @param[in] sig Signature of 'buf' by the private key pair of 'key'
+    @param[in] siglen Length in bytes of 'sig'
+    @param[out] status Result of the signature check. 1 on success, -1 on
+        non-matching signature.
+    @param usrData Data used by some hardware crypto. Can be NULL.
+    @return < 0 on failure. Also 'status'.
+ */
+int32_t psEccDsaVerify(psPool_t *pool, const psEccKey_t *key,
+    const unsigned char *buf, psSize_t buflen,
+    const unsigned char *sig, psSize_t siglen,
+    int32_t *status, void *usrData)
+{
+    return eccDsaVerify(pool, key, NULL, 0, buf, buflen, sig, siglen, status,
+        usrData);
+}
 
-    @note TLS does use the size prefix in output.
+# ifdef USE_PUBKEY_PRECOMP
+/**
+    psEccDsaVerify() using the precomputed data of a public key.
+
+    @param[in] precomp Data from psPubKeyPrecompute() on the public key that
+    contains 'key', or NULL. Ignored if computed for another key.
  */
-int32_t psEccDsaSign(psPool_t *pool, const psEccKey_t *privKey,
+int32_t psEccDsaVerifyExt(psPool_t *pool, const psEccKey_t *key,
+    const psPubKeyPrecomp_t *precomp,
+    const unsigned char *buf, psSize_t buflen,
+    const unsigned char *sig, psSize_t siglen,
+    int32_t *status, void *usrData)
+{
+    if (precomp != NULL && precomp->key->type == PS_ECC &&
+        &precomp->key->key.ecc == key && precomp->comb != NULL)
+    {
+        return eccDsaVerify(pool, key, precomp->comb, precomp->combSpacing,
+            buf, buflen, sig, siglen, status, usrData);
+    }
+    return eccDsaVerify(pool, key, NULL, 0, buf, buflen, sig, siglen, status,
+        usrData);
+}
+# endif /* USE_PUBKEY_PRECOMP */
+
+/******************************************************************************/
+/*
+    Make up the message independent part of an ECDSA signature: a fresh
+    nonce k, r = x(k*G) mod n, k^-1 mod n and x*r mod n. The signature of
+    a message digest e is then s = k^-1 * (e + x*r) mod n.
+    'r', 'kinv' and 'xr' must be initialized. Returns PS_LIMIT_FAIL in the
+    unlikely case that r is zero, the caller should try again.
+ */
+static int32_t eccDsaNonce(psPool_t *pool, const psEccKey_t *privKey,
+    const pstm_modctx *nctx, pstm_int *r, pstm_int *kinv, pstm_int *xr,
+    void *usrData)
+{
+    psEccKey_t pubKey;      /* @note Large on the stack */
+    int32_t err;
+
+    if ((err = psEccGenKey(pool, &pubKey, privKey->curve, usrData))
+        != PS_SUCCESS)
+    {
+        return err;
+    }
+    /* find r = x1 mod n */
+    if ((err = pstm_mod_ctx(pool, nctx, &pubKey.pubkey.x, r)) != PS_SUCCESS)
+    {
+        goto L_OUT;
+    }
+    if (pstm_iszero(r) == PS_TRUE)
+    {
+        err = PS_LIMIT_FAIL;
+        goto L_OUT;
+    }
+    if ((err = pstm_invmod(pool, &pubKey.k, nctx->m, kinv)) != PS_SUCCESS)
+    {
+        goto L_OUT; /* k = 1/k */
+    }
+    err = pstm_mulmod_ctx(pool, nctx, &privKey->k, r, xr); /* xr */
+L_OUT:
+    psEccClearKey(&pubKey);
+    return err;
+}
+
+# ifdef USE_ECDSA_PRESIGN
+/******************************************************************************/
+/*
+    Queue of nonces made up in advance by a background thread, so that
+    signing only has to compute s = k^-1 * (e + x*r) mod n.
+
+    Each entry is handed out exactly once and wiped as it is taken. The
+    queue belongs to the process that created it: a forked child would
+    share the nonces of its parent, so if the process id changes the
+    queue is wiped and signing falls back to making up nonces inline.
+ */
+typedef struct
+{
+    pstm_int r;
+    pstm_int kinv;
+    pstm_int xr;
+} eccPresignEntry_t;
+
+struct psEccPresign
+{
+    psPool_t *pool;
+    const psEccKey_t *key;
+    pstm_int n;
+    pstm_modctx nctx;           /* Reduction context of the curve order */
+    eccPresignEntry_t *entry;   /* Ring of 'depth' entries */
+    uint16_t depth;
+    uint16_t head;
+    uint16_t count;             /* Ready entries starting at 'head' */
+    uint32_t pid;               /* Process that owns the queue */
+#  ifdef USE_MULTITHREADING
+    psMutex_t lock;
+#  endif
+    psWorkerPool_t *worker;
+    psWorkerJob_t job;
+    uint8_t queued;
+    uint8_t closing;
+    uint8_t forked;
+};
+
+static void eccPresignWipe(eccPresignEntry_t *e)
+{
+    pstm_clear(&e->r);
+    pstm_clear(&e->kinv);
+    pstm_clear(&e->xr);
+}
+
+/*
+    Background job: fill the queue, one nonce at a time. A pool without
+    threads runs this in the signing thread, where a whole queue would
+    stall the handshake, so there it adds a single nonce per run.
+ */
+static void eccPresignRefill(void *arg)
+{
+    psEccPresign_t *ps = arg;
+    eccPresignEntry_t *e;
+    psSize_t size;
+    uint16_t batch;
+    int32_t err;
+
+    size = ps->n.alloc;
+    batch = psWorkerPoolThreads(ps->worker) > 0 ? ps->depth : 1;
+    for (;; )
+    {
+        psLockMutex(&ps->lock);
+        if (ps->closing || ps->forked || ps->count == ps->depth ||
+            batch == 0)
+        {
+            ps->queued = 0;
+            psUnlockMutex(&ps->lock);
+            return;
+        }
+        /* Only this job writes past the ready entries */
+        e = &ps->entry[(ps->head + ps->count) % ps->depth];
+        psUnlockMutex(&ps->lock);
+
+        if (pstm_init_size(ps->pool, &e->r, size) < 0 ||
+            pstm_init_size(ps->pool, &e->kinv, size) < 0 ||
+            pstm_init_size(ps->pool, &e->xr, size) < 0)
+        {
+            err = PS_MEM_FAIL;
+        }
+        else
+        {
+            err = eccDsaNonce(ps->pool, ps->key, &ps->nctx, &e->r, &e->kinv,
+                &e->xr, NULL);
+        }
+        if (err != PS_SUCCESS)
+        {
+            eccPresignWipe(e);
+            if (err == PS_LIMIT_FAIL)
+            {
+                continue;
+            }
+            psTraceCrypto("ECDSA nonce precomputation failed\n");
+            psLockMutex(&ps->lock);
+            ps->queued = 0;
+            psUnlockMutex(&ps->lock);
+            return;
+        }
+        psLockMutex(&ps->lock);
+        ps->count++;
+        psUnlockMutex(&ps->lock);
+        batch--;
+    }
+}
+
+/*
+    Called before taking ps->lock. In a child of fork() the lock may still
+    be held by the refill thread of the parent, which the child does not
+    have, so the child recreates it. It then wipes the nonces, they are
+    the parent's, and signs with inline nonces from then on.
+ */
+static void eccPresignForked(psEccPresign_t *ps)
+{
+    if (ps->forked || ps->pid == psGetProcessId())
+    {
+        return;
+    }
+    if (psCreateMutex(&ps->lock, 0) < 0)
+    {
+        psTraceCrypto("ECDSA nonce queue lock not recreated after fork\n");
+    }
+    ps->forked = 1;
+    ps->queued = 0;
+    while (ps->count > 0)
+    {
+        eccPresignWipe(&ps->entry[ps->head]);
+        ps->head = (ps->head + 1) % ps->depth;
+        ps->count--;
+    }
+}
+
+/*
+    Take the oldest nonce from the queue into 'r', 'kinv' and 'xr' and
+    schedule a refill. Returns PS_FAILURE if the queue is empty.
+ */
+static int32_t eccPresignPop(psEccPresign_t *ps, pstm_int *r, pstm_int *kinv,
+    pstm_int *xr)
+{
+    eccPresignEntry_t *e;
+    int32_t err;
+    uint8_t kick;
+
+    err = PS_FAILURE;
+    kick = 0;
+    eccPresignForked(ps);
+    psLockMutex(&ps->lock);
+    if (ps->count > 0)
+    {
+        e = &ps->entry[ps->head];
+        if ((err = pstm_copy(&e->r, r)) == PSTM_OKAY &&
+            (err = pstm_copy(&e->kinv, kinv)) == PSTM_OKAY)
+        {
+            err = pstm_copy(&e->xr, xr);
+        }
+        /* Never hand out the same nonce twice, even on failure */
+        eccPresignWipe(e);
+        ps->head = (ps->head + 1) % ps->depth;
+        ps->count--;
+    }
+    if (!ps->queued && !ps->closing && !ps->forked)
+    {
+        ps->queued = kick = 1;
+    }
+    psUnlockMutex(&ps->lock);
+    if (kick)
+    {
+        psWorkerJobInit(&ps->job, eccPresignRefill, ps);
+        psWorkerPoolSubmit(ps->worker, &ps->job);
+    }
+    return err;
+}
+
+/**
+    Create a queue of precomputed signing nonces for a private key.
+    A background thread keeps up to 'depth' nonces ready for
+    psEccDsaSignExt(). Without thread support the signing thread adds one
+    nonce for each one it takes, which gives no speedup.
+
+    @param[in] pool Memory pool
+    @param[in] privKey Private key. Must outlive the queue.
+    @param[in] depth Number of nonces to keep ready.
+    @param[out] presign The new queue.
+    @return < 0 on failure.
+ */
+int32_t psEccNewPresign(psPool_t *pool, const psEccKey_t *privKey,
+    uint16_t depth, psEccPresign_t **presign)
+{
+    psEccPresign_t *ps;
+    int32_t err;
+
+    if (privKey == NULL || presign == NULL || depth == 0 ||
+        privKey->type != PS_PRIVKEY || !PS_ECC_IS_WEIERSTRASS(privKey->curve))
+    {
+        return PS_ARG_FAIL;
+    }
+    if ((ps = psMalloc(pool, sizeof(psEccPresign_t))) == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    memset(ps, 0x0, sizeof(psEccPresign_t));
+    ps->pool = pool;
+    ps->key = privKey;
+    ps->depth = depth;
+    ps->pid = psGetProcessId();
+    err = PS_MEM_FAIL;
+    if ((ps->entry = psMalloc(pool, depth * sizeof(eccPresignEntry_t))) == NULL)
+    {
+        goto L_FREE;
+    }
+    memset(ps->entry, 0x0, depth * sizeof(eccPresignEntry_t));
+    if (pstm_init_for_read_unsigned_bin(pool, &ps->n, privKey->curve->size) < 0)
+    {
+        goto L_FREE;
+    }
+    if ((err = pstm_read_radix(pool, &ps->n, privKey->curve->order,
+             privKey->curve->size * 2, 16)) != PS_SUCCESS)
+    {
+        goto L_N;
+    }
+    if ((err = pstm_modctx_init(pool, &ps->nctx, &ps->n)) != PS_SUCCESS)
+    {
+        goto L_N;
+    }
+    if ((err = psCreateMutex(&ps->lock, 0)) < 0)
+    {
+        goto L_CTX;
+    }
+    if ((err = psWorkerPoolOpen(pool, &ps->worker, 1)) < 0)
+    {
+        psDestroyMutex(&ps->lock);
+        goto L_CTX;
+    }
+    ps->queued = 1;
+    psWorkerJobInit(&ps->job, eccPresignRefill, ps);
+    psWorkerPoolSubmit(ps->worker, &ps->job);
+    *presign = ps;
+    return PS_SUCCESS;
+
+L_CTX:
+    pstm_modctx_clear(&ps->nctx);
+L_N:
+    pstm_clear(&ps->n);
+L_FREE:
+    if (ps->entry)
+    {
+        psFree(ps->entry, pool);
+    }
+    psFree(ps, pool);
+    return err;
+}
+
+/**
+    Stop the background thread of a nonce queue, wipe and free it.
+ */
+void psEccDeletePresign(psEccPresign_t *presign)
+{
+    psEccPresign_t *ps = presign;
+
+    if (ps == NULL)
+    {
+        return;
+    }
+    eccPresignForked(ps);
+    psLockMutex(&ps->lock);
+    ps->closing = 1;
+    psUnlockMutex(&ps->lock);
+    /* In a forked child this only frees the pool, there is no thread */
+    psWorkerPoolClose(ps->worker);
+    while (ps->count > 0)
+    {
+        eccPresignWipe(&ps->entry[ps->head]);
+        ps->head = (ps->head + 1) % ps->depth;
+        ps->count--;
+    }
+    psDestroyMutex(&ps->lock);
+    pstm_modctx_clear(&ps->nctx);
+    pstm_clear(&ps->n);
+    psFree(ps->entry, ps->pool);
+    psFree(ps, ps->pool);
+}
+# endif /* USE_ECDSA_PRESIGN */
+
+/******************************************************************************/
+/*
+    psEccDsaSign() taking nonces from an optional presign queue.
+ */
+static int32_t eccDsaSign(psPool_t *pool, const psEccKey_t *privKey,
+    psEccPresign_t *presign,
     const unsigned char *buf, psSize_t buflen,
     unsigned char *sig, psSize_t *siglen,
     uint8_t includeSize, void *usrData)
 {
-    psEccKey_t pubKey;      /* @note Large on the stack */
-    pstm_int r, s;
+    pstm_int r, s, kinv;
 
     pstm_int e, p;
+    pstm_modctx nctx;
     psSize_t radlen;
     int32_t err = PS_MEM_FAIL;
     psSize_t olen, rLen, sLen;
@@ -3101,12 +4097,18 @@ int32_t psEccDsaSign(psPool_t *pool, const psEccKey_t *privKey,
     unsigned char *negative;
 
     rflag = sflag = 0;
+    nctx.m = NULL;
 
     /* is this a private key? */
     if (privKey->type != PS_PRIVKEY)
     {
         return PS_ARG_FAIL;
     }
+    if (!PS_ECC_IS_WEIERSTRASS(privKey->curve))
+    {
+        psTraceCrypto("ECDSA is only defined for Weierstrass curves\n");
+        return PS_UNSUPPORTED_FAIL;
+    }
 
     /* Can't sign more data than the key length.  Truncate if so */
     if (buflen > privKey->curve->size)
@@ -3131,6 +4133,10 @@ int32_t psEccDsaSign(psPool_t *pool, const psEccKey_t *privKey,
     {
         goto LBL_R;
     }
+    if (pstm_init_size(pool, &kinv, p.alloc) < 0)
+    {
+        goto LBL_S;
+    }
 
     if ((err = pstm_read_radix(pool, &p, privKey->curve->order, radlen,
              16)) != PS_SUCCESS)
@@ -3141,8 +4147,17 @@ int32_t psEccDsaSign(psPool_t *pool, const psEccKey_t *privKey,
     {
         goto errnokey;
     }
+    /* Everything below is mod n, reduce without division */
+    if ((err = pstm_modctx_init(pool, &nctx, &p)) != PS_SUCCESS)
+    {
+        goto errnokey;
+    }
+    if ((err = pstm_mod_ctx(pool, &nctx, &e, &e)) != PS_SUCCESS)
+    {
+        goto errnokey;
+    }
 
-    /* make up a key and export the public copy */
+    /* make up a nonce, or take a precomputed one */
     sanity = 0;
     for (;; )
     {
@@ -3152,60 +4167,50 @@ int32_t psEccDsaSign(psPool_t *pool, const psEccKey_t *privKey,
             err = PS_PLATFORM_FAIL; /* possible problem with prng */
             goto errnokey;
         }
-        if ((err = psEccGenKey(pool, &pubKey, privKey->curve, usrData))
-            != PS_SUCCESS)
-        {
-            goto errnokey;
-        }
-        /* find r = x1 mod n */
-        if ((err = pstm_mod(pool, &pubKey.pubkey.x, &p, &r)) != PS_SUCCESS)
-        {
-            goto error;
-        }
-
-        if (pstm_iszero(&r) == PS_TRUE)
-        {
-            psEccClearKey(&pubKey);
-        }
-        else
+# ifdef USE_ECDSA_PRESIGN
+        if (presign == NULL || eccPresignPop(presign, &r, &kinv, &s) != PSTM_OKAY)
+# endif
         {
-            /* find s = (e + xr)/k */
-            if ((err = pstm_invmod(pool, &pubKey.k, &p, &pubKey.k)) !=
-                PS_SUCCESS)
-            {
-                goto error; /* k = 1/k */
-            }
-            if ((err = pstm_mulmod(pool, &privKey->k, &r, &p, &s))
-                != PS_SUCCESS)
-            {
-                goto error; /* s = xr */
-            }
-            if ((err = pstm_add(&e, &s, &s)) != PS_SUCCESS)
+            /* r, 1/k and s = xr */
+            err = eccDsaNonce(pool, privKey, &nctx, &r, &kinv, &s, usrData);
+            if (err == PS_LIMIT_FAIL)
             {
-                goto error;  /* s = e +  xr */
+                continue;
             }
-            if ((err = pstm_mod(pool, &s, &p, &s)) != PS_SUCCESS)
+            if (err != PS_SUCCESS)
             {
-                goto error; /* s = e +  xr */
+                goto errnokey;
             }
-            if ((err = pstm_mulmod(pool, &s, &pubKey.k, &p, &s))
-                != PS_SUCCESS)
+        }
+        /* find s = (e + xr)/k */
+        if ((err = pstm_add(&e, &s, &s)) != PS_SUCCESS)
+        {
+            goto errnokey;  /* s = e +  xr */
+        }
+        /* e and xr are both below n */
+        if (pstm_cmp(&s, &p) != PSTM_LT)
+        {
+            if ((err = pstm_sub(&s, &p, &s)) != PS_SUCCESS)
             {
-                goto error; /* s = (e + xr)/k */
+                goto errnokey; /* s = e +  xr */
             }
-            psEccClearKey(&pubKey);
+        }
+        if ((err = pstm_mulmod_ctx(pool, &nctx, &s, &kinv, &s))
+            != PS_SUCCESS)
+        {
+            goto errnokey; /* s = (e + xr)/k */
+        }
 
-            rLen = pstm_unsigned_bin_size(&r);
-            sLen = pstm_unsigned_bin_size(&s);
+        rLen = pstm_unsigned_bin_size(&r);
+        sLen = pstm_unsigned_bin_size(&s);
 
-            /* Signatures can be smaller than the keysize but keep it sane */
-            if (((rLen + 6) >= privKey->curve->size) &&
-                ((sLen + 6) >= privKey->curve->size))
+        /* Signatures can be smaller than the keysize but keep it sane */
+        if (((rLen + 6) >= privKey->curve->size) &&
+            ((sLen + 6) >= privKey->curve->size))
+        {
+            if (pstm_iszero(&s) == PS_FALSE)
             {
-                if (pstm_iszero(&s) == PS_FALSE)
-                {
-                    break;
-                }
+                break;
             }
         }
     }
@@ -3294,15 +4299,15 @@ int32_t psEccDsaSign(psPool_t *pool, const psEccKey_t *privKey,
     }
     if ((err = pstm_to_unsigned_bin(pool, &s, sig)) != PSTM_OKAY)
     {
-        goto error;
+        goto errnokey;
     }
     *siglen += sLen + 2;
     err = PS_SUCCESS;
-    goto errnokey;
 
-error:
-    psEccClearKey(&pubKey);
 errnokey:
+    pstm_modctx_clear(&nctx);
+    pstm_clear(&kinv);
+LBL_S:
     pstm_clear(&s);
 LBL_R:
     pstm_clear(&r);
@@ -3313,5 +4318,50 @@ LBL_P:
     return err;
 }
 
+/**
+    Sign a message digest.
+    @param pool Memory pool
+    @param[in] key Private ECC key
+    @param[in] in The data to sign
+    @param[in] inlen The length in bytes of 'in'
+    @param[out] out The destination for the signature
+    @param[in,out] outlen The max size and resulting size of the signature
+    @param[in] includeSize Pass 1 to include size prefix in output.
+    @param usrData Implementation specific data. Can pass NULL.
+    @return PS_SUCCESS if successful
+
+    @note TLS does use the size prefix in output.
+ */
+int32_t psEccDsaSign(psPool_t *pool, const psEccKey_t *privKey,
+    const unsigned char *buf, psSize_t buflen,
+    unsigned char *sig, psSize_t *siglen,
+    uint8_t includeSize, void *usrData)
+{
+    return eccDsaSign(pool, privKey, NULL, buf, buflen, sig, siglen,
+        includeSize, usrData);
+}
+
+# ifdef USE_ECDSA_PRESIGN
+/**
+    psEccDsaSign() using a nonce from a psEccNewPresign() queue when one is
+    ready.
+
+    @param[in] presign Queue created for 'privKey', or NULL.
+ */
+int32_t psEccDsaSignExt(psPool_t *pool, const psEccKey_t *privKey,
+    psEccPresign_t *presign,
+    const unsigned char *buf, psSize_t buflen,
+    unsigned char *sig, psSize_t *siglen,
+    uint8_t includeSize, void *usrData)
+{
+    if (presign != NULL && presign->key != privKey)
+    {
+        presign = NULL;
+    }
+    return eccDsaSign(pool, privKey, presign, buf, buflen, sig, siglen,
+        includeSize, usrData);
+}
+# endif /* USE_ECDSA_PRESIGN */
+
 #endif  /* USE_MATRIX_ECC */
 
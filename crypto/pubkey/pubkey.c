@@ -55,6 +55,11 @@ int32_t psInitPubKey(psPool_t *pool, psPubKey_t *key, uint8_t type)
     case PS_ECC:
         psEccInitKey(pool, &key->key.ecc, NULL);
         break;
+# endif
+# ifdef USE_ED25519
+    case PS_ED25519:
+        psEd25519ClearKey(&key->key.ed25519);
+        break;
 # endif
     default:
         break;
@@ -84,6 +89,11 @@ void psClearPubKey(psPubKey_t *key)
     case PS_ECC:
         psEccClearKey(&key->key.ecc);
         break;
+# endif
+# ifdef USE_ED25519
+    case PS_ED25519:
+        psEd25519ClearKey(&key->key.ed25519);
+        break;
 # endif
     default:
         break;
@@ -116,6 +126,84 @@ void psDeletePubKey(psPubKey_t **key)
     *key = NULL;
 }
 
+# ifdef USE_PUBKEY_PRECOMP
+/******************************************************************************/
+/**
+    Precompute data that speeds up signature verification with a public
+    key that is used many times, such as the key of a trusted CA.
+    The result can be passed to psRsaDecryptPubExt(), psRsaCryptExt() and
+    psEccDsaVerifyExt().
+
+    @param[in] pool Memory pool for the precomputed data.
+    @param[in] key Public key. Must outlive the result.
+    @param[out] precomp The precomputed data, free with psPubKeyPrecompFree().
+    @return < 0 on failure.
+ */
+int32_t psPubKeyPrecompute(psPool_t *pool, const psPubKey_t *key,
+    psPubKeyPrecomp_t **precomp)
+{
+    psPubKeyPrecomp_t *pc;
+    int32_t rc;
+
+    if (key == NULL || precomp == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    *precomp = NULL;
+    if ((pc = psMalloc(pool, sizeof(psPubKeyPrecomp_t))) == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    memset(pc, 0x0, sizeof(psPubKeyPrecomp_t));
+    pc->pool = pool;
+    pc->key = key;
+    switch (key->type)
+    {
+#  ifdef USE_RSA
+    case PS_RSA:
+        rc = pstm_modctx_init(pool, &pc->nCtx, &key->key.rsa.N);
+        break;
+#  endif
+#  ifdef USE_ECC
+    case PS_ECC:
+        rc = psEccPrecompute(pool, &key->key.ecc, pc);
+        break;
+#  endif
+    default:
+        rc = PS_UNSUPPORTED_FAIL;
+        break;
+    }
+    if (rc < 0)
+    {
+        psFree(pc, pool);
+        return rc;
+    }
+    *precomp = pc;
+    return PS_SUCCESS;
+}
+
+void psPubKeyPrecompFree(psPubKeyPrecomp_t *precomp)
+{
+    if (precomp == NULL)
+    {
+        return;
+    }
+#  ifdef USE_RSA
+    if (precomp->key->type == PS_RSA)
+    {
+        pstm_modctx_clear(&precomp->nCtx);
+    }
+#  endif
+#  ifdef USE_ECC
+    if (precomp->comb)
+    {
+        psFree(precomp->comb, precomp->pool);
+    }
+#  endif
+    psFree(precomp, precomp->pool);
+}
+# endif /* USE_PUBKEY_PRECOMP */
+
 # ifdef USE_PRIVATE_KEY_PARSING
 #  ifdef MATRIX_USE_FILE_SYSTEM
 #   if defined(USE_ECC) && defined(USE_RSA)
@@ -127,6 +215,7 @@ void psDeletePubKey(psPubKey_t **key)
   Return codes:
   1 RSA key
   2 ECC key
+  3 Ed25519 key, PKCS #8 only
   < 0 error
  */
 int32_t psParseUnknownPrivKeyMem(psPool_t *pool,
@@ -183,6 +272,12 @@ int32_t psParseUnknownPrivKeyMem(psPool_t *pool,
              {
                  keytype = 2;
              }
+#     ifdef USE_ED25519
+             else if (privkey->type == PS_ED25519)
+             {
+                 keytype = 3;
+             }
+#     endif
              goto parsed;
 #    endif  /* USE_PKCS8 */
          }
@@ -197,7 +292,7 @@ parsed:
          privkey->type = PS_RSA;
          privkey->keysize = psRsaSize(&privkey->key.rsa);
      }
-     else
+     else if (keytype == 2)
      {
          privkey->type = PS_ECC;
          privkey->keysize = psEccSize(&privkey->key.ecc);
@@ -214,6 +309,7 @@ parsed:
     Return codes:
         1 RSA key
         2 ECC key
+        3 Ed25519 key
         < 0 error
  */
 int32_t psParseUnknownPrivKey(psPool_t *pool, int pemOrDer,
@@ -226,6 +322,9 @@ int32_t psParseUnknownPrivKey(psPool_t *pool, int pemOrDer,
     unsigned char *keyBuf;
     int32 keyBufLen;
     int32_t rc;
+#    ifdef USE_ED25519
+    psSize_t derLen;
+#    endif
 
     privkey->keysize = 0;
     rsakey = &privkey->key.rsa;
@@ -240,6 +339,21 @@ int32_t psParseUnknownPrivKey(psPool_t *pool, int pemOrDer,
             if (psEccParsePrivFile(pool, keyfile, password, ecckey)
                 < PS_SUCCESS)
             {
+#    ifdef USE_ED25519
+                /* Other key types only come as PKCS #8 */
+                if (psPkcs1DecodePrivFile(pool, keyfile, password, &keyBuf,
+                        &derLen) == PS_SUCCESS)
+                {
+                    rc = psParseUnknownPrivKeyMem(pool, keyBuf, derLen,
+                        password, privkey);
+                    psFree(keyBuf, pool);
+                    if (rc > 0)
+                    {
+                        keytype = rc;
+                        goto out;
+                    }
+                }
+#    endif
                 psTraceStrCrypto("Unable to parse private key file %s\n",
                     keyfile);
                 return PS_FAILURE;
@@ -595,6 +709,24 @@ psRes_t psVerifySig(psPool_t *pool,
         }
         break;
 # endif /* USE_ECC */
+# ifdef USE_ED25519
+    case PS_ED25519:
+        /* Ed25519 signs the data itself, so hashIn is the whole message */
+        if (psEd25519Verify(&key->key.ed25519, hashIn, hashInLen,
+                sig, sigLen, &eccRet) < 0)
+        {
+            psTraceCrypto("Error decrypting request signature\n");
+            rc = PS_FAILURE;
+            goto out;
+        }
+        if (eccRet != 1)
+        {
+            psTraceCrypto("Error validating signature\n");
+            rc = PS_VERIFICATION_FAILED;
+            goto out;
+        }
+        break;
+# endif /* USE_ED25519 */
     default:
         psTraceCrypto("Unsupported pubkey algorithm\n");
         rc = PS_UNSUPPORTED_FAIL;
@@ -623,6 +755,25 @@ psRes_t psHashDataAndVerifySig(psPool_t *pool,
 
     *verifyResult = PS_FALSE;
 
+# ifdef USE_ED25519
+    if (key->type == PS_ED25519)
+    {
+        int32_t status;
+
+        if (psEd25519Verify(&key->key.ed25519, dataBegin, dataLen,
+                sig, sigLen, &status) < 0)
+        {
+            return PS_FAILURE;
+        }
+        if (status != 1)
+        {
+            return PS_VERIFICATION_FAILED;
+        }
+        *verifyResult = PS_TRUE;
+        return PS_SUCCESS;
+    }
+# endif /* USE_ED25519 */
+
     rc = psComputeHashForSig(dataBegin, dataLen,
         signatureAlgorithm, digest,
         &digestLen);
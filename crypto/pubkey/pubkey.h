@@ -74,6 +74,7 @@
 #  define IS_BRAIN256R1   0x00020000
 #  define IS_BRAIN384R1   0x00040000
 #  define IS_BRAIN512R1   0x00080000
+#  define IS_X25519       0x00100000
 /* TLS needs one bit of info (last bit) */
 #  define IS_RECVD_EXT    0x00800000
 
@@ -90,6 +91,7 @@ enum
     IANA_BRAIN256R1,
     IANA_BRAIN384R1,
     IANA_BRAIN512R1,
+    IANA_X25519,
 
     IANA_BRAIN224R1 = 255 /**< @note this is not defined by IANA */
 };
@@ -131,6 +133,37 @@ extern int32_t getEccParamByName(const char *curveName,
                                  const psEccCurve_t **curve);
 extern int32_t getEccParamByOid(uint32_t oid, const psEccCurve_t **curve);
 
+/** Queue of precomputed ECDSA signing nonces, see psEccNewPresign(). */
+typedef struct psEccPresign psEccPresign_t;
+
+#  ifdef USE_X25519
+/** True if the curve is X25519, which only supports key agreement. */
+#   define PS_ECC_IS_X25519(curve) ((curve) && (curve)->curveId == IANA_X25519)
+extern int32_t psX25519GenKey(psPool_t *pool, psEccKey_t *key, void *usrData);
+extern int32_t psX25519ImportKey(psPool_t *pool, const unsigned char *in,
+                                 psSize_t inlen, psEccKey_t *key);
+extern int32_t psX25519ExportKey(psPool_t *pool, const psEccKey_t *key,
+                                 unsigned char *out, psSize_t *outlen);
+extern int32_t psX25519SharedSecret(psPool_t *pool, const psEccKey_t *privKey,
+                                    const psEccKey_t *pubKey,
+                                    unsigned char *out, psSize_t *outlen);
+#  else
+#   define PS_ECC_IS_X25519(curve) 0
+#  endif
+
+#  ifdef USE_ED25519
+#   define ED25519_KEY_SIZE 32
+#   define ED25519_SIG_SIZE 64
+
+/** Ed25519 key. The private key is the 32 byte seed of RFC 8032. */
+typedef struct
+{
+    unsigned char pub[ED25519_KEY_SIZE];
+    unsigned char priv[ED25519_KEY_SIZE];   /* Only if type is PS_PRIVKEY */
+    uint8_t type;                           /* PS_PRIVKEY or PS_PUBKEY */
+} psEd25519Key_t;
+#  endif
+
 # endif
 
 /******************************************************************************/
@@ -166,7 +199,8 @@ enum PACKED
     PS_DSA,
     PS_ECC,
     PS_DH,
-    PS_CL_PK /* A public key for CL Library. May contain any key format. */
+    PS_CL_PK, /* A public key for CL Library. May contain any key format. */
+    PS_ED25519
 };
 
 /** Signature types */
@@ -175,7 +209,8 @@ enum PACKED
     RSA_TYPE_SIG = 5,
     ECDSA_TYPE_SIG,
     RSAPSS_TYPE_SIG,
-    DSA_TYPE_SIG
+    DSA_TYPE_SIG,
+    ED25519_TYPE_SIG
 };
 
 /**
@@ -197,14 +232,42 @@ typedef struct
 #  endif
 #  ifdef USE_DH
         psDhKey_t dh;
+#  endif
+#  ifdef USE_ED25519
+        psEd25519Key_t ed25519;
 #  endif
     }               key;
 # endif
     psPool_t *pool;
     psSize_t keysize;           /* in bytes. 512 max for RSA 4096 */
-    uint8_t type;               /* PS_RSA, PS_ECC, PS_DH */
+    uint8_t type;               /* PS_RSA, PS_ECC, PS_DH, PS_ED25519 */
 } psPubKey_t;
 
+# ifdef USE_PUBKEY_PRECOMP
+/**
+    Precomputed data for a public key that verifies many signatures, such as
+    the key of a trusted CA. Refers to the key it was computed from, so the
+    key must outlive it.
+ */
+typedef struct
+{
+    psPool_t *pool;
+    const psPubKey_t *key;      /* The key this was computed from */
+#  ifdef USE_RSA
+    pstm_modctx nCtx;           /* Reduction context of the modulus */
+#  endif
+#  ifdef USE_ECC
+    pstm_digit *comb;           /* Comb table of Q, see ecc.c */
+    psSize_t combSpacing;       /* Bits between the teeth of the comb */
+#  endif
+} psPubKeyPrecomp_t;
+
+#  ifdef USE_ECC
+extern int32_t psEccPrecompute(psPool_t *pool, const psEccKey_t *key,
+                               psPubKeyPrecomp_t *precomp);
+#  endif
+# endif /* USE_PUBKEY_PRECOMP */
+
 extern int32_t pkcs1Pad(const unsigned char *in, psSize_t inlen,
                         unsigned char *out, psSize_t outlen,
                         uint8_t cryptType, void *userPtr);
@@ -239,7 +302,8 @@ typedef struct
 } psVerifySigOptions_t;
 
 /*
-    Verify the signature of a digest.
+    Verify the signature of a digest. Ed25519 keys sign the message
+    itself, for them hashIn is the message.
  */
 psRes_t psVerifySig(psPool_t *pool,
                     const unsigned char hashIn[SHA512_HASH_SIZE],
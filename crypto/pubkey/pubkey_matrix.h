@@ -39,9 +39,14 @@
 
 # ifdef USE_MATRIX_RSA
 
+/* Values of psRsaKey_t.optimized */
+#  define PS_RSA_OPTIMIZED        1   /* CRT parameters are present */
+#  define PS_RSA_OPTIMIZED_CTX    2   /* ...and pCtx is set up */
+
 typedef struct
 {
     pstm_int e, d, N, qP, dP, dQ, p, q;
+    pstm_modctx pCtx;       /* Reduction mod p for the CRT recombination */
     psPool_t *pool;
     psSize_t size;          /* Size of the key in bytes */
     uint8_t optimized;      /* Set if optimized */
@@ -53,6 +58,13 @@ typedef struct
 
 # ifdef USE_MATRIX_ECC
 
+/** Equation of a psEccCurve_t */
+enum
+{
+    PS_ECC_CURVE_WEIERSTRASS = 0, /**< y^2 = x^3 + Ax + B, all the ECC math */
+    PS_ECC_CURVE_MONTGOMERY       /**< By^2 = x^3 + Ax^2 + x, key agreement */
+};
+
 /**
     An ECC curve.
     Including size, name, and domain parameters.
@@ -71,8 +83,13 @@ typedef struct
     const char *order;   /**< The order of the curve (ascii hex) */
     const char *Gx;      /**< The x coordinate of the base point (ascii hex) */
     const char *Gy;      /**< The y coordinate of the base point (ascii hex) */
+    uint8_t type;        /**< PS_ECC_CURVE_*, Weierstrass unless set */
 } psEccCurve_t;
 
+/** True if the generic point arithmetic and ECDSA can use the curve */
+#  define PS_ECC_IS_WEIERSTRASS(curve) \
+    ((curve)->type == PS_ECC_CURVE_WEIERSTRASS)
+
 /**
     A point on a ECC curve, stored in Jacbobian format such that
     (x,y,z) => (x/z^2, y/z^3, 1) when interpretted as affine.
@@ -106,6 +123,9 @@ typedef struct
     pstm_int g;     /* The Generator/Base value */
     psPool_t *pool;
     psSize_t size;  /* Size of 'p' in bytes */
+#  ifdef USE_DH_PRECOMP
+    pstm_fbctx *gComb; /* Comb of g, see psDhPrecomputeParams() */
+#  endif
 } psDhParams_t;
 
 typedef struct
@@ -280,6 +280,10 @@ void psRsaClearKey(psRsaKey_t *key)
     pstm_clear(&(key->dP));
     pstm_clear(&(key->dQ));
     pstm_clear(&(key->qP));
+    if (key->optimized == PS_RSA_OPTIMIZED_CTX)
+    {
+        pstm_modctx_clear(&key->pCtx);
+    }
     key->size = 0;
     key->optimized = 0;
     key->pool = NULL;
@@ -325,6 +329,12 @@ int32_t psRsaCopyKey(psRsaKey_t *to, const psRsaKey_t *from)
     to->size = from->size;
     to->optimized = from->optimized;
     to->pool = from->pool;
+    /* The context refers to 'from->p', set up one of our own */
+    if (to->optimized == PS_RSA_OPTIMIZED_CTX &&
+        pstm_modctx_init(to->pool, &to->pCtx, &to->p) != PSTM_OKAY)
+    {
+        to->optimized = PS_RSA_OPTIMIZED;
+    }
 error:
     if (err < 0)
     {
@@ -566,8 +576,14 @@ int32_t psRsaParsePkcs1PrivKey(psPool_t *pool,
      If we made it here, the key is ready for optimized decryption
      Set the key length of the key
  */
-    key->optimized = 1;
+    key->optimized = PS_RSA_OPTIMIZED;
     key->size = pstm_unsigned_bin_size(&key->N);
+    /* Precompute reduction mod p so decryption needs no long division.
+       Without it psRsaCrypt() falls back to pstm_mulmod(). */
+    if (pstm_modctx_init(pool, &key->pCtx, &key->p) == PSTM_OKAY)
+    {
+        key->optimized = PS_RSA_OPTIMIZED_CTX;
+    }
 
     /* Should be at the end */
     if (end != p)
@@ -591,24 +607,59 @@ int32_t psRsaParsePkcs1PrivKey(psPool_t *pool,
 #endif  /* USE_RSA */
 
 #ifdef USE_MATRIX_RSA
+# ifdef USE_RSA_PARALLEL_CRT
 /******************************************************************************/
-/**
-    Primary RSA crypto routine, with either public or private key.
+/*
+    Worker pool for computing the two CRT halves of a private key operation
+    concurrently. The calling thread computes the dP/p half while a worker
+    computes the dQ/q half.
+ */
+#  ifndef RSA_PARALLEL_CRT_THREADS
+#   define RSA_PARALLEL_CRT_THREADS 2
+#  endif
 
-    @param[in] pool Pool to use for temporary memory allocation for this op.
-    @param[in] key RSA key to use for this operation.
-    @param[in] in Pointer to allocated buffer to encrypt.
-    @param[in] inlen Number of bytes pointed to by 'in' to encrypt.
-    @param[out] out Pointer to allocated buffer to store encrypted data.
-    @param[out] outlen Number of bytes written to 'out' buffer.
-    @param[in] type PS_PRIVKEY or PS_PUBKEY.
-    @param[in] data TODO Hardware context.
+static psWorkerPool_t *rsaCrtWorkers;
 
-    @return 0 on success, < 0 on failure.
+typedef struct
+{
+    psPool_t *pool;
+    const pstm_int *G;
+    const pstm_int *X;
+    const pstm_int *P;
+    pstm_int *Y;
+    int32_t err;
+} psRsaCrtHalf_t;
 
-    @note 'out' and 'in' can be equal for in-situ operation.
+static void psRsaCrtHalfRun(void *arg)
+{
+    psRsaCrtHalf_t *half = arg;
+
+    half->err = pstm_exptmod(half->pool, half->G, half->X, half->P, half->Y);
+}
+
+int32_t psRsaParallelCrtOpen(void)
+{
+    if (rsaCrtWorkers != NULL)
+    {
+        return PS_SUCCESS;
+    }
+    return psWorkerPoolOpen(NULL, &rsaCrtWorkers, RSA_PARALLEL_CRT_THREADS);
+}
+
+void psRsaParallelCrtClose(void)
+{
+    psWorkerPoolClose(rsaCrtWorkers);
+    rsaCrtWorkers = NULL;
+}
+# endif /* USE_RSA_PARALLEL_CRT */
+
+/******************************************************************************/
+/*
+    psRsaCrypt() with an optional reduction context for the modulus, used
+    by public key operations.
  */
-int32_t psRsaCrypt(psPool_t *pool, psRsaKey_t *key,
+static int32_t psRsaCryptCtx(psPool_t *pool, psRsaKey_t *key,
+    const pstm_modctx *nCtx,
     const unsigned char *in, psSize_t inlen,
     unsigned char *out, psSize_t *outlen,
     uint8_t type, void *data)
@@ -616,6 +667,10 @@ int32_t psRsaCrypt(psPool_t *pool, psRsaKey_t *key,
     pstm_int tmp, tmpa, tmpb;
     int32_t res;
     uint32_t x;
+# ifdef USE_RSA_PARALLEL_CRT
+    psRsaCrtHalf_t half;
+    psWorkerJob_t job;
+# endif
 
     if (in == NULL || out == NULL || outlen == NULL || key == NULL)
     {
@@ -657,6 +712,30 @@ int32_t psRsaCrypt(psPool_t *pool, psRsaKey_t *key,
                 res = PS_FAILURE;
                 goto done;
             }
+# ifdef USE_RSA_PARALLEL_CRT
+            /* Hand the q half to a worker and compute the p half here.
+               Both only read 'tmp' and the key, and write separate outputs. */
+            half.pool = pool;
+            half.G = &tmp;
+            half.X = &key->dQ;
+            half.P = &key->q;
+            half.Y = &tmpb;
+            half.err = PS_FAILURE;
+            psWorkerJobInit(&job, psRsaCrtHalfRun, &half);
+            psWorkerPoolSubmit(rsaCrtWorkers, &job);
+            res = pstm_exptmod(pool, &tmp, &key->dP, &key->p, &tmpa);
+            psWorkerJobWait(rsaCrtWorkers, &job);
+            if (res != PS_SUCCESS)
+            {
+                psTraceCrypto("decrypt error: pstm_exptmod dP, p\n");
+                goto error;
+            }
+            if (half.err != PS_SUCCESS)
+            {
+                psTraceCrypto("decrypt error: pstm_exptmod dQ, q\n");
+                goto error;
+            }
+# else
             if (pstm_exptmod(pool, &tmp, &key->dP, &key->p, &tmpa) !=
                 PS_SUCCESS)
             {
@@ -669,12 +748,29 @@ int32_t psRsaCrypt(psPool_t *pool, psRsaKey_t *key,
                 psTraceCrypto("decrypt error: pstm_exptmod dQ, q\n");
                 goto error;
             }
+# endif /* USE_RSA_PARALLEL_CRT */
             if (pstm_sub(&tmpa, &tmpb, &tmp) != PS_SUCCESS)
             {
                 psTraceCrypto("decrypt error: sub tmpb, tmp\n");
                 goto error;
             }
-            if (pstm_mulmod(pool, &tmp, &key->qP, &key->p, &tmp) != PS_SUCCESS)
+            if (key->optimized == PS_RSA_OPTIMIZED_CTX)
+            {
+                /* tmpa - tmpb is in (-q, p), move it into [0, p) first */
+                while (tmp.sign == PSTM_NEG)
+                {
+                    if (pstm_add(&tmp, &key->p, &tmp) != PS_SUCCESS)
+                    {
+                        goto error;
+                    }
+                }
+                res = pstm_mulmod_ctx(pool, &key->pCtx, &tmp, &key->qP, &tmp);
+            }
+            else
+            {
+                res = pstm_mulmod(pool, &tmp, &key->qP, &key->p, &tmp);
+            }
+            if (res != PS_SUCCESS)
             {
                 psTraceCrypto("decrypt error: pstm_mulmod qP, p\n");
                 goto error;
@@ -703,7 +799,24 @@ int32_t psRsaCrypt(psPool_t *pool, psRsaKey_t *key,
     }
     else if (type == PS_PUBKEY)
     {
-        if (pstm_exptmod(pool, &tmp, &key->e, &key->N, &tmp) != PS_SUCCESS)
+        /* Small public exponents (3, 17, 65537...) do not benefit from the
+           sliding window in pstm_exptmod */
+        if (pstm_count_bits(&key->e) <= PSTM_EXPTMOD_SHORT_MAX_BITS)
+        {
+            if (nCtx != NULL)
+            {
+                res = pstm_exptmod_short_ctx(pool, &tmp, &key->e, nCtx, &tmp);
+            }
+            else
+            {
+                res = pstm_exptmod_short(pool, &tmp, &key->e, &key->N, &tmp);
+            }
+        }
+        else
+        {
+            res = pstm_exptmod(pool, &tmp, &key->e, &key->N, &tmp);
+        }
+        if (res != PS_SUCCESS)
         {
             psTraceCrypto("psRsaCrypt error: pstm_exptmod\n");
             goto error;
@@ -754,6 +867,64 @@ done:
     return res;
 }
 
+/******************************************************************************/
+/**
+    Primary RSA crypto routine, with either public or private key.
+
+    @param[in] pool Pool to use for temporary memory allocation for this op.
+    @param[in] key RSA key to use for this operation.
+    @param[in] in Pointer to allocated buffer to encrypt.
+    @param[in] inlen Number of bytes pointed to by 'in' to encrypt.
+    @param[out] out Pointer to allocated buffer to store encrypted data.
+    @param[out] outlen Number of bytes written to 'out' buffer.
+    @param[in] type PS_PRIVKEY or PS_PUBKEY.
+    @param[in] data TODO Hardware context.
+
+    @return 0 on success, < 0 on failure.
+
+    @note 'out' and 'in' can be equal for in-situ operation.
+ */
+int32_t psRsaCrypt(psPool_t *pool, psRsaKey_t *key,
+    const unsigned char *in, psSize_t inlen,
+    unsigned char *out, psSize_t *outlen,
+    uint8_t type, void *data)
+{
+    return psRsaCryptCtx(pool, key, NULL, in, inlen, out, outlen, type, data);
+}
+
+# ifdef USE_PUBKEY_PRECOMP
+/******************************************************************************/
+/*
+    Return the reduction context of 'precomp' if it was computed for 'key'.
+ */
+static const pstm_modctx *rsaPrecompCtx(const psRsaKey_t *key,
+    const psPubKeyPrecomp_t *precomp)
+{
+    if (precomp != NULL && precomp->key->type == PS_RSA &&
+        &precomp->key->key.rsa == key)
+    {
+        return &precomp->nCtx;
+    }
+    return NULL;
+}
+
+/**
+    psRsaCrypt() using the precomputed data of a public key.
+
+    @param[in] precomp Data from psPubKeyPrecompute() on the public key that
+    contains 'key', or NULL. Ignored if computed for another key.
+ */
+int32_t psRsaCryptExt(psPool_t *pool, psRsaKey_t *key,
+    const psPubKeyPrecomp_t *precomp,
+    const unsigned char *in, psSize_t inlen,
+    unsigned char *out, psSize_t *outlen,
+    uint8_t type, void *data)
+{
+    return psRsaCryptCtx(pool, key, rsaPrecompCtx(key, precomp),
+        in, inlen, out, outlen, type, data);
+}
+# endif /* USE_PUBKEY_PRECOMP */
+
 /******************************************************************************/
 /**
     RSA private encryption. This is used by a private key holder to sign
@@ -957,24 +1128,11 @@ int32_t psRsaDecryptPriv(psPool_t *pool, psRsaKey_t *key,
 }
 
 /******************************************************************************/
-/**
-    RSA public decryption. This is used by a public key holder to verify
-    a signature by the private key holder, who signs using psRsaEncryptPriv().
-
-    @param[in] pool Pool to use for temporary memory allocation for this op.
-    @param[in] key RSA key to use for this operation.
-    @param[in,out] in Pointer to allocated buffer to encrypt.
-    @param[in] inlen Number of bytes pointed to by 'in' to encrypt.
-    @param[out] out Pointer to allocated buffer to store encrypted data.
-    @param[in] outlen length of expected output.
-    @param[in] data TODO Hardware context.
-
-    @return 0 on success, < 0 on failure.
-
-    TODO -fix
-    @note this function writes over the 'in' buffer
+/*
+    psRsaDecryptPub() with an optional reduction context for the modulus.
  */
-int32_t psRsaDecryptPub(psPool_t *pool, psRsaKey_t *key,
+static int32_t psRsaDecryptPubCtx(psPool_t *pool, psRsaKey_t *key,
+    const pstm_modctx *nCtx,
     unsigned char *in, psSize_t inlen,
     unsigned char *out, psSize_t outlen,
     void *data)
@@ -988,7 +1146,7 @@ int32_t psRsaDecryptPub(psPool_t *pool, psRsaKey_t *key,
         return PS_ARG_FAIL;
     }
     ptLen = inlen;
-    if ((err = psRsaCrypt(pool, key, in, inlen, in, &ptLen,
+    if ((err = psRsaCryptCtx(pool, key, nCtx, in, inlen, in, &ptLen,
              PS_PUBKEY, data)) < PS_SUCCESS)
     {
         psTraceCrypto("Error performing psRsaDecryptPub\n");
@@ -1006,6 +1164,50 @@ int32_t psRsaDecryptPub(psPool_t *pool, psRsaKey_t *key,
     return PS_SUCCESS;
 }
 
+/******************************************************************************/
+/**
+    RSA public decryption. This is used by a public key holder to verify
+    a signature by the private key holder, who signs using psRsaEncryptPriv().
+
+    @param[in] pool Pool to use for temporary memory allocation for this op.
+    @param[in] key RSA key to use for this operation.
+    @param[in,out] in Pointer to allocated buffer to encrypt.
+    @param[in] inlen Number of bytes pointed to by 'in' to encrypt.
+    @param[out] out Pointer to allocated buffer to store encrypted data.
+    @param[in] outlen length of expected output.
+    @param[in] data TODO Hardware context.
+
+    @return 0 on success, < 0 on failure.
+
+    TODO -fix
+    @note this function writes over the 'in' buffer
+ */
+int32_t psRsaDecryptPub(psPool_t *pool, psRsaKey_t *key,
+    unsigned char *in, psSize_t inlen,
+    unsigned char *out, psSize_t outlen,
+    void *data)
+{
+    return psRsaDecryptPubCtx(pool, key, NULL, in, inlen, out, outlen, data);
+}
+
+# ifdef USE_PUBKEY_PRECOMP
+/**
+    psRsaDecryptPub() using the precomputed data of a public key.
+
+    @param[in] precomp Data from psPubKeyPrecompute() on the public key that
+    contains 'key', or NULL. Ignored if computed for another key.
+ */
+int32_t psRsaDecryptPubExt(psPool_t *pool, psRsaKey_t *key,
+    const psPubKeyPrecomp_t *precomp,
+    unsigned char *in, psSize_t inlen,
+    unsigned char *out, psSize_t outlen,
+    void *data)
+{
+    return psRsaDecryptPubCtx(pool, key, rsaPrecompCtx(key, precomp),
+        in, inlen, out, outlen, data);
+}
+# endif /* USE_PUBKEY_PRECOMP */
+
 #endif  /* USE_MATRIX_RSA */
 
 /******************************************************************************/
@@ -1705,6 +1705,8 @@ static int32 psDesTest(void)
 #endif /* DES */
 
 #ifdef USE_PKCS5
+/* Define PBKDF2_TIMING to also time PBKDF2_ROUNDS iterations */
+# define PBKDF2_ROUNDS 100000
 int32 psPBKDF2(void)
 {
     int32 i;
@@ -1727,6 +1729,42 @@ int32 psPBKDF2(void)
             0x36, 0x62, 0xc0, 0xe4, 0x4a, 0x8b, 0x29, 0x1a, 0x96, 0x4c, 0xf2,
             0xf0, 0x70, 0x38 } }
     };
+    unsigned char shaKey[64];
+    static struct
+    {
+        psCipherType_e hash;
+        int32 rounds, dkLen;
+        unsigned char *pass, *salt;
+        unsigned char output[64];
+    } shaTests[] = {
+#  ifdef USE_SHA256
+        { HASH_SHA256, 1, 32, (unsigned char *) "password", (unsigned char *) "salt",
+          { 0x12, 0x0f, 0xb6, 0xcf, 0xfc, 0xf8, 0xb3, 0x2c, 0x43, 0xe7, 0x22,
+            0x52, 0x56, 0xc4, 0xf8, 0x37, 0xa8, 0x65, 0x48, 0xc9, 0x2c, 0xcc,
+            0x35, 0x48, 0x08, 0x05, 0x98, 0x7c, 0xb7, 0x0b, 0xe1, 0x7b } },
+        { HASH_SHA256, 4096, 40, (unsigned char *) "passwordPASSWORDpassword",
+          (unsigned char *) "saltSALTsaltSALTsaltSALTsaltSALTsalt",
+          { 0x34, 0x8c, 0x89, 0xdb, 0xcb, 0xd3, 0x2b, 0x2f, 0x32, 0xd8, 0x14,
+            0xb8, 0x11, 0x6e, 0x84, 0xcf, 0x2b, 0x17, 0x34, 0x7e, 0xbc, 0x18,
+            0x00, 0x18, 0x1c, 0x4e, 0x2a, 0x1f, 0xb8, 0xdd, 0x53, 0xe1, 0xc6,
+            0x35, 0x51, 0x8c, 0x7d, 0xac, 0x47, 0xe9 } },
+#  endif
+#  ifdef USE_SHA512
+        { HASH_SHA512, 4096, 64, (unsigned char *) "password", (unsigned char *) "salt",
+          { 0xd1, 0x97, 0xb1, 0xb3, 0x3d, 0xb0, 0x14, 0x3e, 0x01, 0x8b, 0x12,
+            0xf3, 0xd1, 0xd1, 0x47, 0x9e, 0x6c, 0xde, 0xbd, 0xcc, 0x97, 0xc5,
+            0xc0, 0xf8, 0x7f, 0x69, 0x02, 0xe0, 0x72, 0xf4, 0x57, 0xb5, 0x14,
+            0x3f, 0x30, 0x60, 0x26, 0x41, 0xb3, 0xd5, 0x5c, 0xd3, 0x35, 0x98,
+            0x8c, 0xb3, 0x6b, 0x84, 0x37, 0x60, 0x60, 0xec, 0xd5, 0x32, 0xe0,
+            0x39, 0xb7, 0x42, 0xa2, 0x39, 0x43, 0x4a, 0xf2, 0xd5 } },
+#  endif
+        { HASH_SHA1, 2, 20, (unsigned char *) "password", (unsigned char *) "salt",
+          { 0xea, 0x6c, 0x01, 0x4d, 0xc7, 0x2d, 0x6f, 0x8c, 0xcd, 0x1e, 0xd9,
+            0x2a, 0xce, 0x1d, 0x41, 0xf0, 0xd8, 0xde, 0x89, 0x57 } }
+    };
+# ifdef PBKDF2_TIMING
+    psTime_t start, end;
+# endif
 
     for (i = 0; i < (int32) (sizeof(tests) / sizeof(tests[0])); i++)
     {
@@ -1743,6 +1781,39 @@ int32 psPBKDF2(void)
             _psTrace("PASSED\n");
         }
     }
+
+    for (i = 0; i < (int32) (sizeof(shaTests) / sizeof(shaTests[0])); i++)
+    {
+        _psTraceInt("	PBKDF2-HMAC-SHA2 known vector test %d... ", i + 1);
+        if (psPkcs5Pbkdf2Hmac(shaTests[i].hash, shaTests[i].pass,
+                (uint32) strlen((char *) shaTests[i].pass),
+                shaTests[i].salt, (uint32) strlen((char *) shaTests[i].salt),
+                shaTests[i].rounds, shaKey, shaTests[i].dkLen) < 0 ||
+            memcmp(shaKey, shaTests[i].output, shaTests[i].dkLen) != 0)
+        {
+            _psTrace("FAILED\n");
+        }
+        else
+        {
+            _psTrace("PASSED\n");
+        }
+    }
+
+# ifdef PBKDF2_TIMING
+    printf("Timing PBKDF2 with %d rounds\n", PBKDF2_ROUNDS);
+    psGetTime(&start, NULL);
+    psPkcs5Pbkdf2((unsigned char *) "password", 8, (unsigned char *) "salt", 4,
+        PBKDF2_ROUNDS, key, 24);
+    psGetTime(&end, NULL);
+    printf("HMAC-SHA1 24 byte key: %u msecs\n", psDiffMsecs(start, end, NULL));
+#  ifdef USE_SHA256
+    psGetTime(&start, NULL);
+    psPkcs5Pbkdf2Hmac(HASH_SHA256, (unsigned char *) "password", 8,
+        (unsigned char *) "salt", 4, PBKDF2_ROUNDS, shaKey, 32);
+    psGetTime(&end, NULL);
+    printf("HMAC-SHA256 32 byte key: %u msecs\n", psDiffMsecs(start, end, NULL));
+#  endif
+# endif /* PBKDF2_TIMING */
     return 0;
 }
 #endif /* PKCS5 */
@@ -3094,6 +3165,66 @@ static int32 psRsaSignTest(void)
 
     return PS_SUCCESS;
 }
+
+#  ifdef USE_MATRIX_RSA
+/*
+    Private key operations through the CRT, on the worker pool with
+    USE_RSA_PARALLEL_CRT, must match a plain exponentiation with d.
+ */
+static int32 psRsaCrtTest(void)
+{
+    psPool_t *pool = NULL;
+    psRsaKey_t privkey;
+    unsigned char in[512], crt[512], plain[512];
+    psSize_t crtLen, plainLen;
+    uint8_t optimized;
+    int32_t rc;
+    int i, j;
+
+    for (i = 0;
+         i < sizeof(rsa) / sizeof(rsa[0]) && rsa[i].size >= (MIN_RSA_BITS / 8);
+         i++)
+    {
+        _psTraceInt("	%d bit CRT against exponentiation with d...",
+            rsa[i].size * 8);
+        psRsaInitKey(pool, &privkey);
+        if (psRsaParsePkcs1PrivKey(pool, rsa[i].key, rsa[i].keysize,
+                &privkey) < 0 || privkey.optimized == 0)
+        {
+            _psTrace("FAILED: no CRT parameters\n");
+            psRsaClearKey(&privkey);
+            return PS_FAILURE;
+        }
+        optimized = privkey.optimized;
+        for (j = 0; j < 8; j++)
+        {
+            /* A random input below the modulus */
+            psGetPrngLocked(in, rsa[i].size, NULL);
+            in[0] &= 0x7F;
+            crtLen = plainLen = rsa[i].size;
+            rc = psRsaCrypt(pool, &privkey, in, rsa[i].size, crt, &crtLen,
+                PS_PRIVKEY, NULL);
+            if (rc == PS_SUCCESS)
+            {
+                privkey.optimized = 0;
+                rc = psRsaCrypt(pool, &privkey, in, rsa[i].size, plain,
+                    &plainLen, PS_PRIVKEY, NULL);
+                privkey.optimized = optimized;
+            }
+            if (rc != PS_SUCCESS || crtLen != plainLen ||
+                memcmp(crt, plain, crtLen) != 0)
+            {
+                _psTrace("FAILED: results differ\n");
+                psRsaClearKey(&privkey);
+                return PS_FAILURE;
+            }
+        }
+        psRsaClearKey(&privkey);
+        _psTrace(" PASSED\n");
+    }
+    return PS_SUCCESS;
+}
+#  endif /* USE_MATRIX_RSA */
 # endif /* USE_PRIVATE_KEY_PARSING */
 
 /******************************************************************************/
@@ -5175,6 +5306,452 @@ L_FAIL:
     return rc;
 }
 
+# ifdef USE_ECDSA_PRESIGN
+/*
+    Signatures made with precomputed nonces, across more signatures than
+    the queue holds, must verify, as must the plain psEccDsaSign() ones
+    of the same key. No two signatures of a message may share a nonce.
+ */
+static int32_t psEccPresignCurveTest(uint16_t curveId)
+{
+    psPool_t *pool = NULL;
+    psEccKey_t key = PS_ECC_STATIC_INIT;
+    psEccPresign_t *ps = NULL;
+    const psEccCurve_t *curve;
+    unsigned char in[128], out[160], prev[160];
+    psSize_t outlen, prevlen = 0;
+    int32_t status, rc = PS_FAIL;
+    int i;
+
+    if (getEccParamById(curveId, &curve) < 0)
+    {
+        return PS_FAIL;
+    }
+    _psTraceStr("	%s presigned signatures...", curve->name);
+    if (psEccGenKey(pool, &key, curve, NULL) < 0 ||
+        psEccNewPresign(pool, &key, 4, &ps) < 0)
+    {
+        _psTrace("FAILED: setup\n");
+        goto L_FAIL;
+    }
+    if (psGetPrngLocked(in, sizeof(in), NULL) < 0)
+    {
+        goto L_FAIL;
+    }
+    for (i = 0; i < 12; i++)
+    {
+        outlen = sizeof(out);
+        if (psEccDsaSignExt(pool, &key, ps, in, curve->size, out, &outlen,
+                i & 1, NULL) < 0)
+        {
+            _psTraceInt("FAILED: presigned signature %d\n", i);
+            goto L_FAIL;
+        }
+        if (psEccDsaVerify(pool, &key, in, curve->size, out + 2 * (i & 1),
+                outlen - 2 * (i & 1), &status, NULL) < 0 || status != 1)
+        {
+            _psTraceInt("FAILED: presigned signature %d didn't verify\n", i);
+            goto L_FAIL;
+        }
+        if (outlen == prevlen && memcmp(out, prev, outlen) == 0)
+        {
+            _psTraceInt("FAILED: signature %d repeated\n", i);
+            goto L_FAIL;
+        }
+        memcpy(prev, out, outlen);
+        prevlen = outlen;
+        /* A changed message must not verify */
+        in[0] ^= 0x01;
+        if (psEccDsaVerify(pool, &key, in, curve->size, out + 2 * (i & 1),
+                outlen - 2 * (i & 1), &status, NULL) == PS_SUCCESS &&
+            status == 1)
+        {
+            _psTraceInt("FAILED: signature %d verified a changed message\n", i);
+            goto L_FAIL;
+        }
+        in[0] ^= 0x01;
+
+        /* The same message signed without the queue */
+        outlen = sizeof(out);
+        if (psEccDsaSign(pool, &key, in, curve->size, out, &outlen, 0,
+                NULL) < 0 ||
+            psEccDsaVerify(pool, &key, in, curve->size, out, outlen,
+                &status, NULL) < 0 || status != 1)
+        {
+            _psTraceInt("FAILED: plain signature %d\n", i);
+            goto L_FAIL;
+        }
+    }
+    rc = PS_SUCCESS;
+    _psTrace(" PASSED\n");
+L_FAIL:
+    if (ps != NULL)
+    {
+        psEccDeletePresign(ps);
+    }
+    psEccClearKey(&key);
+    return rc;
+}
+
+static int32_t psEccPresignTest(void)
+{
+    if (psEccPresignCurveTest(IANA_SECP256R1) < 0 ||
+        psEccPresignCurveTest(IANA_SECP384R1) < 0)
+    {
+        return PS_FAIL;
+    }
+#  ifdef USE_SECP521R1
+    if (psEccPresignCurveTest(IANA_SECP521R1) < 0)
+    {
+        return PS_FAIL;
+    }
+#  endif
+    return PS_SUCCESS;
+}
+# endif /* USE_ECDSA_PRESIGN */
+
+# ifdef USE_X25519
+static int32_t x25519_kat(void)
+{
+    int32_t rc = PS_FAIL;
+    const psEccCurve_t *curve;
+    psEccKey_t a = PS_ECC_STATIC_INIT;
+    psEccKey_t b = PS_ECC_STATIC_INIT;
+    psEccKey_t b_imported = PS_ECC_STATIC_INIT;
+    unsigned char k[32], u[32], out[32], sab[32], sba[32];
+    psSize_t outlen, sablen, sbalen;
+    int i;
+
+/* RFC 7748, section 5.2 */
+    unsigned char scalar[] =
+    {
+        0xa5, 0x46, 0xe3, 0x6b, 0xf0, 0x52, 0x7c, 0x9d, 0x3b, 0x16, 0x15, 0x4b,
+        0x82, 0x46, 0x5e, 0xdd, 0x62, 0x14, 0x4c, 0x0a, 0xc1, 0xfc, 0x5a, 0x18,
+        0x50, 0x6a, 0x22, 0x44, 0xba, 0x44, 0x9a, 0xc4
+    };
+    unsigned char u_in[] =
+    {
+        0xe6, 0xdb, 0x68, 0x67, 0x58, 0x30, 0x30, 0xdb, 0x35, 0x94, 0xc1, 0xa4,
+        0x24, 0xb1, 0x5f, 0x7c, 0x72, 0x66, 0x24, 0xec, 0x26, 0xb3, 0x35, 0x3b,
+        0x10, 0xa9, 0x03, 0xa6, 0xd0, 0xab, 0x1c, 0x4c
+    };
+    unsigned char u_out[] =
+    {
+        0xc3, 0xda, 0x55, 0x37, 0x9d, 0xe9, 0xc6, 0x90, 0x8e, 0x94, 0xea, 0x4d,
+        0xf2, 0x8d, 0x08, 0x4f, 0x32, 0xec, 0xcf, 0x03, 0x49, 0x1c, 0x71, 0xf7,
+        0x54, 0xb4, 0x07, 0x55, 0x77, 0xa2, 0x85, 0x52
+    };
+/* RFC 7748, section 5.2: k = u = 9, result after 1 and 1000 iterations */
+    unsigned char iter1[] =
+    {
+        0x42, 0x2c, 0x8e, 0x7a, 0x62, 0x27, 0xd7, 0xbc, 0xa1, 0x35, 0x0b, 0x3e,
+        0x2b, 0xb7, 0x27, 0x9f, 0x78, 0x97, 0xb8, 0x7b, 0xb6, 0x85, 0x4b, 0x78,
+        0x3c, 0x60, 0xe8, 0x03, 0x11, 0xae, 0x30, 0x79
+    };
+    unsigned char iter1000[] =
+    {
+        0x68, 0x4c, 0xf5, 0x9b, 0xa8, 0x33, 0x09, 0x55, 0x28, 0x00, 0xef, 0x56,
+        0x6f, 0x2f, 0x4d, 0x3c, 0x1c, 0x38, 0x87, 0xc4, 0x93, 0x60, 0xe3, 0x87,
+        0x5f, 0x2e, 0xb9, 0x4d, 0x99, 0x53, 0x2c, 0x51
+    };
+/* RFC 7748, section 6.1 */
+    unsigned char alice_priv[] =
+    {
+        0x77, 0x07, 0x6d, 0x0a, 0x73, 0x18, 0xa5, 0x7d, 0x3c, 0x16, 0xc1, 0x72,
+        0x51, 0xb2, 0x66, 0x45, 0xdf, 0x4c, 0x2f, 0x87, 0xeb, 0xc0, 0x99, 0x2a,
+        0xb1, 0x77, 0xfb, 0xa5, 0x1d, 0xb9, 0x2c, 0x2a
+    };
+    unsigned char alice_pub[] =
+    {
+        0x85, 0x20, 0xf0, 0x09, 0x89, 0x30, 0xa7, 0x54, 0x74, 0x8b, 0x7d, 0xdc,
+        0xb4, 0x3e, 0xf7, 0x5a, 0x0d, 0xbf, 0x3a, 0x0d, 0x26, 0x38, 0x1a, 0xf4,
+        0xeb, 0xa4, 0xa9, 0x8e, 0xaa, 0x9b, 0x4e, 0x6a
+    };
+    unsigned char bob_pub[] =
+    {
+        0xde, 0x9e, 0xdb, 0x7d, 0x7b, 0x7d, 0xc1, 0xb4, 0xd3, 0x5b, 0x61, 0xc2,
+        0xec, 0xe4, 0x35, 0x37, 0x3f, 0x83, 0x43, 0xc8, 0x5b, 0x78, 0x67, 0x4d,
+        0xad, 0xfc, 0x7e, 0x14, 0x6f, 0x88, 0x2b, 0x4f
+    };
+    unsigned char secret[] =
+    {
+        0x4a, 0x5d, 0x9d, 0x5b, 0xa4, 0xce, 0x2d, 0xe1, 0x72, 0x8e, 0x3b, 0xf4,
+        0x80, 0x35, 0x0f, 0x25, 0xe0, 0x7e, 0x21, 0xc9, 0x47, 0xd1, 0x9e, 0x33,
+        0x76, 0xf0, 0x9b, 0x3c, 0x1e, 0x16, 0x17, 0x42
+    };
+
+    _psTrace("	X25519 known-answer test...");
+    if (psX25519(out, scalar, u_in) != PS_SUCCESS ||
+        memcmp(out, u_out, sizeof(out)) != 0)
+    {
+        _psTrace("X25519 scalar multiplication failed\n");
+        goto L_FAIL;
+    }
+
+    memset(k, 0x0, sizeof(k));
+    k[0] = 9;
+    memcpy(u, k, sizeof(u));
+    for (i = 1; i <= 1000; i++)
+    {
+        if (psX25519(out, k, u) != PS_SUCCESS)
+        {
+            _psTrace("X25519 iteration failed\n");
+            goto L_FAIL;
+        }
+        memcpy(u, k, sizeof(u));
+        memcpy(k, out, sizeof(k));
+        if ((i == 1 && memcmp(k, iter1, sizeof(k)) != 0) ||
+            (i == 1000 && memcmp(k, iter1000, sizeof(k)) != 0))
+        {
+            _psTrace("X25519 iteration result mismatch\n");
+            goto L_FAIL;
+        }
+    }
+
+    memset(u, 0x0, sizeof(u));
+    if (psX25519(out, alice_priv, u) != PS_FAILURE)
+    {
+        _psTrace("X25519 accepted a small order point\n");
+        goto L_FAIL;
+    }
+    u[0] = 9;
+    if (psX25519(out, alice_priv, u) != PS_SUCCESS ||
+        memcmp(out, alice_pub, sizeof(out)) != 0)
+    {
+        _psTrace("X25519 public key mismatch\n");
+        goto L_FAIL;
+    }
+    if (psX25519(out, alice_priv, bob_pub) != PS_SUCCESS ||
+        memcmp(out, secret, sizeof(out)) != 0)
+    {
+        _psTrace("X25519 shared secret mismatch\n");
+        goto L_FAIL;
+    }
+    _psTrace(" PASSED\n");
+
+    /* The same through the ECC key API, as used by TLS */
+    _psTrace("	X25519 key agreement test...");
+    if (getEccParamById(IANA_X25519, &curve) < 0)
+    {
+        goto L_FAIL;
+    }
+    if (psEccGenKey(NULL, &a, curve, NULL) < 0 ||
+        psEccGenKey(NULL, &b, curve, NULL) < 0)
+    {
+        _psTrace("X25519 key generation failed\n");
+        goto L_FAIL;
+    }
+    outlen = sizeof(out);
+    if (psEccX963ExportKey(NULL, &b, out, &outlen) < 0 ||
+        outlen != psEccX963Size(curve) ||
+        psEccX963ImportKey(NULL, out, outlen, &b_imported, curve) < 0)
+    {
+        _psTrace("X25519 key export/import failed\n");
+        goto L_FAIL;
+    }
+    sablen = sizeof(sab);
+    sbalen = sizeof(sba);
+    if (psEccGenSharedSecret(NULL, &a, &b_imported, sab, &sablen, NULL) < 0 ||
+        psEccGenSharedSecret(NULL, &b, &a, sba, &sbalen, NULL) < 0 ||
+        sablen != 32 || sbalen != 32 || memcmp(sab, sba, 32) != 0)
+    {
+        _psTrace("X25519 shared secrets differ\n");
+        goto L_FAIL;
+    }
+    /* The Weierstrass code must not take the Montgomery curve */
+    outlen = sizeof(out);
+    if (psEccDsaSign(NULL, &a, sab, 32, out, &outlen, 0, NULL) !=
+        PS_UNSUPPORTED_FAIL)
+    {
+        _psTrace("ECDSA accepted an X25519 key\n");
+        goto L_FAIL;
+    }
+    rc = PS_SUCCESS;
+    _psTrace(" PASSED\n");
+
+L_FAIL:
+    memzero_s(sab, sizeof(sab));
+    memzero_s(sba, sizeof(sba));
+    psEccClearKey(&a);
+    psEccClearKey(&b);
+    psEccClearKey(&b_imported);
+    return rc;
+}
+# endif /* USE_X25519 */
+
+# ifdef USE_ED25519
+static int32_t ed25519_vector(const unsigned char *seed,
+    const unsigned char *pub, const unsigned char *msg, psSizeL_t msgLen,
+    const unsigned char *sig)
+{
+    psEd25519Key_t key;
+    unsigned char out[ED25519_SIG_SIZE];
+    int32_t status;
+
+    if (psEd25519ImportPrivKey(&key, seed) != PS_SUCCESS ||
+        memcmp(key.pub, pub, ED25519_KEY_SIZE) != 0)
+    {
+        _psTrace("Ed25519 public key mismatch\n");
+        return PS_FAIL;
+    }
+    if (psEd25519Sign(&key, msg, msgLen, out) != PS_SUCCESS ||
+        memcmp(out, sig, ED25519_SIG_SIZE) != 0)
+    {
+        _psTrace("Ed25519 signature mismatch\n");
+        return PS_FAIL;
+    }
+    psEd25519ClearKey(&key);
+    if (psEd25519ImportPubKey(&key, pub) != PS_SUCCESS ||
+        psEd25519Verify(&key, msg, msgLen, sig, ED25519_SIG_SIZE,
+            &status) != PS_SUCCESS || status != 1)
+    {
+        _psTrace("Ed25519 verification failed\n");
+        return PS_FAIL;
+    }
+    /* A changed message must not verify */
+    memcpy(out, sig, ED25519_SIG_SIZE);
+    out[ED25519_SIG_SIZE - 1] ^= 0x01;
+    if (psEd25519Verify(&key, msg, msgLen, out, ED25519_SIG_SIZE,
+            &status) != PS_SUCCESS || status == 1)
+    {
+        _psTrace("Ed25519 accepted a modified signature\n");
+        return PS_FAIL;
+    }
+    return PS_SUCCESS;
+}
+
+static int32_t ed25519_kat(void)
+{
+    psEd25519Key_t key;
+    unsigned char sig[ED25519_SIG_SIZE];
+    int32_t status;
+    unsigned int carry;
+    int i;
+
+/* RFC 8032, section 7.1, TEST 1 to TEST 3 */
+    unsigned char seed1[] =
+    {
+        0x9d, 0x61, 0xb1, 0x9d, 0xef, 0xfd, 0x5a, 0x60, 0xba, 0x84, 0x4a, 0xf4,
+        0x92, 0xec, 0x2c, 0xc4, 0x44, 0x49, 0xc5, 0x69, 0x7b, 0x32, 0x69, 0x19,
+        0x70, 0x3b, 0xac, 0x03, 0x1c, 0xae, 0x7f, 0x60
+    };
+    unsigned char pub1[] =
+    {
+        0xd7, 0x5a, 0x98, 0x01, 0x82, 0xb1, 0x0a, 0xb7, 0xd5, 0x4b, 0xfe, 0xd3,
+        0xc9, 0x64, 0x07, 0x3a, 0x0e, 0xe1, 0x72, 0xf3, 0xda, 0xa6, 0x23, 0x25,
+        0xaf, 0x02, 0x1a, 0x68, 0xf7, 0x07, 0x51, 0x1a
+    };
+    unsigned char sig1[] =
+    {
+        0xe5, 0x56, 0x43, 0x00, 0xc3, 0x60, 0xac, 0x72, 0x90, 0x86, 0xe2, 0xcc,
+        0x80, 0x6e, 0x82, 0x8a, 0x84, 0x87, 0x7f, 0x1e, 0xb8, 0xe5, 0xd9, 0x74,
+        0xd8, 0x73, 0xe0, 0x65, 0x22, 0x49, 0x01, 0x55, 0x5f, 0xb8, 0x82, 0x15,
+        0x90, 0xa3, 0x3b, 0xac, 0xc6, 0x1e, 0x39, 0x70, 0x1c, 0xf9, 0xb4, 0x6b,
+        0xd2, 0x5b, 0xf5, 0xf0, 0x59, 0x5b, 0xbe, 0x24, 0x65, 0x51, 0x41, 0x43,
+        0x8e, 0x7a, 0x10, 0x0b
+    };
+    unsigned char seed2[] =
+    {
+        0x4c, 0xcd, 0x08, 0x9b, 0x28, 0xff, 0x96, 0xda, 0x9d, 0xb6, 0xc3, 0x46,
+        0xec, 0x11, 0x4e, 0x0f, 0x5b, 0x8a, 0x31, 0x9f, 0x35, 0xab, 0xa6, 0x24,
+        0xda, 0x8c, 0xf6, 0xed, 0x4f, 0xb8, 0xa6, 0xfb
+    };
+    unsigned char pub2[] =
+    {
+        0x3d, 0x40, 0x17, 0xc3, 0xe8, 0x43, 0x89, 0x5a, 0x92, 0xb7, 0x0a, 0xa7,
+        0x4d, 0x1b, 0x7e, 0xbc, 0x9c, 0x98, 0x2c, 0xcf, 0x2e, 0xc4, 0x96, 0x8c,
+        0xc0, 0xcd, 0x55, 0xf1, 0x2a, 0xf4, 0x66, 0x0c
+    };
+    unsigned char msg2[] =
+    {
+        0x72
+    };
+    unsigned char sig2[] =
+    {
+        0x92, 0xa0, 0x09, 0xa9, 0xf0, 0xd4, 0xca, 0xb8, 0x72, 0x0e, 0x82, 0x0b,
+        0x5f, 0x64, 0x25, 0x40, 0xa2, 0xb2, 0x7b, 0x54, 0x16, 0x50, 0x3f, 0x8f,
+        0xb3, 0x76, 0x22, 0x23, 0xeb, 0xdb, 0x69, 0xda, 0x08, 0x5a, 0xc1, 0xe4,
+        0x3e, 0x15, 0x99, 0x6e, 0x45, 0x8f, 0x36, 0x13, 0xd0, 0xf1, 0x1d, 0x8c,
+        0x38, 0x7b, 0x2e, 0xae, 0xb4, 0x30, 0x2a, 0xee, 0xb0, 0x0d, 0x29, 0x16,
+        0x12, 0xbb, 0x0c, 0x00
+    };
+    unsigned char seed3[] =
+    {
+        0xc5, 0xaa, 0x8d, 0xf4, 0x3f, 0x9f, 0x83, 0x7b, 0xed, 0xb7, 0x44, 0x2f,
+        0x31, 0xdc, 0xb7, 0xb1, 0x66, 0xd3, 0x85, 0x35, 0x07, 0x6f, 0x09, 0x4b,
+        0x85, 0xce, 0x3a, 0x2e, 0x0b, 0x44, 0x58, 0xf7
+    };
+    unsigned char pub3[] =
+    {
+        0xfc, 0x51, 0xcd, 0x8e, 0x62, 0x18, 0xa1, 0xa3, 0x8d, 0xa4, 0x7e, 0xd0,
+        0x02, 0x30, 0xf0, 0x58, 0x08, 0x16, 0xed, 0x13, 0xba, 0x33, 0x03, 0xac,
+        0x5d, 0xeb, 0x91, 0x15, 0x48, 0x90, 0x80, 0x25
+    };
+    unsigned char msg3[] =
+    {
+        0xaf, 0x82
+    };
+    unsigned char sig3[] =
+    {
+        0x62, 0x91, 0xd6, 0x57, 0xde, 0xec, 0x24, 0x02, 0x48, 0x27, 0xe6, 0x9c,
+        0x3a, 0xbe, 0x01, 0xa3, 0x0c, 0xe5, 0x48, 0xa2, 0x84, 0x74, 0x3a, 0x44,
+        0x5e, 0x36, 0x80, 0xd7, 0xdb, 0x5a, 0xc3, 0xac, 0x18, 0xff, 0x9b, 0x53,
+        0x8d, 0x16, 0xf2, 0x90, 0xae, 0x67, 0xf7, 0x60, 0x98, 0x4d, 0xc6, 0x59,
+        0x4a, 0x7c, 0x15, 0xe9, 0x71, 0x6e, 0xd2, 0x8d, 0xc0, 0x27, 0xbe, 0xce,
+        0xea, 0x1e, 0xc4, 0x0a
+    };
+/* The group order L, little endian */
+    unsigned char order[] =
+    {
+        0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2,
+        0xde, 0xf9, 0xde, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10
+    };
+
+    _psTrace("	Ed25519 known-answer test...");
+    if (ed25519_vector(seed1, pub1, NULL, 0, sig1) != PS_SUCCESS ||
+        ed25519_vector(seed2, pub2, msg2, sizeof(msg2), sig2) != PS_SUCCESS ||
+        ed25519_vector(seed3, pub3, msg3, sizeof(msg3), sig3) != PS_SUCCESS)
+    {
+        return PS_FAIL;
+    }
+
+    /* S + L verifies mathematically but must be rejected as non canonical */
+    memcpy(sig, sig1, sizeof(sig));
+    carry = 0;
+    for (i = 0; i < 32; i++)
+    {
+        carry += sig[32 + i] + order[i];
+        sig[32 + i] = (unsigned char) carry;
+        carry >>= 8;
+    }
+    if (psEd25519ImportPubKey(&key, pub1) != PS_SUCCESS ||
+        psEd25519Verify(&key, NULL, 0, sig, sizeof(sig),
+            &status) != PS_SUCCESS || status == 1)
+    {
+        _psTrace("Ed25519 accepted a non canonical signature\n");
+        return PS_FAIL;
+    }
+    _psTrace(" PASSED\n");
+
+    _psTrace("	Ed25519 sign/verify test...");
+    if (psEd25519GenKey(NULL, &key, NULL) != PS_SUCCESS ||
+        psEd25519Sign(&key, msg3, sizeof(msg3), sig) != PS_SUCCESS ||
+        psEd25519Verify(&key, msg3, sizeof(msg3), sig, sizeof(sig),
+            &status) != PS_SUCCESS || status != 1 ||
+        psEd25519Verify(&key, msg2, sizeof(msg2), sig, sizeof(sig),
+            &status) != PS_SUCCESS || status == 1)
+    {
+        _psTrace("Ed25519 generated key failed\n");
+        psEd25519ClearKey(&key);
+        return PS_FAIL;
+    }
+    psEd25519ClearKey(&key);
+    _psTrace(" PASSED\n");
+    return PS_SUCCESS;
+}
+# endif /* USE_ED25519 */
+
 static int32_t psEccTest(void)
 {
     int32_t rc;
@@ -5199,28 +5776,673 @@ static int32_t psEccTest(void)
     }
 # endif /* USE_SECP521R1 */
 
+# ifdef USE_X25519
+    rc = x25519_kat();
+    if (rc != PS_SUCCESS)
+    {
+        return rc;
+    }
+# endif /* USE_X25519 */
+
+# ifdef USE_ED25519
+    rc = ed25519_kat();
+    if (rc != PS_SUCCESS)
+    {
+        return rc;
+    }
+# endif /* USE_ED25519 */
+
     rc = psEccPairwiseTest();
     if (rc != PS_SUCCESS)
     {
         return rc;
     }
 
+# ifdef USE_ECDSA_PRESIGN
+    rc = psEccPresignTest();
+    if (rc != PS_SUCCESS)
+    {
+        return rc;
+    }
+# endif /* USE_ECDSA_PRESIGN */
+
     return PS_SUCCESS;
 }
 #endif /* USE_ECC */
 
+#ifdef USE_DH
 /******************************************************************************/
-
-/******************************************************************************/
-
-typedef struct
+/*
+    Keys generated for an RFC 7919 group must agree with a plain
+    exponentiation of the generator, and with keys made without the comb.
+ */
+static int32_t psDhGroupTest(uint16_t group, const char *name)
 {
-    int32 (*fn)(void);
-    char name[64];
-} test_t;
-
-static test_t tests[] = {
-#ifdef USE_AES
+    psDhParams_t params;
+    psDhKey_t k1, k2;
+    pstm_int pub;
+    unsigned char *p, *g;
+    unsigned char s1[512], s2[512];
+    psSize_t pLen, gLen, s1len, s2len;
+    int32_t rc = PS_FAIL;
+
+    _psTraceStr("	%s key exchange...", name);
+    p = g = NULL;
+    memset(&k1, 0x0, sizeof(k1));
+    memset(&k2, 0x0, sizeof(k2));
+    if (psDhLoadNamedGroup(NULL, group, &params) < 0)
+    {
+        _psTrace("FAILED: psDhLoadNamedGroup\n");
+        return PS_FAIL;
+    }
+    if (pstm_init(NULL, &pub) != PS_SUCCESS)
+    {
+        psPkcs3ClearDhParams(&params);
+        return PS_FAIL;
+    }
+    if (psDhGenKeyParams(NULL, &params, &k1, NULL) < 0 ||
+        psDhGenKeyInts(NULL, params.size, &params.p, &params.g, &k2,
+            NULL) < 0)
+    {
+        _psTrace("FAILED: key generation\n");
+        goto L_FAIL;
+    }
+    if (pstm_exptmod(NULL, &params.g, &k1.priv, &params.p, &pub)
+        != PS_SUCCESS || pstm_cmp(&pub, &k1.pub) != PSTM_EQ)
+    {
+        _psTrace("FAILED: public key mismatch\n");
+        goto L_FAIL;
+    }
+    if (psDhExportParameters(NULL, &params, &p, &pLen, &g, &gLen) < 0)
+    {
+        goto L_FAIL;
+    }
+    s1len = sizeof(s1);
+    s2len = sizeof(s2);
+    if (psDhGenSharedSecret(NULL, &k1, &k2, p, pLen, s1, &s1len, NULL) < 0 ||
+        psDhGenSharedSecret(NULL, &k2, &k1, p, pLen, s2, &s2len, NULL) < 0 ||
+        s1len != s2len || memcmp(s1, s2, s1len) != 0)
+    {
+        _psTrace("FAILED: shared secret mismatch\n");
+        goto L_FAIL;
+    }
+    _psTrace(" PASSED\n");
+    rc = PS_SUCCESS;
+
+L_FAIL:
+    if (p)
+    {
+        psFree(p, NULL);
+    }
+    if (g)
+    {
+        psFree(g, NULL);
+    }
+    pstm_clear(&pub);
+    psDhClearKey(&k1);
+    psDhClearKey(&k2);
+    psPkcs3ClearDhParams(&params);
+    return rc;
+}
+
+static int32_t psDhTest(void)
+{
+    if (psDhGroupTest(PS_DH_FFDHE2048, "ffdhe2048") < 0 ||
+        psDhGroupTest(PS_DH_FFDHE3072, "ffdhe3072") < 0 ||
+        psDhGroupTest(PS_DH_FFDHE4096, "ffdhe4096") < 0)
+    {
+        return PS_FAIL;
+    }
+    return PS_SUCCESS;
+}
+#endif /* USE_DH */
+
+#if defined(USE_MATRIX_RSA) || defined(USE_MATRIX_ECC) || defined(USE_MATRIX_DH)
+/******************************************************************************/
+/*
+    Differential tests of the pstm fast paths: random operands, mostly
+    around the sizes where the code changes strategy, must give the same
+    results as the plain routines.
+ */
+# define PSTM_TEST_ROUNDS    16
+
+/* Random 'a' of exactly 'bits' bits, odd if 'odd' is set */
+static int32_t pstmTestRandom(pstm_int *a, uint16_t bits, int odd)
+{
+    unsigned char buf[4096 / 8 * 2];
+    psSize_t len;
+    uint8_t top;
+
+    len = (bits + 7) / 8;
+    if (len == 0 || len > sizeof(buf))
+    {
+        return PS_ARG_FAIL;
+    }
+    if (psGetPrngLocked(buf, len, NULL) < 0)
+    {
+        return PS_FAILURE;
+    }
+    top = (uint8_t) (len * 8 - bits);
+    buf[0] &= 0xFF >> top;
+    buf[0] |= 0x80 >> top;
+    if (odd)
+    {
+        buf[len - 1] |= 0x01;
+    }
+    return pstm_read_unsigned_bin(a, buf, len);
+}
+
+/* Initialize the NULL terminated list 'v'. Clear it with pstmTestClear()
+   even on failure. */
+static int32_t pstmTestInit(pstm_int *v[])
+{
+    int i;
+
+    for (i = 0; v[i] != NULL; i++)
+    {
+        memset(v[i], 0x0, sizeof(pstm_int));
+    }
+    for (i = 0; v[i] != NULL; i++)
+    {
+        if (pstm_init(NULL, v[i]) != PSTM_OKAY)
+        {
+            return PS_MEM_FAIL;
+        }
+    }
+    return PS_SUCCESS;
+}
+
+static void pstmTestClear(pstm_int *v[])
+{
+    int i;
+
+    for (i = 0; v[i] != NULL; i++)
+    {
+        pstm_clear(v[i]);
+    }
+}
+
+# if defined(USE_MATRIX_RSA) || defined(USE_MATRIX_DH)
+/*
+    pstm_exptmod_short() for small exponents against pstm_exptmod(), for
+    every modulus size that pstm_exptmod() supports.
+ */
+static int32_t pstmExptmodShortTest(void)
+{
+    static const uint16_t sizes[] = { 512, 1024, 1536, 2048, 3072, 4096 };
+    pstm_int g, x, p, y1, y2;
+    pstm_int *all[] = { &g, &x, &p, &y1, &y2, NULL };
+    int32_t rc = PS_FAILURE;
+    int i, j;
+
+    _psTrace("	pstm_exptmod_short against pstm_exptmod...");
+    if (pstmTestInit(all) < 0)
+    {
+        goto L_FAIL;
+    }
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        for (j = 0; j < PSTM_TEST_ROUNDS; j++)
+        {
+            if (pstmTestRandom(&p, sizes[i], 1) < 0 ||
+                pstmTestRandom(&g, sizes[i] - 8, 0) < 0)
+            {
+                goto L_FAIL;
+            }
+            /* The common public exponents, then random ones up to the
+               longest the short path is meant for */
+            if (j == 0)
+            {
+                pstm_set(&x, 3);
+            }
+            else if (j == 1)
+            {
+                pstm_set(&x, 65537);
+            }
+            else if (pstmTestRandom(&x,
+                         1 + (j * 7) % PSTM_EXPTMOD_SHORT_MAX_BITS, 0) < 0)
+            {
+                goto L_FAIL;
+            }
+            if (pstm_exptmod_short(NULL, &g, &x, &p, &y1) != PSTM_OKAY ||
+                pstm_exptmod(NULL, &g, &x, &p, &y2) != PSTM_OKAY ||
+                pstm_cmp(&y1, &y2) != PSTM_EQ)
+            {
+                _psTraceInt("FAILED: %d bit modulus\n", sizes[i]);
+                goto L_FAIL;
+            }
+        }
+    }
+    _psTrace(" PASSED\n");
+    rc = PS_SUCCESS;
+L_FAIL:
+    pstmTestClear(all);
+    return rc;
+}
+# endif /* USE_MATRIX_RSA || USE_MATRIX_DH */
+
+/*
+    The reduction context routines against the plain ones, for odd moduli
+    of the curve orders' sizes, odd lengths and RSA/DH sizes. Operands
+    cover the fast path (reduced, and below R) and the fallback.
+ */
+static int32_t pstmModctxTest(void)
+{
+    static const uint16_t sizes[] = {
+        65, 130, 192, 224, 256, 384, 521, 1024, 1535, 2048, 4096
+    };
+    pstm_int a, b, m, c1, c2;
+    pstm_int *all[] = { &a, &b, &m, &c1, &c2, NULL };
+    pstm_modctx ctx;
+    uint16_t abits;
+    int32_t rc = PS_FAILURE;
+    int i, j;
+
+    _psTrace("	Reduction contexts against pstm_mulmod and pstm_mod...");
+    ctx.m = NULL;
+    if (pstmTestInit(all) < 0)
+    {
+        goto L_FAIL;
+    }
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        if (pstmTestRandom(&m, sizes[i], 1) < 0 ||
+            pstm_modctx_init(NULL, &ctx, &m) != PSTM_OKAY)
+        {
+            goto L_FAIL;
+        }
+        for (j = 0; j < PSTM_TEST_ROUNDS; j++)
+        {
+            /* Reduced operands, then ones that may be above m but below R,
+               then ones above R */
+            abits = sizes[i] - 1 - j % 4;
+            if (j >= PSTM_TEST_ROUNDS / 2)
+            {
+                abits = m.used * DIGIT_BIT - j % 2;
+            }
+            if (j == PSTM_TEST_ROUNDS - 1)
+            {
+                abits = (m.used + 1) * DIGIT_BIT;
+            }
+            if (pstmTestRandom(&a, abits, j & 1) < 0 ||
+                pstmTestRandom(&b, sizes[i] - 1, 0) < 0)
+            {
+                goto L_FAIL;
+            }
+            if (j == 0)
+            {
+                /* m - 1 squared */
+                if (pstm_sub_d(NULL, &m, 1, &a) != PSTM_OKAY ||
+                    pstm_copy(&a, &b) != PSTM_OKAY)
+                {
+                    goto L_FAIL;
+                }
+            }
+            if (pstm_mulmod_ctx(NULL, &ctx, &a, &b, &c1) != PSTM_OKAY ||
+                pstm_mulmod(NULL, &a, &b, &m, &c2) != PSTM_OKAY ||
+                pstm_cmp(&c1, &c2) != PSTM_EQ)
+            {
+                _psTraceInt("FAILED: pstm_mulmod_ctx, %d bit modulus\n",
+                    sizes[i]);
+                goto L_FAIL;
+            }
+            if (pstm_mod_ctx(NULL, &ctx, &a, &c1) != PSTM_OKAY ||
+                pstm_mod(NULL, &a, &m, &c2) != PSTM_OKAY ||
+                pstm_cmp(&c1, &c2) != PSTM_EQ)
+            {
+                _psTraceInt("FAILED: pstm_mod_ctx, %d bit modulus\n",
+                    sizes[i]);
+                goto L_FAIL;
+            }
+#  if defined(USE_MATRIX_RSA) || defined(USE_MATRIX_DH)
+            if (pstmTestRandom(&b, 1 + j * 2, 0) < 0)
+            {
+                goto L_FAIL;
+            }
+            /* c2 is a mod m from above */
+            if (pstm_exptmod_short_ctx(NULL, &c2, &b, &ctx, &a) != PSTM_OKAY ||
+                pstm_exptmod_short(NULL, &c2, &b, &m, &c1) != PSTM_OKAY ||
+                pstm_cmp(&a, &c1) != PSTM_EQ)
+            {
+                _psTraceInt("FAILED: pstm_exptmod_short_ctx, %d bit modulus\n",
+                    sizes[i]);
+                goto L_FAIL;
+            }
+#  endif
+        }
+        pstm_modctx_clear(&ctx);
+    }
+    _psTrace(" PASSED\n");
+    rc = PS_SUCCESS;
+L_FAIL:
+    pstm_modctx_clear(&ctx);
+    pstmTestClear(all);
+    return rc;
+}
+
+# ifdef USE_PSTM_KARATSUBA
+/* Sizes in digits around a Karatsuba cutoff whose products fit a pstm_int */
+static int pstmTestSizes(psSize_t cutoff, psSize_t sizes[12])
+{
+    static const int16_t delta[] = { -2, -1, 0, 1, 2 };
+    int i, n = 0;
+
+    for (i = 0; i < sizeof(delta) / sizeof(delta[0]); i++)
+    {
+        sizes[n++] = cutoff + delta[i];
+    }
+    for (i = 1; i < sizeof(delta) / sizeof(delta[0]) - 1; i++)
+    {
+        if (2 * cutoff + delta[i] <= PSTM_MAX_SIZE / 2)
+        {
+            sizes[n++] = 2 * cutoff + delta[i];
+        }
+    }
+    /* Odd sizes split unevenly at every level */
+    sizes[n++] = cutoff + cutoff / 2 + 1;
+    sizes[n++] = 3 * cutoff / 2 - 1;
+    return n;
+}
+
+/*
+    pstm_mul_comba() and pstm_sqr_comba(), which switch to Karatsuba at the
+    cutoffs, and the Karatsuba routines themselves with a small cutoff, so
+    that they recurse a few levels, against the comba routines.
+ */
+static int32_t pstmKaratsubaTest(void)
+{
+    pstm_int a, b, c1, c2;
+    pstm_int *all[] = { &a, &b, &c1, &c2, NULL };
+    psSize_t sizes[12], bsize;
+    pstm_digit *paD = NULL;
+    psSize_t paDlen;
+    int32_t rc = PS_FAILURE;
+    int i, j, n;
+
+    _psTrace("	Karatsuba multiplication against comba...");
+    paDlen = PSTM_KARATSUBA_SCRATCH_BOUND(PSTM_MAX_SIZE / 2);
+    if (pstmTestInit(all) < 0 || (paD = psMalloc(NULL, paDlen)) == NULL)
+    {
+        goto L_FAIL;
+    }
+    n = pstmTestSizes(PSTM_KARATSUBA_MUL_CUTOFF, sizes);
+    for (i = 0; i < n; i++)
+    {
+        for (j = 0; j < PSTM_TEST_ROUNDS; j++)
+        {
+            /* Balanced, then around the 3:4 ratio where pstm_mul_comba()
+               stops using Karatsuba */
+            bsize = sizes[i];
+            if (j % 4 == 1)
+            {
+                bsize = (3 * sizes[i] + 3) / 4;
+            }
+            else if (j % 4 == 2)
+            {
+                bsize = 3 * sizes[i] / 4 - 1;
+            }
+            if (pstmTestRandom(&a, sizes[i] * DIGIT_BIT, 0) < 0 ||
+                pstmTestRandom(&b, bsize * DIGIT_BIT, j & 1) < 0)
+            {
+                goto L_FAIL;
+            }
+            if (pstm_mul_comba_base(NULL, &a, &b, &c1, NULL, 0) != PSTM_OKAY ||
+                pstm_mul_comba(NULL, &a, &b, &c2, paD, paDlen) != PSTM_OKAY ||
+                pstm_cmp(&c1, &c2) != PSTM_EQ)
+            {
+                _psTraceInt("FAILED: pstm_mul_comba, %d digits\n", sizes[i]);
+                goto L_FAIL;
+            }
+            if (pstm_mul_karatsuba_cutoff(NULL, &a, &b, &c2, NULL, 0, 0)
+                != PSTM_OKAY || pstm_cmp(&c1, &c2) != PSTM_EQ)
+            {
+                _psTraceInt("FAILED: pstm_mul_karatsuba, %d digits\n",
+                    sizes[i]);
+                goto L_FAIL;
+            }
+        }
+    }
+    n = pstmTestSizes(PSTM_KARATSUBA_SQR_CUTOFF, sizes);
+    for (i = 0; i < n; i++)
+    {
+        for (j = 0; j < PSTM_TEST_ROUNDS; j++)
+        {
+            if (pstmTestRandom(&a, sizes[i] * DIGIT_BIT, j & 1) < 0)
+            {
+                goto L_FAIL;
+            }
+            if (pstm_sqr_comba_base(NULL, &a, &c1, NULL, 0) != PSTM_OKAY ||
+                pstm_sqr_comba(NULL, &a, &c2, paD, paDlen) != PSTM_OKAY ||
+                pstm_cmp(&c1, &c2) != PSTM_EQ)
+            {
+                _psTraceInt("FAILED: pstm_sqr_comba, %d digits\n", sizes[i]);
+                goto L_FAIL;
+            }
+            if (pstm_sqr_karatsuba_cutoff(NULL, &a, &c2, NULL, 0, 0)
+                != PSTM_OKAY || pstm_cmp(&c1, &c2) != PSTM_EQ)
+            {
+                _psTraceInt("FAILED: pstm_sqr_karatsuba, %d digits\n",
+                    sizes[i]);
+                goto L_FAIL;
+            }
+        }
+    }
+    _psTrace(" PASSED\n");
+    rc = PS_SUCCESS;
+L_FAIL:
+    if (paD != NULL)
+    {
+        psFree(paD, NULL);
+    }
+    pstmTestClear(all);
+    return rc;
+}
+
+/* Y = G**X mod P by square and multiply on the comba routines */
+static int32_t pstmTestExptmodBase(const pstm_int *G, const pstm_int *X,
+    const pstm_int *P, pstm_int *Y, pstm_int *t)
+{
+    int i;
+
+    pstm_set(Y, 1);
+    for (i = pstm_count_bits(X) - 1; i >= 0; i--)
+    {
+        if (pstm_sqr_comba_base(NULL, Y, t, NULL, 0) != PSTM_OKAY ||
+            pstm_mod(NULL, t, P, Y) != PSTM_OKAY)
+        {
+            return PS_FAILURE;
+        }
+        if ((X->dp[i / DIGIT_BIT] >> (i % DIGIT_BIT)) & 1)
+        {
+            if (pstm_mul_comba_base(NULL, Y, G, t, NULL, 0) != PSTM_OKAY ||
+                pstm_mod(NULL, t, P, Y) != PSTM_OKAY)
+            {
+                return PS_FAILURE;
+            }
+        }
+    }
+    return PS_SUCCESS;
+}
+
+/*
+    pstm_exptmod() on the modulus sizes below and above the points where
+    the Montgomery code switches to Karatsuba, against plain comba.
+ */
+static int32_t pstmntKaratsubaTest(void)
+{
+    static const uint16_t sizes[] = { 2048, 3072, 4096 };
+    pstm_int g, x, p, y1, y2, t;
+    pstm_int *all[] = { &g, &x, &p, &y1, &y2, &t, NULL };
+    int32_t rc = PS_FAILURE;
+    int i, j;
+
+    _psTrace("	pstm_exptmod across the Karatsuba cutoffs...");
+    if (pstmTestInit(all) < 0)
+    {
+        goto L_FAIL;
+    }
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        for (j = 0; j < PSTM_TEST_ROUNDS / 4; j++)
+        {
+            if (pstmTestRandom(&p, sizes[i], 1) < 0 ||
+                pstmTestRandom(&g, sizes[i] - 1 - j, 0) < 0 ||
+                pstmTestRandom(&x, 64 + j, 0) < 0)
+            {
+                goto L_FAIL;
+            }
+            if (pstmTestExptmodBase(&g, &x, &p, &y1, &t) < 0 ||
+                pstm_exptmod(NULL, &g, &x, &p, &y2) != PSTM_OKAY ||
+                pstm_cmp(&y1, &y2) != PSTM_EQ)
+            {
+                _psTraceInt("FAILED: %d bit modulus\n", sizes[i]);
+                goto L_FAIL;
+            }
+        }
+    }
+    _psTrace(" PASSED\n");
+    rc = PS_SUCCESS;
+L_FAIL:
+    pstmTestClear(all);
+    return rc;
+}
+# endif /* USE_PSTM_KARATSUBA */
+
+# ifdef PSTM_INLINE_DIGITS
+/*
+    Integers that start in the inline storage, against integers that are
+    always on the heap, at sizes on both sides of PSTM_INLINE_DIGITS. The
+    values must survive growing out of the inline storage, pstm_copy(),
+    pstm_exch() and pstm_init_copy() between the two kinds.
+ */
+static int32_t pstmInlineTest(void)
+{
+    static const int16_t delta[] = { -1, 0, 1 };
+    psSize_t sizes[6];
+    pstm_int a, b, c, ha, hb, hc, d;
+    pstm_int *all[] = { &a, &b, &c, &ha, &hb, &hc, &d, NULL };
+    psSize_t len = PSTM_INLINE_DIGITS * sizeof(pstm_digit);
+    int32_t rc = PS_FAILURE;
+    int i, j;
+
+    _psTrace("	Inline pstm_int digits against heap digits...");
+    for (i = 0; i < 3; i++)
+    {
+        sizes[i] = PSTM_INLINE_DIGITS / 2 + delta[i];
+        sizes[i + 3] = PSTM_INLINE_DIGITS + delta[i];
+    }
+    for (i = 0; all[i] != NULL; i++)
+    {
+        memset(all[i], 0x0, sizeof(pstm_int));
+    }
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        for (j = 0; j < PSTM_TEST_ROUNDS; j++)
+        {
+            /* Inline a, b and c, heap ha, hb and hc */
+            if (pstm_init_size(NULL, &a, 1) != PSTM_OKAY ||
+                pstm_init_size(NULL, &b, 1) != PSTM_OKAY ||
+                pstm_init_size(NULL, &c, 1) != PSTM_OKAY ||
+                pstm_init_for_read_unsigned_bin(NULL, &ha, len) != PSTM_OKAY ||
+                pstm_init_for_read_unsigned_bin(NULL, &hb, len) != PSTM_OKAY ||
+                pstm_init_for_read_unsigned_bin(NULL, &hc, len) != PSTM_OKAY)
+            {
+                goto L_FAIL;
+            }
+            if (pstmTestRandom(&a, sizes[i] * DIGIT_BIT - j, j & 1) < 0 ||
+                pstmTestRandom(&b, (sizes[i] - j % 2) * DIGIT_BIT, 0) < 0 ||
+                pstm_copy(&a, &ha) != PSTM_OKAY ||
+                pstm_copy(&b, &hb) != PSTM_OKAY)
+            {
+                goto L_FAIL;
+            }
+            /* The products leave the inline storage from the middle sizes on */
+            if (pstm_mul_comba(NULL, &a, &b, &c, NULL, 0) != PSTM_OKAY ||
+                pstm_mul_comba(NULL, &ha, &hb, &hc, NULL, 0) != PSTM_OKAY ||
+                pstm_cmp(&c, &hc) != PSTM_EQ)
+            {
+                _psTraceInt("FAILED: multiply, %d digits\n", sizes[i]);
+                goto L_FAIL;
+            }
+            /* Inline with inline, then inline with heap */
+            pstm_exch(&a, &b);
+            if (pstm_cmp(&a, &hb) != PSTM_EQ || pstm_cmp(&b, &ha) != PSTM_EQ)
+            {
+                _psTraceInt("FAILED: exchange, %d digits\n", sizes[i]);
+                goto L_FAIL;
+            }
+            pstm_exch(&a, &ha);
+            if (pstm_cmp(&a, &b) != PSTM_EQ || pstm_cmp(&ha, &hb) != PSTM_EQ)
+            {
+                _psTraceInt("FAILED: exchange, %d digits\n", sizes[i]);
+                goto L_FAIL;
+            }
+            /* Exchanged integers must still own their digits */
+            if (pstm_grow(&ha, PSTM_INLINE_DIGITS + 8) != PSTM_OKAY ||
+                pstm_grow(&b, PSTM_INLINE_DIGITS + 8) != PSTM_OKAY ||
+                pstm_cmp(&ha, &hb) != PSTM_EQ || pstm_cmp(&b, &a) != PSTM_EQ)
+            {
+                _psTraceInt("FAILED: grow, %d digits\n", sizes[i]);
+                goto L_FAIL;
+            }
+            if (pstm_init_copy(NULL, &d, &hc, 0) != PSTM_OKAY ||
+                pstm_cmp(&d, &c) != PSTM_EQ)
+            {
+                _psTraceInt("FAILED: copy, %d digits\n", sizes[i]);
+                goto L_FAIL;
+            }
+            /* Clearing leaves them ready for the next round's init */
+            pstmTestClear(all);
+        }
+    }
+    _psTrace(" PASSED\n");
+    rc = PS_SUCCESS;
+L_FAIL:
+    pstmTestClear(all);
+    return rc;
+}
+# endif /* PSTM_INLINE_DIGITS */
+
+static int32 psPstmTest(void)
+{
+# if defined(USE_MATRIX_RSA) || defined(USE_MATRIX_DH)
+    if (pstmExptmodShortTest() < 0)
+    {
+        return PS_FAILURE;
+    }
+# endif
+    if (pstmModctxTest() < 0)
+    {
+        return PS_FAILURE;
+    }
+# ifdef USE_PSTM_KARATSUBA
+    if (pstmKaratsubaTest() < 0 || pstmntKaratsubaTest() < 0)
+    {
+        return PS_FAILURE;
+    }
+# endif
+# ifdef PSTM_INLINE_DIGITS
+    if (pstmInlineTest() < 0)
+    {
+        return PS_FAILURE;
+    }
+# endif
+    return PS_SUCCESS;
+}
+#endif /* USE_MATRIX_RSA || USE_MATRIX_ECC || USE_MATRIX_DH */
+
+/******************************************************************************/
+
+/******************************************************************************/
+
+typedef struct
+{
+    int32 (*fn)(void);
+    char name[64];
+} test_t;
+
+static test_t tests[] = {
+#ifdef USE_AES
 # ifdef USE_AES_BLOCK
     { psAesTestBlock,         "***** AES BLOCK TESTS *****"                                                                },
 # endif
@@ -5366,6 +6588,20 @@ static test_t tests[] = {
 #endif
       , "***** RSA SIGN TESTS *****" },
 
+#if defined(USE_MATRIX_RSA) || defined(USE_MATRIX_ECC) || defined(USE_MATRIX_DH)
+    { psPstmTest
+#else
+    { NULL
+#endif
+      , "***** PSTM MATH TESTS *****" },
+
+#if defined(USE_MATRIX_RSA) && defined(USE_PRIVATE_KEY_PARSING)
+    { psRsaCrtTest
+#else
+    { NULL
+#endif
+      , "***** RSA CRT TESTS *****" },
+
 #if defined(USE_PKCS1_OAEP) && !defined(USE_HARDWARE_CRYPTO_PKA)
     { psRsaOaepVectorTest
 #else
@@ -5387,6 +6623,13 @@ static test_t tests[] = {
 #endif
       , "***** ECC TESTS *****" },
 
+#ifdef USE_DH
+    { psDhTest
+#else
+    { NULL
+#endif
+      , "***** DH TESTS *****" },
+
     { NULL
       , "***** PRF TESTS *****" },
 
@@ -174,6 +174,29 @@ int main(int argc, char **argv)
         }
         psGetTime(&end, NULL);
         _psTraceInt(TIME_UNITS " genInts\n", psDiffMsecs(start, end, NULL));
+#  ifdef USE_DH_PRECOMP
+        psGetTime(&start, NULL);
+        if (psDhPrecomputeParams(misc, &dhParams) < 0)
+        {
+            _psTrace("	FAILED OPERATION\n");
+        }
+        psGetTime(&end, NULL);
+        _psTraceInt(TIME_UNITS " precompute\n", psDiffMsecs(start, end, NULL));
+        iter = 0;
+        psGetTime(&start, NULL);
+        while (iter < keys[i].iter)
+        {
+            if (psDhGenKeyParams(pool, &dhParams, &dhKeyPriv, NULL) < 0)
+            {
+                _psTrace("	FAILED OPERATION\n");
+            }
+
+            psDhClearKey(&dhKeyPriv);
+            iter++;
+        }
+        psGetTime(&end, NULL);
+        _psTraceInt(TIME_UNITS " genParams\n", psDiffMsecs(start, end, NULL));
+#  endif /* USE_DH_PRECOMP */
 # endif /* DO_GEN_INTS */
 
 # ifdef DO_GEN_SECRET
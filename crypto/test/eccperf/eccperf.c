@@ -193,6 +193,82 @@ const static keyList_t keys[] = {
     { NULL }
 };
 
+# ifdef USE_ED25519
+/*
+    Ed25519 has its own key type, so it gets its own pass. The message is
+    the same random 32 bytes the ECDSA runs sign.
+ */
+static void ed25519Perf(psPool_t *pool, const unsigned char *in, uint32 inLen)
+{
+    psEd25519Key_t key;
+    unsigned char sig[ED25519_SIG_SIZE];
+    psTime_t start, end;
+    uint32 iter;
+    int32 t, validateStatus;
+
+    _psTraceStr("Testing %s...\n", "ed25519");
+#  ifdef MAKE_KEY_OP
+    psGetTime(&start, NULL);
+    for (iter = 0; iter < ITER; iter++)
+    {
+        if (psEd25519GenKey(pool, &key, NULL) < 0)
+        {
+            _psTrace("	FAILED OPERATION:GenKey\n");
+        }
+        else
+        {
+            psEd25519ClearKey(&key);
+        }
+    }
+    psGetTime(&end, NULL);
+    t = psDiffMsecs(start, end, NULL) / ITER;
+    _psTraceInt(TIME_UNITS "/genkey ", t);
+    _psTraceInt("(%d per sec)\n", PER_SEC(t));
+#  endif /* MAKE_KEY_OP */
+
+    if (psEd25519GenKey(pool, &key, NULL) < 0)
+    {
+        _psTrace("	FAILED OPERATION:GenKey\n");
+        return;
+    }
+    /* Make sure the verify loop has a good signature even without SIGN_OP */
+    psEd25519Sign(&key, in, inLen, sig);
+
+#  ifdef SIGN_OP
+    psGetTime(&start, NULL);
+    for (iter = 0; iter < ITER; iter++)
+    {
+        if (psEd25519Sign(&key, in, inLen, sig) < 0)
+        {
+            _psTrace("	FAILED OPERATION: Sign\n");
+        }
+    }
+    psGetTime(&end, NULL);
+    t = psDiffMsecs(start, end, NULL) / ITER;
+    _psTraceInt(TIME_UNITS "/sign ", t);
+    _psTraceInt("(%d per sec)\n", PER_SEC(t));
+#  endif /* SIGN_OP */
+
+#  ifdef VERIFY_OP
+    psGetTime(&start, NULL);
+    for (iter = 0; iter < ITER; iter++)
+    {
+        if (psEd25519Verify(&key, in, inLen, sig, sizeof(sig),
+                &validateStatus) < 0 || validateStatus != 1)
+        {
+            _psTrace("	FAILED OPERATION:VerifySignature\n");
+        }
+    }
+    psGetTime(&end, NULL);
+    t = psDiffMsecs(start, end, NULL) / ITER;
+    _psTraceInt(TIME_UNITS "/verify ", t);
+    _psTraceInt("(%d per sec)\n", PER_SEC(t));
+#  endif /* VERIFY_OP */
+
+    psEd25519ClearKey(&key);
+}
+# endif /* USE_ED25519 */
+
 /******************************************************************************/
 /*
     Main
@@ -361,6 +437,12 @@ int main(int argc, char **argv)
         i++;
     }
 
+# ifdef USE_ED25519
+    psGetEntropy(in, sizeof(in), NULL);
+    ed25519Perf(pool, in, sizeof(in));
+    memzero_s(in, sizeof(in));
+# endif
+
 # ifdef STATS
     fclose(sfd);
 # endif
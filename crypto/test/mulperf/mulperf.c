@@ -0,0 +1,214 @@
+/**
+ *      @file    mulperf.c
+ *      @version $Format:%h%d$
+ *
+ *      Karatsuba cutoff tuning for pstm multiplication and squaring.
+ */
+/*
+ *      Copyright (c) 2013-2017 INSIDE Secure Corporation
+ *      All Rights Reserved
+ *
+ *      The latest version of this code is available at http://www.matrixssl.org
+ *
+ *      This software is open source; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This General Public License does NOT permit incorporating this software
+ *      into proprietary programs.  If you are unable to comply with the GPL, a
+ *      commercial license for this software may be purchased from INSIDE at
+ *      http://www.insidesecure.com/
+ *
+ *      This program is distributed in WITHOUT ANY WARRANTY; without even the
+ *      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *      See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program; if not, write to the Free Software
+ *      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *      http://www.gnu.org/copyleft/gpl.html
+ */
+/******************************************************************************/
+
+#include "crypto/cryptoImpl.h"
+#include <stdio.h>
+
+#if defined(USE_PSTM_KARATSUBA) && defined(USE_MATRIX_RSA)
+
+/******************************************************************************/
+/*
+    For every operand size the comba routines are timed against a single
+    level of Karatsuba whose halves go to comba. The recommended cutoff is
+    the smallest size from which Karatsuba wins at every larger size.
+    Rebuild the library with the printed defines to use the result.
+ */
+
+/* Smallest and largest operand sizes tried, in digits */
+# define MIN_DIGITS   8
+# define MAX_DIGITS   (4096 / DIGIT_BIT)
+
+/* Each measurement is the best of RUNS runs of at least MIN_MSECS */
+# define RUNS         3
+# define MIN_MSECS    20
+
+typedef int32_t (*mulFunc_t)(psPool_t *pool, const pstm_int *A,
+                             const pstm_int *B, pstm_int *C,
+                             pstm_digit *paD, psSize_t paDlen);
+
+/* Cutoff of the Karatsuba runs being timed */
+static psSize_t g_cutoff;
+
+static int32_t sqrComba(psPool_t *pool, const pstm_int *A, const pstm_int *B,
+    pstm_int *C, pstm_digit *paD, psSize_t paDlen)
+{
+    return pstm_sqr_comba_base(pool, A, C, paD, paDlen);
+}
+
+static int32_t mulKaratsuba(psPool_t *pool, const pstm_int *A,
+    const pstm_int *B, pstm_int *C, pstm_digit *paD, psSize_t paDlen)
+{
+    return pstm_mul_karatsuba_cutoff(pool, A, B, C, paD, paDlen, g_cutoff);
+}
+
+static int32_t sqrKaratsuba(psPool_t *pool, const pstm_int *A,
+    const pstm_int *B, pstm_int *C, pstm_digit *paD, psSize_t paDlen)
+{
+    return pstm_sqr_karatsuba_cutoff(pool, A, C, paD, paDlen, g_cutoff);
+}
+
+static void randomInt(pstm_int *a, psSize_t digits)
+{
+    psGetPrngLocked((unsigned char *) a->dp, digits * sizeof(pstm_digit),
+        NULL);
+    a->used = digits;
+    if (a->dp[digits - 1] == 0)
+    {
+        a->dp[digits - 1] = 1;
+    }
+    a->sign = PSTM_ZPOS;
+}
+
+/* Nanoseconds per call, best of a few runs */
+static uint32 timeOp(mulFunc_t f, const pstm_int *a, const pstm_int *b,
+    pstm_int *c, pstm_digit *paD, psSize_t paDlen)
+{
+    psTime_t start, end;
+    uint32 count, batch, msecs, ns, best;
+    int32 i, run;
+
+    best = 0;
+    for (run = 0; run < RUNS; run++)
+    {
+        count = 0;
+        batch = 16;
+        psGetTime(&start, NULL);
+        do
+        {
+            for (i = 0; i < batch; i++)
+            {
+                if (f(NULL, a, b, c, paD, paDlen) != PSTM_OKAY)
+                {
+                    printf("FAIL: multiplication error\n");
+                    return 0;
+                }
+            }
+            count += batch;
+            batch *= 2;
+            psGetTime(&end, NULL);
+            msecs = (uint32) psDiffMsecs(start, end, NULL);
+        }
+        while (msecs < MIN_MSECS);
+        ns = (uint32) (((uint64) msecs * 1000000) / count);
+        if (best == 0 || ns < best)
+        {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+/*
+    Returns the suggested cutoff, or 0 if Karatsuba never won.
+ */
+static psSize_t tune(const char *name, mulFunc_t comba, mulFunc_t karatsuba,
+    int square)
+{
+    pstm_int a, b, c;
+    pstm_digit *paD;
+    psSize_t n, best, paDlen;
+    uint32 tc, tk;
+
+    paDlen = PSTM_KARATSUBA_SCRATCH_BOUND(MAX_DIGITS);
+    if ((paD = psMalloc(NULL, paDlen)) == NULL)
+    {
+        return 0;
+    }
+    pstm_init_size(NULL, &a, MAX_DIGITS);
+    pstm_init_size(NULL, &b, MAX_DIGITS);
+    pstm_init_size(NULL, &c, 2 * MAX_DIGITS);
+
+    printf("%s\n  digits    comba ns  karatsuba ns\n", name);
+    best = 0;
+    for (n = MIN_DIGITS; n <= MAX_DIGITS; n++)
+    {
+        randomInt(&a, n);
+        randomInt(&b, n);
+        /* One level of Karatsuba, the halves are below the cutoff */
+        g_cutoff = n;
+        tc = timeOp(comba, &a, square ? &a : &b, &c, paD, paDlen);
+        tk = timeOp(karatsuba, &a, square ? &a : &b, &c, paD, paDlen);
+        printf("  %6hu  %10u  %12u%s\n", n, tc, tk, tk < tc ? "  *" : "");
+        if (tk < tc)
+        {
+            if (best == 0)
+            {
+                best = n;
+            }
+        }
+        else
+        {
+            best = 0;
+        }
+    }
+    pstm_clear(&a);
+    pstm_clear(&b);
+    pstm_clear(&c);
+    psFree(paD, NULL);
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    psSize_t mul, sqr;
+
+    if (psCryptoOpen(PSCRYPTO_CONFIG) < PS_SUCCESS)
+    {
+        _psTrace("Failed to initialize library:  psCryptoOpen failed\n");
+        return -1;
+    }
+    printf("Tuning Karatsuba cutoffs for %d bit digits\n", DIGIT_BIT);
+    mul = tune("Multiplication", pstm_mul_comba_base, mulKaratsuba, 0);
+    sqr = tune("Squaring", sqrComba, sqrKaratsuba, 1);
+
+    printf("Current:   -DPSTM_KARATSUBA_MUL_CUTOFF=%d "
+        "-DPSTM_KARATSUBA_SQR_CUTOFF=%d\n",
+        PSTM_KARATSUBA_MUL_CUTOFF, PSTM_KARATSUBA_SQR_CUTOFF);
+    /* Karatsuba never winning is expressed as a cutoff above any key size */
+    printf("Suggested: -DPSTM_KARATSUBA_MUL_CUTOFF=%hu "
+        "-DPSTM_KARATSUBA_SQR_CUTOFF=%hu\n",
+        mul ? mul : PSTM_MAX_SIZE, sqr ? sqr : PSTM_MAX_SIZE);
+    psCryptoClose();
+    return 0;
+}
+
+#else
+
+/* Stub main */
+int main(int argc, char **argv)
+{
+    printf("USE_PSTM_KARATSUBA not defined.\n");
+    return 0;
+}
+
+#endif /* USE_PSTM_KARATSUBA && USE_MATRIX_RSA */
@@ -1731,6 +1731,82 @@ const static sslCipherSpec_t supportedCiphers[] = {
       csNullVerifyMac }
 };
 
+/******************************************************************************/
+/*
+    Open addressed index from cipher suite ID to supportedCiphers ordinal,
+    so the IDs of a ClientHello don't each scan the table above. Slots hold
+    ordinal + 1, zero is empty. Built once by sslInitCipherIndex from
+    matrixSslOpen. Twice the 256 cipher maximum keeps probe chains short.
+ */
+#define CIPHER_INDEX_BITS   9
+#define CIPHER_INDEX_SIZE   (1 << CIPHER_INDEX_BITS)
+
+static uint16_t cipherIndex[CIPHER_INDEX_SIZE];
+static uint8_t cipherIndexReady = 0;
+
+static uint16_t cipherIndexHash(uint16_t id)
+{
+    /* Fibonacci hashing, top bits of the 16 bit product */
+    return (uint16_t) (id * 40503U) >> (16 - CIPHER_INDEX_BITS);
+}
+
+void sslInitCipherIndex(void)
+{
+    uint16_t i, h;
+
+    if (cipherIndexReady)
+    {
+        return;
+    }
+    memset(cipherIndex, 0x0, sizeof(cipherIndex));
+    i = 0;
+    do
+    {
+        h = cipherIndexHash(supportedCiphers[i].ident);
+        while (cipherIndex[h] != 0)
+        {
+            h = (h + 1) & (CIPHER_INDEX_SIZE - 1);
+        }
+        cipherIndex[h] = i + 1;
+    }
+    while (supportedCiphers[i++].ident != SSL_NULL_WITH_NULL_NULL);
+    cipherIndexReady = 1;
+}
+
+/*
+    Ordinal of id in supportedCiphers, including the terminating NULL suite,
+    or -1 if it is not compiled in.
+ */
+static int32 cipherOrdinal(uint16_t id)
+{
+    uint16_t h, i;
+
+    if (!cipherIndexReady)
+    {
+        /* Before matrixSslOpen, fall back to the scan */
+        i = 0;
+        do
+        {
+            if (supportedCiphers[i].ident == id)
+            {
+                return i;
+            }
+        }
+        while (supportedCiphers[i++].ident != SSL_NULL_WITH_NULL_NULL);
+        return -1;
+    }
+    h = cipherIndexHash(id);
+    while (cipherIndex[h] != 0)
+    {
+        if (supportedCiphers[cipherIndex[h] - 1].ident == id)
+        {
+            return cipherIndex[h] - 1;
+        }
+        h = (h + 1) & (CIPHER_INDEX_SIZE - 1);
+    }
+    return -1;
+}
+
 #ifdef USE_SERVER_SIDE_SSL
 /******************************************************************************/
 /*
@@ -1969,6 +2045,15 @@ static int32_t validateKeyForExtensions(ssl_t *ssl, const sslCipherSpec_t *spec,
                     }
                 }
 #    endif /* USE_ECC */
+#    ifdef USE_ED25519
+                if (crt->pubKeyAlgorithm == OID_ED25519_KEY_ALG)
+                {
+                    if (!(ssl->hashSigAlg & HASH_SIG_ED25519_MASK))
+                    {
+                        return PS_UNSUPPORTED_FAIL;
+                    }
+                }
+#    endif /* USE_ED25519 */
             }
 #   endif  /* USE_DHE_CIPHER_SUITE */
 
@@ -2022,6 +2107,14 @@ static int32_t validateKeyForExtensions(ssl_t *ssl, const sslCipherSpec_t *spec,
                 }
                 break;
 #    endif
+#    ifdef USE_ED25519
+            case OID_ED25519_SIG:
+                if (!(ssl->hashSigAlg & HASH_SIG_ED25519_MASK))
+                {
+                    return PS_UNSUPPORTED_FAIL;
+                }
+                break;
+#    endif
 #   endif       /* USE_ECC */
             default:
                 psTraceInfo("Don't share ANY sig/hash algorithms with peer\n");
@@ -2032,7 +2125,11 @@ static int32_t validateKeyForExtensions(ssl_t *ssl, const sslCipherSpec_t *spec,
             /* EC suites have the added check of specific curves.  Just
                 checking DH suites because the curve comes from the cert.
                 ECDHE suites negotiate key exchange curve elsewhere */
-            if (spec->type == CS_ECDH_ECDSA || spec->type == CS_ECDH_RSA)
+            if ((spec->type == CS_ECDH_ECDSA || spec->type == CS_ECDH_RSA)
+#    ifdef USE_ED25519
+                && crt->publicKey.type != PS_ED25519
+#    endif
+                )
             {
                 if (ssl->ecInfo.ecFlags)
                 {
@@ -2057,6 +2154,15 @@ static int32_t validateKeyForExtensions(ssl_t *ssl, const sslCipherSpec_t *spec,
 
 #  endif /* USE_TLS_1_2 */
 
+#  ifdef USE_ED25519
+    /* The intrinsic hash signature algorithm only exists in TLS 1.2 */
+    if (!(ssl->flags & SSL_FLAGS_TLS_1_2) &&
+        givenKey->privKey.type == PS_ED25519)
+    {
+        return PS_UNSUPPORTED_FAIL;
+    }
+#  endif
+
     /* Must be good */
     return PS_SUCCESS;
 }
@@ -2087,6 +2193,9 @@ static int32 haveCorrectSigAlg(psX509Cert_t *cert, int32 sigType)
             cert->sigAlgorithm == OID_SHA224_ECDSA_SIG ||
             cert->sigAlgorithm == OID_SHA256_ECDSA_SIG ||
             cert->sigAlgorithm == OID_SHA384_ECDSA_SIG ||
+#  ifdef USE_ED25519
+            cert->sigAlgorithm == OID_ED25519_SIG ||
+#  endif
             cert->sigAlgorithm == OID_SHA512_ECDSA_SIG)
         {
             return PS_SUCCESS;
@@ -2098,260 +2207,224 @@ static int32 haveCorrectSigAlg(psX509Cert_t *cert, int32 sigType)
 # endif /* USE_SERVER_SIDE_SSL */
 
 /******************************************************************************/
+# ifdef USE_SERVER_SIDE_SSL
 /*
-    Don't report a matching cipher suite if the user hasn't loaded the
-    proper public key material to support it.  We do not check the client
-    auth side of the algorithms because that authentication mechanism is
-    negotiated within the handshake itself
-
-    The annoying #ifdef USE_SERVER_SIDE and CLIENT_SIDE are because the
-    structure members only exist one one side or the other and so are used
-    for compiling.  You can't actually get into the wrong area of the
-    SSL_FLAGS_SERVER test so no #else cases should be needed
+    Server side of haveKeyMaterial.  This only looks at the keys, so it is
+    run for every suite when they are loaded and the answers are kept in
+    the cipherEligible bitmap of sslKeys_t.
  */
-int32_t haveKeyMaterial(const ssl_t *ssl, int32 cipherType, short reallyTest)
+static int32 haveServerKeyMaterial(const sslKeys_t *keys, int32 cipherType)
 {
-
-# ifdef USE_SERVER_SIDE_SSL
-    /* If the user has a ServerNameIndication callback registered we're
-        going to skip the first test because they may not have loaded the
-        final key material yet */
-    if (ssl->sni_cb && reallyTest == 0)
-    {
-        return PS_SUCCESS;
-    }
-# endif
-
-# ifndef USE_ONLY_PSK_CIPHER_SUITE
-
+#  ifndef USE_ONLY_PSK_CIPHER_SUITE
     /*  To start, capture all the cipherTypes where servers must have an
-        identity and clients have a CA so we don't repeat them everywhere */
+        identity so we don't repeat them everywhere */
     if (cipherType == CS_RSA || cipherType == CS_DHE_RSA ||
         cipherType == CS_ECDHE_RSA || cipherType == CS_ECDH_RSA ||
         cipherType == CS_ECDHE_ECDSA || cipherType == CS_ECDH_ECDSA)
     {
-        if (ssl->flags & SSL_FLAGS_SERVER)
-        {
-#  ifdef USE_SERVER_SIDE_SSL
-            if (ssl->keys == NULL || ssl->keys->cert == NULL)
-            {
-                return PS_FAILURE;
-            }
-#  endif
-#  ifdef USE_CLIENT_SIDE_SSL
-        }
-        else
+        if (keys == NULL || keys->cert == NULL)
         {
-            if (ssl->keys == NULL || ssl->keys->CAcerts == NULL)
-            {
-                return PS_FAILURE;
-            }
-#  endif
+            return PS_FAILURE;
         }
     }
 
     /*  Standard RSA ciphers types - auth and exchange */
     if (cipherType == CS_RSA)
     {
-        if (ssl->flags & SSL_FLAGS_SERVER)
+        if (haveCorrectKeyAlg(keys->cert, OID_RSA_KEY_ALG,
+                KEY_ALG_FIRST) < 0)
         {
-#  ifdef USE_SERVER_SIDE_SSL
-            if (haveCorrectKeyAlg(ssl->keys->cert, OID_RSA_KEY_ALG,
-                    KEY_ALG_FIRST) < 0)
-            {
-                return PS_FAILURE;
-            }
-            if (haveCorrectSigAlg(ssl->keys->cert, RSA_TYPE_SIG) < 0)
-            {
-                return PS_FAILURE;
-            }
-#  endif
-#  ifdef USE_CLIENT_SIDE_SSL
+            return PS_FAILURE;
         }
-        else     /* Client */
-
+        if (haveCorrectSigAlg(keys->cert, RSA_TYPE_SIG) < 0)
         {
-            if (haveCorrectKeyAlg(ssl->keys->CAcerts, OID_RSA_KEY_ALG,
-                    KEY_ALG_ANY) < 0)
-            {
-                return PS_FAILURE;
-            }
-#  endif
+            return PS_FAILURE;
         }
     }
 
-#  ifdef USE_DHE_CIPHER_SUITE
+#   ifdef USE_DHE_CIPHER_SUITE
 /*
     DHE_RSA ciphers types
  */
     if (cipherType == CS_DHE_RSA)
     {
-        if (ssl->flags & SSL_FLAGS_SERVER)
+#    ifdef REQUIRE_DH_PARAMS
+        if (keys->dhParams.size == 0)
         {
-#   ifdef REQUIRE_DH_PARAMS
-            if (ssl->keys->dhParams.size == 0)
-            {
-                return PS_FAILURE;
-            }
-#   endif
-#   ifdef USE_SERVER_SIDE_SSL
-            if (haveCorrectKeyAlg(ssl->keys->cert, OID_RSA_KEY_ALG,
-                    KEY_ALG_FIRST) < 0)
-            {
-                return PS_FAILURE;
-            }
-#   endif
-#   ifdef USE_CLIENT_SIDE_SSL
+            return PS_FAILURE;
         }
-        else
+#    endif
+        if (haveCorrectKeyAlg(keys->cert, OID_RSA_KEY_ALG,
+                KEY_ALG_FIRST) < 0)
         {
-            if (haveCorrectKeyAlg(ssl->keys->CAcerts, OID_RSA_KEY_ALG,
-                    KEY_ALG_ANY) < 0)
-            {
-                return PS_FAILURE;
-            }
-#   endif
+            return PS_FAILURE;
         }
     }
 
-#   ifdef REQUIRE_DH_PARAMS
+#    ifdef REQUIRE_DH_PARAMS
 /*
-    Anon DH ciphers don't need much
+    Anon DH and DHE_PSK ciphers don't need much
  */
-    if (cipherType == CS_DH_ANON)
+    if (cipherType == CS_DH_ANON || cipherType == CS_DHE_PSK)
     {
-        if (ssl->flags & SSL_FLAGS_SERVER)
+        if (keys == NULL || keys->dhParams.size == 0)
         {
-            if (ssl->keys == NULL || ssl->keys->dhParams.size == 0)
-            {
-                return PS_FAILURE;
-            }
+            return PS_FAILURE;
         }
     }
-#   endif
+#    endif
+#   endif /* USE_DHE_CIPHER_SUITE */
 
-#   ifdef USE_PSK_CIPHER_SUITE
-    if (cipherType == CS_DHE_PSK)
+#   ifdef USE_ECC_CIPHER_SUITE /* key exchange */
+/*
+    ECDHE_RSA ciphers use RSA keys
+ */
+    if (cipherType == CS_ECDHE_RSA)
     {
-#    ifdef REQUIRE_DH_PARAMS
-        if (ssl->flags & SSL_FLAGS_SERVER)
+        if (haveCorrectKeyAlg(keys->cert, OID_RSA_KEY_ALG,
+                KEY_ALG_FIRST) < 0)
         {
-            if (ssl->keys == NULL || ssl->keys->dhParams.size == 0)
-            {
-                return PS_FAILURE;
-            }
+            return PS_FAILURE;
         }
-#    endif
-        /* Only using these for clients at the moment */
-        if (!(ssl->flags & SSL_FLAGS_SERVER))
+        if (haveCorrectSigAlg(keys->cert, RSA_TYPE_SIG) < 0)
         {
-            if (ssl->keys == NULL || ssl->keys->pskKeys == NULL)
-            {
-                return PS_FAILURE;
-            }
+            return PS_FAILURE;
         }
     }
-#   endif /* USE_PSK_CIPHER_SUITE */
-#  endif  /* USE_DHE_CIPHER_SUITE */
 
-#  ifdef USE_ECC_CIPHER_SUITE /* key exchange */
 /*
-    ECDHE_RSA ciphers use RSA keys
+    ECDH_RSA ciphers use ECDSA key exhange and RSA auth.
  */
-    if (cipherType == CS_ECDHE_RSA)
+    if (cipherType == CS_ECDH_RSA)
     {
-        if (ssl->flags & SSL_FLAGS_SERVER)
+        if (haveCorrectKeyAlg(keys->cert, OID_ECDSA_KEY_ALG,
+                KEY_ALG_FIRST) < 0)
         {
-#   ifdef USE_SERVER_SIDE_SSL
-            if (haveCorrectKeyAlg(ssl->keys->cert, OID_RSA_KEY_ALG,
-                    KEY_ALG_FIRST) < 0)
-            {
-                return PS_FAILURE;
-            }
-            if (haveCorrectSigAlg(ssl->keys->cert, RSA_TYPE_SIG) < 0)
-            {
-                return PS_FAILURE;
-            }
-#   endif
-#   ifdef USE_CLIENT_SIDE_SSL
+            return PS_FAILURE;
         }
-        else
+        if (haveCorrectSigAlg(keys->cert, RSA_TYPE_SIG) < 0)
         {
-            if (haveCorrectKeyAlg(ssl->keys->CAcerts, OID_RSA_KEY_ALG,
-                    KEY_ALG_ANY) < 0)
-            {
-                return PS_FAILURE;
-            }
-#   endif
+            return PS_FAILURE;
         }
     }
 
 /*
-    ECDH_RSA ciphers use ECDSA key exhange and RSA auth.
+    ECDHE_ECDSA and ECDH_ECDSA ciphers must have ECDSA keys. ECDHE_ECDSA
+    also takes the Ed25519 signing keys of RFC 8422.
  */
-    if (cipherType == CS_ECDH_RSA)
+    if (cipherType == CS_ECDHE_ECDSA || cipherType == CS_ECDH_ECDSA)
     {
-        if (ssl->flags & SSL_FLAGS_SERVER)
-        {
-#   ifdef USE_SERVER_SIDE_SSL
-            if (haveCorrectKeyAlg(ssl->keys->cert, OID_ECDSA_KEY_ALG,
+        if (haveCorrectKeyAlg(keys->cert, OID_ECDSA_KEY_ALG,
+                KEY_ALG_FIRST) < 0
+#    ifdef USE_ED25519
+            && (cipherType == CS_ECDH_ECDSA ||
+                haveCorrectKeyAlg(keys->cert, OID_ED25519_KEY_ALG,
                     KEY_ALG_FIRST) < 0)
-            {
-                return PS_FAILURE;
-            }
-            if (haveCorrectSigAlg(ssl->keys->cert, RSA_TYPE_SIG) < 0)
-            {
-                return PS_FAILURE;
-            }
-#   endif
-#   ifdef USE_CLIENT_SIDE_SSL
+#    endif
+            )
+        {
+            return PS_FAILURE;
         }
-        else
+        if (haveCorrectSigAlg(keys->cert, ECDSA_TYPE_SIG) < 0)
         {
-            if (haveCorrectKeyAlg(ssl->keys->CAcerts, OID_RSA_KEY_ALG,
-                    KEY_ALG_ANY) < 0)
-            {
-                return PS_FAILURE;
-            }
-#   endif
+            return PS_FAILURE;
+        }
+    }
+#   endif /* USE_ECC_CIPHER_SUITE */
+#  endif  /* USE_ONLY_PSK_CIPHER_SUITE */
+
+#  ifdef USE_PSK_CIPHER_SUITE
+    if (cipherType == CS_PSK)
+    {
+        if (keys == NULL || keys->pskKeys == NULL)
+        {
+            return PS_FAILURE;
         }
     }
+#  endif /* USE_PSK_CIPHER_SUITE */
 
+    return PS_SUCCESS;
+}
+# endif /* USE_SERVER_SIDE_SSL */
 
+/******************************************************************************/
 /*
-    ECDHE_ECDSA and ECDH_ECDSA ciphers must have ECDSA keys
+    Don't report a matching cipher suite if the user hasn't loaded the
+    proper public key material to support it.  We do not check the client
+    auth side of the algorithms because that authentication mechanism is
+    negotiated within the handshake itself
  */
-    if (cipherType == CS_ECDHE_ECDSA || cipherType == CS_ECDH_ECDSA)
+int32_t haveKeyMaterial(const ssl_t *ssl, int32 cipherType, short reallyTest)
+{
+
+# ifdef USE_SERVER_SIDE_SSL
+    /* If the user has a ServerNameIndication callback registered we're
+        going to skip the first test because they may not have loaded the
+        final key material yet */
+    if (ssl->sni_cb && reallyTest == 0)
     {
-        if (ssl->flags & SSL_FLAGS_SERVER)
+        return PS_SUCCESS;
+    }
+    if (ssl->flags & SSL_FLAGS_SERVER)
+    {
+        return haveServerKeyMaterial(ssl->keys, cipherType);
+    }
+# endif
+
+# ifdef USE_CLIENT_SIDE_SSL
+#  ifndef USE_ONLY_PSK_CIPHER_SUITE
+    /*  To start, capture all the cipherTypes where clients must have a CA
+        so we don't repeat them everywhere */
+    if (cipherType == CS_RSA || cipherType == CS_DHE_RSA ||
+        cipherType == CS_ECDHE_RSA || cipherType == CS_ECDH_RSA ||
+        cipherType == CS_ECDHE_ECDSA || cipherType == CS_ECDH_ECDSA)
+    {
+        if (ssl->keys == NULL || ssl->keys->CAcerts == NULL)
         {
-#   ifdef USE_SERVER_SIDE_SSL
-            if (haveCorrectKeyAlg(ssl->keys->cert, OID_ECDSA_KEY_ALG,
-                    KEY_ALG_FIRST) < 0)
-            {
-                return PS_FAILURE;
-            }
-            if (haveCorrectSigAlg(ssl->keys->cert, ECDSA_TYPE_SIG) < 0)
-            {
-                return PS_FAILURE;
-            }
-#   endif
-#   ifdef USE_CLIENT_SIDE_SSL
+            return PS_FAILURE;
         }
-        else
+    }
+
+    /*  Server authenticates with RSA */
+    if (cipherType == CS_RSA || cipherType == CS_DHE_RSA ||
+        cipherType == CS_ECDHE_RSA || cipherType == CS_ECDH_RSA)
+    {
+        if (haveCorrectKeyAlg(ssl->keys->CAcerts, OID_RSA_KEY_ALG,
+                KEY_ALG_ANY) < 0)
         {
-            if (haveCorrectKeyAlg(ssl->keys->CAcerts, OID_ECDSA_KEY_ALG,
-                    KEY_ALG_ANY) < 0)
-            {
-                return PS_FAILURE;
-            }
+            return PS_FAILURE;
+        }
+    }
+
+#   if defined(USE_DHE_CIPHER_SUITE) && defined(USE_PSK_CIPHER_SUITE)
+    if (cipherType == CS_DHE_PSK)
+    {
+        if (ssl->keys == NULL || ssl->keys->pskKeys == NULL)
+        {
+            return PS_FAILURE;
+        }
+    }
 #   endif
+
+#   ifdef USE_ECC_CIPHER_SUITE
+    if (cipherType == CS_ECDHE_ECDSA || cipherType == CS_ECDH_ECDSA)
+    {
+        if (haveCorrectKeyAlg(ssl->keys->CAcerts, OID_ECDSA_KEY_ALG,
+                KEY_ALG_ANY) < 0
+#    ifdef USE_ED25519
+            && (cipherType == CS_ECDH_ECDSA ||
+                haveCorrectKeyAlg(ssl->keys->CAcerts, OID_ED25519_KEY_ALG,
+                    KEY_ALG_ANY) < 0)
+#    endif
+            )
+        {
+            return PS_FAILURE;
         }
     }
-#  endif /* USE_ECC_CIPHER_SUITE */
-# endif  /* USE_ONLY_PSK_CIPHER_SUITE   */
+#   endif /* USE_ECC_CIPHER_SUITE */
+#  endif  /* USE_ONLY_PSK_CIPHER_SUITE */
 
-# ifdef USE_PSK_CIPHER_SUITE
+#  ifdef USE_PSK_CIPHER_SUITE
     if (cipherType == CS_PSK)
     {
         if (ssl->keys == NULL || ssl->keys->pskKeys == NULL)
@@ -2359,12 +2432,57 @@ int32_t haveKeyMaterial(const ssl_t *ssl, int32 cipherType, short reallyTest)
             return PS_FAILURE;
         }
     }
-# endif /* USE_PSK_CIPHER_SUITE */
+#  endif /* USE_PSK_CIPHER_SUITE */
+# endif  /* USE_CLIENT_SIDE_SSL */
 
     return PS_SUCCESS;
 }
 #endif /* VALIDATE_KEY_MATERIAL */
 
+/******************************************************************************/
+/*
+    Run whenever key material is loaded.  Records which supportedCiphers the
+    keys can serve, so that matching a ClientHello tests one bit per suite
+    instead of walking the certificate chain again.
+ */
+void matrixSslUpdateCipherEligibility(sslKeys_t *keys)
+{
+#if defined(USE_SERVER_SIDE_SSL) && defined(VALIDATE_KEY_MATERIAL)
+    uint16_t i;
+
+    if (keys == NULL)
+    {
+        return;
+    }
+    memset(keys->cipherEligible, 0x0, sizeof(keys->cipherEligible));
+    i = 0;
+    do
+    {
+        if (haveServerKeyMaterial(keys, supportedCiphers[i].type) == PS_SUCCESS)
+        {
+            keys->cipherEligible[i >> 5] |= 1U << (i & 31);
+        }
+    }
+    while (supportedCiphers[i++].ident != SSL_NULL_WITH_NULL_NULL);
+#endif /* USE_SERVER_SIDE_SSL && VALIDATE_KEY_MATERIAL */
+}
+
+#if defined(USE_SERVER_SIDE_SSL) && defined(VALIDATE_KEY_MATERIAL)
+/* Can keys serve the suite at this supportedCiphers ordinal */
+static int32 keysHaveCipher(const sslKeys_t *keys, int32 ordinal)
+{
+    if (keys == NULL)
+    {
+        return haveServerKeyMaterial(NULL, supportedCiphers[ordinal].type);
+    }
+    if (keys->cipherEligible[ordinal >> 5] & (1U << (ordinal & 31)))
+    {
+        return PS_SUCCESS;
+    }
+    return PS_FAILURE;
+}
+#endif /* USE_SERVER_SIDE_SSL && VALIDATE_KEY_MATERIAL */
+
 
 /*      0 return is a key was found
     <0 is no luck
@@ -2455,12 +2573,10 @@ int32 chooseCipherSuite(ssl_t *ssl, unsigned char *listStart, int32 listLen)
             }
 
 #  ifdef VALIDATE_KEY_MATERIAL
-            /* We want to double check this.  Temporarily assign their keys as
-                ssl->keys for haveKeyMaterial to find */
-            ssl->keys = givenKey;
-            if (haveKeyMaterial(ssl, spec->type, 1) < 0)
+            /* We want to double check this against what their keys were
+                found eligible for when loaded */
+            if (keysHaveCipher(givenKey, spec - supportedCiphers) < 0)
             {
-                ssl->keys = NULL;
                 /* We're still looping through cipher suites above so this
                     isn't really fatal.  It just means the user gave us keys
                     that don't match the suite we wanted */
@@ -2469,8 +2585,6 @@ int32 chooseCipherSuite(ssl_t *ssl, unsigned char *listStart, int32 listLen)
                     spec->ident);
                 continue;
             }
-            /* Reset.  One final test below before we can set ssl->keys */
-            ssl->keys = NULL;
 #  endif
         }
         else
@@ -2489,7 +2603,7 @@ int32 chooseCipherSuite(ssl_t *ssl, unsigned char *listStart, int32 listLen)
 #  ifdef VALIDATE_KEY_MATERIAL
                 /* New ssl->keys may have been loaded by the callback,
                     see if they match the potential cipher suite */
-                if (haveKeyMaterial(ssl, spec->type, 1) < 0)
+                if (keysHaveCipher(ssl->keys, spec - supportedCiphers) < 0)
                 {
                     continue;
                 }
@@ -2634,6 +2748,13 @@ int32 csCheckCertAgainstCipherSuite(int32 pubKey, int32 cipherType)
         }
 
     }
+#  ifdef USE_ED25519
+    /* Signing-only key, so no static ECDH */
+    if (pubKey == PS_ED25519 && cipherType == CS_ECDHE_ECDSA)
+    {
+        return 1;
+    }
+#  endif
     return 0; /* no match */
 }
 # endif /* USE_CLIENT_SIDE_SSL */
@@ -2648,16 +2769,13 @@ int32 csCheckCertAgainstCipherSuite(int32 pubKey, int32 cipherType)
  */
 const sslCipherSpec_t *sslGetDefinedCipherSpec(uint16_t id)
 {
-    uint8_t i;
+    int32 i;
 
-    for (i = 0; supportedCiphers[i].ident != SSL_NULL_WITH_NULL_NULL; i++)
+    if (id == SSL_NULL_WITH_NULL_NULL || (i = cipherOrdinal(id)) < 0)
     {
-        if (supportedCiphers[i].ident == id)
-        {
-            return &supportedCiphers[i];
-        }
+        return NULL;
     }
-    return NULL;
+    return &supportedCiphers[i];
 }
 
 /******************************************************************************/
@@ -2672,177 +2790,173 @@ const sslCipherSpec_t *sslGetDefinedCipherSpec(uint16_t id)
  */
 const sslCipherSpec_t *sslGetCipherSpec(const ssl_t *ssl, uint16_t id)
 {
-    uint8_t i;
+    int32 i;
 
 #ifdef USE_SERVER_SIDE_SSL
     uint8_t j;
 #endif /* USE_SERVER_SIDE_SSL */
 
-    i = 0;
-    do
+    if ((i = cipherOrdinal(id)) < 0)
     {
-        if (supportedCiphers[i].ident != id)
-        {
-            continue;
-        }
-        /* Double check we support the requsted hash algorithm */
+        return NULL;
+    }
+    /* Double check we support the requsted hash algorithm */
 #ifndef USE_MD5
-        if (supportedCiphers[i].flags & CRYPTO_FLAGS_MD5)
-        {
-            return NULL;
-        }
+    if (supportedCiphers[i].flags & CRYPTO_FLAGS_MD5)
+    {
+        return NULL;
+    }
 #endif
 #ifndef USE_SHA1
-        if (supportedCiphers[i].flags & CRYPTO_FLAGS_SHA1)
-        {
-            return NULL;
-        }
+    if (supportedCiphers[i].flags & CRYPTO_FLAGS_SHA1)
+    {
+        return NULL;
+    }
 #endif
 #if !defined(USE_SHA256) && !defined(USE_SHA384)
-        if (supportedCiphers[i].flags & CRYPTO_FLAGS_SHA2)
-        {
-            return NULL;
-        }
+    if (supportedCiphers[i].flags & CRYPTO_FLAGS_SHA2)
+    {
+        return NULL;
+    }
 #endif
-        /* Double check we support the requsted weak cipher algorithm */
+    /* Double check we support the requsted weak cipher algorithm */
 #ifndef USE_ARC4
-        if (supportedCiphers[i].flags &
-            (CRYPTO_FLAGS_ARC4INITE | CRYPTO_FLAGS_ARC4INITD))
-        {
-            return NULL;
-        }
+    if (supportedCiphers[i].flags &
+        (CRYPTO_FLAGS_ARC4INITE | CRYPTO_FLAGS_ARC4INITD))
+    {
+        return NULL;
+    }
 #endif
 #ifndef USE_3DES
-        if (supportedCiphers[i].flags & CRYPTO_FLAGS_3DES)
-        {
-            return NULL;
-        }
+    if (supportedCiphers[i].flags & CRYPTO_FLAGS_3DES)
+    {
+        return NULL;
+    }
 #endif
 #ifdef USE_SERVER_SIDE_SSL
-        /* Globally disabled? */
-        if (disabledCipherFlags[i >> 5] & (1 << (i & 31)))
-        {
-            psTraceIntInfo("Matched cipher suite %d but disabled by user\n",
-                id);
-            return NULL;
-        }
-        /* Disabled for session? */
-        if (id != 0)   /* Disable NULL_WITH_NULL_NULL not possible */
+    /* Globally disabled? */
+    if (disabledCipherFlags[i >> 5] & (1 << (i & 31)))
+    {
+        psTraceIntInfo("Matched cipher suite %d but disabled by user\n",
+            id);
+        return NULL;
+    }
+    /* Disabled for session? */
+    if (id != 0)   /* Disable NULL_WITH_NULL_NULL not possible */
+    {
+        for (j = 0; j < SSL_MAX_DISABLED_CIPHERS; j++)
         {
-            for (j = 0; j < SSL_MAX_DISABLED_CIPHERS; j++)
+            if (ssl->disabledCiphers[j] == id)
             {
-                if (ssl->disabledCiphers[j] == id)
-                {
-                    psTraceIntInfo("Matched cipher suite %d but disabled by user\n",
-                        id);
-                    return NULL;
-                }
+                psTraceIntInfo("Matched cipher suite %d but disabled by user\n",
+                    id);
+                return NULL;
             }
         }
+    }
 #endif  /* USE_SERVER_SIDE_SSL */
 #ifdef USE_TLS_1_2
-        /* Unusable because protocol doesn't allow? */
+    /* Unusable because protocol doesn't allow? */
 # ifdef USE_DTLS
-        if (ssl->majVer == DTLS_MAJ_VER &&
-            ssl->minVer != DTLS_1_2_MIN_VER)
+    if (ssl->majVer == DTLS_MAJ_VER &&
+        ssl->minVer != DTLS_1_2_MIN_VER)
+    {
+        if (supportedCiphers[i].flags & CRYPTO_FLAGS_SHA3 ||
+            supportedCiphers[i].flags & CRYPTO_FLAGS_SHA2)
         {
-            if (supportedCiphers[i].flags & CRYPTO_FLAGS_SHA3 ||
-                supportedCiphers[i].flags & CRYPTO_FLAGS_SHA2)
-            {
-                psTraceIntInfo(
-                    "Matched cipher suite %d but only allowed in DTLS 1.2\n", id);
-                return NULL;
-            }
+            psTraceIntInfo(
+                "Matched cipher suite %d but only allowed in DTLS 1.2\n", id);
+            return NULL;
         }
-        if (!(ssl->flags & SSL_FLAGS_DTLS))
-        {
+    }
+    if (!(ssl->flags & SSL_FLAGS_DTLS))
+    {
 # endif
-        if (ssl->minVer < TLS_1_2_MIN_VER)
+    if (ssl->minVer < TLS_1_2_MIN_VER)
+    {
+        if (supportedCiphers[i].flags & CRYPTO_FLAGS_SHA3 ||
+            supportedCiphers[i].flags & CRYPTO_FLAGS_SHA2)
         {
-            if (supportedCiphers[i].flags & CRYPTO_FLAGS_SHA3 ||
-                supportedCiphers[i].flags & CRYPTO_FLAGS_SHA2)
-            {
-                psTraceIntInfo(
-                    "Matched cipher suite %d but only allowed in TLS 1.2\n", id);
-                return NULL;
-            }
+            psTraceIntInfo(
+                "Matched cipher suite %d but only allowed in TLS 1.2\n", id);
+            return NULL;
         }
-        if (ssl->minVer == TLS_1_2_MIN_VER)
+    }
+    if (ssl->minVer == TLS_1_2_MIN_VER)
+    {
+        if (supportedCiphers[i].flags & CRYPTO_FLAGS_MD5)
         {
-            if (supportedCiphers[i].flags & CRYPTO_FLAGS_MD5)
-            {
-                psTraceIntInfo("Not allowing MD5 suite %d in TLS 1.2\n",
-                    id);
-                return NULL;
-            }
+            psTraceIntInfo("Not allowing MD5 suite %d in TLS 1.2\n",
+                id);
+            return NULL;
         }
+    }
 # ifdef USE_DTLS
     }
 # endif
 #endif  /* TLS_1_2 */
 
-        /** Check restrictions by HTTP2 (set by ALPN extension).
-            This should filter out all ciphersuites specified in:
-                https://tools.ietf.org/html/rfc7540#appendix-A
-           "Note: This list was assembled from the set of registered TLS
-           cipher suites at the time of writing.  This list includes those
-           cipher suites that do not offer an ephemeral key exchange and
-           those that are based on the TLS null, stream, or block cipher type
-           (as defined in Section 6.2.3 of [TLS12]).  Additional cipher
-           suites with these properties could be defined; these would not be
-           explicitly prohibited."
-         */
-        if (ssl->flags & SSL_FLAGS_HTTP2)
-        {
-            /** Only allow AEAD ciphers. */
-            if (!(supportedCiphers[i].flags & CRYPTO_FLAGS_GCM) &&
-                !(supportedCiphers[i].flags & CRYPTO_FLAGS_CHACHA))
-            {
+    /** Check restrictions by HTTP2 (set by ALPN extension).
+        This should filter out all ciphersuites specified in:
+            https://tools.ietf.org/html/rfc7540#appendix-A
+       "Note: This list was assembled from the set of registered TLS
+       cipher suites at the time of writing.  This list includes those
+       cipher suites that do not offer an ephemeral key exchange and
+       those that are based on the TLS null, stream, or block cipher type
+       (as defined in Section 6.2.3 of [TLS12]).  Additional cipher
+       suites with these properties could be defined; these would not be
+       explicitly prohibited."
+     */
+    if (ssl->flags & SSL_FLAGS_HTTP2)
+    {
+        /** Only allow AEAD ciphers. */
+        if (!(supportedCiphers[i].flags & CRYPTO_FLAGS_GCM) &&
+            !(supportedCiphers[i].flags & CRYPTO_FLAGS_CHACHA))
+        {
 
-                return NULL;
-            }
-            /** Only allow ephemeral key exchange. */
-            switch (supportedCiphers[i].type)
-            {
-            case CS_DHE_RSA:
-            case CS_ECDHE_ECDSA:
-            case CS_ECDHE_RSA:
-                break;
-            default:
-                return NULL;
-            }
+            return NULL;
+        }
+        /** Only allow ephemeral key exchange. */
+        switch (supportedCiphers[i].type)
+        {
+        case CS_DHE_RSA:
+        case CS_ECDHE_ECDSA:
+        case CS_ECDHE_RSA:
+            break;
+        default:
+            return NULL;
         }
+    }
 
-        /*      The suite is available.  Want to reject if current key material
-            does not support? */
+    /*      The suite is available.  Want to reject if current key material
+        does not support? */
 #ifdef VALIDATE_KEY_MATERIAL
-        if (ssl->keys != NULL)
+    if (ssl->keys != NULL)
+    {
+        if ((ssl->flags & SSL_FLAGS_SERVER) == 0)
         {
-            if ((ssl->flags & SSL_FLAGS_SERVER) == 0)
-            {
-                /* Client: Just accept the cipher suite, because we do not
-                   know of server public key yet. */
-                return &supportedCiphers[i];
-            }
-            if (haveKeyMaterial(ssl, supportedCiphers[i].type, 0)
-                == PS_SUCCESS)
-            {
-                return &supportedCiphers[i];
-            }
-            psTraceIntInfo("Matched cipher suite %d but no supporting keys\n",
-                id);
+            /* Client: Just accept the cipher suite, because we do not
+               know of server public key yet. */
+            return &supportedCiphers[i];
         }
-        else
+# ifdef USE_SERVER_SIDE_SSL
+        /* The keys may not be final until the SNI callback runs */
+        if (ssl->sni_cb || keysHaveCipher(ssl->keys, i) == PS_SUCCESS)
         {
             return &supportedCiphers[i];
         }
-#else
+# endif
+        psTraceIntInfo("Matched cipher suite %d but no supporting keys\n",
+            id);
+    }
+    else
+    {
         return &supportedCiphers[i];
-#endif  /* VALIDATE_KEY_MATERIAL */
     }
-    while (supportedCiphers[i++].ident != SSL_NULL_WITH_NULL_NULL);
-
     return NULL;
+#else
+    return &supportedCiphers[i];
+#endif  /* VALIDATE_KEY_MATERIAL */
 }
 
 
@@ -155,7 +155,6 @@ int32 dtlsWriteCertificate(ssl_t *ssl, int32 certLen, int32 lsize,
     unsigned char *c)
 {
 #  if defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH)
-    psX509Cert_t *cert;
     unsigned char *tmp, *tmpStart;
     int32 tmpLen, wLen;
 /*
@@ -176,20 +175,9 @@ int32 dtlsWriteCertificate(ssl_t *ssl, int32 certLen, int32 lsize,
 
     if (certLen > 0)
     {
-        cert = ssl->keys->cert;
-        while (cert)
-        {
-            certLen = cert->binLen;
-            if (certLen > 0)
-            {
-                *tmp = (unsigned char) ((certLen & 0xFF0000) >> 16); tmp++;
-                *tmp = (certLen & 0xFF00) >> 8; tmp++;
-                *tmp = (certLen & 0xFF); tmp++;
-                memcpy(tmp, cert->unparsedBin, certLen);
-                tmp += certLen;
-            }
-            cert = cert->next;
-        }
+        /* Encoded when the keys were loaded */
+        memcpy(tmp, ssl->keys->certMsg, ssl->keys->certMsgLen);
+        tmp += ssl->keys->certMsgLen;
     }
 
 /*
@@ -216,7 +204,6 @@ int32 dtlsWriteCertificate(ssl_t *ssl, int32 certLen, int32 lsize,
 int32 dtlsWriteCertificateRequest(psPool_t *pool, ssl_t *ssl, int32 certLen,
     int32 certCount, int32 sigHashLen, unsigned char *c)
 {
-    psX509Cert_t *cert;
     unsigned char *tmp, *tmpStart;
     int32 tmpLen, wLen;
 
@@ -300,23 +287,13 @@ int32 dtlsWriteCertificateRequest(psPool_t *pool, ssl_t *ssl, int32 certLen,
     }
 #   endif /* TLS_1_2 */
 
-#   if defined(USE_CLIENT_SIDE_SSL) || defined(USE_CLIENT_AUTH)
-    cert = ssl->keys->CAcerts;
-#   else
-    cert = NULL;
-#   endif
-    if (cert)
+    if (ssl->keys->caDnMsg)
     {
         *tmp = ((certLen + (certCount * 2)) & 0xFF00) >> 8; tmp++;
         *tmp = (certLen + (certCount * 2)) & 0xFF; tmp++;
-        while (cert)
-        {
-            *tmp = (cert->subject.dnencLen & 0xFF00) >> 8; tmp++;
-            *tmp = cert->subject.dnencLen & 0xFF; tmp++;
-            memcpy(tmp, cert->subject.dnenc, cert->subject.dnencLen);
-            tmp += cert->subject.dnencLen;
-            cert = cert->next;
-        }
+        /* Encoded when the keys were loaded */
+        memcpy(tmp, ssl->keys->caDnMsg, ssl->keys->caDnMsgLen);
+        tmp += ssl->keys->caDnMsgLen;
     }
     else
     {
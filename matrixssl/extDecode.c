@@ -657,18 +657,11 @@ static int ClientHelloExt(ssl_t *ssl, unsigned short extType, unsigned short ext
             return MATRIXSSL_ERROR;
         }
         c += dataLen;
-        /* Currently, the OCSPResponse must be loaded into the key material
-            so we check if that exists to determine if we will reply with
-            the extension and CERTIFICATE_STATUS handshake message */
-        if (ssl->keys->OCSPResponseBufLen > 0 &&
-            ssl->keys->OCSPResponseBuf != NULL)
-        {
-            ssl->extFlags.status_request = 1;
-        }
-        else
-        {
-            psTraceInfo("Client requesting OCSP but we have no response\n");
-        }
+        /* Whether we reply with the extension and CERTIFICATE_STATUS
+            depends on the OCSPResponse loaded into the key material, and
+            the SNI callback may still replace the keys.  The response is
+            checked for and pinned at the end of parseClientHello. */
+        ssl->extFlags.status_request = 1;
 
         break;
 # endif
@@ -650,6 +650,30 @@ SKIP_STANDARD_RESUMPTION:
 
     matrixSslSetKexFlags(ssl);
 
+# ifdef USE_OCSP
+    /* The SNI callback has had its say, so ssl->keys are final.  Their
+        OCSPResponse decides whether we reply with the extension and
+        CERTIFICATE_STATUS, and is pinned for this handshake in case the
+        keys get a newer one before CERTIFICATE_STATUS is written. */
+    matrixSslReleaseOCSPStaple(ssl->staple);
+    ssl->staple = NULL;
+    if (ssl->extFlags.status_request &&
+        (ssl->staple = matrixSslAcquireOCSPStaple(ssl->keys)) == NULL)
+    {
+        psTraceInfo("Client requesting OCSP but we have no response\n");
+        ssl->extFlags.status_request = 0;
+    }
+# endif
+# ifdef USE_HS_TRANSCRIPT
+    /* Without a client Certificate to come, or before TLS 1.2, there will
+        be no Ed25519 CertificateVerify to check */
+    if ((ssl->flags & SSL_FLAGS_RESUMED) ||
+        !(ssl->flags & SSL_FLAGS_TLS_1_2))
+    {
+        sslFreeHSTranscript(ssl);
+    }
+# endif
+
     /* If we're resuming a handshake, then the next handshake message we
         expect is the finished message.  Otherwise we do the full handshake */
     if (ssl->flags & SSL_FLAGS_RESUMED)
@@ -715,8 +739,7 @@ SKIP_STANDARD_RESUMPTION:
             {
                 return MATRIXSSL_ERROR;
             }
-            if ((rc = psDhGenKeyInts(ssl->hsPool, ssl->keys->dhParams.size,
-                     &ssl->keys->dhParams.p, &ssl->keys->dhParams.g,
+            if ((rc = matrixSslGenEphemeralDhKey(ssl->keys, ssl->hsPool,
                      ssl->sec.dhKeyPriv, pkiData)) < 0)
             {
                 psFree(ssl->sec.dhKeyPriv, ssl->hsPool);
@@ -1341,6 +1364,9 @@ int32 parseCertificateVerify(ssl_t *ssl,
     unsigned char *c;
     psPool_t *cvpkiPool = NULL;
     void *pkiData = ssl->userPtr;
+#   ifdef USE_HS_TRANSCRIPT
+    int32 intrinsic = 0;
+#   endif
 
     c = *cp;
     rc = 0;
@@ -1399,6 +1425,14 @@ int32 parseCertificateVerify(ssl_t *ssl,
             certVerifyLen = SHA1_HASH_SIZE;
             break;
 #    endif
+
+#    ifdef USE_HS_TRANSCRIPT
+        case HASH_SIG_INTRINSIC:
+            /* Ed25519, HASH_SIG_MASK has rejected the other pairings */
+            intrinsic = 1;
+            certVerifyLen = 0;
+            break;
+#    endif
         default:
             ssl->err = SSL_ALERT_DECODE_ERROR;
             psTraceInfo("Invalid Certificate Verify message\n");
@@ -1430,6 +1464,36 @@ int32 parseCertificateVerify(ssl_t *ssl,
     }
     /*  The server side verification of client identity.  If we can match
         the signature we know the client has possesion of the private key. */
+#   ifdef USE_HS_TRANSCRIPT
+    if (intrinsic != (ssl->sec.cert->pubKeyAlgorithm == OID_ED25519_KEY_ALG))
+    {
+        psTraceInfo("CertificateVerify algorithm does not match cert key\n");
+        ssl->err = SSL_ALERT_ILLEGAL_PARAMETER;
+        return MATRIXSSL_ERROR;
+    }
+    if (intrinsic)
+    {
+        /* Signed over the messages preceding this one */
+        if (ssl->sec.hsTranscript.buf.buf == NULL ||
+            ssl->sec.hsTranscript.err)
+        {
+            psTraceInfo("No handshake transcript for Ed25519 certVerify\n");
+            ssl->err = SSL_ALERT_INTERNAL_ERROR;
+            return MATRIXSSL_ERROR;
+        }
+        rc = 0;
+        if (psEd25519Verify(&ssl->sec.cert->publicKey.key.ed25519,
+                ssl->sec.hsTranscript.buf.start, ssl->sec.hsTranscriptCvLen,
+                c, pubKeyLen, &rc) < 0 || rc != 1)
+        {
+            psTraceInfo("Can't verify certVerify sig\n");
+            ssl->err = SSL_ALERT_BAD_CERTIFICATE;
+            return MATRIXSSL_ERROR;
+        }
+        rc = MATRIXSSL_SUCCESS; /* done using rc as a temp */
+    }
+    else
+#   endif /* USE_HS_TRANSCRIPT */
 #   ifdef USE_ECC
     /* Need to read sig algorithm type out of cert itself */
     if (ssl->sec.cert->pubKeyAlgorithm == OID_ECDSA_KEY_ALG)
@@ -2027,6 +2091,10 @@ int32 parseServerKeyExchange(ssl_t *ssl,
 #  ifdef USE_ECC_CIPHER_SUITE
     uint32 res;
     const psEccCurve_t *curve;
+#   ifdef USE_ED25519
+    int32 intrinsic = 0;
+    unsigned char *tbs;
+#   endif
 #  endif
     void *pkiData = ssl->userPtr;
 
@@ -2297,6 +2365,14 @@ int32 parseServerKeyExchange(ssl_t *ssl,
             {
                 hashSize = SHA1_HASH_SIZE;
             }
+#   if defined(USE_ECC_CIPHER_SUITE) && defined(USE_ED25519)
+            else if (skeHashSigAlg ==
+                     ((HASH_SIG_INTRINSIC << 8) | HASH_SIG_ED25519))
+            {
+                /* Signature is over the params themselves */
+                intrinsic = 1;
+            }
+#   endif
             else
             {
                 psTraceIntInfo("Unsupported hashAlg SKE parse: %d\n",
@@ -2482,6 +2558,41 @@ int32 parseServerKeyExchange(ssl_t *ssl,
         }
 #  endif /* USE_RSA_CIPHER_SUITE */
 #  ifdef USE_ECC_CIPHER_SUITE
+#   ifdef USE_ED25519
+        if ((ssl->flags & SSL_FLAGS_DHE_WITH_DSA) &&
+            intrinsic != (ssl->sec.cert->publicKey.type == PS_ED25519))
+        {
+            psTraceInfo("SKE signature algorithm does not match cert key\n");
+            ssl->err = SSL_ALERT_ILLEGAL_PARAMETER;
+            return MATRIXSSL_ERROR;
+        }
+        if ((ssl->flags & SSL_FLAGS_DHE_WITH_DSA) && intrinsic)
+        {
+            /* RFC 8422: Ed25519 signs randoms || params directly */
+            hashSize = (2 * SSL_HS_RANDOM_SIZE) + (uint32) (sigStop - sigStart);
+            if ((tbs = psMalloc(ssl->hsPool, hashSize)) == NULL)
+            {
+                return SSL_MEM_ERROR;
+            }
+            memcpy(tbs, ssl->sec.clientRandom, SSL_HS_RANDOM_SIZE);
+            memcpy(tbs + SSL_HS_RANDOM_SIZE, ssl->sec.serverRandom,
+                SSL_HS_RANDOM_SIZE);
+            memcpy(tbs + (2 * SSL_HS_RANDOM_SIZE), sigStart,
+                (uint32) (sigStop - sigStart));
+            i = 0;
+            res = psEd25519Verify(&ssl->sec.cert->publicKey.key.ed25519,
+                tbs, hashSize, c, pubDhLen, &i);
+            psFree(tbs, ssl->hsPool);
+            c += pubDhLen;
+            if (res != PS_SUCCESS || i != 1)
+            {
+                psTraceInfo("Can't verify serverKeyExchange sig\n");
+                ssl->err = SSL_ALERT_BAD_CERTIFICATE;
+                return MATRIXSSL_ERROR;
+            }
+        }
+        else
+#   endif /* USE_ED25519 */
         if (ssl->flags & SSL_FLAGS_DHE_WITH_DSA)
         {
 /*
@@ -2700,8 +2811,14 @@ int32 parseCertificateStatus(ssl_t *ssl, int32 hsLen, unsigned char **cp,
         AND passing through the server chain as well because some real
         world examples we have seen use the intermediate cert as the
         OCSP responder */
-    if ((rc = psOcspResponseValidateOld(ssl->hsPool, ssl->keys->CAcerts,
-             ssl->sec.cert, &response)) < 0)
+#  ifdef USE_OCSP_CACHE
+    rc = matrixSslValidateOCSPResponseCached(ssl->keys, ssl->hsPool,
+        ssl->sec.cert, &response);
+#  else
+    rc = psOcspResponseValidateOld(ssl->hsPool, ssl->keys->CAcerts,
+        ssl->sec.cert, &response);
+#  endif
+    if (rc < 0)
     {
         /* Couldn't validate */
         psX509FreeCert(response.OCSPResponseCert);
@@ -3005,6 +3122,17 @@ int32 parseCertificateRequest(ssl_t *ssl, int32 hsLen, unsigned char **cp,
                     }
                 }
 #     endif
+#     ifdef USE_ED25519
+                /* Same test covers an Ed25519 key and an Ed25519 issuer */
+                if (cert->pubKeyAlgorithm == OID_ED25519_KEY_ALG ||
+                    cert->sigAlgorithm == OID_ED25519_SIG)
+                {
+                    if (!(hashSigAlg & HASH_SIG_ED25519_MASK))
+                    {
+                        sigAlgMatch = 0;
+                    }
+                }
+#     endif
 #    endif      /* USE_ECC */
                 cert = cert->next;
             }
@@ -3263,6 +3391,9 @@ int32 parseFinished(ssl_t *ssl, int32 hsLen,
     }
 # endif
 #endif /* USE_DTLS */
+#ifdef USE_HS_TRANSCRIPT
+    sslFreeHSTranscript(ssl);
+#endif
     ssl->hsPool = NULL;
 
     *cp = c;
@@ -3282,6 +3413,11 @@ int32 parseCertificate(ssl_t *ssl, unsigned char **cp, unsigned char *end)
     int32 rc, i, certChainLen, parseLen = 0;
     void *pkiData = ssl->userPtr;
     int32 pathLen;
+#  ifdef USE_CERT_CHAIN_CACHE
+    unsigned char *chainStart = NULL;
+    unsigned char chainId[SHA256_HASH_SIZE];
+    psSha256_t sha;
+#  endif
 
     psTraceStrHs(">>> %s parsing CERTIFICATE message\n",
         (ssl->flags & SSL_FLAGS_SERVER) ? "Server" : "Client");
@@ -3389,6 +3525,9 @@ SKIP_CERT_CHAIN_INIT:
         goto RESUME_VALIDATE_CERTS;
     }
 #  endif /* USE_HARDWARE_CRYPTO_PKA || USE_EXT_CERTIFICATE_VERIFY_SIGNING */
+#  ifdef USE_CERT_CHAIN_CACHE
+    chainStart = c;
+#  endif
          /* Chain must be at least 3 b certLen */
     while (certChainLen >= 3)
     {
@@ -3405,9 +3544,15 @@ SKIP_CERT_CHAIN_INIT:
             psTraceInfo("Invalid certificate length\n");
             return MATRIXSSL_ERROR;
         }
+        /* The kept DER also backs the serial number, signature and
+           any retained DN and subjectAltName DER */
         if (ssl->bFlags & BFLAG_KEEP_PEER_CERT_DER)
         {
-            certFlags |= CERT_STORE_UNPARSED_BUFFER;
+            certFlags |= CERT_STORE_UNPARSED_BUFFER | CERT_ZERO_COPY;
+        }
+        if (ssl->bFlags & BFLAG_LAZY_PEER_CERTS)
+        {
+            certFlags |= CERT_LAZY_PARSE;
         }
 /*
             Extract the binary cert message into the cert structure
@@ -3482,9 +3627,30 @@ SKIP_CERT_CHAIN_INIT:
 RESUME_VALIDATE_CERTS:
 #  endif /* USE_HARDWARE_CRYPTO_PKA || USE_EXT_CERTIFICATE_VERIFY_SIGNING */
 
-    rc = matrixValidateCertsExt(ssl->hsPool, ssl->sec.cert,
-        ssl->keys == NULL ? NULL : ssl->keys->CAcerts, ssl->expectedName,
+#  ifdef USE_CERT_CHAIN_CACHE
+    /* The chain cache is keyed by the certificate_list as received */
+    if (chainStart != NULL && ssl->keys != NULL &&
+        ssl->keys->chainCache != NULL)
+    {
+        psSha256PreInit(&sha);
+        psSha256Init(&sha);
+        psSha256Update(&sha, chainStart, (uint32) (c - chainStart));
+        psSha256Final(&sha, chainId);
+    }
+    else
+    {
+        chainStart = NULL;
+    }
+    rc = matrixSslValidateCertsCached(ssl->keys,
+        chainStart == NULL ? NULL : chainId, ssl->hsPool, ssl->sec.cert,
+        ssl->expectedName, &foundIssuer, pkiData, ssl->memAllocPtr,
+        &ssl->validateCertsOpts);
+#  else
+    rc = matrixValidateCertsIndexed(ssl->hsPool, ssl->sec.cert,
+        ssl->keys == NULL ? NULL : ssl->keys->CAcerts,
+        ssl->keys == NULL ? NULL : ssl->keys->caIndex, ssl->expectedName,
         &foundIssuer, pkiData, ssl->memAllocPtr, &ssl->validateCertsOpts);
+#  endif /* USE_CERT_CHAIN_CACHE */
 
     if (rc == PS_MEM_FAIL)
     {
@@ -3680,6 +3846,15 @@ STRAIGHT_TO_USER_CALLBACK:
     if (ssl->flags & SSL_FLAGS_SERVER)
     {
         ssl->hsState = SSL_HS_CLIENT_KEY_EXCHANGE;
+#  ifdef USE_HS_TRANSCRIPT
+        /* Only an Ed25519 client key makes a CertificateVerify that needs
+            the buffered messages */
+        if (ssl->sec.cert == NULL ||
+            ssl->sec.cert->pubKeyAlgorithm != OID_ED25519_KEY_ALG)
+        {
+            sslFreeHSTranscript(ssl);
+        }
+#  endif
     }
     else
     {
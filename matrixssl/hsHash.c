@@ -65,6 +65,39 @@
     @return < 0 on failure.
     @param[in,out] ssl TLS context
  */
+# ifdef USE_HS_TRANSCRIPT
+/******************************************************************************/
+/*
+    Ed25519 is a PureEdDSA signature, so a CertificateVerify made with it
+    covers the handshake messages rather than a digest of them. Only the
+    handshakes that can need one pay for the buffer: a client that will
+    authenticate with an Ed25519 key, or a server that requests client
+    authentication.  The messages before the client Certificate cannot be
+    rebuilt later, so the server buffers from the start and drops the
+    transcript as soon as the handshake rules Ed25519 out: on resumption
+    or a version below TLS 1.2 in parseClientHello, and on any other client
+    key in parseCertificate.
+ */
+static int32 wantHSTranscript(ssl_t *ssl)
+{
+    if (ssl->flags & SSL_FLAGS_SERVER)
+    {
+        return (ssl->flags & SSL_FLAGS_CLIENT_AUTH) ? 1 : 0;
+    }
+    return (ssl->keys != NULL && ssl->keys->privKey.type == PS_ED25519);
+}
+
+void sslFreeHSTranscript(ssl_t *ssl)
+{
+    if (ssl->sec.hsTranscript.buf.buf != NULL)
+    {
+        psDynBufUninit(&ssl->sec.hsTranscript);
+    }
+    memset(&ssl->sec.hsTranscript, 0, sizeof(psDynBuf_t));
+    ssl->sec.hsTranscriptCvLen = 0;
+}
+# endif /* USE_HS_TRANSCRIPT */
+
 int32_t sslInitHSHash(ssl_t *ssl)
 {
 # ifdef USE_DTLS
@@ -95,6 +128,17 @@ int32_t sslInitHSHash(ssl_t *ssl)
 #  endif
 # endif
 
+# ifdef USE_HS_TRANSCRIPT
+    sslFreeHSTranscript(ssl);
+    if (wantHSTranscript(ssl))
+    {
+        if (psDynBufInit(ssl->hsPool, &ssl->sec.hsTranscript, 1024) == NULL)
+        {
+            return PS_MEM_FAIL;
+        }
+    }
+# endif
+
     return 0;
 }
 
@@ -151,6 +195,19 @@ int32_t sslUpdateHSHash(ssl_t *ssl, const unsigned char *in, psSize_t len)
 
 # endif
 
+# ifdef USE_HS_TRANSCRIPT
+    if (ssl->sec.hsTranscript.buf.buf != NULL)
+    {
+        unsigned char *t;
+
+        if ((t = psDynBufAppendSize(&ssl->sec.hsTranscript, len)) == NULL)
+        {
+            return PS_MEM_FAIL;
+        }
+        memcpy(t, in, len);
+    }
+# endif
+
     return 0;
 }
 
@@ -43,6 +43,13 @@ static const char copyright[] =
 static int32 verifyReadKeys(psPool_t *pool, sslKeys_t *keys, void *poolUserPtr);
 # endif /* USE_SERVER_SIDE_SSL || USE_CLIENT_AUTH */
 #endif  /* USE_RSA || USE_ECC */
+#ifdef REQUIRE_DH_PARAMS
+static void dhRingDrop(dhEphemeralRing_t *ring);
+static void dhRingClose(sslKeys_t *keys);
+#endif /* REQUIRE_DH_PARAMS */
+#if defined(USE_ECC_EPHEMERAL_POOL) || defined(REQUIRE_DH_PARAMS)
+static void ephemeralCacheForked(sslKeys_t *keys);
+#endif
 
 #ifdef USE_SERVER_SIDE_SSL
 
@@ -84,7 +91,32 @@ static int32 matrixSslLoadKeyMaterialMem(sslKeys_t *keys,
                                          const unsigned char *privBuf,
                                          int32 privLen, const unsigned char *CAbuf, int32 CAlen,
                                          int32 privKeyType);
+# ifdef MATRIX_USE_FILE_SYSTEM
+static int32 matrixSslParseKeyMaterial(sslKeys_t *keys, const char *certFile,
+                                       const char *privFile, const char *privPass, const char *CAfile,
+                                       int32 privKeyType);
+# endif
+static int32 matrixSslParseKeyMaterialMem(sslKeys_t *keys,
+                                          const unsigned char *certBuf, int32 certLen,
+                                          const unsigned char *privBuf,
+                                          int32 privLen, const unsigned char *CAbuf, int32 CAlen,
+                                          int32 privKeyType);
 #endif /* USE_RSA || USE_ECC */
+#if defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH)
+# ifndef USE_ONLY_PSK_CIPHER_SUITE
+static int32 matrixSslEncodeKeyMessages(sslKeys_t *keys);
+# endif /* !USE_ONLY_PSK_CIPHER_SUITE */
+static void matrixSslFreeKeyMessages(sslKeys_t *keys);
+#endif /* USE_SERVER_SIDE_SSL || USE_CLIENT_AUTH */
+#ifdef USE_CERT_VALIDATE
+static int32 matrixSslIndexCAs(sslKeys_t *keys);
+#endif
+#ifdef USE_CERT_CHAIN_CACHE
+static void certChainCacheClose(sslKeys_t *keys);
+#endif
+#ifdef USE_OCSP_CACHE
+static void ocspCacheClose(sslKeys_t *keys);
+#endif
 
 /******************************************************************************/
 /*
@@ -96,6 +128,11 @@ static int32 matrixSslLoadKeyMaterialMem(sslKeys_t *keys,
  */
 static char g_config[32] = "N";
 
+#ifdef USE_ASYNC_PKA
+/* Runs the handshake PKA jobs of sessions opened with asyncPka */
+static psWorkerPool_t *g_pkaWorker;
+#endif /* USE_ASYNC_PKA */
+
 int32_t matrixSslOpenWithConfig(const char *config)
 {
     unsigned long clen;
@@ -122,6 +159,7 @@ int32_t matrixSslOpenWithConfig(const char *config)
         psError("pscrypto open failure\n");
         return PS_FAIL;
     }
+    sslInitCipherIndex();
 
 # ifdef USE_SERVER_SIDE_SSL
 #  ifdef USE_SHARED_SESSION_CACHE
@@ -166,6 +204,13 @@ int32_t matrixSslOpenWithConfig(const char *config)
     matrixDtlsSetPmtu(-1);
 #endif /* USE_DTLS */
 
+#ifdef USE_ASYNC_PKA
+    if ((rc = psWorkerPoolOpen(NULL, &g_pkaWorker, ASYNC_PKA_THREADS)) < 0)
+    {
+        return rc;
+    }
+#endif /* USE_ASYNC_PKA */
+
     return PS_SUCCESS;
 }
 
@@ -197,6 +242,11 @@ void matrixSslClose(void)
     }
 #  endif
 # endif /* USE_SERVER_SIDE_SSL */
+# ifdef USE_ASYNC_PKA
+    /* Runs any job still queued, sessions must be deleted before this */
+    psWorkerPoolClose(g_pkaWorker);
+    g_pkaWorker = NULL;
+# endif /* USE_ASYNC_PKA */
     psCryptoClose();
     *g_config = 'N';
 }
@@ -215,7 +265,8 @@ int32_t matrixSslNewKeys(sslKeys_t **keys, void *memAllocUserPtr)
     psPool_t *pool = NULL;
     sslKeys_t *lkeys;
 
-#if  defined(USE_ECC) || defined(REQUIRE_DH_PARAMS)
+#if  defined(USE_ECC) || defined(REQUIRE_DH_PARAMS) || \
+    (defined(USE_OCSP) && defined(USE_SERVER_SIDE_SSL))
     int32_t rc;
 #endif
 
@@ -236,6 +287,22 @@ int32_t matrixSslNewKeys(sslKeys_t **keys, void *memAllocUserPtr)
         return rc;
     }
 #endif
+#if defined(USE_OCSP) && defined(USE_SERVER_SIDE_SSL)
+    rc = psCreateMutex(&lkeys->stapleLock, 0);
+    if (rc < 0)
+    {
+# if  defined(USE_ECC) || defined(REQUIRE_DH_PARAMS)
+        psDestroyMutex(&lkeys->cache.lock);
+# endif
+        psFree(lkeys, pool);
+        return rc;
+    }
+#endif
+#ifdef REQUIRE_DH_PARAMS
+    lkeys->cache.dhUsage = 1;
+    lkeys->cache.dhSeconds = DH_EPHEMERAL_CACHE_SECONDS;
+#endif
+    matrixSslUpdateCipherEligibility(lkeys);
     *keys = lkeys;
     return PS_SUCCESS;
 }
@@ -308,6 +375,13 @@ int32 psTestUserEcID(int32 id, int32 ecFlags)
             return PS_FAILURE;
         }
     }
+    else if (id == 29)
+    {
+        if (!(ecFlags & IS_X25519))
+        {
+            return PS_FAILURE;
+        }
+    }
     else
     {
         return PS_UNSUPPORTED_FAIL;
@@ -353,6 +427,10 @@ int32 curveIdToFlag(int32 id)
     {
         return IS_BRAIN512R1;
     }
+    else if (id == 29)
+    {
+        return IS_X25519;
+    }
     return 0;
 }
 
@@ -484,6 +562,11 @@ int32 matrixSslLoadPkcs12(sslKeys_t *keys, const unsigned char *certFile,
             keys->cert = NULL;
         }
         psClearPubKey(&keys->privKey);
+#  if (defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH)) && \
+    !defined(USE_ONLY_PSK_CIPHER_SUITE)
+        matrixSslEncodeKeyMessages(keys);
+#  endif /* (USE_SERVER_SIDE_SSL || USE_CLIENT_AUTH) && !USE_ONLY_PSK... */
+        matrixSslUpdateCipherEligibility(keys);
         return rc;
     }
 #  ifdef USE_CERT_PARSE
@@ -496,10 +579,18 @@ int32 matrixSslLoadPkcs12(sslKeys_t *keys, const unsigned char *certFile,
         psX509FreeCert(keys->cert);
         psClearPubKey(&keys->privKey);
         keys->cert = NULL;
+#   ifndef USE_ONLY_PSK_CIPHER_SUITE
+        matrixSslEncodeKeyMessages(keys);
+#   endif /* !USE_ONLY_PSK_CIPHER_SUITE */
+        matrixSslUpdateCipherEligibility(keys);
         return PS_CERT_AUTH_FAIL;
     }
+#   ifndef USE_ONLY_PSK_CIPHER_SUITE
+    rc = matrixSslEncodeKeyMessages(keys);
+#   endif /* !USE_ONLY_PSK_CIPHER_SUITE */
 #  endif /* USE_SERVER_SIDE_SSL || USE_CLIENT_AUTH */
-    return PS_SUCCESS;
+    matrixSslUpdateCipherEligibility(keys);
+    return rc < 0 ? rc : PS_SUCCESS;
 }
 # endif /* USE_PKCS12 */
 
@@ -573,6 +664,12 @@ int32_t matrixSslLoadKeysMem(sslKeys_t *keys,
         return matrixSslLoadKeyMaterialMem(keys, certBuf, certLen,
                 privBuf, privLen, CAbuf, CAlen, PS_ECC);
         break;
+#  ifdef USE_ED25519
+    case 3: /* Ed25519 */
+        return matrixSslLoadKeyMaterialMem(keys, certBuf, certLen,
+                privBuf, privLen, CAbuf, CAlen, PS_ED25519);
+        break;
+#  endif
     }
 
     return PS_FAILURE;
@@ -617,14 +714,54 @@ int32_t matrixSslLoadKeys(sslKeys_t *keys, const char *certFile,
         return matrixSslLoadKeyMaterial(keys, certFile, privFile, privPass,
                 CAfile, PS_ECC);
         break;
+#  ifdef USE_ED25519
+    case 3: /* Ed25519 */
+        return matrixSslLoadKeyMaterial(keys, certFile, privFile, privPass,
+                CAfile, PS_ED25519);
+        break;
+#  endif
     }
 
     return PS_FAILURE;
 }
 
+/*
+    The parse may fail after dropping key material loaded by an earlier call,
+    so the suites the keys can serve are recomputed either way.
+ */
 static int32 matrixSslLoadKeyMaterial(sslKeys_t *keys, const char *certFile,
     const char *privFile, const char *privPass, const char *CAfile,
     int32 privKeyType)
+{
+    int32 rc;
+#  if ((defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH)) && \
+    !defined(USE_ONLY_PSK_CIPHER_SUITE)) || defined(USE_CERT_VALIDATE)
+    int32 err;
+#  endif
+
+    rc = matrixSslParseKeyMaterial(keys, certFile, privFile, privPass, CAfile,
+        privKeyType);
+#  if (defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH)) && \
+    !defined(USE_ONLY_PSK_CIPHER_SUITE)
+    if (keys != NULL && (err = matrixSslEncodeKeyMessages(keys)) < 0 &&
+        rc >= 0)
+    {
+        rc = err;
+    }
+#  endif /* (USE_SERVER_SIDE_SSL || USE_CLIENT_AUTH) && !USE_ONLY_PSK... */
+#  ifdef USE_CERT_VALIDATE
+    if (keys != NULL && (err = matrixSslIndexCAs(keys)) < 0 && rc >= 0)
+    {
+        rc = err;
+    }
+#  endif
+    matrixSslUpdateCipherEligibility(keys);
+    return rc;
+}
+
+static int32 matrixSslParseKeyMaterial(sslKeys_t *keys, const char *certFile,
+    const char *privFile, const char *privPass, const char *CAfile,
+    int32 privKeyType)
 {
     psPool_t *pool;
     int32 err, flags;
@@ -636,9 +773,10 @@ static int32 matrixSslLoadKeyMaterial(sslKeys_t *keys, const char *certFile,
     pool = keys->pool;
 
 /*
-    Setting flags to store raw ASN.1 stream for SSL CERTIFICATE message use
+    Setting flags to store raw ASN.1 stream for SSL CERTIFICATE message use.
+    The other variable length fields of the certs are kept as views into it.
  */
-    flags = CERT_STORE_UNPARSED_BUFFER;
+    flags = CERT_STORE_UNPARSED_BUFFER | CERT_ZERO_COPY;
 
 #  ifdef USE_CLIENT_AUTH
 /*
@@ -725,6 +863,28 @@ static int32 matrixSslLoadKeyMaterial(sslKeys_t *keys, const char *certFile,
             }
             keys->privKey.keysize = psEccSize(&keys->privKey.key.ecc);
         }
+#    ifdef USE_ED25519
+        if (privKeyType == PS_ED25519)
+        {
+            /* Only carried in PKCS#8, which the generic parser handles */
+            err = psParseUnknownPrivKey(pool, 1, (char *) privFile,
+                (char *) privPass, &keys->privKey);
+            if (err >= 0 && keys->privKey.type != PS_ED25519)
+            {
+                psClearPubKey(&keys->privKey);
+                err = PS_UNSUPPORTED_FAIL;
+            }
+            if (err < 0)
+            {
+                if (keys->cert)
+                {
+                    psX509FreeCert(keys->cert);
+                    keys->cert = NULL;
+                }
+                return err;
+            }
+        }
+#    endif /* USE_ED25519 */
 #   endif /* USE_ECC */
 #  else
         psTraceStrInfo("Ignoring %s privFile in matrixSslReadKeys\n",
@@ -744,7 +904,7 @@ static int32 matrixSslLoadKeyMaterial(sslKeys_t *keys, const char *certFile,
 #  endif /* USE_SERVER_SIDE_SSL || USE_CLIENT_AUTH */
 
     /* Not necessary to store binary representations of CA certs */
-    flags &= ~CERT_STORE_UNPARSED_BUFFER;
+    flags &= ~(CERT_STORE_UNPARSED_BUFFER | CERT_ZERO_COPY);
 
     if (CAfile)
     {
@@ -782,6 +942,9 @@ static int32 matrixSslLoadKeyMaterial(sslKeys_t *keys, const char *certFile,
                 err = PS_CERT_AUTH_FAIL_EXTENSION;
 #   endif
             }
+#   if defined(USE_PUBKEY_PRECOMP) && defined(USE_CERT_PARSE)
+            psX509PrecomputeKeys(keys->CAcerts);
+#   endif
         }
 
 #ifdef ALLOW_CA_BUNDLE_PARTIAL_PARSE
@@ -838,6 +1001,217 @@ int32 matrixSslLoadEcKeysMem(sslKeys_t *keys, const unsigned char *certBuf,
         CAbuf, CAlen, PS_ECC);
 
 }
+
+# ifdef USE_ECC_EPHEMERAL_POOL
+/******************************************************************************/
+/*
+    Ephemeral key pool. Each curve that has been asked for gets a ring of
+    ready keys. A single background job tops up all rings, and generates
+    keys without holding keys->cache.lock. The free slot at head + count is
+    only written by that job and only becomes visible to handshakes when
+    'count' is incremented, so the lock is only held for bookkeeping and
+    for copying a key out.
+ */
+
+/* Find the ring of 'curve', creating it if there is room. Lock held. */
+static eccEphemeralRing_t *eccRingGet(sslKeys_t *keys,
+    const psEccCurve_t *curve)
+{
+    eccEphemeralRing_t **slot = NULL;
+    uint8_t i;
+
+    for (i = 0; i < ECC_EPHEMERAL_POOL_CURVES; i++)
+    {
+        if (keys->cache.eccRing[i] == NULL)
+        {
+            if (slot == NULL)
+            {
+                slot = &keys->cache.eccRing[i];
+            }
+        }
+        else if (keys->cache.eccRing[i]->curve == curve)
+        {
+            return keys->cache.eccRing[i];
+        }
+    }
+    if (slot == NULL)
+    {
+        return NULL;
+    }
+    if ((*slot = psMalloc(keys->pool, sizeof(eccEphemeralRing_t))) == NULL)
+    {
+        return NULL;
+    }
+    memset(*slot, 0x0, sizeof(eccEphemeralRing_t));
+    (*slot)->curve = curve;
+    return *slot;
+}
+
+/* Drop the oldest key of a ring. Lock held. */
+static void eccRingDrop(eccEphemeralRing_t *ring)
+{
+    psEccClearKey(&ring->key[ring->head]);
+    ring->head = (ring->head + 1) % ECC_EPHEMERAL_POOL_SIZE;
+    ring->count--;
+}
+
+/* Background job: fill every ring, one key at a time */
+static void eccRingRefill(void *arg)
+{
+    sslKeys_t *keys = arg;
+    eccEphemeralRing_t *ring;
+    psEccKey_t *key;
+    psTime_t t;
+    uint8_t i;
+
+    for (;; )
+    {
+        psLockMutex(&keys->cache.lock);
+        ring = NULL;
+        if (!keys->cache.eccClosing)
+        {
+            for (i = 0; i < ECC_EPHEMERAL_POOL_CURVES; i++)
+            {
+                if (keys->cache.eccRing[i] != NULL &&
+                    keys->cache.eccRing[i]->count < ECC_EPHEMERAL_POOL_SIZE)
+                {
+                    ring = keys->cache.eccRing[i];
+                    break;
+                }
+            }
+        }
+        if (ring == NULL)
+        {
+            /* Cleared under the same lock that found nothing to do, so a
+               handshake taking a key after this queues the job again */
+            keys->cache.eccRefillQueued = 0;
+            psUnlockMutex(&keys->cache.lock);
+            return;
+        }
+        key = &ring->key[(ring->head + ring->count) % ECC_EPHEMERAL_POOL_SIZE];
+        psUnlockMutex(&keys->cache.lock);
+
+        if (psEccGenKey(keys->pool, key, ring->curve, NULL) < 0)
+        {
+            psTraceInfo("Background ephemeral ECC key generation failed\n");
+            psLockMutex(&keys->cache.lock);
+            keys->cache.eccRefillQueued = 0;
+            psUnlockMutex(&keys->cache.lock);
+            return;
+        }
+        psGetTime(&t, keys->poolUserPtr);
+
+        psLockMutex(&keys->cache.lock);
+        i = (ring->head + ring->count) % ECC_EPHEMERAL_POOL_SIZE;
+        ring->time[i] = t;
+        ring->use[i] = 0;
+        ring->count++;
+        keys->cache.pid = psGetProcessId();
+        psUnlockMutex(&keys->cache.lock);
+    }
+}
+
+/**
+    Take an ephemeral ECC key for ECDHE key exchange from the pool of 'keys'.
+    If the pool of the curve is empty the key is generated by the caller,
+    and the background job is queued to refill it.
+    @param[in] keys Keys structure holding the pool
+    @param[out] ecc Receives a copy of the key, or NULL to only start
+        filling the pool for 'curve'.
+    @param[in] curve ECC curve of the key.
+    @param[in] hwCtx Context for hardware crypto.
+ */
+int32_t matrixSslGenEphemeralEcKey(sslKeys_t *keys, psEccKey_t *ecc,
+    const psEccCurve_t *curve, void *hwCtx)
+{
+    eccEphemeralRing_t *ring;
+    psTime_t t;
+    int32_t rc;
+    uint8_t kick;
+
+    psAssert(keys && curve);
+    ephemeralCacheForked(keys);
+    psGetTime(&t, keys->poolUserPtr);
+    rc = PS_FAILURE;
+    kick = 0;
+    psLockMutex(&keys->cache.lock);
+    ring = eccRingGet(keys, curve);
+    while (ring != NULL && ring->count > 0)
+    {
+        if (psDiffMsecs(ring->time[ring->head], t, keys->poolUserPtr) >
+            (1000 * ECC_EPHEMERAL_CACHE_SECONDS))
+        {
+            eccRingDrop(ring);
+            continue;
+        }
+        if (ecc == NULL)
+        {
+            rc = PS_SUCCESS;
+            break;
+        }
+        rc = psEccCopyKey(ecc, &ring->key[ring->head]);
+        if (rc == PS_SUCCESS &&
+            ++ring->use[ring->head] >= ECC_EPHEMERAL_POOL_USAGE)
+        {
+            eccRingDrop(ring);
+        }
+        break;
+    }
+    if (ring != NULL && ring->count < ECC_EPHEMERAL_POOL_SIZE &&
+        !keys->cache.eccRefillQueued && !keys->cache.eccClosing)
+    {
+        if (keys->cache.eccWorker != NULL ||
+            psWorkerPoolOpen(keys->pool, &keys->cache.eccWorker, 1) == PS_SUCCESS)
+        {
+            keys->cache.pid = psGetProcessId();
+            keys->cache.eccRefillQueued = 1;
+            kick = 1;
+        }
+    }
+    psUnlockMutex(&keys->cache.lock);
+
+    if (kick)
+    {
+        psWorkerJobInit(&keys->cache.eccRefill, eccRingRefill, keys);
+        psWorkerPoolSubmit(keys->cache.eccWorker, &keys->cache.eccRefill);
+    }
+    if (rc == PS_SUCCESS || ecc == NULL)
+    {
+        return PS_SUCCESS;
+    }
+    psTraceStrInfo("Generating ephemeral %s key (pool empty)\n", curve->name);
+    return psEccGenKey(keys->pool, ecc, curve, hwCtx);
+}
+
+/* Stop the refill job and free the pool */
+static void eccRingClose(sslKeys_t *keys)
+{
+    eccEphemeralRing_t *ring;
+    uint8_t i;
+
+    ephemeralCacheForked(keys);
+    psLockMutex(&keys->cache.lock);
+    keys->cache.eccClosing = 1;
+    psUnlockMutex(&keys->cache.lock);
+    /* Waits for a running refill, which stops after its current key */
+    psWorkerPoolClose(keys->cache.eccWorker);
+    keys->cache.eccWorker = NULL;
+    for (i = 0; i < ECC_EPHEMERAL_POOL_CURVES; i++)
+    {
+        if ((ring = keys->cache.eccRing[i]) == NULL)
+        {
+            continue;
+        }
+        while (ring->count > 0)
+        {
+            eccRingDrop(ring);
+        }
+        psFree(ring, keys->pool);
+        keys->cache.eccRing[i] = NULL;
+    }
+}
+
+# else
 /**
     Generate and cache an ephemeral ECC key for later use in ECDHE key exchange.
     @param[out] keys Keys structure to hold ephemeral keys
@@ -848,13 +1222,13 @@ int32 matrixSslLoadEcKeysMem(sslKeys_t *keys, const unsigned char *certBuf,
 int32_t matrixSslGenEphemeralEcKey(sslKeys_t *keys, psEccKey_t *ecc,
     const psEccCurve_t *curve, void *hwCtx)
 {
-# if ECC_EPHEMERAL_CACHE_USAGE > 0
+#  if ECC_EPHEMERAL_CACHE_USAGE > 0
     psTime_t t;
-# endif
+#  endif
     int32_t rc;
 
     psAssert(keys && curve);
-# if ECC_EPHEMERAL_CACHE_USAGE > 0
+#  if ECC_EPHEMERAL_CACHE_USAGE > 0
     psGetTime(&t, keys->poolUserPtr);
     psLockMutex(&keys->cache.lock);
     if (keys->cache.eccPrivKey.curve != curve)
@@ -906,7 +1280,7 @@ L_REGEN:
     }
     psUnlockMutex(&keys->cache.lock);
     return rc;
-# else
+#  else
     /* Not using ephemeral caching. */
     if (ecc)
     {
@@ -915,8 +1289,50 @@ L_REGEN:
     }
     rc = PS_SUCCESS;
     return rc;
-# endif /* ECC_EPHEMERAL_CACHE_USAGE > 0 */
+#  endif /* ECC_EPHEMERAL_CACHE_USAGE > 0 */
+}
+# endif /* USE_ECC_EPHEMERAL_POOL */
+
+# if defined(USE_ECDSA_PRESIGN) && \
+    (defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH))
+/**
+    Return the queue of precomputed signing nonces for the ECC private key
+    of 'keys', creating it on first use. Returns NULL if the queue could not
+    be created, in which case signatures make up their nonces inline.
+ */
+psEccPresign_t *matrixSslGetEcdsaPresign(sslKeys_t *keys)
+{
+    psEccPresign_t *presign, *created;
+
+#  ifdef USE_ECC_EPHEMERAL_POOL
+    ephemeralCacheForked(keys);
+#  endif
+    psLockMutex(&keys->cache.lock);
+    presign = keys->cache.ecdsaPresign;
+    psUnlockMutex(&keys->cache.lock);
+    if (presign != NULL || keys->privKey.type != PS_ECC)
+    {
+        return presign;
+    }
+    /* Created without the lock, as that may compute the first nonce. If
+        another handshake got there first, theirs is kept. */
+    if (psEccNewPresign(keys->pool, &keys->privKey.key.ecc,
+            ECDSA_PRESIGN_DEPTH, &created) < 0)
+    {
+        psTraceInfo("ECDSA nonce precomputation not available\n");
+        return NULL;
+    }
+    psLockMutex(&keys->cache.lock);
+    if ((presign = keys->cache.ecdsaPresign) == NULL)
+    {
+        presign = keys->cache.ecdsaPresign = created;
+        created = NULL;
+    }
+    psUnlockMutex(&keys->cache.lock);
+    psEccDeletePresign(created);
+    return presign;
 }
+# endif /* USE_ECDSA_PRESIGN && (USE_SERVER_SIDE_SSL || USE_CLIENT_AUTH) */
 
 #endif  /* USE_ECC */
 
@@ -926,6 +1342,38 @@ static int32 matrixSslLoadKeyMaterialMem(sslKeys_t *keys,
     const unsigned char *privBuf,
     int32 privLen, const unsigned char *CAbuf, int32 CAlen,
     int32 privKeyType)
+{
+    int32 rc;
+# if ((defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH)) && \
+    !defined(USE_ONLY_PSK_CIPHER_SUITE)) || defined(USE_CERT_VALIDATE)
+    int32 err;
+# endif
+
+    rc = matrixSslParseKeyMaterialMem(keys, certBuf, certLen, privBuf, privLen,
+        CAbuf, CAlen, privKeyType);
+# if (defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH)) && \
+    !defined(USE_ONLY_PSK_CIPHER_SUITE)
+    if (keys != NULL && (err = matrixSslEncodeKeyMessages(keys)) < 0 &&
+        rc >= 0)
+    {
+        rc = err;
+    }
+# endif /* (USE_SERVER_SIDE_SSL || USE_CLIENT_AUTH) && !USE_ONLY_PSK... */
+# ifdef USE_CERT_VALIDATE
+    if (keys != NULL && (err = matrixSslIndexCAs(keys)) < 0 && rc >= 0)
+    {
+        rc = err;
+    }
+# endif
+    matrixSslUpdateCipherEligibility(keys);
+    return rc;
+}
+
+static int32 matrixSslParseKeyMaterialMem(sslKeys_t *keys,
+    const unsigned char *certBuf, int32 certLen,
+    const unsigned char *privBuf,
+    int32 privLen, const unsigned char *CAbuf, int32 CAlen,
+    int32 privKeyType)
 {
     psPool_t *pool;
     int32 err, flags = 0;
@@ -942,9 +1390,10 @@ static int32 matrixSslLoadKeyMaterialMem(sslKeys_t *keys,
     pool = keys->pool;
 
 /*
-    Setting flags to store raw ASN.1 stream for SSL CERTIFICATE message use
+    Setting flags to store raw ASN.1 stream for SSL CERTIFICATE message use.
+    The other variable length fields of the certs are kept as views into it.
  */
-    flags = CERT_STORE_UNPARSED_BUFFER;
+    flags = CERT_STORE_UNPARSED_BUFFER | CERT_ZERO_COPY;
 
 # ifdef USE_CLIENT_AUTH
 /*
@@ -1021,6 +1470,19 @@ static int32 matrixSslLoadKeyMaterialMem(sslKeys_t *keys,
             }
             keys->privKey.keysize = psEccSize(&keys->privKey.key.ecc);
         }
+#   if defined(USE_ED25519) && defined(USE_PKCS8)
+        if (privKeyType == PS_ED25519)
+        {
+            if ((err = psPkcs8ParsePrivBin(pool, (unsigned char *) privBuf,
+                     (uint32) privLen, NULL, &keys->privKey)) < 0 ||
+                keys->privKey.type != PS_ED25519)
+            {
+                psClearPubKey(&keys->privKey);
+                psX509FreeCert(keys->cert); keys->cert = NULL;
+                return err < 0 ? err : PS_UNSUPPORTED_FAIL;
+            }
+        }
+#   endif /* USE_ED25519 && USE_PKCS8 */
 #  endif /* USE_ECC */
 # else
         psTraceInfo("Ignoring privBuf in matrixSslReadKeysMem\n");
@@ -1040,7 +1502,7 @@ static int32 matrixSslLoadKeyMaterialMem(sslKeys_t *keys,
 /*
      Not necessary to store binary representations of CA certs
  */
-    flags &= ~CERT_STORE_UNPARSED_BUFFER;
+    flags &= ~(CERT_STORE_UNPARSED_BUFFER | CERT_ZERO_COPY);
 
     if (CAbuf)
     {
@@ -1069,6 +1531,12 @@ static int32 matrixSslLoadKeyMaterialMem(sslKeys_t *keys,
             }
 #endif /* ALLOW_CA_BUNDLE_PARTIAL_PARSE */
         }
+#  if defined(USE_PUBKEY_PRECOMP) && defined(USE_CERT_PARSE)
+        else
+        {
+            psX509PrecomputeKeys(keys->CAcerts);
+        }
+#  endif
 # else
         psTraceInfo("Ignoring CAbuf in matrixSslReadKeysMem\n");
 # endif /* USE_CLIENT_SIDE_SSL || USE_CLIENT_AUTH */
@@ -1093,42 +1561,395 @@ ca_load_failed:
 }
 #endif /* USE_RSA || USE_ECC */
 
-
-#if defined(USE_OCSP) && defined(USE_SERVER_SIDE_SSL)
-int32_t matrixSslLoadOCSPResponse(sslKeys_t *keys,
-    const unsigned char *OCSPResponseBuf, psSize_t OCSPResponseBufLen)
+#if (defined(USE_CLIENT_SIDE_SSL) || defined(USE_CLIENT_AUTH)) && \
+    defined(USE_CERT_PARSE)
+/******************************************************************************/
+/*
+    Load the trusted CAs from a trust store image made by
+    psX509NewTrustStore (see apps/ssl/trustStore.c) instead of a PEM or DER
+    bundle.  The certificates are parsed in place, each the first time it
+    is needed (see CERT_DEFERRED_PARSE), so the image must outlive keys.
+ */
+int32 matrixSslLoadTrustStoreMem(sslKeys_t *keys, const unsigned char *image,
+    psSizeL_t imageLen)
 {
-    psPool_t *pool;
+    int32 flags, err;
 
-    if (keys == NULL || OCSPResponseBuf == NULL || OCSPResponseBufLen == 0)
+    if (keys == NULL || image == NULL)
     {
         return PS_ARG_FAIL;
     }
-    pool = keys->pool;
-    PS_POOL_USED(pool);
-
-    /* Overwrite/Update any response being set */
-    if (keys->OCSPResponseBuf != NULL)
+    if (keys->CAcerts != NULL)
     {
-        psFree(keys->OCSPResponseBuf, pool);
-        keys->OCSPResponseBufLen = 0;
+        return PS_UNSUPPORTED_FAIL;
     }
-
-    keys->OCSPResponseBufLen = OCSPResponseBufLen;
-    if ((keys->OCSPResponseBuf = psMalloc(pool, OCSPResponseBufLen)) == NULL)
+    /* Each CA is parsed when first used, the entries of the image carry
+        what the index and the CERTIFICATE_REQUEST DN list need */
+    flags = CERT_DEFERRED_PARSE;
+# ifdef USE_CLIENT_AUTH
+    /* For an image with the other DN hash, which is parsed in full */
+    flags |= CERT_STORE_DN_BUFFER;
+# endif
+# ifdef ALLOW_CA_BUNDLE_PARTIAL_PARSE
+    flags |= CERT_ALLOW_BUNDLE_PARTIAL_PARSE;
+# endif
+    err = psX509ParseTrustStore(keys->pool, image, imageLen, &keys->CAcerts,
+        flags);
+    if (err == 0)
     {
-        return PS_MEM_FAIL;
+        psTraceInfo("Failed to load any CA certs.\n");
+        err = PS_PARSE_FAIL;
     }
-
-    memcpy(keys->OCSPResponseBuf, OCSPResponseBuf, OCSPResponseBufLen);
+    if (err < 0)
+    {
+        return err;
+    }
+    psTraceIntInfo("Loaded %d CA certs\n", err);
+    err = PS_SUCCESS;
+    if (keys->CAcerts->authFailFlags)
+    {
+        /* As for a CAfile, only the date check can fail here */
+        psAssert(keys->CAcerts->authFailFlags == PS_CERT_AUTH_FAIL_DATE_FLAG);
+# ifdef POSIX
+        err = PS_CERT_AUTH_FAIL_EXTENSION;
+# endif
+    }
+# if (defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH)) && \
+    !defined(USE_ONLY_PSK_CIPHER_SUITE)
+    if (err == PS_SUCCESS)
+    {
+        err = matrixSslEncodeKeyMessages(keys);
+    }
+# endif
+# ifdef USE_CERT_VALIDATE
+    if (err == PS_SUCCESS)
+    {
+        err = matrixSslIndexCAs(keys);
+    }
+# endif
+    if (err < 0)
+    {
+        /* Leave no references to the CAs or the image behind */
+        psX509FreeCert(keys->CAcerts);
+        keys->CAcerts = NULL;
+# if (defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH)) && \
+    !defined(USE_ONLY_PSK_CIPHER_SUITE)
+        matrixSslEncodeKeyMessages(keys);
+# endif
+# ifdef USE_CERT_VALIDATE
+        matrixSslIndexCAs(keys);
+# endif
+        return err;
+    }
+# ifdef USE_PUBKEY_PRECOMP
+    psX509PrecomputeKeys(keys->CAcerts);
+# endif
+    matrixSslUpdateCipherEligibility(keys);
     return PS_SUCCESS;
 }
-#endif /* USE_OCSP && USE_SERVER_SIDE_SSL */
 
-/******************************************************************************/
+# ifdef MATRIX_USE_FILE_SYSTEM
 /*
-    This will free the struct and any key material that was loaded via:
-        matrixSslLoadRsaKeys
+    As matrixSslLoadTrustStoreMem, over a read-only mapping of fileName that
+    every process loading the same file shares.  The mapping is released by
+    matrixSslDeleteKeys.
+ */
+int32 matrixSslLoadTrustStore(sslKeys_t *keys, const char *fileName)
+{
+    const unsigned char *image;
+    psSizeL_t imageLen;
+    int32 rc;
+
+    if (keys == NULL || fileName == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    if (keys->CAcerts != NULL)
+    {
+        return PS_UNSUPPORTED_FAIL;
+    }
+    if ((rc = psMapFile(keys->pool, fileName, &image, &imageLen)) < 0)
+    {
+        return rc;
+    }
+    if ((rc = matrixSslLoadTrustStoreMem(keys, image, imageLen)) < 0)
+    {
+        psUnmapFile(keys->pool, image, imageLen);
+        return rc;
+    }
+    keys->caImage = image;
+    keys->caImageLen = imageLen;
+    return PS_SUCCESS;
+}
+# endif /* MATRIX_USE_FILE_SYSTEM */
+#endif /* (USE_CLIENT_SIDE_SSL || USE_CLIENT_AUTH) && USE_CERT_PARSE */
+
+#ifdef USE_CERT_VALIDATE
+/******************************************************************************/
+/*
+    Index the trusted CAs by subject DN, so validation only tries the CAs
+    that can have issued the top of a peer chain.  Without an index, the
+    whole CA list is tried.
+ */
+static int32 matrixSslIndexCAs(sslKeys_t *keys)
+{
+    psX509FreeCertIndex(keys->caIndex);
+    keys->caIndex = NULL;
+    keys->caGeneration++;
+    return psX509NewCertIndex(keys->pool, keys->CAcerts, &keys->caIndex);
+}
+#endif /* USE_CERT_VALIDATE */
+
+#if defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH)
+/******************************************************************************/
+/*
+    The certificate list of the Certificate message and the DN list of the
+    CertificateRequest message only depend on the keys.  Encode them once
+    here, after every load, and a full handshake copies each in one go.
+ */
+static void matrixSslFreeKeyMessages(sslKeys_t *keys)
+{
+    if (keys->certMsg)
+    {
+        psFree(keys->certMsg, keys->pool);
+        keys->certMsg = NULL;
+    }
+    keys->certMsgLen = 0;
+    keys->certCount = 0;
+# if defined(USE_SERVER_SIDE_SSL) && defined(USE_CLIENT_AUTH)
+    if (keys->caDnMsg)
+    {
+        psFree(keys->caDnMsg, keys->pool);
+        keys->caDnMsg = NULL;
+    }
+    keys->caDnMsgLen = 0;
+    keys->caCount = 0;
+# endif
+}
+
+# ifndef USE_ONLY_PSK_CIPHER_SUITE
+static int32 matrixSslEncodeKeyMessages(sslKeys_t *keys)
+{
+    psX509Cert_t *cert;
+    unsigned char *c;
+    uint32 len;
+    uint16 count;
+
+    matrixSslFreeKeyMessages(keys);
+
+    len = count = 0;
+    for (cert = keys->cert; cert != NULL; cert = cert->next)
+    {
+        psAssert(cert->unparsedBin != NULL);
+        len += 3 + cert->binLen;
+        count++;
+    }
+    if (count > 0)
+    {
+        if ((keys->certMsg = psMalloc(keys->pool, len)) == NULL)
+        {
+            return PS_MEM_FAIL;
+        }
+        c = keys->certMsg;
+        for (cert = keys->cert; cert != NULL; cert = cert->next)
+        {
+            *c = (unsigned char) ((cert->binLen & 0xFF0000) >> 16); c++;
+            *c = (cert->binLen & 0xFF00) >> 8; c++;
+            *c = (cert->binLen & 0xFF); c++;
+            memcpy(c, cert->unparsedBin, cert->binLen);
+            c += cert->binLen;
+        }
+        keys->certMsgLen = len;
+        keys->certCount = count;
+    }
+
+#  if defined(USE_SERVER_SIDE_SSL) && defined(USE_CLIENT_AUTH)
+    len = count = 0;
+    for (cert = keys->CAcerts; cert != NULL; cert = cert->next)
+    {
+        if (cert->subject.dnenc == NULL)
+        {
+            /* Not usable for CertificateRequest, as before */
+            return PS_SUCCESS;
+        }
+        len += 2 + cert->subject.dnencLen;
+        count++;
+    }
+    if (count > 0)
+    {
+        if ((keys->caDnMsg = psMalloc(keys->pool, len)) == NULL)
+        {
+            return PS_MEM_FAIL;
+        }
+        c = keys->caDnMsg;
+        for (cert = keys->CAcerts; cert != NULL; cert = cert->next)
+        {
+            *c = (cert->subject.dnencLen & 0xFF00) >> 8; c++;
+            *c = cert->subject.dnencLen & 0xFF; c++;
+            memcpy(c, cert->subject.dnenc, cert->subject.dnencLen);
+            c += cert->subject.dnencLen;
+        }
+        keys->caDnMsgLen = len;
+        keys->caCount = count;
+    }
+#  endif /* USE_SERVER_SIDE_SSL && USE_CLIENT_AUTH */
+    return PS_SUCCESS;
+}
+# endif /* !USE_ONLY_PSK_CIPHER_SUITE */
+#endif /* USE_SERVER_SIDE_SSL || USE_CLIENT_AUTH */
+
+#if defined(USE_OCSP) && defined(USE_SERVER_SIDE_SSL)
+/******************************************************************************/
+/*
+    The keys hold one reference to the current staple, and every handshake
+    that agreed to send it holds another from the end of ClientHello
+    parsing, once the SNI callback has settled on its keys, until the next
+    handshake or the session is deleted.  Loading a new response only swaps
+    the pointer under stapleLock, so a refresh never waits on handshakes and
+    a handshake in flight sends the response its flight was sized for.
+    A staple records the lock and pool of the keys it came from, so it is
+    released correctly after the session has moved to other keys.
+ */
+sslOcspStaple_t *matrixSslAcquireOCSPStaple(sslKeys_t *keys)
+{
+    sslOcspStaple_t *staple;
+
+    psLockMutex(&keys->stapleLock);
+    if ((staple = keys->staple) != NULL)
+    {
+        staple->refs++;
+    }
+    psUnlockMutex(&keys->stapleLock);
+    return staple;
+}
+
+void matrixSslReleaseOCSPStaple(sslOcspStaple_t *staple)
+{
+    uint32_t refs;
+
+    if (staple == NULL)
+    {
+        return;
+    }
+    psLockMutex(staple->lock);
+    refs = --staple->refs;
+    psUnlockMutex(staple->lock);
+    if (refs == 0)
+    {
+        psFree(staple, staple->pool);
+    }
+}
+
+/*
+    Set the OCSPResponse sent to clients asking for certificate status.
+    May be called again at any time, including while handshakes are using
+    keys, to replace the response with a newer one.
+ */
+int32_t matrixSslLoadOCSPResponse(sslKeys_t *keys,
+    const unsigned char *OCSPResponseBuf, psSize_t OCSPResponseBufLen)
+{
+    sslOcspStaple_t *staple, *old;
+    psPool_t *pool;
+
+    if (keys == NULL || OCSPResponseBuf == NULL || OCSPResponseBufLen == 0)
+    {
+        return PS_ARG_FAIL;
+    }
+    pool = keys->pool;
+    PS_POOL_USED(pool);
+
+    /* Stored as the whole CertificateStatus body so the handshake can
+        copy it in one go */
+    staple = psMalloc(pool, sizeof(sslOcspStaple_t) + 4 + OCSPResponseBufLen);
+    if (staple == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    staple->msg = (unsigned char *) (staple + 1);
+    staple->len = OCSPResponseBufLen;
+    staple->refs = 1;
+#  ifdef USE_MULTITHREADING
+    staple->lock = &keys->stapleLock;
+#  endif
+    staple->pool = pool;
+    /*  struct {
+          CertificateStatusType status_type;
+          select (status_type) {
+              case ocsp: OCSPResponse;
+          } response;
+       } CertificateStatus; */
+    staple->msg[0] = 0x1;
+    /* ocspLen is 16 bit value. */
+    staple->msg[1] = 0;
+    staple->msg[2] = (OCSPResponseBufLen & 0xFF00) >> 8;
+    staple->msg[3] = (OCSPResponseBufLen & 0xFF);
+    memcpy(staple->msg + 4, OCSPResponseBuf, OCSPResponseBufLen);
+
+    /* Overwrite/Update any response being set */
+    psLockMutex(&keys->stapleLock);
+    old = keys->staple;
+    keys->staple = staple;
+    psUnlockMutex(&keys->stapleLock);
+    matrixSslReleaseOCSPStaple(old);
+    return PS_SUCCESS;
+}
+
+# ifdef MATRIX_USE_FILE_SYSTEM
+/*
+    Refresh hook for a file watcher or timer: replace the OCSPResponse of
+    keys with the DER one in fileName.  The new response must parse and be
+    inside its thisUpdate to nextUpdate window, otherwise the current one
+    is kept and the error returned.  The file is read and checked before
+    the swap, so handshakes only ever see a complete response.
+ */
+int32_t matrixSslRefreshOCSPResponseFile(sslKeys_t *keys,
+    const char *fileName)
+{
+    psOcspResponse_t response;
+    unsigned char *buf, *p;
+    int32 bufLen;
+    int32_t rc;
+
+    if (keys == NULL || fileName == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    if ((rc = psGetFileBuf(keys->pool, fileName, &buf, &bufLen)) < 0)
+    {
+        return rc;
+    }
+    if (bufLen <= 0 || bufLen > 0xFFFF)
+    {
+        psFree(buf, keys->pool);
+        return PS_LIMIT_FAIL;
+    }
+    memset(&response, 0x0, sizeof(psOcspResponse_t));
+    p = buf;
+    rc = psOcspParseResponse(keys->pool, bufLen, &p, buf + bufLen, &response);
+    if (rc == PS_SUCCESS)
+    {
+        rc = psOcspResponseCheckDates(&response, 0, NULL, NULL, NULL, NULL,
+            PS_OCSP_TIME_LINGER);
+    }
+    psOcspResponseUninit(&response);
+    if (rc == PS_SUCCESS)
+    {
+        rc = matrixSslLoadOCSPResponse(keys, buf, (psSize_t) bufLen);
+    }
+    else
+    {
+        psTraceIntInfo("Keeping the current OCSP response: %d\n", rc);
+    }
+    psFree(buf, keys->pool);
+    return rc;
+}
+# endif /* MATRIX_USE_FILE_SYSTEM */
+#endif /* USE_OCSP && USE_SERVER_SIDE_SSL */
+
+/******************************************************************************/
+/*
+    This will free the struct and any key material that was loaded via:
+        matrixSslLoadRsaKeys
         matrixSslLoadEcKeys
         matrixSslLoadDhParams
         matrixSslLoadPsk
@@ -1154,6 +1975,10 @@ void matrixSslDeleteKeys(sslKeys_t *keys)
         psX509FreeCert(keys->cert);
     }
 
+#  ifdef USE_ECDSA_PRESIGN
+    /* Stops the thread using privKey */
+    psEccDeletePresign(keys->cache.ecdsaPresign);
+#  endif
     psClearPubKey(&keys->privKey);
 # endif /* USE_SERVER_SIDE_SSL || USE_CLIENT_AUTH */
 
@@ -1162,10 +1987,27 @@ void matrixSslDeleteKeys(sslKeys_t *keys)
     {
         psX509FreeCert(keys->CAcerts);
     }
+#  ifdef USE_CERT_VALIDATE
+    psX509FreeCertIndex(keys->caIndex);
+#  endif
+#  ifdef USE_CERT_CHAIN_CACHE
+    certChainCacheClose(keys);
+#  endif
+#  ifdef USE_OCSP_CACHE
+    ocspCacheClose(keys);
+#  endif
+#  ifdef MATRIX_USE_FILE_SYSTEM
+    /* After the CAs parsed over it */
+    psUnmapFile(keys->pool, keys->caImage, keys->caImageLen);
+#  endif
 # endif /* USE_CLIENT_SIDE_SSL || USE_CLIENT_AUTH */
 #endif  /* !USE_ONLY_PSK_CIPHER_SUITE */
+#if defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH)
+    matrixSslFreeKeyMessages(keys);
+#endif
 
 #ifdef REQUIRE_DH_PARAMS
+    dhRingClose(keys);
     psPkcs3ClearDhParams(&keys->dhParams);
 #endif /* REQUIRE_DH_PARAMS */
 
@@ -1198,6 +2040,9 @@ void matrixSslDeleteKeys(sslKeys_t *keys)
 #endif
 
 #if defined(USE_ECC) || defined(REQUIRE_DH_PARAMS)
+# ifdef USE_ECC_EPHEMERAL_POOL
+    eccRingClose(keys);
+# endif
     psDestroyMutex(&keys->cache.lock);
 # ifdef USE_ECC
     if (keys->cache.eccPrivKeyUse > 0)
@@ -1210,11 +2055,8 @@ void matrixSslDeleteKeys(sslKeys_t *keys)
 #endif
 
 #if defined(USE_OCSP) && defined(USE_SERVER_SIDE_SSL)
-    if (keys->OCSPResponseBuf != NULL)
-    {
-        psFree(keys->OCSPResponseBuf, keys->pool);
-        keys->OCSPResponseBufLen = 0;
-    }
+    matrixSslReleaseOCSPStaple(keys->staple);
+    psDestroyMutex(&keys->stapleLock);
 #endif
 
     memzero_s(keys, sizeof(sslKeys_t));
@@ -1298,6 +2140,18 @@ static int32 verifyReadKeys(psPool_t *pool, sslKeys_t *keys, void *poolUserPtr)
         }
     }
 #    endif /* USE_RSA */
+#    ifdef USE_ED25519
+    if (keys->privKey.type == PS_ED25519)
+    {
+        if (keys->cert->publicKey.type != PS_ED25519 ||
+            memcmpct(keys->privKey.key.ed25519.pub,
+                keys->cert->publicKey.key.ed25519.pub, ED25519_KEY_SIZE) != 0)
+        {
+            psTraceInfo("Private key doesn't match cert\n");
+            return PS_CERT_AUTH_FAIL;
+        }
+    }
+#    endif /* USE_ED25519 */
 #   endif  /* !USE_EXT_CERTIFICATE_VERIFY_SIGNING */
 #  endif   /* USE_CERT_PARSE */
     return PS_SUCCESS;
@@ -1306,94 +2160,483 @@ static int32 verifyReadKeys(psPool_t *pool, sslKeys_t *keys, void *poolUserPtr)
 #endif  /* USE_SERVER_SIDE_SSL || USE_CLIENT_AUTH */
 /******************************************************************************/
 
-#ifdef REQUIRE_DH_PARAMS
+#if defined(USE_ECC_EPHEMERAL_POOL) || defined(REQUIRE_DH_PARAMS)
 /******************************************************************************/
 /*
-    User level API to assign the DH parameter file to the server application.
+    Ready ephemeral keys belong to the process that generated them. After
+    fork() a child would hand out the same keys as its parent and every
+    sibling, and keys->cache.lock may still be held by a refill thread that
+    only exists in the parent. So a process other than keys->cache.pid
+    checks this before taking the lock: it recreates the lock, wipes the
+    keys and drops the inherited workers. The child must get here before it
+    starts threads that share 'keys'.
  */
-# ifdef MATRIX_USE_FILE_SYSTEM
-int32 matrixSslLoadDhParams(sslKeys_t *keys, const char *paramFile)
+static void ephemeralCacheForked(sslKeys_t *keys)
 {
-    if (keys == NULL)
+# ifdef USE_ECC_EPHEMERAL_POOL
+    eccEphemeralRing_t *ring;
+    uint8_t i;
+# endif
+    uint32_t pid;
+
+    pid = psGetProcessId();
+    if (keys->cache.pid == 0 || keys->cache.pid == pid)
     {
-        return PS_ARG_FAIL;
+        return;
     }
-    return psPkcs3ParseDhParamFile(keys->pool, (char *) paramFile, &keys->dhParams);
-}
-# endif /* MATRIX_USE_FILE_SYSTEM */
-
-/******************************************************************************/
-int32 matrixSslLoadDhParamsMem(sslKeys_t *keys,  const unsigned char *dhBin,
-    int32 dhBinLen)
-{
-    if (keys == NULL)
+    if (psCreateMutex(&keys->cache.lock, 0) < 0)
     {
-        return PS_ARG_FAIL;
+        psTraceInfo("Ephemeral key cache lock not recreated after fork\n");
     }
-    return psPkcs3ParseDhParamBin(keys->pool, (unsigned char *) dhBin, dhBinLen,
-        &keys->dhParams);
+    /* In a child closing a pool only frees it, its thread stayed behind */
+# ifdef USE_ECC_EPHEMERAL_POOL
+    psWorkerPoolClose(keys->cache.eccWorker);
+    keys->cache.eccWorker = NULL;
+    keys->cache.eccRefillQueued = 0;
+    for (i = 0; i < ECC_EPHEMERAL_POOL_CURVES; i++)
+    {
+        if ((ring = keys->cache.eccRing[i]) == NULL)
+        {
+            continue;
+        }
+        while (ring->count > 0)
+        {
+            eccRingDrop(ring);
+        }
+    }
+# endif /* USE_ECC_EPHEMERAL_POOL */
+# ifdef REQUIRE_DH_PARAMS
+    psWorkerPoolClose(keys->cache.dhWorker);
+    keys->cache.dhWorker = NULL;
+    keys->cache.dhRefillQueued = 0;
+    if (keys->cache.dhRing != NULL)
+    {
+        while (keys->cache.dhRing->count > 0)
+        {
+            dhRingDrop(keys->cache.dhRing);
+        }
+    }
+# endif /* REQUIRE_DH_PARAMS */
+    keys->cache.pid = pid;
 }
-#endif /* REQUIRE_DH_PARAMS */
+#endif /* USE_ECC_EPHEMERAL_POOL || REQUIRE_DH_PARAMS */
 
+#ifdef REQUIRE_DH_PARAMS
 /******************************************************************************/
 /*
-    New SSL protocol context
-    This structure is associated with a single SSL connection.  Each socket
-    using SSL should be associated with a new SSL context.
-
-    certBuf and privKey ARE NOT duplicated within the server context, in order
-    to minimize memory usage with multiple simultaneous requests.  They must
-    not be deleted by caller until all server contexts using them are deleted.
+    Ephemeral DH keys. By default every DHE handshake generates its own key.
+    matrixSslSetDhEphemeralPolicy() can let a key serve several handshakes,
+    and have a background job keep keys ready in keys->cache.dhRing. As with
+    the ECC pool, the job generates into the slot at head + count without
+    holding keys->cache.lock and publishes the key by incrementing 'count'.
  */
-int32 matrixSslNewSession(ssl_t **ssl, const sslKeys_t *keys,
-    sslSessionId_t *session, sslSessOpts_t *options)
-{
-    psPool_t *pool = NULL;
-    ssl_t *lssl;
-    int32_t specificVersion, flags;
 
-#ifdef USE_STATELESS_SESSION_TICKETS
-    uint32_t i;
-#endif
+/* Drop the oldest key of the ring. Lock held. */
+static void dhRingDrop(dhEphemeralRing_t *ring)
+{
+    psDhClearKey(&ring->key[ring->head]);
+    ring->head = (ring->head + 1) % DH_EPHEMERAL_POOL_MAX;
+    ring->count--;
+}
 
-    /* SERVER_SIDE and CLIENT_AUTH and others will have been added to
-        versionFlag by callers */
-    flags = options->versionFlag;
+/* Background job: fill the ring up to dhReady keys */
+static void dhRingRefill(void *arg)
+{
+    sslKeys_t *keys = arg;
+    dhEphemeralRing_t *ring;
+    psDhKey_t *key;
+    psTime_t t;
+    uint8_t i;
 
-/*
-    First API level chance to make sure a user is not attempting to use
-    client or server support that was not built into this library compile
- */
-#ifndef USE_SERVER_SIDE_SSL
-    if (flags & SSL_FLAGS_SERVER)
+    for (;; )
     {
-        psTraceInfo("SSL_FLAGS_SERVER passed to matrixSslNewSession but MatrixSSL lib was not compiled with server support\n");
-        return PS_ARG_FAIL;
+        psLockMutex(&keys->cache.lock);
+        ring = keys->cache.dhRing;
+        if (keys->cache.dhClosing || ring == NULL ||
+            ring->count >= keys->cache.dhReady)
+        {
+            keys->cache.dhRefillQueued = 0;
+            psUnlockMutex(&keys->cache.lock);
+            return;
+        }
+        key = &ring->key[(ring->head + ring->count) % DH_EPHEMERAL_POOL_MAX];
+        psUnlockMutex(&keys->cache.lock);
+
+        if (psDhGenKeyParams(keys->pool, &keys->dhParams, key, NULL) < 0)
+        {
+            psTraceInfo("Background ephemeral DH key generation failed\n");
+            psLockMutex(&keys->cache.lock);
+            keys->cache.dhRefillQueued = 0;
+            psUnlockMutex(&keys->cache.lock);
+            return;
+        }
+        psGetTime(&t, keys->poolUserPtr);
+
+        psLockMutex(&keys->cache.lock);
+        i = (ring->head + ring->count) % DH_EPHEMERAL_POOL_MAX;
+        ring->time[i] = t;
+        ring->use[i] = 0;
+        ring->count++;
+        keys->cache.pid = psGetProcessId();
+        psUnlockMutex(&keys->cache.lock);
     }
-#endif
+}
 
-#ifndef USE_CLIENT_SIDE_SSL
-    if (!(flags & SSL_FLAGS_SERVER))
+/* Whether the refill job should be submitted, marking it queued. Lock held. */
+static uint8_t dhRingNeedsRefill(sslKeys_t *keys)
+{
+    if (keys->cache.dhRing == NULL ||
+        keys->cache.dhRing->count >= keys->cache.dhReady ||
+        keys->cache.dhRefillQueued || keys->cache.dhClosing)
     {
-        psTraceInfo("SSL_FLAGS_SERVER was not passed to matrixSslNewSession but MatrixSSL was not compiled with client support\n");
-        return PS_ARG_FAIL;
+        return 0;
     }
-#endif
-
-#ifndef USE_CLIENT_AUTH
-    if (flags & SSL_FLAGS_CLIENT_AUTH)
+    if (keys->cache.dhWorker == NULL &&
+        psWorkerPoolOpen(keys->pool, &keys->cache.dhWorker, 1) < 0)
     {
-        psTraceInfo("SSL_FLAGS_CLIENT_AUTH passed to matrixSslNewSession but MatrixSSL was not compiled with USE_CLIENT_AUTH enabled\n");
-        return PS_ARG_FAIL;
+        return 0;
     }
-#endif
+    keys->cache.pid = psGetProcessId();
+    keys->cache.dhRefillQueued = 1;
+    return 1;
+}
 
-    if (flags & SSL_FLAGS_SERVER)
+/*
+    Copy the oldest key of the ring that is still within the policy into
+    'dh', counting the use. Returns PS_FAILURE if there is none. Lock held.
+ */
+static int32_t dhRingTake(sslKeys_t *keys, dhEphemeralRing_t *ring,
+    psTime_t t, psPool_t *pool, psDhKey_t *dh)
+{
+    int32_t rc, age;
+
+    while (ring->count > 0)
     {
-# ifndef USE_PSK_CIPHER_SUITE
-        if (keys == NULL)
+        /* dhSeconds is clamped so the product fits; a negative age
+           means the difference itself wrapped */
+        age = psDiffMsecs(ring->time[ring->head], t, keys->poolUserPtr);
+        if (age < 0 || age > (int32) (1000 * keys->cache.dhSeconds))
         {
-            psTraceInfo("NULL keys parameter passed to matrixSslNewSession\n");
+            dhRingDrop(ring);
+            continue;
+        }
+        rc = psDhCopyKey(pool, dh, &ring->key[ring->head]);
+        if (rc == PS_SUCCESS &&
+            ++ring->use[ring->head] >= keys->cache.dhUsage)
+        {
+            dhRingDrop(ring);
+        }
+        return rc;
+    }
+    return PS_FAILURE;
+}
+
+/* Stop the refill job and drop all keys. The policy is kept. */
+static void dhRingClose(sslKeys_t *keys)
+{
+    dhEphemeralRing_t *ring;
+
+    ephemeralCacheForked(keys);
+    psLockMutex(&keys->cache.lock);
+    keys->cache.dhClosing = 1;
+    psUnlockMutex(&keys->cache.lock);
+    /* Waits for a running refill, which stops after its current key */
+    psWorkerPoolClose(keys->cache.dhWorker);
+    keys->cache.dhWorker = NULL;
+    keys->cache.dhRefillQueued = 0;
+    if ((ring = keys->cache.dhRing) != NULL)
+    {
+        while (ring->count > 0)
+        {
+            dhRingDrop(ring);
+        }
+        psFree(ring, keys->pool);
+        keys->cache.dhRing = NULL;
+    }
+    keys->cache.dhClosing = 0;
+}
+
+/**
+    Set how ephemeral keys for DHE key exchange are made with 'keys'.
+    The default, a 'usage' of 1 and no 'ready' keys, generates a new key in
+    every handshake.
+
+    @param[in] keys Keys structure with loaded DH parameters. Must not be
+        in use by handshakes while the policy changes.
+    @param[in] usage Maximum number of handshakes that share one key.
+    @param[in] seconds Maximum lifetime of a key. Values above
+        DH_EPHEMERAL_MAX_SECONDS (about 24 days) are clamped to it.
+    @param[in] ready Number of keys a background thread keeps generated in
+        advance, at most DH_EPHEMERAL_POOL_MAX. Requires USE_MULTITHREADING.
+    @return < 0 on error.
+ */
+int32 matrixSslSetDhEphemeralPolicy(sslKeys_t *keys, uint16 usage,
+    uint32 seconds, uint8 ready)
+{
+    uint8_t kick;
+
+    if (keys == NULL || keys->dhParams.size == 0 || usage == 0 ||
+        seconds == 0 || ready > DH_EPHEMERAL_POOL_MAX)
+    {
+        return PS_ARG_FAIL;
+    }
+# ifndef USE_MULTITHREADING
+    if (ready > 0)
+    {
+        return PS_UNSUPPORTED_FAIL;
+    }
+# endif
+    dhRingClose(keys);
+    keys->cache.dhUsage = usage;
+    keys->cache.dhSeconds = PS_MIN(seconds, DH_EPHEMERAL_MAX_SECONDS);
+    keys->cache.dhReady = ready;
+    if (ready == 0)
+    {
+        return PS_SUCCESS;
+    }
+    /* Start generating right away rather than at the first handshake */
+    if ((keys->cache.dhRing = psMalloc(keys->pool,
+             sizeof(dhEphemeralRing_t))) == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    memset(keys->cache.dhRing, 0x0, sizeof(dhEphemeralRing_t));
+    psLockMutex(&keys->cache.lock);
+    kick = dhRingNeedsRefill(keys);
+    psUnlockMutex(&keys->cache.lock);
+    if (kick)
+    {
+        psWorkerJobInit(&keys->cache.dhRefill, dhRingRefill, keys);
+        psWorkerPoolSubmit(keys->cache.dhWorker, &keys->cache.dhRefill);
+    }
+    return PS_SUCCESS;
+}
+
+/**
+    Get an ephemeral DH key for DHE key exchange with the parameters of
+    'keys', following the policy set with matrixSslSetDhEphemeralPolicy().
+    @param[in] keys Keys structure holding the DH parameters and keys
+    @param[in] pool Memory pool for 'dh'
+    @param[out] dh Receives a key of its own. Free with psDhClearKey().
+    @param[in] usrData Context for hardware crypto.
+ */
+int32_t matrixSslGenEphemeralDhKey(sslKeys_t *keys, psPool_t *pool,
+    psDhKey_t *dh, void *usrData)
+{
+    dhEphemeralRing_t *ring;
+    psTime_t t;
+    int32_t rc;
+    uint8_t kick;
+
+    psAssert(keys && dh);
+    if (keys->cache.dhUsage <= 1 && keys->cache.dhReady == 0)
+    {
+        return psDhGenKeyParams(pool, &keys->dhParams, dh, usrData);
+    }
+    ephemeralCacheForked(keys);
+    psGetTime(&t, keys->poolUserPtr);
+    psLockMutex(&keys->cache.lock);
+    if ((ring = keys->cache.dhRing) == NULL)
+    {
+        if ((ring = psMalloc(keys->pool, sizeof(dhEphemeralRing_t))) == NULL)
+        {
+            psUnlockMutex(&keys->cache.lock);
+            return PS_MEM_FAIL;
+        }
+        memset(ring, 0x0, sizeof(dhEphemeralRing_t));
+        keys->cache.dhRing = ring;
+    }
+    rc = dhRingTake(keys, ring, t, pool, dh);
+    if (rc != PS_SUCCESS && keys->cache.dhReady == 0)
+    {
+        /* Reuse without a background job: generate the shared key here,
+           but not under the lock, which every ephemeral key user waits
+           on. If another handshake installs one meanwhile, use that. */
+        psUnlockMutex(&keys->cache.lock);
+        psTraceInfo("Generating ephemeral DH key\n");
+        if ((rc = psDhGenKeyParams(pool, &keys->dhParams, dh, usrData)) < 0)
+        {
+            return rc;
+        }
+        psLockMutex(&keys->cache.lock);
+        if (ring->count == 0)
+        {
+            rc = psDhCopyKey(keys->pool, &ring->key[ring->head], dh);
+            if (rc == PS_SUCCESS)
+            {
+                ring->time[ring->head] = t;
+                ring->use[ring->head] = 1;
+                ring->count = 1;
+                keys->cache.pid = psGetProcessId();
+            }
+            psUnlockMutex(&keys->cache.lock);
+            /* A key that could not be shared still serves this handshake */
+            return PS_SUCCESS;
+        }
+        psDhClearKey(dh);
+        rc = dhRingTake(keys, ring, t, pool, dh);
+        psUnlockMutex(&keys->cache.lock);
+        return rc;
+    }
+    kick = dhRingNeedsRefill(keys);
+    psUnlockMutex(&keys->cache.lock);
+
+    if (kick)
+    {
+        psWorkerJobInit(&keys->cache.dhRefill, dhRingRefill, keys);
+        psWorkerPoolSubmit(keys->cache.dhWorker, &keys->cache.dhRefill);
+    }
+    if (rc == PS_SUCCESS)
+    {
+        return PS_SUCCESS;
+    }
+    psTraceInfo("Generating ephemeral DH key (pool empty)\n");
+    return psDhGenKeyParams(pool, &keys->dhParams, dh, usrData);
+}
+
+/******************************************************************************/
+/*
+    Every DHE handshake raises the same generator to a new power, so build
+    its comb once here. Parameters that cannot have one still work.
+ */
+static void matrixSslPrecomputeDhParams(sslKeys_t *keys)
+{
+# ifdef USE_DH_PRECOMP
+    if (psDhPrecomputeParams(keys->pool, &keys->dhParams) < 0)
+    {
+        psTraceInfo("No comb for DH generator, using full exponentiation\n");
+    }
+# endif /* USE_DH_PRECOMP */
+}
+
+/******************************************************************************/
+/*
+    User level API to assign the DH parameter file to the server application.
+ */
+# ifdef MATRIX_USE_FILE_SYSTEM
+int32 matrixSslLoadDhParams(sslKeys_t *keys, const char *paramFile)
+{
+    int32 rc;
+
+    if (keys == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    dhRingClose(keys);
+    psPkcs3ClearDhParams(&keys->dhParams);
+    rc = psPkcs3ParseDhParamFile(keys->pool, (char *) paramFile,
+        &keys->dhParams);
+    if (rc >= 0)
+    {
+        matrixSslPrecomputeDhParams(keys);
+    }
+    matrixSslUpdateCipherEligibility(keys);
+    return rc < 0 ? rc : PS_SUCCESS;
+}
+# endif /* MATRIX_USE_FILE_SYSTEM */
+
+/******************************************************************************/
+int32 matrixSslLoadDhParamsMem(sslKeys_t *keys,  const unsigned char *dhBin,
+    int32 dhBinLen)
+{
+    int32 rc;
+
+    if (keys == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    dhRingClose(keys);
+    psPkcs3ClearDhParams(&keys->dhParams);
+    rc = psPkcs3ParseDhParamBin(keys->pool, (unsigned char *) dhBin,
+        dhBinLen, &keys->dhParams);
+    if (rc >= 0)
+    {
+        matrixSslPrecomputeDhParams(keys);
+    }
+    matrixSslUpdateCipherEligibility(keys);
+    return rc < 0 ? rc : PS_SUCCESS;
+}
+
+/******************************************************************************/
+/*
+    Use one of the RFC 7919 groups, PS_DH_FFDHE2048, PS_DH_FFDHE3072 or
+    PS_DH_FFDHE4096, instead of a parameter file.
+ */
+int32 matrixSslLoadDhGroup(sslKeys_t *keys, uint16 group)
+{
+    int32 rc;
+
+    if (keys == NULL)
+    {
+        return PS_ARG_FAIL;
+    }
+    dhRingClose(keys);
+    psPkcs3ClearDhParams(&keys->dhParams);
+    rc = psDhLoadNamedGroup(keys->pool, group, &keys->dhParams);
+    matrixSslUpdateCipherEligibility(keys);
+    return rc;
+}
+#endif /* REQUIRE_DH_PARAMS */
+
+/******************************************************************************/
+/*
+    New SSL protocol context
+    This structure is associated with a single SSL connection.  Each socket
+    using SSL should be associated with a new SSL context.
+
+    certBuf and privKey ARE NOT duplicated within the server context, in order
+    to minimize memory usage with multiple simultaneous requests.  They must
+    not be deleted by caller until all server contexts using them are deleted.
+ */
+int32 matrixSslNewSession(ssl_t **ssl, const sslKeys_t *keys,
+    sslSessionId_t *session, sslSessOpts_t *options)
+{
+    psPool_t *pool = NULL;
+    ssl_t *lssl;
+    int32_t specificVersion, flags;
+
+#ifdef USE_STATELESS_SESSION_TICKETS
+    uint32_t i;
+#endif
+
+    /* SERVER_SIDE and CLIENT_AUTH and others will have been added to
+        versionFlag by callers */
+    flags = options->versionFlag;
+
+/*
+    First API level chance to make sure a user is not attempting to use
+    client or server support that was not built into this library compile
+ */
+#ifndef USE_SERVER_SIDE_SSL
+    if (flags & SSL_FLAGS_SERVER)
+    {
+        psTraceInfo("SSL_FLAGS_SERVER passed to matrixSslNewSession but MatrixSSL lib was not compiled with server support\n");
+        return PS_ARG_FAIL;
+    }
+#endif
+
+#ifndef USE_CLIENT_SIDE_SSL
+    if (!(flags & SSL_FLAGS_SERVER))
+    {
+        psTraceInfo("SSL_FLAGS_SERVER was not passed to matrixSslNewSession but MatrixSSL was not compiled with client support\n");
+        return PS_ARG_FAIL;
+    }
+#endif
+
+#ifndef USE_CLIENT_AUTH
+    if (flags & SSL_FLAGS_CLIENT_AUTH)
+    {
+        psTraceInfo("SSL_FLAGS_CLIENT_AUTH passed to matrixSslNewSession but MatrixSSL was not compiled with USE_CLIENT_AUTH enabled\n");
+        return PS_ARG_FAIL;
+    }
+#endif
+
+    if (flags & SSL_FLAGS_SERVER)
+    {
+# ifndef USE_PSK_CIPHER_SUITE
+        if (keys == NULL)
+        {
+            psTraceInfo("NULL keys parameter passed to matrixSslNewSession\n");
             return PS_ARG_FAIL;
         }
 # endif /* USE_PSK_CIPHER_SUITE */
@@ -1427,6 +2670,10 @@ int32 matrixSslNewSession(ssl_t **ssl, const sslKeys_t *keys,
     {
         lssl->bFlags |= BFLAG_KEEP_PEER_CERTS;
     }
+    if (options->lazy_peer_cert_parse)
+    {
+        lssl->bFlags |= BFLAG_LAZY_PEER_CERTS;
+    }
 #endif
 
     if (options->validateCertsOpts.max_verify_depth >= 0)
@@ -1527,6 +2774,13 @@ int32 matrixSslNewSession(ssl_t **ssl, const sslKeys_t *keys,
             return PS_ARG_FAIL;
         }
 # endif /* USE_EXT_CERTIFICATE_VERIFY_SIGNING */
+# ifdef USE_ASYNC_PKA
+        if (options->asyncPka)
+        {
+            psTraceInfo("Error: Async PKA not supported with DTLS\n");
+            return PS_ARG_FAIL;
+        }
+# endif /* USE_ASYNC_PKA */
         lssl->flags |= SSL_FLAGS_DTLS;
         lssl->recordHeadLen += DTLS_HEADER_ADD_LEN;
         lssl->hshakeHeadLen += DTLS_HEADER_ADD_LEN;
@@ -1818,6 +3072,17 @@ int32 matrixSslNewSession(ssl_t **ssl, const sslKeys_t *keys,
         }
         lssl->sid = session;
     }
+#ifdef USE_ASYNC_PKA
+    if (options->asyncPka)
+    {
+        if (psCreateNotify(&lssl->pkaNotify) < 0)
+        {
+            matrixSslDeleteSession(lssl);
+            return PS_PLATFORM_FAIL;
+        }
+        lssl->asyncPkaInUse = 1;
+    }
+#endif /* USE_ASYNC_PKA */
     /* Clear these to minimize damage on a protocol parsing bug */
     memset(lssl->inbuf, 0x0, lssl->insize);
     memset(lssl->outbuf, 0x0, lssl->outsize);
@@ -1843,6 +3108,20 @@ void matrixSslDeleteSession(ssl_t *ssl)
         return;
     }
 
+#ifdef USE_ASYNC_PKA
+    if (ssl->asyncPkaInUse)
+    {
+        /* A running job owns the handshake state until it returns */
+        if (ssl->asyncPkaPending)
+        {
+            psWorkerJobWait(g_pkaWorker, &ssl->pkaJob);
+            ssl->asyncPkaPending = 0;
+        }
+        psDestroyNotify(&ssl->pkaNotify);
+        ssl->asyncPkaInUse = 0;
+    }
+#endif /* USE_ASYNC_PKA */
+
     ssl->flags |= SSL_FLAGS_CLOSED;
 
     /* Synchronize all digests, in case some of them have been updated, but
@@ -1882,6 +3161,10 @@ void matrixSslDeleteSession(ssl_t *ssl)
     {
         psFree(ssl->expectedName, ssl->sPool);
     }
+#if defined(USE_OCSP) && defined(USE_SERVER_SIDE_SSL)
+    matrixSslReleaseOCSPStaple(ssl->staple);
+    ssl->staple = NULL;
+#endif
 #ifndef USE_ONLY_PSK_CIPHER_SUITE
 # if defined(USE_CLIENT_SIDE_SSL) || defined(USE_CLIENT_AUTH)
     if (ssl->sec.cert)
@@ -1939,6 +3222,9 @@ void matrixSslDeleteSession(ssl_t *ssl)
     {
         psFree(ssl->fragMessage, ssl->hsPool);
     }
+#ifdef USE_HS_TRANSCRIPT
+    sslFreeHSTranscript(ssl);
+#endif
 
 #ifdef USE_DTLS
 # ifdef USE_CLIENT_SIDE_SSL
@@ -1993,6 +3279,67 @@ void matrixSslDeleteSession(ssl_t *ssl)
     psFree(ssl, pool);
 }
 
+#ifdef USE_ASYNC_PKA
+/******************************************************************************/
+/*
+    Deferred PKA on the worker pool. While a job is pending it has the
+    session to itself: the flight being built stays in the caller's buffer,
+    and the application may only poll pkaNotify and call
+    matrixSslReceivedData(ssl, 0, ...) until it is collected.
+ */
+static void sslPkaJobMain(void *arg)
+{
+    ssl_t *ssl = arg;
+
+    ssl->asyncPkaRc = ssl->asyncPkaOp(ssl, &ssl->asyncPkaOut);
+    psSignalNotify(&ssl->pkaNotify);
+}
+
+/*
+    Queue 'op' for the session. 'out' is the flight buffer the op would
+    have been given synchronously. Returns PS_PENDING, or < 0 if the job
+    could not be queued.
+ */
+int32 sslSubmitPkaJob(ssl_t *ssl, int32 (*op)(ssl_t *ssl, psBuf_t *out),
+    psBuf_t *out)
+{
+    int32 rc;
+
+    psAssert(ssl->asyncPkaInUse && !ssl->asyncPkaPending);
+    ssl->asyncPkaOp = op;
+    ssl->asyncPkaOut = *out;
+    ssl->asyncPkaPending = 1;
+    ssl->hwflags |= SSL_HWFLAGS_PENDING_PKA_W;
+    psWorkerJobInit(&ssl->pkaJob, sslPkaJobMain, ssl);
+    if ((rc = psWorkerPoolSubmit(g_pkaWorker, &ssl->pkaJob)) < 0)
+    {
+        ssl->asyncPkaPending = 0;
+        ssl->hwflags &= ~SSL_HWFLAGS_PENDING_PKA_W;
+        return rc;
+    }
+    return PS_PENDING;
+}
+
+/*
+    PS_PENDING until the job has run. Then 'out' is restored to the flight
+    buffer as the op left it and the op's own return code is returned.
+ */
+int32 sslCollectPkaJob(ssl_t *ssl, psBuf_t *out)
+{
+    if (!psClearNotify(&ssl->pkaNotify))
+    {
+        return PS_PENDING;
+    }
+    /* The notify is posted just before the worker marks the job done */
+    psWorkerJobWait(g_pkaWorker, &ssl->pkaJob);
+    ssl->asyncPkaPending = 0;
+    ssl->hwflags &= ~SSL_HWFLAGS_PENDING_PKA_W;
+    psAssert(out->buf == ssl->asyncPkaOut.buf);
+    *out = ssl->asyncPkaOut;
+    return ssl->asyncPkaRc;
+}
+#endif /* USE_ASYNC_PKA */
+
 /******************************************************************************/
 /*
     Generic session option control for changing already connected sessions.
@@ -3382,22 +4729,11 @@ int32 matrixValidateCerts(psPool_t *pool, psX509Cert_t *subjectCerts,
 }
 
 /*
-    Subject certs is the leaf first chain of certs from the peer
-    Issuer certs is a flat list of trusted CAs loaded by LoadKeys
+    Checks of the arguments of matrixValidateCertsIndexed
  */
-int32 matrixValidateCertsExt(psPool_t *pool, psX509Cert_t *subjectCerts,
-    psX509Cert_t *issuerCerts, char *expectedName,
-    psX509Cert_t **foundIssuer, void *hwCtx,
-    void *poolUserPtr,
+static int32 matrixValidateCertsArgs(char *expectedName,
     const matrixValidateCertsOptions_t *opts)
 {
-
-    psX509Cert_t *ic, *sc;
-    x509GeneralName_t *n;
-    x509v3extensions_t *ext;
-    char ip[16];
-    int32 rc, foundSupportedSAN, pathLen = 0;
-
     /*
        Check for illegal option combinations.
      */
@@ -3426,12 +4762,213 @@ int32 matrixValidateCertsExt(psPool_t *pool, psX509Cert_t *subjectCerts,
         }
     }
 
-    *foundIssuer = NULL;
+    return PS_SUCCESS;
+}
+
 /*
-    Case #1 is no issuing cert.  Going to want to check that the final
-    subject cert presented is a SelfSigned CA
+    Checks of the leaf certificate made once its chain has authenticated
  */
-    if (issuerCerts == NULL)
+static int32 matrixValidateLeafCert(psX509Cert_t *subjectCerts,
+    char *expectedName, const matrixValidateCertsOptions_t *opts)
+{
+    x509GeneralName_t *n;
+    x509v3extensions_t *ext;
+    char ip[16];
+    int32 rc = PS_SUCCESS, foundSupportedSAN;
+
+    /* Validate extensions of leaf certificate */
+    ext = &subjectCerts->extensions;
+
+    /* Validate extended key usage */
+    if (ext->critFlags & EXT_CRIT_FLAG(OID_ENUM(id_ce_extKeyUsage)))
+    {
+        if (!(ext->ekuFlags & (EXT_KEY_USAGE_TLS_SERVER_AUTH |
+                               EXT_KEY_USAGE_TLS_CLIENT_AUTH)))
+        {
+            _psTrace("End-entity certificate not for TLS usage!\n");
+            subjectCerts->authFailFlags |= PS_CERT_AUTH_FAIL_EKU_FLAG;
+            rc = subjectCerts->authStatus = PS_CERT_AUTH_FAIL_EXTENSION;
+        }
+    }
+
+    /* Check the subject/altSubject. Should match requested domain */
+    if (expectedName == NULL ||
+        (opts->flags & VCERTS_FLAG_SKIP_EXPECTED_NAME_VALIDATION))
+    {
+        return rc;
+    }
+    /* Only the names of the leaf are needed from a lazily parsed chain */
+    if (psX509DecodeCert(subjectCerts) < 0)
+    {
+        psTraceInfo("Couldn't decode the names of the peer certificate\n");
+        subjectCerts->authFailFlags |= PS_CERT_AUTH_FAIL_SUBJECT_FLAG;
+        rc = subjectCerts->authStatus = PS_CERT_AUTH_FAIL_EXTENSION;
+        return rc;
+    }
+    foundSupportedSAN = 0;
+    for (n = ext->san; n != NULL; n = n->next)
+    {
+        switch (n->id)
+        {
+        case GN_DNS:
+            foundSupportedSAN = 1;
+            if (opts->nameType == NAME_TYPE_ANY ||
+                opts->nameType == NAME_TYPE_HOSTNAME ||
+                opts->nameType == NAME_TYPE_SAN_DNS)
+            {
+                if (wildcardMatch((char *) n->data, expectedName) == 0)
+                {
+                    return rc;
+                }
+            }
+            break;
+        case GN_EMAIL:
+            foundSupportedSAN = 1;
+            if (opts->nameType == NAME_TYPE_ANY ||
+                opts->nameType == NAME_TYPE_SAN_EMAIL)
+            {
+                if (opts->mFlags &
+                    VCERTS_MFLAG_SAN_EMAIL_CASE_INSENSITIVE_LOCAL_PART)
+                {
+                    if (matchEmail((char *) n->data, n->dataLen,
+                            expectedName, 0))
+                    {
+                        return rc;
+                    }
+                }
+                else
+                {
+                    if (matchEmail((char *) n->data, n->dataLen,
+                            expectedName, 1))
+                    {
+                        return rc;
+                    }
+                }
+            }
+            break;
+        case GN_IP:
+            foundSupportedSAN = 1;
+            if (opts->nameType == NAME_TYPE_ANY ||
+                opts->nameType == NAME_TYPE_SAN_IP_ADDRESS)
+            {
+                snprintf(ip, 15, "%u.%u.%u.%u",
+                    (unsigned char) (n->data[0]),
+                    (unsigned char ) (n->data[1]),
+                    (unsigned char ) (n->data[2]),
+                    (unsigned char ) (n->data[3]));
+                ip[15] = '\0';
+                if (strcmp(ip, expectedName) == 0)
+                {
+                    return rc;
+                }
+            }
+            break;
+        case GN_OTHER:
+        case GN_X400:
+        case GN_DIR:
+        case GN_EDI:
+        case GN_URI:
+        case GN_REGID:
+            /* No support for these currently. */
+            break;
+        }
+    }
+
+    /*
+       Now check the subject CN, if necessary.
+
+       RFC 6125, Section 6.4.4:
+       "a client MUST NOT seek a match for a reference identifier
+       of CN-ID if the presented identifiers include a DNS-ID, SRV-ID,
+       URI-ID, or any application-specific identifier types supported
+       by the client."
+     */
+
+# ifdef ALWAYS_CHECK_SUBJECT_CN_IN_HOSTNAME_VALIDATION
+    if (wildcardMatch(subjectCerts->subject.commonName,
+            expectedName) == 0)
+    {
+        return rc;
+    }
+# else
+    if (opts->nameType == NAME_TYPE_ANY ||
+        opts->nameType == NAME_TYPE_CN ||
+        opts->nameType == NAME_TYPE_HOSTNAME)
+    {
+        if (!foundSupportedSAN ||
+            (opts->mFlags & VCERTS_MFLAG_ALWAYS_CHECK_SUBJECT_CN))
+        {
+            if (wildcardMatch(subjectCerts->subject.commonName,
+                    expectedName) == 0)
+            {
+                return rc;
+            }
+        }
+    }
+# endif     /* ALWAYS_CHECK_SUBJECT_CN_IN_HOSTNAME_VALIDATION */
+
+    psTraceInfo("Authentication failed: no matching subject\n");
+    subjectCerts->authFailFlags |= PS_CERT_AUTH_FAIL_SUBJECT_FLAG;
+    rc = subjectCerts->authStatus = PS_CERT_AUTH_FAIL_EXTENSION;
+    return rc;
+}
+
+/*
+    Subject certs is the leaf first chain of certs from the peer
+    Issuer certs is a flat list of trusted CAs loaded by LoadKeys
+ */
+int32 matrixValidateCertsExt(psPool_t *pool, psX509Cert_t *subjectCerts,
+    psX509Cert_t *issuerCerts, char *expectedName,
+    psX509Cert_t **foundIssuer, void *hwCtx,
+    void *poolUserPtr,
+    const matrixValidateCertsOptions_t *opts)
+{
+    return matrixValidateCertsIndexed(pool, subjectCerts, issuerCerts, NULL,
+        expectedName, foundIssuer, hwCtx, poolUserPtr, opts);
+}
+
+/*
+    The first CA from *ca on that parses, see psX509ParseDeferred, leaving
+    *ca at it.  Trust store CAs are parsed on first use.
+ */
+static psX509Cert_t *nextIssuerCert(psX509Cert_t **ca)
+{
+    psX509Cert_t *ic = NULL;
+
+    while (*ca != NULL && (ic = psX509ParseDeferred(*ca)) == NULL)
+    {
+        *ca = (*ca)->next;
+    }
+    return ic;
+}
+
+/*
+    As matrixValidateCertsExt, with issuerIndex an optional index of
+    issuerCerts (see psX509NewCertIndex).  Only the issuer certs it returns
+    for the parent-most subject cert are tried.
+ */
+int32 matrixValidateCertsIndexed(psPool_t *pool, psX509Cert_t *subjectCerts,
+    psX509Cert_t *issuerCerts, const psX509CertIndex_t *issuerIndex,
+    char *expectedName, psX509Cert_t **foundIssuer, void *hwCtx,
+    void *poolUserPtr,
+    const matrixValidateCertsOptions_t *opts)
+{
+
+    psX509Cert_t *ic, *sc, *ca = NULL;
+    psX509CertIndexCursor_t cursor;
+    int32 rc, pathLen = 0;
+
+    if ((rc = matrixValidateCertsArgs(expectedName, opts)) < 0)
+    {
+        return rc;
+    }
+
+    *foundIssuer = NULL;
+/*
+    Case #1 is no issuing cert.  Going to want to check that the final
+    subject cert presented is a SelfSigned CA
+ */
+    if (issuerCerts == NULL)
     {
         return psX509AuthenticateCert(pool, subjectCerts, NULL, foundIssuer,
             hwCtx, poolUserPtr);
@@ -3498,7 +5035,21 @@ int32 matrixValidateCertsExt(psPool_t *pool, psX509Cert_t *subjectCerts,
      we only need to pass in the single parent-most cert to be tested against
  */
     *foundIssuer = NULL;
-    ic = issuerCerts;
+    if (issuerIndex != NULL)
+    {
+        memset(&cursor, 0, sizeof(cursor));
+        if ((ic = psX509FindIssuerCandidate(issuerIndex, sc, &cursor)) == NULL)
+        {
+            /* What trying each CA would have concluded */
+            psTraceInfo("No trusted CA with the issuer DN of the peer\n");
+            sc->authStatus = PS_CERT_AUTH_FAIL_DN;
+        }
+    }
+    else
+    {
+        ca = issuerCerts;
+        ic = nextIssuerCert(&ca);
+    }
     while (ic != NULL)
     {
         sc->authStatus = PS_FALSE;
@@ -3530,149 +5081,519 @@ int32 matrixValidateCertsExt(psPool_t *pool, psX509Cert_t *subjectCerts,
                 }
             }
 
-            /* Validate extensions of leaf certificate */
-            ext = &subjectCerts->extensions;
+            return matrixValidateLeafCert(subjectCerts, expectedName, opts);
+        }
+        else if (rc == PS_MEM_FAIL)
+        {
+/*
+            OK to fail on the authentication because there may be a list here
+            but MEM failures prevent us from continuing at all.
+ */
+            return rc;
+        }
+        if (issuerIndex != NULL)
+        {
+            ic = psX509FindIssuerCandidate(issuerIndex, sc, &cursor);
+        }
+        else
+        {
+            ca = ca->next;
+            ic = nextIssuerCert(&ca);
+        }
+    }
+/*
+    Success would have returned if it happen
+ */
+    return PS_CERT_AUTH_FAIL;
+}
 
-            /* Validate extended key usage */
-            if (ext->critFlags & EXT_CRIT_FLAG(OID_ENUM(id_ce_extKeyUsage)))
-            {
-                if (!(ext->ekuFlags & (EXT_KEY_USAGE_TLS_SERVER_AUTH |
-                                       EXT_KEY_USAGE_TLS_CLIENT_AUTH)))
-                {
-                    _psTrace("End-entity certificate not for TLS usage!\n");
-                    subjectCerts->authFailFlags |= PS_CERT_AUTH_FAIL_EKU_FLAG;
-                    rc = subjectCerts->authStatus = PS_CERT_AUTH_FAIL_EXTENSION;
-                }
-            }
+# ifdef USE_CERT_CHAIN_CACHE
+/******************************************************************************/
+/*
+    Peers tend to present the same chain on every connection.  A chain that
+    validated is remembered by the digest of its DER, so that the next time
+    its signatures need not be verified again.  Entries only match while the
+    CAs of the keys are the ones the chain validated against.
+ */
+static void certChainCacheClose(sslKeys_t *keys)
+{
+    if (keys->chainCache == NULL)
+    {
+        return;
+    }
+    psDestroyMutex(&keys->chainCache->lock);
+    psFree(keys->chainCache, keys->pool);
+    keys->chainCache = NULL;
+}
 
-            /* Check the subject/altSubject. Should match requested domain */
-            if (expectedName == NULL ||
-                (opts->flags & VCERTS_FLAG_SKIP_EXPECTED_NAME_VALIDATION))
-            {
-                return rc;
-            }
-            foundSupportedSAN = 0;
-            for (n = ext->san; n != NULL; n = n->next)
-            {
-                switch (n->id)
-                {
-                case GN_DNS:
-                    foundSupportedSAN = 1;
-                    if (opts->nameType == NAME_TYPE_ANY ||
-                        opts->nameType == NAME_TYPE_HOSTNAME ||
-                        opts->nameType == NAME_TYPE_SAN_DNS)
-                    {
-                        if (wildcardMatch((char *) n->data, expectedName) == 0)
-                        {
-                            return rc;
-                        }
-                    }
-                    break;
-                case GN_EMAIL:
-                    foundSupportedSAN = 1;
-                    if (opts->nameType == NAME_TYPE_ANY ||
-                        opts->nameType == NAME_TYPE_SAN_EMAIL)
-                    {
-                        if (opts->mFlags &
-                            VCERTS_MFLAG_SAN_EMAIL_CASE_INSENSITIVE_LOCAL_PART)
-                        {
-                            if (matchEmail((char *) n->data, n->dataLen,
-                                    expectedName, 0))
-                            {
-                                return rc;
-                            }
-                        }
-                        else
-                        {
-                            if (matchEmail((char *) n->data, n->dataLen,
-                                    expectedName, 1))
-                            {
-                                return rc;
-                            }
-                        }
-                    }
-                    break;
-                case GN_IP:
-                    foundSupportedSAN = 1;
-                    if (opts->nameType == NAME_TYPE_ANY ||
-                        opts->nameType == NAME_TYPE_SAN_IP_ADDRESS)
-                    {
-                        snprintf(ip, 15, "%u.%u.%u.%u",
-                            (unsigned char) (n->data[0]),
-                            (unsigned char ) (n->data[1]),
-                            (unsigned char ) (n->data[2]),
-                            (unsigned char ) (n->data[3]));
-                        ip[15] = '\0';
-                        if (strcmp(ip, expectedName) == 0)
-                        {
-                            return rc;
-                        }
-                    }
-                    break;
-                case GN_OTHER:
-                case GN_X400:
-                case GN_DIR:
-                case GN_EDI:
-                case GN_URI:
-                case GN_REGID:
-                    /* No support for these currently. */
-                    break;
-                }
-            }
+/**
+    Remember up to 'size' peer chains that validated against the CAs of
+    'keys', for at most 'seconds' each.  Set before any session uses 'keys'.
+    A size of 0 disables the cache, which is the default.
+ */
+int32_t matrixSslSetCertChainCache(sslKeys_t *keys, uint16_t size,
+    uint32_t seconds)
+{
+    certChainCache_t *cache;
+    int32_t rc;
+
+    if (keys == NULL || size > CERT_CHAIN_CACHE_MAX ||
+        (size > 0 && seconds == 0))
+    {
+        return PS_ARG_FAIL;
+    }
+    certChainCacheClose(keys);
+    if (size == 0)
+    {
+        return PS_SUCCESS;
+    }
+    cache = psMalloc(keys->pool,
+        sizeof(certChainCache_t) + size * sizeof(certChainEntry_t));
+    if (cache == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    memset(cache, 0x0,
+        sizeof(certChainCache_t) + size * sizeof(certChainEntry_t));
+    if ((rc = psCreateMutex(&cache->lock, 0)) < 0)
+    {
+        psFree(cache, keys->pool);
+        return rc;
+    }
+    cache->entry = (certChainEntry_t *) (cache + 1);
+    cache->size = size;
+    cache->seconds = seconds;
+    keys->chainCache = cache;
+    return PS_SUCCESS;
+}
+
+/**
+    Number of chains found in and missing from the cache of 'keys'
+ */
+void matrixSslGetCertChainCacheStats(sslKeys_t *keys, uint32_t *hits,
+    uint32_t *misses)
+{
+    *hits = *misses = 0;
+    if (keys == NULL || keys->chainCache == NULL)
+    {
+        return;
+    }
+    psLockMutex(&keys->chainCache->lock);
+    *hits = keys->chainCache->hits;
+    *misses = keys->chainCache->misses;
+    psUnlockMutex(&keys->chainCache->lock);
+}
 
-            /*
-               Now check the subject CN, if necessary.
+/* The CA a cached chain validated against, or NULL */
+static psX509Cert_t *certChainCacheFind(sslKeys_t *keys,
+    const unsigned char *chainId)
+{
+    certChainCache_t *cache = keys->chainCache;
+    certChainEntry_t *e;
+    psX509Cert_t *issuer = NULL;
+    psTime_t now;
+    uint16_t i;
+
+    psGetTime(&now, keys->poolUserPtr);
+    psLockMutex(&cache->lock);
+    for (i = 0; i < cache->size; i++)
+    {
+        e = &cache->entry[i];
+        if (e->generation == 0 ||
+            memcmp(e->id, chainId, SHA256_HASH_SIZE) != 0)
+        {
+            continue;
+        }
+        if (e->generation == keys->caGeneration &&
+            (uint32_t) psDiffMsecs(e->time, now, keys->poolUserPtr) / 1000 <
+            cache->seconds)
+        {
+            e->used = ++cache->clock;
+            issuer = e->issuer;
+        }
+        else
+        {
+            e->generation = 0;
+        }
+        break;
+    }
+    if (issuer != NULL)
+    {
+        cache->hits++;
+    }
+    else
+    {
+        cache->misses++;
+    }
+    psUnlockMutex(&cache->lock);
+    return issuer;
+}
 
-               RFC 6125, Section 6.4.4:
-               "a client MUST NOT seek a match for a reference identifier
-               of CN-ID if the presented identifiers include a DNS-ID, SRV-ID,
-               URI-ID, or any application-specific identifier types supported
-               by the client."
-             */
+/* Remember a validated chain, in place of the least recently used one */
+static void certChainCacheAdd(sslKeys_t *keys, const unsigned char *chainId,
+    psX509Cert_t *issuer)
+{
+    certChainCache_t *cache = keys->chainCache;
+    certChainEntry_t *e, *victim;
+    uint16_t i;
 
-# ifdef ALWAYS_CHECK_SUBJECT_CN_IN_HOSTNAME_VALIDATION
-            if (wildcardMatch(subjectCerts->subject.commonName,
-                    expectedName) == 0)
-            {
-                return rc;
-            }
-# else
-            if (opts->nameType == NAME_TYPE_ANY ||
-                opts->nameType == NAME_TYPE_CN ||
-                opts->nameType == NAME_TYPE_HOSTNAME)
-            {
-                if (!foundSupportedSAN ||
-                    (opts->mFlags & VCERTS_MFLAG_ALWAYS_CHECK_SUBJECT_CN))
-                {
-                    if (wildcardMatch(subjectCerts->subject.commonName,
-                            expectedName) == 0)
-                    {
-                        return rc;
-                    }
-                }
-            }
-# endif     /* ALWAYS_CHECK_SUBJECT_CN_IN_HOSTNAME_VALIDATION */
+    psLockMutex(&cache->lock);
+    victim = &cache->entry[0];
+    for (i = 0; i < cache->size; i++)
+    {
+        e = &cache->entry[i];
+        if (e->generation != 0 &&
+            memcmp(e->id, chainId, SHA256_HASH_SIZE) == 0)
+        {
+            victim = e;
+            break;
+        }
+        if (victim->generation != 0 &&
+            (e->generation == 0 || e->used < victim->used))
+        {
+            victim = e;
+        }
+    }
+    memcpy(victim->id, chainId, SHA256_HASH_SIZE);
+    victim->issuer = issuer;
+    victim->generation = keys->caGeneration;
+    victim->used = ++cache->clock;
+    psGetTime(&victim->time, keys->poolUserPtr);
+    psUnlockMutex(&cache->lock);
+}
 
-            psTraceInfo("Authentication failed: no matching subject\n");
-            subjectCerts->authFailFlags |= PS_CERT_AUTH_FAIL_SUBJECT_FLAG;
-            rc = subjectCerts->authStatus = PS_CERT_AUTH_FAIL_EXTENSION;
-            return rc;
+/*
+    Authentication state of a chain found in the cache.  The signatures are
+    known good; the validity dates (checked again by the parse) and the
+    revocation status can have changed.
+ */
+static int32 certChainCacheRecheck(psX509Cert_t *subjectCerts)
+{
+    psX509Cert_t *sc;
+
+    for (sc = subjectCerts; sc != NULL; sc = sc->next)
+    {
+        sc->authStatus = PS_FALSE;
+    }
+    for (sc = subjectCerts; sc != NULL; sc = sc->next)
+    {
+#  ifdef USE_CRL
+        psCRL_determineRevokedStatus(sc);
+        if (sc->revokedStatus == CRL_CHECK_REVOKED_AND_AUTHENTICATED)
+        {
+            sc->authStatus = PS_CERT_AUTH_FAIL_REVOKED;
+            return PS_CERT_AUTH_FAIL_REVOKED;
         }
-        else if (rc == PS_MEM_FAIL)
+#  endif
+        if (sc->authFailFlags & PS_CERT_AUTH_FAIL_DATE_FLAG)
+        {
+            sc->authStatus = PS_CERT_AUTH_FAIL_EXTENSION;
+        }
+        else
         {
+            sc->authStatus = PS_CERT_AUTH_PASS;
+        }
+    }
+    return PS_SUCCESS;
+}
+
 /*
-            OK to fail on the authentication because there may be a list here
-            but MEM failures prevent us from continuing at all.
+    matrixValidateCertsIndexed against the CAs of 'keys', going through the
+    chain cache of 'keys' when it has one.  chainId is the SHA-256 digest
+    of the certificate_list the peer sent, or NULL to bypass the cache.
  */
+int32 matrixSslValidateCertsCached(sslKeys_t *keys,
+    const unsigned char *chainId, psPool_t *pool,
+    psX509Cert_t *subjectCerts, char *expectedName,
+    psX509Cert_t **foundIssuer, void *hwCtx, void *poolUserPtr,
+    const matrixValidateCertsOptions_t *opts)
+{
+    psX509Cert_t *sc;
+    int32 rc;
+
+    if (keys == NULL)
+    {
+        return matrixValidateCertsIndexed(pool, subjectCerts, NULL, NULL,
+            expectedName, foundIssuer, hwCtx, poolUserPtr, opts);
+    }
+    if (keys->chainCache == NULL || chainId == NULL ||
+        keys->CAcerts == NULL)
+    {
+        return matrixValidateCertsIndexed(pool, subjectCerts, keys->CAcerts,
+            keys->caIndex, expectedName, foundIssuer, hwCtx, poolUserPtr,
+            opts);
+    }
+    if ((*foundIssuer = certChainCacheFind(keys, chainId)) != NULL)
+    {
+        if ((rc = matrixValidateCertsArgs(expectedName, opts)) < 0)
+        {
+            return rc;
+        }
+        if ((rc = certChainCacheRecheck(subjectCerts)) < 0)
+        {
             return rc;
         }
-        ic = ic->next;
+        return matrixValidateLeafCert(subjectCerts, expectedName, opts);
     }
+    rc = matrixValidateCertsIndexed(pool, subjectCerts, keys->CAcerts,
+        keys->caIndex, expectedName, foundIssuer, hwCtx, poolUserPtr, opts);
+    if (rc != PS_SUCCESS || *foundIssuer == NULL)
+    {
+        return rc;
+    }
+    for (sc = subjectCerts; sc != NULL; sc = sc->next)
+    {
+        if (sc->authStatus != PS_CERT_AUTH_PASS)
+        {
+            return rc;
+        }
+    }
+    certChainCacheAdd(keys, chainId, *foundIssuer);
+    return rc;
+}
+# endif /* USE_CERT_CHAIN_CACHE */
+
+# ifdef USE_OCSP_CACHE
+/******************************************************************************/
 /*
-    Success would have returned if it happen
+    A server staples the same OCSP response to every handshake until its
+    responder issues a new one.  The status a validated response gave is
+    remembered by the CertID issuerKeyHash and serialNumber, along with the
+    ResponseData digest its signature covered, so that response is not
+    verified again before its nextUpdate.  Entries only match while the
+    CAs of the keys are the ones the response validated against.
  */
-    return PS_CERT_AUTH_FAIL;
+static void ocspCacheClose(sslKeys_t *keys)
+{
+    if (keys->ocspCache == NULL)
+    {
+        return;
+    }
+    psDestroyMutex(&keys->ocspCache->lock);
+    psFree(keys->ocspCache, keys->pool);
+    keys->ocspCache = NULL;
+}
+
+/**
+    Remember the status from up to 'size' stapled OCSP responses that
+    validated against the CAs of 'keys', each until its nextUpdate.  Set
+    before any session uses 'keys'.  A size of 0 disables the cache, which
+    is the default.
+ */
+int32_t matrixSslSetOCSPCache(sslKeys_t *keys, uint16_t size)
+{
+    ocspCache_t *cache;
+    int32_t rc;
+
+    if (keys == NULL || size > OCSP_CACHE_MAX)
+    {
+        return PS_ARG_FAIL;
+    }
+    ocspCacheClose(keys);
+    if (size == 0)
+    {
+        return PS_SUCCESS;
+    }
+    cache = psMalloc(keys->pool,
+        sizeof(ocspCache_t) + size * sizeof(ocspCacheEntry_t));
+    if (cache == NULL)
+    {
+        return PS_MEM_FAIL;
+    }
+    memset(cache, 0x0, sizeof(ocspCache_t) + size * sizeof(ocspCacheEntry_t));
+    if ((rc = psCreateMutex(&cache->lock, 0)) < 0)
+    {
+        psFree(cache, keys->pool);
+        return rc;
+    }
+    cache->entry = (ocspCacheEntry_t *) (cache + 1);
+    cache->size = size;
+    keys->ocspCache = cache;
+    return PS_SUCCESS;
+}
+
+/**
+    Number of OCSP responses found in and missing from the cache of 'keys'
+ */
+void matrixSslGetOCSPCacheStats(sslKeys_t *keys, uint32_t *hits,
+    uint32_t *misses)
+{
+    *hits = *misses = 0;
+    if (keys == NULL || keys->ocspCache == NULL)
+    {
+        return;
+    }
+    psLockMutex(&keys->ocspCache->lock);
+    *hits = keys->ocspCache->hits;
+    *misses = keys->ocspCache->misses;
+    psUnlockMutex(&keys->ocspCache->lock);
+}
+
+static int ocspCacheMatch(const ocspCacheEntry_t *e,
+    const psOcspSingleResponse_t *sr)
+{
+    return e->generation != 0 &&
+           e->keyHashLen == sr->certIdKeyHashLen &&
+           e->serialLen == sr->certIdSerialLen &&
+           memcmp(e->keyHash, sr->certIdKeyHash, e->keyHashLen) == 0 &&
+           memcmp(e->serial, sr->certIdSerial, e->serialLen) == 0;
+}
+
+/* The singleResponse about the leaf of srvCerts, as psOcspResponseValidate
+    picks it, or -1 */
+static int32 ocspFindSingleResponse(const psOcspResponse_t *response,
+    const psX509Cert_t *srvCerts)
+{
+    const psOcspSingleResponse_t *sr;
+    int32 i;
+
+    for (i = 0; i < MAX_OCSP_RESPONSES; i++)
+    {
+        sr = &response->singleResponse[i];
+        if (srvCerts->serialNumberLen == sr->certIdSerialLen &&
+            memcmp(srvCerts->serialNumber, sr->certIdSerial,
+                srvCerts->serialNumberLen) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* 1 and the remembered result in rc if the response was validated before */
+static int32 ocspCacheFind(sslKeys_t *keys, const psOcspResponse_t *response,
+    int32 index, int32_t *rc)
+{
+    ocspCache_t *cache = keys->ocspCache;
+    const psOcspSingleResponse_t *sr = &response->singleResponse[index];
+    ocspCacheEntry_t *e;
+    psBrokenDownTime_t now;
+    int32 found = 0;
+    uint16_t i;
+
+    if (psGetBrokenDownGMTime(&now, 0) < 0)
+    {
+        return 0;
+    }
+    psLockMutex(&cache->lock);
+    for (i = 0; i < cache->size; i++)
+    {
+        e = &cache->entry[i];
+        if (!ocspCacheMatch(e, sr))
+        {
+            continue;
+        }
+        if (e->generation != keys->caGeneration ||
+            psBrokenDownTimeCmp(&e->nextUpdate, &now) < 0)
+        {
+            e->generation = 0;
+        }
+        else if (e->digestLen == response->hashLen &&
+                 memcmp(e->digest, response->hashResult, e->digestLen) == 0)
+        {
+            e->used = ++cache->clock;
+            *rc = e->rc;
+            found = 1;
+        }
+        /* else a different response about the same certificate, which
+            replaces this entry once validated */
+        break;
+    }
+    if (found)
+    {
+        cache->hits++;
+    }
+    else
+    {
+        cache->misses++;
+    }
+    psUnlockMutex(&cache->lock);
+    return found;
+}
+
+/* Remember a validated response, in place of the least recently used one */
+static void ocspCacheAdd(sslKeys_t *keys, const psOcspResponse_t *response,
+    int32 index, int32_t rc)
+{
+    ocspCache_t *cache = keys->ocspCache;
+    const psOcspSingleResponse_t *sr = &response->singleResponse[index];
+    ocspCacheEntry_t *e, *victim;
+    psBrokenDownTime_t nextUpdate;
+    uint16_t i;
+
+    /* Without nextUpdate newer status is always available (RFC 6960
+        section 4.2.2.1), so there is nothing to remember */
+    if (sr->nextUpdate == NULL ||
+        sr->certIdKeyHashLen > MAX_HASH_SIZE ||
+        sr->certIdSerialLen > OCSP_CACHE_SERIAL_MAX ||
+        response->hashLen > MAX_HASH_SIZE ||
+        psBrokenDownTimeImport(&nextUpdate, (const char *) sr->nextUpdate,
+            sr->nextUpdateLen, 0) < 0)
+    {
+        return;
+    }
+    psLockMutex(&cache->lock);
+    victim = &cache->entry[0];
+    for (i = 0; i < cache->size; i++)
+    {
+        e = &cache->entry[i];
+        if (ocspCacheMatch(e, sr))
+        {
+            victim = e;
+            break;
+        }
+        if (victim->generation != 0 &&
+            (e->generation == 0 || e->used < victim->used))
+        {
+            victim = e;
+        }
+    }
+    memcpy(victim->keyHash, sr->certIdKeyHash, sr->certIdKeyHashLen);
+    victim->keyHashLen = (uint8_t) sr->certIdKeyHashLen;
+    memcpy(victim->serial, sr->certIdSerial, sr->certIdSerialLen);
+    victim->serialLen = (uint8_t) sr->certIdSerialLen;
+    memcpy(victim->digest, response->hashResult, response->hashLen);
+    victim->digestLen = (uint8_t) response->hashLen;
+    victim->nextUpdate = nextUpdate;
+    victim->rc = rc;
+    victim->generation = keys->caGeneration;
+    victim->used = ++cache->clock;
+    psUnlockMutex(&cache->lock);
+}
+
+/*
+    psOcspResponseValidateOld against the CAs of 'keys', going through the
+    OCSP cache of 'keys' when it has one.  A hit skips locating and
+    authenticating the responder and verifying the response signature.
+ */
+int32_t matrixSslValidateOCSPResponseCached(sslKeys_t *keys, psPool_t *pool,
+    psX509Cert_t *srvCerts, psOcspResponse_t *response)
+{
+    psValidateOCSPResponseOptions_t vOpts;
+    int32 index;
+    int32_t rc;
+
+    if (keys->ocspCache == NULL || keys->CAcerts == NULL)
+    {
+        return psOcspResponseValidateOld(pool, keys->CAcerts, srvCerts,
+            response);
+    }
+    index = ocspFindSingleResponse(response, srvCerts);
+    if (index >= 0 && ocspCacheFind(keys, response, index, &rc))
+    {
+        return rc;
+    }
+    memset(&vOpts, 0x0, sizeof(vOpts));
+    vOpts.index_p = &index;
+    rc = psOcspResponseValidate(pool, keys->CAcerts, srvCerts, response,
+        &vOpts);
+    if (rc == PS_SUCCESS || rc == PS_CERT_AUTH_FAIL_REVOKED)
+    {
+        ocspCacheAdd(keys, response, index, rc);
+    }
+    return rc;
 }
+# endif /* USE_OCSP_CACHE */
 
 /******************************************************************************/
 /*
@@ -637,6 +637,13 @@ int32 matrixSslGetReadbuf(ssl_t *ssl, unsigned char **buf)
         return PS_ARG_FAIL;
     }
     psAssert(ssl && ssl->insize > 0 && ssl->inbuf != NULL);
+#ifdef USE_ASYNC_PKA
+    /* inbuf holds the flight that the pending PKA job is completing */
+    if (ssl->asyncPkaPending)
+    {
+        return PS_EAGAIN;
+    }
+#endif
     /* If there's unprocessed data in inbuf, have caller append to it */
     *buf = ssl->inbuf + ssl->inlen;
     return ssl->insize - ssl->inlen;
@@ -657,6 +664,12 @@ int32 matrixSslGetReadbufOfSize(ssl_t *ssl, int32 size, unsigned char **buf)
         return PS_ARG_FAIL;
     }
     psAssert(ssl && ssl->insize > 0 && ssl->inbuf != NULL);
+#ifdef USE_ASYNC_PKA
+    if (ssl->asyncPkaPending)
+    {
+        return PS_EAGAIN;
+    }
+#endif
 
     if ((ssl->insize - ssl->inlen) >= size)
     {
@@ -1160,7 +1173,12 @@ int32 matrixSslReceivedData(ssl_t *ssl, uint32 bytes, unsigned char **ptbuf,
     *ptbuf = NULL;
     *ptlen = 0;
     ssl->inlen += bytes;
+#ifdef USE_ASYNC_PKA
+    /* A flight grown after SSL_FULL is pending with inlen already zeroed */
+    if (ssl->inlen == 0 && !ssl->asyncPkaPending)
+#else
     if (ssl->inlen == 0)
+#endif
     {
         return PS_SUCCESS; /* Nothing to do.  Basically a poll */
     }
@@ -1339,6 +1357,13 @@ DECODE_MORE:
         {
             /* printf("THIS SHOULD BE A NEGATIVE VALUE?\n"); */
         }
+#ifdef USE_ASYNC_PKA
+        if (decodeErr == PS_PENDING && ssl->asyncPkaPending)
+        {
+            /* inlen is left as is so the zero byte call resumes */
+            return MATRIXSSL_PKA_PENDING;
+        }
+#endif
         return decodeErr; /* Will be a negative value */
 
     case SSL_ALERT:
@@ -1514,6 +1539,21 @@ DECODE_MORE:
     return rc;
 }
 
+#ifdef USE_ASYNC_PKA
+/******************************************************************************/
+/*
+    Readable once a job behind MATRIXSSL_PKA_PENDING has finished
+ */
+int32_t matrixSslGetPkaEventFd(ssl_t *ssl)
+{
+    if (!ssl || !ssl->asyncPkaInUse)
+    {
+        return PS_ARG_FAIL;
+    }
+    return psNotifyFd(&ssl->pkaNotify);
+}
+#endif /* USE_ASYNC_PKA */
+
 /******************************************************************************/
 /*
     Plaintext data has been processed as a response to MATRIXSSL_APP_DATA or
@@ -1683,6 +1723,12 @@ int32_t matrixSslEncodeRehandshake(ssl_t *ssl, sslKeys_t *keys,
  */
     if (keys != NULL)
     {
+#  if defined(USE_OCSP) && defined(USE_SERVER_SIDE_SSL)
+        /* The pinned response belongs to the old keys.  The next ClientHello
+            pins one from the new keys if the client asks for it. */
+        matrixSslReleaseOCSPStaple(ssl->staple);
+        ssl->staple = NULL;
+#  endif
         ssl->keys = keys;
         matrixSslSetSessionOption(ssl, SSL_OPTION_FULL_HANDSHAKE, NULL);
     }
@@ -72,6 +72,7 @@ extern "C" {
 # define MATRIXSSL_HANDSHAKE_COMPLETE    5            /* Handshake completed */
 # define MATRIXSSL_RECEIVED_ALERT    6                /* An alert was received */
 # define MATRIXSSL_APP_DATA_COMPRESSED   7            /* App data must be inflated */
+# define MATRIXSSL_PKA_PENDING       8                /* Waiting on an async PKA job */
 
 /******************************************************************************/
 /*
@@ -123,6 +124,16 @@ PSPUBLIC int32  matrixSslLoadRsaKeysMem(sslKeys_t *keys,
                                         const unsigned char *privBuf, int32 privLen,
                                         const unsigned char *trustedCABuf, int32 trustedCALen);
 # endif /* USE_RSA */
+# if (defined(USE_CLIENT_SIDE_SSL) || defined(USE_CLIENT_AUTH)) && \
+    defined(USE_CERT_PARSE)
+PSPUBLIC int32  matrixSslLoadTrustStoreMem(sslKeys_t *keys,
+                                           const unsigned char *image,
+                                           psSizeL_t imageLen);
+#  ifdef MATRIX_USE_FILE_SYSTEM
+PSPUBLIC int32  matrixSslLoadTrustStore(sslKeys_t *keys,
+                                        const char *fileName);
+#  endif
+# endif /* (USE_CLIENT_SIDE_SSL || USE_CLIENT_AUTH) && USE_CERT_PARSE */
 PSPUBLIC int32  matrixSslLoadPkcs12(sslKeys_t *keys,
                                     const unsigned char *p12File,
                                     const unsigned char *importPass, int32 ipasslen,
@@ -132,6 +143,21 @@ PSPUBLIC int32  matrixSslLoadPkcs12(sslKeys_t *keys,
 PSPUBLIC int32_t matrixSslLoadOCSPResponse(sslKeys_t *keys,
                                            const unsigned char *OCSPResponseBuf,
                                            psSize_t OCSPResponseBufLen);
+#  ifdef MATRIX_USE_FILE_SYSTEM
+PSPUBLIC int32_t matrixSslRefreshOCSPResponseFile(sslKeys_t *keys,
+                                                  const char *fileName);
+#  endif
+# endif
+# ifdef USE_OCSP_CACHE
+PSPUBLIC int32_t matrixSslSetOCSPCache(sslKeys_t *keys, uint16_t size);
+PSPUBLIC void matrixSslGetOCSPCacheStats(sslKeys_t *keys,
+                                         uint32_t *hits, uint32_t *misses);
+# endif
+# ifdef USE_CERT_CHAIN_CACHE
+PSPUBLIC int32_t matrixSslSetCertChainCache(sslKeys_t *keys, uint16_t size,
+                                            uint32_t seconds);
+PSPUBLIC void matrixSslGetCertChainCacheStats(sslKeys_t *keys,
+                                              uint32_t *hits, uint32_t *misses);
 # endif
 
 /******************************************************************************/
@@ -169,6 +195,23 @@ PSPUBLIC int32_t matrixSslEncodeRehandshake(ssl_t *ssl, sslKeys_t *keys,
 PSPUBLIC int32 matrixSslDisableRehandshakes(ssl_t *ssl);
 PSPUBLIC int32 matrixSslReEnableRehandshakes(ssl_t *ssl);
 
+# ifdef USE_ASYNC_PKA
+/** Get the descriptor that signals completion of a handshake PKA job.
+
+    Only valid for sessions opened with sslSessOpts_t.asyncPka set. When
+    matrixSslReceivedData returns MATRIXSSL_PKA_PENDING, the key operation
+    runs on the library worker pool. Wait for this descriptor to become
+    readable, then call matrixSslReceivedData(ssl, 0, ...) to continue the
+    handshake. Until then, do not read more data into the session.
+    The descriptor stays the same for the lifetime of the session and is
+    closed by matrixSslDeleteSession.
+
+    @param[in] ssl Pointer to the SSL session struct.
+    @return The descriptor, or PS_ARG_FAIL if the session is not async.
+ */
+PSPUBLIC int32_t matrixSslGetPkaEventFd(ssl_t *ssl);
+# endif /* USE_ASYNC_PKA */
+
 # ifdef USE_CLIENT_SIDE_SSL
 /******************************************************************************/
 /*
@@ -369,6 +412,11 @@ PSPUBLIC int32  matrixDtlsGetPmtu(void);
 PSPUBLIC int32 matrixSslLoadDhParams(sslKeys_t *keys, const char *paramFile);
 PSPUBLIC int32 matrixSslLoadDhParamsMem(sslKeys_t *keys,
                                         const unsigned char *dhBin, int32 dhBinLen);
+PSPUBLIC int32 matrixSslLoadDhGroup(sslKeys_t *keys, uint16 group);
+PSPUBLIC int32 matrixSslSetDhEphemeralPolicy(sslKeys_t *keys, uint16 usage,
+                                             uint32 seconds, uint8 ready);
+PSPUBLIC int32_t matrixSslGenEphemeralDhKey(sslKeys_t *keys, psPool_t *pool,
+                                            psDhKey_t *dh, void *usrData);
 # endif /* REQUIRE_DH_PARAMS */
 /******************************************************************************/
 
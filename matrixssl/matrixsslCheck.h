@@ -75,6 +75,24 @@ extern "C" {
 #  endif
 # endif
 
+# ifdef USE_ECC_EPHEMERAL_POOL
+#  ifndef USE_ECC
+#   error "USE_ECC required for USE_ECC_EPHEMERAL_POOL."
+#  endif
+#  ifndef USE_MULTITHREADING
+#   error "USE_MULTITHREADING required for USE_ECC_EPHEMERAL_POOL."
+#  endif
+# endif
+
+# ifdef USE_ASYNC_PKA
+#  ifndef POSIX
+#   error "USE_ASYNC_PKA only implemented for POSIX platforms."
+#  endif
+#  ifndef USE_MULTITHREADING
+#   error "USE_MULTITHREADING required for USE_ASYNC_PKA."
+#  endif
+# endif
+
 # ifdef USE_EAP_FAST
 /******************************************************************************/
 #  ifndef USE_SHA1
@@ -1122,6 +1140,15 @@ typedef int32 psX509Cert_t;
 #  endif /* USE_CERT_PARSE && USE_ONLY_PSK_CIPHER_SUITE */
 # endif /* USE_CLIENT_AUTH || USE_CLIENT_SIDE_SSL */
 
+# if defined(USE_CERT_VALIDATE) && defined(USE_SHA256)
+#  define USE_CERT_CHAIN_CACHE /* See matrixSslSetCertChainCache. */
+# endif
+
+# if defined(USE_OCSP) && defined(USE_CLIENT_SIDE_SSL) && \
+    defined(USE_CERT_VALIDATE)
+#  define USE_OCSP_CACHE /* See matrixSslSetOCSPCache. */
+# endif
+
 # if defined(USE_EXT_CERTIFICATE_VERIFY_SIGNING)
 #  ifndef USE_CLIENT_AUTH
 #   error "Must enable USE_CLIENT_AUTH if USE_EXT_CERTIFICATE_VERIFY_SIGNING is enabled"
@@ -1131,6 +1158,12 @@ typedef int32 psX509Cert_t;
 #  endif /* USE_CERT_PARSE */
 # endif  /* USE_EXT_CERTIFICATE_VERIFY_SIGNING */
 
+# if defined(USE_ED25519) && defined(USE_CLIENT_AUTH) && defined(USE_TLS_1_2)
+/* Ed25519 CertificateVerify signs the handshake messages themselves rather
+   than a running hash, so they must be buffered for the handshake */
+#  define USE_HS_TRANSCRIPT
+# endif
+
 # ifdef USE_TRUSTED_CA_INDICATION
 #  ifndef ENABLE_CA_CERT_HASH
 #   error "Define ENABLE_CA_CERT_HASH in cryptoConfig.h for Trusted CA Indication"
@@ -428,6 +428,7 @@ extern "C" {
 # define BFLAG_STOP_BEAST        (1 << 2)
 # define BFLAG_KEEP_PEER_CERTS    (1 << 3) /* Keep peer cert chain. */
 # define BFLAG_KEEP_PEER_CERT_DER (1 << 4) /* Keep raw DER of peer certs. */
+# define BFLAG_LAZY_PEER_CERTS    (1 << 5) /* Parse peer certs lazily. */
 
 /*
     Number of bytes server must send before creating a re-handshake credit
@@ -447,6 +448,7 @@ extern "C" {
 #  define SSL_OPT_BRAIN256R1  IS_BRAIN256R1
 #  define SSL_OPT_BRAIN384R1  IS_BRAIN384R1
 #  define SSL_OPT_BRAIN512R1  IS_BRAIN512R1
+#  define SSL_OPT_X25519      IS_X25519
 # endif
 
 /* Cipher types (internal for CipherSpec_t.type) */
@@ -502,9 +504,12 @@ enum PACKED
 # ifdef USE_TLS_1_2
 /**
    enum {
-    none(0), md5(1), sha1(2), sha224(3), sha256(4), sha384(5), sha512(6), (255)
+    none(0), md5(1), sha1(2), sha224(3), sha256(4), sha384(5), sha512(6),
+    intrinsic(8), (255)
    } HashAlgorithm;
-   enum { anonymous(0), rsa(1), dsa(2), ecdsa(3), (255) } SigAlgorithm;
+   enum {
+    anonymous(0), rsa(1), dsa(2), ecdsa(3), ed25519(7), (255)
+   } SigAlgorithm;
  */
 enum PACKED
 {
@@ -512,13 +517,15 @@ enum PACKED
     HASH_SIG_SHA1,
     HASH_SIG_SHA256 = 4,
     HASH_SIG_SHA384,
-    HASH_SIG_SHA512
+    HASH_SIG_SHA512,
+    HASH_SIG_INTRINSIC = 8 /* RFC 8422: signature hashes the message itself */
 };
 
 enum PACKED
 {
     HASH_SIG_RSA = 1,
-    HASH_SIG_ECDSA = 3 /* This 3 is correct for hashSigAlg */
+    HASH_SIG_ECDSA = 3, /* This 3 is correct for hashSigAlg */
+    HASH_SIG_ED25519 = 7
 };
 
 /* Internal flag format for algorithms */
@@ -535,13 +542,27 @@ enum PACKED
     HASH_SIG_SHA256_ECDSA_MASK = 0x100 << HASH_SIG_SHA256,
     HASH_SIG_SHA384_ECDSA_MASK = 0x100 << HASH_SIG_SHA384,
     HASH_SIG_SHA512_ECDSA_MASK = 0x100 << HASH_SIG_SHA512,
+    /* Intrinsic hash only pairs with Ed25519.  Hash code 7 is unassigned,
+        so its bit in the low byte is free. */
+    HASH_SIG_ED25519_MASK = 1 << 7,
 };
 
 /** Return a unique flag for the given HASH_SIG_ALG. */
 static __inline uint16_t HASH_SIG_MASK(uint8_t hash, uint8_t sig)
 {
-    /* TODO - do better validation on hash and sig */
-    hash = 1 << (hash & 0x7);
+    /* TODO - do better validation on sig */
+    if (hash == HASH_SIG_INTRINSIC)
+    {
+        /* RSA-PSS and Ed448 share this hash code and are not supported */
+        return sig == HASH_SIG_ED25519 ? HASH_SIG_ED25519_MASK : 0;
+    }
+    /* Unassigned hash codes would alias the bits above, none(0) and 7
+        included, so they match nothing */
+    if (hash < HASH_SIG_MD5 || hash > HASH_SIG_SHA512)
+    {
+        return 0;
+    }
+    hash = 1 << hash;
     return sig == HASH_SIG_RSA ? hash : ((uint16_t) hash << 8);
 }
 # endif /* USE_TLS_1_2 */
@@ -883,11 +904,56 @@ typedef struct sessTicketKey
 #  else
 #   define ECC_EPHEMERAL_CACHE_USAGE   1000         /**< Maximum use count of key */
 #  endif
+#  ifdef USE_ECC_EPHEMERAL_POOL
+#   ifndef ECC_EPHEMERAL_POOL_SIZE
+#    define ECC_EPHEMERAL_POOL_SIZE   8  /**< Keys kept ready per curve */
+#   endif
+#   ifndef ECC_EPHEMERAL_POOL_USAGE
+#    define ECC_EPHEMERAL_POOL_USAGE  1  /**< Maximum use count of a key */
+#   endif
+#   if defined(NO_ECC_EPHEMERAL_CACHE) && ECC_EPHEMERAL_POOL_USAGE > 1
+#    error "NO_ECC_EPHEMERAL_CACHE requires ECC_EPHEMERAL_POOL_USAGE 1"
+#   endif
+#   define ECC_EPHEMERAL_POOL_CURVES  4  /**< Curves pooled per sslKeys_t */
+
+/* Ready ephemeral keys for one curve, oldest first from 'head' */
+typedef struct
+{
+    const psEccCurve_t *curve;
+    psEccKey_t key[ECC_EPHEMERAL_POOL_SIZE];
+    psTime_t time[ECC_EPHEMERAL_POOL_SIZE];  /**< Time key was generated */
+    uint16_t use[ECC_EPHEMERAL_POOL_SIZE];   /**< Use count */
+    uint8_t head;
+    uint8_t count;
+} eccEphemeralRing_t;
+#  endif /* USE_ECC_EPHEMERAL_POOL */
+#  if defined(USE_ECDSA_PRESIGN) && !defined(ECDSA_PRESIGN_DEPTH)
+#   define ECDSA_PRESIGN_DEPTH  16  /**< Signing nonces kept ready */
+#  endif
+#  ifdef REQUIRE_DH_PARAMS
+#   define DH_EPHEMERAL_CACHE_SECONDS  (2 * 60 * 60) /**< Default lifetime */
+#   define DH_EPHEMERAL_POOL_MAX       16   /**< Most keys kept ready */
+/* Longest key lifetime in seconds that psDiffMsecs() can measure */
+#   define DH_EPHEMERAL_MAX_SECONDS    (0x7FFFFFFF / 1000)
+
+/* Ephemeral keys for keys->dhParams, oldest first from 'head' */
+typedef struct
+{
+    psDhKey_t key[DH_EPHEMERAL_POOL_MAX];
+    psTime_t time[DH_EPHEMERAL_POOL_MAX];   /**< Time key was generated */
+    uint16_t use[DH_EPHEMERAL_POOL_MAX];    /**< Use count */
+    uint8_t head;
+    uint8_t count;
+} dhEphemeralRing_t;
+#  endif /* REQUIRE_DH_PARAMS */
 typedef struct
 {
 #  ifdef USE_MULTITHREADING
     psMutex_t lock;
 #  endif
+#  if defined(USE_ECC_EPHEMERAL_POOL) || defined(REQUIRE_DH_PARAMS)
+    uint32_t pid;                    /**< Process that made the ready keys */
+#  endif
 #  ifdef USE_ECC
     psEccKey_t eccPrivKey;           /**< Cached ephemeral key */
     psEccKey_t eccPubKey;            /**< Cached remote ephemeral pub key */
@@ -896,11 +962,106 @@ typedef struct
     uint16_t eccPubKeyCurveId;       /**< Curve the point is on */
     unsigned char eccPubKeyRaw[132]; /**< Max size of secp521r1 */
 #  endif
+#  ifdef USE_ECC_EPHEMERAL_POOL
+    eccEphemeralRing_t *eccRing[ECC_EPHEMERAL_POOL_CURVES];
+    psWorkerPool_t *eccWorker;       /**< Refills eccRing in the background */
+    psWorkerJob_t eccRefill;
+    uint8_t eccRefillQueued;         /**< eccRefill is queued or running */
+    uint8_t eccClosing;
+#  endif
+#  ifdef USE_ECDSA_PRESIGN
+    psEccPresign_t *ecdsaPresign;    /**< Nonces for signing with privKey */
+#  endif
 #  ifdef REQUIRE_DH_PARAMS
+    dhEphemeralRing_t *dhRing;       /**< Allocated once the policy needs it */
+    uint32_t dhSeconds;              /**< Max lifetime of a key */
+    uint16_t dhUsage;                /**< Maximum use count of a key */
+    uint8_t dhReady;                 /**< Keys generated in the background */
+    psWorkerPool_t *dhWorker;        /**< Refills dhRing in the background */
+    psWorkerJob_t dhRefill;
+    uint8_t dhRefillQueued;          /**< dhRefill is queued or running */
+    uint8_t dhClosing;
 #  endif
 } ephemeralKeyCache_t;
 # endif /* defined(USE_ECC) || defined(REQUIRE_DH_PARAMS) */
 
+# ifdef USE_CERT_CHAIN_CACHE
+#  define CERT_CHAIN_CACHE_MAX 4096    /**< Most chains a cache can hold */
+
+/* A peer chain that validated against the CAs of an sslKeys_t */
+typedef struct
+{
+    unsigned char id[SHA256_HASH_SIZE]; /**< Digest of the DER chain */
+    psX509Cert_t *issuer;               /**< Trusted CA of the chain */
+    psTime_t time;                      /**< Time the chain was validated */
+    uint32_t generation;                /**< keys->caGeneration, 0 if free */
+    uint32_t used;                      /**< Clock of the last hit */
+} certChainEntry_t;
+
+/* See matrixSslSetCertChainCache */
+typedef struct
+{
+#  ifdef USE_MULTITHREADING
+    psMutex_t lock;
+#  endif
+    certChainEntry_t *entry;
+    uint32_t seconds;                   /**< Lifetime of an entry */
+    uint32_t clock;                     /**< Ticks on every insert and hit */
+    uint32_t hits;
+    uint32_t misses;
+    uint16_t size;
+} certChainCache_t;
+# endif /* USE_CERT_CHAIN_CACHE */
+
+# ifdef USE_OCSP_CACHE
+#  define OCSP_CACHE_MAX 4096          /**< Most responses a cache can hold */
+#  define OCSP_CACHE_SERIAL_MAX 32     /**< Longest serialNumber remembered */
+
+/* Status of one certificate from an OCSP response that validated against
+    the CAs of an sslKeys_t */
+typedef struct
+{
+    unsigned char keyHash[MAX_HASH_SIZE];       /**< CertID issuerKeyHash */
+    unsigned char serial[OCSP_CACHE_SERIAL_MAX]; /**< CertID serialNumber */
+    unsigned char digest[MAX_HASH_SIZE];        /**< Signed ResponseData hash */
+    psBrokenDownTime_t nextUpdate;              /**< Entry expires after */
+    int32_t rc;                                 /**< Validation result */
+    uint32_t generation;                /**< keys->caGeneration, 0 if free */
+    uint32_t used;                      /**< Clock of the last hit */
+    uint8_t keyHashLen;
+    uint8_t serialLen;
+    uint8_t digestLen;
+} ocspCacheEntry_t;
+
+/* See matrixSslSetOCSPCache */
+typedef struct
+{
+#  ifdef USE_MULTITHREADING
+    psMutex_t lock;
+#  endif
+    ocspCacheEntry_t *entry;
+    uint32_t clock;                     /**< Ticks on every insert and hit */
+    uint32_t hits;
+    uint32_t misses;
+    uint16_t size;
+} ocspCache_t;
+# endif /* USE_OCSP_CACHE */
+
+# if defined(USE_OCSP) && defined(USE_SERVER_SIDE_SSL)
+/* A CertificateStatus body, shared by the keys and the handshakes sending
+    it.  See matrixSslLoadOCSPResponse */
+typedef struct
+{
+    unsigned char *msg;             /* 4 byte header, then the OCSPResponse */
+    psSize_t len;                   /* Of the OCSPResponse */
+    uint32_t refs;                  /* Under lock */
+#  ifdef USE_MULTITHREADING
+    psMutex_t *lock;                /* stapleLock of the keys that loaded it */
+#  endif
+    psPool_t *pool;                 /* Pool of those keys */
+} sslOcspStaple_t;
+# endif
+
 typedef struct
 {
     psPool_t *pool;
@@ -909,10 +1070,34 @@ typedef struct
     /* in the cert */
     psPubKey_t privKey;
     psX509Cert_t *cert;
+    unsigned char *certMsg;         /* Certificate message entries for cert,
+                                       3 byte length and DER each */
+    uint32 certMsgLen;
+    uint16 certCount;
 # endif /* USE_SERVER_SIDE_SSL || USE_CLIENT_AUTH */
 # if defined(USE_CLIENT_SIDE_SSL) || defined(USE_CLIENT_AUTH)
     psX509Cert_t *CAcerts;
+#  ifdef USE_CERT_VALIDATE
+    psX509CertIndex_t *caIndex;     /* Issuer lookup into CAcerts, or NULL */
+    uint32_t caGeneration;          /* Incremented when CAcerts change */
+#  endif
+#  ifdef MATRIX_USE_FILE_SYSTEM
+    const unsigned char *caImage;   /* matrixSslLoadTrustStore mapping */
+    psSizeL_t caImageLen;
+#  endif
+#  ifdef USE_CERT_CHAIN_CACHE
+    certChainCache_t *chainCache;   /* Validated peer chains, or NULL */
+#  endif
+#  ifdef USE_OCSP_CACHE
+    ocspCache_t *ocspCache;         /* Validated OCSP responses, or NULL */
+#  endif
 # endif /* USE_CLIENT_SIDE_SSL || USE_CLIENT_AUTH */
+# if defined(USE_SERVER_SIDE_SSL) && defined(USE_CLIENT_AUTH)
+    unsigned char *caDnMsg;         /* CertificateRequest certificate
+                                       authorities, 2 byte length and DN each */
+    uint32 caDnMsgLen;
+    uint16 caCount;
+# endif /* USE_SERVER_SIDE_SSL && USE_CLIENT_AUTH */
 # ifdef REQUIRE_DH_PARAMS
     psDhParams_t dhParams;
 # endif /* REQUIRE_DH_PARAMS */
@@ -924,14 +1109,20 @@ typedef struct
     sslSessTicketCb_t ticket_cb;
 # endif
 # if defined(USE_OCSP) && defined(USE_SERVER_SIDE_SSL)
-    unsigned char *OCSPResponseBuf;
-    psSize_t OCSPResponseBufLen;
+#  ifdef USE_MULTITHREADING
+    psMutex_t stapleLock;           /* Guards staple and its refs */
+#  endif
+    sslOcspStaple_t *staple;        /* Current response, or NULL */
 # endif
     void *poolUserPtr;              /* Data that will be given to psOpenPool
                                        for any operations involving these keys */
 # if defined(USE_ECC) || defined(REQUIRE_DH_PARAMS)
     ephemeralKeyCache_t cache;
 # endif
+# if defined(USE_SERVER_SIDE_SSL) && defined(VALIDATE_KEY_MATERIAL)
+    uint32_t cipherEligible[8];     /* Bit per supported cipher ordinal these
+                                       keys can serve, set when loaded */
+# endif
 } sslKeys_t;
 
 /******************************************************************************/
@@ -954,6 +1145,10 @@ typedef struct
     int32 useExtCvSigOp;                            /* Client: sign the handshake messages hash in
                                                        CertificateVerify externally. */
 # endif /* USE_EXT_CERTIFICATE_VERIFY_SIGNING */
+# ifdef USE_ASYNC_PKA
+    short asyncPka;                                 /* 1 to run handshake PKA ops on the
+                                                       library worker pool (TLS only) */
+# endif /* USE_ASYNC_PKA */
     int32 versionFlag;                              /* The SSL_FLAGS_TLS_ version (+ DTLS flag here) */
 #ifdef USE_CLIENT_SIDE_SSL
     uint8_t clientRejectVersionDowngrade;             /* Send SSL_ALERT_PROTOCOL_VERSION if server proposes
@@ -968,6 +1163,10 @@ typedef struct
     int32 keep_peer_cert_der;                       /* Keep raw DER of peer certs */
     int32 keep_peer_certs;                          /* Keep peer cert chain until the session
                                                        is deleted  */
+    int32 lazy_peer_cert_parse;                     /* Parse peer certs with CERT_LAZY_PARSE.
+                                                       The certificate callback must call
+                                                       psX509DecodeCert before reading DN
+                                                       attributes or subjectAltNames */
     matrixValidateCertsOptions_t validateCertsOpts; /* Certificate validation
                                                        options. */
     void *userDataPtr; /* Initial value of ssl->userDataPtr during NewSession. */
@@ -1096,6 +1295,11 @@ typedef struct
     unsigned char sha512Snapshot[SHA512_HASH_SIZE];
 # endif
 
+# ifdef USE_HS_TRANSCRIPT
+    psDynBuf_t hsTranscript;              /* Raw handshake messages */
+    uint32 hsTranscriptCvLen;             /* Portion before CERTIFICATE_VERIFY */
+# endif
+
 # if defined(USE_PSK_CIPHER_SUITE) && defined(USE_CLIENT_SIDE_SSL)
     unsigned char *hint;
     uint8_t hintLen;
@@ -1209,7 +1413,8 @@ enum
     PKA_AFTER_ECDH_KEY_GEN,         /* ECDH CKE operation. makeKey */
     PKA_AFTER_ECDH_SECRET_GEN,      /* GenSecret */
     PKA_AFTER_ECDH_SECRET_GEN_DONE, /* Control for single-pass op */
-    PKA_AFTER_DH_KEY_GEN            /* DH CKE operation */
+    PKA_AFTER_DH_KEY_GEN,           /* DH CKE operation */
+    PKA_AFTER_ED25519_SIG_GEN       /* Ed25519 over the whole message */
 };
 
 typedef struct
@@ -1223,6 +1428,10 @@ typedef struct
     psPool_t *pool;
 } pkaAfter_t;
 
+# if defined(USE_ASYNC_PKA) && !defined(ASYNC_PKA_THREADS)
+#  define ASYNC_PKA_THREADS   2  /**< Worker threads shared by all sessions */
+# endif
+
 typedef struct nextMsgInFlight
 {
     unsigned char *start;
@@ -1245,6 +1454,11 @@ struct ssl
     sslSec_t sec;                   /* Security structure */
 
     sslKeys_t *keys;                /* SSL public and private keys */
+# if defined(USE_OCSP) && defined(USE_SERVER_SIDE_SSL)
+    sslOcspStaple_t *staple;        /* keys->staple when the handshake
+                                       agreed to send CertificateStatus,
+                                       taken once its keys were chosen */
+# endif
 
     pkaAfter_t pkaAfter[2];         /* Cli-side cli-auth = two PKA in flight */
 # ifdef USE_EXT_CERTIFICATE_VERIFY_SIGNING
@@ -1257,6 +1471,15 @@ struct ssl
     int32_t extCvSigAlg;
     unsigned char *extCvOrigFlightEnd;
 # endif /* USE_EXT_CERTIFICATE_VERIFY_SIGNING */
+# ifdef USE_ASYNC_PKA
+    uint8_t asyncPkaInUse;          /* Opened with sslSessOpts_t.asyncPka */
+    uint8_t asyncPkaPending;        /* pkaJob submitted, result not collected */
+    int32 asyncPkaRc;               /* Return code of asyncPkaOp */
+    int32 (*asyncPkaOp)(struct ssl *ssl, psBuf_t *out);
+    psBuf_t asyncPkaOut;            /* Flight buffer, the job's until collected */
+    psWorkerJob_t pkaJob;
+    psNotify_t pkaNotify;           /* Posted when asyncPkaOp has returned */
+# endif /* USE_ASYNC_PKA */
     flightEncode_t *flightEncode;
     unsigned char *delayHsHash;
     unsigned char *seqDelay;      /* tmp until flightEncode_t is built */
@@ -1292,7 +1515,7 @@ struct ssl
     uint32 bFlagsBk;
 # endif /* USE_CLIENT_SIDE_SSL */
 
-# if defined(USE_HARDWARE_CRYPTO_RECORD) || defined (USE_HARDWARE_CRYPTO_PKA) || defined(USE_EXT_CERTIFICATE_VERIFY_SIGNING)
+# if defined(USE_HARDWARE_CRYPTO_RECORD) || defined (USE_HARDWARE_CRYPTO_PKA) || defined(USE_EXT_CERTIFICATE_VERIFY_SIGNING) || defined(USE_ASYNC_PKA)
     uint32 hwflags;             /* SSL_HWFLAGS_ */
 # endif
 
@@ -1532,6 +1755,15 @@ extern int32_t matrixSslEncodeClientHello(ssl_t *ssl, sslBuf_t *out,
 extern int32    matrixSslGetSessionId(ssl_t *ssl, sslSessionId_t *sessionId);
 # endif /* USE_CLIENT_SIDE_SSL */
 
+# ifdef USE_ECDSA_PRESIGN
+extern psEccPresign_t *matrixSslGetEcdsaPresign(sslKeys_t *keys);
+# endif /* USE_ECDSA_PRESIGN */
+
+# if defined(USE_OCSP) && defined(USE_SERVER_SIDE_SSL)
+extern sslOcspStaple_t *matrixSslAcquireOCSPStaple(sslKeys_t *keys);
+extern void matrixSslReleaseOCSPStaple(sslOcspStaple_t *staple);
+# endif
+
 # ifdef USE_SSL_INFORMATIONAL_TRACE
 extern void matrixSslPrintHSDetails(ssl_t *ssl);
 # endif /* USE_SSL_INFORMATIONAL_TRACE */
@@ -1558,6 +1790,25 @@ extern int32 matrixValidateCertsExt(psPool_t *pool, psX509Cert_t *subjectCerts,
                                     psX509Cert_t *issuerCerts, char *expectedName,
                                     psX509Cert_t **foundIssuer, void *pkiData, void *userPoolPtr,
                                     const matrixValidateCertsOptions_t *options);
+extern int32 matrixValidateCertsIndexed(psPool_t *pool, psX509Cert_t *subjectCerts,
+                                        psX509Cert_t *issuerCerts,
+                                        const psX509CertIndex_t *issuerIndex,
+                                        char *expectedName,
+                                        psX509Cert_t **foundIssuer, void *pkiData, void *userPoolPtr,
+                                        const matrixValidateCertsOptions_t *options);
+#  ifdef USE_CERT_CHAIN_CACHE
+extern int32 matrixSslValidateCertsCached(sslKeys_t *keys,
+                                          const unsigned char *chainId,
+                                          psPool_t *pool, psX509Cert_t *subjectCerts,
+                                          char *expectedName,
+                                          psX509Cert_t **foundIssuer, void *pkiData, void *userPoolPtr,
+                                          const matrixValidateCertsOptions_t *options);
+#  endif
+#  ifdef USE_OCSP_CACHE
+extern int32_t matrixSslValidateOCSPResponseCached(sslKeys_t *keys,
+                                                   psPool_t *pool, psX509Cert_t *srvCerts,
+                                                   psOcspResponse_t *response);
+#  endif
 extern int32 matrixUserCertValidator(ssl_t *ssl, int32 alert,
                                      psX509Cert_t *subjectCert, sslCertCb_t certCb);
 # endif /* USE_ONLY_PSK_CIPHER_SUITE */
@@ -1630,6 +1881,9 @@ extern int32 sslActivateWriteCipher(ssl_t *ssl);
 extern int32_t sslUpdateHSHash(ssl_t *ssl, const unsigned char *in, psSize_t len);
 extern int32 sslInitHSHash(ssl_t *ssl);
 extern int32 sslSnapshotHSHash(ssl_t *ssl, unsigned char *out, int32 senderFlag);
+# ifdef USE_HS_TRANSCRIPT
+extern void sslFreeHSTranscript(ssl_t *ssl);
+# endif
 extern int32 sslWritePad(unsigned char *p, unsigned char padLen);
 extern int32 sslCreateKeys(ssl_t *ssl);
 extern void sslResetContext(ssl_t *ssl);
@@ -1637,6 +1891,12 @@ extern void clearPkaAfter(ssl_t *ssl);
 extern pkaAfter_t *getPkaAfter(ssl_t *ssl);
 extern void freePkaAfter(ssl_t *ssl);
 extern void clearFlightList(ssl_t *ssl);
+# ifdef USE_ASYNC_PKA
+extern int32 sslSubmitPkaJob(ssl_t *ssl,
+                             int32 (*op)(ssl_t *ssl, psBuf_t *out),
+                             psBuf_t *out);
+extern int32 sslCollectPkaJob(ssl_t *ssl, psBuf_t *out);
+# endif
 
 # ifdef USE_SERVER_SIDE_SSL
 extern int32 matrixRegisterSession(ssl_t *ssl);
@@ -1687,6 +1947,8 @@ extern int32_t sslGetCipherSpecListLen(const ssl_t *ssl);
 extern int32_t sslGetCipherSpecList(ssl_t *ssl, unsigned char *c, int32 len,
                                     int32 addScsv);
 extern int32_t haveKeyMaterial(const ssl_t *ssl, int32 cipherType, short reallyTest);
+extern void sslInitCipherIndex(void);
+extern void matrixSslUpdateCipherEligibility(sslKeys_t *keys);
 # ifdef USE_CLIENT_SIDE_SSL
 int32 csCheckCertAgainstCipherSuite(int32 sigAlg, int32 cipherType);
 # endif
@@ -104,6 +104,7 @@ int32_t matrixSslLoadPsk(sslKeys_t *keys,
         }
         list->next = psk;
     }
+    matrixSslUpdateCipherEligibility(keys);
 
     return 0;
 }
@@ -148,13 +148,13 @@ int32 matrixSslDecode(ssl_t *ssl, unsigned char **buf, uint32 *len,
     p = pend = mac = ctStart = NULL;
     padLen = 0;
 
-# ifdef USE_EXT_CERTIFICATE_VERIFY_SIGNING
+# if defined(USE_EXT_CERTIFICATE_VERIFY_SIGNING) || defined(USE_ASYNC_PKA)
     if (ssl->hwflags & SSL_HWFLAGS_PENDING_PKA_W ||
         ssl->hwflags & SSL_HWFLAGS_PENDING_FLIGHT_W)
     {
         goto encodeResponse;
     }
-# endif /* USE_EXT_CERTIFICATE_VERIFY_SIGNING */
+# endif /* USE_EXT_CERTIFICATE_VERIFY_SIGNING || USE_ASYNC_PKA */
 
 /*
     This flag is set if the previous call to this routine returned an SSL_FULL
@@ -1627,7 +1627,7 @@ encodeResponse:
     tmpout.buf = tmpout.end = tmpout.start = origbuf;
     tmpout.size = size;
 
-# if defined(USE_HARDWARE_CRYPTO_RECORD) || defined(USE_HARDWARE_CRYPTO_PKA) || defined(USE_EXT_CERTIFICATE_VERIFY_SIGNING)
+# if defined(USE_HARDWARE_CRYPTO_RECORD) || defined(USE_HARDWARE_CRYPTO_PKA) || defined(USE_EXT_CERTIFICATE_VERIFY_SIGNING) || defined(USE_ASYNC_PKA)
     if (!(ssl->hwflags & SSL_HWFLAGS_PENDING_PKA_W) &&
         !(ssl->hwflags & SSL_HWFLAGS_PENDING_FLIGHT_W))
     {
@@ -2197,6 +2197,10 @@ hsStateDetermined:
             ssl->err = SSL_ALERT_INTERNAL_ERROR;
             return MATRIXSSL_ERROR;
         }
+# ifdef USE_HS_TRANSCRIPT
+        ssl->sec.hsTranscriptCvLen = (uint32)
+            (ssl->sec.hsTranscript.buf.end - ssl->sec.hsTranscript.buf.start);
+# endif
     }
 #endif /* USE_CLIENT_AUTH */
 
@@ -683,8 +683,14 @@ static int32 nowDoSkePka(ssl_t *ssl, psBuf_t *out)
 #    ifdef USE_DTLS
         ssl->ecdsaSizeChange = 0;
 #    endif
+#    ifdef USE_ECDSA_PRESIGN
+        if ((err = psEccDsaSignExt(pkiPool, &ssl->keys->privKey.key.ecc,
+                 matrixSslGetEcdsaPresign(ssl->keys),
+                 pka->inbuf, pka->inlen, tmpEcdsa, &len, 1, pka->data)) != 0)
+#    else
         if ((err = psEccDsaSign(pkiPool, &ssl->keys->privKey.key.ecc,
                  pka->inbuf, pka->inlen, tmpEcdsa, &len, 1, pka->data)) != 0)
+#    endif
         {
             /* DO NOT close pool (unless failed).  It is kept around in
                 pkaCmdInfo for result until finished and is closed there */
@@ -736,6 +742,19 @@ static int32 nowDoSkePka(ssl_t *ssl, psBuf_t *out)
         clearPkaAfter(ssl);
     }
 #   endif /* USE_ECC_CIPHER_SUITE */
+#   ifdef USE_ED25519
+    if (pka->type == PKA_AFTER_ED25519_SIG_GEN)
+    {
+        if (psEd25519Sign(&ssl->keys->privKey.key.ed25519, pka->inbuf,
+                pka->inlen, pka->outbuf) < 0)
+        {
+            clearPkaAfter(ssl);
+            return MATRIXSSL_ERROR;
+        }
+        clearPkaAfter(ssl);
+        rc = PS_SUCCESS;
+    }
+#   endif /* USE_ED25519 */
 #  endif  /* !USE_ONLY_PSK_CIPHER_SUITE */
     return rc;
 }
@@ -1152,6 +1171,14 @@ if (g_reusePreLen == 0)
 
     return rc;
 }
+
+#  ifdef USE_ASYNC_PKA
+/* nowDoCkePka in the shape of a worker pool PKA job */
+static int32 nowDoCkePkaJob(ssl_t *ssl, psBuf_t *out)
+{
+    return nowDoCkePka(ssl);
+}
+#  endif /* USE_ASYNC_PKA */
 # endif /* USE_CLIENT_SIDE_SSL */
 
 /******************************************************************************/
@@ -1168,9 +1195,6 @@ int32 sslEncodeResponse(ssl_t *ssl, psBuf_t *out, uint32 *requiredLen)
 
 # if defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH)
     int32 i;
-#  ifndef USE_ONLY_PSK_CIPHER_SUITE
-    psX509Cert_t *cert;
-#  endif /* USE_ONLY_PSK_CIPHER_SUITE */
 # endif  /* USE_SERVER_SIDE_SSL */
 
 # if defined(USE_SERVER_SIDE_SSL)
@@ -1242,6 +1266,18 @@ int32 sslEncodeResponse(ssl_t *ssl, psBuf_t *out, uint32 *requiredLen)
     }
 # endif
 
+# ifdef USE_ASYNC_PKA
+    if (ssl->asyncPkaPending)
+    {
+        /* Case of a PKA job for this flight on the worker pool */
+        if ((rc = sslCollectPkaJob(ssl, out)) < 0)
+        {
+            return rc; /* PS_PENDING or the job's error */
+        }
+        goto resumeFlightAfterPka;
+    }
+# endif /* USE_ASYNC_PKA */
+
 # ifdef USE_DTLS
     if (ssl->flags & SSL_FLAGS_DTLS)
     {
@@ -1300,6 +1336,9 @@ int32 sslEncodeResponse(ssl_t *ssl, psBuf_t *out, uint32 *requiredLen)
 #      else
                 certReqLen += 4;
 #      endif /* USE_SHA */
+#      ifdef USE_HS_TRANSCRIPT
+                certReqLen += 2; /* Ed25519 */
+#      endif
 #     endif  /* USE_ECC */
 #     ifdef USE_RSA
 #      ifdef USE_SHA384
@@ -1317,13 +1356,10 @@ int32 sslEncodeResponse(ssl_t *ssl, psBuf_t *out, uint32 *requiredLen)
 #    ifdef USE_ECC
                 certReqLen += 1; /* Add on ECDSA_SIGN support */
 #    endif /* USE_ECC */
-                while (CAcert)
-                {
-                    certReqLen += 2; /* 2 bytes for specifying each cert len */
-                    CAcertLen += CAcert->subject.dnencLen;
-                    CAcert = CAcert->next;
-                    certCount++;
-                }
+                /* 2 bytes for specifying each cert len */
+                certCount = ssl->keys->caCount;
+                certReqLen += certCount * 2;
+                CAcertLen = ssl->keys->caDnMsgLen - (certCount * 2);
 #    ifdef USE_DTLS
                 /* if (ssl->flags & SSL_FLAGS_DTLS) { */
                 /*      if (certReqLen + CAcertLen > ssl->pmtu) { */
@@ -1435,13 +1471,13 @@ int32 sslEncodeResponse(ssl_t *ssl, psBuf_t *out, uint32 *requiredLen)
                          1 byte pub key len, 2 byte privkeysize len,
                          1 byte 0x04 inside the eccKey itself
  */
-                    srvKeyExLen = (ssl->sec.eccKeyPriv->curve->size * 2) + 7 +
+                    srvKeyExLen = psEccX963Size(ssl->sec.eccKeyPriv->curve) + 6 +
                                   ssl->keys->privKey.keysize;
                 }
                 else if (ssl->flags & SSL_FLAGS_DHE_WITH_DSA)
                 {
                     /* ExportKey plus signature */
-                    srvKeyExLen = (ssl->sec.eccKeyPriv->curve->size * 2) + 7 +
+                    srvKeyExLen = psEccX963Size(ssl->sec.eccKeyPriv->curve) + 6 +
                                   6 + /* 6 = 2 ASN_SEQ, 4 ASN_BIG */
                                   ssl->keys->privKey.keysize;
                     if (ssl->keys->privKey.keysize >= 128)
@@ -1487,12 +1523,8 @@ int32 sslEncodeResponse(ssl_t *ssl, psBuf_t *out, uint32 *requiredLen)
 #   endif   /* USE_ECC_CIPHER_SUITE */
             stotalCertLen = i = 0;
 #   ifndef USE_ONLY_PSK_CIPHER_SUITE
-            cert = ssl->keys->cert;
-            for (i = 0; cert != NULL; i++)
-            {
-                stotalCertLen += cert->binLen;
-                cert = cert->next;
-            }
+            i = ssl->keys->certCount;
+            stotalCertLen = ssl->keys->certMsgLen - (i * 3);
             /* Are we going to have to fragment the CERTIFICATE message? */
             if ((stotalCertLen + 3 + (i * 3) + ssl->hshakeHeadLen) >
                 ssl->maxPtFrag)
@@ -1565,13 +1597,8 @@ int32 sslEncodeResponse(ssl_t *ssl, psBuf_t *out, uint32 *requiredLen)
         {
 #  endif
 #  ifndef USE_ONLY_PSK_CIPHER_SUITE
-        cert = ssl->keys->cert;
-        for (i = 0; cert != NULL; i++)
-        {
-            psAssert(cert->unparsedBin != NULL);
-            stotalCertLen += cert->binLen;
-            cert = cert->next;
-        }
+        i = ssl->keys->certCount;
+        stotalCertLen = ssl->keys->certMsgLen - (i * 3);
         /* Are we going to have to fragment the CERTIFICATE message? */
         if ((stotalCertLen + 3 + (i * 3) + ssl->hshakeHeadLen) >
             ssl->maxPtFrag)
@@ -1674,10 +1701,10 @@ int32 sslEncodeResponse(ssl_t *ssl, psBuf_t *out, uint32 *requiredLen)
             messageSize += 4; /* 2 type, 2 length, 0 value */
 
             /* And the handshake message oh.  1 type, 3 len, x OCSPResponse
-                The status_request flag will only have been set if a
-                ssl->keys->OCSPResponseBuf was present during extension parse */
+                The status_request flag will only have been left set if
+                parseClientHello took ssl->staple */
             messageSize += ssl->hshakeHeadLen + ssl->recordHeadLen + 4 +
-                           ssl->keys->OCSPResponseBufLen;
+                           ssl->staple->len;
             messageSize += secureWriteAdditions(ssl, 1);
         }
 #  endif
@@ -2100,7 +2127,7 @@ int32 sslEncodeResponse(ssl_t *ssl, psBuf_t *out, uint32 *requiredLen)
 #   ifdef USE_ECC_CIPHER_SUITE
                 if (ssl->flags & SSL_FLAGS_ECC_CIPHER)
                 {
-                    ckeSize = (ssl->sec.eccKeyPriv->curve->size * 2) + 2;
+                    ckeSize = psEccX963Size(ssl->sec.eccKeyPriv->curve) + 1;
                 }
                 else
                 {
@@ -2189,13 +2216,8 @@ int32 sslEncodeResponse(ssl_t *ssl, psBuf_t *out, uint32 *requiredLen)
 /*
                     Account for the certificate and certificateVerify messages
  */
-                    cert = ssl->keys->cert;
-                    ctotalCertLen = 0;
-                    for (i = 0; cert != NULL; i++)
-                    {
-                        ctotalCertLen += cert->binLen;
-                        cert = cert->next;
-                    }
+                    i = ssl->keys->certCount;
+                    ctotalCertLen = ssl->keys->certMsgLen - (i * 3);
                     /* Are we going to have to fragment the CERT message? */
                     if ((ctotalCertLen + 3 + (i * 3) + ssl->hshakeHeadLen) >
                         ssl->maxPtFrag)
@@ -2221,6 +2243,13 @@ int32 sslEncodeResponse(ssl_t *ssl, psBuf_t *out, uint32 *requiredLen)
                         }
                     }
 #    endif          /* USE_ECC */
+#    ifdef USE_HS_TRANSCRIPT
+                    if (ssl->keys->privKey.type == PS_ED25519)
+                    {
+                        /* Signature is twice the key size */
+                        messageSize += ED25519_SIG_SIZE - ED25519_KEY_SIZE;
+                    }
+#    endif
                 }
                 else
                 {
@@ -2472,6 +2501,12 @@ resumeFlightEncryption:
     {
         if (ssl->pkaAfter[0].type > 0)
         {
+#  ifdef USE_ASYNC_PKA
+            if (ssl->asyncPkaInUse)
+            {
+                return sslSubmitPkaJob(ssl, nowDoSkePka, out);
+            }
+#  endif /* USE_ASYNC_PKA */
             if ((rc = nowDoSkePka(ssl, out)) < 0)
             {
                 return rc;
@@ -2506,6 +2541,12 @@ resumeFlightEncryption:
          /* Handle delayed ClientKeyExchange write. */
         if (ssl->pkaAfter[0].type > 0)
         {
+#  ifdef USE_ASYNC_PKA
+            if (ssl->asyncPkaInUse)
+            {
+                return sslSubmitPkaJob(ssl, nowDoCkePkaJob, out);
+            }
+#  endif /* USE_ASYNC_PKA */
             if ((rc = nowDoCkePka(ssl)) < 0)
             {
                 return rc;
@@ -2514,6 +2555,9 @@ resumeFlightEncryption:
     }
 # endif
 
+# ifdef USE_ASYNC_PKA
+resumeFlightAfterPka:
+# endif
     /* Encrypt Flight */
     if (ssl->flightEncode)
     {
@@ -2796,6 +2840,7 @@ pkaAfter_t *getPkaAfterCv(ssl_t *ssl)
     {
         if (ssl->pkaAfter[i].type == PKA_AFTER_RSA_SIG_GEN_ELEMENT
             || ssl->pkaAfter[i].type == PKA_AFTER_ECDSA_SIG_GEN
+            || ssl->pkaAfter[i].type == PKA_AFTER_ED25519_SIG_GEN
             || ssl->pkaAfter[i].type == PKA_AFTER_RSA_SIG_GEN)
         {
             return &ssl->pkaAfter[i];
@@ -4315,13 +4360,22 @@ static int32 writeServerKeyExchange(ssl_t *ssl, sslBuf_t *out, uint32 pLen,
     if (ssl->flags & SSL_FLAGS_ECC_CIPHER)
     {
         /* ExportKey portion */
-        eccPubKeyLen = (ssl->sec.eccKeyPriv->curve->size * 2) + 1;
+        eccPubKeyLen = psEccX963Size(ssl->sec.eccKeyPriv->curve);
 
         if (ssl->flags & SSL_FLAGS_DHE_WITH_RSA)
         {
             messageSize = ssl->recordHeadLen + ssl->hshakeHeadLen +
                           eccPubKeyLen + 4 + ssl->keys->privKey.keysize + 2;
         }
+#    ifdef USE_ED25519
+        else if ((ssl->flags & SSL_FLAGS_DHE_WITH_DSA) &&
+                 ssl->keys->privKey.type == PS_ED25519)
+        {
+            /* Fixed size signature, no ASN.1 wrapping */
+            messageSize = ssl->recordHeadLen + ssl->hshakeHeadLen + 6 +
+                          eccPubKeyLen + ED25519_SIG_SIZE;
+        }
+#    endif
         else if (ssl->flags & SSL_FLAGS_DHE_WITH_DSA)
         {
             messageSize = ssl->recordHeadLen + ssl->hshakeHeadLen + 6 +
@@ -4627,6 +4681,68 @@ static int32 writeServerKeyExchange(ssl_t *ssl, sslBuf_t *out, uint32 pLen,
 #   endif  /* USE_RSA_CIPHER_SUITE */
 
 #   ifdef USE_ECC_CIPHER_SUITE
+#    ifdef USE_ED25519
+    if ((ssl->flags & SSL_FLAGS_DHE_WITH_DSA) &&
+        ssl->keys->privKey.type == PS_ED25519)
+    {
+        /* Ed25519 signs the params themselves rather than a digest, so the
+            pkaAfter input is the full randoms || params buffer. The
+            signature is deterministic so DTLS retransmits simply sign
+            again instead of saving it in ckeMsg. */
+        if (!(ssl->flags & SSL_FLAGS_TLS_1_2))
+        {
+            psTraceInfo("Ed25519 ServerKeyExchange requires TLS 1.2\n");
+            return PS_UNSUPPORTED_FAIL;
+        }
+        hashSize = (2 * SSL_HS_RANDOM_SIZE) + (int32) (c - sigStart);
+        if ((hsMsgHash = psMalloc(ssl->hsPool, hashSize)) == NULL)
+        {
+            return PS_MEM_FAIL;
+        }
+        memcpy(hsMsgHash, ssl->sec.clientRandom, SSL_HS_RANDOM_SIZE);
+        memcpy(hsMsgHash + SSL_HS_RANDOM_SIZE, ssl->sec.serverRandom,
+            SSL_HS_RANDOM_SIZE);
+        memcpy(hsMsgHash + (2 * SSL_HS_RANDOM_SIZE), sigStart,
+            (int32) (c - sigStart));
+        *c++ = HASH_SIG_INTRINSIC;
+        *c++ = HASH_SIG_ED25519;
+        *c++ = (ED25519_SIG_SIZE & 0xFF00) >> 8;
+        *c++ = ED25519_SIG_SIZE & 0xFF;
+#     ifdef USE_DTLS
+        if ((ssl->flags & SSL_FLAGS_DTLS) && (ssl->retransmit == 1))
+        {
+            /* nowDoSkePka is skipped on retransmits */
+            rc = psEd25519Sign(&ssl->keys->privKey.key.ed25519, hsMsgHash,
+                hashSize, c);
+            psFree(hsMsgHash, ssl->hsPool);
+            if (rc < 0)
+            {
+                return rc;
+            }
+            c += ED25519_SIG_SIZE;
+        }
+        else     /* closed below */
+        {
+#     endif /* USE_DTLS */
+        if ((pkaAfter = getPkaAfter(ssl)) == NULL)
+        {
+            psFree(hsMsgHash, ssl->hsPool);
+            psTraceInfo("getPkaAfter error\n");
+            return PS_PLATFORM_FAIL;
+        }
+        pkaAfter->inbuf = hsMsgHash;
+        pkaAfter->outbuf = c;
+        pkaAfter->data = pkiData;
+        pkaAfter->inlen = hashSize;
+        pkaAfter->type = PKA_AFTER_ED25519_SIG_GEN;
+        pkaAfter->user = ED25519_SIG_SIZE;
+        c += ED25519_SIG_SIZE;
+#     ifdef USE_DTLS
+    }
+#     endif /* USE_DTLS */
+    }
+    else
+#    endif /* USE_ED25519 */
     if (ssl->flags & SSL_FLAGS_DHE_WITH_DSA)
     {
 #    ifndef USE_ONLY_PSK_CIPHER_SUITE
@@ -5101,8 +5217,8 @@ static int32 writeCertificateStatus(ssl_t *ssl, sslBuf_t *out)
     c = out->end;
     end = out->buf + out->size;
 
-    ocspLen = ssl->keys->OCSPResponseBufLen;
-    messageSize = ssl->recordHeadLen + ssl->hshakeHeadLen + 4 + ocspLen;
+    ocspLen = 4 + ssl->staple->len;
+    messageSize = ssl->recordHeadLen + ssl->hshakeHeadLen + ocspLen;
 
     if ((rc = writeRecordHeader(ssl, SSL_RECORD_TYPE_HANDSHAKE,
              SSL_HS_CERTIFICATE_STATUS, &messageSize, &padLen, &encryptStart,
@@ -5110,18 +5226,8 @@ static int32 writeCertificateStatus(ssl_t *ssl, sslBuf_t *out)
     {
         return rc;
     }
-    /*  struct {
-          CertificateStatusType status_type;
-          select (status_type) {
-              case ocsp: OCSPResponse;
-          } response;
-       } CertificateStatus; */
-    *c = 0x1; c++;
-    /* ocspLen is 16 bit value. */
-    *c = 0; c++;
-    *c = (ocspLen & 0xFF00) >> 8; c++;
-    *c = (ocspLen & 0xFF); c++;
-    memcpy(c, ssl->keys->OCSPResponseBuf, ocspLen);
+    /* Encoded by matrixSslLoadOCSPResponse */
+    memcpy(c, ssl->staple->msg, ocspLen);
     c += ocspLen;
 
     if ((rc = postponeEncryptRecord(ssl, SSL_RECORD_TYPE_HANDSHAKE,
@@ -5158,11 +5264,6 @@ static int32 writeCertificateStatus(ssl_t *ssl, sslBuf_t *out)
  */
 static int32 writeCertificate(ssl_t *ssl, sslBuf_t *out, int32 notEmpty)
 {
-#  if defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH)
-    psX509Cert_t *cert;
-    uint32 certLen;
-#  endif /* USE_SERVER_SIDE_SSL || USE_CLIENT_AUTH */
-
     unsigned char *c, *end, *encryptStart;
     uint8_t padLen;
     int32 totalCertLen, lsize, i, rc;
@@ -5193,13 +5294,9 @@ static int32 writeCertificate(ssl_t *ssl, sslBuf_t *out, int32 notEmpty)
     if (notEmpty)
     {
 #  if defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH)
-        cert = ssl->keys->cert;
-        for (; cert != NULL; i++)
-        {
-            psAssert(cert->unparsedBin != NULL);
-            totalCertLen += cert->binLen;
-            cert = cert->next;
-        }
+        /* Encoded when the keys were loaded */
+        i = ssl->keys->certCount;
+        totalCertLen = ssl->keys->certMsgLen - (i * 3);
 #  else
         return PS_DISABLED_FEATURE_FAIL;
 #  endif /* USE_SERVER_SIDE_SSL || USE_CLIENT_AUTH */
@@ -5261,23 +5358,10 @@ static int32 writeCertificate(ssl_t *ssl, sslBuf_t *out, int32 notEmpty)
         *c = ((totalCertLen + (lsize - 3)) & 0xFF); c++;
 
 #  if defined(USE_SERVER_SIDE_SSL) || defined(USE_CLIENT_AUTH)
-        if (notEmpty)
+        if (notEmpty && ssl->keys->certMsgLen > 0)
         {
-            cert = ssl->keys->cert;
-            while (cert)
-            {
-                psAssert(cert->unparsedBin != NULL);
-                certLen = cert->binLen;
-                if (certLen > 0)
-                {
-                    *c = (unsigned char) ((certLen & 0xFF0000) >> 16); c++;
-                    *c = (certLen & 0xFF00) >> 8; c++;
-                    *c = (certLen & 0xFF); c++;
-                    memcpy(c, cert->unparsedBin, certLen);
-                    c += certLen;
-                }
-                cert = cert->next;
-            }
+            memcpy(c, ssl->keys->certMsg, ssl->keys->certMsgLen);
+            c += ssl->keys->certMsgLen;
         }
 #  endif /* USE_SERVER_SIDE_SSL || USE_CLIENT_AUTH */
 
@@ -5552,7 +5636,7 @@ int32_t matrixSslEncodeClientHello(ssl_t *ssl, sslBuf_t *out,
     short i, useTicket;
 #  ifdef USE_TLS_1_2
     psSize_t sigHashLen, sigHashFlags;
-    unsigned char sigHash[18];      /* 2b len + 2b * 8 sig hash combos */
+    unsigned char sigHash[20];      /* 2b len + 2b * 9 sig hash combos */
 #  endif
 #  ifdef USE_ECC_CIPHER_SUITE
     unsigned char eccCurveList[32];
@@ -5837,9 +5921,11 @@ int32_t matrixSslEncodeClientHello(ssl_t *ssl, sslBuf_t *out,
 
         enum {
           none(0), md5(1), sha1(2), sha224(3), sha256(4), sha384(5),
-          sha512(6), (255)
+          sha512(6), intrinsic(8), (255)
         } HashAlgorithm;
-        enum { anonymous(0), rsa(1), dsa(2), ecdsa(3), (255) } SigAlgorithm;
+        enum {
+          anonymous(0), rsa(1), dsa(2), ecdsa(3), ed25519(7), (255)
+        } SigAlgorithm;
      */
 
 #   define ADD_SIG_HASH(A, B) \
@@ -5865,6 +5951,9 @@ int32_t matrixSslEncodeClientHello(ssl_t *ssl, sslBuf_t *out,
 #    ifdef USE_SHA1
     ADD_SIG_HASH(HASH_SIG_SHA1, HASH_SIG_ECDSA);
 #    endif
+#    ifdef USE_ED25519
+    ADD_SIG_HASH(HASH_SIG_INTRINSIC, HASH_SIG_ED25519);
+#    endif
 #   endif /* USE_ECC */
 
 #   ifdef USE_RSA
@@ -6440,7 +6529,7 @@ static int32 writeClientKeyExchange(ssl_t *ssl, sslBuf_t *out)
 #   ifdef USE_ECC_CIPHER_SUITE
         if (ssl->flags & SSL_FLAGS_ECC_CIPHER)
         {
-            keyLen = (ssl->sec.eccKeyPriv->curve->size * 2) + 2;
+            keyLen = psEccX963Size(ssl->sec.eccKeyPriv->curve) + 1;
         }
         else
         {
@@ -7089,8 +7178,14 @@ static int nowDoCvPkaInnerECDSA(ssl_t *ssl, pkaAfter_t *pka,
        Length of outbuf is increased by 1.
      */
     len = pka->user + 1;
+#     ifdef USE_ECDSA_PRESIGN
+    rc = psEccDsaSignExt(pkiPool, &ssl->keys->privKey.key.ecc,
+        matrixSslGetEcdsaPresign(ssl->keys),
+        hashTbs, hashTbsLen, tmpEcdsa, &len, 1, pka->data);
+#     else
     rc = psEccDsaSign(pkiPool, &ssl->keys->privKey.key.ecc,
         hashTbs, hashTbsLen, tmpEcdsa, &len, 1, pka->data);
+#     endif
     if (rc != PS_SUCCESS)
     {
         goto out;
@@ -7308,6 +7403,44 @@ out:
 }
 #    endif /* USE_RSA */
 
+#    ifdef USE_HS_TRANSCRIPT
+static int nowDoCvPkaInnerEd25519(ssl_t *ssl, pkaAfter_t *pka)
+{
+    psDynBuf_t *t = &ssl->sec.hsTranscript;
+    int32_t rc;
+
+    /* Everything up to and including the ClientKeyExchange */
+    if (t->buf.buf == NULL || t->err)
+    {
+        psTraceInfo("No handshake transcript for Ed25519 certVerify\n");
+        clearPkaAfter(ssl);
+        return MATRIXSSL_ERROR;
+    }
+    rc = psEd25519Sign(&ssl->keys->privKey.key.ed25519, t->buf.start,
+        (psSizeL_t) (t->buf.end - t->buf.start), pka->outbuf);
+    if (rc < 0)
+    {
+        clearPkaAfter(ssl);
+        return rc;
+    }
+#     ifdef USE_DTLS
+    if (ssl->flags & SSL_FLAGS_DTLS)
+    {
+        ssl->certVerifyMsgLen = ED25519_SIG_SIZE;
+        ssl->certVerifyMsg = psMalloc(ssl->hsPool, ED25519_SIG_SIZE);
+        if (ssl->certVerifyMsg == NULL)
+        {
+            clearPkaAfter(ssl);
+            return SSL_MEM_ERROR;
+        }
+        memcpy(ssl->certVerifyMsg, pka->outbuf, ED25519_SIG_SIZE);
+    }
+#     endif /* USE_DTLS */
+    clearPkaAfter(ssl);
+    return PS_SUCCESS;
+}
+#    endif /* USE_HS_TRANSCRIPT */
+
 /******************************************************************************/
 /*      Postponed CERTIFICATE_VERIFY PKA operation */
 static int32 nowDoCvPka(ssl_t *ssl, psBuf_t *out)
@@ -7349,6 +7482,11 @@ static int32 nowDoCvPka(ssl_t *ssl, psBuf_t *out)
         rc = nowDoCvPkaInnerECDSA(ssl, pka, msgHash, out);
         break;
 #    endif /* USE_ECC */
+#    ifdef USE_HS_TRANSCRIPT
+    case PKA_AFTER_ED25519_SIG_GEN:
+        rc = nowDoCvPkaInnerEd25519(ssl, pka);
+        break;
+#    endif /* USE_HS_TRANSCRIPT */
 #    ifdef USE_RSA
     case PKA_AFTER_RSA_SIG_GEN:
     case PKA_AFTER_RSA_SIG_GEN_ELEMENT:
@@ -7402,6 +7540,20 @@ static int32 writeCertificateVerify(ssl_t *ssl, sslBuf_t *out)
     messageSize = ssl->recordHeadLen + ssl->hshakeHeadLen +
                   2 + ssl->keys->privKey.keysize;
 
+#    ifdef USE_HS_TRANSCRIPT
+    if (ssl->keys->privKey.type == PS_ED25519)
+    {
+        /* The intrinsic hash signature is only defined for TLS 1.2 */
+        if (!(ssl->flags & SSL_FLAGS_TLS_1_2))
+        {
+            psTraceInfo("Ed25519 certVerify requires TLS 1.2\n");
+            return MATRIXSSL_ERROR;
+        }
+        messageSize = ssl->recordHeadLen + ssl->hshakeHeadLen +
+                      2 + ED25519_SIG_SIZE;
+    }
+#    endif /* USE_HS_TRANSCRIPT */
+
 #    ifdef USE_ECC
     /* Additional ASN.1 overhead from psEccSignHash */
     if (ssl->keys->cert->pubKeyAlgorithm == OID_ECDSA_KEY_ALG)
@@ -7470,6 +7622,36 @@ static int32 writeCertificateVerify(ssl_t *ssl, sslBuf_t *out)
     Correct to be looking at the child-most cert here because that is the
     one associated with the private key.
  */
+#    ifdef USE_HS_TRANSCRIPT
+    if (ssl->keys->privKey.type == PS_ED25519)
+    {
+        /* Signed over the buffered handshake messages in nowDoCvPka */
+        *c = HASH_SIG_INTRINSIC; c++;
+        *c = HASH_SIG_ED25519; c++;
+        *c = (ED25519_SIG_SIZE & 0xFF00) >> 8; c++;
+        *c = ED25519_SIG_SIZE & 0xFF; c++;
+#     ifdef USE_DTLS
+        if (ssl->flags & SSL_FLAGS_DTLS && ssl->retransmit)
+        {
+            pkaAfter->type = 0; /* reset so AFTER logic doesn't trigger */
+            memcpy(c, ssl->certVerifyMsg, ssl->certVerifyMsgLen);
+            c += ssl->certVerifyMsgLen;
+        }
+        else
+        {
+#     endif
+        pkaAfter->type = PKA_AFTER_ED25519_SIG_GEN;
+        pkaAfter->data = pkiData;
+        pkaAfter->inlen = 0;
+        pkaAfter->outbuf = c;
+        pkaAfter->user = ED25519_SIG_SIZE;
+        c += ED25519_SIG_SIZE;
+#     ifdef USE_DTLS
+    }
+#     endif
+    }
+    else
+#    endif /* USE_HS_TRANSCRIPT */
 #    ifdef USE_ECC
     if (ssl->keys->cert->pubKeyAlgorithm == OID_ECDSA_KEY_ALG)
     {
@@ -7747,7 +7929,6 @@ static int32 writeCertificateRequest(ssl_t *ssl, sslBuf_t *out, int32 certLen,
     int32 certCount)
 {
     unsigned char *c, *end, *encryptStart;
-    psX509Cert_t *cert;
     uint8_t padLen;
     psSize_t messageSize, sigHashLen = 0;
     int32_t rc;
@@ -7773,6 +7954,9 @@ static int32 writeCertificateRequest(ssl_t *ssl, sslBuf_t *out, int32 certLen,
 #     else
         sigHashLen += 4;
 #     endif /* USE_SHA */
+#     ifdef USE_HS_TRANSCRIPT
+        sigHashLen += 2;
+#     endif
 #    endif  /* USE_ECC */
 #    ifdef USE_RSA
 #     ifdef USE_SHA384
@@ -7865,6 +8049,10 @@ static int32 writeCertificateRequest(ssl_t *ssl, sslBuf_t *out, int32 certLen,
         *c++ = 0x2; /* SHA1 */
         *c++ = 0x3; /* ECDSA */
 #     endif
+#     ifdef USE_HS_TRANSCRIPT
+        *c++ = HASH_SIG_INTRINSIC;
+        *c++ = HASH_SIG_ED25519;
+#     endif
 #    endif
 
 #    ifdef USE_RSA
@@ -7885,23 +8073,17 @@ static int32 writeCertificateRequest(ssl_t *ssl, sslBuf_t *out, int32 certLen,
     }
 #   endif /* TLS_1_2 */
 
-    cert = ssl->keys->CAcerts;
-    if (cert)
+    if (ssl->keys->CAcerts)
     {
-        *c = ((certLen + (certCount * 2)) & 0xFF00) >> 8; c++;
-        *c = (certLen + (certCount * 2)) & 0xFF; c++;
-        while (cert)
+        /* Encoded when the keys were loaded, absent if a DN wasn't kept */
+        if (ssl->keys->caDnMsg == NULL)
         {
-            if (cert->subject.dnenc == NULL)
-            {
-                return PS_FAIL;
-            }
-            *c = (cert->subject.dnencLen & 0xFF00) >> 8; c++;
-            *c = cert->subject.dnencLen & 0xFF; c++;
-            memcpy(c, cert->subject.dnenc, cert->subject.dnencLen);
-            c += cert->subject.dnencLen;
-            cert = cert->next;
+            return PS_FAIL;
         }
+        *c = ((certLen + (certCount * 2)) & 0xFF00) >> 8; c++;
+        *c = (certLen + (certCount * 2)) & 0xFF; c++;
+        memcpy(c, ssl->keys->caDnMsg, ssl->keys->caDnMsgLen);
+        c += ssl->keys->caDnMsgLen;
     }
     else
     {
@@ -7983,6 +8165,10 @@ static int32 writeMultiRecordCertRequest(ssl_t *ssl, sslBuf_t *out,
                 *c++ = 0x2; /* SHA1 */
                 *c++ = 0x3; /* ECDSA */
 #     endif
+#     ifdef USE_HS_TRANSCRIPT
+                *c++ = HASH_SIG_INTRINSIC;
+                *c++ = HASH_SIG_ED25519;
+#     endif
 #    endif
 
 #    ifdef USE_RSA
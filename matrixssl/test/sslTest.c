@@ -37,6 +37,9 @@
 #include "matrixssl/matrixsslApi.h"
 #include "core/psUtil.h"
 #include <stdio.h>
+#ifdef USE_ASYNC_PKA
+# include <poll.h>
+#endif
 
 #ifdef USE_PSK_CIPHER_SUITE
 # include "testkeys/PSK/psk.h"
@@ -145,6 +148,10 @@ typedef struct
     uint32 hsTime;
     uint32 appTime;
 # endif
+    const char *caFile;         /* PASS_TRUST_STORE: CAs for loadTrustStore */
+    const unsigned char *caMem;
+    int32 caMemLen;
+    unsigned char *caImage;     /* Loaded into keys, freed with them */
 } sslConn_t;
 
 enum
@@ -348,6 +355,19 @@ static int32_t throughputTest(sslConn_t *s, sslConn_t *r, uint16_t nrec, psSize_
 static void print_throughput(void);
 # endif
 
+# if defined(USE_OCSP_CACHE) && defined(MATRIX_USE_FILE_SYSTEM) && \
+    defined(USE_RSA) && !defined(USE_ONLY_PSK_CIPHER_SUITE)
+#  define OCSP_TEST
+static int32 ocspTest(void);
+# endif
+
+# if defined(USE_ED25519) && defined(USE_ECC_CIPHER_SUITE) && \
+    defined(USE_CLIENT_AUTH) && defined(USE_TLS_1_2) && \
+    defined(MATRIX_USE_FILE_SYSTEM) && !defined(USE_ONLY_PSK_CIPHER_SUITE)
+#  define ED25519_TEST
+static int32 ed25519Test(void);
+# endif
+
 /*
     Client-authentication.  Callback that is registered to receive client
     certificate information for custom validation
@@ -416,6 +436,48 @@ const static char *g_version_str[] = {
 };
 # endif
 
+/*
+    Every suite and version is run once per pass.  The first pass uses the
+    default session and keys options, later ones switch on the optional
+    caches and parse modes so that both code paths stay covered.
+ */
+# define PASS_CHAIN_CACHE   0x1     /* matrixSslSetCertChainCache on keys */
+# define PASS_DHE_REUSE     0x2     /* matrixSslSetDhEphemeralPolicy */
+# define PASS_LAZY_CERTS    0x4     /* Client lazy_peer_cert_parse */
+# define PASS_KEEP_CERT_DER 0x8     /* Client keep_peer_cert_der */
+# define PASS_TRUST_STORE   0x10    /* CAs from matrixSslLoadTrustStoreMem */
+
+typedef struct
+{
+    const char *name;
+    uint32_t flags;
+} testPass_t;
+
+static const testPass_t g_passes[] = {
+    { "default options", 0 },
+# ifndef ENABLE_PERF_TIMING
+#  ifdef USE_CERT_CHAIN_CACHE
+    { "peer chain cache", PASS_CHAIN_CACHE },
+#  endif
+#  ifdef REQUIRE_DH_PARAMS
+    { "shared DHE keys", PASS_DHE_REUSE },
+#  endif
+#  ifdef USE_CERT_PARSE
+    { "lazy peer cert parse", PASS_LAZY_CERTS },
+    { "retained peer cert DER", PASS_KEEP_CERT_DER },
+    { "lazy parse of retained DER", PASS_LAZY_CERTS | PASS_KEEP_CERT_DER },
+#   ifndef USE_ONLY_PSK_CIPHER_SUITE
+    { "trust store image", PASS_TRUST_STORE },
+#   endif
+#  endif
+# endif /* !ENABLE_PERF_TIMING */
+    { NULL, 0 }     /* NULL must be last to terminate list */
+};
+
+static uint8_t g_pass = 0;
+
+# define TEST_PASS(A) (g_passes[g_pass].flags & (A))
+
 /* Ciphersuites to test */
 
 # define CS(A) { #A, A }
@@ -720,6 +782,10 @@ int sslTest(void)
     memset(svrConn, 0, sizeof(sslConn_t));
     memset(clnConn, 0, sizeof(sslConn_t));
 
+    /* Loop through each pass (note: not indented) */
+    for (g_pass = 0; g_passes[g_pass].name != NULL; g_pass++)
+    {
+    testPrintStr("Pass with %s\n\n", (char *) g_passes[g_pass].name);
 # ifdef USE_RSA
     RSA_SIZE = 0;
 # endif
@@ -1463,6 +1529,20 @@ LBL_FREE:
 # endif
 
     } /* End cipher suite loop */
+    } /* End pass loop (unindented) */
+
+# ifdef OCSP_TEST
+    if (ocspTest() < 0)
+    {
+        rc = PS_FAILURE;
+    }
+# endif
+# ifdef ED25519_TEST
+    if (ed25519Test() < 0)
+    {
+        rc = PS_FAILURE;
+    }
+# endif
 
 # ifdef ENABLE_PERF_TIMING
     printf("Ciphersuite" DELIM "Keysize" DELIM "Authsize" DELIM
@@ -1609,6 +1689,9 @@ static int32 initializeResumedHandshake(sslConn_t *clnConn, sslConn_t *svrConn,
 
     memset(&options, 0x0, sizeof(sslSessOpts_t));
     options.versionFlag = g_versionFlag;
+#  ifdef USE_ASYNC_PKA
+    options.asyncPka = !(g_versionFlag & SSL_FLAGS_DTLS);
+#  endif
 #  ifdef USE_ECC_CIPHER_SUITE
     options.ecFlags = clnConn->ssl->ecInfo.ecFlags;
 #  endif
@@ -1669,6 +1752,9 @@ static int32 initializeClientAuthHandshake(sslConn_t *clnConn,
 
     memset(&options, 0x0, sizeof(sslSessOpts_t));
     options.versionFlag = g_versionFlag;
+#  ifdef USE_ASYNC_PKA
+    options.asyncPka = !(g_versionFlag & SSL_FLAGS_DTLS);
+#  endif
 #  ifdef USE_ECC_CIPHER_SUITE
     options.ecFlags = clnConn->ssl->ecInfo.ecFlags;
 #  endif
@@ -1812,6 +1898,22 @@ static int32 performHandshake(sslConn_t *sendingSide, sslConn_t *receivingSide)
 
 # ifdef USE_EXT_CERTIFICATE_VERIFY_SIGNING
 # endif  /* USE_EXT_CERTIFICATE_VERIFY_SIGNING */
+# ifdef USE_ASYNC_PKA
+    while (rc == MATRIXSSL_PKA_PENDING)
+    {
+        /* Wait for the worker pool the way an event loop would */
+        struct pollfd pfd;
+
+        pfd.fd = matrixSslGetPkaEventFd(receivingSide->ssl);
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, -1) < 0)
+        {
+            return PS_FAILURE;
+        }
+        rc = matrixSslReceivedData(receivingSide->ssl, 0, &plaintextBuf,
+            &ptLen);
+    }
+# endif  /* USE_ASYNC_PKA */
     if (rc == MATRIXSSL_REQUEST_SEND)
     {
 /*
@@ -2202,6 +2304,523 @@ SEND_MORE:
 }
 
 
+# ifndef USE_ONLY_PSK_CIPHER_SUITE
+/*
+    PASS_TRUST_STORE: the key loading calls get no CAs, they are kept in
+    conn for loadTrustStore instead.
+ */
+#  if defined(MATRIX_USE_FILE_SYSTEM) && !defined(USE_HEADER_KEYS)
+static const char *passCAfile(sslConn_t *conn, const char *caFile)
+{
+    if (TEST_PASS(PASS_TRUST_STORE))
+    {
+        conn->caFile = caFile;
+        return NULL;
+    }
+    return caFile;
+}
+#  endif /* MATRIX_USE_FILE_SYSTEM && !USE_HEADER_KEYS */
+
+#  ifdef USE_HEADER_KEYS
+static const unsigned char *passCAmem(sslConn_t *conn,
+    const unsigned char *ca, int32 caLen)
+{
+    if (TEST_PASS(PASS_TRUST_STORE))
+    {
+        conn->caMem = ca;
+        conn->caMemLen = caLen;
+        return NULL;
+    }
+    return ca;
+}
+#  endif /* USE_HEADER_KEYS */
+
+/*
+    Compile the CAs kept by passCAfile or passCAmem into a trust store image
+    and load it into conn->keys.  Check what the deferred parse put in the
+    list against loading the same CAs with matrixSslLoadRsaKeys; the
+    handshake then checks the certificates it parses on first use.
+ */
+static int32 loadTrustStore(sslConn_t *conn)
+{
+    sslKeys_t *ref = NULL;
+    psX509Cert_t *certs = NULL, *ca, *refCa;
+    psSizeL_t imageLen;
+    int32 rc;
+
+    if (conn->caFile == NULL && conn->caMem == NULL)
+    {
+        return PS_SUCCESS;  /* Suite without certificates */
+    }
+#  if defined(MATRIX_USE_FILE_SYSTEM) && !defined(USE_HEADER_KEYS)
+    rc = psX509ParseCertFile(NULL, (char *) conn->caFile, &certs,
+        CERT_STORE_UNPARSED_BUFFER);
+#  else
+    rc = psX509ParseCert(NULL, conn->caMem, conn->caMemLen, &certs,
+        CERT_STORE_UNPARSED_BUFFER);
+#  endif
+    if (rc < 0 ||
+        (rc = psX509NewTrustStore(NULL, certs, &conn->caImage,
+             &imageLen)) < 0 ||
+        (rc = matrixSslLoadTrustStoreMem(conn->keys, conn->caImage,
+             imageLen)) < 0)
+    {
+        testPrintInt("		FAILED: trust store image %d\n", rc);
+        goto out;
+    }
+
+    if (matrixSslNewKeys(&ref, NULL) < PS_SUCCESS)
+    {
+        rc = PS_MEM_FAIL;
+        goto out;
+    }
+#  if defined(MATRIX_USE_FILE_SYSTEM) && !defined(USE_HEADER_KEYS)
+#   ifdef USE_RSA
+    rc = matrixSslLoadRsaKeys(ref, NULL, NULL, NULL, conn->caFile);
+#   else
+    rc = matrixSslLoadEcKeys(ref, NULL, NULL, NULL, conn->caFile);
+#   endif
+#  else
+#   ifdef USE_RSA
+    rc = matrixSslLoadRsaKeysMem(ref, NULL, 0, NULL, 0, conn->caMem,
+        conn->caMemLen);
+#   else
+    rc = matrixSslLoadEcKeysMem(ref, NULL, 0, NULL, 0, conn->caMem,
+        conn->caMemLen);
+#   endif
+#  endif
+    if (rc < 0)
+    {
+        goto out;
+    }
+    rc = PS_FAILURE;
+    for (ca = conn->keys->CAcerts, refCa = ref->CAcerts;
+         ca != NULL && refCa != NULL; ca = ca->next, refCa = refCa->next)
+    {
+        /* Nothing was parsed yet */
+        if (!ca->deferred || ca->parsed != NULL ||
+            memcmp(ca->subject.hash, refCa->subject.hash,
+                SHA1_HASH_SIZE) != 0 ||
+            memcmp(ca->issuer.hash, refCa->issuer.hash, SHA1_HASH_SIZE) != 0 ||
+            ca->pubKeyAlgorithm != refCa->pubKeyAlgorithm ||
+            ca->extensions.sk.len != refCa->extensions.sk.len ||
+            (ca->extensions.sk.len > 0 &&
+             memcmp(ca->extensions.sk.id, refCa->extensions.sk.id,
+                 ca->extensions.sk.len) != 0))
+        {
+            goto out;
+        }
+#  ifdef USE_CLIENT_AUTH
+        if (ca->subject.dnencLen != refCa->subject.dnencLen ||
+            memcmp(ca->subject.dnenc, refCa->subject.dnenc,
+                ca->subject.dnencLen) != 0)
+        {
+            goto out;
+        }
+#  endif
+#  ifdef ENABLE_CA_CERT_HASH
+        if (memcmp(ca->sha1CertHash, refCa->sha1CertHash,
+                SHA1_HASH_SIZE) != 0)
+        {
+            goto out;
+        }
+#  endif
+    }
+    if (ca != NULL || refCa != NULL)
+    {
+        goto out;
+    }
+#  if defined(USE_SERVER_SIDE_SSL) && defined(USE_CLIENT_AUTH)
+    if (conn->keys->caDnMsgLen != ref->caDnMsgLen ||
+        memcmp(conn->keys->caDnMsg, ref->caDnMsg, ref->caDnMsgLen) != 0)
+    {
+        goto out;
+    }
+#  endif
+#  ifdef USE_CERT_VALIDATE
+    if ((conn->keys->caIndex == NULL) != (ref->caIndex == NULL))
+    {
+        goto out;
+    }
+#  endif
+    rc = PS_SUCCESS;
+
+out:
+    if (rc == PS_FAILURE)
+    {
+        testPrint("		FAILED: trust store image against CA file\n");
+    }
+    conn->caFile = NULL;
+    conn->caMem = NULL;
+    psX509FreeCert(certs);
+    matrixSslDeleteKeys(ref);
+    return rc;
+}
+# endif /* !USE_ONLY_PSK_CIPHER_SUITE */
+
+# ifdef OCSP_TEST
+/*
+    OCSP stapling of the RSA-2048 server certificate, which the responses in
+    testkeys are about, into a client with an OCSP cache.  Which response
+    the client got shows in whether the handshake passes, good or revoked,
+    and in the cache statistics.
+ */
+static char ocspCertFile[] = "../../testkeys/RSA/2048_RSA.pem";
+static char ocspKeyFile[] = "../../testkeys/RSA/2048_RSA_KEY.pem";
+static char ocspCAfile[] = "../../testkeys/RSA/2048_RSA_CA.pem";
+static char ocspGoodFile[] = "../../testkeys/RSA/2048_RSA_OCSP_GOOD.der";
+static char ocspRevokedFile[] = "../../testkeys/RSA/2048_RSA_OCSP_REVOKED.der";
+static char ocspExpiredFile[] = "../../testkeys/RSA/2048_RSA_OCSP_EXPIRED.der";
+
+static sslKeys_t *g_ocspSniKeys;
+
+static void ocspSniCb(void *ssl, char *hostname, int32 hostnameLen,
+    sslKeys_t **newKeys)
+{
+    *newKeys = g_ocspSniKeys;
+}
+
+/*
+    One handshake of a client asking for a stapled response.  With sniKeys,
+    the server session starts on svrKeys and its SNI callback moves it to
+    sniKeys.  The server session is left in svr for the caller to check.
+ */
+static int32 ocspHandshake(sslConn_t *svr, sslKeys_t *svrKeys,
+    sslKeys_t *clnKeys, sslKeys_t *sniKeys)
+{
+    sslConn_t cln;
+    sslSessOpts_t options;
+    tlsExtension_t *ext = NULL;
+    unsigned char *sni;
+    int32 sniLen, rc;
+
+    memset(svr, 0x0, sizeof(sslConn_t));
+    memset(&cln, 0x0, sizeof(sslConn_t));
+    memset(&options, 0x0, sizeof(sslSessOpts_t));
+    if (matrixSslNewServerSession(&svr->ssl, svrKeys, NULL, &options) < 0)
+    {
+        return PS_FAILURE;
+    }
+    if (sniKeys != NULL)
+    {
+        g_ocspSniKeys = sniKeys;
+        matrixSslRegisterSNICallback(svr->ssl, ocspSniCb);
+        if (matrixSslNewHelloExtension(&ext, NULL) < 0)
+        {
+            return PS_FAILURE;
+        }
+        if (matrixSslCreateSNIext(NULL, (unsigned char *) "localhost", 9,
+                &sni, &sniLen) < 0)
+        {
+            matrixSslDeleteHelloExtension(ext);
+            return PS_FAILURE;
+        }
+        matrixSslLoadHelloExtension(ext, sni, sniLen, EXT_SNI);
+        psFree(sni, NULL);
+    }
+    /* The server session marked options as its own */
+    memset(&options, 0x0, sizeof(sslSessOpts_t));
+    options.OCSPstapling = 1;
+    rc = matrixSslNewClientSession(&cln.ssl, clnKeys, NULL, NULL, 0,
+        clnCertChecker, "localhost", ext, NULL, &options);
+    matrixSslDeleteHelloExtension(ext);
+    if (rc >= 0)
+    {
+        rc = performHandshake(&cln, svr);
+    }
+    if (cln.ssl != NULL)
+    {
+        matrixSslDeleteSession(cln.ssl);
+    }
+    return rc;
+}
+
+static int32 ocspCacheStats(sslKeys_t *keys, uint32_t hits, uint32_t misses)
+{
+    uint32_t h, m;
+
+    matrixSslGetOCSPCacheStats(keys, &h, &m);
+    return h == hits && m == misses;
+}
+
+static int32 ocspTest(void)
+{
+    sslKeys_t *svrKeys = NULL, *sniKeys = NULL, *clnKeys = NULL;
+    sslOcspStaple_t *staple;
+    sslConn_t svr;
+    const char *failed;
+    uint16_t i;
+
+    testPrint("OCSP stapling and cache test\n");
+    memset(&svr, 0x0, sizeof(sslConn_t));
+    failed = "loading keys";
+    if (matrixSslNewKeys(&svrKeys, NULL) < 0 ||
+        matrixSslNewKeys(&sniKeys, NULL) < 0 ||
+        matrixSslNewKeys(&clnKeys, NULL) < 0 ||
+        matrixSslLoadRsaKeys(svrKeys, ocspCertFile, ocspKeyFile, NULL,
+            NULL) < 0 ||
+        matrixSslLoadRsaKeys(sniKeys, ocspCertFile, ocspKeyFile, NULL,
+            NULL) < 0 ||
+        matrixSslLoadRsaKeys(clnKeys, NULL, NULL, NULL, ocspCAfile) < 0 ||
+        matrixSslSetOCSPCache(clnKeys, 4) < 0 ||
+        matrixSslRefreshOCSPResponseFile(svrKeys, ocspGoodFile) < 0)
+    {
+        goto out;
+    }
+
+    failed = "cache miss";
+    if (ocspHandshake(&svr, svrKeys, clnKeys, NULL) < 0 ||
+        !ocspCacheStats(clnKeys, 0, 1) ||
+        svr.ssl->staple != svrKeys->staple)
+    {
+        goto out;
+    }
+    /* A refresh leaves the response pinned by the session alone */
+    failed = "refresh with a pinned response";
+    staple = svr.ssl->staple;
+    if (matrixSslRefreshOCSPResponseFile(svrKeys, ocspRevokedFile) < 0 ||
+        svrKeys->staple == staple || staple->refs != 1)
+    {
+        goto out;
+    }
+    matrixSslDeleteSession(svr.ssl);
+    svr.ssl = NULL;
+
+    /* A new staple with the same response */
+    failed = "cache hit";
+    if (matrixSslRefreshOCSPResponseFile(svrKeys, ocspGoodFile) < 0 ||
+        ocspHandshake(&svr, svrKeys, clnKeys, NULL) < 0 ||
+        !ocspCacheStats(clnKeys, 1, 1))
+    {
+        goto out;
+    }
+    matrixSslDeleteSession(svr.ssl);
+    svr.ssl = NULL;
+
+    /* Past nextUpdate the response is validated again */
+    failed = "nextUpdate expiry";
+    for (i = 0; i < clnKeys->ocspCache->size; i++)
+    {
+        clnKeys->ocspCache->entry[i].nextUpdate.tm_year = 100;
+    }
+    if (ocspHandshake(&svr, svrKeys, clnKeys, NULL) < 0 ||
+        !ocspCacheStats(clnKeys, 1, 2))
+    {
+        goto out;
+    }
+    matrixSslDeleteSession(svr.ssl);
+    if (ocspHandshake(&svr, svrKeys, clnKeys, NULL) < 0 ||
+        !ocspCacheStats(clnKeys, 2, 2))
+    {
+        goto out;
+    }
+    matrixSslDeleteSession(svr.ssl);
+    svr.ssl = NULL;
+
+    /* So is every response once the CAs are indexed again, which any
+        further key material loaded into the keys does */
+    failed = "caGeneration invalidation";
+    if (matrixSslLoadRsaKeys(clnKeys, ocspCertFile, ocspKeyFile, NULL,
+            NULL) < 0 ||
+        ocspHandshake(&svr, svrKeys, clnKeys, NULL) < 0 ||
+        !ocspCacheStats(clnKeys, 2, 3))
+    {
+        goto out;
+    }
+    matrixSslDeleteSession(svr.ssl);
+    svr.ssl = NULL;
+
+    /* Revoked is remembered, and fails the handshake from the cache too */
+    failed = "revoked response";
+    if (matrixSslRefreshOCSPResponseFile(svrKeys, ocspRevokedFile) < 0 ||
+        ocspHandshake(&svr, svrKeys, clnKeys, NULL) >= 0 ||
+        !ocspCacheStats(clnKeys, 2, 4))
+    {
+        goto out;
+    }
+    matrixSslDeleteSession(svr.ssl);
+    if (ocspHandshake(&svr, svrKeys, clnKeys, NULL) >= 0 ||
+        !ocspCacheStats(clnKeys, 3, 4))
+    {
+        goto out;
+    }
+    matrixSslDeleteSession(svr.ssl);
+    svr.ssl = NULL;
+
+    /* A refresh keeps the current response unless the new one is usable */
+    failed = "refresh with an expired or unparsable file";
+    staple = svrKeys->staple;
+    if (matrixSslRefreshOCSPResponseFile(svrKeys, ocspExpiredFile) >= 0 ||
+        matrixSslRefreshOCSPResponseFile(svrKeys, ocspCertFile) >= 0 ||
+        svrKeys->staple != staple)
+    {
+        goto out;
+    }
+
+    /* The SNI callback swaps the revoked response of svrKeys for the good
+        one of sniKeys during the handshake.  The session sends and pins
+        the one of the keys it ends up with. */
+    failed = "SNI swap of keys";
+    if (matrixSslRefreshOCSPResponseFile(sniKeys, ocspGoodFile) < 0 ||
+        ocspHandshake(&svr, svrKeys, clnKeys, sniKeys) < 0 ||
+        svr.ssl->keys != sniKeys || svr.ssl->staple != sniKeys->staple ||
+        !ocspCacheStats(clnKeys, 3, 5))
+    {
+        goto out;
+    }
+    failed = NULL;
+
+out:
+    if (failed != NULL)
+    {
+        testPrintStr("	FAILED: OCSP %s\n", (char *) failed);
+    }
+    else
+    {
+        testTrace("	PASSED: OCSP stapling and cache\n");
+    }
+    if (svr.ssl != NULL)
+    {
+        matrixSslDeleteSession(svr.ssl);
+    }
+    matrixSslDeleteKeys(svrKeys);
+    matrixSslDeleteKeys(sniKeys);
+    matrixSslDeleteKeys(clnKeys);
+    return failed == NULL ? PS_SUCCESS : PS_FAILURE;
+}
+# endif /* OCSP_TEST */
+
+# ifdef ED25519_TEST
+/*
+    Mutual authentication with Ed25519 certificates on both sides, which
+    signs the ServerKeyExchange and the CertificateVerify with Ed25519.
+    The handshake only passes if each side verified the other's signature.
+ */
+static char ed25519CertFile[] = "../../testkeys/ED25519/ED25519.pem";
+static char ed25519KeyFile[] = "../../testkeys/ED25519/ED25519_KEY.pem";
+static char ed25519CAfile[] = "../../testkeys/ED25519/ED25519_CA.pem";
+
+static int32 g_ed25519SvrPeer, g_ed25519ClnPeer;
+
+static int32 ed25519SvrCertCb(ssl_t *ssl, psX509Cert_t *cert, int32 alert)
+{
+    g_ed25519SvrPeer = cert->pubKeyAlgorithm;
+    return alert;
+}
+
+static int32 ed25519ClnCertCb(ssl_t *ssl, psX509Cert_t *cert, int32 alert)
+{
+    g_ed25519ClnPeer = cert->pubKeyAlgorithm;
+    return alert;
+}
+
+/*
+    One TLS 1.2 handshake offering every cipher suite.  The server session
+    is left in svr for the caller to check.
+ */
+static int32 ed25519Handshake(sslConn_t *svr, sslKeys_t *svrKeys,
+    sslKeys_t *clnKeys, sslSessionId_t *sid)
+{
+    sslConn_t cln;
+    sslSessOpts_t options;
+    int32 rc;
+
+    memset(svr, 0x0, sizeof(sslConn_t));
+    memset(&cln, 0x0, sizeof(sslConn_t));
+    memset(&options, 0x0, sizeof(sslSessOpts_t));
+    g_ed25519SvrPeer = g_ed25519ClnPeer = 0;
+    options.versionFlag = SSL_FLAGS_TLS_1_2;
+    if (matrixSslNewServerSession(&svr->ssl, svrKeys, ed25519SvrCertCb,
+            &options) < 0)
+    {
+        return PS_FAILURE;
+    }
+    /* The server session marked options as its own */
+    memset(&options, 0x0, sizeof(sslSessOpts_t));
+    options.versionFlag = SSL_FLAGS_TLS_1_2;
+    rc = matrixSslNewClientSession(&cln.ssl, clnKeys, sid, NULL, 0,
+        ed25519ClnCertCb, "localhost", NULL, NULL, &options);
+    if (rc >= 0)
+    {
+        rc = performHandshake(&cln, svr);
+    }
+    if (cln.ssl != NULL)
+    {
+        matrixSslDeleteSession(cln.ssl);
+    }
+    return rc;
+}
+
+static int32 ed25519Test(void)
+{
+    sslKeys_t *svrKeys = NULL, *clnKeys = NULL;
+    sslSessionId_t *sid = NULL;
+    matrixSslLoadKeysOpts_t opts;
+    sslConn_t svr;
+    const char *failed;
+
+    testPrint("Ed25519 authentication test\n");
+    memset(&svr, 0x0, sizeof(sslConn_t));
+    memset(&opts, 0x0, sizeof(matrixSslLoadKeysOpts_t));
+    opts.key_type = 3; /* Ed25519 */
+    failed = "loading keys";
+    /* The server finds out the key type on its own */
+    if (matrixSslNewKeys(&svrKeys, NULL) < 0 ||
+        matrixSslNewKeys(&clnKeys, NULL) < 0 ||
+        matrixSslLoadKeys(svrKeys, ed25519CertFile, ed25519KeyFile, NULL,
+            ed25519CAfile, NULL) < 0 ||
+        matrixSslLoadKeys(clnKeys, ed25519CertFile, ed25519KeyFile, NULL,
+            ed25519CAfile, &opts) < 0 ||
+        matrixSslNewSessionId(&sid, NULL) < 0)
+    {
+        goto out;
+    }
+
+    failed = "mutual authentication";
+    if (ed25519Handshake(&svr, svrKeys, clnKeys, sid) < 0 ||
+        svr.ssl->cipher->type != CS_ECDHE_ECDSA ||
+        g_ed25519SvrPeer != OID_ED25519_KEY_ALG ||
+        g_ed25519ClnPeer != OID_ED25519_KEY_ALG)
+    {
+        goto out;
+    }
+    matrixSslDeleteSession(svr.ssl);
+    svr.ssl = NULL;
+
+    /* A resumed handshake has no CertificateVerify, so the server drops
+        the transcript it kept for one */
+    failed = "resumption";
+    if (ed25519Handshake(&svr, svrKeys, clnKeys, sid) < 0 ||
+        !(svr.ssl->flags & SSL_FLAGS_RESUMED) ||
+        svr.ssl->sec.hsTranscript.buf.buf != NULL)
+    {
+        goto out;
+    }
+    failed = NULL;
+
+out:
+    if (failed != NULL)
+    {
+        testPrintStr("	FAILED: Ed25519 %s\n", (char *) failed);
+    }
+    else
+    {
+        testTrace("	PASSED: Ed25519 authentication\n");
+    }
+    if (svr.ssl != NULL)
+    {
+        matrixSslDeleteSession(svr.ssl);
+    }
+    if (sid != NULL)
+    {
+        matrixSslDeleteSessionId(sid);
+    }
+    matrixSslDeleteKeys(svrKeys);
+    matrixSslDeleteKeys(clnKeys);
+    return failed == NULL ? PS_SUCCESS : PS_FAILURE;
+}
+# endif /* ED25519_TEST */
+
 static int32 initializeServer(sslConn_t *conn, psCipher16_t cipherSuite)
 {
     sslKeys_t *keys = NULL;
@@ -2215,6 +2834,9 @@ static int32 initializeServer(sslConn_t *conn, psCipher16_t cipherSuite)
 
     memset(&options, 0x0, sizeof(sslSessOpts_t));
     options.versionFlag = g_versionFlag;
+# ifdef USE_ASYNC_PKA
+    options.asyncPka = !(g_versionFlag & SSL_FLAGS_DTLS);
+# endif
 
     if (conn->keys == NULL)
     {
@@ -2235,7 +2857,7 @@ static int32 initializeServer(sslConn_t *conn, psCipher16_t cipherSuite)
         {
 #   if defined(MATRIX_USE_FILE_SYSTEM) && !defined(USE_HEADER_KEYS)
             if (matrixSslLoadEcKeys(keys, svrEcCertFile, svrEcKeyFile, NULL,
-                    clnEcCAfile) < 0)
+                    passCAfile(conn, clnEcCAfile)) < 0)
             {
                 return PS_FAILURE;
             }
@@ -2244,7 +2866,7 @@ static int32 initializeServer(sslConn_t *conn, psCipher16_t cipherSuite)
 #   ifdef USE_HEADER_KEYS
             if (matrixSslLoadEcKeysMem(keys, ECC, ECC_SIZE,
                     ECCKEY, ECCKEY_SIZE,
-                    ECCCA, ECCCA_SIZE) < 0)
+                    passCAmem(conn, ECCCA, ECCCA_SIZE), ECCCA_SIZE) < 0)
             {
                 return PS_FAILURE;
             }
@@ -2256,7 +2878,7 @@ static int32 initializeServer(sslConn_t *conn, psCipher16_t cipherSuite)
         {
 #   if defined(MATRIX_USE_FILE_SYSTEM) && !defined(USE_HEADER_KEYS)
             if (matrixSslLoadEcKeys(keys, svrEcRsaCertFile, svrEcRsaKeyFile,
-                    NULL, clnEcRsaCAfile) < 0)
+                    NULL, passCAfile(conn, clnEcRsaCAfile)) < 0)
             {
                 return PS_FAILURE;
             }
@@ -2265,7 +2887,8 @@ static int32 initializeServer(sslConn_t *conn, psCipher16_t cipherSuite)
 #   ifdef USE_HEADER_KEYS
             if (matrixSslLoadEcKeysMem(keys, ECDHRSA256, sizeof(ECDHRSA256),
                     ECDHRSA256KEY, sizeof(ECDHRSA256KEY),
-                    ECDHRSA2048CA, sizeof(ECDHRSA2048CA)) < 0)
+                    passCAmem(conn, ECDHRSA2048CA, sizeof(ECDHRSA2048CA)),
+                    sizeof(ECDHRSA2048CA)) < 0)
             {
                 return PS_FAILURE;
             }
@@ -2282,7 +2905,7 @@ static int32 initializeServer(sslConn_t *conn, psCipher16_t cipherSuite)
         {
 #   if defined(MATRIX_USE_FILE_SYSTEM) && !defined(USE_HEADER_KEYS)
             if (matrixSslLoadRsaKeys(keys, svrCertFile, svrKeyFile, NULL,
-                    clnCAfile) < 0)
+                    passCAfile(conn, clnCAfile)) < 0)
             {
                 return PS_FAILURE;
             }
@@ -2291,7 +2914,7 @@ static int32 initializeServer(sslConn_t *conn, psCipher16_t cipherSuite)
 #   ifdef USE_HEADER_KEYS
             if (matrixSslLoadRsaKeysMem(keys, (unsigned char *) RSACERT, RSA_SIZE,
                     (unsigned char *) RSAKEY, RSAKEY_SIZE,
-                    (unsigned char *) RSACA, RSACA_SIZE) < 0)
+                    passCAmem(conn, RSACA, RSACA_SIZE), RSACA_SIZE) < 0)
             {
                 return PS_FAILURE;
             }
@@ -2299,6 +2922,19 @@ static int32 initializeServer(sslConn_t *conn, psCipher16_t cipherSuite)
         }
 #  endif  /* !USE_ONLY_PSK_CIPHER_SUITE */
 # endif   /* USE_RSA */
+# ifndef USE_ONLY_PSK_CIPHER_SUITE
+        if (TEST_PASS(PASS_TRUST_STORE) && loadTrustStore(conn) < 0)
+        {
+            return PS_FAILURE;
+        }
+# endif
+# if defined(USE_CERT_CHAIN_CACHE) && defined(USE_CLIENT_AUTH)
+        /* Client auth re-handshakes see the same client chain again */
+        if (TEST_PASS(PASS_CHAIN_CACHE))
+        {
+            matrixSslSetCertChainCache(keys, 8, 60);
+        }
+# endif
 
 # ifdef REQUIRE_DH_PARAMS
         if (spec->type == CS_DHE_RSA || spec->type == CS_DH_ANON ||
@@ -2310,6 +2946,15 @@ static int32 initializeServer(sslConn_t *conn, psCipher16_t cipherSuite)
 #  ifdef USE_HEADER_KEYS
             matrixSslLoadDhParamsMem(keys, DHPARAM, DH_SIZE);
 #  endif
+            /* Share each ephemeral key between a few of the handshakes */
+            if (TEST_PASS(PASS_DHE_REUSE))
+            {
+#  ifdef USE_MULTITHREADING
+                matrixSslSetDhEphemeralPolicy(keys, 3, 60, 2);
+#  else
+                matrixSslSetDhEphemeralPolicy(keys, 3, 60, 0);
+#  endif
+            }
         }
 # endif /* REQUIRE_DH_PARAMS */
 
@@ -2365,9 +3010,20 @@ static int32 initializeClient(sslConn_t *conn, psCipher16_t cipherSuite,
 
     memset(&options, 0x0, sizeof(sslSessOpts_t));
     options.versionFlag = g_versionFlag;
+# ifdef USE_ASYNC_PKA
+    options.asyncPka = !(g_versionFlag & SSL_FLAGS_DTLS);
+# endif
 # ifdef TEST_RESUMPTIONS_WITH_SESSION_TICKETS
     options.ticketResumption = 1;
 # endif
+    if (TEST_PASS(PASS_LAZY_CERTS))
+    {
+        options.lazy_peer_cert_parse = 1;
+    }
+    if (TEST_PASS(PASS_KEEP_CERT_DER))
+    {
+        options.keep_peer_cert_der = 1;
+    }
 
     if (conn->keys == NULL)
     {
@@ -2411,7 +3067,7 @@ static int32 initializeClient(sslConn_t *conn, psCipher16_t cipherSuite,
         {
 #   if defined(MATRIX_USE_FILE_SYSTEM) && !defined(USE_HEADER_KEYS)
             if (matrixSslLoadEcKeys(keys, clnEcCertFile, clnEcKeyFile, NULL,
-                    svrEcCAfile) < 0)
+                    passCAfile(conn, svrEcCAfile)) < 0)
             {
                 return PS_FAILURE;
             }
@@ -2420,7 +3076,7 @@ static int32 initializeClient(sslConn_t *conn, psCipher16_t cipherSuite,
 #   ifdef USE_HEADER_KEYS
             if (matrixSslLoadEcKeysMem(keys, ECC, ECC_SIZE,
                     ECCKEY, ECCKEY_SIZE,
-                    ECCCA, ECCCA_SIZE) < 0)
+                    passCAmem(conn, ECCCA, ECCCA_SIZE), ECCCA_SIZE) < 0)
             {
                 return PS_FAILURE;
             }
@@ -2433,7 +3089,7 @@ static int32 initializeClient(sslConn_t *conn, psCipher16_t cipherSuite,
         {
 #    if defined(MATRIX_USE_FILE_SYSTEM) && !defined(USE_HEADER_KEYS)
             if (matrixSslLoadEcKeys(keys, clnEcRsaCertFile, clnEcRsaKeyFile,
-                    NULL, svrEcRsaCAfile) < 0)
+                    NULL, passCAfile(conn, svrEcRsaCAfile)) < 0)
             {
                 return PS_FAILURE;
             }
@@ -2442,7 +3098,8 @@ static int32 initializeClient(sslConn_t *conn, psCipher16_t cipherSuite,
 #    ifdef USE_HEADER_KEYS
             if (matrixSslLoadEcKeysMem(keys, ECDHRSA521, sizeof(ECDHRSA521),
                     ECDHRSA521KEY, sizeof(ECDHRSA521KEY),
-                    ECDHRSA1024CA, sizeof(ECDHRSA1024CA)) < 0)
+                    passCAmem(conn, ECDHRSA1024CA, sizeof(ECDHRSA1024CA)),
+                    sizeof(ECDHRSA1024CA)) < 0)
             {
                 return PS_FAILURE;
             }
@@ -2459,7 +3116,7 @@ static int32 initializeClient(sslConn_t *conn, psCipher16_t cipherSuite,
         {
 #   if defined(MATRIX_USE_FILE_SYSTEM) && !defined(USE_HEADER_KEYS)
             if (matrixSslLoadRsaKeys(keys, clnCertFile, clnKeyFile, NULL,
-                    svrCAfile) < 0)
+                    passCAfile(conn, svrCAfile)) < 0)
             {
                 return PS_FAILURE;
             }
@@ -2467,7 +3124,7 @@ static int32 initializeClient(sslConn_t *conn, psCipher16_t cipherSuite,
 
 #   ifdef USE_HEADER_KEYS
             if (matrixSslLoadRsaKeysMem(keys, RSACERT, RSA_SIZE,
-                    RSAKEY, RSAKEY_SIZE, (unsigned char *) RSACA,
+                    RSAKEY, RSAKEY_SIZE, passCAmem(conn, RSACA, RSACA_SIZE),
                     RSACA_SIZE) < 0)
             {
                 return PS_FAILURE;
@@ -2476,6 +3133,19 @@ static int32 initializeClient(sslConn_t *conn, psCipher16_t cipherSuite,
         }
 #  endif  /* USE_ONLY_PSK_CIPHER_SUITE  */
 # endif   /* USE_RSA */
+# ifndef USE_ONLY_PSK_CIPHER_SUITE
+        if (TEST_PASS(PASS_TRUST_STORE) && loadTrustStore(conn) < 0)
+        {
+            return PS_FAILURE;
+        }
+# endif
+# ifdef USE_CERT_CHAIN_CACHE
+        /* Re-handshakes see the same server chain again */
+        if (TEST_PASS(PASS_CHAIN_CACHE))
+        {
+            matrixSslSetCertChainCache(keys, 8, 60);
+        }
+# endif
 
 # ifdef USE_PSK_CIPHER_SUITE
         if (spec->type == CS_PSK || spec->type == CS_DHE_PSK)
@@ -2525,6 +3195,9 @@ static void freeSessionAndConnection(sslConn_t *conn)
     matrixSslDeleteKeys(conn->keys);
     conn->ssl = NULL;
     conn->keys = NULL;
+    /* Only now that no keys point into it */
+    psFree(conn->caImage, NULL);
+    conn->caImage = NULL;
 }
 
 /* Ignoring the CERTIFICATE_EXPIRED alert in the test because it will
@@ -0,0 +1,94 @@
+/**
+ *      @file    2048_RSA_KEY_PBES2.h
+ *      @version $Format:%h%d$
+ *
+ *      Auto generated from DER file.
+ */
+/*
+    2048_RSA_KEY as an encrypted PKCS#8 key: PBES2 with PBKDF2 using
+    hmacWithSHA256, and des-ede3-cbc.  The password is "password".
+ */
+#define RSA2048KEY_PBES2_SIZE 1312
+const static unsigned char RSA2048KEY_PBES2[RSA2048KEY_PBES2_SIZE] =
+    "\x30\x82\x05\x1c\x30\x4e\x06\x09\x2a\x86\x48\x86\xf7\x0d\x01\x05"
+    "\x0d\x30\x41\x30\x29\x06\x09\x2a\x86\x48\x86\xf7\x0d\x01\x05\x0c"
+    "\x30\x1c\x04\x08\x49\xbf\x23\x25\x1f\xfd\xef\xfb\x02\x02\x08\x00"
+    "\x30\x0c\x06\x08\x2a\x86\x48\x86\xf7\x0d\x02\x09\x05\x00\x30\x14"
+    "\x06\x08\x2a\x86\x48\x86\xf7\x0d\x03\x07\x04\x08\x1b\x4c\xac\xa3"
+    "\xc7\x1d\x57\x18\x04\x82\x04\xc8\xbd\xf2\x2f\x95\x13\x0e\xd9\x5c"
+    "\x1d\xec\x3e\xb9\x3a\x88\x89\xf4\xb2\x6e\x55\xc5\xb2\xf0\x7c\x74"
+    "\x22\xd7\x4d\xf9\xe5\xd9\x15\xf6\x17\xb3\xe4\xcc\xa6\x53\xc8\x3f"
+    "\xfc\xbf\x95\xc4\x44\xbe\x24\x28\x90\x7f\x02\x48\xdb\x14\x66\x35"
+    "\x7a\x43\x78\x17\xcf\x29\x4d\xe0\x9b\xda\xd5\xc0\xa0\x5b\x1d\xec"
+    "\x54\x60\x23\x48\xd1\xd2\x32\x3e\xfd\x36\x68\x17\x0a\x3f\x5b\x8c"
+    "\x7c\x77\x0c\x0d\x7b\xf9\xf9\x18\xf7\xa9\x64\x54\xeb\x44\x0c\x81"
+    "\xb1\x64\x99\x59\x7c\x48\xf1\x56\x65\x99\x6b\xe0\x26\x3a\x48\x9d"
+    "\xef\xf4\x76\xba\x8d\x07\x72\x2e\xf8\x87\x76\x69\x58\xf3\xdc\x15"
+    "\x88\x3e\xad\x33\x5a\x27\x91\xf6\x6c\x79\x69\x4a\x17\x1d\xbf\x34"
+    "\x7a\xa8\xa4\x9a\x80\xfc\x2d\xc0\x5e\xba\xdb\xf0\x93\xfa\xa3\x29"
+    "\xb8\x31\x15\x2d\xc8\x5b\x69\x2a\x60\x62\xba\x1f\x1f\x24\x42\x6f"
+    "\x9d\x3c\x46\xf2\xcf\x12\x42\x1d\x47\x65\x86\x04\x23\xaa\xa1\x73"
+    "\xdd\x3a\xb1\x87\x4d\xc2\x75\xe6\x12\xb4\x2b\x51\x2b\x94\x40\x70"
+    "\xe6\xa1\xa9\xc5\xce\xb8\x0c\xfb\x53\xf4\xda\x78\x84\xed\x08\xdf"
+    "\xb5\xd7\x50\xb1\xb4\x7e\xb0\x72\xff\xf6\xe6\x7f\xf6\x99\x3d\xf4"
+    "\xba\x6b\x86\xaf\x82\xf9\x82\xe2\xc3\x72\xc8\x6f\x58\x8c\xb2\x21"
+    "\x57\xfb\x71\x75\xa3\xd0\x88\x81\x46\xf7\xae\x43\xb8\x5a\xfd\x51"
+    "\x6e\xc7\x43\xe2\x19\x0b\x43\x27\xc7\xcc\x03\x49\x04\x96\x8a\x76"
+    "\xf3\x2f\x38\x1b\xd4\x45\x69\x1b\xdc\xf7\x7b\x75\xe2\x75\xad\x7f"
+    "\x4a\x6b\xea\x24\xe9\xdf\xa6\xd0\xbf\xad\xa0\xb3\x0f\x9e\xdb\x62"
+    "\xbd\x0a\x71\x44\x19\x66\xec\x33\x70\x7e\xf6\x95\x35\xed\x4a\x95"
+    "\xeb\xfa\x3d\xdc\xfd\x4a\xfb\x61\xc0\xa7\x96\x22\xe0\x01\xe7\x65"
+    "\x86\x3d\x1c\x85\x14\x77\xd9\x5b\x6b\x26\x69\x7f\x95\xe8\x5b\xca"
+    "\x94\xc1\x21\xb6\x2b\x05\x2b\x68\xde\xe4\x8e\x93\xd6\x42\x0a\xdc"
+    "\x19\x75\x88\x4a\xc1\x82\x3f\xd1\x71\x60\x0a\x20\x0f\xbc\xcc\x3c"
+    "\xdf\x4b\x8a\xb3\xa2\xc3\x9b\xe7\x37\xc6\xf7\x6d\x3d\x48\x38\xe5"
+    "\x73\x04\x11\xe4\xb5\xd8\xea\xe0\xb4\xb6\x42\xa4\x79\x7a\x0c\x23"
+    "\xfa\xbe\x4e\x1c\xcd\x83\x26\x09\x45\x5b\xdd\x99\x53\xa9\xba\x8a"
+    "\x2e\xf5\x93\x63\x98\x0c\x5d\x16\x6a\xbe\x70\x61\x64\xb5\x98\x6c"
+    "\x3b\x7a\x5d\x0a\xc5\x25\x0f\xa3\xe0\x6b\xde\x24\x30\x8b\xcd\x5a"
+    "\x93\x13\x9d\x3d\x6c\xdb\xa8\xe5\x04\x19\xc8\x36\x25\x65\xc5\xf6"
+    "\xc6\x5a\xc9\xa6\x4b\xf9\xa7\x95\xd2\x72\x2f\x49\x2c\xf3\x0b\x35"
+    "\x07\xca\x6e\x00\x95\x77\xc8\xf6\x70\x3a\xc5\x09\x46\x7c\x0a\xdd"
+    "\xf3\x04\xa3\x9f\x48\xff\x02\x71\x4b\x02\x09\x6e\xdc\xd6\x6e\xc4"
+    "\xc2\x30\x78\x77\x56\xc8\x34\x53\xb5\x13\x2c\xb8\xb0\x38\x3b\xbe"
+    "\xe9\x4c\xf3\x88\xc1\x64\x68\x5e\xd8\x01\xc5\x38\x75\x03\xa9\x87"
+    "\xac\x5a\x9c\x98\xe5\x7f\x52\xa4\x47\x5a\x5f\x7b\xde\x41\xcb\x62"
+    "\x0c\xe8\x4d\x70\xe2\xa8\x9e\x65\xa5\x75\xe8\x34\x81\x24\x29\x7f"
+    "\xd3\xae\x77\x80\x61\x41\xec\x9b\x57\x03\x7b\xc4\x85\x37\xce\x79"
+    "\x3a\x96\x5d\xb8\xab\x24\xbd\x3f\x70\x6b\x83\x3f\xac\xd9\x25\x3e"
+    "\x54\xb7\x33\x9e\x55\x78\xb7\x00\x8a\xe3\xc6\x8c\xe0\xc4\x7e\xec"
+    "\x1a\xb9\xff\x72\xcf\xab\x11\xc3\x02\xbb\xb7\x14\x60\x2e\x18\x72"
+    "\xdc\xc0\xe2\x68\xc1\x80\xca\x7d\x3d\xe2\xd2\x4b\x4d\xa1\x83\x6c"
+    "\x58\xde\x54\x16\xe0\xd7\xf5\x73\x20\x79\x27\x31\x46\x6c\xc6\xe0"
+    "\xb4\x5f\x48\xca\x50\x8a\x78\x2a\xfb\x5d\x75\x43\xfb\x93\x8b\x07"
+    "\xab\xff\x2e\x62\x62\x24\x9a\xb8\x52\xf6\x85\xaf\x64\x3e\x6c\x9b"
+    "\x09\xbe\xcf\x54\x2e\xa2\xb1\xd0\xcd\x4d\x55\x74\x1c\x60\x94\x85"
+    "\xa7\x37\x97\x2e\x69\x56\xda\x74\xeb\x79\xce\xd0\xf2\x78\x2a\x16"
+    "\x6d\x65\xd8\xfa\x05\xa0\x80\x85\xcc\x54\xf0\xb5\x70\xdb\xe1\xa8"
+    "\x29\x2e\x54\x3e\x3e\xe6\x35\xfb\x7d\x4c\x2a\x39\x29\x68\xd5\x00"
+    "\x38\x30\xb1\xaa\xed\xd4\x4d\xdd\x4a\xed\xc5\x35\x49\x2b\x01\xb7"
+    "\xe5\x73\x71\xcd\xdf\x1e\x01\x7b\xb3\x1b\x9e\xce\x4c\x74\xc1\x31"
+    "\x94\x69\xd0\xff\x62\xda\x04\x89\x4f\x43\x2d\x4f\x84\xd2\xbe\xf9"
+    "\x5e\xab\xa3\x16\x7b\x65\x3b\xc6\x9c\xd5\x5e\x96\x56\xdb\x2b\x54"
+    "\xc2\xdf\x96\x9d\x8a\xac\x31\x8f\x20\xf3\x98\xbf\xf3\x3c\xda\xf6"
+    "\xcf\x9f\xc6\x1f\xf0\xa2\x1f\xc4\x92\xfa\x8a\xe2\x77\x24\x7a\x6f"
+    "\xc4\x68\x36\x53\xe1\xc6\xcf\xae\x7d\x2f\x39\x4a\xc6\xe2\x24\x5a"
+    "\x7e\x28\x95\x70\x5b\x05\x83\x5f\x97\x7f\x62\xad\xea\x6a\x28\x38"
+    "\x0a\x33\xb8\xfc\x5f\x32\x2a\xc7\x27\xe9\x6f\xbb\x35\x0e\xe1\xb1"
+    "\x35\x05\xf2\x44\xfe\x03\x1e\x40\xb1\xe2\xa0\x87\x01\xca\x64\xcd"
+    "\x3c\xd0\xc6\x0c\x7f\x6a\xb4\xca\xb6\xbf\x42\x62\x6c\x56\x5d\x98"
+    "\x20\x78\xb9\x10\x86\x9c\xe9\x68\xf4\x79\xc2\x98\x38\x74\x48\xd7"
+    "\xc8\x9b\x02\xad\x88\x31\x83\xcd\x71\xc4\x93\xc2\x9d\x63\xd5\x56"
+    "\xf3\x5b\x40\x1e\x20\x6e\x30\x16\x04\x00\xed\xb8\x0e\xad\x4b\x60"
+    "\xf0\x6d\x3b\xfe\xb5\xa4\x12\x67\xe0\x08\xe8\x62\x69\x19\x7a\x29"
+    "\x3d\xee\x86\x38\x9f\x3f\x88\xa8\xe9\x2e\xa3\x11\xdd\xdd\x95\xc2"
+    "\xe5\xd9\x49\x3c\x33\xdd\x9b\xa5\xcf\x6b\xc2\xef\xfd\x1f\x08\x3f"
+    "\xc5\xe1\x11\x73\x32\xe8\xf2\x1e\xf7\xd8\xb6\x42\x80\x48\x6a\x45"
+    "\x77\x60\xbd\xcd\x56\x17\xc2\x2e\x84\x13\x61\xe5\x2f\x01\xf1\xd3"
+    "\xbd\x4a\x18\x2b\x9c\xd9\x50\x4c\x48\x7c\x32\xd8\x3b\x8a\x62\x4b"
+    "\x30\x9e\x89\x04\xcb\xaa\x40\x78\x4f\xf0\x0b\xb4\x67\x00\x42\x4d"
+    "\x4a\x26\xeb\x9d\x5e\x07\x1b\xc2\x98\xfe\xc9\xe5\x32\x9c\x18\x98"
+    "\x1d\x69\x3d\xf9\x37\x1a\xc0\xae\xeb\x34\x97\x7e\xc2\x2b\xd8\x61"
+    "\xaf\x67\xa6\xb4\x83\xad\x81\x91\x74\xef\xf9\xa6\x07\xe8\x5f\x1c"
+    "\x62\x76\x2b\xbd\x52\xa6\x8d\x21\x90\x33\x16\x00\xd4\x63\xe8\x7c"
+    "\x14\x99\xea\xd0\x95\xd7\x72\x3a\x74\x85\x43\xf0\x75\x74\x6e\x59";